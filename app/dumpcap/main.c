@@ -49,6 +49,7 @@
 #define MBUF_POOL_CACHE_SIZE 32
 #define BURST_SIZE 32
 #define SLEEP_THRESHOLD 1000
+#define WRITE_BUFFER_SIZE (1024 * 1024)
 
 /* command line flags */
 static const char *progname;
@@ -57,6 +58,7 @@ static bool group_read;
 static bool quiet;
 static bool promiscuous_mode = true;
 static bool use_pcapng = true;
+static bool zero_copy;
 static char *output_name;
 static const char *filter_str;
 static unsigned int ring_size = 2048;
@@ -120,6 +122,8 @@ static void usage(void)
 	       "  -P                       use libpcap format instead of pcapng\n"
 	       "  --capture-comment <comment>\n"
 	       "                           add a capture comment to the output file\n"
+	       "  --zero-copy              reference packets instead of copying them\n"
+	       "                           (pcapng only)\n"
 	       "\n"
 	       "Miscellaneous:\n"
 	       "  -q                       don't report packet capture counts\n"
@@ -318,6 +322,7 @@ static void parse_opts(int argc, char **argv)
 		{ "ring-buffer",     required_argument, NULL, 'b' },
 		{ "snapshot-length", required_argument, NULL, 's' },
 		{ "version",         no_argument,       NULL, 'v' },
+		{ "zero-copy",       no_argument,       NULL, 0 },
 		{ NULL },
 	};
 	int option_index, c;
@@ -330,11 +335,13 @@ static void parse_opts(int argc, char **argv)
 
 		switch (c) {
 		case 0:
-			switch (option_index) {
-			case 0:
+			if (strcmp(long_options[option_index].name,
+				   "capture-comment") == 0) {
 				capture_comment = optarg;
-				break;
-			default:
+			} else if (strcmp(long_options[option_index].name,
+					  "zero-copy") == 0) {
+				zero_copy = true;
+			} else {
 				usage();
 				exit(1);
 			}
@@ -399,6 +406,10 @@ static void parse_opts(int argc, char **argv)
 			exit(1);
 		}
 	}
+
+	if (zero_copy && !use_pcapng)
+		rte_exit(EXIT_FAILURE,
+			 "--zero-copy is only supported with pcapng format\n");
 }
 
 static void
@@ -651,6 +662,12 @@ static dumpcap_out_t create_output(void)
 			rte_exit(EXIT_FAILURE, "pcapng_fdopen failed: %s\n",
 				 strerror(rte_errno));
 		free(os);
+
+		/* Batch the packet bursts into large writes */
+		if (rte_pcapng_set_write_buffer(ret.pcapng,
+						WRITE_BUFFER_SIZE) < 0)
+			rte_exit(EXIT_FAILURE, "pcapng write buffer failed: %s\n",
+				 strerror(rte_errno));
 	} else {
 		pcap_t *pcap;
 
@@ -677,6 +694,8 @@ static void enable_pdump(struct rte_ring *r, struct rte_mempool *mp)
 	flags = RTE_PDUMP_FLAG_RXTX;
 	if (use_pcapng)
 		flags |= RTE_PDUMP_FLAG_PCAPNG;
+	if (zero_copy)
+		flags |= RTE_PDUMP_FLAG_ZEROCOPY;
 
 	TAILQ_FOREACH(intf, &interfaces, next) {
 		if (promiscuous_mode)
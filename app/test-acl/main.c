@@ -41,6 +41,7 @@
 #define	OPT_ITER_NUM		"iter"
 #define	OPT_VERBOSE		"verbose"
 #define	OPT_IPV6		"ipv6"
+#define	OPT_BLD_LCORES		"bldlcores"
 
 #define	TRACE_DEFAULT_NUM	0x10000
 #define	TRACE_STEP_MAX		0x1000
@@ -107,6 +108,7 @@ static struct {
 	uint32_t            iter_num;
 	uint32_t            verbose;
 	uint32_t            ipv6;
+	uint32_t            bld_lcores;
 	struct acl_alg      alg;
 	uint32_t            used_traces;
 	void               *traces;
@@ -234,6 +236,13 @@ enum {
 	NUM_FIELDS_IPV6
 };
 
+/* IPv6 addresses as four 32-bit fields or as one 128-bit field */
+enum {
+	IPV6_FRMT_NONE,
+	IPV6_FRMT_U32,
+	IPV6_FRMT_U128,
+};
+
 struct rte_acl_field_def ipv6_defs[NUM_FIELDS_IPV6] = {
 	{
 		.type = RTE_ACL_FIELD_TYPE_BITMASK,
@@ -314,6 +323,44 @@ struct rte_acl_field_def ipv6_defs[NUM_FIELDS_IPV6] = {
 	},
 };
 
+struct rte_acl_field_def ipv6_u128_defs[] = {
+	{
+		.type = RTE_ACL_FIELD_TYPE_BITMASK,
+		.size = sizeof(uint8_t),
+		.field_index = PROTO_FIELD_IPV6,
+		.input_index = PROTO_FIELD_IPV6,
+		.offset = offsetof(struct ipv6_5tuple, proto),
+	},
+	{
+		.type = RTE_ACL_FIELD_TYPE_MASK128,
+		.size = IPV6_ADDR_LEN,
+		.field_index = SRC1_FIELD_IPV6,
+		.input_index = SRC1_FIELD_IPV6,
+		.offset = offsetof(struct ipv6_5tuple, ip_src),
+	},
+	{
+		.type = RTE_ACL_FIELD_TYPE_MASK128,
+		.size = IPV6_ADDR_LEN,
+		.field_index = DST1_FIELD_IPV6,
+		.input_index = DST1_FIELD_IPV6,
+		.offset = offsetof(struct ipv6_5tuple, ip_dst),
+	},
+	{
+		.type = RTE_ACL_FIELD_TYPE_RANGE,
+		.size = sizeof(uint16_t),
+		.field_index = SRCP_FIELD_IPV6,
+		.input_index = SRCP_FIELD_IPV6,
+		.offset = offsetof(struct ipv6_5tuple, port_src),
+	},
+	{
+		.type = RTE_ACL_FIELD_TYPE_RANGE,
+		.size = sizeof(uint16_t),
+		.field_index = DSTP_FIELD_IPV6,
+		.input_index = SRCP_FIELD_IPV6,
+		.offset = offsetof(struct ipv6_5tuple, port_dst),
+	},
+};
+
 
 enum {
 	CB_FLD_SRC_ADDR,
@@ -574,6 +621,14 @@ parse_ipv6_net(const char *in, struct rte_acl_field field[4])
 		field[i].value.u32 = v[i];
 	}
 
+	/* or use the first two fields for the 128-bit address. */
+	if (config.ipv6 == IPV6_FRMT_U128) {
+		field[0].value.u64 = (uint64_t)v[0] << 32 | v[1];
+		field[0].mask_range.u64 = m;
+		field[1].value.u64 = (uint64_t)v[2] << 32 | v[3];
+		field[1].mask_range.u64 = 0;
+	}
+
 	return 0;
 }
 
@@ -799,12 +854,20 @@ acx_init(void)
 {
 	int ret;
 	FILE *f;
+	uint32_t lcore;
+	uint64_t start, tm;
 	struct rte_acl_config cfg;
+	struct rte_acl_build_param bld;
+	unsigned int lcores[RTE_MAX_LCORE];
 
 	memset(&cfg, 0, sizeof(cfg));
+	memset(&bld, 0, sizeof(bld));
 
 	/* setup ACL build config. */
-	if (config.ipv6) {
+	if (config.ipv6 == IPV6_FRMT_U128) {
+		cfg.num_fields = RTE_DIM(ipv6_u128_defs);
+		memcpy(&cfg.defs, ipv6_u128_defs, sizeof(ipv6_u128_defs));
+	} else if (config.ipv6) {
 		cfg.num_fields = RTE_DIM(ipv6_defs);
 		memcpy(&cfg.defs, ipv6_defs, sizeof(ipv6_defs));
 	} else {
@@ -815,7 +878,8 @@ acx_init(void)
 	cfg.max_size = config.max_size;
 
 	/* setup ACL creation parameters. */
-	prm.rule_size = RTE_ACL_RULE_SZ(cfg.num_fields);
+	prm.rule_size = RTE_ACL_RULE_SZ(config.ipv6 ?
+		RTE_DIM(ipv6_defs) : cfg.num_fields);
 	prm.max_rule_num = config.nb_rules;
 
 	config.acx = rte_acl_create(&prm);
@@ -842,12 +906,23 @@ acx_init(void)
 
 	fclose(f);
 
+	/* build the tries on the worker lcores, if requested. */
+	if (config.bld_lcores != 0) {
+		RTE_LCORE_FOREACH_WORKER(lcore)
+			lcores[bld.num_lcores++] = lcore;
+		bld.lcores = lcores;
+	}
+
 	/* perform build. */
-	ret = rte_acl_build(config.acx, &cfg);
+	start = rte_rdtsc_precise();
+	ret = rte_acl_build_ext(config.acx, &cfg, &bld);
+	tm = rte_rdtsc_precise() - start;
 
 	dump_verbose(DUMP_NONE, stdout,
-		"rte_acl_build(%u) finished with %d\n",
-		config.bld_categories, ret);
+		"rte_acl_build(%u) on %u worker lcores finished with %d, "
+		"%" PRIu64 " cycles (%.2Lf sec)\n",
+		config.bld_categories, bld.num_lcores, ret,
+		tm, (long double)tm / rte_get_timer_hz());
 
 	rte_acl_dump(config.acx);
 
@@ -999,7 +1074,9 @@ print_usage(const char *prgname)
 		"[--" OPT_ITER_NUM "=<number of iterations to perform>]\n"
 		"[--" OPT_VERBOSE "=<verbose level>]\n"
 		"[--" OPT_SEARCH_ALG "=%s]\n"
-		"[--" OPT_IPV6 "=<IPv6 rules and trace files>]\n",
+		"[--" OPT_IPV6 "[=4B|16B] <IPv6 rules and trace files, "
+			"addresses in 4B or 16B fields>]\n"
+		"[--" OPT_BLD_LCORES "=<build tries on worker lcores>]\n",
 		prgname, RTE_ACL_RESULTS_MULTIPLIER,
 		(uint32_t)RTE_ACL_MAX_CATEGORIES,
 		buf);
@@ -1022,6 +1099,20 @@ dump_config(FILE *f)
 	fprintf(f, "%s:%u(%s)\n", OPT_SEARCH_ALG, config.alg.alg,
 		config.alg.name);
 	fprintf(f, "%s:%u\n", OPT_IPV6, config.ipv6);
+	fprintf(f, "%s:%u\n", OPT_BLD_LCORES, config.bld_lcores);
+}
+
+static uint32_t
+get_ipv6_opt(const char *opt, const char *name)
+{
+	if (opt == NULL || strcmp(opt, "4B") == 0)
+		return IPV6_FRMT_U32;
+	else if (strcmp(opt, "16B") == 0)
+		return IPV6_FRMT_U128;
+
+	rte_exit(-EINVAL, "invalid value: \"%s\" for option: %s\n",
+		opt, name);
+	return IPV6_FRMT_NONE;
 }
 
 static void
@@ -1050,7 +1141,8 @@ get_input_opts(int argc, char **argv)
 		{OPT_ITER_NUM, 1, 0, 0},
 		{OPT_VERBOSE, 1, 0, 0},
 		{OPT_SEARCH_ALG, 1, 0, 0},
-		{OPT_IPV6, 0, 0, 0},
+		{OPT_IPV6, 2, 0, 0},
+		{OPT_BLD_LCORES, 0, 0, 0},
 		{NULL, 0, 0, 0}
 	};
 
@@ -1099,7 +1191,11 @@ get_input_opts(int argc, char **argv)
 				OPT_SEARCH_ALG) == 0) {
 			get_alg_opt(optarg, lgopts[opt_idx].name);
 		} else if (strcmp(lgopts[opt_idx].name, OPT_IPV6) == 0) {
-			config.ipv6 = 1;
+			config.ipv6 = get_ipv6_opt(optarg,
+				lgopts[opt_idx].name);
+		} else if (strcmp(lgopts[opt_idx].name,
+				OPT_BLD_LCORES) == 0) {
+			config.bld_lcores = 1;
 		}
 	}
 	config.trace_sz = config.ipv6 ? sizeof(struct ipv6_5tuple) :
@@ -44,6 +44,7 @@
 #define FIB_TYPE_MASK		(FIB_RIB_TYPE|FIB_V4_DIR_TYPE|FIB_V6_TRIE_TYPE)
 #define SHUFFLE_FLAG		(1 << 7)
 #define DRY_RUN_FLAG		(1 << 8)
+#define BATCH_FLAG		(1 << 9)
 
 static char *distrib_string;
 static char line[LINE_MAX];
@@ -627,6 +628,8 @@ print_usage(void)
 		"[-c <do comparison with LPM library>]\n"
 		"[-6 <do tests with ipv6 (default ipv4)>]\n"
 		"[-s <shuffle randomly generated routes>]\n"
+		"[-B <add and delete all the routes in one FIB update"
+		" transaction (not valid with -b rib)>]\n"
 		"[-a <check nexthops for all ipv4 address space"
 		"(only valid with -c)>]\n"
 		"[-b <fib algorithm>]\n\tavailable options for ipv4\n"
@@ -678,6 +681,12 @@ check_config(void)
 		printf("-e 1 is valid only for ipv4\n");
 		return -1;
 	}
+
+	if ((config.flags & BATCH_FLAG) &&
+			((config.flags & FIB_TYPE_MASK) == FIB_RIB_TYPE)) {
+		printf("-B is valid only for dir and trie fib types\n");
+		return -1;
+	}
 	return 0;
 }
 
@@ -687,7 +696,7 @@ parse_opts(int argc, char **argv)
 	int opt;
 	char *endptr;
 
-	while ((opt = getopt(argc, argv, "f:t:n:d:l:r:c6ab:e:g:w:u:sv:")) !=
+	while ((opt = getopt(argc, argv, "f:t:n:d:l:r:c6ab:e:g:w:u:sBv:")) !=
 			-1) {
 		switch (opt) {
 		case 'f':
@@ -737,6 +746,9 @@ parse_opts(int argc, char **argv)
 		case 's':
 			config.flags |= SHUFFLE_FLAG;
 			break;
+		case 'B':
+			config.flags |= BATCH_FLAG;
+			break;
 		case 'c':
 			config.flags |= CMP_FLAG;
 			break;
@@ -891,20 +903,37 @@ run_v4(void)
 		}
 	}
 
-	for (k = config.print_fract, i = 0; k > 0; k--) {
+	if (config.flags & BATCH_FLAG) {
 		start = rte_rdtsc_precise();
-		for (j = 0; j < (config.nb_routes - i) / k; j++) {
-			ret = rte_fib_add(fib, rt[i + j].addr, rt[i + j].depth,
-				rt[i + j].nh);
-			if (unlikely(ret != 0)) {
-				printf("Can not add a route to FIB, err %d\n",
-					ret);
-				return -ret;
+		ret = rte_fib_update_begin(fib);
+		for (i = 0; (ret == 0) && (i < config.nb_routes); i++)
+			ret = rte_fib_add(fib, rt[i].addr, rt[i].depth,
+				rt[i].nh);
+		if (ret == 0)
+			ret = rte_fib_update_commit(fib);
+		if (ret != 0) {
+			printf("Can not load routes to FIB, err %d\n", ret);
+			return -ret;
+		}
+		acc = rte_rdtsc_precise() - start;
+		printf("FIB batched load %"PRIu64", AVG FIB add %"PRIu64"\n",
+			acc, acc / config.nb_routes);
+	} else {
+		for (k = config.print_fract, i = 0; k > 0; k--) {
+			start = rte_rdtsc_precise();
+			for (j = 0; j < (config.nb_routes - i) / k; j++) {
+				ret = rte_fib_add(fib, rt[i + j].addr,
+					rt[i + j].depth, rt[i + j].nh);
+				if (unlikely(ret != 0)) {
+					printf("Can not add a route to FIB, "
+						"err %d\n", ret);
+					return -ret;
+				}
 			}
+			printf("AVG FIB add %"PRIu64"\n",
+				(rte_rdtsc_precise() - start) / j);
+			i += j;
 		}
-		printf("AVG FIB add %"PRIu64"\n",
-			(rte_rdtsc_precise() - start) / j);
-		i += j;
 	}
 
 	if (config.flags & CMP_FLAG) {
@@ -979,14 +1008,32 @@ run_v4(void)
 		printf("FIB and LPM lookup returns same values\n");
 	}
 
-	for (k = config.print_fract, i = 0; k > 0; k--) {
+	if (config.flags & BATCH_FLAG) {
 		start = rte_rdtsc_precise();
-		for (j = 0; j < (config.nb_routes - i) / k; j++)
-			rte_fib_delete(fib, rt[i + j].addr, rt[i + j].depth);
+		ret = rte_fib_update_begin(fib);
+		for (i = 0; (ret == 0) && (i < config.nb_routes); i++)
+			rte_fib_delete(fib, rt[i].addr, rt[i].depth);
+		if (ret == 0)
+			ret = rte_fib_update_commit(fib);
+		if (ret != 0) {
+			printf("Can not delete routes from FIB, err %d\n",
+				ret);
+			return -ret;
+		}
+		acc = rte_rdtsc_precise() - start;
+		printf("FIB batched delete %"PRIu64", AVG FIB delete %"PRIu64
+			"\n", acc, acc / config.nb_routes);
+	} else {
+		for (k = config.print_fract, i = 0; k > 0; k--) {
+			start = rte_rdtsc_precise();
+			for (j = 0; j < (config.nb_routes - i) / k; j++)
+				rte_fib_delete(fib, rt[i + j].addr,
+					rt[i + j].depth);
 
-		printf("AVG FIB delete %"PRIu64"\n",
-			(rte_rdtsc_precise() - start) / j);
-		i += j;
+			printf("AVG FIB delete %"PRIu64"\n",
+				(rte_rdtsc_precise() - start) / j);
+			i += j;
+		}
 	}
 
 	if (config.flags & CMP_FLAG) {
@@ -1086,20 +1133,37 @@ run_v6(void)
 		}
 	}
 
-	for (k = config.print_fract, i = 0; k > 0; k--) {
+	if (config.flags & BATCH_FLAG) {
 		start = rte_rdtsc_precise();
-		for (j = 0; j < (config.nb_routes - i) / k; j++) {
-			ret = rte_fib6_add(fib, rt[i + j].addr,
-				rt[i + j].depth, rt[i + j].nh);
-			if (unlikely(ret != 0)) {
-				printf("Can not add a route to FIB, err %d\n",
-					ret);
-				return -ret;
+		ret = rte_fib6_update_begin(fib);
+		for (i = 0; (ret == 0) && (i < config.nb_routes); i++)
+			ret = rte_fib6_add(fib, rt[i].addr, rt[i].depth,
+				rt[i].nh);
+		if (ret == 0)
+			ret = rte_fib6_update_commit(fib);
+		if (ret != 0) {
+			printf("Can not load routes to FIB, err %d\n", ret);
+			return -ret;
+		}
+		acc = rte_rdtsc_precise() - start;
+		printf("FIB batched load %"PRIu64", AVG FIB add %"PRIu64"\n",
+			acc, acc / config.nb_routes);
+	} else {
+		for (k = config.print_fract, i = 0; k > 0; k--) {
+			start = rte_rdtsc_precise();
+			for (j = 0; j < (config.nb_routes - i) / k; j++) {
+				ret = rte_fib6_add(fib, rt[i + j].addr,
+					rt[i + j].depth, rt[i + j].nh);
+				if (unlikely(ret != 0)) {
+					printf("Can not add a route to FIB, "
+						"err %d\n", ret);
+					return -ret;
+				}
 			}
+			printf("AVG FIB add %"PRIu64"\n",
+				(rte_rdtsc_precise() - start) / j);
+			i += j;
 		}
-		printf("AVG FIB add %"PRIu64"\n",
-			(rte_rdtsc_precise() - start) / j);
-		i += j;
 	}
 
 	if (config.flags & CMP_FLAG) {
@@ -1178,14 +1242,32 @@ run_v6(void)
 		printf("FIB and LPM lookup returns same values\n");
 	}
 
-	for (k = config.print_fract, i = 0; k > 0; k--) {
+	if (config.flags & BATCH_FLAG) {
 		start = rte_rdtsc_precise();
-		for (j = 0; j < (config.nb_routes - i) / k; j++)
-			rte_fib6_delete(fib, rt[i + j].addr, rt[i + j].depth);
+		ret = rte_fib6_update_begin(fib);
+		for (i = 0; (ret == 0) && (i < config.nb_routes); i++)
+			rte_fib6_delete(fib, rt[i].addr, rt[i].depth);
+		if (ret == 0)
+			ret = rte_fib6_update_commit(fib);
+		if (ret != 0) {
+			printf("Can not delete routes from FIB, err %d\n",
+				ret);
+			return -ret;
+		}
+		acc = rte_rdtsc_precise() - start;
+		printf("FIB batched delete %"PRIu64", AVG FIB delete %"PRIu64
+			"\n", acc, acc / config.nb_routes);
+	} else {
+		for (k = config.print_fract, i = 0; k > 0; k--) {
+			start = rte_rdtsc_precise();
+			for (j = 0; j < (config.nb_routes - i) / k; j++)
+				rte_fib6_delete(fib, rt[i + j].addr,
+					rt[i + j].depth);
 
-		printf("AVG FIB delete %"PRIu64"\n",
-			(rte_rdtsc_precise() - start) / j);
-		i += j;
+			printf("AVG FIB delete %"PRIu64"\n",
+				(rte_rdtsc_precise() - start) / j);
+			i += j;
+		}
 	}
 
 	if (config.flags & CMP_FLAG) {
@@ -4131,7 +4131,8 @@ setup_gro(const char *onoff, portid_t port_id)
 			return;
 		}
 		if (gro_flush_cycles == GRO_DEFAULT_FLUSH_CYCLES) {
-			gro_ports[port_id].param.gro_types = RTE_GRO_TCP_IPV4;
+			gro_ports[port_id].param.gro_types = RTE_GRO_TCP_IPV4 |
+				RTE_GRO_TCP_IPV6;
 			gro_ports[port_id].param.max_flow_num =
 				GRO_DEFAULT_FLOW_NUM;
 			gro_ports[port_id].param.max_item_per_flow =
@@ -4180,7 +4181,7 @@ show_gro(portid_t port_id)
 		return;
 	}
 	if (gro_ports[port_id].enable) {
-		printf("GRO type: TCP/IPv4\n");
+		printf("GRO type: TCP/IPv4, TCP/IPv6\n");
 		if (gro_flush_cycles == GRO_DEFAULT_FLUSH_CYCLES) {
 			max_pkts_num = param->max_flow_num *
 				param->max_item_per_flow;
@@ -13,6 +13,7 @@
 #include <rte_ip.h>
 #include <rte_acl.h>
 #include <rte_common.h>
+#include <rte_random.h>
 
 #include "test_acl.h"
 
@@ -449,6 +450,271 @@ test_classify(void)
 	return ret;
 }
 
+#define	TEST_BUILD_EXT_FILL_RULES	0x1000
+
+/*
+ * Add rules of a category the test data are not checked against,
+ * enough of them for the build to split the rule set into several tries.
+ */
+static int
+test_build_ext_fill(struct rte_acl_ctx *acx)
+{
+	uint32_t i;
+	struct rte_acl_ipv4vlan_rule r;
+
+	for (i = 0; i != TEST_BUILD_EXT_FILL_RULES; i++) {
+		memset(&r, 0, sizeof(r));
+		r.data.category_mask = 1 << (LEN - 1);
+		r.data.priority = 1;
+		r.data.userdata = i + 1;
+		r.src_addr = RTE_IPV4(10, 0, i >> 8, i);
+		r.src_mask_len = 32;
+		r.dst_addr = RTE_IPV4(192, 168, i >> 4, 0);
+		r.dst_mask_len = 24;
+		r.src_port_low = i % 1000;
+		r.src_port_high = r.src_port_low + i % 37;
+		r.dst_port_low = i % 777;
+		r.dst_port_high = UINT16_MAX - i % 101;
+
+		if (rte_acl_ipv4vlan_add_rules(acx, &r, 1) != 0) {
+			printf("Line %i: Adding rules to ACL context failed!\n",
+				__LINE__);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/*
+ * Test ACL build on worker lcores and incremental ACL build,
+ * classify results have to be the same as with a regular build.
+ */
+static int
+test_build_ext(void)
+{
+	struct rte_acl_ctx *acx;
+	struct rte_acl_config cfg;
+	struct rte_acl_build_param prm;
+	unsigned int lcores[RTE_MAX_LCORE];
+	uint32_t half, i, lcore;
+	int ret;
+
+	acx = rte_acl_create(&acl_param);
+	if (acx == NULL) {
+		printf("Line %i: Error creating ACL context!\n", __LINE__);
+		return -1;
+	}
+
+	memset(&cfg, 0, sizeof(cfg));
+	acl_ipv4vlan_config(&cfg, ipv4_7tuple_layout, RTE_ACL_MAX_CATEGORIES);
+
+	memset(&prm, 0, sizeof(prm));
+	RTE_LCORE_FOREACH_WORKER(lcore)
+		lcores[prm.num_lcores++] = lcore;
+	prm.lcores = lcores;
+
+	half = RTE_DIM(acl_test_rules) / 2;
+	ret = 0;
+
+	for (i = 0; i != 2; i++) {
+
+		/* build on worker lcores all at once */
+		prm.flags = 0;
+		rte_acl_reset(acx);
+		ret = test_build_ext_fill(acx);
+		if (ret == 0)
+			ret = rte_acl_ipv4vlan_add_rules(acx, acl_test_rules,
+				RTE_DIM(acl_test_rules));
+		if (ret == 0)
+			ret = rte_acl_build_ext(acx, &cfg, &prm);
+		if (ret != 0) {
+			printf("Line %i, iter: %u: Building ACL context "
+				"failed with error code: %d\n",
+				__LINE__, i, ret);
+			break;
+		}
+
+		ret = test_classify_run(acx, acl_test_data,
+			RTE_DIM(acl_test_data));
+		if (ret != 0) {
+			printf("Line %i, iter: %u: %s failed!\n",
+				__LINE__, i, __func__);
+			break;
+		}
+
+		/* build incrementally, with and without new rules */
+		prm.flags = RTE_ACL_BUILD_F_INCREMENTAL;
+		rte_acl_reset_rules(acx);
+		ret = test_build_ext_fill(acx);
+		if (ret == 0)
+			ret = rte_acl_ipv4vlan_add_rules(acx, acl_test_rules,
+				half);
+		if (ret == 0)
+			ret = rte_acl_build_ext(acx, &cfg, &prm);
+		if (ret == 0)
+			ret = rte_acl_ipv4vlan_add_rules(acx,
+				acl_test_rules + half,
+				RTE_DIM(acl_test_rules) - half);
+		if (ret == 0)
+			ret = rte_acl_build_ext(acx, &cfg, &prm);
+		if (ret == 0)
+			ret = rte_acl_build_ext(acx, &cfg, &prm);
+		if (ret != 0) {
+			printf("Line %i, iter: %u: Incremental build of ACL "
+				"context failed with error code: %d\n",
+				__LINE__, i, ret);
+			break;
+		}
+
+		ret = test_classify_run(acx, acl_test_data,
+			RTE_DIM(acl_test_data));
+		if (ret != 0) {
+			printf("Line %i, iter: %u: %s failed!\n",
+				__LINE__, i, __func__);
+			break;
+		}
+
+		/* build all rules on the calling lcore on next iteration */
+		prm.num_lcores = 0;
+	}
+
+	rte_acl_free(acx);
+	return ret;
+}
+
+#define	TEST_BUILD_INC_VLAN_RULES	16
+
+/*
+ * Incremental build where the first rule only matches on the source
+ * address, so the first build drops all the fields after it, and the
+ * new rules match on the other fields: the new rules must keep the
+ * wildness of all their fields apart, or the VLAN fields of a rule
+ * look as wild as the ports of the previous one.
+ */
+static int
+test_build_incremental_fields(void)
+{
+	static struct ipv4_7tuple test_data[2 * TEST_BUILD_INC_VLAN_RULES + 3];
+	const uint8_t *data[RTE_DIM(test_data)];
+	uint32_t results[RTE_DIM(test_data)];
+	uint32_t expected[RTE_DIM(test_data)];
+	struct rte_acl_ipv4vlan_rule r;
+	struct rte_acl_build_param prm;
+	struct rte_acl_config cfg;
+	struct rte_acl_ctx *acx;
+	uint32_t i, n;
+	int ret;
+
+	acx = rte_acl_create(&acl_param);
+	if (acx == NULL) {
+		printf("Line %i: Error creating ACL context!\n", __LINE__);
+		return -1;
+	}
+
+	memset(&cfg, 0, sizeof(cfg));
+	acl_ipv4vlan_config(&cfg, ipv4_7tuple_layout, RTE_ACL_MAX_CATEGORIES);
+	memset(&prm, 0, sizeof(prm));
+	prm.flags = RTE_ACL_BUILD_F_INCREMENTAL;
+
+	/* match all packets from 10.0.0.0/8, on any port */
+	memset(&r, 0, sizeof(r));
+	r.data.category_mask = ACL_ALLOW_MASK;
+	r.data.priority = 1;
+	r.data.userdata = 1;
+	r.src_addr = RTE_IPV4(10, 0, 0, 0);
+	r.src_mask_len = 8;
+	r.src_port_high = UINT16_MAX;
+	r.dst_port_high = UINT16_MAX;
+	ret = rte_acl_ipv4vlan_add_rules(acx, &r, 1);
+	if (ret == 0)
+		ret = rte_acl_build_ext(acx, &cfg, &prm);
+
+	/* and those to 192.168.0.0/16, on any port */
+	r.data.priority = 2;
+	r.data.userdata = 2;
+	r.dst_addr = RTE_IPV4(192, 168, 0, 0);
+	r.dst_mask_len = 16;
+	if (ret == 0)
+		ret = rte_acl_ipv4vlan_add_rules(acx, &r, 1);
+
+	/* and those to 192.168.i.0/24 on VLAN 100 + i, on any port */
+	r.data.priority = 3;
+	r.dst_mask_len = 24;
+	r.vlan_mask = UINT16_MAX;
+	for (i = 0; ret == 0 && i != TEST_BUILD_INC_VLAN_RULES; i++) {
+		r.data.userdata = 3 + i;
+		r.dst_addr = RTE_IPV4(192, 168, i, 0);
+		r.vlan = 100 + i;
+		ret = rte_acl_ipv4vlan_add_rules(acx, &r, 1);
+	}
+
+	/* and those to 192.168.200.0/24 on port 1000 */
+	r.data.userdata = 3 + TEST_BUILD_INC_VLAN_RULES;
+	r.dst_addr = RTE_IPV4(192, 168, 200, 0);
+	r.vlan = 0;
+	r.vlan_mask = 0;
+	r.dst_port_low = 1000;
+	r.dst_port_high = 1000;
+	if (ret == 0)
+		ret = rte_acl_ipv4vlan_add_rules(acx, &r, 1);
+
+	if (ret == 0)
+		ret = rte_acl_build_ext(acx, &cfg, &prm);
+	if (ret != 0) {
+		printf("Line %i: Incremental build of ACL context "
+			"failed with error code: %d\n", __LINE__, ret);
+		rte_acl_free(acx);
+		return ret;
+	}
+
+	memset(test_data, 0, sizeof(test_data));
+	for (i = 0; i != RTE_DIM(test_data); i++) {
+		test_data[i].proto = 6;
+		test_data[i].ip_src = RTE_IPV4(10, 1, 1, 1);
+		test_data[i].port_dst = 80;
+		data[i] = (uint8_t *)&test_data[i];
+	}
+
+	/* packets on the VLAN of their rule, then on another one */
+	for (i = 0; i != TEST_BUILD_INC_VLAN_RULES; i++) {
+		test_data[i].ip_dst = RTE_IPV4(192, 168, i, 1);
+		test_data[i].vlan = 100 + i;
+		expected[i] = 3 + i;
+		n = TEST_BUILD_INC_VLAN_RULES + i;
+		test_data[n].ip_dst = RTE_IPV4(192, 168, i, 1);
+		test_data[n].vlan = 999;
+		expected[n] = 2;
+	}
+
+	/* packets on the port of the last rule, then on another port */
+	n = 2 * TEST_BUILD_INC_VLAN_RULES;
+	test_data[n].ip_dst = RTE_IPV4(192, 168, 200, 1);
+	test_data[n].port_dst = 1000;
+	expected[n] = 3 + TEST_BUILD_INC_VLAN_RULES;
+	test_data[n + 1].ip_dst = RTE_IPV4(192, 168, 200, 1);
+	expected[n + 1] = 2;
+	test_data[n + 2].ip_dst = RTE_IPV4(172, 16, 0, 1);
+	expected[n + 2] = 1;
+
+	bswap_test_data(test_data, RTE_DIM(test_data), 1);
+
+	ret = rte_acl_classify(acx, data, results, RTE_DIM(data), 1);
+	if (ret != 0)
+		printf("Line %i: classify failed!\n", __LINE__);
+
+	for (i = 0; ret == 0 && i != RTE_DIM(results); i++) {
+		if (results[i] != expected[i]) {
+			printf("Line %i: Error in results at %u "
+				"(expected %u got %u)!\n",
+				__LINE__, i, expected[i], results[i]);
+			ret = -EINVAL;
+		}
+	}
+
+	rte_acl_free(acx);
+	return ret;
+}
+
 static int
 test_build_ports_range(void)
 {
@@ -1716,6 +1982,177 @@ test_u32_range(void)
 	return rc;
 }
 
+#define	TEST_MASK128_RULES	0x200
+#define	TEST_MASK128_DATA	0x400
+
+struct ipv6_2tuple {
+	uint8_t  proto;
+	uint32_t ip[4];
+};
+
+enum {
+	PROTO_FIELD_IPV6_2T,
+	IP1_FIELD_IPV6_2T,
+	IP2_FIELD_IPV6_2T,
+	IP3_FIELD_IPV6_2T,
+	IP4_FIELD_IPV6_2T,
+	NUM_FIELDS_IPV6_2T
+};
+
+RTE_ACL_RULE_DEF(acl_ipv6_2tuple_rule, NUM_FIELDS_IPV6_2T);
+
+static int
+test_mask128_ctx(struct rte_acl_ctx *acx, const struct rte_acl_config *cfg,
+	const struct acl_ipv6_2tuple_rule *rules, uint32_t num)
+{
+	int ret;
+
+	ret = rte_acl_add_rules(acx, (const struct rte_acl_rule *)rules, num);
+	if (ret != 0) {
+		printf("Line %i: Adding rules to ACL context failed!\n",
+			__LINE__);
+		return ret;
+	}
+
+	ret = rte_acl_build(acx, cfg);
+	if (ret != 0) {
+		printf("Line %i: Building ACL context failed!\n", __LINE__);
+		return ret;
+	}
+	return 0;
+}
+
+/*
+ * Test 128-bit prefix field against IPv6 addresses split
+ * into four 32-bit prefix fields, results have to be the same.
+ */
+static int
+test_mask128(void)
+{
+	static const uint32_t mask_len[] = {0, 16, 32, 48, 56, 64, 96, 127, 128};
+	static struct acl_ipv6_2tuple_rule r32[TEST_MASK128_RULES];
+	static struct acl_ipv6_2tuple_rule r128[TEST_MASK128_RULES];
+	static struct ipv6_2tuple data[TEST_MASK128_DATA];
+	const uint8_t *dp[TEST_MASK128_DATA];
+	uint32_t res32[TEST_MASK128_DATA], res128[TEST_MASK128_DATA];
+	struct rte_acl_ctx *acx32, *acx128;
+	struct rte_acl_config cfg32, cfg128;
+	struct rte_acl_param prm;
+	uint32_t i, j, len, ip[4];
+	int ret;
+
+	memset(&cfg32, 0, sizeof(cfg32));
+	cfg32.num_categories = 1;
+	cfg32.num_fields = NUM_FIELDS_IPV6_2T;
+	cfg32.defs[0].type = RTE_ACL_FIELD_TYPE_BITMASK;
+	cfg32.defs[0].size = sizeof(uint8_t);
+	cfg32.defs[0].field_index = PROTO_FIELD_IPV6_2T;
+	cfg32.defs[0].input_index = PROTO_FIELD_IPV6_2T;
+	cfg32.defs[0].offset = offsetof(struct ipv6_2tuple, proto);
+	for (i = 0; i != RTE_DIM(ip); i++) {
+		cfg32.defs[i + 1].type = RTE_ACL_FIELD_TYPE_MASK;
+		cfg32.defs[i + 1].size = sizeof(uint32_t);
+		cfg32.defs[i + 1].field_index = IP1_FIELD_IPV6_2T + i;
+		cfg32.defs[i + 1].input_index = IP1_FIELD_IPV6_2T + i;
+		cfg32.defs[i + 1].offset = offsetof(struct ipv6_2tuple, ip[i]);
+	}
+
+	cfg128 = cfg32;
+	cfg128.num_fields = 2;
+	cfg128.defs[1].type = RTE_ACL_FIELD_TYPE_MASK128;
+	cfg128.defs[1].size = sizeof(ip);
+
+	memset(r32, 0, sizeof(r32));
+	memset(r128, 0, sizeof(r128));
+
+	for (i = 0; i != TEST_MASK128_RULES; i++) {
+		len = mask_len[i % RTE_DIM(mask_len)];
+		for (j = 0; j != RTE_DIM(ip); j++)
+			ip[j] = rte_rand();
+
+		/* some rules share a prefix with the previous ones */
+		if (i >= RTE_DIM(mask_len) && (i & 1) != 0)
+			memcpy(ip, &r32[i - RTE_DIM(mask_len)].field[1],
+				sizeof(ip[0]));
+
+		r32[i].data.category_mask = 1;
+		r32[i].data.priority = len + 1;
+		r32[i].data.userdata = i + 1;
+		r32[i].field[PROTO_FIELD_IPV6_2T].value.u8 = IPPROTO_TCP;
+		r32[i].field[PROTO_FIELD_IPV6_2T].mask_range.u8 = UINT8_MAX;
+		for (j = 0; j != RTE_DIM(ip); j++) {
+			r32[i].field[IP1_FIELD_IPV6_2T + j].value.u32 = ip[j];
+			r32[i].field[IP1_FIELD_IPV6_2T + j].mask_range.u32 =
+				RTE_MIN(RTE_MAX(len, j * 32) - j * 32, 32U);
+		}
+
+		r128[i].data = r32[i].data;
+		r128[i].field[PROTO_FIELD_IPV6_2T] =
+			r32[i].field[PROTO_FIELD_IPV6_2T];
+		r128[i].field[IP1_FIELD_IPV6_2T].value.u64 =
+			(uint64_t)ip[0] << 32 | ip[1];
+		r128[i].field[IP1_FIELD_IPV6_2T].mask_range.u32 = len;
+		r128[i].field[IP2_FIELD_IPV6_2T].value.u64 =
+			(uint64_t)ip[2] << 32 | ip[3];
+	}
+
+	/* look up addresses around the rules prefixes */
+	for (i = 0; i != TEST_MASK128_DATA; i++) {
+		data[i].proto = IPPROTO_TCP;
+		for (j = 0; j != RTE_DIM(ip); j++) {
+			data[i].ip[j] = r32[i % TEST_MASK128_RULES].field[
+				IP1_FIELD_IPV6_2T + j].value.u32;
+			if ((i & 3) == (j & 3))
+				data[i].ip[j] ^= rte_rand() & UINT16_MAX;
+			data[i].ip[j] = rte_cpu_to_be_32(data[i].ip[j]);
+		}
+		dp[i] = (const uint8_t *)&data[i];
+	}
+
+	memset(&prm, 0, sizeof(prm));
+	prm.socket_id = SOCKET_ID_ANY;
+	prm.max_rule_num = TEST_MASK128_RULES;
+
+	prm.name = "acl_mask32";
+	prm.rule_size = RTE_ACL_RULE_SZ(NUM_FIELDS_IPV6_2T);
+	acx32 = rte_acl_create(&prm);
+	prm.name = "acl_mask128";
+	acx128 = rte_acl_create(&prm);
+	if (acx32 == NULL || acx128 == NULL) {
+		printf("Line %i: Error creating ACL context!\n", __LINE__);
+		ret = -1;
+		goto exit;
+	}
+
+	ret = test_mask128_ctx(acx32, &cfg32, r32, TEST_MASK128_RULES);
+	if (ret == 0)
+		ret = test_mask128_ctx(acx128, &cfg128, r128,
+			TEST_MASK128_RULES);
+	if (ret == 0)
+		ret = rte_acl_classify(acx32, dp, res32, RTE_DIM(dp), 1);
+	if (ret == 0)
+		ret = rte_acl_classify(acx128, dp, res128, RTE_DIM(dp), 1);
+	if (ret != 0) {
+		printf("Line %i: %s failed!\n", __LINE__, __func__);
+		goto exit;
+	}
+
+	for (i = 0; i != RTE_DIM(dp); i++) {
+		if (res32[i] != res128[i]) {
+			printf("Line %i: Error in results at %u "
+				"(expected %u got %u)!\n",
+				__LINE__, i, res32[i], res128[i]);
+			ret = -1;
+			break;
+		}
+	}
+
+exit:
+	rte_acl_free(acx32);
+	rte_acl_free(acx128);
+	return ret;
+}
+
 static int
 test_acl(void)
 {
@@ -1733,10 +2170,16 @@ test_acl(void)
 		return -1;
 	if (test_build_ports_range() < 0)
 		return -1;
+	if (test_build_ext() < 0)
+		return -1;
+	if (test_build_incremental_fields() < 0)
+		return -1;
 	if (test_convert() < 0)
 		return -1;
 	if (test_u32_range() < 0)
 		return -1;
+	if (test_mask128() < 0)
+		return -1;
 
 	return 0;
 }
@@ -717,6 +717,89 @@ sanity_mark_test(struct worker_params *wp, struct rte_mempool *p)
 	return 0;
 }
 
+/* check the per-worker statistics: each packet is accounted to the worker
+ * which handled it, either as pinned or unpinned, and nothing is left
+ * queued once all packets are back.
+ */
+static int
+test_worker_stats(struct worker_params *wp, struct rte_mempool *p)
+{
+	struct rte_distributor *d = wp->dist;
+	struct rte_distributor_worker_stats stats;
+	struct rte_mbuf *bufs[BURST];
+	struct rte_mbuf *returns[BURST*2];
+	unsigned int i, count, handled;
+	uint64_t total = 0;
+	int failed = 0;
+	int ret;
+
+	printf("=== Worker stats test (%s) ===\n", wp->name);
+	ret = rte_distributor_worker_stats_reset(d);
+	if (ret == -ENOTSUP) {
+		if (rte_distributor_worker_stats_get(d, 0, &stats) != -ENOTSUP ||
+				rte_distributor_rebalance_set(d, 1) !=
+				-ENOTSUP) {
+			printf("Line %d: Error, stats supported\n", __LINE__);
+			return -1;
+		}
+		printf("No worker stats in single mode\n\n");
+		return 0;
+	}
+	if (ret != 0 || rte_distributor_worker_stats_get(d,
+			rte_lcore_count() - 1, &stats) != -EINVAL) {
+		printf("Line %d: Error, invalid stats parameters\n", __LINE__);
+		return -1;
+	}
+
+	clear_packet_count();
+	if (rte_mempool_get_bulk(p, (void *)bufs, BURST) != 0) {
+		printf("line %d: Error getting mbufs from pool\n", __LINE__);
+		return -1;
+	}
+	for (i = 0; i < BURST; i++)
+		bufs[i]->hash.usr = (i & 3) << 4;
+
+	count = 0;
+	while (count < BURST)
+		count += rte_distributor_process(d, &bufs[count],
+			BURST - count);
+	count = 0;
+	do {
+		rte_distributor_flush(d);
+		count += rte_distributor_returned_pkts(d, returns, BURST*2);
+	} while (count < BURST);
+
+	for (i = 0; i < rte_lcore_count() - 1; i++) {
+		rte_distributor_worker_stats_get(d, i, &stats);
+		handled = __atomic_load_n(&worker_stats[i].handled_packets,
+				__ATOMIC_RELAXED);
+		printf("Worker %u handled %u packets: %"PRIu64" pinned, "
+			"%"PRIu64" unpinned, %"PRIu64" stalls\n", i, handled,
+			stats.pinned, stats.unpinned, stats.stalls);
+		if (stats.pkts != handled ||
+				stats.pinned + stats.unpinned != handled ||
+				stats.backlog != 0) {
+			printf("Line %d: Error, wrong stats for worker %u\n",
+					__LINE__, i);
+			failed = 1;
+		}
+		total += stats.pkts;
+	}
+	if (total != BURST) {
+		printf("Line %d: Error, %"PRIu64" packets in stats, "
+				"expected %u\n", __LINE__, total, BURST);
+		failed = 1;
+	}
+
+	rte_mempool_put_bulk(p, (void *)bufs, BURST);
+
+	if (failed)
+		return -1;
+
+	printf("Worker stats test passed\n\n");
+	return 0;
+}
+
 static
 int test_error_distributor_create_name(void)
 {
@@ -813,7 +896,11 @@ test_distributor(void)
 {
 	static struct rte_distributor *ds;
 	static struct rte_distributor *db;
-	static struct rte_distributor *dist[2];
+	static struct rte_distributor *dr;
+	static struct rte_distributor *dist[3];
+	static const char * const dist_names[] = {
+		"single", "burst", "burst rebalance"
+	};
 	static struct rte_mempool *p;
 	int i;
 
@@ -847,6 +934,20 @@ test_distributor(void)
 		rte_distributor_clear_returns(db);
 	}
 
+	if (dr == NULL) {
+		dr = rte_distributor_create("Test_dist_rebal", rte_socket_id(),
+				rte_lcore_count() - 1,
+				RTE_DIST_ALG_BURST);
+		if (dr == NULL ||
+				rte_distributor_rebalance_set(dr, 1) != 0) {
+			printf("Error creating rebalancing distributor\n");
+			return -1;
+		}
+	} else {
+		rte_distributor_flush(dr);
+		rte_distributor_clear_returns(dr);
+	}
+
 	if (ds == NULL) {
 		ds = rte_distributor_create("Test_dist_single",
 				rte_socket_id(),
@@ -874,16 +975,13 @@ test_distributor(void)
 
 	dist[0] = ds;
 	dist[1] = db;
+	dist[2] = dr;
 
-	for (i = 0; i < 2; i++) {
+	for (i = 0; i < (int)RTE_DIM(dist); i++) {
 
 		worker_params.dist = dist[i];
-		if (i)
-			strlcpy(worker_params.name, "burst",
-					sizeof(worker_params.name));
-		else
-			strlcpy(worker_params.name, "single",
-					sizeof(worker_params.name));
+		strlcpy(worker_params.name, dist_names[i],
+				sizeof(worker_params.name));
 
 		rte_eal_mp_remote_launch(handle_work,
 				&worker_params, SKIP_MAIN);
@@ -891,6 +989,12 @@ test_distributor(void)
 			goto err;
 		quit_workers(&worker_params, p);
 
+		rte_eal_mp_remote_launch(handle_work,
+				&worker_params, SKIP_MAIN);
+		if (test_worker_stats(&worker_params, p) < 0)
+			goto err;
+		quit_workers(&worker_params, p);
+
 		rte_eal_mp_remote_launch(handle_work_with_free_mbufs,
 				&worker_params, SKIP_MAIN);
 		if (sanity_test_with_mbuf_alloc(&worker_params, p) < 0)
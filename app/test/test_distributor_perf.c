@@ -17,10 +17,12 @@
 #define ITER_POWER 21 /* log 2 of how many iterations we do when timing. */
 #define BURST 64
 #define BIG_BATCH 1024
+#define SLOW_WORKER_CYCLES 200 /* extra cycles per packet of a slow worker */
 
 /* static vars - zero initialized by default */
 static volatile int quit;
 static volatile unsigned worker_idx;
+static uint64_t slow_worker_cycles; /* spent per packet by worker 0 */
 
 struct worker_stats {
 	volatile unsigned handled_packets;
@@ -119,6 +121,12 @@ handle_work(void *arg)
 	num = rte_distributor_get_pkt(d, id, buf, buf, num);
 	while (!quit) {
 		worker_stats[id].handled_packets += num;
+		if (id == 0 && slow_worker_cycles != 0) {
+			const uint64_t end = rte_rdtsc() +
+					num * slow_worker_cycles;
+			while (rte_rdtsc() < end)
+				rte_pause();
+		}
 		num = rte_distributor_get_pkt(d, id, buf, buf, num);
 	}
 	worker_stats[id].handled_packets += num;
@@ -134,11 +142,13 @@ handle_work(void *arg)
 static inline int
 perf_test(struct rte_distributor *d, struct rte_mempool *p)
 {
+	struct rte_distributor_worker_stats stats;
 	unsigned int i;
 	uint64_t start, end;
 	struct rte_mbuf *bufs[BURST];
 
 	clear_packet_count();
+	rte_distributor_worker_stats_reset(d);
 	if (rte_mempool_get_bulk(p, (void *)bufs, BURST) != 0) {
 		printf("Error getting mbufs from pool\n");
 		return -1;
@@ -164,9 +174,13 @@ perf_test(struct rte_distributor *d, struct rte_mempool *p)
 			((end - start) >> ITER_POWER)/BURST);
 	rte_mempool_put_bulk(p, (void *)bufs, BURST);
 
-	for (i = 0; i < rte_lcore_count() - 1; i++)
-		printf("Worker %u handled %u packets\n", i,
+	for (i = 0; i < rte_lcore_count() - 1; i++) {
+		printf("Worker %u handled %u packets", i,
 				worker_stats[i].handled_packets);
+		if (rte_distributor_worker_stats_get(d, i, &stats) == 0)
+			printf(", %"PRIu64" stalls", stats.stalls);
+		printf("\n");
+	}
 	printf("Total packets: %u (%x)\n", total_packet_count(),
 			total_packet_count());
 	printf("=== Perf test done ===\n\n");
@@ -204,6 +218,7 @@ test_distributor_perf(void)
 {
 	static struct rte_distributor *ds;
 	static struct rte_distributor *db;
+	static struct rte_distributor *dr;
 	static struct rte_mempool *p;
 
 	if (rte_lcore_count() < 2) {
@@ -238,6 +253,19 @@ test_distributor_perf(void)
 		rte_distributor_clear_returns(db);
 	}
 
+	if (dr == NULL) {
+		dr = rte_distributor_create("Test_rebalance", rte_socket_id(),
+				rte_lcore_count() - 1,
+				RTE_DIST_ALG_BURST);
+		if (dr == NULL ||
+				rte_distributor_rebalance_set(dr, 1) != 0) {
+			printf("Error creating rebalancing distributor\n");
+			return -1;
+		}
+	} else {
+		rte_distributor_clear_returns(dr);
+	}
+
 	const unsigned nb_bufs = (511 * rte_lcore_count()) < BIG_BATCH ?
 			(BIG_BATCH * 2) - 1 : (511 * rte_lcore_count());
 	if (p == NULL) {
@@ -261,7 +289,38 @@ test_distributor_perf(void)
 		return -1;
 	quit_workers(db, p);
 
+	printf("=== Performance test of distributor (burst mode, rebalance) ===\n");
+	rte_eal_mp_remote_launch(handle_work, dr, SKIP_MAIN);
+	if (perf_test(dr, p) < 0)
+		return -1;
+	quit_workers(dr, p);
+
+	if (rte_lcore_count() < 3) {
+		printf("Not enough cores for the slow worker tests, skipping\n");
+		return 0;
+	}
+
+	/* worker 0 falls behind, the others have to take its load */
+	slow_worker_cycles = SLOW_WORKER_CYCLES;
+
+	printf("=== Performance test of distributor (burst mode, slow worker) ===\n");
+	rte_eal_mp_remote_launch(handle_work, db, SKIP_MAIN);
+	if (perf_test(db, p) < 0)
+		goto err;
+	quit_workers(db, p);
+
+	printf("=== Performance test of distributor (burst mode, rebalance, slow worker) ===\n");
+	rte_eal_mp_remote_launch(handle_work, dr, SKIP_MAIN);
+	if (perf_test(dr, p) < 0)
+		goto err;
+	quit_workers(dr, p);
+
+	slow_worker_cycles = 0;
 	return 0;
+
+err:
+	slow_worker_cycles = 0;
+	return -1;
 }
 
 REGISTER_TEST_COMMAND(distributor_perf_autotest, test_distributor_perf);
@@ -9,6 +9,7 @@
 #include <rte_random.h>
 #include <rte_debug.h>
 #include <rte_ip.h>
+#include <rte_vect.h>
 
 #include "test.h"
 
@@ -316,6 +317,106 @@ static int test_five_keys(void)
 	return 0;
 }
 
+/*
+ * Check that every lookup algorithm available returns the values added,
+ * for key lengths ending in the middle of a hash block or not and for
+ * bursts which are not a multiple of the vector width.
+ */
+static int test_lookup_algs(void)
+{
+	static const uint32_t key_lens[] = { 4, 13, 37, 48 };
+	static const enum rte_efd_lookup_alg algs[] = {
+		RTE_EFD_LOOKUP_SCALAR,
+		RTE_EFD_LOOKUP_AVX2,
+		RTE_EFD_LOOKUP_NEON,
+		RTE_EFD_LOOKUP_AVX512,
+	};
+	static uint8_t alg_keys[RTE_EFD_BURST_MAX * 8][64];
+	static efd_value_t alg_data[RTE_EFD_BURST_MAX * 8];
+	const unsigned int num_keys = RTE_DIM(alg_keys);
+	const void *key_array[RTE_EFD_BURST_MAX];
+	efd_value_t result[RTE_EFD_BURST_MAX];
+	struct rte_efd_table *handle;
+	uint16_t max_simd_bitwidth = rte_vect_get_max_simd_bitwidth();
+	unsigned int i, j, k, a, burst;
+	int ret = -1;
+
+	printf("Entering %s\n", __func__);
+
+	/* Allow the AVX512 lookup, if not limited from the command line */
+	rte_vect_set_max_simd_bitwidth(RTE_VECT_SIMD_512);
+
+	for (i = 0; i < RTE_DIM(key_lens); i++) {
+		handle = rte_efd_create("test_lookup_algs", TABLE_SIZE,
+				key_lens[i], efd_get_all_sockets_bitmask(),
+				test_socket_id);
+		if (handle == NULL) {
+			printf("Error creating the efd table\n");
+			goto exit;
+		}
+
+		for (j = 0; j < num_keys; j++) {
+			for (k = 0; k < key_lens[i]; k++)
+				alg_keys[j][k] = rte_rand() & 0xFF;
+			alg_data[j] = rte_rand() & VALUE_BITMASK;
+			if (rte_efd_update(handle, test_socket_id,
+					alg_keys[j], alg_data[j]) != 0) {
+				printf("Error inserting key %u\n", j);
+				goto free_table;
+			}
+		}
+
+		if (rte_efd_set_lookup_alg(handle, RTE_EFD_LOOKUP_AVX512 + 1) !=
+				-EINVAL) {
+			printf("Invalid lookup algorithm accepted\n");
+			goto free_table;
+		}
+
+		for (a = 0; a < RTE_DIM(algs); a++) {
+			if (rte_efd_set_lookup_alg(handle, algs[a]) != 0) {
+				if (algs[a] == RTE_EFD_LOOKUP_SCALAR) {
+					printf("Cannot select scalar lookup\n");
+					goto free_table;
+				}
+				continue;
+			}
+
+			for (j = 0; j < num_keys; j += burst) {
+				/* Alternate full bursts and odd sized ones */
+				burst = (j / RTE_EFD_BURST_MAX) & 1 ?
+						RTE_EFD_BURST_MAX - 11 :
+						RTE_EFD_BURST_MAX;
+				burst = RTE_MIN(burst, num_keys - j);
+				for (k = 0; k < burst; k++)
+					key_array[k] = alg_keys[j + k];
+				rte_efd_lookup_bulk(handle, test_socket_id,
+						burst, key_array, result);
+				for (k = 0; k < burst; k++) {
+					if (result[k] != alg_data[j + k]) {
+						printf("Algorithm %d, key length %u: key %u expected %d, got %d\n",
+							algs[a], key_lens[i],
+							j + k, alg_data[j + k],
+							result[k]);
+						goto free_table;
+					}
+				}
+			}
+			printf("Algorithm %d, key length %u: OK\n", algs[a],
+					key_lens[i]);
+		}
+
+		rte_efd_free(handle);
+	}
+	ret = 0;
+	goto exit;
+
+free_table:
+	rte_efd_free(handle);
+exit:
+	rte_vect_set_max_simd_bitwidth(max_simd_bitwidth);
+	return ret;
+}
+
 /*
  * Test to see the average table utilization (entries added/max entries)
  * before hitting a random entry that cannot be added
@@ -454,6 +555,8 @@ test_efd(void)
 		return -1;
 	if (test_five_keys() < 0)
 		return -1;
+	if (test_lookup_algs() < 0)
+		return -1;
 	if (test_efd_creation_with_bad_parameters() < 0)
 		return -1;
 	if (test_average_table_utilization() < 0)
@@ -12,6 +12,7 @@
 #include <rte_efd.h>
 #include <rte_memcpy.h>
 #include <rte_thash.h>
+#include <rte_vect.h>
 
 #include "test.h"
 
@@ -73,6 +74,20 @@ static uint32_t hashtest_key_lens[] = {
 /* Array to store number of cycles per operation */
 static uint64_t cycles[NUM_KEYSIZES][NUM_OPERATIONS];
 
+static const struct {
+	enum rte_efd_lookup_alg alg;
+	const char *name;
+} lookup_algs[] = {
+	{ RTE_EFD_LOOKUP_SCALAR, "Scalar" },
+	{ RTE_EFD_LOOKUP_AVX2, "AVX2" },
+	{ RTE_EFD_LOOKUP_NEON, "NEON" },
+	{ RTE_EFD_LOOKUP_AVX512, "AVX512" },
+};
+#define NUM_LOOKUP_ALGS RTE_DIM(lookup_algs)
+
+/* Array to store number of cycles per bulk lookup, 0 if not supported */
+static uint64_t alg_cycles[NUM_KEYSIZES][NUM_LOOKUP_ALGS];
+
 /* Array to store the data */
 static efd_value_t data[KEYS_TO_ADD];
 
@@ -270,6 +285,29 @@ timed_lookups_multi(struct efd_perf_params *params)
 	return 0;
 }
 
+/* Bulk lookups with each algorithm supported, then back to the default */
+static int
+timed_lookups_algs(struct efd_perf_params *params)
+{
+	uint64_t default_cycles = cycles[params->cycle][LOOKUP_MULTI];
+	unsigned int i;
+
+	for (i = 0; i < NUM_LOOKUP_ALGS; i++) {
+		alg_cycles[params->cycle][i] = 0;
+		if (rte_efd_set_lookup_alg(params->efd_table,
+				lookup_algs[i].alg) != 0)
+			continue;
+		if (timed_lookups_multi(params) < 0)
+			return -1;
+		alg_cycles[params->cycle][i] =
+				cycles[params->cycle][LOOKUP_MULTI];
+	}
+
+	cycles[params->cycle][LOOKUP_MULTI] = default_cycles;
+	return rte_efd_set_lookup_alg(params->efd_table,
+			RTE_EFD_LOOKUP_DEFAULT);
+}
+
 static int
 timed_deletes(struct efd_perf_params *params)
 {
@@ -349,6 +387,9 @@ run_all_tbl_perf_tests(void)
 		if (timed_lookups_multi(&params) < 0)
 			return exit_with_fail("timed_lookups_multi", &params, i);
 
+		if (timed_lookups_algs(&params) < 0)
+			return exit_with_fail("timed_lookups_algs", &params, i);
+
 		if (timed_deletes(&params) < 0)
 			return exit_with_fail("timed_deletes", &params, i);
 
@@ -369,17 +410,38 @@ run_all_tbl_perf_tests(void)
 			printf("%-18"PRIu64, cycles[i][j]);
 		printf("\n");
 	}
+
+	printf("\nLookup_bulk per algorithm (in CPU cycles/key)\n");
+	printf("---------------------------------------------\n");
+	printf("\n%-18s", "Keysize");
+	for (j = 0; j < NUM_LOOKUP_ALGS; j++)
+		printf("%-18s", lookup_algs[j].name);
+	printf("\n");
+	for (i = 0; i < NUM_KEYSIZES; i++) {
+		printf("%-18d", hashtest_key_lens[i]);
+		for (j = 0; j < NUM_LOOKUP_ALGS; j++) {
+			if (alg_cycles[i][j] == 0)
+				printf("%-18s", "n/a");
+			else
+				printf("%-18"PRIu64, alg_cycles[i][j]);
+		}
+		printf("\n");
+	}
 	return 0;
 }
 
 static int
 test_efd_perf(void)
 {
+	uint16_t max_simd_bitwidth = rte_vect_get_max_simd_bitwidth();
+	int ret;
 
-	if (run_all_tbl_perf_tests() < 0)
-		return -1;
+	/* Allow the AVX512 lookup, if not limited from the command line */
+	rte_vect_set_max_simd_bitwidth(RTE_VECT_SIMD_512);
+	ret = run_all_tbl_perf_tests();
+	rte_vect_set_max_simd_bitwidth(max_simd_bitwidth);
 
-	return 0;
+	return ret < 0 ? -1 : 0;
 }
 
 REGISTER_TEST_COMMAND(efd_perf_autotest, test_efd_perf);
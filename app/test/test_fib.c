@@ -9,6 +9,9 @@
 
 #include <rte_ip.h>
 #include <rte_log.h>
+#include <rte_malloc.h>
+#include <rte_random.h>
+#include <rte_rib.h>
 #include <rte_fib.h>
 
 #include "test.h"
@@ -21,6 +24,12 @@ static int32_t test_free_null(void);
 static int32_t test_add_del_invalid(void);
 static int32_t test_get_invalid(void);
 static int32_t test_lookup(void);
+static int32_t test_invalid_rcu(void);
+static int32_t test_fib_rcu_sync_rw(void);
+static int32_t test_invalid_update(void);
+static int32_t test_update_commit(void);
+static int32_t test_update_tbl8(void);
+static int32_t test_update_tbl8_exhausted(void);
 
 #define MAX_ROUTES	(1 << 16)
 #define MAX_TBL8	(1 << 15)
@@ -376,6 +385,632 @@ test_lookup(void)
 	return TEST_SUCCESS;
 }
 
+/*
+ * rte_fib_rcu_qsbr_add positive and negative tests.
+ *  - Add RCU QSBR variable to FIB
+ *  - Add another RCU QSBR variable to FIB
+ *  - Check returns
+ */
+int32_t
+test_invalid_rcu(void)
+{
+	struct rte_fib *fib = NULL;
+	struct rte_fib_conf config;
+	size_t sz;
+	struct rte_rcu_qsbr *qsv;
+	struct rte_rcu_qsbr *qsv2;
+	int32_t status;
+	struct rte_fib_rcu_config rcu_cfg = {0};
+	uint64_t def_nh = 100;
+
+	config.max_routes = MAX_ROUTES;
+	config.rib_ext_sz = 0;
+	config.default_nh = def_nh;
+	config.type = RTE_FIB_DUMMY;
+
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	/* Create RCU QSBR variable */
+	sz = rte_rcu_qsbr_get_memsize(RTE_MAX_LCORE);
+	qsv = (struct rte_rcu_qsbr *)rte_zmalloc_socket(NULL, sz,
+		RTE_CACHE_LINE_SIZE, SOCKET_ID_ANY);
+	RTE_TEST_ASSERT(qsv != NULL, "Can not allocate memory for RCU\n");
+
+	status = rte_rcu_qsbr_init(qsv, RTE_MAX_LCORE);
+	RTE_TEST_ASSERT(status == 0, "Can not initialize RCU\n");
+
+	rcu_cfg.v = qsv;
+
+	/* Not supported by the DUMMY type */
+	status = rte_fib_rcu_qsbr_add(fib, &rcu_cfg);
+	RTE_TEST_ASSERT(status == -ENOTSUP,
+		"rte_fib_rcu_qsbr_add returned wrong status\n");
+	rte_fib_free(fib);
+
+	config.type = RTE_FIB_DIR24_8;
+	config.dir24_8.nh_sz = RTE_FIB_DIR24_8_4B;
+	config.dir24_8.num_tbl8 = MAX_TBL8;
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	/* Call rte_fib_rcu_qsbr_add without fib or config */
+	status = rte_fib_rcu_qsbr_add(NULL, &rcu_cfg);
+	RTE_TEST_ASSERT(status == -EINVAL,
+		"RCU added without fib\n");
+	status = rte_fib_rcu_qsbr_add(fib, NULL);
+	RTE_TEST_ASSERT(status == -EINVAL,
+		"RCU added without config\n");
+
+	/* Invalid QSBR mode */
+	rcu_cfg.mode = 2;
+	status = rte_fib_rcu_qsbr_add(fib, &rcu_cfg);
+	RTE_TEST_ASSERT(status == -EINVAL,
+		"RCU added with incorrect mode\n");
+
+	rcu_cfg.mode = RTE_FIB_QSBR_MODE_DQ;
+
+	/* Attach RCU QSBR to FIB */
+	status = rte_fib_rcu_qsbr_add(fib, &rcu_cfg);
+	RTE_TEST_ASSERT(status == 0, "Can not attach RCU to FIB\n");
+
+	/* Create and attach another RCU QSBR to FIB table */
+	qsv2 = (struct rte_rcu_qsbr *)rte_zmalloc_socket(NULL, sz,
+		RTE_CACHE_LINE_SIZE, SOCKET_ID_ANY);
+	RTE_TEST_ASSERT(qsv2 != NULL, "Can not allocate memory for RCU\n");
+
+	rcu_cfg.v = qsv2;
+	rcu_cfg.mode = RTE_FIB_QSBR_MODE_SYNC;
+	status = rte_fib_rcu_qsbr_add(fib, &rcu_cfg);
+	RTE_TEST_ASSERT(status == -EEXIST, "Secondary RCU was mistakenly attached\n");
+
+	rte_fib_free(fib);
+	rte_free(qsv);
+	rte_free(qsv2);
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * rte_fib_rcu_qsbr_add DQ mode functional test.
+ * Reader and writer are in the same thread in this test.
+ *  - Create FIB which supports 64 tbl8 groups
+ *  - Add RCU QSBR variable to FIB
+ *  - Add a route with depth=28 (> 24)
+ *  - Register a reader thread (not a real thread)
+ *  - Writer delete the route, its tbl8 group is deferred
+ *  - Writer add routes in the other 63 groups
+ *  - Writer add a route (no available tbl8 group)
+ *  - Reader report quiescent state
+ *  - Writer add the route
+ *  - Reader lookup the route
+ */
+int32_t
+test_fib_rcu_sync_rw(void)
+{
+	struct rte_fib *fib = NULL;
+	struct rte_fib_conf config;
+	size_t sz;
+	struct rte_rcu_qsbr *qsv;
+	int32_t status;
+	uint32_t i, ip = RTE_IPV4(192, 0, 2, 100);
+	uint8_t depth = 28;
+	uint64_t def_nh = 100, next_hop = 1, next_hop_return;
+	struct rte_fib_rcu_config rcu_cfg = {0};
+
+	config.max_routes = MAX_ROUTES;
+	config.rib_ext_sz = 0;
+	config.default_nh = def_nh;
+	config.type = RTE_FIB_DIR24_8;
+	config.dir24_8.nh_sz = RTE_FIB_DIR24_8_4B;
+	config.dir24_8.num_tbl8 = 64;
+
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	/* Create RCU QSBR variable */
+	sz = rte_rcu_qsbr_get_memsize(1);
+	qsv = (struct rte_rcu_qsbr *)rte_zmalloc_socket(NULL, sz,
+		RTE_CACHE_LINE_SIZE, SOCKET_ID_ANY);
+	RTE_TEST_ASSERT(qsv != NULL, "Can not allocate memory for RCU\n");
+
+	status = rte_rcu_qsbr_init(qsv, 1);
+	RTE_TEST_ASSERT(status == 0, "Can not initialize RCU\n");
+
+	rcu_cfg.v = qsv;
+	rcu_cfg.mode = RTE_FIB_QSBR_MODE_DQ;
+	/* Attach RCU QSBR to FIB table */
+	status = rte_fib_rcu_qsbr_add(fib, &rcu_cfg);
+	RTE_TEST_ASSERT(status == 0, "Can not attach RCU to FIB\n");
+
+	status = rte_fib_add(fib, ip, depth, next_hop);
+	RTE_TEST_ASSERT(status == 0, "Failed to add a route\n");
+
+	/* Register pseudo reader */
+	status = rte_rcu_qsbr_thread_register(qsv, 0);
+	RTE_TEST_ASSERT(status == 0, "Can not register RCU thread\n");
+	rte_rcu_qsbr_thread_online(qsv, 0);
+
+	status = rte_fib_lookup_bulk(fib, &ip, &next_hop_return, 1);
+	RTE_TEST_ASSERT((status == 0) && (next_hop_return == next_hop),
+		"Failed to get proper nexthop\n");
+
+	/* Writer update */
+	status = rte_fib_delete(fib, ip, depth);
+	RTE_TEST_ASSERT(status == 0, "Failed to delete a route\n");
+
+	status = rte_fib_lookup_bulk(fib, &ip, &next_hop_return, 1);
+	RTE_TEST_ASSERT((status == 0) && (next_hop_return == def_nh),
+		"Failed to get proper nexthop\n");
+
+	/* All the other tbl8 groups */
+	for (i = 1; i < 64; i++) {
+		status = rte_fib_add(fib, ip + (i << 8), depth, next_hop);
+		RTE_TEST_ASSERT(status == 0, "Failed to add a route\n");
+	}
+
+	/* The deleted group is not reusable yet */
+	status = rte_fib_add(fib, ip, depth, next_hop);
+	RTE_TEST_ASSERT(status != 0, "Added a route to a deferred group\n");
+
+	/* Reader quiescent */
+	rte_rcu_qsbr_quiescent(qsv, 0);
+
+	status = rte_fib_add(fib, ip, depth, next_hop);
+	RTE_TEST_ASSERT(status == 0, "Failed to add a route\n");
+
+	rte_rcu_qsbr_thread_offline(qsv, 0);
+	status = rte_rcu_qsbr_thread_unregister(qsv, 0);
+	RTE_TEST_ASSERT(status == 0, "Can not unregister RCU thread\n");
+
+	status = rte_fib_lookup_bulk(fib, &ip, &next_hop_return, 1);
+	RTE_TEST_ASSERT((status == 0) && (next_hop_return == next_hop),
+		"Failed to get proper nexthop\n");
+
+	rte_fib_free(fib);
+	rte_free(qsv);
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Check the update transaction calls with incorrect arguments
+ */
+int32_t
+test_invalid_update(void)
+{
+	struct rte_fib *fib = NULL;
+	struct rte_fib_conf config;
+	uint32_t ip = RTE_IPV4(192, 0, 2, 0);
+	uint8_t depth = 24;
+	uint64_t next_hop = 1, next_hop_return;
+	int ret;
+
+	config.max_routes = MAX_ROUTES;
+	config.rib_ext_sz = 0;
+	config.default_nh = 0;
+	config.type = RTE_FIB_DUMMY;
+
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	ret = rte_fib_update_begin(NULL);
+	RTE_TEST_ASSERT(ret == -EINVAL, "Transaction started without fib\n");
+	ret = rte_fib_update_commit(NULL);
+	RTE_TEST_ASSERT(ret == -EINVAL, "Transaction committed without fib\n");
+
+	/* Not supported by the DUMMY type, bulk calls still work */
+	ret = rte_fib_update_begin(fib);
+	RTE_TEST_ASSERT(ret == -ENOTSUP,
+		"rte_fib_update_begin returned wrong status\n");
+	ret = rte_fib_add_bulk(fib, &ip, &depth, &next_hop, 1);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add routes\n");
+	ret = rte_fib_lookup_bulk(fib, &ip, &next_hop_return, 1);
+	RTE_TEST_ASSERT((ret == 0) && (next_hop_return == next_hop),
+		"Failed to get proper nexthop\n");
+	ret = rte_fib_delete_bulk(fib, &ip, &depth, 1);
+	RTE_TEST_ASSERT(ret == 0, "Failed to delete routes\n");
+	rte_fib_free(fib);
+
+	config.type = RTE_FIB_DIR24_8;
+	config.dir24_8.nh_sz = RTE_FIB_DIR24_8_4B;
+	config.dir24_8.num_tbl8 = 16;
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	ret = rte_fib_update_commit(fib);
+	RTE_TEST_ASSERT(ret == -EINVAL, "Committed without transaction\n");
+	ret = rte_fib_add_bulk(NULL, &ip, &depth, &next_hop, 1);
+	RTE_TEST_ASSERT(ret < 0, "Routes added without fib\n");
+	ret = rte_fib_add_bulk(fib, &ip, &depth, NULL, 1);
+	RTE_TEST_ASSERT(ret < 0, "Routes added without next hops\n");
+
+	ret = rte_fib_update_begin(fib);
+	RTE_TEST_ASSERT(ret == 0, "Failed to start transaction\n");
+	ret = rte_fib_update_begin(fib);
+	RTE_TEST_ASSERT(ret == -EBUSY, "Nested transaction started\n");
+
+	/* Lookups return the old next hops until the commit */
+	ret = rte_fib_add(fib, ip, depth, next_hop);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+	ret = rte_fib_lookup_bulk(fib, &ip, &next_hop_return, 1);
+	RTE_TEST_ASSERT((ret == 0) && (next_hop_return == 0),
+		"Route applied before the commit\n");
+
+	/* A bulk call within a transaction does not commit it */
+	ip++;
+	depth = 32;
+	next_hop++;
+	ret = rte_fib_add_bulk(fib, &ip, &depth, &next_hop, 1);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add routes\n");
+	ret = rte_fib_lookup_bulk(fib, &ip, &next_hop_return, 1);
+	RTE_TEST_ASSERT((ret == 0) && (next_hop_return == 0),
+		"Route applied before the commit\n");
+
+	ret = rte_fib_update_commit(fib);
+	RTE_TEST_ASSERT(ret == 0, "Failed to commit transaction\n");
+	ret = rte_fib_lookup_bulk(fib, &ip, &next_hop_return, 1);
+	RTE_TEST_ASSERT((ret == 0) && (next_hop_return == next_hop),
+		"Failed to get proper nexthop\n");
+	ip--;
+	ret = rte_fib_lookup_bulk(fib, &ip, &next_hop_return, 1);
+	RTE_TEST_ASSERT((ret == 0) && (next_hop_return == next_hop - 1),
+		"Failed to get proper nexthop\n");
+
+	rte_fib_free(fib);
+
+	return TEST_SUCCESS;
+}
+
+#define UPDATE_ROUTES	1024
+#define UPDATE_LOOKUPS	(1 << 14)
+
+/* Compare the next hops of both FIBs around the routes and at random */
+static int
+check_same_lookups(struct rte_fib *fib, struct rte_fib *ref,
+	const uint32_t *ips, const uint8_t *depths, unsigned int n)
+{
+	static uint32_t lookup_ips[UPDATE_LOOKUPS];
+	static uint64_t nh[UPDATE_LOOKUPS], ref_nh[UPDATE_LOOKUPS];
+	unsigned int i, k = 0;
+
+	for (i = 0; i < n; i++) {
+		lookup_ips[k++] = ips[i];
+		lookup_ips[k++] = ips[i] - 1;
+		lookup_ips[k++] = ips[i] +
+			(uint32_t)(1ULL << (32 - depths[i])) - 1;
+		lookup_ips[k++] = ips[i] + (uint32_t)(1ULL << (32 - depths[i]));
+	}
+	while (k < UPDATE_LOOKUPS)
+		lookup_ips[k++] = RTE_IPV4(10, 0, 0, 0) |
+			(rte_rand() & 0xfffff);
+
+	rte_fib_lookup_bulk(fib, lookup_ips, nh, UPDATE_LOOKUPS);
+	rte_fib_lookup_bulk(ref, lookup_ips, ref_nh, UPDATE_LOOKUPS);
+	for (i = 0; i < UPDATE_LOOKUPS; i++) {
+		if (nh[i] != ref_nh[i]) {
+			printf("Next hop %"PRIu64" instead of %"PRIu64
+				" for %08x\n", nh[i], ref_nh[i],
+				lookup_ips[i]);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/*
+ * Apply overlapping updates in transactions and check that the result
+ * is the same as when applying them one by one
+ */
+int32_t
+test_update_commit(void)
+{
+	static uint32_t ips[UPDATE_ROUTES];
+	static uint8_t depths[UPDATE_ROUTES];
+	static uint64_t next_hops[UPDATE_ROUTES];
+	struct rte_fib *fib, *ref;
+	struct rte_fib_conf config;
+	unsigned int i;
+	int ret;
+
+	config.max_routes = MAX_ROUTES;
+	config.rib_ext_sz = 0;
+	config.default_nh = 0;
+	config.type = RTE_FIB_DIR24_8;
+	config.dir24_8.nh_sz = RTE_FIB_DIR24_8_4B;
+	config.dir24_8.num_tbl8 = UPDATE_ROUTES;
+
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+	ref = rte_fib_create("test_update_commit_ref", SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(ref != NULL, "Failed to create FIB\n");
+
+	/* Nested prefixes from /8 to /32 within 10.0.0.0/12 */
+	for (i = 0; i < UPDATE_ROUTES; i++) {
+		depths[i] = 8 + rte_rand_max(25);
+		ips[i] = (RTE_IPV4(10, 0, 0, 0) | (rte_rand() & 0xfffff)) &
+			(uint32_t)(UINT64_MAX << (32 - depths[i]));
+		next_hops[i] = i + 1;
+	}
+
+	/* Full load in an implicit transaction */
+	ret = rte_fib_add_bulk(fib, ips, depths, next_hops, UPDATE_ROUTES);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add routes\n");
+	for (i = 0; i < UPDATE_ROUTES; i++) {
+		ret = rte_fib_add(ref, ips[i], depths[i], next_hops[i]);
+		RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+	}
+	RTE_TEST_ASSERT(check_same_lookups(fib, ref, ips, depths,
+		UPDATE_ROUTES) == 0, "Lookups differ after the load\n");
+
+	/* Delete, re-add and change routes in one explicit transaction */
+	ret = rte_fib_update_begin(fib);
+	RTE_TEST_ASSERT(ret == 0, "Failed to start transaction\n");
+	for (i = 0; i < UPDATE_ROUTES; i++) {
+		if (i % 3 == 0) {
+			rte_fib_delete(fib, ips[i], depths[i]);
+			rte_fib_delete(ref, ips[i], depths[i]);
+		}
+		if (i % 5 == 0) {
+			next_hops[i] += UPDATE_ROUTES;
+			ret = rte_fib_add(fib, ips[i], depths[i],
+				next_hops[i]);
+			RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+			ret = rte_fib_add(ref, ips[i], depths[i],
+				next_hops[i]);
+			RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+		}
+	}
+	ret = rte_fib_update_commit(fib);
+	RTE_TEST_ASSERT(ret == 0, "Failed to commit transaction\n");
+	RTE_TEST_ASSERT(check_same_lookups(fib, ref, ips, depths,
+		UPDATE_ROUTES) == 0, "Lookups differ after the update\n");
+
+	/* Stop at the first missing route, then delete everything */
+	ret = rte_fib_delete_bulk(fib, ips, depths, UPDATE_ROUTES);
+	RTE_TEST_ASSERT(ret == -ENOENT, "Deleted a missing route\n");
+	for (i = 0; i < UPDATE_ROUTES; i++)
+		rte_fib_delete(fib, ips[i], depths[i]);
+	for (i = 0; i < UPDATE_ROUTES; i++)
+		rte_fib_delete(ref, ips[i], depths[i]);
+	RTE_TEST_ASSERT(check_same_lookups(fib, ref, ips, depths,
+		UPDATE_ROUTES) == 0, "Lookups differ after the delete\n");
+
+	rte_fib_free(fib);
+	rte_fib_free(ref);
+
+	return TEST_SUCCESS;
+}
+
+#define UPDATE_TBL8	64
+
+/*
+ * Check that a transaction removing the routes of tbl8 groups along
+ * with their covering route releases the groups
+ */
+int32_t
+test_update_tbl8(void)
+{
+	uint32_t ips[UPDATE_TBL8 + 1];
+	uint8_t depths[UPDATE_TBL8 + 1];
+	uint64_t next_hops[UPDATE_TBL8 + 1];
+	uint64_t nh;
+	struct rte_fib *fib;
+	struct rte_fib_conf config;
+	unsigned int i;
+	int ret;
+
+	config.max_routes = MAX_ROUTES;
+	config.rib_ext_sz = 0;
+	config.default_nh = 0;
+	config.type = RTE_FIB_DIR24_8;
+	config.dir24_8.nh_sz = RTE_FIB_DIR24_8_4B;
+	config.dir24_8.num_tbl8 = UPDATE_TBL8;
+
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	/* A /28 in each /24 of a /16, using all the tbl8 groups */
+	for (i = 0; i < UPDATE_TBL8; i++) {
+		ips[i] = RTE_IPV4(10, 0, i, 16);
+		depths[i] = 28;
+		next_hops[i] = 2;
+	}
+	ips[i] = RTE_IPV4(10, 0, 0, 0);
+	depths[i] = 16;
+	next_hops[i] = 1;
+	ret = rte_fib_add_bulk(fib, ips, depths, next_hops, UPDATE_TBL8 + 1);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add routes\n");
+
+	ret = rte_fib_delete_bulk(fib, ips, depths, UPDATE_TBL8 + 1);
+	RTE_TEST_ASSERT(ret == 0, "Failed to delete routes\n");
+
+	/* Same in another /16, without the groups of the first one left */
+	for (i = 0; i < UPDATE_TBL8; i++)
+		ips[i] = RTE_IPV4(10, 1, i, 16);
+	ret = rte_fib_add_bulk(fib, ips, depths, next_hops, UPDATE_TBL8);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add routes\n");
+
+	for (i = 0; i < UPDATE_TBL8; i++) {
+		ret = rte_fib_lookup_bulk(fib, &ips[i], &nh, 1);
+		RTE_TEST_ASSERT((ret == 0) && (nh == 2),
+			"Wrong next hop after the update\n");
+		ips[i] = RTE_IPV4(10, 0, i, 16);
+		ret = rte_fib_lookup_bulk(fib, &ips[i], &nh, 1);
+		RTE_TEST_ASSERT((ret == 0) && (nh == 0),
+			"Wrong next hop after the update\n");
+	}
+
+	rte_fib_free(fib);
+
+	return TEST_SUCCESS;
+}
+
+#define EXHAUST_TBL8	64
+
+/* Add or delete a /28 route in each /24 of a /16 */
+static int
+exhaust_routes(struct rte_fib *fib, uint8_t b, int add, int bulk)
+{
+	uint32_t ips[EXHAUST_TBL8];
+	uint8_t depths[EXHAUST_TBL8];
+	uint64_t next_hops[EXHAUST_TBL8];
+	unsigned int i;
+	int ret = 0;
+
+	for (i = 0; i < EXHAUST_TBL8; i++) {
+		ips[i] = RTE_IPV4(10, b, i, 16);
+		depths[i] = 28;
+		next_hops[i] = b;
+	}
+	if (bulk)
+		return add ? rte_fib_add_bulk(fib, ips, depths, next_hops,
+				EXHAUST_TBL8) :
+			rte_fib_delete_bulk(fib, ips, depths, EXHAUST_TBL8);
+	for (i = 0; (i < EXHAUST_TBL8) && (ret == 0); i++)
+		ret = add ? rte_fib_add(fib, ips[i], depths[i], next_hops[i]) :
+			rte_fib_delete(fib, ips[i], depths[i]);
+	return ret;
+}
+
+/* Check the next hops of the routes of exhaust_routes() */
+static int
+exhaust_lookup(struct rte_fib *fib, uint8_t b, uint64_t next_hop)
+{
+	uint32_t ips[EXHAUST_TBL8];
+	uint64_t nhs[EXHAUST_TBL8];
+	unsigned int i;
+
+	for (i = 0; i < EXHAUST_TBL8; i++)
+		ips[i] = RTE_IPV4(10, b, i, 16);
+	rte_fib_lookup_bulk(fib, ips, nhs, EXHAUST_TBL8);
+	for (i = 0; i < EXHAUST_TBL8; i++)
+		if (nhs[i] != next_hop)
+			return -1;
+	return 0;
+}
+
+/* Count the routes of exhaust_routes() in the RIB */
+static unsigned int
+exhaust_in_rib(struct rte_fib *fib, uint8_t b)
+{
+	struct rte_rib *rib = rte_fib_get_rib(fib);
+	unsigned int i, n = 0;
+
+	for (i = 0; i < EXHAUST_TBL8; i++)
+		if (rte_rib_lookup_exact(rib, RTE_IPV4(10, b, i, 16),
+				28) != NULL)
+			n++;
+	return n;
+}
+
+/*
+ * Run out of tbl8 groups, held by the RCU defer queue, during commits:
+ * an explicit transaction fails with the dataplane unchanged and stays
+ * in progress, a bulk call rolls its own transaction back.
+ */
+int32_t
+test_update_tbl8_exhausted(void)
+{
+	struct rte_fib *fib;
+	struct rte_fib_conf config;
+	struct rte_fib_rcu_config rcu_cfg = {0};
+	struct rte_rcu_qsbr *qsv;
+	uint32_t ip = RTE_IPV4(10, 4, 0, 1);
+	uint32_t ips[2];
+	uint8_t depths[2];
+	uint64_t nh;
+	size_t sz;
+	int ret;
+
+	config.max_routes = MAX_ROUTES;
+	config.rib_ext_sz = 0;
+	config.default_nh = 0;
+	config.type = RTE_FIB_DIR24_8;
+	config.dir24_8.nh_sz = RTE_FIB_DIR24_8_4B;
+	config.dir24_8.num_tbl8 = EXHAUST_TBL8;
+
+	/* The name of the RIB mempool is too long with __func__ */
+	fib = rte_fib_create("test_tbl8_exhausted", SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	sz = rte_rcu_qsbr_get_memsize(1);
+	qsv = (struct rte_rcu_qsbr *)rte_zmalloc_socket(NULL, sz,
+		RTE_CACHE_LINE_SIZE, SOCKET_ID_ANY);
+	RTE_TEST_ASSERT(qsv != NULL, "Can not allocate memory for RCU\n");
+	ret = rte_rcu_qsbr_init(qsv, 1);
+	RTE_TEST_ASSERT(ret == 0, "Can not initialize RCU\n");
+	rcu_cfg.v = qsv;
+	rcu_cfg.mode = RTE_FIB_QSBR_MODE_DQ;
+	ret = rte_fib_rcu_qsbr_add(fib, &rcu_cfg);
+	RTE_TEST_ASSERT(ret == 0, "Can not attach RCU to FIB\n");
+
+	/* Pseudo reader holding the groups of the deleted routes */
+	ret = rte_rcu_qsbr_thread_register(qsv, 0);
+	RTE_TEST_ASSERT(ret == 0, "Can not register RCU thread\n");
+	rte_rcu_qsbr_thread_online(qsv, 0);
+
+	RTE_TEST_ASSERT(exhaust_routes(fib, 1, 1, 0) == 0,
+		"Failed to add routes\n");
+	RTE_TEST_ASSERT(exhaust_routes(fib, 1, 0, 0) == 0,
+		"Failed to delete routes\n");
+
+	ret = rte_fib_update_begin(fib);
+	RTE_TEST_ASSERT(ret == 0, "Failed to start transaction\n");
+	RTE_TEST_ASSERT(exhaust_routes(fib, 2, 1, 0) == 0,
+		"Failed to add routes\n");
+	ret = rte_fib_update_commit(fib);
+	RTE_TEST_ASSERT(ret == -ENOSPC, "Committed without tbl8 groups\n");
+	RTE_TEST_ASSERT(exhaust_lookup(fib, 2, 0) == 0,
+		"Dataplane changed by a failed commit\n");
+	ret = rte_fib_update_begin(fib);
+	RTE_TEST_ASSERT(ret == -EBUSY, "Failed commit ended transaction\n");
+
+	/* Retried once the groups are reclaimed */
+	rte_rcu_qsbr_quiescent(qsv, 0);
+	ret = rte_fib_update_commit(fib);
+	RTE_TEST_ASSERT(ret == 0, "Failed to commit transaction\n");
+	RTE_TEST_ASSERT(exhaust_lookup(fib, 2, 2) == 0,
+		"Wrong next hop after the commit\n");
+
+	RTE_TEST_ASSERT(exhaust_routes(fib, 2, 0, 0) == 0,
+		"Failed to delete routes\n");
+	ret = exhaust_routes(fib, 3, 1, 1);
+	RTE_TEST_ASSERT(ret == -ENOSPC, "Bulk add without tbl8 groups\n");
+	RTE_TEST_ASSERT(exhaust_in_rib(fib, 3) == 0,
+		"Routes of a failed bulk add left in the RIB\n");
+	RTE_TEST_ASSERT(exhaust_lookup(fib, 3, 0) == 0,
+		"Dataplane changed by a failed bulk add\n");
+
+	/* The following updates reach the dataplane */
+	ret = rte_fib_add(fib, ip, 16, 4);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+	ret = rte_fib_lookup_bulk(fib, &ip, &nh, 1);
+	RTE_TEST_ASSERT((ret == 0) && (nh == 4),
+		"Update after a failed bulk add not applied\n");
+
+	/* A bulk delete stopping at a missing route deletes nothing */
+	ips[0] = ip;
+	ips[1] = RTE_IPV4(10, 5, 0, 0);
+	depths[0] = depths[1] = 16;
+	ret = rte_fib_delete_bulk(fib, ips, depths, 2);
+	RTE_TEST_ASSERT(ret == -ENOENT, "Deleted a missing route\n");
+	RTE_TEST_ASSERT(rte_rib_lookup_exact(rte_fib_get_rib(fib), ip,
+		16) != NULL, "Route of a failed bulk delete removed\n");
+	ret = rte_fib_lookup_bulk(fib, &ip, &nh, 1);
+	RTE_TEST_ASSERT((ret == 0) && (nh == 4),
+		"Dataplane changed by a failed bulk delete\n");
+
+	rte_rcu_qsbr_thread_offline(qsv, 0);
+	ret = rte_rcu_qsbr_thread_unregister(qsv, 0);
+	RTE_TEST_ASSERT(ret == 0, "Can not unregister RCU thread\n");
+
+	rte_fib_free(fib);
+	rte_free(qsv);
+
+	return TEST_SUCCESS;
+}
+
 static struct unit_test_suite fib_fast_tests = {
 	.suite_name = "fib autotest",
 	.setup = NULL,
@@ -386,6 +1021,12 @@ static struct unit_test_suite fib_fast_tests = {
 	TEST_CASE(test_add_del_invalid),
 	TEST_CASE(test_get_invalid),
 	TEST_CASE(test_lookup),
+	TEST_CASE(test_invalid_rcu),
+	TEST_CASE(test_fib_rcu_sync_rw),
+	TEST_CASE(test_invalid_update),
+	TEST_CASE(test_update_commit),
+	TEST_CASE(test_update_tbl8),
+	TEST_CASE(test_update_tbl8_exhausted),
 	TEST_CASES_END()
 	}
 };
@@ -9,6 +9,8 @@
 
 #include <rte_memory.h>
 #include <rte_log.h>
+#include <rte_malloc.h>
+#include <rte_random.h>
 #include <rte_rib6.h>
 #include <rte_fib6.h>
 
@@ -22,6 +24,10 @@ static int32_t test_free_null(void);
 static int32_t test_add_del_invalid(void);
 static int32_t test_get_invalid(void);
 static int32_t test_lookup(void);
+static int32_t test_invalid_rcu(void);
+static int32_t test_fib6_rcu_sync_rw(void);
+static int32_t test_update_commit(void);
+static int32_t test_update_tbl8_exhausted(void);
 
 #define MAX_ROUTES	(1 << 16)
 /** Maximum number of tbl8 for 2-byte entries */
@@ -385,6 +391,533 @@ test_lookup(void)
 	return TEST_SUCCESS;
 }
 
+/*
+ * rte_fib6_rcu_qsbr_add positive and negative tests.
+ *  - Add RCU QSBR variable to FIB
+ *  - Add another RCU QSBR variable to FIB
+ *  - Check returns
+ */
+int32_t
+test_invalid_rcu(void)
+{
+	struct rte_fib6 *fib = NULL;
+	struct rte_fib6_conf config;
+	size_t sz;
+	struct rte_rcu_qsbr *qsv;
+	struct rte_rcu_qsbr *qsv2;
+	int32_t status;
+	struct rte_fib6_rcu_config rcu_cfg = {0};
+	uint64_t def_nh = 100;
+
+	config.max_routes = MAX_ROUTES;
+	config.rib_ext_sz = 0;
+	config.default_nh = def_nh;
+	config.type = RTE_FIB6_DUMMY;
+
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	/* Create RCU QSBR variable */
+	sz = rte_rcu_qsbr_get_memsize(RTE_MAX_LCORE);
+	qsv = (struct rte_rcu_qsbr *)rte_zmalloc_socket(NULL, sz,
+		RTE_CACHE_LINE_SIZE, SOCKET_ID_ANY);
+	RTE_TEST_ASSERT(qsv != NULL, "Can not allocate memory for RCU\n");
+
+	status = rte_rcu_qsbr_init(qsv, RTE_MAX_LCORE);
+	RTE_TEST_ASSERT(status == 0, "Can not initialize RCU\n");
+
+	rcu_cfg.v = qsv;
+
+	/* Not supported by the DUMMY type */
+	status = rte_fib6_rcu_qsbr_add(fib, &rcu_cfg);
+	RTE_TEST_ASSERT(status == -ENOTSUP,
+		"rte_fib6_rcu_qsbr_add returned wrong status\n");
+	rte_fib6_free(fib);
+
+	config.type = RTE_FIB6_TRIE;
+	config.trie.nh_sz = RTE_FIB6_TRIE_4B;
+	config.trie.num_tbl8 = MAX_TBL8;
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	/* Call rte_fib6_rcu_qsbr_add without fib or config */
+	status = rte_fib6_rcu_qsbr_add(NULL, &rcu_cfg);
+	RTE_TEST_ASSERT(status == -EINVAL,
+		"RCU added without fib\n");
+	status = rte_fib6_rcu_qsbr_add(fib, NULL);
+	RTE_TEST_ASSERT(status == -EINVAL,
+		"RCU added without config\n");
+
+	/* Invalid QSBR mode */
+	rcu_cfg.mode = 2;
+	status = rte_fib6_rcu_qsbr_add(fib, &rcu_cfg);
+	RTE_TEST_ASSERT(status == -EINVAL,
+		"RCU added with incorrect mode\n");
+
+	rcu_cfg.mode = RTE_FIB6_QSBR_MODE_DQ;
+
+	/* Attach RCU QSBR to FIB */
+	status = rte_fib6_rcu_qsbr_add(fib, &rcu_cfg);
+	RTE_TEST_ASSERT(status == 0, "Can not attach RCU to FIB\n");
+
+	/* Create and attach another RCU QSBR to FIB table */
+	qsv2 = (struct rte_rcu_qsbr *)rte_zmalloc_socket(NULL, sz,
+		RTE_CACHE_LINE_SIZE, SOCKET_ID_ANY);
+	RTE_TEST_ASSERT(qsv2 != NULL, "Can not allocate memory for RCU\n");
+
+	rcu_cfg.v = qsv2;
+	rcu_cfg.mode = RTE_FIB6_QSBR_MODE_SYNC;
+	status = rte_fib6_rcu_qsbr_add(fib, &rcu_cfg);
+	RTE_TEST_ASSERT(status == -EEXIST, "Secondary RCU was mistakenly attached\n");
+
+	rte_fib6_free(fib);
+	rte_free(qsv);
+	rte_free(qsv2);
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * rte_fib6_rcu_qsbr_add DQ mode functional test.
+ * Reader and writer are in the same thread in this test.
+ *  - Create FIB which supports 8 tbl8s
+ *  - Add RCU QSBR variable to FIB
+ *  - Register a reader thread (not a real thread)
+ *  - Writer add then delete a route with depth=40 (> 24), its two tbl8s
+ *    are deferred
+ *  - Writer add routes until there is no available tbl8
+ *  - Reader report quiescent state
+ *  - Writer add the route
+ *  - Reader lookup the route
+ */
+int32_t
+test_fib6_rcu_sync_rw(void)
+{
+	struct rte_fib6 *fib = NULL;
+	struct rte_fib6_conf config;
+	size_t sz;
+	struct rte_rcu_qsbr *qsv;
+	int32_t status;
+	uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE] = {0x20, 0x01, 0x0d, 0xb8, 0, 0, 0,
+		0, 0, 0, 0, 0, 0, 0, 0, 1};
+	uint8_t depth = 40;
+	uint64_t def_nh = 100, next_hop = 1, next_hop_return;
+	struct rte_fib6_rcu_config rcu_cfg = {0};
+	unsigned int i;
+
+	config.max_routes = MAX_ROUTES;
+	config.rib_ext_sz = 0;
+	config.default_nh = def_nh;
+	config.type = RTE_FIB6_TRIE;
+	config.trie.nh_sz = RTE_FIB6_TRIE_4B;
+	config.trie.num_tbl8 = 8;
+
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	/* Create RCU QSBR variable */
+	sz = rte_rcu_qsbr_get_memsize(1);
+	qsv = (struct rte_rcu_qsbr *)rte_zmalloc_socket(NULL, sz,
+		RTE_CACHE_LINE_SIZE, SOCKET_ID_ANY);
+	RTE_TEST_ASSERT(qsv != NULL, "Can not allocate memory for RCU\n");
+
+	status = rte_rcu_qsbr_init(qsv, 1);
+	RTE_TEST_ASSERT(status == 0, "Can not initialize RCU\n");
+
+	rcu_cfg.v = qsv;
+	rcu_cfg.mode = RTE_FIB6_QSBR_MODE_DQ;
+	/* Attach RCU QSBR to FIB table */
+	status = rte_fib6_rcu_qsbr_add(fib, &rcu_cfg);
+	RTE_TEST_ASSERT(status == 0, "Can not attach RCU to FIB\n");
+
+	/* Register pseudo reader */
+	status = rte_rcu_qsbr_thread_register(qsv, 0);
+	RTE_TEST_ASSERT(status == 0, "Can not register RCU thread\n");
+	rte_rcu_qsbr_thread_online(qsv, 0);
+
+	status = rte_fib6_add(fib, ip, depth, next_hop);
+	RTE_TEST_ASSERT(status == 0, "Failed to add a route\n");
+
+	status = rte_fib6_lookup_bulk(fib, &ip, &next_hop_return, 1);
+	RTE_TEST_ASSERT((status == 0) && (next_hop_return == next_hop),
+		"Failed to get proper nexthop\n");
+
+	/* Writer update */
+	status = rte_fib6_delete(fib, ip, depth);
+	RTE_TEST_ASSERT(status == 0, "Failed to delete a route\n");
+
+	status = rte_fib6_lookup_bulk(fib, &ip, &next_hop_return, 1);
+	RTE_TEST_ASSERT((status == 0) && (next_hop_return == def_nh),
+		"Failed to get proper nexthop\n");
+
+	/*
+	 * Without the deferred tbl8s, there would be enough tbl8s for
+	 * these routes, one for each /24.
+	 */
+	depth = 32;
+	for (i = 0; i < config.trie.num_tbl8 - 1; i++) {
+		ip[2]++;
+		status = rte_fib6_add(fib, ip, depth, next_hop);
+		if (status != 0)
+			break;
+	}
+	RTE_TEST_ASSERT(status != 0, "Deferred tbl8s were reused\n");
+
+	/* Reader quiescent */
+	rte_rcu_qsbr_quiescent(qsv, 0);
+
+	status = rte_fib6_add(fib, ip, depth, next_hop);
+	RTE_TEST_ASSERT(status == 0, "Failed to add a route\n");
+
+	rte_rcu_qsbr_thread_offline(qsv, 0);
+	status = rte_rcu_qsbr_thread_unregister(qsv, 0);
+	RTE_TEST_ASSERT(status == 0, "Can not unregister RCU thread\n");
+
+	status = rte_fib6_lookup_bulk(fib, &ip, &next_hop_return, 1);
+	RTE_TEST_ASSERT((status == 0) && (next_hop_return == next_hop),
+		"Failed to get proper nexthop\n");
+
+	rte_fib6_free(fib);
+	rte_free(qsv);
+
+	return TEST_SUCCESS;
+}
+
+#define UPDATE_ROUTES	1024
+#define UPDATE_LOOKUPS	(1 << 14)
+
+enum {
+	HOST_BITS_ZERO,
+	HOST_BITS_ONE,
+	HOST_BITS_RANDOM
+};
+
+/* Set the bits of the address after the first depth ones */
+static void
+set_host_bits(uint8_t *ip, uint8_t depth, int how)
+{
+	int i;
+	uint8_t msk, val;
+
+	for (i = depth / 8; i < RTE_FIB6_IPV6_ADDR_SIZE; i++) {
+		msk = (i == depth / 8) ? 0xff >> (depth % 8) : 0xff;
+		if (how == HOST_BITS_RANDOM)
+			val = rte_rand();
+		else
+			val = (how == HOST_BITS_ONE) ? 0xff : 0;
+		ip[i] = (ip[i] & ~msk) | (val & msk);
+	}
+}
+
+/* Compare the next hops of both FIBs around the routes and at random */
+static int
+check_same_lookups(struct rte_fib6 *fib, struct rte_fib6 *ref,
+	uint8_t ips[][RTE_FIB6_IPV6_ADDR_SIZE], const uint8_t *depths,
+	unsigned int n)
+{
+	static uint8_t lookup_ips[UPDATE_LOOKUPS][RTE_FIB6_IPV6_ADDR_SIZE];
+	static uint64_t nh[UPDATE_LOOKUPS], ref_nh[UPDATE_LOOKUPS];
+	unsigned int i, k = 0;
+
+	for (i = 0; i < n; i++) {
+		memcpy(lookup_ips[k++], ips[i], RTE_FIB6_IPV6_ADDR_SIZE);
+		memcpy(lookup_ips[k], ips[i], RTE_FIB6_IPV6_ADDR_SIZE);
+		set_host_bits(lookup_ips[k++], depths[i], HOST_BITS_ONE);
+	}
+	while (k < UPDATE_LOOKUPS) {
+		memcpy(lookup_ips[k], ips[k % n], RTE_FIB6_IPV6_ADDR_SIZE);
+		set_host_bits(lookup_ips[k++], 38, HOST_BITS_RANDOM);
+	}
+
+	rte_fib6_lookup_bulk(fib, lookup_ips, nh, UPDATE_LOOKUPS);
+	rte_fib6_lookup_bulk(ref, lookup_ips, ref_nh, UPDATE_LOOKUPS);
+	for (i = 0; i < UPDATE_LOOKUPS; i++) {
+		if (nh[i] != ref_nh[i]) {
+			printf("Next hop %"PRIu64" instead of %"PRIu64
+				" for lookup %u\n", nh[i], ref_nh[i], i);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/*
+ * Apply overlapping updates in transactions and check that the result
+ * is the same as when applying them one by one
+ */
+int32_t
+test_update_commit(void)
+{
+	static uint8_t ips[UPDATE_ROUTES][RTE_FIB6_IPV6_ADDR_SIZE];
+	static uint8_t depths[UPDATE_ROUTES];
+	static uint64_t next_hops[UPDATE_ROUTES];
+	const uint8_t base[RTE_FIB6_IPV6_ADDR_SIZE] = {0x20, 0x01, 0x0d, 0xb8};
+	struct rte_fib6 *fib, *ref;
+	struct rte_fib6_conf config;
+	unsigned int i;
+	int ret;
+
+	config.max_routes = MAX_ROUTES;
+	config.rib_ext_sz = 0;
+	config.default_nh = 0;
+	config.type = RTE_FIB6_DUMMY;
+
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+	ret = rte_fib6_update_begin(fib);
+	RTE_TEST_ASSERT(ret == -ENOTSUP,
+		"rte_fib6_update_begin returned wrong status\n");
+	rte_fib6_free(fib);
+
+	config.type = RTE_FIB6_TRIE;
+	config.trie.nh_sz = RTE_FIB6_TRIE_4B;
+	config.trie.num_tbl8 = MAX_TBL8;
+
+	fib = rte_fib6_create(__func__, SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+	ref = rte_fib6_create("test_update_commit_ref", SOCKET_ID_ANY,
+		&config);
+	RTE_TEST_ASSERT(ref != NULL, "Failed to create FIB\n");
+
+	ret = rte_fib6_update_commit(fib);
+	RTE_TEST_ASSERT(ret == -EINVAL, "Committed without transaction\n");
+
+	/* Nested prefixes from /32 to /64 within 2001:db8::/38 */
+	for (i = 0; i < UPDATE_ROUTES; i++) {
+		depths[i] = 32 + rte_rand_max(33);
+		memcpy(ips[i], base, RTE_FIB6_IPV6_ADDR_SIZE);
+		set_host_bits(ips[i], 38, HOST_BITS_RANDOM);
+		set_host_bits(ips[i], depths[i], HOST_BITS_ZERO);
+		next_hops[i] = i + 1;
+	}
+
+	/* Full load in an implicit transaction */
+	ret = rte_fib6_add_bulk(fib, ips, depths, next_hops, UPDATE_ROUTES);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add routes\n");
+	for (i = 0; i < UPDATE_ROUTES; i++) {
+		ret = rte_fib6_add(ref, ips[i], depths[i], next_hops[i]);
+		RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+	}
+	RTE_TEST_ASSERT(check_same_lookups(fib, ref, ips, depths,
+		UPDATE_ROUTES) == 0, "Lookups differ after the load\n");
+
+	/* Delete, re-add and change routes in one explicit transaction */
+	ret = rte_fib6_update_begin(fib);
+	RTE_TEST_ASSERT(ret == 0, "Failed to start transaction\n");
+	ret = rte_fib6_update_begin(fib);
+	RTE_TEST_ASSERT(ret == -EBUSY, "Nested transaction started\n");
+	for (i = 0; i < UPDATE_ROUTES; i++) {
+		if (i % 3 == 0) {
+			rte_fib6_delete(fib, ips[i], depths[i]);
+			rte_fib6_delete(ref, ips[i], depths[i]);
+		}
+		if (i % 5 == 0) {
+			next_hops[i] += UPDATE_ROUTES;
+			ret = rte_fib6_add(fib, ips[i], depths[i],
+				next_hops[i]);
+			RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+			ret = rte_fib6_add(ref, ips[i], depths[i],
+				next_hops[i]);
+			RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+		}
+	}
+	ret = rte_fib6_update_commit(fib);
+	RTE_TEST_ASSERT(ret == 0, "Failed to commit transaction\n");
+	RTE_TEST_ASSERT(check_same_lookups(fib, ref, ips, depths,
+		UPDATE_ROUTES) == 0, "Lookups differ after the update\n");
+
+	/* Stop at the first missing route, then delete everything */
+	ret = rte_fib6_delete_bulk(fib, ips, depths, UPDATE_ROUTES);
+	RTE_TEST_ASSERT(ret == -ENOENT, "Deleted a missing route\n");
+	for (i = 0; i < UPDATE_ROUTES; i++)
+		rte_fib6_delete(fib, ips[i], depths[i]);
+	for (i = 0; i < UPDATE_ROUTES; i++)
+		rte_fib6_delete(ref, ips[i], depths[i]);
+	RTE_TEST_ASSERT(check_same_lookups(fib, ref, ips, depths,
+		UPDATE_ROUTES) == 0, "Lookups differ after the delete\n");
+
+	rte_fib6_free(fib);
+	rte_fib6_free(ref);
+
+	return TEST_SUCCESS;
+}
+
+#define EXHAUST_TBL8	8
+#define EXHAUST_ROUTES	6
+
+/* Set the prefixes of exhaust_routes(), a /32 in different /24s */
+static void
+exhaust_ips(uint8_t ips[][RTE_FIB6_IPV6_ADDR_SIZE], uint8_t b)
+{
+	unsigned int i;
+
+	for (i = 0; i < EXHAUST_ROUTES; i++) {
+		memset(ips[i], 0, RTE_FIB6_IPV6_ADDR_SIZE);
+		ips[i][0] = 0x20;
+		ips[i][1] = b;
+		ips[i][2] = i;
+		ips[i][3] = 1;
+	}
+}
+
+/* Add or delete routes needing a tbl8 group each */
+static int
+exhaust_routes(struct rte_fib6 *fib, uint8_t b, int add, int bulk)
+{
+	uint8_t ips[EXHAUST_ROUTES][RTE_FIB6_IPV6_ADDR_SIZE];
+	uint8_t depths[EXHAUST_ROUTES];
+	uint64_t next_hops[EXHAUST_ROUTES];
+	unsigned int i;
+	int ret = 0;
+
+	exhaust_ips(ips, b);
+	for (i = 0; i < EXHAUST_ROUTES; i++) {
+		depths[i] = 32;
+		next_hops[i] = b;
+	}
+	if (bulk)
+		return add ? rte_fib6_add_bulk(fib, ips, depths, next_hops,
+				EXHAUST_ROUTES) :
+			rte_fib6_delete_bulk(fib, ips, depths, EXHAUST_ROUTES);
+	for (i = 0; (i < EXHAUST_ROUTES) && (ret == 0); i++)
+		ret = add ? rte_fib6_add(fib, ips[i], depths[i],
+				next_hops[i]) :
+			rte_fib6_delete(fib, ips[i], depths[i]);
+	return ret;
+}
+
+/* Check the next hops of the routes of exhaust_routes() */
+static int
+exhaust_lookup(struct rte_fib6 *fib, uint8_t b, uint64_t next_hop)
+{
+	uint8_t ips[EXHAUST_ROUTES][RTE_FIB6_IPV6_ADDR_SIZE];
+	uint64_t nhs[EXHAUST_ROUTES];
+	unsigned int i;
+
+	exhaust_ips(ips, b);
+	rte_fib6_lookup_bulk(fib, ips, nhs, EXHAUST_ROUTES);
+	for (i = 0; i < EXHAUST_ROUTES; i++)
+		if (nhs[i] != next_hop)
+			return -1;
+	return 0;
+}
+
+/* Count the routes of exhaust_routes() in the RIB */
+static unsigned int
+exhaust_in_rib(struct rte_fib6 *fib, uint8_t b)
+{
+	uint8_t ips[EXHAUST_ROUTES][RTE_FIB6_IPV6_ADDR_SIZE];
+	struct rte_rib6 *rib = rte_fib6_get_rib(fib);
+	unsigned int i, n = 0;
+
+	exhaust_ips(ips, b);
+	for (i = 0; i < EXHAUST_ROUTES; i++)
+		if (rte_rib6_lookup_exact(rib, ips[i], 32) != NULL)
+			n++;
+	return n;
+}
+
+/*
+ * Run out of tbl8 groups, held by the RCU defer queue, during commits:
+ * an explicit transaction fails with the dataplane unchanged and stays
+ * in progress, a bulk call rolls its own transaction back.
+ */
+int32_t
+test_update_tbl8_exhausted(void)
+{
+	struct rte_fib6 *fib;
+	struct rte_fib6_conf config;
+	struct rte_fib6_rcu_config rcu_cfg = {0};
+	struct rte_rcu_qsbr *qsv;
+	uint8_t ips[2][RTE_FIB6_IPV6_ADDR_SIZE] = {{0x20, 4}, {0x20, 5}};
+	uint8_t depths[2] = {16, 16};
+	uint64_t nh;
+	size_t sz;
+	int ret;
+
+	config.max_routes = MAX_ROUTES;
+	config.rib_ext_sz = 0;
+	config.default_nh = 0;
+	config.type = RTE_FIB6_TRIE;
+	config.trie.nh_sz = RTE_FIB6_TRIE_4B;
+	config.trie.num_tbl8 = EXHAUST_TBL8;
+
+	/* The name of the RIB mempool is too long with __func__ */
+	fib = rte_fib6_create("test_tbl8_exhausted", SOCKET_ID_ANY, &config);
+	RTE_TEST_ASSERT(fib != NULL, "Failed to create FIB\n");
+
+	sz = rte_rcu_qsbr_get_memsize(1);
+	qsv = (struct rte_rcu_qsbr *)rte_zmalloc_socket(NULL, sz,
+		RTE_CACHE_LINE_SIZE, SOCKET_ID_ANY);
+	RTE_TEST_ASSERT(qsv != NULL, "Can not allocate memory for RCU\n");
+	ret = rte_rcu_qsbr_init(qsv, 1);
+	RTE_TEST_ASSERT(ret == 0, "Can not initialize RCU\n");
+	rcu_cfg.v = qsv;
+	rcu_cfg.mode = RTE_FIB6_QSBR_MODE_DQ;
+	ret = rte_fib6_rcu_qsbr_add(fib, &rcu_cfg);
+	RTE_TEST_ASSERT(ret == 0, "Can not attach RCU to FIB\n");
+
+	/* Pseudo reader holding the groups of the deleted routes */
+	ret = rte_rcu_qsbr_thread_register(qsv, 0);
+	RTE_TEST_ASSERT(ret == 0, "Can not register RCU thread\n");
+	rte_rcu_qsbr_thread_online(qsv, 0);
+
+	RTE_TEST_ASSERT(exhaust_routes(fib, 1, 1, 0) == 0,
+		"Failed to add routes\n");
+	RTE_TEST_ASSERT(exhaust_routes(fib, 1, 0, 0) == 0,
+		"Failed to delete routes\n");
+
+	ret = rte_fib6_update_begin(fib);
+	RTE_TEST_ASSERT(ret == 0, "Failed to start transaction\n");
+	RTE_TEST_ASSERT(exhaust_routes(fib, 2, 1, 0) == 0,
+		"Failed to add routes\n");
+	ret = rte_fib6_update_commit(fib);
+	RTE_TEST_ASSERT(ret == -ENOSPC, "Committed without tbl8 groups\n");
+	RTE_TEST_ASSERT(exhaust_lookup(fib, 2, 0) == 0,
+		"Dataplane changed by a failed commit\n");
+	ret = rte_fib6_update_begin(fib);
+	RTE_TEST_ASSERT(ret == -EBUSY, "Failed commit ended transaction\n");
+
+	/* Retried once the groups are reclaimed */
+	rte_rcu_qsbr_quiescent(qsv, 0);
+	ret = rte_fib6_update_commit(fib);
+	RTE_TEST_ASSERT(ret == 0, "Failed to commit transaction\n");
+	RTE_TEST_ASSERT(exhaust_lookup(fib, 2, 2) == 0,
+		"Wrong next hop after the commit\n");
+
+	RTE_TEST_ASSERT(exhaust_routes(fib, 2, 0, 0) == 0,
+		"Failed to delete routes\n");
+	ret = exhaust_routes(fib, 3, 1, 1);
+	RTE_TEST_ASSERT(ret == -ENOSPC, "Bulk add without tbl8 groups\n");
+	RTE_TEST_ASSERT(exhaust_in_rib(fib, 3) == 0,
+		"Routes of a failed bulk add left in the RIB\n");
+	RTE_TEST_ASSERT(exhaust_lookup(fib, 3, 0) == 0,
+		"Dataplane changed by a failed bulk add\n");
+
+	/* The following updates reach the dataplane */
+	ret = rte_fib6_add(fib, ips[0], depths[0], 4);
+	RTE_TEST_ASSERT(ret == 0, "Failed to add a route\n");
+	ret = rte_fib6_lookup_bulk(fib, ips, &nh, 1);
+	RTE_TEST_ASSERT((ret == 0) && (nh == 4),
+		"Update after a failed bulk add not applied\n");
+
+	/* A bulk delete stopping at a missing route deletes nothing */
+	ret = rte_fib6_delete_bulk(fib, ips, depths, 2);
+	RTE_TEST_ASSERT(ret == -ENOENT, "Deleted a missing route\n");
+	ret = rte_fib6_lookup_bulk(fib, ips, &nh, 1);
+	RTE_TEST_ASSERT((ret == 0) && (nh == 4),
+		"Route of a failed bulk delete removed\n");
+
+	rte_rcu_qsbr_thread_offline(qsv, 0);
+	ret = rte_rcu_qsbr_thread_unregister(qsv, 0);
+	RTE_TEST_ASSERT(ret == 0, "Can not unregister RCU thread\n");
+
+	rte_fib6_free(fib);
+	rte_free(qsv);
+
+	return TEST_SUCCESS;
+}
+
 static struct unit_test_suite fib6_fast_tests = {
 	.suite_name = "fib6 autotest",
 	.setup = NULL,
@@ -395,6 +928,10 @@ static struct unit_test_suite fib6_fast_tests = {
 	TEST_CASE(test_add_del_invalid),
 	TEST_CASE(test_get_invalid),
 	TEST_CASE(test_lookup),
+	TEST_CASE(test_invalid_rcu),
+	TEST_CASE(test_fib6_rcu_sync_rw),
+	TEST_CASE(test_update_commit),
+	TEST_CASE(test_update_tbl8_exhausted),
 	TEST_CASES_END()
 	}
 };
@@ -12,6 +12,9 @@
 #include <rte_random.h>
 #include <rte_branch_prediction.h>
 #include <rte_ip.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
+#include <rte_malloc.h>
 #include <rte_fib.h>
 
 #include "test.h"
@@ -316,6 +319,126 @@ print_route_distribution(const struct route_rule *table, uint32_t n)
 	printf("\n");
 }
 
+/* Routes added and deleted by the writer during the RCU lookup test */
+#define NUM_UPDATE_ROUTES 1024
+
+static struct route_rule update_route_table[NUM_UPDATE_ROUTES];
+static uint8_t writer_done;
+static uint64_t writer_updates;
+
+/*
+ * Writer thread: add and delete routes longer than /24, so that tbl8
+ * groups are allocated and freed, until the lookups are done.
+ */
+static int
+test_fib_rcu_writer(void *arg)
+{
+	struct rte_fib *fib = arg;
+	uint32_t next_hop_add = 0xBB;
+	uint64_t updates = 0;
+	unsigned int i;
+
+	while (!__atomic_load_n(&writer_done, __ATOMIC_RELAXED)) {
+		for (i = 0; i < NUM_UPDATE_ROUTES; i++)
+			if (rte_fib_add(fib, update_route_table[i].ip,
+					update_route_table[i].depth,
+					next_hop_add) == 0)
+				updates++;
+		for (i = 0; i < NUM_UPDATE_ROUTES; i++)
+			if (rte_fib_delete(fib, update_route_table[i].ip,
+					update_route_table[i].depth) == 0)
+				updates++;
+	}
+	writer_updates = updates;
+
+	return 0;
+}
+
+/*
+ * Measure the bulk lookup rate of a reader reporting its quiescent state
+ * after each batch, while a writer on another lcore continuously updates
+ * the FIB with RCU reclamation of the tbl8 groups.
+ */
+static int
+test_fib_rcu_perf(struct rte_fib *fib)
+{
+	struct rte_fib_rcu_config rcu_cfg = {0};
+	struct rte_rcu_qsbr *qsv;
+	static uint32_t ip_batch[BATCH_SIZE];
+	uint64_t next_hops[BULK_SIZE];
+	uint64_t begin, total_time = 0, elapsed;
+	unsigned int i, j, writer_lcore;
+	size_t sz;
+
+	writer_lcore = rte_get_next_lcore(-1, 1, 0);
+	if (writer_lcore >= RTE_MAX_LCORE) {
+		printf("Not enough lcores for the RCU lookup test, skipping\n");
+		rte_fib_free(fib);
+		return 0;
+	}
+
+	sz = rte_rcu_qsbr_get_memsize(1);
+	qsv = rte_zmalloc(NULL, sz, RTE_CACHE_LINE_SIZE);
+	if (qsv == NULL) {
+		rte_fib_free(fib);
+		return -1;
+	}
+	rte_rcu_qsbr_init(qsv, 1);
+
+	rcu_cfg.v = qsv;
+	rcu_cfg.mode = RTE_FIB_QSBR_MODE_DQ;
+	if (rte_fib_rcu_qsbr_add(fib, &rcu_cfg) != 0) {
+		printf("RCU variable assignment failed\n");
+		rte_fib_free(fib);
+		rte_free(qsv);
+		return -1;
+	}
+
+	for (i = 0; i < NUM_UPDATE_ROUTES; i++) {
+		update_route_table[i].depth = 25 + rte_rand_max(8);
+		update_route_table[i].ip = rte_rand() &
+			(uint32_t)(UINT64_MAX << (32 - update_route_table[i].depth));
+	}
+
+	rte_rcu_qsbr_thread_register(qsv, 0);
+	rte_rcu_qsbr_thread_online(qsv, 0);
+
+	__atomic_store_n(&writer_done, 0, __ATOMIC_RELAXED);
+	rte_eal_remote_launch(test_fib_rcu_writer, fib, writer_lcore);
+
+	elapsed = rte_rdtsc();
+	for (i = 0; i < ITERATIONS; i++) {
+		for (j = 0; j < BATCH_SIZE; j++)
+			ip_batch[j] = rte_rand();
+
+		begin = rte_rdtsc();
+		for (j = 0; j < BATCH_SIZE; j += BULK_SIZE)
+			rte_fib_lookup_bulk(fib, &ip_batch[j], next_hops,
+				BULK_SIZE);
+		/* Update quiescent state */
+		rte_rcu_qsbr_quiescent(qsv, 0);
+		total_time += rte_rdtsc() - begin;
+	}
+	elapsed = rte_rdtsc() - elapsed;
+
+	__atomic_store_n(&writer_done, 1, __ATOMIC_RELAXED);
+	rte_eal_wait_lcore(writer_lcore);
+
+	rte_rcu_qsbr_thread_offline(qsv, 0);
+	rte_rcu_qsbr_thread_unregister(qsv, 0);
+
+	printf("BULK FIB Lookup with RCU under updates: %.1f cycles, "
+		"%.2f M updates/s\n",
+		(double)total_time / ((double)ITERATIONS * BATCH_SIZE),
+		writer_updates / ((double)elapsed / rte_get_tsc_hz()) / 1e6);
+
+	/* The RCU variable is used until the FIB is freed */
+	rte_fib_free(fib);
+	rte_free(qsv);
+
+	return 0;
+}
+
 static int
 test_fib_perf(void)
 {
@@ -406,7 +529,15 @@ test_fib_perf(void)
 
 	rte_fib_free(fib);
 
-	return 0;
+	/* Measure bulk lookup under a continuous update stream */
+	fib = rte_fib_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_FIB_ASSERT(fib != NULL);
+
+	for (i = 0; i < NUM_ROUTE_ENTRIES; i++)
+		rte_fib_add(fib, large_route_table[i].ip,
+			large_route_table[i].depth, next_hop_add);
+
+	return test_fib_rcu_perf(fib);
 }
 
 REGISTER_TEST_COMMAND(fib_perf_autotest, test_fib_perf);
@@ -3,14 +3,18 @@
  */
 #include <assert.h>
 #include <inttypes.h>
+#include <pthread.h>
 #include <signal.h>
 #include <stdio.h>
 #include <string.h>
 #include <unistd.h>
 
+#include <rte_cycles.h>
 #include <rte_errno.h>
 #include <rte_graph.h>
 #include <rte_graph_worker.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
 #include <rte_mbuf.h>
 #include <rte_mbuf_dyn.h>
 #include <rte_random.h>
@@ -771,6 +775,238 @@ test_print_stats(void)
 	return 0;
 }
 
+#define DISPATCH_OBJS 4096
+
+static uint64_t dispatch_seq[DISPATCH_OBJS];
+static uint64_t dispatch_src_count;
+static uint64_t dispatch_snk_count;
+static uint64_t dispatch_snk_errors;
+static volatile int dispatch_done;
+
+static uint16_t
+test_dispatch_source(struct rte_graph *graph, struct rte_node *node,
+		     void **objs, uint16_t nb_objs)
+{
+	void **next_stream;
+	uint16_t i;
+
+	RTE_SET_USED(objs);
+	nb_objs = RTE_MIN((uint64_t)RTE_GRAPH_BURST_SIZE,
+			  DISPATCH_OBJS - dispatch_src_count);
+	if (nb_objs == 0)
+		return 0;
+
+	next_stream = rte_node_next_stream_get(graph, node, 0, nb_objs);
+	for (i = 0; i < nb_objs; i++)
+		next_stream[i] = &dispatch_seq[dispatch_src_count++];
+	rte_node_next_stream_put(graph, node, 0, nb_objs);
+
+	return nb_objs;
+}
+
+static uint16_t
+test_dispatch_fwd(struct rte_graph *graph, struct rte_node *node, void **objs,
+		  uint16_t nb_objs)
+{
+	RTE_SET_USED(objs);
+
+	if (rte_lcore_id() != rte_get_main_lcore())
+		dispatch_snk_errors++;
+	rte_node_next_stream_move(graph, node, 0);
+
+	return nb_objs;
+}
+
+static uint16_t
+test_dispatch_sink(struct rte_graph *graph, struct rte_node *node,
+		   void **objs, uint16_t nb_objs)
+{
+	uint16_t i;
+
+	RTE_SET_USED(graph);
+	RTE_SET_USED(node);
+
+	if (rte_lcore_id() == rte_get_main_lcore())
+		dispatch_snk_errors++;
+
+	/* Objects keep their order across the handoff ring */
+	for (i = 0; i < nb_objs; i++)
+		if ((uint64_t *)objs[i] != &dispatch_seq[dispatch_snk_count++])
+			dispatch_snk_errors++;
+
+	return nb_objs;
+}
+
+static struct rte_node_register test_dispatch_source_node = {
+	.name = "test_dispatch_source",
+	.process = test_dispatch_source,
+	.flags = RTE_NODE_SOURCE_F,
+	.nb_edges = 1,
+	.next_nodes = {"test_dispatch_fwd"},
+};
+RTE_NODE_REGISTER(test_dispatch_source_node);
+
+static struct rte_node_register test_dispatch_fwd_node = {
+	.name = "test_dispatch_fwd",
+	.process = test_dispatch_fwd,
+	.nb_edges = 1,
+	.next_nodes = {"test_dispatch_sink"},
+};
+RTE_NODE_REGISTER(test_dispatch_fwd_node);
+
+static struct rte_node_register test_dispatch_sink_node = {
+	.name = "test_dispatch_sink",
+	.process = test_dispatch_sink,
+};
+RTE_NODE_REGISTER(test_dispatch_sink_node);
+
+static int
+dispatch_worker(void *arg)
+{
+	struct rte_graph *graph = arg;
+
+	while (!dispatch_done)
+		rte_graph_walk(graph);
+
+	return 0;
+}
+
+static void *
+dispatch_non_eal_walk(void *arg)
+{
+	rte_graph_walk(arg);
+	return NULL;
+}
+
+static int
+dispatch_stats_cb(bool is_first, bool is_last, void *cookie,
+		  const struct rte_graph_cluster_node_stats *st)
+{
+	RTE_SET_USED(is_first);
+	RTE_SET_USED(is_last);
+	RTE_SET_USED(cookie);
+
+	if (st->id == test_dispatch_sink_node.id &&
+	    (st->dispatch_objs != DISPATCH_OBJS || st->objs != DISPATCH_OBJS ||
+	     st->ring_count != 0)) {
+		printf("Dispatch stats mismatch, handoff %" PRIu64
+		       " objs %" PRIu64 " ring %" PRIu64 "\n",
+		       st->dispatch_objs, st->objs, st->ring_count);
+		dispatch_snk_errors++;
+	}
+
+	return 0;
+}
+
+static int
+test_graph_mcore_dispatch(void)
+{
+	static const char *patterns[] = {"test_dispatch_*"};
+	struct rte_graph_node_lcore node_lcores[] = {
+		{ .node_pattern = "test_dispatch_sink" },
+		{ .node_pattern = "*", .lcore_id = rte_get_main_lcore() },
+	};
+	struct rte_graph_param gconf = {
+		.socket_id = SOCKET_ID_ANY,
+		.nb_node_patterns = 1,
+		.node_patterns = patterns,
+		.model = RTE_GRAPH_MODEL_MCORE_DISPATCH,
+		.nb_node_lcores = 1,
+		.node_lcores = &node_lcores[0],
+		.dispatch_ring_size = 64,
+	};
+	struct rte_graph_cluster_stats_param s_param;
+	struct rte_graph_cluster_stats *stats;
+	const char *pattern = "dispatch0";
+	struct rte_graph *graph;
+	unsigned int lcore_id;
+	pthread_t thread;
+	rte_graph_t id;
+	uint64_t tsc;
+	int rc = -1;
+
+	lcore_id = rte_get_next_lcore(-1, 1, 0);
+	if (lcore_id >= RTE_MAX_LCORE) {
+		printf("At least 2 lcores are needed for dispatch test\n");
+		return TEST_SKIPPED;
+	}
+	node_lcores[0].lcore_id = lcore_id;
+
+	/* Source and forward nodes have no lcore */
+	id = rte_graph_create("dispatch0", &gconf);
+	if (id != RTE_GRAPH_ID_INVALID) {
+		printf("Graph creation success without node affinity\n");
+		return -1;
+	}
+
+	gconf.nb_node_lcores = RTE_DIM(node_lcores);
+	id = rte_graph_create("dispatch0", &gconf);
+	if (id == RTE_GRAPH_ID_INVALID) {
+		printf("Dispatch graph creation failed, error = %d\n",
+		       rte_errno);
+		return -1;
+	}
+
+	graph = rte_graph_lookup("dispatch0");
+
+	/* A thread outside of EAL has no instance to walk */
+	if (pthread_create(&thread, NULL, dispatch_non_eal_walk, graph) != 0) {
+		printf("Cannot create non-EAL thread\n");
+		goto destroy;
+	}
+	pthread_join(thread, NULL);
+	if (dispatch_src_count != 0) {
+		printf("Dispatch graph walked from a non-EAL thread\n");
+		goto destroy;
+	}
+
+	dispatch_done = 0;
+	rte_eal_remote_launch(dispatch_worker, graph, lcore_id);
+
+	/* The small ring forces handoffs to stall and be retried */
+	tsc = rte_get_timer_cycles() + rte_get_timer_hz() * 10;
+	while (dispatch_snk_count < DISPATCH_OBJS &&
+	       rte_get_timer_cycles() < tsc)
+		rte_graph_walk(graph);
+
+	dispatch_done = 1;
+	rte_eal_wait_lcore(lcore_id);
+
+	if (dispatch_snk_count != DISPATCH_OBJS || dispatch_snk_errors) {
+		printf("Dispatch got %" PRIu64 " objs, %" PRIu64 " errors\n",
+		       dispatch_snk_count, dispatch_snk_errors);
+		goto destroy;
+	}
+
+	rc = 0;
+	if (!rte_graph_has_stats_feature())
+		goto destroy;
+
+	memset(&s_param, 0, sizeof(s_param));
+	s_param.f = stdout;
+	s_param.socket_id = SOCKET_ID_ANY;
+	s_param.graph_patterns = &pattern;
+	s_param.nb_graph_patterns = 1;
+	s_param.fn = dispatch_stats_cb;
+	stats = rte_graph_cluster_stats_create(&s_param);
+	if (stats == NULL) {
+		printf("Unable to get dispatch stats\n");
+		rc = -1;
+		goto destroy;
+	}
+	rte_graph_cluster_stats_get(stats, 0);
+	rte_graph_cluster_stats_destroy(stats);
+	if (dispatch_snk_errors)
+		rc = -1;
+
+destroy:
+	if (rte_graph_destroy(id)) {
+		printf("Dispatch graph destroy failed\n");
+		rc = -1;
+	}
+	return rc;
+}
+
 static int
 graph_setup(void)
 {
@@ -822,6 +1058,7 @@ static struct unit_test_suite graph_testsuite = {
 		TEST_CASE(test_graph_lookup_functions),
 		TEST_CASE(test_graph_walk),
 		TEST_CASE(test_print_stats),
+		TEST_CASE(test_graph_mcore_dispatch),
 		TEST_CASES_END(), /**< NULL terminate unit test array */
 	},
 };
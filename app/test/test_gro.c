@@ -0,0 +1,542 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2017 Intel Corporation
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_cycles.h>
+#include <rte_ether.h>
+#include <rte_ethdev.h>
+#include <rte_gro.h>
+#include <rte_gso.h>
+#include <rte_ip.h>
+#include <rte_mbuf.h>
+#include <rte_tcp.h>
+
+#include "test.h"
+
+#define NUM_MBUFS 1024
+#define MBUF_CACHE_SIZE 32
+#define BURST 32
+#define PAYLOAD_LEN 100
+#define GSO_SEG_SIZE 256
+#define PERF_FLOWS 4
+#define PERF_ITERATIONS 10000
+#define PERF_SWEEP_MAX_FLOWS UINT16_MAX
+#define PERF_SWEEP_MBUFS (2 * PERF_SWEEP_MAX_FLOWS + BURST)
+#define PERF_SWEEP_DATA_ROOM (RTE_PKTMBUF_HEADROOM + 256)
+
+static struct rte_mempool *pkt_pool;
+static struct rte_mempool *indirect_pool;
+
+static const uint8_t ip6_src[16] = {
+	0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1 };
+static const uint8_t ip6_dst[16] = {
+	0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2 };
+
+/* Build an Ethernet/IPvX/TCP packet with PAYLOAD_LEN bytes of payload. */
+static struct rte_mbuf *
+build_tcp_pkt(bool ipv6, uint16_t src_port, uint32_t seq, uint16_t ip_id,
+		uint16_t payload_len)
+{
+	struct rte_ether_hdr *eth;
+	struct rte_tcp_hdr *tcp;
+	struct rte_mbuf *m;
+	uint16_t l3_len;
+	char *data;
+
+	m = rte_pktmbuf_alloc(pkt_pool);
+	if (m == NULL)
+		return NULL;
+
+	l3_len = ipv6 ? sizeof(struct rte_ipv6_hdr) :
+		sizeof(struct rte_ipv4_hdr);
+	data = rte_pktmbuf_append(m, sizeof(*eth) + l3_len + sizeof(*tcp) +
+			payload_len);
+	if (data == NULL) {
+		rte_pktmbuf_free(m);
+		return NULL;
+	}
+	memset(data, 0, m->pkt_len);
+
+	eth = (struct rte_ether_hdr *)data;
+	eth->src_addr.addr_bytes[5] = 1;
+	eth->dst_addr.addr_bytes[5] = 2;
+
+	if (ipv6) {
+		struct rte_ipv6_hdr *ip = (struct rte_ipv6_hdr *)(eth + 1);
+
+		eth->ether_type = rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV6);
+		ip->vtc_flow = rte_cpu_to_be_32(6 << 28);
+		ip->payload_len = rte_cpu_to_be_16(sizeof(*tcp) + payload_len);
+		ip->proto = IPPROTO_TCP;
+		ip->hop_limits = 64;
+		memcpy(ip->src_addr, ip6_src, sizeof(ip->src_addr));
+		memcpy(ip->dst_addr, ip6_dst, sizeof(ip->dst_addr));
+		m->packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV6 |
+			RTE_PTYPE_L4_TCP;
+		m->ol_flags |= RTE_MBUF_F_TX_IPV6;
+	} else {
+		struct rte_ipv4_hdr *ip = (struct rte_ipv4_hdr *)(eth + 1);
+
+		eth->ether_type = rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV4);
+		ip->version_ihl = RTE_IPV4_VHL_DEF;
+		ip->total_length = rte_cpu_to_be_16(l3_len + sizeof(*tcp) +
+				payload_len);
+		ip->packet_id = rte_cpu_to_be_16(ip_id);
+		ip->time_to_live = 64;
+		ip->next_proto_id = IPPROTO_TCP;
+		ip->src_addr = rte_cpu_to_be_32(RTE_IPV4(10, 0, 0, 1));
+		ip->dst_addr = rte_cpu_to_be_32(RTE_IPV4(10, 0, 0, 2));
+		m->packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4 |
+			RTE_PTYPE_L4_TCP;
+		m->ol_flags |= RTE_MBUF_F_TX_IPV4;
+	}
+
+	tcp = (struct rte_tcp_hdr *)(data + sizeof(*eth) + l3_len);
+	tcp->src_port = rte_cpu_to_be_16(src_port);
+	tcp->dst_port = rte_cpu_to_be_16(80);
+	tcp->sent_seq = rte_cpu_to_be_32(seq);
+	tcp->recv_ack = rte_cpu_to_be_32(1);
+	tcp->data_off = (sizeof(*tcp) / 4) << 4;
+	tcp->tcp_flags = RTE_TCP_ACK_FLAG;
+
+	m->l2_len = sizeof(*eth);
+	m->l3_len = l3_len;
+	m->l4_len = sizeof(*tcp);
+
+	return m;
+}
+
+/*
+ * Send two flows of four in-order segments each, with the segments of the
+ * two flows interleaved, and check that each flow is merged into a single
+ * packet whose IP length covers all the payload.
+ */
+static int
+test_gro_tcp_burst(bool ipv6)
+{
+	struct rte_gro_param param = {
+		.gro_types = ipv6 ? RTE_GRO_TCP_IPV6 : RTE_GRO_TCP_IPV4,
+		.max_flow_num = 4,
+		.max_item_per_flow = BURST,
+	};
+	struct rte_mbuf *pkts[BURST];
+	uint16_t nb_pkts = 0, nb_gro, i;
+	uint32_t exp_len;
+
+	for (i = 0; i < 4; i++) {
+		pkts[nb_pkts++] = build_tcp_pkt(ipv6, 1000, 1 + i * PAYLOAD_LEN,
+				i, PAYLOAD_LEN);
+		pkts[nb_pkts++] = build_tcp_pkt(ipv6, 2000, 1 + i * PAYLOAD_LEN,
+				i, PAYLOAD_LEN);
+	}
+	for (i = 0; i < nb_pkts; i++)
+		TEST_ASSERT_NOT_NULL(pkts[i], "Failed to build packet %u", i);
+
+	nb_gro = rte_gro_reassemble_burst(pkts, nb_pkts, &param);
+	TEST_ASSERT_EQUAL(nb_gro, 2, "Expected 2 packets after GRO, got %u",
+			nb_gro);
+
+	exp_len = sizeof(struct rte_tcp_hdr) + 4 * PAYLOAD_LEN;
+	for (i = 0; i < nb_gro; i++) {
+		TEST_ASSERT_EQUAL(pkts[i]->nb_segs, 4,
+				"Unexpected number of segments %u",
+				pkts[i]->nb_segs);
+		if (ipv6) {
+			struct rte_ipv6_hdr *ip = rte_pktmbuf_mtod_offset(
+					pkts[i], struct rte_ipv6_hdr *,
+					pkts[i]->l2_len);
+
+			TEST_ASSERT_EQUAL(rte_be_to_cpu_16(ip->payload_len),
+					exp_len, "Wrong IPv6 payload length");
+		} else {
+			struct rte_ipv4_hdr *ip = rte_pktmbuf_mtod_offset(
+					pkts[i], struct rte_ipv4_hdr *,
+					pkts[i]->l2_len);
+
+			TEST_ASSERT_EQUAL(rte_be_to_cpu_16(ip->total_length),
+					exp_len + sizeof(*ip),
+					"Wrong IPv4 total length");
+		}
+		rte_pktmbuf_free(pkts[i]);
+	}
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_gro_tcp4_burst(void)
+{
+	return test_gro_tcp_burst(false);
+}
+
+static int
+test_gro_tcp6_burst(void)
+{
+	return test_gro_tcp_burst(true);
+}
+
+/*
+ * Feed out-of-order TCP/IPv6 segments to a GRO context across several
+ * calls and check they are all merged and flushed as one packet.
+ */
+static int
+test_gro_tcp6_ctx(void)
+{
+	struct rte_gro_param param = {
+		.gro_types = RTE_GRO_TCP_IPV6,
+		.max_flow_num = 4,
+		.max_item_per_flow = 8,
+		.socket_id = rte_socket_id(),
+	};
+	struct rte_mbuf *pkts[BURST];
+	uint16_t nb_left, nb_out;
+	void *ctx;
+
+	ctx = rte_gro_ctx_create(&param);
+	TEST_ASSERT_NOT_NULL(ctx, "Failed to create GRO context");
+
+	pkts[0] = build_tcp_pkt(true, 1000, 1 + PAYLOAD_LEN, 0, PAYLOAD_LEN);
+	pkts[1] = build_tcp_pkt(true, 1000, 1 + 2 * PAYLOAD_LEN, 0,
+			PAYLOAD_LEN);
+	TEST_ASSERT(pkts[0] != NULL && pkts[1] != NULL,
+			"Failed to build packets");
+	nb_left = rte_gro_reassemble(pkts, 2, ctx);
+	TEST_ASSERT_EQUAL(nb_left, 0, "Packets not kept in GRO context");
+
+	/* The first segment arrives last and is pre-pended */
+	pkts[0] = build_tcp_pkt(true, 1000, 1, 0, PAYLOAD_LEN);
+	TEST_ASSERT_NOT_NULL(pkts[0], "Failed to build packet");
+	nb_left = rte_gro_reassemble(pkts, 1, ctx);
+	TEST_ASSERT_EQUAL(nb_left, 0, "Packet not kept in GRO context");
+	TEST_ASSERT_EQUAL(rte_gro_get_pkt_count(ctx), 1,
+			"Packets not merged in GRO context");
+
+	/* A SYN is never merged and is handed back */
+	pkts[0] = build_tcp_pkt(true, 1000, 1, 0, PAYLOAD_LEN);
+	TEST_ASSERT_NOT_NULL(pkts[0], "Failed to build packet");
+	rte_pktmbuf_mtod_offset(pkts[0], struct rte_tcp_hdr *,
+			pkts[0]->l2_len + pkts[0]->l3_len)->tcp_flags =
+		RTE_TCP_SYN_FLAG;
+	nb_left = rte_gro_reassemble(pkts, 1, ctx);
+	TEST_ASSERT_EQUAL(nb_left, 1, "SYN packet was not handed back");
+	rte_pktmbuf_free(pkts[0]);
+
+	nb_out = rte_gro_timeout_flush(ctx, 0, RTE_GRO_TCP_IPV6, pkts, BURST);
+	TEST_ASSERT_EQUAL(nb_out, 1, "Expected 1 flushed packet, got %u",
+			nb_out);
+	TEST_ASSERT_EQUAL(pkts[0]->pkt_len, sizeof(struct rte_ether_hdr) +
+			sizeof(struct rte_ipv6_hdr) +
+			sizeof(struct rte_tcp_hdr) + 3 * PAYLOAD_LEN,
+			"Wrong merged packet length %u", pkts[0]->pkt_len);
+	TEST_ASSERT_EQUAL(rte_be_to_cpu_32(rte_pktmbuf_mtod_offset(pkts[0],
+			struct rte_tcp_hdr *, pkts[0]->l2_len +
+			pkts[0]->l3_len)->sent_seq), 1,
+			"Merged packet does not start at the first segment");
+	rte_pktmbuf_free(pkts[0]);
+	TEST_ASSERT_EQUAL(rte_gro_get_pkt_count(ctx), 0,
+			"GRO context not empty after flush");
+
+	rte_gro_ctx_destroy(ctx);
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Segment a large TCP/IPv6 packet and check the lengths and sequence
+ * numbers of the resulting segments.
+ */
+static int
+test_gso_tcp6(void)
+{
+	struct rte_gso_ctx gso_ctx = {
+		.direct_pool = pkt_pool,
+		.indirect_pool = indirect_pool,
+		.gso_types = RTE_ETH_TX_OFFLOAD_TCP_TSO,
+		.gso_size = GSO_SEG_SIZE,
+	};
+	struct rte_mbuf *segs[BURST];
+	uint16_t hdr_len, pyld_len, total = 0;
+	uint32_t seq;
+	struct rte_mbuf *m;
+	int nb_segs, i;
+
+	m = build_tcp_pkt(true, 1000, 1, 0, 1000);
+	TEST_ASSERT_NOT_NULL(m, "Failed to build packet");
+	m->ol_flags |= RTE_MBUF_F_TX_TCP_SEG;
+	hdr_len = m->l2_len + m->l3_len + m->l4_len;
+	pyld_len = GSO_SEG_SIZE - hdr_len;
+
+	nb_segs = rte_gso_segment(m, &gso_ctx, segs, BURST);
+	TEST_ASSERT_EQUAL(nb_segs, (1000 + pyld_len - 1) / pyld_len,
+			"Unexpected number of GSO segments %d", nb_segs);
+
+	seq = 1;
+	for (i = 0; i < nb_segs; i++) {
+		struct rte_ipv6_hdr *ip = rte_pktmbuf_mtod_offset(segs[i],
+				struct rte_ipv6_hdr *, segs[i]->l2_len);
+		struct rte_tcp_hdr *tcp = (struct rte_tcp_hdr *)(ip + 1);
+
+		TEST_ASSERT_EQUAL(rte_be_to_cpu_16(ip->payload_len),
+				segs[i]->pkt_len - segs[i]->l2_len -
+				sizeof(*ip), "Wrong payload length");
+		TEST_ASSERT_EQUAL(rte_be_to_cpu_32(tcp->sent_seq), seq,
+				"Wrong sequence number in segment %d", i);
+		seq += segs[i]->pkt_len - hdr_len;
+		total += segs[i]->pkt_len - hdr_len;
+		rte_pktmbuf_free(segs[i]);
+	}
+	TEST_ASSERT_EQUAL(total, 1000, "Payload lost during GSO");
+	rte_pktmbuf_free(m);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_gro_setup(void)
+{
+	pkt_pool = rte_pktmbuf_pool_create("GRO_MBUF_POOL", NUM_MBUFS,
+			MBUF_CACHE_SIZE, 0, RTE_MBUF_DEFAULT_BUF_SIZE,
+			rte_socket_id());
+	if (pkt_pool == NULL) {
+		printf("%s: Error creating mempool\n", __func__);
+		return -1;
+	}
+
+	indirect_pool = rte_pktmbuf_pool_create("GRO_INDIRECT_POOL",
+			NUM_MBUFS, MBUF_CACHE_SIZE, 0, 0, rte_socket_id());
+	if (indirect_pool == NULL) {
+		printf("%s: Error creating mempool\n", __func__);
+		rte_mempool_free(pkt_pool);
+		pkt_pool = NULL;
+		return -1;
+	}
+
+	return 0;
+}
+
+static void
+test_gro_teardown(void)
+{
+	rte_mempool_free(indirect_pool);
+	indirect_pool = NULL;
+	rte_mempool_free(pkt_pool);
+	pkt_pool = NULL;
+}
+
+/*
+ * Measure the cost of rte_gro_reassemble_burst() on bursts made of
+ * PERF_FLOWS interleaved flows of in-order segments.
+ */
+static int
+test_gro_perf_burst(bool ipv6)
+{
+	struct rte_gro_param param = {
+		.gro_types = ipv6 ? RTE_GRO_TCP_IPV6 : RTE_GRO_TCP_IPV4,
+		.max_flow_num = PERF_FLOWS,
+		.max_item_per_flow = BURST,
+	};
+	struct rte_mbuf *pkts[BURST];
+	uint64_t start, cycles = 0;
+	uint16_t nb_gro, i, j;
+	unsigned int iter;
+
+	for (iter = 0; iter < PERF_ITERATIONS; iter++) {
+		for (i = 0; i < BURST; i++) {
+			j = i / PERF_FLOWS;
+			pkts[i] = build_tcp_pkt(ipv6, 1000 + i % PERF_FLOWS,
+					1 + j * PAYLOAD_LEN, j, PAYLOAD_LEN);
+			TEST_ASSERT_NOT_NULL(pkts[i], "Failed to build packet");
+		}
+
+		start = rte_rdtsc_precise();
+		nb_gro = rte_gro_reassemble_burst(pkts, BURST, &param);
+		cycles += rte_rdtsc_precise() - start;
+
+		TEST_ASSERT_EQUAL(nb_gro, PERF_FLOWS,
+				"Expected %u packets after GRO, got %u",
+				PERF_FLOWS, nb_gro);
+		rte_pktmbuf_free_bulk(pkts, nb_gro);
+	}
+
+	printf("TCP/IPv%c GRO burst: %.2f cycles/pkt\n", ipv6 ? '6' : '4',
+			(double)cycles / ((double)PERF_ITERATIONS * BURST));
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Insert a segment 'seg' of each of the 'nb_flows' flows into a GRO
+ * context, and return the cycles spent in rte_gro_reassemble().
+ */
+static int
+perf_flows_reassemble(bool ipv6, void *ctx, uint32_t nb_flows, uint32_t seg,
+		uint64_t *cycles)
+{
+	struct rte_mbuf *pkts[BURST];
+	uint64_t start;
+	uint32_t flow;
+	uint16_t nb, nb_left, i;
+
+	*cycles = 0;
+	for (flow = 0; flow < nb_flows; flow += nb) {
+		nb = RTE_MIN(nb_flows - flow, (uint32_t)BURST);
+		for (i = 0; i < nb; i++) {
+			pkts[i] = build_tcp_pkt(ipv6, flow + i + 1,
+					1 + seg * PAYLOAD_LEN, seg,
+					PAYLOAD_LEN);
+			TEST_ASSERT_NOT_NULL(pkts[i],
+					"Failed to build packet");
+		}
+
+		start = rte_rdtsc_precise();
+		nb_left = rte_gro_reassemble(pkts, nb, ctx);
+		*cycles += rte_rdtsc_precise() - start;
+		TEST_ASSERT_EQUAL(nb_left, 0,
+				"Packets not kept in GRO context");
+	}
+
+	return TEST_SUCCESS;
+}
+
+static void
+perf_flows_flush(void *ctx, uint64_t gro_types)
+{
+	struct rte_mbuf *pkts[BURST];
+	uint16_t nb;
+
+	do {
+		nb = rte_gro_timeout_flush(ctx, 0, gro_types, pkts, BURST);
+		rte_pktmbuf_free_bulk(pkts, nb);
+	} while (nb != 0);
+}
+
+/*
+ * Measure the per packet cost of rte_gro_reassemble() on a context
+ * holding up to 'nb_flows' flows: one segment of every flow is inserted
+ * as a new flow, then a second, in-order segment of every flow is
+ * merged, so the costs are dominated by finding a free slot and by the
+ * flow lookup. The context is then flushed and filled again, to check
+ * that the slots of the flushed flows are all reused.
+ */
+static int
+test_gro_perf_flows(bool ipv6, uint32_t nb_flows)
+{
+	struct rte_gro_param param = {
+		.gro_types = ipv6 ? RTE_GRO_TCP_IPV6 : RTE_GRO_TCP_IPV4,
+		.max_flow_num = nb_flows,
+		.max_item_per_flow = 2,
+		.socket_id = rte_socket_id(),
+	};
+	uint64_t insert_cycles = 0, merge_cycles = 0, cycles;
+	void *ctx;
+	int ret;
+
+	ctx = rte_gro_ctx_create(&param);
+	TEST_ASSERT_NOT_NULL(ctx, "Failed to create GRO context");
+
+	ret = perf_flows_reassemble(ipv6, ctx, nb_flows, 0, &insert_cycles);
+	if (ret == TEST_SUCCESS)
+		ret = perf_flows_reassemble(ipv6, ctx, nb_flows, 1,
+				&merge_cycles);
+	if (ret == TEST_SUCCESS &&
+			rte_gro_get_pkt_count(ctx) != nb_flows) {
+		printf("Expected %u packets in GRO context\n", nb_flows);
+		ret = TEST_FAILED;
+	}
+	perf_flows_flush(ctx, param.gro_types);
+
+	if (ret == TEST_SUCCESS)
+		ret = perf_flows_reassemble(ipv6, ctx, nb_flows, 0, &cycles);
+	if (ret == TEST_SUCCESS &&
+			rte_gro_get_pkt_count(ctx) != nb_flows) {
+		printf("Expected %u packets in refilled GRO context\n",
+				nb_flows);
+		ret = TEST_FAILED;
+	}
+	perf_flows_flush(ctx, param.gro_types);
+	rte_gro_ctx_destroy(ctx);
+
+	if (ret == TEST_SUCCESS)
+		printf("TCP/IPv%c GRO with %5u flows: "
+				"insert %.2f, merge %.2f cycles/pkt\n",
+				ipv6 ? '6' : '4', nb_flows,
+				(double)insert_cycles / nb_flows,
+				(double)merge_cycles / nb_flows);
+
+	return ret;
+}
+
+/* Sweep the number of flows held by a GRO context from 1 to 64K. */
+static int
+test_gro_perf_flow_sweep(bool ipv6)
+{
+	static const uint32_t nb_flows[] = {
+		1, 16, 256, 4096, PERF_SWEEP_MAX_FLOWS };
+	struct rte_mempool *mp = pkt_pool;
+	unsigned int i;
+	int ret = TEST_SUCCESS;
+
+	/* Twice as many mbufs as flows, small enough for a single segment */
+	pkt_pool = rte_pktmbuf_pool_create("GRO_PERF_POOL", PERF_SWEEP_MBUFS,
+			MBUF_CACHE_SIZE, 0, PERF_SWEEP_DATA_ROOM,
+			rte_socket_id());
+	if (pkt_pool == NULL) {
+		printf("%s: Error creating mempool\n", __func__);
+		pkt_pool = mp;
+		return TEST_FAILED;
+	}
+
+	for (i = 0; i < RTE_DIM(nb_flows) && ret == TEST_SUCCESS; i++)
+		ret = test_gro_perf_flows(ipv6, nb_flows[i]);
+
+	rte_mempool_free(pkt_pool);
+	pkt_pool = mp;
+
+	return ret;
+}
+
+static int
+test_gro_perf(void)
+{
+	int ret;
+
+	if (test_gro_setup() < 0)
+		return TEST_FAILED;
+
+	ret = test_gro_perf_burst(false);
+	if (ret == TEST_SUCCESS)
+		ret = test_gro_perf_burst(true);
+	if (ret == TEST_SUCCESS)
+		ret = test_gro_perf_flow_sweep(false);
+	if (ret == TEST_SUCCESS)
+		ret = test_gro_perf_flow_sweep(true);
+
+	test_gro_teardown();
+
+	return ret;
+}
+
+static struct unit_test_suite gro_test_suite = {
+	.setup = test_gro_setup,
+	.teardown = test_gro_teardown,
+	.suite_name = "GRO/GSO Unit Test Suite",
+	.unit_test_cases = {
+		TEST_CASE(test_gro_tcp4_burst),
+		TEST_CASE(test_gro_tcp6_burst),
+		TEST_CASE(test_gro_tcp6_ctx),
+		TEST_CASE(test_gso_tcp6),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_gro(void)
+{
+	return unit_test_suite_runner(&gro_test_suite);
+}
+
+REGISTER_TEST_COMMAND(gro_autotest, test_gro);
+REGISTER_TEST_COMMAND(gro_perf_autotest, test_gro_perf);
@@ -1001,6 +1001,321 @@ static int test_extendable_bucket(void)
 	return 0;
 }
 
+/*
+ * Fill a growable table from a small initial size, checking all the keys
+ * are found while the buckets are migrated, then delete half of them.
+ */
+#define GROW_MAX_ENTRIES 4096
+#define GROW_NUM_KEYS (GROW_MAX_ENTRIES * 3 / 4)
+static int test_growable(uint8_t rwc_lf)
+{
+	struct rte_hash_parameters params = {
+		.name = "test_growable",
+		.entries = GROW_MAX_ENTRIES,
+		.init_entries = 64,
+		.key_len = sizeof(uint32_t),
+		.hash_func = rte_jhash,
+		.hash_func_init_val = 0,
+		.socket_id = 0,
+		.extra_flag = RTE_HASH_EXTRA_FLAGS_GROWABLE,
+	};
+	static uint32_t keys[GROW_NUM_KEYS];
+	const void *key_ptrs[RTE_HASH_LOOKUP_BULK_MAX];
+	int32_t positions[RTE_HASH_LOOKUP_BULK_MAX];
+	struct rte_hash *handle;
+	const void *next_key;
+	void *data, *next_data;
+	uint32_t i, j, n, iter;
+	int32_t pos;
+
+	if (rwc_lf)
+		params.extra_flag |= RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF;
+
+	params.extra_flag |= RTE_HASH_EXTRA_FLAGS_EXT_TABLE;
+	handle = rte_hash_create(&params);
+	RETURN_IF_ERROR(handle != NULL,
+			"growable hash created with ext table");
+	params.extra_flag &= ~RTE_HASH_EXTRA_FLAGS_EXT_TABLE;
+
+	handle = rte_hash_create(&params);
+	RETURN_IF_ERROR(handle == NULL, "hash creation failed");
+
+	for (i = 0; i < GROW_NUM_KEYS; i++) {
+		keys[i] = i * 2654435761U;
+		pos = rte_hash_add_key_data(handle, &keys[i],
+				(void *)((uintptr_t)i));
+		RETURN_IF_ERROR(pos != 0, "failed to add key %u", i);
+
+		if ((i & 127) != 127)
+			continue;
+		RETURN_IF_ERROR((uint32_t)rte_hash_count(handle) != i + 1,
+				"wrong count %d after %u keys",
+				rte_hash_count(handle), i + 1);
+		for (j = 0; j <= i; j++) {
+			RETURN_IF_ERROR(rte_hash_lookup_data(handle,
+					&keys[j], &data) < 0 ||
+					data != (void *)((uintptr_t)j),
+					"failed to find key %u of %u", j, i + 1);
+		}
+	}
+
+	/* Bulk lookup, while the last growth may still be migrated */
+	for (i = 0; i < GROW_NUM_KEYS; i += n) {
+		n = RTE_MIN(GROW_NUM_KEYS - i,
+			    (uint32_t)RTE_HASH_LOOKUP_BULK_MAX);
+		for (j = 0; j < n; j++)
+			key_ptrs[j] = &keys[i + j];
+		rte_hash_lookup_bulk(handle, key_ptrs, n, positions);
+		for (j = 0; j < n; j++)
+			RETURN_IF_ERROR(positions[j] < 0,
+				"failed to bulk lookup key %u", i + j);
+	}
+
+	/* Delete the even keys */
+	for (i = 0; i < GROW_NUM_KEYS; i += 2) {
+		pos = rte_hash_del_key(handle, &keys[i]);
+		RETURN_IF_ERROR(pos < 0, "failed to delete key %u", i);
+		if (rwc_lf)
+			rte_hash_free_key_with_position(handle, pos);
+	}
+	for (i = 0; i < GROW_NUM_KEYS; i++) {
+		pos = rte_hash_lookup(handle, &keys[i]);
+		RETURN_IF_ERROR((i & 1) ? pos < 0 : pos != -ENOENT,
+				"wrong lookup of key %u: %d", i, pos);
+	}
+
+	n = 0;
+	iter = 0;
+	while (rte_hash_iterate(handle, &next_key, &next_data, &iter) >= 0) {
+		i = (uintptr_t)next_data;
+		RETURN_IF_ERROR(i >= GROW_NUM_KEYS || (i & 1) == 0 ||
+				memcmp(next_key, &keys[i], sizeof(keys[i])),
+				"wrong key %u iterated", i);
+		n++;
+	}
+	RETURN_IF_ERROR(n != GROW_NUM_KEYS / 2,
+			"%u keys iterated", n);
+
+	rte_hash_free(handle);
+	return 0;
+}
+
+/*
+ * Age the keys of a table: the even keys are not looked up after they are
+ * added, they are first reported and kept by an incremental scan, then
+ * deleted by a full one.
+ */
+#define AGE_ENTRIES 256
+#define AGE_NUM_KEYS (AGE_ENTRIES * 3 / 4)
+#define AGE_BUCKETS (AGE_ENTRIES / 8)
+#define AGE_TIMEOUT_MS 50
+
+struct age_count {
+	const uint32_t *keys;
+	uint32_t reported;
+	uint32_t errors;
+};
+
+static int
+age_keep_cb(void *arg, const void *key, void *data, int32_t position)
+{
+	struct age_count *c = arg;
+	uint32_t i = (uintptr_t)data;
+
+	RTE_SET_USED(position);
+	if (i >= AGE_NUM_KEYS || (i & 1) != 0 ||
+	    memcmp(key, &c->keys[i], sizeof(c->keys[i])) != 0)
+		c->errors++;
+	c->reported++;
+	return RTE_HASH_AGE_KEEP;
+}
+
+static int
+age_lookup_odd(struct rte_hash *handle, const uint32_t *keys)
+{
+	const void *key_ptrs[AGE_NUM_KEYS / 4];
+	int32_t positions[AGE_NUM_KEYS / 4];
+	uint32_t i, n = 0;
+
+	/* Half of the keys one by one, the others in bulk */
+	for (i = 1; i < AGE_NUM_KEYS / 2; i += 2)
+		if (rte_hash_lookup(handle, &keys[i]) < 0)
+			return -1;
+	for (; i < AGE_NUM_KEYS; i += 2)
+		key_ptrs[n++] = &keys[i];
+	if (rte_hash_lookup_bulk(handle, key_ptrs, n, positions) != 0)
+		return -1;
+	for (i = 0; i < n; i++)
+		if (positions[i] < 0)
+			return -1;
+	return 0;
+}
+
+static int test_aging(uint32_t extra_flag)
+{
+	struct rte_hash_parameters params = {
+		.name = "test_aging",
+		.entries = AGE_ENTRIES,
+		.key_len = sizeof(uint32_t),
+		.hash_func = rte_jhash,
+		.hash_func_init_val = 0,
+		.socket_id = 0,
+		.extra_flag = RTE_HASH_EXTRA_FLAGS_AGING | extra_flag,
+	};
+	static uint32_t keys[AGE_NUM_KEYS];
+	struct age_count count = { .keys = keys };
+	struct rte_hash *handle;
+	uint32_t i;
+	int32_t pos;
+	int ret;
+
+	handle = rte_hash_create(&params);
+	RETURN_IF_ERROR(handle == NULL, "hash creation failed");
+
+	for (i = 0; i < AGE_NUM_KEYS; i++) {
+		keys[i] = i * 2654435761U;
+		pos = rte_hash_add_key_data(handle, &keys[i],
+				(void *)((uintptr_t)i));
+		RETURN_IF_ERROR(pos < 0, "failed to add key %u", i);
+	}
+
+	/* A scan with no budget only advances the clock */
+	rte_delay_ms(2 * AGE_TIMEOUT_MS);
+	ret = rte_hash_age_scan(handle, AGE_TIMEOUT_MS, 0, NULL, NULL);
+	RETURN_IF_ERROR(ret != 0, "empty scan returned %d", ret);
+	RETURN_IF_ERROR(age_lookup_odd(handle, keys) < 0,
+			"failed to lookup odd keys");
+
+	/* Report the unused keys, a few buckets at a time */
+	for (i = 0; i < AGE_BUCKETS; i += 4) {
+		ret = rte_hash_age_scan(handle, AGE_TIMEOUT_MS, 4,
+					age_keep_cb, &count);
+		RETURN_IF_ERROR(ret < 0, "scan failed: %d", ret);
+	}
+	RETURN_IF_ERROR(count.errors != 0 || count.reported != AGE_NUM_KEYS / 2,
+			"%u keys reported, %u errors",
+			count.reported, count.errors);
+	RETURN_IF_ERROR(rte_hash_count(handle) != AGE_NUM_KEYS,
+			"keys deleted by a keeping scan");
+
+	/* The kept keys were refreshed */
+	ret = rte_hash_age_scan(handle, AGE_TIMEOUT_MS, UINT32_MAX, NULL, NULL);
+	RETURN_IF_ERROR(ret != 0, "%d kept keys expired", ret);
+
+	/* Delete the unused keys */
+	rte_delay_ms(2 * AGE_TIMEOUT_MS);
+	ret = rte_hash_age_scan(handle, AGE_TIMEOUT_MS, 0, NULL, NULL);
+	RETURN_IF_ERROR(ret != 0, "empty scan returned %d", ret);
+	RETURN_IF_ERROR(age_lookup_odd(handle, keys) < 0,
+			"failed to lookup odd keys");
+	ret = rte_hash_age_scan(handle, AGE_TIMEOUT_MS, UINT32_MAX, NULL, NULL);
+	RETURN_IF_ERROR(ret != AGE_NUM_KEYS / 2, "%d keys expired", ret);
+	RETURN_IF_ERROR(rte_hash_count(handle) != AGE_NUM_KEYS / 2,
+			"wrong count %d after aging", rte_hash_count(handle));
+	for (i = 0; i < AGE_NUM_KEYS; i++) {
+		pos = rte_hash_lookup(handle, &keys[i]);
+		RETURN_IF_ERROR((i & 1) ? pos < 0 : pos != -ENOENT,
+				"wrong lookup of key %u: %d", i, pos);
+	}
+
+	/* The keys found since the previous scan are kept, even when the
+	 * scans are further apart than the timeout.
+	 */
+	for (i = 0; i < 2; i++) {
+		rte_delay_ms(2 * AGE_TIMEOUT_MS);
+		RETURN_IF_ERROR(age_lookup_odd(handle, keys) < 0,
+				"failed to lookup odd keys");
+		ret = rte_hash_age_scan(handle, AGE_TIMEOUT_MS, UINT32_MAX,
+					NULL, NULL);
+		RETURN_IF_ERROR(ret != 0, "%d used keys expired", ret);
+	}
+	rte_delay_ms(2 * AGE_TIMEOUT_MS);
+	ret = rte_hash_age_scan(handle, AGE_TIMEOUT_MS, UINT32_MAX, NULL, NULL);
+	RETURN_IF_ERROR(ret != AGE_NUM_KEYS / 2, "%d keys expired", ret);
+	RETURN_IF_ERROR(rte_hash_count(handle) != 0,
+			"wrong count %d after aging", rte_hash_count(handle));
+
+	rte_hash_free(handle);
+
+	/* Aging is not enabled */
+	params.extra_flag = extra_flag;
+	handle = rte_hash_create(&params);
+	RETURN_IF_ERROR(handle == NULL, "hash creation failed");
+	ret = rte_hash_age_scan(handle, AGE_TIMEOUT_MS, 1, NULL, NULL);
+	rte_hash_free(handle);
+	RETURN_IF_ERROR(ret != -EINVAL, "scan without aging returned %d", ret);
+
+	return 0;
+}
+
+/*
+ * Look up, in one streaming call, the keys of a table filled past its
+ * buckets into extendable ones, interleaved with keys not in the table.
+ */
+#define STREAM_ENTRIES 1024
+#define STREAM_NUM_KEYS (2 * STREAM_ENTRIES)
+static int test_lookup_stream(uint32_t extra_flag)
+{
+	struct rte_hash_parameters params = {
+		.name = "test_lookup_stream",
+		.entries = STREAM_ENTRIES,
+		.key_len = sizeof(uint32_t),
+		.hash_func = rte_jhash,
+		.hash_func_init_val = 0,
+		.socket_id = 0,
+		.extra_flag = extra_flag,
+	};
+	static uint32_t keys[STREAM_NUM_KEYS];
+	static const void *key_ptrs[STREAM_NUM_KEYS];
+	static int32_t added[STREAM_NUM_KEYS], positions[STREAM_NUM_KEYS];
+	static void *data[STREAM_NUM_KEYS];
+	struct rte_hash *handle;
+	uint32_t i, num_added = 0;
+	int ret;
+
+	handle = rte_hash_create(&params);
+	RETURN_IF_ERROR(handle == NULL, "hash creation failed");
+
+	for (i = 0; i < STREAM_NUM_KEYS; i++) {
+		keys[i] = i * 2654435761U;
+		key_ptrs[i] = &keys[i];
+		added[i] = -ENOENT;
+		if (i & 1)
+			continue;
+		if (rte_hash_add_key_data(handle, &keys[i],
+				(void *)((uintptr_t)i)) != 0)
+			continue;
+		added[i] = rte_hash_lookup(handle, &keys[i]);
+		RETURN_IF_ERROR(added[i] < 0, "failed to find key %u", i);
+		num_added++;
+	}
+	RETURN_IF_ERROR(num_added < STREAM_ENTRIES * 3 / 4,
+			"only %u keys added", num_added);
+
+	ret = rte_hash_lookup_stream(handle, key_ptrs, STREAM_NUM_KEYS,
+				     positions, data);
+	RETURN_IF_ERROR(ret != (int)num_added,
+			"%d keys found, %u added", ret, num_added);
+	for (i = 0; i < STREAM_NUM_KEYS; i++) {
+		RETURN_IF_ERROR(positions[i] != added[i],
+				"key %u found at %d, added at %d",
+				i, positions[i], added[i]);
+		RETURN_IF_ERROR(added[i] >= 0 &&
+				data[i] != (void *)((uintptr_t)i),
+				"wrong data for key %u", i);
+	}
+
+	/* Fewer keys than the pipeline depth, without data */
+	ret = rte_hash_lookup_stream(handle, key_ptrs, 3, positions, NULL);
+	RETURN_IF_ERROR(ret != (added[0] >= 0) + (added[2] >= 0) ||
+			positions[0] != added[0] || positions[1] != -ENOENT ||
+			positions[2] != added[2],
+			"wrong lookup of 3 keys");
+
+	rte_hash_free(handle);
+	return 0;
+}
+
 /******************************************************************************/
 static int
 fbk_hash_unit_test(void)
@@ -2225,6 +2540,23 @@ test_hash(void)
 		return -1;
 	if (test_extendable_bucket() < 0)
 		return -1;
+	if (test_growable(0) < 0)
+		return -1;
+	if (test_growable(1) < 0)
+		return -1;
+	if (test_aging(RTE_HASH_EXTRA_FLAGS_EXT_TABLE) < 0)
+		return -1;
+	if (test_aging(RTE_HASH_EXTRA_FLAGS_GROWABLE) < 0)
+		return -1;
+	if (test_lookup_stream(0) < 0)
+		return -1;
+	if (test_lookup_stream(RTE_HASH_EXTRA_FLAGS_EXT_TABLE) < 0)
+		return -1;
+	if (test_lookup_stream(RTE_HASH_EXTRA_FLAGS_EXT_TABLE |
+			RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF) < 0)
+		return -1;
+	if (test_lookup_stream(RTE_HASH_EXTRA_FLAGS_GROWABLE) < 0)
+		return -1;
 
 	if (test_fbk_hash_find_existing() < 0)
 		return -1;
@@ -719,6 +719,92 @@ fbk_hash_perf_test(void)
 	return 0;
 }
 
+#define STREAM_ENTRIES (1 << 24)	/* Entries of the table. */
+#define STREAM_KEYS (STREAM_ENTRIES * 3 / 4)	/* Keys added. */
+#define STREAM_LOOKUPS (1 << 22)	/* Keys looked up per measurement. */
+
+/*
+ * Compare, on a table much larger than the caches, lookups of random keys
+ * by bursts of RTE_HASH_LOOKUP_BULK_MAX with one streaming lookup.
+ */
+static int
+lookup_stream_perf_test(void)
+{
+	struct rte_hash_parameters params = {
+		.name = "stream_perf",
+		.entries = STREAM_ENTRIES,
+		.key_len = sizeof(uint64_t),
+		.hash_func = rte_hash_crc,
+		.socket_id = rte_socket_id(),
+	};
+	struct rte_hash *handle;
+	uint64_t *stream_keys = NULL;
+	const void **lookup_keys = NULL;
+	int32_t *lookup_pos = NULL;
+	uint64_t begin, bulk_cycles, stream_cycles;
+	unsigned int i, j, n;
+	int ret = -1;
+
+	handle = rte_hash_create(&params);
+	stream_keys = rte_malloc(NULL, STREAM_KEYS * sizeof(*stream_keys), 0);
+	lookup_keys = rte_malloc(NULL, STREAM_LOOKUPS * sizeof(*lookup_keys),
+				 0);
+	lookup_pos = rte_malloc(NULL, STREAM_LOOKUPS * sizeof(*lookup_pos), 0);
+	if (handle == NULL || stream_keys == NULL || lookup_keys == NULL ||
+			lookup_pos == NULL) {
+		printf("Cannot allocate the streaming lookup test table\n");
+		goto exit;
+	}
+
+	for (i = 0; i < STREAM_KEYS; i++) {
+		stream_keys[i] = rte_rand();
+		if (rte_hash_add_key(handle, &stream_keys[i]) < 0) {
+			printf("Cannot add key %u\n", i);
+			goto exit;
+		}
+	}
+	for (i = 0; i < STREAM_LOOKUPS; i++)
+		lookup_keys[i] = &stream_keys[rte_rand_max(STREAM_KEYS)];
+
+	begin = rte_rdtsc();
+	for (i = 0; i < STREAM_LOOKUPS; i += RTE_HASH_LOOKUP_BULK_MAX)
+		rte_hash_lookup_bulk(handle, &lookup_keys[i],
+				     RTE_HASH_LOOKUP_BULK_MAX, &lookup_pos[i]);
+	bulk_cycles = rte_rdtsc() - begin;
+
+	begin = rte_rdtsc();
+	n = rte_hash_lookup_stream(handle, lookup_keys, STREAM_LOOKUPS,
+				   lookup_pos, NULL);
+	stream_cycles = rte_rdtsc() - begin;
+
+	for (j = 0; j < STREAM_LOOKUPS; j++) {
+		if (lookup_pos[j] < 0) {
+			printf("Lookup %u failed\n", j);
+			goto exit;
+		}
+	}
+	if (n != STREAM_LOOKUPS) {
+		printf("Streaming lookup found %u keys\n", n);
+		goto exit;
+	}
+
+	printf("\n\n *** Streaming lookup performance test results ***\n");
+	printf("%u keys in %u entries\n", STREAM_KEYS, STREAM_ENTRIES);
+	printf("Bulk lookup of %u keys: %.1f cycles per lookup\n",
+		RTE_HASH_LOOKUP_BULK_MAX,
+		(double)bulk_cycles / STREAM_LOOKUPS);
+	printf("Streaming lookup: %.1f cycles per lookup\n",
+		(double)stream_cycles / STREAM_LOOKUPS);
+	ret = 0;
+
+exit:
+	rte_free(lookup_pos);
+	rte_free(lookup_keys);
+	rte_free(stream_keys);
+	rte_hash_free(handle);
+	return ret;
+}
+
 static int
 test_hash_perf(void)
 {
@@ -746,6 +832,9 @@ test_hash_perf(void)
 	if (fbk_hash_perf_test() < 0)
 		return -1;
 
+	if (lookup_stream_perf_test() < 0)
+		return -1;
+
 	return 0;
 }
 
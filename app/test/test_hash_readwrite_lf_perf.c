@@ -42,6 +42,7 @@
 #define READ_PASS_NON_SHIFT_PATH 8
 #define BULK_LOOKUP 16
 #define READ_PASS_KEY_SHIFTS_EXTBKT 32
+#define READ_PASS_GROWTH 64
 
 #define WRITE_NO_KEY_SHIFT 0
 #define WRITE_KEY_SHIFT 1
@@ -62,6 +63,7 @@ struct rwc_perf {
 	uint32_t multi_rw[NUM_TEST - 1][2][NUM_TEST];
 	uint32_t w_ks_r_hit_extbkt[2][NUM_TEST];
 	uint32_t writer_add_del[NUM_TEST];
+	uint32_t w_grow_r_hit[2][NUM_TEST];
 };
 
 static struct rwc_perf rwc_lf_results, rwc_non_lf_results;
@@ -82,6 +84,7 @@ static struct {
 	uint32_t count_keys_non_shift_path;
 	uint32_t count_keys_extbkt;
 	uint32_t count_keys_ks_extbkt;
+	uint32_t count_keys_grow;
 	uint32_t single_insert;
 	struct rte_hash *h;
 } tbl_rwc_test_param;
@@ -586,6 +589,9 @@ test_rwc_reader(__rte_unused void *arg)
 	} else if (read_type & READ_PASS_KEY_SHIFTS_EXTBKT) {
 		keys = tbl_rwc_test_param.keys_ext_bkt;
 		read_cnt = tbl_rwc_test_param.count_keys_extbkt;
+	} else if (read_type & READ_PASS_GROWTH) {
+		keys = tbl_rwc_test_param.keys_no_ks;
+		read_cnt = tbl_rwc_test_param.count_keys_grow;
 	} else {
 		keys = tbl_rwc_test_param.keys_non_shift_path;
 		read_cnt = tbl_rwc_test_param.count_keys_non_shift_path;
@@ -1229,6 +1235,104 @@ test_hash_add_ks_lookup_hit_extbkt(struct rwc_perf *rwc_perf_results,
 	return -1;
 }
 
+/*
+ * Test lookup perf:
+ * Reader(s) lookup keys present in a growable table while the writer
+ * adds keys, growing the table several times.
+ */
+static int
+test_hash_add_grow_lookup_hit(struct rwc_perf *rwc_perf_results)
+{
+	struct rte_hash_parameters hash_params = {
+		.name = "tests_grow",
+		.entries = TOTAL_ENTRY,
+		.init_entries = TOTAL_ENTRY / 64,
+		.key_len = sizeof(uint32_t),
+		.hash_func = rte_hash_crc,
+		.hash_func_init_val = 0,
+		.socket_id = rte_socket_id(),
+		.extra_flag = RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF |
+			      RTE_HASH_EXTRA_FLAGS_GROWABLE,
+	};
+	unsigned int n, m;
+	uint64_t i;
+	uint8_t read_type = READ_PASS_GROWTH;
+
+	/* Readers lookup the keys added before they start */
+	tbl_rwc_test_param.count_keys_grow =
+		tbl_rwc_test_param.count_keys_no_ks / 16;
+
+	printf("\nTest: Hash add - growable table, read - hit\n");
+	for (m = 0; m < 2; m++) {
+		if (m == 1) {
+			printf("\n** With bulk-lookup **\n");
+			read_type |= BULK_LOOKUP;
+		}
+		for (n = 0; n < NUM_TEST; n++) {
+			unsigned int tot_lcore = rte_lcore_count();
+			if (tot_lcore < rwc_core_cnt[n] + 1)
+				return 0;
+
+			printf("\nNumber of readers: %u\n", rwc_core_cnt[n]);
+
+			__atomic_store_n(&greads, 0, __ATOMIC_RELAXED);
+			__atomic_store_n(&gread_cycles, 0, __ATOMIC_RELAXED);
+
+			/* The table is recreated as it does not shrink */
+			tbl_rwc_test_param.h = rte_hash_create(&hash_params);
+			if (tbl_rwc_test_param.h == NULL) {
+				printf("hash creation failed\n");
+				return -1;
+			}
+
+			for (i = 0; i < tbl_rwc_test_param.count_keys_grow;
+			     i++) {
+				if (rte_hash_add_key(tbl_rwc_test_param.h,
+					tbl_rwc_test_param.keys_no_ks + i) < 0)
+					goto err;
+			}
+
+			writer_done = 0;
+			for (i = 1; i <= rwc_core_cnt[n]; i++)
+				rte_eal_remote_launch(test_rwc_reader,
+						(void *)(uintptr_t)read_type,
+							enabled_core_ids[i]);
+
+			for (i = tbl_rwc_test_param.count_keys_grow;
+			     i < tbl_rwc_test_param.count_keys_no_ks; i++) {
+				if (rte_hash_add_key(tbl_rwc_test_param.h,
+					tbl_rwc_test_param.keys_no_ks + i)
+							< 0) {
+					printf("writer failed %"PRIu64"\n", i);
+					goto err;
+				}
+			}
+			writer_done = 1;
+
+			for (i = 1; i <= rwc_core_cnt[n]; i++)
+				if (rte_eal_wait_lcore(enabled_core_ids[i]) < 0)
+					goto err;
+
+			rte_hash_free(tbl_rwc_test_param.h);
+
+			unsigned long long cycles_per_lookup =
+				__atomic_load_n(&gread_cycles, __ATOMIC_RELAXED)
+				/ __atomic_load_n(&greads, __ATOMIC_RELAXED);
+			rwc_perf_results->w_grow_r_hit[m][n]
+						= cycles_per_lookup;
+			printf("Cycles per lookup: %llu\n", cycles_per_lookup);
+		}
+	}
+
+	return 0;
+
+err:
+	writer_done = 1;
+	rte_eal_mp_wait_lcore();
+	rte_hash_free(tbl_rwc_test_param.h);
+	return -1;
+}
+
 static struct rte_rcu_qsbr *rv;
 
 /*
@@ -1448,6 +1552,8 @@ test_hash_readwrite_lf_perf_main(void)
 		if (test_hash_rcu_qsbr_writer_perf(&rwc_lf_results, rwc_lf,
 						   htm, ext_bkt) < 0)
 			return -1;
+		if (test_hash_add_grow_lookup_hit(&rwc_lf_results) < 0)
+			return -1;
 	}
 	printf("\nTest lookup with read-write concurrency lock free support"
 	       " disabled\n");
@@ -1515,8 +1621,11 @@ test_hash_readwrite_lf_perf_main(void)
 				"%u\n\t\t\t\t\t\t\t\t",
 				rwc_lf_results.w_ks_r_miss[j][i]);
 			printf("Hash add - key-shifts, Hash lookup hit (ext_bkt)\t\t"
-				"%u\n\n\t\t\t\t",
+				"%u\n\t\t\t\t\t\t\t\t",
 				rwc_lf_results.w_ks_r_hit_extbkt[j][i]);
+			printf("Hash add - growable table, lookup - hit\t\t\t\t"
+				"%u\n\n\t\t\t\t",
+				rwc_lf_results.w_grow_r_hit[j][i]);
 
 			printf("Disabled\t");
 			if (htm)
@@ -176,6 +176,48 @@ static int test_latency_packet_forward(void)
 	return (ret >= 0) ? TEST_SUCCESS : TEST_FAILED;
 }
 
+/* Test case to get the latency percentiles of a Tx queue */
+static int test_latency_queue_percentile(void)
+{
+	struct rte_mbuf *pbuf[LATENCY_NUM_PACKETS] = { };
+	uint64_t p50, p99;
+	struct rte_mempool *mp;
+	char poolname[] = "mbuf_pool";
+	int ret;
+
+	/* Failure Test: Invalid queue and percentile */
+	ret = rte_latencystats_queue_percentile(portid,
+			RTE_MAX_QUEUES_PER_PORT, 50, &p50);
+	TEST_ASSERT(ret == -EINVAL, "Test Failed: invalid queue accepted");
+	ret = rte_latencystats_queue_percentile(portid, QUEUE_ID, 101, &p50);
+	TEST_ASSERT(ret == -EINVAL,
+			"Test Failed: invalid percentile accepted");
+
+	ret = test_get_mbuf_from_pool(&mp, pbuf, poolname);
+	TEST_ASSERT(ret >= 0, "allocate mbuf pool Failed");
+	ret = test_dev_start(portid, mp);
+	TEST_ASSERT(ret >= 0, "test_dev_start(%hu, %p) failed, error code: %d",
+			portid, mp, ret);
+
+	/* Packets are timestamped on the first Rx, measured on the next Tx */
+	ret = test_packet_forward(pbuf, portid, QUEUE_ID);
+	if (ret >= 0)
+		ret = test_packet_forward(pbuf, portid, QUEUE_ID);
+	rte_eth_dev_stop(portid);
+	test_put_mbuf_to_pool(mp, pbuf);
+	TEST_ASSERT(ret >= 0, "send pkts Failed");
+
+	/* Success Test: Percentiles of the sampled packets */
+	ret = rte_latencystats_queue_percentile(portid, QUEUE_ID, 50, &p50);
+	TEST_ASSERT(ret == 0, "Test Failed: no p50 latency, error %d", ret);
+	ret = rte_latencystats_queue_percentile(portid, QUEUE_ID, 99, &p99);
+	TEST_ASSERT(ret == 0, "Test Failed: no p99 latency, error %d", ret);
+	TEST_ASSERT(p50 <= p99, "Test Failed: p50 %"PRIu64" > p99 %"PRIu64,
+			p50, p99);
+
+	return TEST_SUCCESS;
+}
+
 static struct
 unit_test_suite latencystats_testsuite = {
 	.suite_name = "Latency Stats Unit Test Suite",
@@ -204,7 +246,12 @@ unit_test_suite latencystats_testsuite = {
 		 */
 		TEST_CASE_ST(NULL, NULL, test_latencystats_get),
 
-		/* Test Case 5: To check uninit of latency test */
+		/* Test Case 5: To check whether the latency percentiles
+		 * of a Tx queue are retrieved
+		 */
+		TEST_CASE_ST(NULL, NULL, test_latency_queue_percentile),
+
+		/* Test Case 6: To check uninit of latency test */
 		TEST_CASE_ST(NULL, NULL, test_latency_uninit),
 
 		TEST_CASES_END()
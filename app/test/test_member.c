@@ -665,6 +665,95 @@ test_member_loadfactor(void)
 	return 0;
 }
 
+/*
+ * Sequence of operations for the sketch setsummary
+ *
+ *  - add a few heavy keys many times and many light keys once
+ *  - query the heavy keys: no underestimation, bounded overestimation
+ *  - report the heavy hitters: all heavy keys by decreasing count
+ *  - reset: all counts back to 0
+ */
+#define SKETCH_TOP_K 8
+#define SKETCH_HEAVY_COUNT 1000
+#define SKETCH_LIGHT_KEYS 10000
+
+static int
+test_member_sketch(void)
+{
+	struct rte_member_setsum *setsum_sketch;
+	struct rte_member_parameters sketch_params = {
+		.name = "test_member_sketch",
+		.key_len = sizeof(uint32_t),
+		.type = RTE_MEMBER_TYPE_SKETCH,
+		.false_positive_rate = 0.01,
+		.error_rate = 0.001,
+		.top_k = SKETCH_TOP_K,
+		.prim_hash_seed = 1,
+		.sec_hash_seed = 11,
+		.socket_id = 0
+	};
+	void *hh_keys[SKETCH_TOP_K];
+	uint64_t hh_counts[SKETCH_TOP_K];
+	uint64_t count, total = 0;
+	uint32_t key, i;
+	int ret;
+
+	setsum_sketch = rte_member_create(&sketch_params);
+	TEST_ASSERT(setsum_sketch != NULL, "sketch creation failed");
+
+	/* Heavy key i is added (i + 1) * SKETCH_HEAVY_COUNT times */
+	for (key = 0; key < SKETCH_TOP_K; key++) {
+		for (i = 0; i < key + 1; i++) {
+			ret = rte_member_add_byte_count(setsum_sketch, &key,
+					SKETCH_HEAVY_COUNT);
+			TEST_ASSERT(ret == 0, "sketch add byte count failed");
+		}
+		total += (key + 1) * SKETCH_HEAVY_COUNT;
+	}
+	for (key = SKETCH_TOP_K; key < SKETCH_TOP_K + SKETCH_LIGHT_KEYS;
+			key++) {
+		ret = rte_member_add(setsum_sketch, &key, 1);
+		TEST_ASSERT(ret == 0, "sketch add failed");
+		total++;
+	}
+
+	for (key = 0; key < SKETCH_TOP_K; key++) {
+		ret = rte_member_query_count(setsum_sketch, &key, &count);
+		TEST_ASSERT(ret == 0, "sketch query failed");
+		TEST_ASSERT(count >= (key + 1) * SKETCH_HEAVY_COUNT &&
+				count <= (key + 1) * SKETCH_HEAVY_COUNT +
+				total * sketch_params.error_rate,
+				"sketch count of key %u out of bounds: %"PRIu64,
+				key, count);
+	}
+
+	ret = rte_member_report_heavyhitter(setsum_sketch, hh_keys, hh_counts);
+	TEST_ASSERT(ret == SKETCH_TOP_K, "sketch reported %d heavy hitters",
+			ret);
+	for (i = 0; i < SKETCH_TOP_K; i++) {
+		memcpy(&key, hh_keys[i], sizeof(key));
+		TEST_ASSERT(key == SKETCH_TOP_K - 1 - i,
+				"sketch heavy hitter %u is key %u", i, key);
+		TEST_ASSERT(i == 0 || hh_counts[i] <= hh_counts[i - 1],
+				"sketch heavy hitters not sorted");
+	}
+
+	/* Only the sketch counts keys */
+	TEST_ASSERT(rte_member_query_count(setsum_ht, &keys[0], &count) ==
+			-EINVAL, "query count of HT setsum should fail");
+
+	rte_member_reset(setsum_sketch);
+	key = SKETCH_TOP_K - 1;
+	rte_member_query_count(setsum_sketch, &key, &count);
+	TEST_ASSERT(count == 0, "sketch count not reset");
+	ret = rte_member_report_heavyhitter(setsum_sketch, hh_keys, hh_counts);
+	TEST_ASSERT(ret == 0, "sketch heavy hitters not reset");
+
+	rte_member_free(setsum_sketch);
+	printf("Sketch test success\n");
+	return 0;
+}
+
 static void
 perform_free(void)
 {
@@ -702,6 +791,10 @@ test_member(void)
 		perform_free();
 		return -1;
 	}
+	if (test_member_sketch() < 0) {
+		perform_free();
+		return -1;
+	}
 	if (test_member_loadfactor() < 0) {
 		rte_member_free(setsum_ht);
 		rte_member_free(setsum_cache);
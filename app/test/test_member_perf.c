@@ -24,6 +24,11 @@
 #define VBF_SET_CNT 16
 #define BURST_SIZE 64
 #define VBF_FALSE_RATE 0.03
+#define SKETCH_TOP_K 16
+#define SKETCH_ERROR_RATE 0.0001
+#define SKETCH_FALSE_RATE 0.01
+/* One add out of SKETCH_HEAVY_RATIO is for a heavy key */
+#define SKETCH_HEAVY_RATIO 2
 
 static unsigned int test_socket_id;
 
@@ -612,6 +617,104 @@ run_all_tbl_perf_tests(void)
 	return 0;
 }
 
+/* Array of the key indexes of the sketch traffic */
+static uint32_t sketch_stream[KEYS_TO_ADD];
+
+/*
+ * Measure the sketch add and query cost on a traffic where the first
+ * SKETCH_TOP_K keys are heavy hitters sharing 1 / SKETCH_HEAVY_RATIO of
+ * the adds, and check how many of them are reported.
+ */
+static int
+run_sketch_perf_tests(void)
+{
+	static uint64_t sketch_cycles[NUM_KEYSIZES][2];
+	static uint32_t sketch_found[NUM_KEYSIZES];
+	struct rte_member_parameters sketch_params = {
+		.name = "test_member_sketch",
+		.type = RTE_MEMBER_TYPE_SKETCH,
+		.false_positive_rate = SKETCH_FALSE_RATE,
+		.error_rate = SKETCH_ERROR_RATE,
+		.top_k = SKETCH_TOP_K,
+		.prim_hash_seed = 0,
+		.sec_hash_seed = 1,
+	};
+	struct rte_member_setsum *setsum;
+	struct member_perf_params params;
+	void *hh_keys[SKETCH_TOP_K];
+	uint64_t hh_counts[SKETCH_TOP_K];
+	uint64_t begin, count;
+	unsigned int i, j, k;
+	int ret;
+
+	printf("\nMeasuring sketch performance, please wait\n");
+	fflush(stdout);
+
+	for (i = 0; i < NUM_KEYSIZES; i++) {
+		if (setup_keys_and_data(&params, i, 0) < 0) {
+			printf("Could not create keys/data/table\n");
+			return -1;
+		}
+		perform_frees(&params);
+
+		for (j = 0; j < KEYS_TO_ADD; j++) {
+			if (rte_rand() % SKETCH_HEAVY_RATIO == 0)
+				sketch_stream[j] = rte_rand() % SKETCH_TOP_K;
+			else
+				sketch_stream[j] = SKETCH_TOP_K + rte_rand() %
+					(KEYS_TO_ADD - SKETCH_TOP_K);
+		}
+
+		sketch_params.key_len = params.key_size;
+		sketch_params.socket_id = test_socket_id;
+		setsum = rte_member_create(&sketch_params);
+		if (setsum == NULL) {
+			printf("sketch create fail\n");
+			return -1;
+		}
+
+		begin = rte_rdtsc();
+		for (j = 0; j < KEYS_TO_ADD; j++)
+			rte_member_add(setsum, &keys[sketch_stream[j]], 1);
+		sketch_cycles[i][0] = (rte_rdtsc() - begin) / KEYS_TO_ADD;
+
+		begin = rte_rdtsc();
+		for (j = 0; j < KEYS_TO_ADD; j++)
+			rte_member_query_count(setsum, &keys[sketch_stream[j]],
+					&count);
+		sketch_cycles[i][1] = (rte_rdtsc() - begin) / KEYS_TO_ADD;
+
+		ret = rte_member_report_heavyhitter(setsum, hh_keys, hh_counts);
+		sketch_found[i] = 0;
+		for (j = 0; j < (unsigned int)RTE_MAX(ret, 0); j++) {
+			for (k = 0; k < SKETCH_TOP_K; k++) {
+				if (memcmp(hh_keys[j], keys[k],
+						params.key_size) == 0) {
+					sketch_found[i]++;
+					break;
+				}
+			}
+		}
+
+		rte_member_free(setsum);
+		printf(".");
+		fflush(stdout);
+	}
+
+	printf("\nSketch results (in CPU cycles/operation)\n");
+	printf("-----------------------------------\n");
+	printf("\n%-18s%-18s%-18s%-18s\n",
+			"Keysize", "Add", "Query", "Heavy_found");
+	for (i = 0; i < NUM_KEYSIZES; i++) {
+		printf("%-18d", hashtest_key_lens[i]);
+		printf("%-18"PRIu64, sketch_cycles[i][0]);
+		printf("%-18"PRIu64, sketch_cycles[i][1]);
+		printf("%u/%u\n", sketch_found[i], SKETCH_TOP_K);
+	}
+
+	return 0;
+}
+
 static int
 test_member_perf(void)
 {
@@ -619,6 +722,9 @@ test_member_perf(void)
 	if (run_all_tbl_perf_tests() < 0)
 		return -1;
 
+	if (run_sketch_perf_tests() < 0)
+		return -1;
+
 	return 0;
 }
 
@@ -9,7 +9,10 @@
 #include <inttypes.h>
 #include <stdarg.h>
 #include <errno.h>
+#include <unistd.h>
 #include <sys/queue.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 
 #include <rte_common.h>
 #include <rte_eal_paging.h>
@@ -225,6 +228,335 @@ static int test_mempool_creation_with_invalid_flags(void)
 	return 0;
 }
 
+/*
+ * Objects put from another socket are buffered apart from the cache
+ * and returned to the pool in bulk.
+ */
+static int
+test_mempool_remote_free(void)
+{
+	const unsigned int n = RTE_MEMPOOL_RETURN_BUF_SIZE;
+	void *objs[2 * RTE_MEMPOOL_RETURN_BUF_SIZE];
+	struct rte_mempool_return_buf *buf;
+	struct rte_mempool *mp;
+	int socket_id = rte_socket_id();
+	unsigned int count;
+	int ret = 0;
+
+	mp = rte_mempool_create("test_remote_free", 1024, 64, 32, 0,
+		NULL, NULL, NULL, NULL, SOCKET_ID_ANY,
+		RTE_MEMPOOL_F_REMOTE_FREE);
+	if (mp != NULL || rte_errno != EINVAL) {
+		rte_mempool_free(mp);
+		RET_ERR();
+	}
+
+	mp = rte_mempool_create("test_remote_free", 1024, 64, 32, 0,
+		NULL, NULL, NULL, NULL, socket_id,
+		RTE_MEMPOOL_F_REMOTE_FREE);
+	if (mp == NULL)
+		RET_ERR();
+	buf = mp->return_bufs[rte_lcore_id()];
+	if (buf == NULL)
+		GOTO_ERR(ret, out);
+
+	/* local puts go to the cache */
+	if (rte_mempool_get_bulk(mp, objs, 8) < 0)
+		GOTO_ERR(ret, out);
+	rte_mempool_put_bulk(mp, objs, 8);
+	if (buf->len != 0)
+		GOTO_ERR(ret, out);
+
+	/* emulate an lcore of another socket */
+	mp->socket_id = socket_id + 1;
+
+	if (rte_mempool_get_bulk(mp, objs, RTE_DIM(objs)) < 0)
+		GOTO_ERR(ret, out);
+	count = rte_mempool_ops_get_count(mp);
+	rte_mempool_put_bulk(mp, objs, n);
+	if (buf->len != n || rte_mempool_ops_get_count(mp) != count ||
+	    rte_mempool_in_use_count(mp) != n)
+		GOTO_ERR(ret, out);
+
+	/* a full buffer is returned to the pool in one bulk */
+	rte_mempool_put(mp, objs[n]);
+	if (buf->len != 1 || rte_mempool_ops_get_count(mp) != count + n)
+		GOTO_ERR(ret, out);
+
+	rte_mempool_remote_flush(mp);
+	if (buf->len != 0 || rte_mempool_ops_get_count(mp) != count + n + 1)
+		GOTO_ERR(ret, out);
+
+	rte_mempool_put_bulk(mp, &objs[n + 1], n - 1);
+	rte_mempool_remote_flush(mp);
+	if (buf->len != 0 || rte_mempool_in_use_count(mp) != 0)
+		GOTO_ERR(ret, out);
+
+	rte_mempool_dump(stdout, mp);
+out:
+	mp->socket_id = socket_id;
+	rte_mempool_free(mp);
+	return ret;
+}
+
+/*
+ * An adaptive cache grows while its lcore mostly allocates from the pool
+ * and shrinks back when it rarely misses.
+ */
+static int
+test_mempool_adaptive_cache(void)
+{
+	struct rte_mempool_cache *cache;
+	struct rte_mempool *mp;
+	void *objs[32];
+	unsigned int i;
+	int ret = 0;
+
+	mp = rte_mempool_create("test_adaptive_cache", 4096, 64, 0, 0,
+		NULL, NULL, NULL, NULL, SOCKET_ID_ANY,
+		RTE_MEMPOOL_F_ADAPTIVE_CACHE);
+	if (mp != NULL || rte_errno != EINVAL) {
+		rte_mempool_free(mp);
+		RET_ERR();
+	}
+
+	mp = rte_mempool_create("test_adaptive_cache", 4096, 64, 256, 0,
+		NULL, NULL, NULL, NULL, SOCKET_ID_ANY,
+		RTE_MEMPOOL_F_ADAPTIVE_CACHE);
+	if (mp == NULL)
+		RET_ERR();
+	cache = rte_mempool_default_cache(mp, rte_lcore_id());
+	if (cache == NULL || cache->size != RTE_MEMPOOL_CACHE_ADAPT_MIN_SIZE ||
+	    cache->max_size != 256)
+		GOTO_ERR(ret, out);
+
+	/*
+	 * Objects are only taken from the cache: it grows until less than
+	 * one get in RTE_MEMPOOL_CACHE_ADAPT_GROW misses, i.e. to 256 for
+	 * bursts of 32.
+	 */
+	for (i = 0; i < 8 * RTE_MEMPOOL_CACHE_ADAPT_PERIOD; i++) {
+		if (rte_mempool_generic_get(mp, objs, 32, cache) < 0)
+			GOTO_ERR(ret, out);
+		rte_mempool_generic_put(mp, objs, 32, NULL);
+	}
+	if (cache->size != 256 || cache->flushthresh != 384)
+		GOTO_ERR(ret, out);
+
+	/* balanced gets and puts, with a rare miss: it shrinks back */
+	for (i = 0; i < 64 * RTE_MEMPOOL_CACHE_ADAPT_PERIOD; i++) {
+		if (rte_mempool_generic_get(mp, objs, 16, cache) < 0)
+			GOTO_ERR(ret, out);
+		rte_mempool_generic_put(mp, objs, 16,
+			i % 128 == 0 ? NULL : cache);
+	}
+	if (cache->size != RTE_MEMPOOL_CACHE_ADAPT_MIN_SIZE ||
+	    cache->len > cache->size || cache->hits == 0 ||
+	    cache->misses == 0)
+		GOTO_ERR(ret, out);
+
+	rte_mempool_cache_flush(cache, mp);
+	if (rte_mempool_in_use_count(mp) != 0)
+		GOTO_ERR(ret, out);
+out:
+	rte_mempool_free(mp);
+	return ret;
+}
+
+/*
+ * Send a command to the telemetry socket and read its reply, return -1
+ * if the socket is not available.
+ */
+static int
+mempool_telemetry_request(const char *cmd, char *buf, size_t len)
+{
+	struct sockaddr_un addr;
+	int sock, bytes;
+
+	sock = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+	if (sock < 0)
+		return -1;
+	addr.sun_family = AF_UNIX;
+	snprintf(addr.sun_path, sizeof(addr.sun_path),
+		"%s/dpdk_telemetry.v2", rte_eal_get_runtime_dir());
+	if (connect(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		close(sock);
+		return -1;
+	}
+
+	/* skip the greeting */
+	bytes = read(sock, buf, len - 1);
+	if (bytes >= 0 && write(sock, cmd, strlen(cmd)) >= 0)
+		bytes = read(sock, buf, len - 1);
+	else
+		bytes = -1;
+	close(sock);
+	if (bytes < 0)
+		return -1;
+	buf[bytes] = '\0';
+	return 0;
+}
+
+/*
+ * The /mempool/cache telemetry command lists the cache of the lcore even
+ * when it is empty, and reports hits only when they are counted.
+ */
+static int
+test_mempool_cache_telemetry(void)
+{
+	const char *cmd = "/mempool/cache,test_cache_telemetry";
+	struct rte_mempool_cache *cache;
+	struct rte_mempool *mp;
+	char lcore_name[32];
+	char buf[16384];
+	void *objs[16];
+	int counted;
+	int ret = 0;
+
+#ifdef RTE_LIBRTE_MEMPOOL_DEBUG
+	counted = 1;
+#else
+	counted = 0;
+#endif
+	snprintf(lcore_name, sizeof(lcore_name), "\"lcore_%u\"",
+		rte_lcore_id());
+
+	mp = rte_mempool_create("test_cache_telemetry", 4096, 64, 64, 0,
+		NULL, NULL, NULL, NULL, SOCKET_ID_ANY, 0);
+	if (mp == NULL)
+		RET_ERR();
+	cache = rte_mempool_default_cache(mp, rte_lcore_id());
+	if (rte_mempool_generic_get(mp, objs, RTE_DIM(objs), cache) < 0)
+		GOTO_ERR(ret, out);
+	rte_mempool_generic_put(mp, objs, RTE_DIM(objs), cache);
+	rte_mempool_cache_flush(cache, mp);
+
+	if (mempool_telemetry_request(cmd, buf, sizeof(buf)) < 0) {
+		printf("Telemetry socket not available, skipping\n");
+		goto out;
+	}
+	printf("%s: %s\n", cmd, buf);
+	if (strstr(buf, lcore_name) == NULL ||
+	    (strstr(buf, "\"hits\"") != NULL) != counted)
+		GOTO_ERR(ret, out);
+	rte_mempool_free(mp);
+
+	/* the hits of an adaptive cache are always counted */
+	mp = rte_mempool_create("test_cache_telemetry", 4096, 64, 256, 0,
+		NULL, NULL, NULL, NULL, SOCKET_ID_ANY,
+		RTE_MEMPOOL_F_ADAPTIVE_CACHE);
+	if (mp == NULL)
+		RET_ERR();
+	cache = rte_mempool_default_cache(mp, rte_lcore_id());
+	if (rte_mempool_generic_get(mp, objs, RTE_DIM(objs), cache) < 0)
+		GOTO_ERR(ret, out);
+	rte_mempool_generic_put(mp, objs, RTE_DIM(objs), cache);
+
+	if (mempool_telemetry_request(cmd, buf, sizeof(buf)) < 0)
+		GOTO_ERR(ret, out);
+	printf("%s: %s\n", cmd, buf);
+	if (strstr(buf, lcore_name) == NULL ||
+	    strstr(buf, "\"hit_rate_pct\"") == NULL)
+		GOTO_ERR(ret, out);
+out:
+	rte_mempool_free(mp);
+	return ret;
+}
+
+#define BUCKET_POOL_SIZE 1024
+
+static void *bucket_objs[BUCKET_POOL_SIZE];
+static void *bucket_blocks[BUCKET_POOL_SIZE];
+static unsigned int bucket_nb_blocks;
+
+/* Get all the buckets as contiguous blocks, then own them */
+static int
+test_mempool_bucket_steal_blocks(void *arg)
+{
+	struct rte_mempool *mp = arg;
+	struct rte_mempool_info info;
+	size_t stride;
+	unsigned int i, j;
+
+	stride = mp->header_size + mp->elt_size + mp->trailer_size;
+	if (rte_mempool_ops_get_info(mp, &info) < 0 ||
+	    rte_mempool_get_contig_blocks(mp, bucket_blocks,
+			bucket_nb_blocks) < 0)
+		RET_ERR();
+	if (rte_mempool_get_contig_blocks(mp, bucket_blocks, 1) == 0)
+		RET_ERR();
+
+	for (i = 0; i < bucket_nb_blocks; i++)
+		for (j = 0; j < info.contig_block_size; j++)
+			rte_mempool_put(mp,
+				RTE_PTR_ADD(bucket_blocks[i], j * stride));
+	return 0;
+}
+
+/*
+ * The full buckets of the bucket driver are owned by the lcore which
+ * returned their objects: the other lcores steal them once the buckets
+ * they own and the shared ones run dry.
+ */
+static int
+test_mempool_bucket(void)
+{
+	struct rte_mempool_info info;
+	struct rte_mempool *mp;
+	unsigned int lcore_id, avail, i, n;
+	int ret = 0;
+
+	lcore_id = rte_get_next_lcore(-1, 1, 0);
+	if (lcore_id >= RTE_MAX_LCORE) {
+		printf("Need at least 2 lcores for bucket mempool test\n");
+		return 0;
+	}
+
+	mp = rte_mempool_create_empty("test_bucket", BUCKET_POOL_SIZE,
+		64, 0, 0, SOCKET_ID_ANY, 0);
+	if (mp == NULL)
+		RET_ERR();
+	if (rte_mempool_set_ops_byname(mp, "bucket", NULL) < 0) {
+		printf("bucket mempool handler not available\n");
+		goto out;
+	}
+	if (rte_mempool_populate_default(mp) < 0 ||
+	    rte_mempool_ops_get_info(mp, &info) < 0 ||
+	    info.contig_block_size == 0)
+		GOTO_ERR(ret, out);
+	avail = rte_mempool_avail_count(mp);
+
+	/* take all the whole buckets, the main lcore then owns them */
+	for (n = 0; n + info.contig_block_size <= BUCKET_POOL_SIZE;
+	     n += info.contig_block_size)
+		if (rte_mempool_get_bulk(mp, &bucket_objs[n],
+				info.contig_block_size) < 0)
+			break;
+	if (n == 0)
+		GOTO_ERR(ret, out);
+	rte_mempool_put_bulk(mp, bucket_objs, n);
+	bucket_nb_blocks = n / info.contig_block_size;
+
+	/* a worker steals them as contiguous blocks in one call */
+	rte_eal_remote_launch(test_mempool_bucket_steal_blocks, mp, lcore_id);
+	if (rte_eal_wait_lcore(lcore_id) < 0)
+		GOTO_ERR(ret, out);
+
+	/* the main lcore steals them back as whole buckets in one call */
+	if (rte_mempool_get_bulk(mp, bucket_objs, n) < 0)
+		GOTO_ERR(ret, out);
+	for (i = 1; i < n; i++)
+		if (bucket_objs[i] == bucket_objs[i - 1])
+			GOTO_ERR(ret, out);
+	rte_mempool_put_bulk(mp, bucket_objs, n);
+
+	if (rte_mempool_avail_count(mp) != avail)
+		GOTO_ERR(ret, out);
+out:
+	rte_mempool_free(mp);
+	return ret;
+}
+
 static struct rte_mempool *mp_spsc;
 static rte_spinlock_t scsp_spinlock;
 static void *scsp_obj_table[MAX_KEEP];
@@ -1004,6 +1336,18 @@ test_mempool(void)
 	if (test_mempool_creation_with_invalid_flags() < 0)
 		GOTO_ERR(ret, err);
 
+	if (test_mempool_remote_free() < 0)
+		GOTO_ERR(ret, err);
+
+	if (test_mempool_adaptive_cache() < 0)
+		GOTO_ERR(ret, err);
+
+	if (test_mempool_cache_telemetry() < 0)
+		GOTO_ERR(ret, err);
+
+	if (test_mempool_bucket() < 0)
+		GOTO_ERR(ret, err);
+
 	if (test_mempool_same_name_twice_creation() < 0)
 		GOTO_ERR(ret, err);
 
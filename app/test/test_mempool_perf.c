@@ -50,6 +50,16 @@
  *      - One core with user-owned cache
  *      - Two cores with user-owned cache
  *      - Max. cores with user-owned cache
+ *      - One core with adaptive cache
+ *      - Two cores with adaptive cache
+ *      - Max. cores with adaptive cache
+ *      - One core with cache, putting from another socket
+ *      - Two cores with cache, putting from another socket
+ *      - Max. cores with cache, putting from another socket
+ *      - One core without cache, for each of the ring_mp_mc, stack and
+ *        bucket handlers
+ *      - Two cores without cache, for each handler
+ *      - Max. cores without cache, for each handler
  *
  *    - Bulk size (*n_get_bulk*, *n_put_bulk*)
  *
@@ -60,6 +70,9 @@
  *
  *      - 32
  *      - 128
+ *
+ *    Finally, with the bucket handler, getting 1, 4 and 16 contiguous blocks
+ *    of objects at a time is compared to getting as many objects in bulk.
  */
 
 #define N 65536
@@ -184,6 +197,7 @@ per_lcore_mempool_test(void *arg)
 		rte_mempool_cache_flush(cache, mp);
 		rte_mempool_cache_free(cache);
 	}
+	rte_mempool_remote_flush(mp);
 
 	return ret;
 }
@@ -208,7 +222,7 @@ launch_cores(struct rte_mempool *mp, unsigned int cores)
 		   external_cache_size : (unsigned) mp->cache_size,
 	       cores, n_get_bulk, n_put_bulk, n_keep);
 
-	if (rte_mempool_avail_count(mp) != MEMPOOL_SIZE) {
+	if (rte_mempool_avail_count(mp) != mp->size) {
 		printf("mempool is not full\n");
 		return -1;
 	}
@@ -249,6 +263,108 @@ launch_cores(struct rte_mempool *mp, unsigned int cores)
 	return 0;
 }
 
+/*
+ * Get blocks of contiguous objects and put the objects back, then get
+ * and put as many objects in bulk, on one core.
+ */
+static int
+test_contig_blocks_perf(struct rte_mempool *mp)
+{
+	static const unsigned int n_blocks_tab[] = { 1, 4, 16 };
+	void *blocks[16];
+	struct rte_mempool_info info;
+	uint64_t hz = rte_get_timer_hz();
+	uint64_t start_cycles, time_diff;
+	uint64_t contig_count, bulk_count;
+	unsigned int i, b, k, n, n_blocks;
+	void **objs;
+	size_t stride;
+	int ret = 0;
+
+	if (rte_mempool_ops_get_info(mp, &info) < 0 ||
+	    info.contig_block_size == 0)
+		RET_ERR();
+	stride = mp->header_size + mp->elt_size + mp->trailer_size;
+	objs = malloc(mp->size * sizeof(void *));
+	if (objs == NULL)
+		RET_ERR();
+
+	for (i = 0; i < RTE_DIM(n_blocks_tab); i++) {
+		n_blocks = n_blocks_tab[i];
+		n = n_blocks * info.contig_block_size;
+		if (n > rte_mempool_avail_count(mp))
+			break;
+
+		contig_count = 0;
+		time_diff = 0;
+		start_cycles = rte_get_timer_cycles();
+		while (time_diff / hz < TIME_S) {
+			if (rte_mempool_get_contig_blocks(mp, blocks,
+					n_blocks) < 0)
+				GOTO_ERR(ret, out);
+			for (b = 0; b < n_blocks; b++)
+				for (k = 0; k < info.contig_block_size; k++)
+					objs[b * info.contig_block_size + k] =
+						RTE_PTR_ADD(blocks[b],
+							k * stride);
+			rte_mempool_put_bulk(mp, objs, n);
+			contig_count += n;
+			time_diff = rte_get_timer_cycles() - start_cycles;
+		}
+
+		bulk_count = 0;
+		time_diff = 0;
+		start_cycles = rte_get_timer_cycles();
+		while (time_diff / hz < TIME_S) {
+			if (rte_mempool_get_bulk(mp, objs, n) < 0)
+				GOTO_ERR(ret, out);
+			rte_mempool_put_bulk(mp, objs, n);
+			bulk_count += n;
+			time_diff = rte_get_timer_cycles() - start_cycles;
+		}
+
+		printf("mempool_autotest contig_blocks=%u objs=%u "
+		       "rate_persec=%" PRIu64 " bulk_rate_persec=%" PRIu64 "\n",
+		       n_blocks, n, contig_count / TIME_S,
+		       bulk_count / TIME_S);
+	}
+
+out:
+	free(objs);
+	return ret;
+}
+
+/* create a mempool (without cache) using the given handler */
+static struct rte_mempool *
+create_pool_by_ops(const char *ops_name)
+{
+	char name[RTE_MEMPOOL_NAMESIZE];
+	struct rte_mempool *mp;
+
+	snprintf(name, sizeof(name), "perf_test_%s", ops_name);
+	mp = rte_mempool_create_empty(name, MEMPOOL_SIZE, MEMPOOL_ELT_SIZE,
+				      0, 0, SOCKET_ID_ANY, 0);
+	if (mp == NULL) {
+		printf("cannot allocate %s mempool\n", ops_name);
+		return NULL;
+	}
+
+	if (rte_mempool_set_ops_byname(mp, ops_name, NULL) < 0) {
+		printf("cannot set %s handler\n", ops_name);
+		rte_mempool_free(mp);
+		return NULL;
+	}
+
+	if (rte_mempool_populate_default(mp) < 0) {
+		printf("cannot populate %s mempool\n", ops_name);
+		rte_mempool_free(mp);
+		return NULL;
+	}
+
+	rte_mempool_obj_iter(mp, my_obj_init, NULL);
+	return mp;
+}
+
 /* for a given number of core, launch all test cases */
 static int
 do_one_mempool_test(struct rte_mempool *mp, unsigned int cores)
@@ -284,7 +400,14 @@ test_mempool_perf(void)
 	struct rte_mempool *mp_cache = NULL;
 	struct rte_mempool *mp_nocache = NULL;
 	struct rte_mempool *default_pool = NULL;
+	struct rte_mempool *mp_remote = NULL;
+	struct rte_mempool *mp_adaptive = NULL;
+	struct rte_mempool *mp_ops = NULL;
+	static const char * const ops_names[] = {
+		"ring_mp_mc", "stack", "bucket"
+	};
 	const char *default_pool_ops;
+	unsigned int i;
 	int ret = -1;
 
 	/* create a mempool (without cache) */
@@ -382,6 +505,95 @@ test_mempool_perf(void)
 	if (do_one_mempool_test(mp_nocache, rte_lcore_count()) < 0)
 		goto err;
 
+	/* create a mempool (with adaptive cache) */
+	mp_adaptive = rte_mempool_create("perf_test_adaptive", MEMPOOL_SIZE,
+					 MEMPOOL_ELT_SIZE,
+					 RTE_MEMPOOL_CACHE_MAX_SIZE, 0,
+					 NULL, NULL,
+					 my_obj_init, NULL,
+					 SOCKET_ID_ANY,
+					 RTE_MEMPOOL_F_ADAPTIVE_CACHE);
+	if (mp_adaptive == NULL)
+		goto err;
+
+	/* performance test with 1, 2 and max cores */
+	printf("start performance test (with adaptive cache)\n");
+	use_external_cache = 0;
+
+	if (do_one_mempool_test(mp_adaptive, 1) < 0)
+		goto err;
+
+	if (do_one_mempool_test(mp_adaptive, 2) < 0)
+		goto err;
+
+	if (do_one_mempool_test(mp_adaptive, rte_lcore_count()) < 0)
+		goto err;
+
+	/*
+	 * Create a mempool (with cache) on the socket of the main lcore,
+	 * with room for the objects in the return buffers.
+	 */
+	mp_remote = rte_mempool_create("perf_test_remote",
+			MEMPOOL_SIZE +
+			rte_lcore_count() * RTE_MEMPOOL_RETURN_BUF_SIZE,
+			MEMPOOL_ELT_SIZE,
+			RTE_MEMPOOL_CACHE_MAX_SIZE, 0,
+			NULL, NULL,
+			my_obj_init, NULL,
+			rte_socket_id(), RTE_MEMPOOL_F_REMOTE_FREE);
+	if (mp_remote == NULL)
+		goto err;
+
+	/*
+	 * The lcores of the other sockets put remote objects. If all the
+	 * lcores are on one socket, emulate a mempool of another socket.
+	 */
+	if (rte_socket_count() == 1)
+		mp_remote->socket_id = rte_socket_id() + 1;
+
+	/* performance test with 1, 2 and max cores */
+	printf("start performance test (with cache, remote free)\n");
+	use_external_cache = 0;
+
+	if (do_one_mempool_test(mp_remote, 1) < 0)
+		goto err;
+
+	if (do_one_mempool_test(mp_remote, 2) < 0)
+		goto err;
+
+	if (do_one_mempool_test(mp_remote, rte_lcore_count()) < 0)
+		goto err;
+
+	for (i = 0; i < RTE_DIM(ops_names); i++) {
+		mp_ops = create_pool_by_ops(ops_names[i]);
+		if (mp_ops == NULL)
+			goto err;
+
+		/* performance test with 1, 2 and max cores */
+		printf("start performance test for %s (without cache)\n",
+		       ops_names[i]);
+		use_external_cache = 0;
+
+		if (do_one_mempool_test(mp_ops, 1) < 0)
+			goto err;
+
+		if (do_one_mempool_test(mp_ops, 2) < 0)
+			goto err;
+
+		if (do_one_mempool_test(mp_ops, rte_lcore_count()) < 0)
+			goto err;
+
+		if (strcmp(ops_names[i], "bucket") == 0) {
+			printf("start contiguous blocks performance test "
+			       "for %s\n", ops_names[i]);
+			if (test_contig_blocks_perf(mp_ops) < 0)
+				goto err;
+		}
+
+		rte_mempool_free(mp_ops);
+		mp_ops = NULL;
+	}
+
 	rte_mempool_list_dump(stdout);
 
 	ret = 0;
@@ -390,6 +602,9 @@ test_mempool_perf(void)
 	rte_mempool_free(mp_cache);
 	rte_mempool_free(mp_nocache);
 	rte_mempool_free(default_pool);
+	rte_mempool_free(mp_remote);
+	rte_mempool_free(mp_adaptive);
+	rte_mempool_free(mp_ops);
 	return ret;
 }
 
@@ -0,0 +1,247 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 Microsoft Corporation
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <inttypes.h>
+
+#include <rte_cycles.h>
+#include <rte_errno.h>
+#include <rte_mbuf.h>
+#include <rte_mempool.h>
+#include <rte_pcapng.h>
+
+#include "test.h"
+
+/*
+ * Throughput of the pcapng capture path: formatting packets by copy or by
+ * reference, then writing them to a file one writev per burst or through
+ * the write buffer.
+ */
+
+#define BURST 32
+#define NUM_BURSTS 4096
+#define NUM_PKTS (BURST * 64)
+#define WRITE_BUFFER_SIZE (1024 * 1024)
+#define MAX_PKT_LEN 1500
+
+static const uint32_t pkt_lens[] = { 64, MAX_PKT_LEN };
+
+static struct rte_mempool *pkt_pool, *capture_pool;
+static struct rte_mbuf *pkts[NUM_PKTS];
+
+typedef struct rte_mbuf *(*capture_fn_t)(uint16_t port_id, uint32_t queue,
+		const struct rte_mbuf *m, struct rte_mempool *mp,
+		uint32_t length, uint64_t timestamp,
+		enum rte_pcapng_direction direction);
+
+static int
+fill_pkts(uint32_t pkt_len)
+{
+	unsigned int i;
+	char *data;
+
+	for (i = 0; i < NUM_PKTS; i++) {
+		rte_pktmbuf_reset(pkts[i]);
+		data = rte_pktmbuf_append(pkts[i], pkt_len);
+		if (data == NULL)
+			return -1;
+		memset(data, i, pkt_len);
+	}
+	return 0;
+}
+
+/* Check that a clone is formatted as a copy, with VLAN expansion */
+static int
+test_clone_format(uint32_t snaplen)
+{
+	static uint8_t copy_data[MAX_PKT_LEN + 256], clone_data[MAX_PKT_LEN + 256];
+	struct rte_mbuf *m = pkts[0], *mc = NULL, *mr = NULL;
+	uint64_t ts = rte_get_tsc_cycles();
+	const void *c, *r;
+	int ret = -1;
+
+	m->ol_flags |= RTE_MBUF_F_RX_VLAN_STRIPPED;
+	m->vlan_tci = 42;
+
+	mc = rte_pcapng_copy(0, 1, m, capture_pool, snaplen, ts,
+			     RTE_PCAPNG_DIRECTION_IN);
+	mr = rte_pcapng_clone(0, 1, m, capture_pool, snaplen, ts,
+			      RTE_PCAPNG_DIRECTION_IN);
+	if (mc == NULL || mr == NULL) {
+		printf("Cannot format packet\n");
+		goto exit;
+	}
+
+	c = rte_pktmbuf_read(mc, 0, rte_pktmbuf_pkt_len(mc), copy_data);
+	r = rte_pktmbuf_read(mr, 0, rte_pktmbuf_pkt_len(mr), clone_data);
+	if (rte_pktmbuf_pkt_len(mc) != rte_pktmbuf_pkt_len(mr) ||
+	    memcmp(c, r, rte_pktmbuf_pkt_len(mc)) != 0) {
+		printf("Clone of %u bytes differs from copy\n", snaplen);
+		goto exit;
+	}
+	ret = 0;
+exit:
+	m->ol_flags &= ~RTE_MBUF_F_RX_VLAN_STRIPPED;
+	rte_pktmbuf_free(mc);
+	rte_pktmbuf_free(mr);
+	return ret;
+}
+
+static int
+test_capture(const char *name, capture_fn_t capture, uint32_t pkt_len)
+{
+	struct rte_mbuf *mc[BURST];
+	uint64_t start, cycles = 0;
+	unsigned int i, j, b;
+
+	for (b = 0; b < NUM_BURSTS; b++) {
+		i = (b * BURST) % NUM_PKTS;
+
+		start = rte_rdtsc();
+		for (j = 0; j < BURST; j++) {
+			mc[j] = capture(0, 0, pkts[i + j], capture_pool,
+					UINT32_MAX, start,
+					RTE_PCAPNG_DIRECTION_IN);
+			if (mc[j] == NULL) {
+				printf("%s failed\n", name);
+				rte_pktmbuf_free_bulk(mc, j);
+				return -1;
+			}
+		}
+		rte_pktmbuf_free_bulk(mc, BURST);
+		cycles += rte_rdtsc() - start;
+	}
+
+	printf("%-6s %4u bytes: %8.2f cycles/pkt\n", name, pkt_len,
+	       (double)cycles / (NUM_BURSTS * BURST));
+	return 0;
+}
+
+static int
+test_write(capture_fn_t capture, uint32_t buf_size, uint32_t pkt_len)
+{
+	char file_name[] = "/tmp/pcapng_perf_XXXXXX";
+	struct rte_mbuf *mc[NUM_PKTS];
+	rte_pcapng_t *pcapng = NULL;
+	uint64_t start, cycles = 0, bytes = 0;
+	unsigned int i, b;
+	ssize_t len;
+	double secs;
+	int fd, ret = -1;
+
+	for (i = 0; i < NUM_PKTS; i++) {
+		mc[i] = capture(0, 0, pkts[i], capture_pool, UINT32_MAX,
+				rte_get_tsc_cycles(), RTE_PCAPNG_DIRECTION_IN);
+		if (mc[i] == NULL) {
+			printf("Cannot format packet\n");
+			rte_pktmbuf_free_bulk(mc, i);
+			return -1;
+		}
+	}
+
+	fd = mkstemp(file_name);
+	if (fd < 0) {
+		printf("Cannot create %s\n", file_name);
+		goto free_pkts;
+	}
+	unlink(file_name);
+
+	pcapng = rte_pcapng_fdopen(fd, NULL, NULL, "pcapng_perf", NULL);
+	if (pcapng == NULL) {
+		printf("Cannot open pcapng file: %s\n", rte_strerror(rte_errno));
+		close(fd);
+		goto free_pkts;
+	}
+	if (rte_pcapng_set_write_buffer(pcapng, buf_size) < 0) {
+		printf("Cannot set write buffer: %s\n",
+		       rte_strerror(rte_errno));
+		goto close;
+	}
+
+	start = rte_rdtsc();
+	for (b = 0; b < NUM_BURSTS; b++) {
+		i = (b * BURST) % NUM_PKTS;
+		len = rte_pcapng_write_packets(pcapng, &mc[i], BURST);
+		if (len < 0) {
+			printf("Write failed: %s\n", rte_strerror(rte_errno));
+			goto close;
+		}
+		bytes += len;
+	}
+	if (rte_pcapng_flush(pcapng) < 0) {
+		printf("Flush failed: %s\n", rte_strerror(rte_errno));
+		goto close;
+	}
+	cycles = rte_rdtsc() - start;
+
+	secs = (double)cycles / rte_get_tsc_hz();
+	printf("%-8s %4u bytes: %8.2f cycles/pkt, %7.2f Mpps, %8.1f MB/s\n",
+	       buf_size ? "buffered" : "writev", pkt_len,
+	       (double)cycles / (NUM_BURSTS * BURST),
+	       NUM_BURSTS * BURST / secs / 1e6, bytes / secs / 1e6);
+	ret = 0;
+close:
+	rte_pcapng_close(pcapng);
+free_pkts:
+	rte_pktmbuf_free_bulk(mc, NUM_PKTS);
+	return ret;
+}
+
+static int
+test_pcapng_perf(void)
+{
+	unsigned int i;
+	int ret = -1;
+
+	pkt_pool = rte_pktmbuf_pool_create("pcapng_perf_pkts", NUM_PKTS, 0, 0,
+					   RTE_MBUF_DEFAULT_BUF_SIZE,
+					   SOCKET_ID_ANY);
+	/* The clones need three mbufs per packet */
+	capture_pool = rte_pktmbuf_pool_create("pcapng_perf_capture",
+					       3 * NUM_PKTS, 0, 0,
+					       rte_pcapng_mbuf_size(MAX_PKT_LEN),
+					       SOCKET_ID_ANY);
+	if (pkt_pool == NULL || capture_pool == NULL) {
+		printf("Cannot create mbuf pools\n");
+		goto exit;
+	}
+
+	if (rte_pktmbuf_alloc_bulk(pkt_pool, pkts, NUM_PKTS) != 0) {
+		printf("Cannot allocate mbufs\n");
+		goto exit;
+	}
+
+	if (fill_pkts(MAX_PKT_LEN) < 0 ||
+	    test_clone_format(UINT32_MAX) < 0 ||
+	    test_clone_format(101) < 0)
+		goto free_pkts;
+
+	for (i = 0; i < RTE_DIM(pkt_lens); i++) {
+		if (fill_pkts(pkt_lens[i]) < 0 ||
+		    test_capture("copy", rte_pcapng_copy, pkt_lens[i]) < 0 ||
+		    test_capture("clone", rte_pcapng_clone, pkt_lens[i]) < 0)
+			goto free_pkts;
+	}
+
+	for (i = 0; i < RTE_DIM(pkt_lens); i++) {
+		if (fill_pkts(pkt_lens[i]) < 0 ||
+		    test_write(rte_pcapng_copy, 0, pkt_lens[i]) < 0 ||
+		    test_write(rte_pcapng_copy, WRITE_BUFFER_SIZE,
+			       pkt_lens[i]) < 0)
+			goto free_pkts;
+	}
+	ret = 0;
+
+free_pkts:
+	rte_pktmbuf_free_bulk(pkts, NUM_PKTS);
+exit:
+	rte_mempool_free(capture_pool);
+	rte_mempool_free(pkt_pool);
+	return ret;
+}
+
+REGISTER_TEST_COMMAND(pcapng_perf_autotest, test_pcapng_perf);
@@ -2,14 +2,23 @@
  * Copyright(c) 2018 Intel Corporation
  */
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <stdint.h>
+#include <stdbool.h>
+#include <inttypes.h>
 #include <limits.h>
 
 #include <ethdev_driver.h>
+#include <rte_cycles.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_udp.h>
 #include <rte_pdump.h>
 #include "rte_eal.h"
 #include "rte_lcore.h"
+#include "rte_malloc.h"
 #include "rte_mempool.h"
 #include "rte_ring.h"
 
@@ -20,6 +29,17 @@
 
 #define launch_p(ARGV) process_dup(ARGV, RTE_DIM(ARGV), __func__)
 
+#define SAMPLE_RATE 2
+#define SAMPLE_PKTS 64
+#define SAMPLE_NUM_FLOWS (NUM_PACKETS / 2)
+/* Time for the callbacks of the sender to see an enable or a disable */
+#define SAMPLE_SETTLE_MS 100
+/* The flows go from 192.0.2.(1 + flow):(1024 + flow) to 198.51.100.1:53 */
+#define SAMPLE_CLIENT_IP RTE_IPV4(192, 0, 2, 1)
+#define SAMPLE_SERVER_IP RTE_IPV4(198, 51, 100, 1)
+#define SAMPLE_CLIENT_PORT 1024
+#define SAMPLE_SERVER_PORT 53
+
 struct rte_ring *ring_server;
 uint16_t portid;
 uint16_t flag_for_send_pkts = 1;
@@ -43,12 +63,173 @@ test_pdump_init(void)
 	return ret;
 }
 
+/*
+ * Make the packets sent by the primary into the two directions of
+ * SAMPLE_NUM_FLOWS UDP flows. Like a NIC with a Toeplitz key, give them
+ * an RSS hash which is not the same for both directions of a flow.
+ */
+static int
+sample_fill_pkts(struct rte_mbuf **pbuf)
+{
+	const uint16_t len = sizeof(struct rte_ether_hdr) +
+		sizeof(struct rte_ipv4_hdr) + sizeof(struct rte_udp_hdr);
+	struct rte_ether_hdr *eth;
+	struct rte_ipv4_hdr *ip;
+	struct rte_udp_hdr *udp;
+	uint32_t client, server;
+	uint16_t client_port, server_port;
+	unsigned int i, flow;
+
+	for (i = 0; i < NUM_PACKETS; i++) {
+		flow = i / 2;
+		client = rte_cpu_to_be_32(SAMPLE_CLIENT_IP + flow);
+		server = rte_cpu_to_be_32(SAMPLE_SERVER_IP);
+		client_port = rte_cpu_to_be_16(SAMPLE_CLIENT_PORT + flow);
+		server_port = rte_cpu_to_be_16(SAMPLE_SERVER_PORT);
+
+		eth = (struct rte_ether_hdr *)rte_pktmbuf_append(pbuf[i], len);
+		if (eth == NULL)
+			return -1;
+		memset(eth, 0, len);
+		eth->ether_type = rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV4);
+		ip = (struct rte_ipv4_hdr *)(eth + 1);
+		ip->version_ihl = RTE_IPV4_VHL_DEF;
+		ip->time_to_live = 64;
+		ip->next_proto_id = IPPROTO_UDP;
+		ip->total_length = rte_cpu_to_be_16(len - sizeof(*eth));
+		udp = (struct rte_udp_hdr *)(ip + 1);
+		udp->dgram_len = rte_cpu_to_be_16(sizeof(*udp));
+		if (i % 2 == 0) {
+			ip->src_addr = client;
+			ip->dst_addr = server;
+			udp->src_port = client_port;
+			udp->dst_port = server_port;
+		} else {
+			ip->src_addr = server;
+			ip->dst_addr = client;
+			udp->src_port = server_port;
+			udp->dst_port = client_port;
+		}
+		pbuf[i]->hash.rss = i;
+		pbuf[i]->ol_flags |= RTE_MBUF_F_RX_RSS_HASH;
+	}
+	return 0;
+}
+
+static void
+sample_drain(struct rte_ring *ring)
+{
+	struct rte_mbuf *pkts[RING_SIZE];
+	unsigned int n;
+
+	while ((n = rte_ring_dequeue_burst(ring, (void **)pkts, RING_SIZE,
+					   NULL)) != 0)
+		rte_pktmbuf_free_bulk(pkts, n);
+}
+
+/*
+ * Capture the transmitted packets of the primary with sampling, and check
+ * the packets which were captured against the statistics. In flow mode,
+ * both directions of a flow must be captured, or neither.
+ */
+static int
+test_pdump_sample(struct rte_ring **rings, struct rte_mempool *mp,
+		  uint32_t flags)
+{
+	struct rte_mbuf *pkts[RING_SIZE];
+	struct rte_pdump_stats before, after;
+	struct rte_ipv4_hdr *ip;
+	int fwd[SAMPLE_NUM_FLOWS] = { 0 };
+	int rev[SAMPLE_NUM_FLOWS] = { 0 };
+	uint64_t sampled, seen;
+	unsigned int i, n = 0, flow, unpaired = 0;
+	bool reverse;
+	int ret = -1;
+
+	/* Let the previous captures end, and throw away what they left */
+	rte_delay_ms(SAMPLE_SETTLE_MS);
+	sample_drain(rings[0]);
+	if (rte_pdump_stats(portid, &before) < 0) {
+		printf("rte_pdump_stats failed\n");
+		goto out;
+	}
+
+	if (rte_pdump_enable_sample(portid, QUEUE_ID, flags, 0, SAMPLE_RATE,
+				    rings, 1, mp, NULL) < 0) {
+		printf("rte_pdump_enable_sample failed\n");
+		goto out;
+	}
+	for (i = 0; i < 100 && rte_ring_count(rings[0]) < SAMPLE_PKTS; i++)
+		rte_delay_ms(10);
+	if (rte_pdump_disable(portid, QUEUE_ID, flags) < 0) {
+		printf("rte_pdump_disable failed\n");
+		goto out;
+	}
+	rte_delay_ms(SAMPLE_SETTLE_MS);
+
+	if (rte_pdump_stats(portid, &after) < 0) {
+		printf("rte_pdump_stats failed\n");
+		goto out;
+	}
+	n = rte_ring_dequeue_burst(rings[0], (void **)pkts, RING_SIZE, NULL);
+
+	sampled = (after.accepted - before.accepted) +
+		(after.nombuf - before.nombuf);
+	seen = sampled + (after.skipped - before.skipped);
+	if (n == 0 || n != (after.accepted - before.accepted) -
+			  (after.ringfull - before.ringfull)) {
+		printf("%u packets captured, %"PRIu64" accepted, %"PRIu64
+		       " ring full\n", n, after.accepted - before.accepted,
+		       after.ringfull - before.ringfull);
+		goto out;
+	}
+
+	if (!(flags & RTE_PDUMP_FLAG_SAMPLE_FLOW)) {
+		if (sampled != seen / SAMPLE_RATE) {
+			printf("%"PRIu64" packets sampled out of %"PRIu64"\n",
+			       sampled, seen);
+			goto out;
+		}
+		ret = 0;
+		goto out;
+	}
+
+	for (i = 0; i < n; i++) {
+		ip = rte_pktmbuf_mtod_offset(pkts[i], struct rte_ipv4_hdr *,
+					     sizeof(struct rte_ether_hdr));
+		reverse = ip->src_addr == rte_cpu_to_be_32(SAMPLE_SERVER_IP);
+		flow = rte_be_to_cpu_32(reverse ? ip->dst_addr :
+					ip->src_addr) - SAMPLE_CLIENT_IP;
+		if (flow >= SAMPLE_NUM_FLOWS) {
+			printf("captured packet of unknown flow\n");
+			goto out;
+		}
+		if (reverse)
+			rev[flow]++;
+		else
+			fwd[flow]++;
+	}
+	/* Only the burst which filled the ring may be cut in a flow */
+	for (flow = 0; flow < SAMPLE_NUM_FLOWS; flow++)
+		unpaired += abs(fwd[flow] - rev[flow]);
+	if (unpaired > 1 || after.skipped == before.skipped) {
+		printf("%u packets captured without their reverse, %"PRIu64
+		       " skipped\n", unpaired, after.skipped - before.skipped);
+		goto out;
+	}
+	ret = 0;
+out:
+	rte_pktmbuf_free_bulk(pkts, n);
+	return ret;
+}
+
 int
 run_pdump_client_tests(void)
 {
 	int flags = RTE_PDUMP_FLAG_TX, ret = 0, itr;
 	char deviceid[] = "net_ring_net_ringa";
-	struct rte_ring *ring_client;
+	struct rte_ring *ring_client = NULL;
+	struct rte_ring **rings = NULL;
 	struct rte_mempool *mp = NULL;
 	struct rte_eth_dev *eth_dev = NULL;
 	char poolname[] = "mbuf_pool_client";
@@ -56,17 +237,31 @@ run_pdump_client_tests(void)
 	ret = test_get_mempool(&mp, poolname);
 	if (ret < 0)
 		return -1;
+	ret = -1;
 	mp->flags = 0x0000;
 	ring_client = rte_ring_create("SR0", RING_SIZE, rte_socket_id(), 0);
 	if (ring_client == NULL) {
 		printf("rte_ring_create SR0 failed");
-		return -1;
+		goto out;
+	}
+
+	/* The capture rings are read by the primary, keep them shared */
+	rings = rte_malloc(NULL, 2 * sizeof(*rings), 0);
+	if (rings == NULL) {
+		printf("rte_malloc of capture rings failed");
+		goto out;
+	}
+	rings[0] = ring_client;
+	rings[1] = rte_ring_create("SR1", RING_SIZE, rte_socket_id(), 0);
+	if (rings[1] == NULL) {
+		printf("rte_ring_create SR1 failed");
+		goto out;
 	}
 
 	eth_dev = rte_eth_dev_attach_secondary(deviceid);
 	if (!eth_dev) {
 		printf("Failed to probe %s", deviceid);
-		return -1;
+		goto out;
 	}
 	rte_eth_dev_probing_finish(eth_dev);
 
@@ -77,14 +272,14 @@ run_pdump_client_tests(void)
 				       mp, NULL);
 		if (ret < 0) {
 			printf("rte_pdump_enable failed\n");
-			return -1;
+			goto out;
 		}
 		printf("pdump_enable success\n");
 
 		ret = rte_pdump_disable(portid, QUEUE_ID, flags);
 		if (ret < 0) {
 			printf("rte_pdump_disable failed\n");
-			return -1;
+			goto out;
 		}
 		printf("pdump_disable success\n");
 
@@ -92,17 +287,33 @@ run_pdump_client_tests(void)
 						   ring_client, mp, NULL);
 		if (ret < 0) {
 			printf("rte_pdump_enable_by_deviceid failed\n");
-			return -1;
+			goto out;
 		}
 		printf("pdump_enable_by_deviceid success\n");
 
 		ret = rte_pdump_disable_by_deviceid(deviceid, QUEUE_ID, flags);
 		if (ret < 0) {
 			printf("rte_pdump_disable_by_deviceid failed\n");
-			return -1;
+			goto out;
 		}
 		printf("pdump_disable_by_deviceid success\n");
 
+		ret = rte_pdump_enable_sample(portid, RTE_PDUMP_ALL_QUEUES,
+					      flags | RTE_PDUMP_FLAG_SAMPLE_FLOW,
+					      0, 4, rings, 2, mp, NULL);
+		if (ret < 0) {
+			printf("rte_pdump_enable_sample failed\n");
+			goto out;
+		}
+		printf("pdump_enable_sample success\n");
+
+		ret = rte_pdump_disable(portid, RTE_PDUMP_ALL_QUEUES, flags);
+		if (ret < 0) {
+			printf("rte_pdump_disable failed\n");
+			goto out;
+		}
+		printf("pdump_disable success\n");
+
 		if (itr == 0) {
 			flags = RTE_PDUMP_FLAG_RX;
 			printf("\n***** flags = RTE_PDUMP_FLAG_RX *****\n");
@@ -111,10 +322,35 @@ run_pdump_client_tests(void)
 			printf("\n***** flags = RTE_PDUMP_FLAG_RXTX *****\n");
 		}
 	}
-	if (ring_client != NULL)
+
+	ret = test_pdump_sample(rings, mp, RTE_PDUMP_FLAG_TX);
+	if (ret < 0) {
+		printf("pdump sampling of packets failed\n");
+		goto out;
+	}
+	printf("pdump sampling of packets success\n");
+
+	ret = test_pdump_sample(rings, mp, RTE_PDUMP_FLAG_TX |
+				RTE_PDUMP_FLAG_SAMPLE_FLOW);
+	if (ret < 0) {
+		printf("pdump sampling of flows failed\n");
+		goto out;
+	}
+	printf("pdump sampling of flows success\n");
+
+out:
+	if (rings != NULL) {
+		if (rings[1] != NULL) {
+			sample_drain(rings[1]);
+			test_ring_free(rings[1]);
+		}
+		rte_free(rings);
+	}
+	if (ring_client != NULL) {
+		sample_drain(ring_client);
 		test_ring_free(ring_client);
-	if (mp != NULL)
-		test_mp_free(mp);
+	}
+	test_mp_free(mp);
 
 	return ret;
 }
@@ -147,6 +383,8 @@ send_pkts(void *empty)
 	ret = test_get_mbuf_from_pool(&mp, pbuf, poolname);
 	if (ret < 0)
 		printf("get_mbuf_from_pool failed\n");
+	else if (sample_fill_pkts(pbuf) < 0)
+		printf("sample_fill_pkts failed\n");
 
 	ret = test_dev_start(portid, mp);
 	if (ret < 0)
@@ -330,6 +330,171 @@ test_reorder_drain(void)
 	return ret;
 }
 
+static int
+test_reorder_insert_bulk(void)
+{
+	struct rte_reorder_buffer *b = NULL;
+	struct rte_mempool *p = test_params->p;
+	const unsigned int size = 8;
+	const unsigned int num_bufs = 6;
+	const rte_reorder_seqn_t seqn[] = {0, 3, 1, 2, 5, 4};
+	struct rte_mbuf *bufs[num_bufs];
+	struct rte_mbuf *robufs[size];
+	unsigned int i, cnt;
+	int ret = 0;
+
+	b = rte_reorder_create("test_insert_bulk", rte_socket_id(), size);
+	TEST_ASSERT_NOT_NULL(b, "Failed to create reorder buffer");
+
+	for (i = 0; i < num_bufs; i++) {
+		bufs[i] = rte_pktmbuf_alloc(p);
+		TEST_ASSERT_NOT_NULL(bufs[i], "Packet allocation failed\n");
+		*rte_reorder_seqn(bufs[i]) = seqn[i];
+	}
+
+	cnt = rte_reorder_insert_bulk(b, bufs, num_bufs);
+	if (cnt != num_bufs) {
+		printf("%s:%d: %u packets inserted instead of %u\n",
+				__func__, __LINE__, cnt, num_bufs);
+		ret = -1;
+		goto exit;
+	}
+	for (i = 0; i < num_bufs; i++)
+		bufs[i] = NULL;
+
+	cnt = rte_reorder_drain(b, robufs, size);
+	for (i = 0; i < cnt; i++) {
+		if (*rte_reorder_seqn(robufs[i]) != i) {
+			printf("%s:%d: packet with seqn %u drained at %u\n",
+					__func__, __LINE__,
+					*rte_reorder_seqn(robufs[i]), i);
+			ret = -1;
+		}
+		rte_pktmbuf_free(robufs[i]);
+	}
+	if (cnt != num_bufs) {
+		printf("%s:%d: %u packets drained instead of %u\n",
+				__func__, __LINE__, cnt, num_bufs);
+		ret = -1;
+	}
+exit:
+	rte_reorder_free(b);
+	for (i = 0; i < num_bufs; i++) {
+		if (bufs[i] != NULL)
+			rte_pktmbuf_free(bufs[i]);
+	}
+	return ret;
+}
+
+static int
+test_reorder_mp(void)
+{
+	struct rte_reorder_buffer *b = NULL;
+	struct rte_mempool *p = test_params->p;
+	const unsigned int size = 4;
+	const unsigned int num_bufs = 6;
+	const rte_reorder_seqn_t seqn[] = {1, 2, 0, 4, 7, 3};
+	struct rte_mbuf *bufs[num_bufs];
+	struct rte_mbuf *robufs[size];
+	unsigned int i, cnt;
+	int ret = -1;
+
+	b = rte_reorder_create_mp("test_mp", rte_socket_id(), size);
+	TEST_ASSERT_NOT_NULL(b, "Failed to create reorder buffer");
+
+	memset(robufs, 0, sizeof(robufs));
+	for (i = 0; i < num_bufs; i++) {
+		bufs[i] = rte_pktmbuf_alloc(p);
+		TEST_ASSERT_NOT_NULL(bufs[i], "Packet allocation failed\n");
+		*rte_reorder_seqn(bufs[i]) = seqn[i];
+	}
+
+	/* Window starts at seqn 0 */
+	cnt = rte_reorder_insert_bulk(b, bufs, 3);
+	if (cnt != 3) {
+		printf("%s:%d: %u packets inserted instead of 3\n",
+				__func__, __LINE__, cnt);
+		goto exit;
+	}
+	for (i = 0; i < 3; i++)
+		bufs[i] = NULL;
+
+	/* Seqn 3 is missing, so only 0, 1 and 2 are ready */
+	cnt = rte_reorder_drain(b, robufs, size);
+	if (cnt != 3) {
+		printf("%s:%d: %u packets drained instead of 3\n",
+				__func__, __LINE__, cnt);
+		goto exit;
+	}
+	for (i = 0; i < cnt; i++) {
+		if (*rte_reorder_seqn(robufs[i]) != i) {
+			printf("%s:%d: packet with seqn %u drained at %u\n",
+					__func__, __LINE__,
+					*rte_reorder_seqn(robufs[i]), i);
+			goto exit;
+		}
+		rte_pktmbuf_free(robufs[i]);
+		robufs[i] = NULL;
+	}
+
+	if (rte_reorder_insert(b, bufs[3]) != 0) {
+		printf("%s:%d: Error inserting packet in window\n",
+				__func__, __LINE__);
+		goto exit;
+	}
+	bufs[3] = NULL;
+
+	/* Seqn 7 is out of the window [3, 7) until seqn 3 is skipped */
+	if (rte_reorder_insert(b, bufs[4]) != -1 || rte_errno != ENOSPC) {
+		printf("%s:%d: No error inserting early packet\n",
+				__func__, __LINE__);
+		goto exit;
+	}
+
+	cnt = rte_reorder_drain(b, robufs, size);
+	if (cnt != 1 || *rte_reorder_seqn(robufs[0]) != 4) {
+		printf("%s:%d: missing packet not skipped\n",
+				__func__, __LINE__);
+		goto exit;
+	}
+	rte_pktmbuf_free(robufs[0]);
+	robufs[0] = NULL;
+
+	if (rte_reorder_insert(b, bufs[4]) != 0) {
+		printf("%s:%d: Error inserting packet after skip\n",
+				__func__, __LINE__);
+		goto exit;
+	}
+	bufs[4] = NULL;
+
+	/* Skipped packet is now late */
+	if (rte_reorder_insert(b, bufs[5]) != -1 || rte_errno != ERANGE) {
+		printf("%s:%d: No error inserting late packet\n",
+				__func__, __LINE__);
+		goto exit;
+	}
+
+	/* Seqn 5 and 6 are missing and nothing waits on them */
+	cnt = rte_reorder_drain(b, robufs, size);
+	if (cnt != 0) {
+		printf("%s:%d: %u packets drained instead of 0\n",
+				__func__, __LINE__, cnt);
+		goto exit;
+	}
+	ret = 0;
+exit:
+	rte_reorder_free(b);
+	for (i = 0; i < num_bufs; i++) {
+		if (bufs[i] != NULL)
+			rte_pktmbuf_free(bufs[i]);
+	}
+	for (i = 0; i < size; i++) {
+		if (robufs[i] != NULL)
+			rte_pktmbuf_free(robufs[i]);
+	}
+	return ret;
+}
+
 static int
 test_setup(void)
 {
@@ -380,6 +545,8 @@ static struct unit_test_suite reorder_test_suite  = {
 		TEST_CASE(test_reorder_free),
 		TEST_CASE(test_reorder_insert),
 		TEST_CASE(test_reorder_drain),
+		TEST_CASE(test_reorder_insert_bulk),
+		TEST_CASE(test_reorder_mp),
 		TEST_CASES_END()
 	}
 };
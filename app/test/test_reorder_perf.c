@@ -0,0 +1,209 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 Intel Corporation
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <rte_cycles.h>
+#include <rte_errno.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
+#include <rte_mbuf.h>
+#include <rte_pause.h>
+#include <rte_reorder.h>
+
+#include "test.h"
+
+/*
+ * Throughput of the single-writer reorder buffer, fed and drained by one
+ * lcore, against the multi-producer one, fed by all the worker lcores and
+ * drained by the main lcore. Packets arrive in bursts whose order is
+ * reversed but for the first packet, which the single-writer buffer takes
+ * as the start of its window, so every burst needs reordering.
+ */
+
+#define BURST 32
+#define REORDER_BUFFER_SIZE 1024
+#define NUM_PKTS (1 << 16)
+#define ITERATIONS 16
+
+static struct rte_mbuf *pkts[NUM_PKTS];
+static unsigned int worker_idx[RTE_MAX_LCORE];
+static unsigned int num_workers;
+static uint64_t late_pkts[RTE_MAX_LCORE];
+static uint32_t synchro;
+
+/* Input order of the packets: 0, 31, 30, ..., 1, 32, 63, 62, ... */
+static void
+reset_seqn(void)
+{
+	unsigned int i, j;
+
+	for (i = 0; i < NUM_PKTS; i++) {
+		j = i & (BURST - 1);
+		*rte_reorder_seqn(pkts[i]) = (i & ~(BURST - 1)) +
+				(j == 0 ? 0 : BURST - j);
+	}
+}
+
+static int
+test_single_writer(int bulk)
+{
+	struct rte_reorder_buffer *b;
+	struct rte_mbuf *out[BURST];
+	unsigned int i, j, it, drained;
+	uint64_t start, cycles = 0, total = 0;
+
+	b = rte_reorder_create("perf_sp", rte_socket_id(), REORDER_BUFFER_SIZE);
+	if (b == NULL) {
+		printf("Cannot create reorder buffer\n");
+		return -1;
+	}
+
+	for (it = 0; it < ITERATIONS; it++) {
+		rte_reorder_reset(b);
+		reset_seqn();
+		drained = 0;
+
+		start = rte_rdtsc();
+		for (i = 0; i < NUM_PKTS; i += BURST) {
+			if (bulk) {
+				rte_reorder_insert_bulk(b, &pkts[i], BURST);
+			} else {
+				for (j = 0; j < BURST; j++)
+					rte_reorder_insert(b, pkts[i + j]);
+			}
+			drained += rte_reorder_drain(b, out, BURST);
+		}
+		cycles += rte_rdtsc() - start;
+		total += drained;
+	}
+
+	rte_reorder_free(b);
+
+	printf("single writer %s: %.2f cycles/pkt, %"PRIu64" pkts drained\n",
+			bulk ? "bulk insert" : "insert",
+			(double)cycles / total, total);
+	return total == (uint64_t)ITERATIONS * NUM_PKTS ? 0 : -1;
+}
+
+static int
+mp_worker(void *arg)
+{
+	struct rte_reorder_buffer *b = arg;
+	unsigned int lcore = rte_lcore_id();
+	unsigned int i, n, cnt;
+
+	while (__atomic_load_n(&synchro, __ATOMIC_RELAXED) == 0)
+		rte_pause();
+
+	/* Each worker inserts every num_workers-th burst */
+	for (i = worker_idx[lcore] * BURST; i < NUM_PKTS;
+			i += num_workers * BURST) {
+		n = 0;
+		while (n < BURST) {
+			cnt = rte_reorder_insert_bulk(b, &pkts[i + n],
+					BURST - n);
+			n += cnt;
+			if (n == BURST)
+				break;
+			if (rte_errno == ERANGE) {
+				/* Skipped by the drain, drop it */
+				late_pkts[lcore]++;
+				n++;
+			} else {
+				rte_pause();
+			}
+		}
+	}
+	return 0;
+}
+
+static int
+test_multi_producer(void)
+{
+	struct rte_reorder_buffer *b;
+	struct rte_mbuf *out[BURST];
+	unsigned int lcore, it;
+	uint64_t start, cycles = 0, total = 0, drained, late;
+
+	b = rte_reorder_create_mp("perf_mp", rte_socket_id(),
+			REORDER_BUFFER_SIZE);
+	if (b == NULL) {
+		printf("Cannot create reorder buffer\n");
+		return -1;
+	}
+
+	num_workers = 0;
+	RTE_LCORE_FOREACH_WORKER(lcore)
+		worker_idx[lcore] = num_workers++;
+
+	for (it = 0; it < ITERATIONS; it++) {
+		rte_reorder_reset(b);
+		reset_seqn();
+		memset(late_pkts, 0, sizeof(late_pkts));
+		drained = 0;
+
+		__atomic_store_n(&synchro, 0, __ATOMIC_RELAXED);
+		rte_eal_mp_remote_launch(mp_worker, b, SKIP_MAIN);
+
+		start = rte_rdtsc();
+		__atomic_store_n(&synchro, 1, __ATOMIC_RELAXED);
+		for (;;) {
+			drained += rte_reorder_drain(b, out, BURST);
+			late = 0;
+			RTE_LCORE_FOREACH_WORKER(lcore)
+				late += __atomic_load_n(&late_pkts[lcore],
+						__ATOMIC_RELAXED);
+			if (drained + late == NUM_PKTS)
+				break;
+		}
+		cycles += rte_rdtsc() - start;
+		rte_eal_mp_wait_lcore();
+		total += drained;
+	}
+
+	rte_reorder_free(b);
+
+	printf("%u producers: %.2f cycles/pkt, %"PRIu64" pkts drained\n",
+			num_workers, (double)cycles / total, total);
+	return 0;
+}
+
+static int
+test_reorder_perf(void)
+{
+	struct rte_mempool *p;
+	int ret = -1;
+
+	p = rte_pktmbuf_pool_create("RO_PERF_POOL", NUM_PKTS, 0, 0, 0,
+			rte_socket_id());
+	if (p == NULL) {
+		printf("Cannot create mbuf pool\n");
+		return -1;
+	}
+	if (rte_pktmbuf_alloc_bulk(p, pkts, NUM_PKTS) != 0) {
+		printf("Cannot allocate mbufs\n");
+		goto exit;
+	}
+
+	if (test_single_writer(0) < 0 || test_single_writer(1) < 0)
+		goto free_pkts;
+
+	if (rte_lcore_count() < 2) {
+		printf("Not enough lcores for the multi-producer test, skipping\n");
+		ret = 0;
+		goto free_pkts;
+	}
+	ret = test_multi_producer();
+
+free_pkts:
+	rte_pktmbuf_free_bulk(pkts, NUM_PKTS);
+exit:
+	rte_mempool_free(p);
+	return ret;
+}
+
+REGISTER_TEST_COMMAND(reorder_perf_autotest, test_reorder_perf);
@@ -1190,6 +1190,152 @@ test_ring_with_exact_size(void)
 	return -1;
 }
 
+static unsigned int
+test_ring_stg_flush(struct rte_ring *r, int esize)
+{
+	/* Legacy queue APIs? */
+	if (esize == -1)
+		return rte_ring_stg_flush(r);
+	return rte_ring_stg_flush_elem(r, esize);
+}
+
+/*
+ * Test cases for the staged producer ring mode.
+ */
+static int
+test_ring_stg(void)
+{
+	struct rte_ring *r = NULL;
+	void **src = NULL, **cur_src = NULL, **dst = NULL, **cur_dst = NULL;
+	const unsigned int ring_sz = 64, num_elems = 128;
+	unsigned int i, stg_sz = RTE_RING_STG_SIZE;
+	ssize_t ring_mem_sz;
+	int ret;
+
+	/* The stages are only allocated by rte_ring_create_elem() */
+	ring_mem_sz = rte_ring_get_memsize(ring_sz);
+	r = rte_zmalloc("stg", ring_mem_sz, RTE_CACHE_LINE_SIZE);
+	if (r == NULL)
+		goto test_fail;
+	ret = rte_ring_init(r, "stg", ring_sz, RING_F_MP_STG_ENQ);
+	rte_free(r);
+	r = NULL;
+	if (ret != -EINVAL) {
+		printf("%s: rte_ring_init accepted RING_F_MP_STG_ENQ\n",
+			__func__);
+		goto test_fail;
+	}
+
+	for (i = 0; i < RTE_DIM(esize); i++) {
+		test_ring_print_test_string("Test staged producer ring",
+				TEST_RING_IGNORE_API_TYPE, esize[i]);
+
+		r = test_ring_create("stg", esize[i], ring_sz, SOCKET_ID_ANY,
+				RING_F_MP_STG_ENQ | RING_F_SC_DEQ);
+		if (r == NULL) {
+			printf("%s: error, can't create ring\n", __func__);
+			goto test_fail;
+		}
+
+		src = test_ring_calloc(num_elems, esize[i]);
+		if (src == NULL)
+			goto test_fail;
+		test_ring_mem_init(src, num_elems, esize[i]);
+		cur_src = src;
+
+		dst = test_ring_calloc(num_elems, esize[i]);
+		if (dst == NULL)
+			goto test_fail;
+		cur_dst = dst;
+
+		/* Staged objects are not visible until flushed */
+		ret = test_ring_enqueue(r, cur_src, esize[i], 8,
+				TEST_RING_THREAD_DEF | TEST_RING_ELEM_BURST);
+		TEST_RING_VERIFY(ret == 8, r, goto test_fail);
+		cur_src = test_ring_inc_ptr(cur_src, esize[i], 8);
+		TEST_RING_VERIFY(rte_ring_count(r) == 0, r, goto test_fail);
+		TEST_RING_VERIFY(test_ring_stg_flush(r, esize[i]) == 0, r,
+				goto test_fail);
+		TEST_RING_VERIFY(rte_ring_count(r) == 8, r, goto test_fail);
+
+		/* A full stage is enqueued along with the new objects */
+		ret = test_ring_enqueue(r, cur_src, esize[i], 8,
+				TEST_RING_THREAD_DEF | TEST_RING_ELEM_BURST);
+		TEST_RING_VERIFY(ret == 8, r, goto test_fail);
+		cur_src = test_ring_inc_ptr(cur_src, esize[i], 8);
+		ret = test_ring_enqueue(r, cur_src, esize[i], stg_sz,
+				TEST_RING_THREAD_DEF | TEST_RING_ELEM_BULK);
+		TEST_RING_VERIFY(ret == (int)stg_sz, r, goto test_fail);
+		cur_src = test_ring_inc_ptr(cur_src, esize[i], stg_sz);
+		TEST_RING_VERIFY(rte_ring_count(r) == 16 + stg_sz, r,
+				goto test_fail);
+
+		/*
+		 * The ring cannot hold the stage: what fits is enqueued,
+		 * the remaining objects stay staged.
+		 */
+		ret = test_ring_enqueue(r, cur_src, esize[i], stg_sz / 2,
+				TEST_RING_THREAD_DEF | TEST_RING_ELEM_BULK);
+		TEST_RING_VERIFY(ret == (int)stg_sz / 2, r, goto test_fail);
+		cur_src = test_ring_inc_ptr(cur_src, esize[i], stg_sz / 2);
+		ret = test_ring_enqueue(r, cur_src, esize[i], stg_sz / 2,
+				TEST_RING_THREAD_DEF | TEST_RING_ELEM_BULK);
+		TEST_RING_VERIFY(ret == (int)stg_sz / 2, r, goto test_fail);
+		cur_src = test_ring_inc_ptr(cur_src, esize[i], stg_sz / 2);
+		TEST_RING_VERIFY(rte_ring_full(r), r, goto test_fail);
+		TEST_RING_VERIFY(test_ring_stg_flush(r, esize[i]) ==
+				16 + 2 * stg_sz - (ring_sz - 1), r,
+				goto test_fail);
+
+		/* A bulk which does not fit in the stage either fails */
+		ret = test_ring_enqueue(r, cur_src, esize[i], stg_sz,
+				TEST_RING_THREAD_DEF | TEST_RING_ELEM_BULK);
+		TEST_RING_VERIFY(ret == 0, r, goto test_fail);
+
+		/* Objects are dequeued in order */
+		ret = test_ring_dequeue(r, cur_dst, esize[i], ring_sz,
+				TEST_RING_THREAD_DEF | TEST_RING_ELEM_BURST);
+		TEST_RING_VERIFY(ret == (int)ring_sz - 1, r, goto test_fail);
+		cur_dst = test_ring_inc_ptr(cur_dst, esize[i], ret);
+		TEST_RING_VERIFY(test_ring_stg_flush(r, esize[i]) == 0, r,
+				goto test_fail);
+		ret = test_ring_dequeue(r, cur_dst, esize[i], ring_sz,
+				TEST_RING_THREAD_DEF | TEST_RING_ELEM_BURST);
+		TEST_RING_VERIFY(ret == 16 + 2 * (int)stg_sz - (int)ring_sz + 1,
+				r, goto test_fail);
+		cur_dst = test_ring_inc_ptr(cur_dst, esize[i], ret);
+		TEST_RING_VERIFY(test_ring_mem_cmp(src, dst,
+					RTE_PTR_DIFF(cur_dst, dst)) == 0,
+					r, goto test_fail);
+		TEST_RING_VERIFY(RTE_PTR_DIFF(cur_src, src) ==
+				RTE_PTR_DIFF(cur_dst, dst), r, goto test_fail);
+
+		/* Reset drops the staged objects */
+		ret = test_ring_enqueue(r, cur_src, esize[i], 4,
+				TEST_RING_THREAD_DEF | TEST_RING_ELEM_BURST);
+		TEST_RING_VERIFY(ret == 4, r, goto test_fail);
+		rte_ring_reset(r);
+		TEST_RING_VERIFY(test_ring_stg_flush(r, esize[i]) == 0, r,
+				goto test_fail);
+		TEST_RING_VERIFY(rte_ring_empty(r), r, goto test_fail);
+
+		rte_free(src);
+		rte_free(dst);
+		rte_ring_free(r);
+		src = NULL;
+		dst = NULL;
+		r = NULL;
+	}
+
+	return 0;
+
+test_fail:
+	rte_free(src);
+	rte_free(dst);
+	rte_ring_free(r);
+	return -1;
+}
+
 static int
 test_ring(void)
 {
@@ -1207,6 +1353,9 @@ test_ring(void)
 	if (test_ring_with_exact_size() < 0)
 		goto test_fail;
 
+	if (test_ring_stg() < 0)
+		goto test_fail;
+
 	/* Burst and bulk operations with sp/sc, mp/mc and default.
 	 * The test cases are split into smaller test cases to
 	 * help clang compile faster.
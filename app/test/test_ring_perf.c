@@ -420,6 +420,148 @@ run_on_all_cores(struct rte_ring *r, const int esize)
 	return 0;
 }
 
+/*
+ * Fan-in test: several producer lcores enqueue bursts on the ring,
+ * the main lcore is the single consumer. The producers are timed, to
+ * compare the cost of the MP enqueue with and without staging.
+ */
+static const unsigned int fan_in_producers[] = { 2, 8, 32 };
+static uint64_t fan_in_cycles[RTE_MAX_LCORE];
+
+#define FAN_IN_ITERATIONS (1 << 12)
+
+static __rte_always_inline int
+fan_in_producer_helper(struct thread_params *p, const int esize)
+{
+	struct rte_ring *r = p->r;
+	const unsigned int bsize = p->size;
+	unsigned int i, n;
+	void *burst;
+	uint64_t start;
+
+	burst = test_ring_calloc(MAX_BURST, esize);
+	if (burst == NULL)
+		return -1;
+
+	while (__atomic_load_n(&synchro, __ATOMIC_RELAXED) == 0)
+		rte_pause();
+
+	start = rte_rdtsc();
+	for (i = 0; i < FAN_IN_ITERATIONS; i++)
+		for (n = 0; n != bsize; ) {
+			n += test_ring_enqueue(r,
+				test_ring_inc_ptr(burst, esize, n), esize,
+				bsize - n,
+				TEST_RING_THREAD_DEF | TEST_RING_ELEM_BURST);
+			if (n != bsize)
+				rte_pause();
+		}
+	/* Make the staged objects visible to the consumer */
+	while ((esize == -1 ? rte_ring_stg_flush(r) :
+			rte_ring_stg_flush_elem(r, esize)) != 0)
+		rte_pause();
+	fan_in_cycles[rte_lcore_id()] = rte_rdtsc() - start;
+
+	rte_free(burst);
+	return 0;
+}
+
+static int
+fan_in_producer(void *p)
+{
+	return fan_in_producer_helper(p, -1);
+}
+
+static int
+fan_in_producer_16B(void *p)
+{
+	return fan_in_producer_helper(p, 16);
+}
+
+static int
+run_fan_in(struct rte_ring *r, const int esize, unsigned int producers)
+{
+	struct thread_params param = {0};
+	lcore_function_t *lcore_f;
+	uint64_t total, cycles;
+	unsigned int c, launched;
+	void *burst;
+	uint64_t n;
+	int ret = 0;
+
+	lcore_f = esize == -1 ? fan_in_producer : fan_in_producer_16B;
+	burst = test_ring_calloc(MAX_BURST, esize);
+	if (burst == NULL)
+		return -1;
+
+	param.r = r;
+	param.size = bulk_sizes[0];
+
+	__atomic_store_n(&synchro, 0, __ATOMIC_RELAXED);
+	launched = 0;
+	RTE_LCORE_FOREACH_WORKER(c) {
+		if (launched == producers)
+			break;
+		fan_in_cycles[c] = 0;
+		if (rte_eal_remote_launch(lcore_f, &param, c) < 0)
+			break;
+		launched++;
+	}
+	__atomic_store_n(&synchro, 1, __ATOMIC_RELAXED);
+
+	/* Drain the ring until all the produced objects are received */
+	total = (uint64_t)launched * FAN_IN_ITERATIONS * param.size;
+	for (n = 0; n != total; )
+		n += test_ring_dequeue(r, burst, esize, MAX_BURST,
+				TEST_RING_THREAD_SPSC | TEST_RING_ELEM_BURST);
+
+	cycles = 0;
+	RTE_LCORE_FOREACH_WORKER(c) {
+		if (rte_eal_wait_lcore(c) < 0)
+			ret = -1;
+		cycles += fan_in_cycles[c];
+	}
+	rte_free(burst);
+	if (launched != producers || ret < 0)
+		return -1;
+
+	printf("%-10s %2u producers, burst %u: %.2f cycles/obj\n",
+		rte_ring_get_prod_sync_type(r) == RTE_RING_SYNC_MT_STG ?
+		"MP staged:" : "MP:", producers, param.size,
+		(double)cycles / total);
+	return 0;
+}
+
+static int
+test_fan_in(const int esize)
+{
+	static const unsigned int prod_flags[] = { 0, RING_F_MP_STG_ENQ };
+	struct rte_ring *r;
+	unsigned int i, j;
+
+	for (i = 0; i != RTE_DIM(fan_in_producers); i++) {
+		if (rte_lcore_count() <= fan_in_producers[i]) {
+			printf("Not enough lcores for %u producers, skipping\n",
+				fan_in_producers[i]);
+			continue;
+		}
+		for (j = 0; j != RTE_DIM(prod_flags); j++) {
+			r = test_ring_create(RING_NAME, esize, RING_SIZE,
+					rte_socket_id(),
+					prod_flags[j] | RING_F_SC_DEQ);
+			if (r == NULL)
+				return -1;
+			if (run_fan_in(r, esize, fan_in_producers[i]) < 0) {
+				rte_ring_free(r);
+				return -1;
+			}
+			rte_ring_free(r);
+		}
+	}
+
+	return 0;
+}
+
 /*
  * Test function that determines how long an enqueue + dequeue of a single item
  * takes on a single lcore. Result is for comparison with the bulk enq+deq.
@@ -557,6 +699,11 @@ test_ring_perf_esize(const int esize)
 		goto test_fail;
 
 	rte_ring_free(r);
+	r = NULL;
+
+	printf("\n### Testing fan-in to a single consumer ###\n");
+	if (test_fan_in(esize) < 0)
+		goto test_fail;
 
 	return 0;
 
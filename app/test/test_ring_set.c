@@ -0,0 +1,236 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 Intel Corporation
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_errno.h>
+#include <rte_ring.h>
+#include <rte_ring_set.h>
+
+#include "test.h"
+
+/*
+ * Ring set functional tests: the set must return the objects of the
+ * non-empty rings only, in round-robin or weighted round-robin order.
+ */
+
+#define NB_RINGS 70 /* more than one bitmap word */
+#define RING_SIZE 64
+
+static struct rte_ring *rings[NB_RINGS];
+
+/* objects are tagged with the index of their ring and a sequence number */
+#define OBJ(ring, seq) ((void *)(uintptr_t)((ring) << 16 | (seq)))
+#define OBJ_RING(obj) ((unsigned int)((uintptr_t)(obj) >> 16))
+#define OBJ_SEQ(obj) ((unsigned int)((uintptr_t)(obj) & UINT16_MAX))
+
+static void
+free_rings(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < NB_RINGS; i++) {
+		rte_ring_free(rings[i]);
+		rings[i] = NULL;
+	}
+}
+
+static int
+create_rings(void)
+{
+	char name[RTE_RING_NAMESIZE];
+	unsigned int i;
+
+	for (i = 0; i < NB_RINGS; i++) {
+		snprintf(name, sizeof(name), "ring_set_%u", i);
+		rings[i] = rte_ring_create(name, RING_SIZE, SOCKET_ID_ANY,
+				RING_F_SP_ENQ | RING_F_SC_DEQ);
+		if (rings[i] == NULL) {
+			free_rings();
+			return -1;
+		}
+	}
+	return 0;
+}
+
+static struct rte_ring_set *
+create_set(unsigned int flags, unsigned int nb_rings)
+{
+	struct rte_ring_set *set;
+	unsigned int i;
+
+	set = rte_ring_set_create("test", sizeof(void *), nb_rings,
+			SOCKET_ID_ANY, flags);
+	if (set == NULL)
+		return NULL;
+
+	for (i = 0; i < nb_rings; i++) {
+		/* weights 1, 2 and 4 */
+		if (rte_ring_set_add(set, rings[i], 1 << (i % 3)) != (int)i) {
+			rte_ring_set_free(set);
+			return NULL;
+		}
+	}
+	return set;
+}
+
+static int
+enqueue_seq(struct rte_ring_set *set, unsigned int ring, unsigned int first,
+		unsigned int n)
+{
+	void *objs[RING_SIZE];
+	unsigned int i;
+
+	for (i = 0; i < n; i++)
+		objs[i] = OBJ(ring, first + i);
+	return rte_ring_set_enqueue_burst(set, ring, objs, n, NULL) == n ?
+		0 : -1;
+}
+
+static int
+test_ring_set_params(void)
+{
+	struct rte_ring_set *set;
+
+	set = rte_ring_set_create("test", 0, 1, SOCKET_ID_ANY, 0);
+	TEST_ASSERT(set == NULL && rte_errno == EINVAL,
+		"Created a set with 0B elements");
+	set = rte_ring_set_create("test", 6, 1, SOCKET_ID_ANY, 0);
+	TEST_ASSERT(set == NULL && rte_errno == EINVAL,
+		"Created a set with 6B elements");
+	set = rte_ring_set_create("test", sizeof(void *), 0, SOCKET_ID_ANY, 0);
+	TEST_ASSERT(set == NULL && rte_errno == EINVAL,
+		"Created a set without rings");
+
+	set = rte_ring_set_create("test", sizeof(void *), 1, SOCKET_ID_ANY,
+			RTE_RING_SET_F_WEIGHTED);
+	TEST_ASSERT_NOT_NULL(set, "Cannot create ring set");
+	TEST_ASSERT_EQUAL(rte_ring_set_add(set, rings[0], 0), -EINVAL,
+		"Added a ring with weight 0");
+	TEST_ASSERT_EQUAL(rte_ring_set_add(set, rings[0], 1), 0,
+		"Cannot add a ring");
+	TEST_ASSERT_EQUAL(rte_ring_set_add(set, rings[1], 1), -ENOSPC,
+		"Added a ring to a full set");
+	rte_ring_set_free(set);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_ring_set_rr(void)
+{
+	struct rte_ring_set *set;
+	void *objs[4 * RING_SIZE];
+	unsigned int i, n;
+
+	set = create_set(0, NB_RINGS);
+	TEST_ASSERT_NOT_NULL(set, "Cannot create ring set");
+
+	TEST_ASSERT_EQUAL(rte_ring_set_dequeue_burst(set, objs, 16), 0,
+		"Dequeued from an empty set");
+
+	/* Only the non-empty rings are visited, in order */
+	TEST_ASSERT_SUCCESS(enqueue_seq(set, 65, 0, 4), "Enqueue failed");
+	TEST_ASSERT_SUCCESS(enqueue_seq(set, 3, 0, 4), "Enqueue failed");
+	n = rte_ring_set_dequeue_burst(set, objs, RTE_DIM(objs));
+	TEST_ASSERT_EQUAL(n, 8, "Dequeued %u objects instead of 8", n);
+	for (i = 0; i < n; i++)
+		TEST_ASSERT(OBJ_RING(objs[i]) == (i < 4 ? 3 : 65) &&
+			OBJ_SEQ(objs[i]) == i % 4,
+			"Unexpected object %u from ring %u", OBJ_SEQ(objs[i]),
+			OBJ_RING(objs[i]));
+	TEST_ASSERT_EQUAL(rte_ring_set_dequeue_burst(set, objs, 16), 0,
+		"Dequeued from an empty set");
+
+	/* Each call starts with the ring following the last one visited */
+	for (i = 0; i < 3; i++)
+		TEST_ASSERT_SUCCESS(enqueue_seq(set, i * 30, 0, 8),
+			"Enqueue failed");
+	for (i = 0; i < 4; i++) {
+		n = rte_ring_set_dequeue_burst(set, objs, 4);
+		TEST_ASSERT_EQUAL(n, 4, "Dequeued %u objects instead of 4", n);
+		TEST_ASSERT(OBJ_RING(objs[0]) == (i % 3) * 30 &&
+			OBJ_SEQ(objs[0]) == (i / 3) * 4,
+			"Unexpected object %u from ring %u", OBJ_SEQ(objs[0]),
+			OBJ_RING(objs[0]));
+	}
+	n = rte_ring_set_dequeue_burst(set, objs, RTE_DIM(objs));
+	TEST_ASSERT_EQUAL(n, 8, "Dequeued %u objects instead of 8", n);
+
+	/* A ring added with objects is not empty */
+	rte_ring_set_free(set);
+	TEST_ASSERT_EQUAL(rte_ring_enqueue(rings[1], OBJ(1, 0)), 0,
+		"Enqueue failed");
+	set = create_set(0, 2);
+	TEST_ASSERT_NOT_NULL(set, "Cannot create ring set");
+	TEST_ASSERT_EQUAL(rte_ring_set_dequeue_burst(set, objs, 16), 1,
+		"Missed the objects of an added ring");
+	rte_ring_set_free(set);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_ring_set_weighted(void)
+{
+	struct rte_ring_set *set;
+	void *objs[4 * RING_SIZE];
+	unsigned int i, n, count[3];
+
+	set = create_set(RTE_RING_SET_F_WEIGHTED, 3);
+	TEST_ASSERT_NOT_NULL(set, "Cannot create ring set");
+
+	for (i = 0; i < 3; i++)
+		TEST_ASSERT_SUCCESS(enqueue_seq(set, i, 0, 16),
+			"Enqueue failed");
+
+	/* Two rounds of 1, 2 and 4 objects */
+	n = rte_ring_set_dequeue_burst(set, objs, 14);
+	TEST_ASSERT_EQUAL(n, 14, "Dequeued %u objects instead of 14", n);
+	memset(count, 0, sizeof(count));
+	for (i = 0; i < n; i++)
+		count[OBJ_RING(objs[i])]++;
+	TEST_ASSERT(count[0] == 2 && count[1] == 4 && count[2] == 8,
+		"Unexpected weighted dequeue: %u %u %u",
+		count[0], count[1], count[2]);
+
+	/* The rings emptied are skipped */
+	n = rte_ring_set_dequeue_burst(set, objs, RTE_DIM(objs));
+	TEST_ASSERT_EQUAL(n, 48 - 14, "Dequeued %u objects instead of %u",
+		n, 48 - 14);
+	for (i = 1; i < n; i++)
+		TEST_ASSERT(OBJ_RING(objs[i]) != OBJ_RING(objs[i - 1]) ||
+			OBJ_SEQ(objs[i]) == OBJ_SEQ(objs[i - 1]) + 1,
+			"Objects of ring %u out of order", OBJ_RING(objs[i]));
+	TEST_ASSERT_EQUAL(rte_ring_set_dequeue_burst(set, objs, 16), 0,
+		"Dequeued from an empty set");
+	rte_ring_set_free(set);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_ring_set(void)
+{
+	int ret;
+
+	if (create_rings() < 0) {
+		printf("Cannot create rings\n");
+		return TEST_FAILED;
+	}
+
+	ret = test_ring_set_params();
+	if (ret == TEST_SUCCESS)
+		ret = test_ring_set_rr();
+	if (ret == TEST_SUCCESS)
+		ret = test_ring_set_weighted();
+
+	free_rings();
+	return ret;
+}
+
+REGISTER_TEST_COMMAND(ring_set_autotest, test_ring_set);
@@ -0,0 +1,149 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 Intel Corporation
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_ring.h>
+#include <rte_ring_set.h>
+
+#include "test.h"
+
+/*
+ * Fan-in of NB_RINGS SPSC rings to one consumer: cost of draining the
+ * rings by polling each of them, compared with dequeuing from a ring set,
+ * for different numbers of non-empty rings.
+ */
+
+#define NB_RINGS 64
+#define RING_SIZE 1024
+#define BURST 32
+#define ITERATIONS (1 << 12)
+#define EMPTY_POLLS (1 << 16)
+
+static const unsigned int nb_busy[] = { 1, 4, 16, 64 };
+
+static struct rte_ring *rings[NB_RINGS];
+static struct rte_ring_set *set;
+static void *objs[BURST];
+
+static uint64_t
+drain_polling(unsigned int total)
+{
+	uint64_t start = rte_rdtsc();
+	unsigned int i, n = 0;
+
+	while (n != total)
+		for (i = 0; i < NB_RINGS; i++)
+			n += rte_ring_dequeue_burst(rings[i], objs, BURST,
+					NULL);
+	return rte_rdtsc() - start;
+}
+
+static uint64_t
+drain_set(unsigned int total)
+{
+	uint64_t start = rte_rdtsc();
+	unsigned int n = 0;
+
+	while (n != total)
+		n += rte_ring_set_dequeue_burst(set, objs, BURST);
+	return rte_rdtsc() - start;
+}
+
+static void
+test_fan_in(unsigned int busy)
+{
+	uint64_t poll_enq = 0, poll_deq = 0, set_enq = 0, set_deq = 0;
+	const unsigned int stride = NB_RINGS / busy;
+	unsigned int i, j;
+	uint64_t start;
+
+	for (i = 0; i < ITERATIONS; i++) {
+		start = rte_rdtsc();
+		for (j = 0; j < NB_RINGS; j += stride)
+			rte_ring_enqueue_burst(rings[j], objs, BURST, NULL);
+		poll_enq += rte_rdtsc() - start;
+		poll_deq += drain_polling(busy * BURST);
+
+		start = rte_rdtsc();
+		for (j = 0; j < NB_RINGS; j += stride)
+			rte_ring_set_enqueue_burst(set, j, objs, BURST, NULL);
+		set_enq += rte_rdtsc() - start;
+		set_deq += drain_set(busy * BURST);
+	}
+
+	printf("%2u/%u non-empty rings: polling enq %6.2f deq %6.2f, "
+		"ring set enq %6.2f deq %6.2f cycles/obj\n",
+		busy, NB_RINGS,
+		(double)poll_enq / (ITERATIONS * busy * BURST),
+		(double)poll_deq / (ITERATIONS * busy * BURST),
+		(double)set_enq / (ITERATIONS * busy * BURST),
+		(double)set_deq / (ITERATIONS * busy * BURST));
+}
+
+static void
+test_empty_poll(void)
+{
+	uint64_t start, poll_cycles, set_cycles;
+	unsigned int i, j;
+
+	start = rte_rdtsc();
+	for (i = 0; i < EMPTY_POLLS; i++)
+		for (j = 0; j < NB_RINGS; j++)
+			rte_ring_dequeue_burst(rings[j], objs, BURST, NULL);
+	poll_cycles = rte_rdtsc() - start;
+
+	start = rte_rdtsc();
+	for (i = 0; i < EMPTY_POLLS; i++)
+		rte_ring_set_dequeue_burst(set, objs, BURST);
+	set_cycles = rte_rdtsc() - start;
+
+	printf(" 0/%u non-empty rings: polling %8.2f, ring set %8.2f "
+		"cycles/poll\n", NB_RINGS, (double)poll_cycles / EMPTY_POLLS,
+		(double)set_cycles / EMPTY_POLLS);
+}
+
+static int
+test_ring_set_perf(void)
+{
+	char name[RTE_RING_NAMESIZE];
+	unsigned int i;
+	int ret = -1;
+
+	set = rte_ring_set_create("ring_set_perf", sizeof(void *), NB_RINGS,
+			rte_socket_id(), 0);
+	if (set == NULL) {
+		printf("Cannot create ring set\n");
+		return -1;
+	}
+
+	for (i = 0; i < NB_RINGS; i++) {
+		snprintf(name, sizeof(name), "ring_set_perf_%u", i);
+		rings[i] = rte_ring_create(name, RING_SIZE, rte_socket_id(),
+				RING_F_SP_ENQ | RING_F_SC_DEQ);
+		if (rings[i] == NULL ||
+				rte_ring_set_add(set, rings[i], 0) != (int)i) {
+			printf("Cannot create ring %u\n", i);
+			goto exit;
+		}
+	}
+
+	test_empty_poll();
+	for (i = 0; i < RTE_DIM(nb_busy); i++)
+		test_fan_in(nb_busy[i]);
+	ret = 0;
+
+exit:
+	for (i = 0; i < NB_RINGS; i++) {
+		rte_ring_free(rings[i]);
+		rings[i] = NULL;
+	}
+	rte_ring_set_free(set);
+	return ret;
+}
+
+REGISTER_TEST_COMMAND(ring_set_perf_autotest, test_ring_set_perf);
@@ -122,6 +122,116 @@ prepare_pkt(struct rte_sched_port *port, struct rte_mbuf *mbuf)
 	mbuf->data_len = 60;
 }
 
+/* Best-effort queues above the subport number are folded onto queue 0 */
+static int
+test_sched_be_queues(struct rte_mempool *mp)
+{
+	struct rte_sched_subport_params params = subport_param[0];
+	struct rte_sched_port *port;
+	struct rte_mbuf *in_mbufs[RTE_SCHED_BE_QUEUES_PER_PIPE];
+	struct rte_mbuf *out_mbufs[RTE_SCHED_BE_QUEUES_PER_PIPE];
+	uint32_t subport, pipe, traffic_class, queue, i;
+	int err;
+
+	params.n_be_queues = 1;
+
+	port = rte_sched_port_config(&port_param);
+	TEST_ASSERT_NOT_NULL(port, "Error config sched port\n");
+
+	err = rte_sched_subport_config(port, SUBPORT, &params, 0);
+	TEST_ASSERT_SUCCESS(err, "Error config sched, err=%d\n", err);
+
+	err = rte_sched_pipe_config(port, SUBPORT, PIPE, 0);
+	TEST_ASSERT_SUCCESS(err, "Error config sched pipe, err=%d\n", err);
+
+	for (i = 0; i < RTE_SCHED_BE_QUEUES_PER_PIPE; i++) {
+		in_mbufs[i] = rte_pktmbuf_alloc(mp);
+		TEST_ASSERT_NOT_NULL(in_mbufs[i], "Packet allocation failed\n");
+		prepare_pkt(port, in_mbufs[i]);
+		rte_sched_port_pkt_write(port, in_mbufs[i], SUBPORT, PIPE,
+			RTE_SCHED_TRAFFIC_CLASS_BE, i, RTE_COLOR_GREEN);
+
+		rte_sched_port_pkt_read_tree_path(port, in_mbufs[i],
+				&subport, &pipe, &traffic_class, &queue);
+		TEST_ASSERT_EQUAL(queue, 0, "Wrong queue\n");
+	}
+
+	err = rte_sched_port_enqueue(port, in_mbufs, i);
+	TEST_ASSERT_EQUAL(err, (int)i, "Wrong enqueue, err=%d\n", err);
+
+	err = rte_sched_port_dequeue(port, out_mbufs, i);
+	TEST_ASSERT_EQUAL(err, (int)i, "Wrong dequeue, err=%d\n", err);
+
+	rte_pktmbuf_free_bulk(out_mbufs, i);
+	rte_sched_port_free(port);
+
+	return 0;
+}
+
+/* Two dequeue workers, each owning one subport of the port */
+static int
+test_sched_workers(struct rte_mempool *mp)
+{
+	struct rte_sched_port_params params = port_param;
+	struct rte_sched_port_worker *workers[2];
+	struct rte_sched_port *port;
+	struct rte_mbuf *in_mbufs[8];
+	struct rte_mbuf *out_mbufs[8];
+	uint32_t subport, pipe, traffic_class, queue, w, i;
+	int err;
+
+	params.n_subports_per_port = RTE_DIM(workers);
+
+	port = rte_sched_port_config(&params);
+	TEST_ASSERT_NOT_NULL(port, "Error config sched port\n");
+
+	for (w = 0; w < RTE_DIM(workers); w++) {
+		err = rte_sched_subport_config(port, w, subport_param, 0);
+		TEST_ASSERT_SUCCESS(err, "Error config sched, err=%d\n", err);
+
+		err = rte_sched_pipe_config(port, w, PIPE, 0);
+		TEST_ASSERT_SUCCESS(err, "Error config sched pipe, err=%d\n",
+			err);
+
+		workers[w] = rte_sched_port_worker_create(port, w, 1);
+		TEST_ASSERT_NOT_NULL(workers[w], "Error creating worker\n");
+	}
+
+	TEST_ASSERT_NULL(rte_sched_port_worker_create(port, 0, 2),
+		"Subport owned by two workers\n");
+
+	for (i = 0; i < RTE_DIM(in_mbufs); i++) {
+		in_mbufs[i] = rte_pktmbuf_alloc(mp);
+		TEST_ASSERT_NOT_NULL(in_mbufs[i], "Packet allocation failed\n");
+		prepare_pkt(port, in_mbufs[i]);
+		rte_sched_port_pkt_write(port, in_mbufs[i], i % RTE_DIM(workers),
+			PIPE, TC, QUEUE, RTE_COLOR_YELLOW);
+	}
+
+	err = rte_sched_port_enqueue(port, in_mbufs, RTE_DIM(in_mbufs));
+	TEST_ASSERT_EQUAL(err, (int)RTE_DIM(in_mbufs),
+		"Wrong enqueue, err=%d\n", err);
+
+	for (w = 0; w < RTE_DIM(workers); w++) {
+		err = rte_sched_port_worker_dequeue(workers[w], out_mbufs,
+			RTE_DIM(out_mbufs));
+		TEST_ASSERT_EQUAL(err, (int)(RTE_DIM(in_mbufs) / RTE_DIM(workers)),
+			"Wrong worker dequeue, err=%d\n", err);
+
+		for (i = 0; i < (uint32_t)err; i++) {
+			rte_sched_port_pkt_read_tree_path(port, out_mbufs[i],
+				&subport, &pipe, &traffic_class, &queue);
+			TEST_ASSERT_EQUAL(subport, w, "Wrong subport\n");
+		}
+		rte_pktmbuf_free_bulk(out_mbufs, err);
+	}
+
+	for (w = 0; w < RTE_DIM(workers); w++)
+		rte_sched_port_worker_free(workers[w]);
+	rte_sched_port_free(port);
+
+	return 0;
+}
 
 /**
  * test main entrance for library sched
@@ -200,8 +310,13 @@ test_sched(void)
 #endif
 
 	rte_sched_port_free(port);
+	rte_pktmbuf_free_bulk(out_mbufs, 10);
 
-	return 0;
+	err = test_sched_be_queues(mp);
+	if (err)
+		return err;
+
+	return test_sched_workers(mp);
 }
 
 REGISTER_TEST_COMMAND(sched_autotest, test_sched);
@@ -527,9 +527,113 @@ timer_sanity_check(void)
 	return 0;
 }
 
+#define NB_BULK_TIMERS 1024
+
+static unsigned int bulk_expired;
+static int bulk_early;
+
+static void
+timer_bulk_cb(struct rte_timer **tims, unsigned int nb_tims, void *arg)
+{
+	uint8_t *fired = arg;
+	uint64_t cur_time = rte_get_timer_cycles();
+	unsigned int i;
+
+	for (i = 0; i < nb_tims; i++) {
+		/* a periodic timer is already reloaded here */
+		if (tims[i]->period == 0 && tims[i]->expire > cur_time)
+			bulk_early = 1;
+		fired[(uintptr_t)tims[i]->arg]++;
+	}
+	bulk_expired += nb_tims;
+}
+
+/*
+ * Arm single timers over 100 ms and a periodic one on a timer data instance,
+ * stop a part of them, and check that the others expire once each and not
+ * before their time, through the bulk manage API.
+ */
+static int
+timer_backend_test(enum rte_timer_backend backend)
+{
+	static struct rte_timer tims[NB_BULK_TIMERS + 1];
+	static uint8_t fired[NB_BULK_TIMERS + 1];
+	struct rte_timer_data_params params = {
+		.backend = backend,
+		/* 1 us, so that 100 ms timers need two cascades */
+		.wheel_tick = rte_get_timer_hz() / 1000000,
+	};
+	const uint64_t hz = rte_get_timer_hz();
+	unsigned int lcore_id = rte_lcore_id();
+	uint64_t end;
+	uint32_t id;
+	unsigned int i;
+	int ret = -1;
+
+	printf("Start timer %s backend test\n",
+	       backend == RTE_TIMER_BACKEND_WHEEL ? "wheel" : "skiplist");
+
+	if (rte_timer_data_alloc_ext(&id, &params) != 0) {
+		printf("Cannot allocate timer data\n");
+		return -1;
+	}
+
+	memset(fired, 0, sizeof(fired));
+	bulk_expired = 0;
+	bulk_early = 0;
+
+	for (i = 0; i < NB_BULK_TIMERS; i++) {
+		rte_timer_init(&tims[i]);
+		rte_timer_alt_reset(id, &tims[i], rte_rand_max(hz / 10), SINGLE,
+				    lcore_id, NULL, (void *)(uintptr_t)i);
+	}
+	rte_timer_init(&tims[i]);
+	rte_timer_alt_reset(id, &tims[i], hz / 100, PERIODICAL, lcore_id,
+			    NULL, (void *)(uintptr_t)i);
+
+	for (i = 0; i < NB_BULK_TIMERS; i += 4)
+		rte_timer_alt_stop(id, &tims[i]);
+
+	end = rte_get_timer_cycles() + hz / 5;
+	while (rte_get_timer_cycles() < end)
+		rte_timer_alt_manage_bulk(id, NULL, 0, timer_bulk_cb, fired);
+
+	for (i = 0; i < NB_BULK_TIMERS; i++) {
+		if (fired[i] != (i % 4 == 0 ? 0 : 1) ||
+		    rte_timer_pending(&tims[i])) {
+			printf("Timer %u expired %u times\n", i, fired[i]);
+			goto out;
+		}
+	}
+	/* about 20 periods elapsed */
+	if (fired[i] < 10 || !rte_timer_pending(&tims[i])) {
+		printf("Periodic timer expired %u times\n", fired[i]);
+		goto out;
+	}
+	if (bulk_early) {
+		printf("Timer expired before its time\n");
+		goto out;
+	}
+
+	rte_timer_stop_all(id, &lcore_id, 1, NULL, NULL);
+	if (rte_timer_pending(&tims[i])) {
+		printf("Periodic timer not stopped\n");
+		goto out;
+	}
+
+	printf("%u timers expired\n", bulk_expired);
+	ret = 0;
+out:
+	rte_timer_stop_all(id, &lcore_id, 1, NULL, NULL);
+	rte_timer_data_dealloc(id);
+	return ret;
+}
+
 static int
 test_timer(void)
 {
+	struct rte_timer_data_params params = { .backend = -1 };
+	uint32_t id;
 	unsigned i;
 	uint64_t cur_time;
 	uint64_t hz;
@@ -545,6 +649,14 @@ test_timer(void)
 		return TEST_FAILED;
 	}
 
+	if (rte_timer_data_alloc_ext(&id, &params) != -EINVAL) {
+		printf("No error on invalid timer backend\n");
+		return TEST_FAILED;
+	}
+	if (timer_backend_test(RTE_TIMER_BACKEND_SKIPLIST) < 0 ||
+	    timer_backend_test(RTE_TIMER_BACKEND_WHEEL) < 0)
+		return TEST_FAILED;
+
 	/* init timer */
 	for (i=0; i<NB_TIMER; i++) {
 		memset(&mytiminfo[i], 0, sizeof(struct mytimerinfo));
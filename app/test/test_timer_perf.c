@@ -33,6 +33,104 @@ timer_cb(struct rte_timer *t __rte_unused, void *param __rte_unused)
 #define do_delay() rte_pause()
 #endif
 
+static const unsigned int backend_nb_timers[] = { 1000000, 10000000 };
+static uint64_t backend_expired;
+
+static void
+timer_bulk_cb(struct rte_timer **tims __rte_unused, unsigned int nb_tims,
+	      void *arg __rte_unused)
+{
+	backend_expired += nb_tims;
+}
+
+/*
+ * Arm timers expiring at random within a second on a timer data instance
+ * with the given backend, arm them all again as a NAT refreshing its
+ * sessions would, then let them expire.
+ */
+static int
+test_timer_backend_perf(struct rte_timer *tms, unsigned int nb_timers,
+			enum rte_timer_backend backend)
+{
+	struct rte_timer_data_params params = { .backend = backend };
+	const uint64_t ticks = rte_get_timer_hz() * DELAY_SECONDS;
+	unsigned int lcore_id = rte_lcore_id();
+	uint64_t start_tsc, arm_tsc, rearm_tsc, expire_tsc, delay_start;
+	uint32_t id;
+	unsigned int i;
+
+	if (rte_timer_data_alloc_ext(&id, &params) != 0) {
+		printf("Cannot allocate timer data\n");
+		return -1;
+	}
+
+	for (i = 0; i < nb_timers; i++)
+		rte_timer_init(&tms[i]);
+
+	start_tsc = rte_rdtsc();
+	for (i = 0; i < nb_timers; i++)
+		rte_timer_alt_reset(id, &tms[i], ticks + rte_rand_max(ticks),
+				    SINGLE, lcore_id, NULL, NULL);
+	arm_tsc = rte_rdtsc() - start_tsc;
+
+	start_tsc = rte_rdtsc();
+	for (i = 0; i < nb_timers; i++)
+		rte_timer_alt_reset(id, &tms[i], ticks + rte_rand_max(ticks),
+				    SINGLE, lcore_id, NULL, NULL);
+	rearm_tsc = rte_rdtsc() - start_tsc;
+
+	/* wait for all the timers, and the tick of the wheel, to expire */
+	delay_start = rte_get_timer_cycles();
+	while (rte_get_timer_cycles() < delay_start + 2 * ticks + ticks / 10)
+		do_delay();
+
+	backend_expired = 0;
+	start_tsc = rte_rdtsc();
+	rte_timer_alt_manage_bulk(id, NULL, 0, timer_bulk_cb, NULL);
+	expire_tsc = rte_rdtsc() - start_tsc;
+
+	rte_timer_data_dealloc(id);
+
+	if (backend_expired != nb_timers) {
+		printf("Error: %"PRIu64" timers expired, expected %u\n",
+		       backend_expired, nb_timers);
+		return -1;
+	}
+
+	printf("%-8s %8u timers: %6"PRIu64" cycles/arm, "
+	       "%6"PRIu64" cycles/re-arm, %6"PRIu64" cycles/expiry\n",
+	       backend == RTE_TIMER_BACKEND_WHEEL ? "wheel" : "skiplist",
+	       nb_timers, arm_tsc / nb_timers, rearm_tsc / nb_timers,
+	       expire_tsc / nb_timers);
+	return 0;
+}
+
+static int
+test_timer_backends_perf(void)
+{
+	struct rte_timer *tms;
+	unsigned int i, nb_timers;
+	int ret = 0;
+
+	printf("\nTimer backends with pending timers:\n");
+	for (i = 0; i < RTE_DIM(backend_nb_timers) && ret == 0; i++) {
+		nb_timers = backend_nb_timers[i];
+		tms = rte_malloc(NULL, sizeof(*tms) * nb_timers, 0);
+		if (tms == NULL) {
+			printf("Not enough memory for %u timers, skipping\n",
+			       nb_timers);
+			continue;
+		}
+		if (test_timer_backend_perf(tms, nb_timers,
+				RTE_TIMER_BACKEND_SKIPLIST) < 0 ||
+		    test_timer_backend_perf(tms, nb_timers,
+				RTE_TIMER_BACKEND_WHEEL) < 0)
+			ret = -1;
+		rte_free(tms);
+	}
+	return ret;
+}
+
 static int
 test_timer_perf(void)
 {
@@ -127,8 +225,10 @@ test_timer_perf(void)
 	printf("Time per rte_timer_manage with zero callbacks: %"PRIu64" cycles\n",
 			(end_tsc - start_tsc + iterations/2) / iterations);
 
+	rte_timer_stop_sync(&tms[0]);
 	rte_free(tms);
-	return 0;
+
+	return test_timer_backends_perf();
 }
 
 REGISTER_TEST_COMMAND(timer_perf_autotest, test_timer_perf);
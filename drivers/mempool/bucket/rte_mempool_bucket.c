@@ -24,6 +24,9 @@
  * Until the bucket is full, no objects from it are eligible for allocation.
  * If a request is made to dequeue a multiply of bucket size, it is
  * satisfied by returning the whole buckets, instead of separate objects.
+ * The full buckets are owned by the lcore which filled them: an lcore
+ * whose buckets and the shared ones run dry steals the buckets of the
+ * other lcores.
  */
 
 
@@ -32,20 +35,18 @@ struct bucket_header {
 	uint8_t fill_cnt;
 };
 
-struct bucket_stack {
-	unsigned int top;
-	unsigned int limit;
-	void *objects[];
-};
-
 struct bucket_data {
 	unsigned int header_size;
 	unsigned int total_elt_size;
 	unsigned int obj_per_bucket;
-	unsigned int bucket_stack_thresh;
 	uintptr_t bucket_page_mask;
 	struct rte_ring *shared_bucket_ring;
-	struct bucket_stack *buckets[RTE_MAX_LCORE];
+	/*
+	 * Single-producer multi-consumer rings to hold the full buckets
+	 * of each lcore: only the owner enqueues, the other lcores may
+	 * dequeue to steal buckets
+	 */
+	struct rte_ring *buckets[RTE_MAX_LCORE];
 	/*
 	 * Multi-producer single-consumer ring to hold objects that are
 	 * returned to the mempool at a different lcore than initially
@@ -58,46 +59,6 @@ struct bucket_data {
 	void *lcore_callback_handle;
 };
 
-static struct bucket_stack *
-bucket_stack_create(const struct rte_mempool *mp, unsigned int n_elts)
-{
-	struct bucket_stack *stack;
-
-	stack = rte_zmalloc_socket("bucket_stack",
-				   sizeof(struct bucket_stack) +
-				   n_elts * sizeof(void *),
-				   RTE_CACHE_LINE_SIZE,
-				   mp->socket_id);
-	if (stack == NULL)
-		return NULL;
-	stack->limit = n_elts;
-	stack->top = 0;
-
-	return stack;
-}
-
-static void
-bucket_stack_push(struct bucket_stack *stack, void *obj)
-{
-	RTE_ASSERT(stack->top < stack->limit);
-	stack->objects[stack->top++] = obj;
-}
-
-static void *
-bucket_stack_pop_unsafe(struct bucket_stack *stack)
-{
-	RTE_ASSERT(stack->top > 0);
-	return stack->objects[--stack->top];
-}
-
-static void *
-bucket_stack_pop(struct bucket_stack *stack)
-{
-	if (stack->top == 0)
-		return NULL;
-	return bucket_stack_pop_unsafe(stack);
-}
-
 static int
 bucket_enqueue_single(struct bucket_data *bd, void *obj)
 {
@@ -114,8 +75,9 @@ bucket_enqueue_single(struct bucket_data *bd, void *obj)
 			hdr->fill_cnt++;
 		} else {
 			hdr->fill_cnt = 0;
-			/* Stack is big enough to put all buckets */
-			bucket_stack_push(bd->buckets[lcore_id], hdr);
+			rc = rte_ring_sp_enqueue(bd->buckets[lcore_id], hdr);
+			/* Ring is big enough to put all buckets */
+			RTE_ASSERT(rc == 0);
 		}
 	} else if (hdr->lcore_id != LCORE_ID_ANY) {
 		struct rte_ring *adopt_ring =
@@ -141,7 +103,6 @@ bucket_enqueue(struct rte_mempool *mp, void * const *obj_table,
 	       unsigned int n)
 {
 	struct bucket_data *bd = mp->pool_data;
-	struct bucket_stack *local_stack = bd->buckets[rte_lcore_id()];
 	unsigned int i;
 	int rc = 0;
 
@@ -149,15 +110,6 @@ bucket_enqueue(struct rte_mempool *mp, void * const *obj_table,
 		rc = bucket_enqueue_single(bd, obj_table[i]);
 		RTE_ASSERT(rc == 0);
 	}
-	if (local_stack->top > bd->bucket_stack_thresh) {
-		rte_ring_enqueue_bulk(bd->shared_bucket_ring,
-				      &local_stack->objects
-				      [bd->bucket_stack_thresh],
-				      local_stack->top -
-				      bd->bucket_stack_thresh,
-				      NULL);
-	    local_stack->top = bd->bucket_stack_thresh;
-	}
 	return rc;
 }
 
@@ -175,6 +127,59 @@ bucket_fill_obj_table(const struct bucket_data *bd, void **pstart,
 	return obj_table;
 }
 
+/* Take full buckets from the other lcores, starting after this one */
+static unsigned int
+bucket_steal(struct bucket_data *bd, void **hdrs, unsigned int n)
+{
+	unsigned int lcore_id = rte_lcore_id();
+	unsigned int i, victim;
+	unsigned int n_stolen = 0;
+
+	for (i = 1; i < RTE_MAX_LCORE && n_stolen < n; i++) {
+		victim = (lcore_id + i) % RTE_MAX_LCORE;
+		if (bd->buckets[victim] == NULL)
+			continue;
+		n_stolen += rte_ring_mc_dequeue_burst(bd->buckets[victim],
+						      hdrs + n_stolen,
+						      n - n_stolen, NULL);
+	}
+
+	return n_stolen;
+}
+
+/*
+ * Get the headers of n full buckets: from the ring of this lcore first,
+ * then from the shared ring, then from the other lcores. All or none of
+ * the buckets are taken.
+ */
+static int
+bucket_dequeue_hdrs(struct bucket_data *bd, void **hdrs, unsigned int n)
+{
+	unsigned int lcore_id = rte_lcore_id();
+	struct rte_ring *local_ring = bd->buckets[lcore_id];
+	unsigned int i, n_hdrs;
+
+	n_hdrs = rte_ring_mc_dequeue_burst(local_ring, hdrs, n, NULL);
+	if (n_hdrs < n)
+		n_hdrs += rte_ring_dequeue_burst(bd->shared_bucket_ring,
+						 hdrs + n_hdrs, n - n_hdrs,
+						 NULL);
+	if (n_hdrs < n)
+		n_hdrs += bucket_steal(bd, hdrs + n_hdrs, n - n_hdrs);
+
+	for (i = 0; i < n_hdrs; i++)
+		((struct bucket_header *)hdrs[i])->lcore_id = lcore_id;
+
+	if (unlikely(n_hdrs < n)) {
+		/* Keep the buckets already dequeued */
+		rte_ring_sp_enqueue_bulk(local_ring, hdrs, n_hdrs, NULL);
+		rte_errno = ENOBUFS;
+		return -rte_errno;
+	}
+
+	return 0;
+}
+
 static int
 bucket_dequeue_orphans(struct bucket_data *bd, void **obj_table,
 		       unsigned int n_orphans)
@@ -188,19 +193,10 @@ bucket_dequeue_orphans(struct bucket_data *bd, void **obj_table,
 	if (unlikely(rc != (int)n_orphans)) {
 		struct bucket_header *hdr;
 
-		objptr = bucket_stack_pop(bd->buckets[rte_lcore_id()]);
+		rc = bucket_dequeue_hdrs(bd, (void **)&objptr, 1);
+		if (rc != 0)
+			return rc;
 		hdr = (struct bucket_header *)objptr;
-
-		if (objptr == NULL) {
-			rc = rte_ring_dequeue(bd->shared_bucket_ring,
-					      (void **)&objptr);
-			if (rc != 0) {
-				rte_errno = ENOBUFS;
-				return -rte_errno;
-			}
-			hdr = (struct bucket_header *)objptr;
-			hdr->lcore_id = rte_lcore_id();
-		}
 		hdr->fill_cnt = 0;
 		bucket_fill_obj_table(bd, (void **)&objptr, obj_table,
 				      n_orphans);
@@ -223,34 +219,23 @@ static int
 bucket_dequeue_buckets(struct bucket_data *bd, void **obj_table,
 		       unsigned int n_buckets)
 {
-	struct bucket_stack *cur_stack = bd->buckets[rte_lcore_id()];
-	unsigned int n_buckets_from_stack = RTE_MIN(n_buckets, cur_stack->top);
-	void **obj_table_base = obj_table;
-
-	n_buckets -= n_buckets_from_stack;
-	while (n_buckets_from_stack-- > 0) {
-		void *obj = bucket_stack_pop_unsafe(cur_stack);
+	/*
+	 * The bucket headers are stored at the end of the table: the
+	 * objects of a bucket only overwrite its own header and the
+	 * objects of the previous buckets.
+	 */
+	void **hdrs = obj_table + n_buckets * (bd->obj_per_bucket - 1);
+	unsigned int i;
+	void *hdr;
+	int rc;
 
-		obj_table = bucket_fill_obj_table(bd, &obj, obj_table,
-						  bd->obj_per_bucket);
-	}
-	while (n_buckets-- > 0) {
-		struct bucket_header *hdr;
+	rc = bucket_dequeue_hdrs(bd, hdrs, n_buckets);
+	if (rc != 0)
+		return rc;
 
-		if (unlikely(rte_ring_dequeue(bd->shared_bucket_ring,
-					      (void **)&hdr) != 0)) {
-			/*
-			 * Return the already-dequeued buffers
-			 * back to the mempool
-			 */
-			bucket_enqueue(bd->pool, obj_table_base,
-				       obj_table - obj_table_base);
-			rte_errno = ENOBUFS;
-			return -rte_errno;
-		}
-		hdr->lcore_id = rte_lcore_id();
-		obj_table = bucket_fill_obj_table(bd, (void **)&hdr,
-						  obj_table,
+	for (i = 0; i < n_buckets; i++) {
+		hdr = hdrs[i];
+		obj_table = bucket_fill_obj_table(bd, &hdr, obj_table,
 						  bd->obj_per_bucket);
 	}
 
@@ -311,37 +296,18 @@ bucket_dequeue_contig_blocks(struct rte_mempool *mp, void **first_obj_table,
 			     unsigned int n)
 {
 	struct bucket_data *bd = mp->pool_data;
-	const uint32_t header_size = bd->header_size;
-	struct bucket_stack *cur_stack = bd->buckets[rte_lcore_id()];
-	unsigned int n_buckets_from_stack = RTE_MIN(n, cur_stack->top);
-	struct bucket_header *hdr;
-	void **first_objp = first_obj_table;
+	unsigned int i;
+	int rc;
 
 	bucket_adopt_orphans(bd);
 
-	n -= n_buckets_from_stack;
-	while (n_buckets_from_stack-- > 0) {
-		hdr = bucket_stack_pop_unsafe(cur_stack);
-		*first_objp++ = (uint8_t *)hdr + header_size;
-	}
-	if (n > 0) {
-		if (unlikely(rte_ring_dequeue_bulk(bd->shared_bucket_ring,
-						   first_objp, n, NULL) != n)) {
-			/* Return the already dequeued buckets */
-			while (first_objp-- != first_obj_table) {
-				bucket_stack_push(cur_stack,
-						  (uint8_t *)*first_objp -
-						  header_size);
-			}
-			rte_errno = ENOBUFS;
-			return -rte_errno;
-		}
-		while (n-- > 0) {
-			hdr = (struct bucket_header *)*first_objp;
-			hdr->lcore_id = rte_lcore_id();
-			*first_objp++ = (uint8_t *)hdr + header_size;
-		}
-	}
+	rc = bucket_dequeue_hdrs(bd, first_obj_table, n);
+	if (rc != 0)
+		return rc;
+
+	for (i = 0; i < n; i++)
+		first_obj_table[i] = (uint8_t *)first_obj_table[i] +
+			bd->header_size;
 
 	return 0;
 }
@@ -357,7 +323,7 @@ bucket_count_per_lcore(unsigned int lcore_id, void *arg)
 	struct bucket_count_per_lcore_ctx *bplc = arg;
 
 	bplc->count += bplc->bd->obj_per_bucket *
-		bplc->bd->buckets[lcore_id]->top;
+		rte_ring_count(bplc->bd->buckets[lcore_id]);
 	bplc->count +=
 		rte_ring_count(bplc->bd->adoption_buffer_rings[lcore_id]);
 	return 0;
@@ -415,10 +381,17 @@ bucket_init_per_lcore(unsigned int lcore_id, void *arg)
 	int rc;
 
 	mp = bd->pool;
-	bd->buckets[lcore_id] = bucket_stack_create(mp,
-		mp->size / bd->obj_per_bucket);
+	rc = snprintf(rg_name, sizeof(rg_name), RTE_MEMPOOL_MZ_FORMAT ".b%u",
+		mp->name, lcore_id);
+	if (rc < 0 || rc >= (int)sizeof(rg_name))
+		return -1;
+
+	/* Ring is big enough to put all buckets */
+	bd->buckets[lcore_id] = rte_ring_create(rg_name,
+		rte_align32pow2(mp->size / bd->obj_per_bucket + 1),
+		mp->socket_id, RING_F_SP_ENQ);
 	if (bd->buckets[lcore_id] == NULL)
-		goto error;
+		return -1;
 
 	rc = snprintf(rg_name, sizeof(rg_name), RTE_MEMPOOL_MZ_FORMAT ".a%u",
 		mp->name, lcore_id);
@@ -435,7 +408,7 @@ bucket_init_per_lcore(unsigned int lcore_id, void *arg)
 
 	return 0;
 error:
-	rte_free(bd->buckets[lcore_id]);
+	rte_ring_free(bd->buckets[lcore_id]);
 	bd->buckets[lcore_id] = NULL;
 	return -1;
 }
@@ -447,7 +420,7 @@ bucket_uninit_per_lcore(unsigned int lcore_id, void *arg)
 
 	rte_ring_free(bd->adoption_buffer_rings[lcore_id]);
 	bd->adoption_buffer_rings[lcore_id] = NULL;
-	rte_free(bd->buckets[lcore_id]);
+	rte_ring_free(bd->buckets[lcore_id]);
 	bd->buckets[lcore_id] = NULL;
 }
 
@@ -484,8 +457,6 @@ bucket_alloc(struct rte_mempool *mp)
 	bd->obj_per_bucket = (bd->bucket_mem_size - bucket_header_size) /
 		bd->total_elt_size;
 	bd->bucket_page_mask = ~(rte_align64pow2(bd->bucket_mem_size) - 1);
-	/* eventually this should be a tunable parameter */
-	bd->bucket_stack_thresh = (mp->size / bd->obj_per_bucket) * 4 / 3;
 
 	bd->lcore_callback_handle = rte_lcore_callback_register("bucket",
 		bucket_init_per_lcore, bucket_uninit_per_lcore, bd);
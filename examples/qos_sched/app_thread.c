@@ -58,6 +58,35 @@ get_pkt_sched(struct rte_mbuf *m, uint32_t *subport, uint32_t *pipe,
 	return 0;
 }
 
+/* Hand the packets over to the WT lcore owning their subport */
+static inline void
+app_rx_split(struct thread_conf *conf, struct rte_mbuf **mbufs, uint32_t nb_rx)
+{
+	struct rte_mbuf *sp_mbufs[MAX_SCHED_SUBPORTS][nb_rx];
+	uint32_t n[MAX_SCHED_SUBPORTS] = {0};
+	uint32_t subport, pipe, traffic_class, queue;
+	uint32_t i, j;
+
+	for (i = 0; i < nb_rx; i++) {
+		rte_sched_port_pkt_read_tree_path(conf->sched_port, mbufs[i],
+				&subport, &pipe, &traffic_class, &queue);
+		sp_mbufs[subport][n[subport]++] = mbufs[i];
+	}
+
+	for (subport = 0; subport < MAX_SCHED_SUBPORTS; subport++) {
+		if (n[subport] == 0)
+			continue;
+
+		if (unlikely(rte_ring_sp_enqueue_bulk(conf->subport_ring[subport],
+				(void **)sp_mbufs[subport], n[subport], NULL) == 0)) {
+			for (j = 0; j < n[subport]; j++)
+				rte_pktmbuf_free(sp_mbufs[subport][j]);
+
+			APP_STATS_ADD(conf->stat.nb_drop, n[subport]);
+		}
+	}
+}
+
 void
 app_rx_thread(struct thread_conf **confs)
 {
@@ -89,7 +118,9 @@ app_rx_thread(struct thread_conf **confs)
 						(enum rte_color) color);
 			}
 
-			if (unlikely(rte_ring_sp_enqueue_bulk(conf->rx_ring,
+			if (conf->subport_ring[0] != NULL)
+				app_rx_split(conf, rx_mbufs, nb_rx);
+			else if (unlikely(rte_ring_sp_enqueue_bulk(conf->rx_ring,
 					(void **)rx_mbufs, nb_rx, NULL) == 0)) {
 				for(i = 0; i < nb_rx; i++) {
 					rte_pktmbuf_free(rx_mbufs[i]);
@@ -210,10 +241,14 @@ app_worker_thread(struct thread_conf **confs)
 			APP_STATS_ADD(conf->stat.nb_rx, nb_pkt);
 		}
 
-		nb_pkt = rte_sched_port_dequeue(conf->sched_port, mbufs,
+		if (conf->sched_worker != NULL)
+			nb_pkt = rte_sched_port_worker_dequeue(conf->sched_worker,
+					mbufs, burst_conf.qos_dequeue);
+		else
+			nb_pkt = rte_sched_port_dequeue(conf->sched_port, mbufs,
 					burst_conf.qos_dequeue);
 		if (likely(nb_pkt > 0))
-			while (rte_ring_sp_enqueue_bulk(conf->tx_ring,
+			while (rte_ring_enqueue_bulk(conf->tx_ring,
 					(void **)mbufs, nb_pkt, NULL) == 0)
 				; /* empty body */
 
@@ -66,6 +66,8 @@ static const char usage[] =
 	"           B = TX host threshold (default value is %u)                         \n"
 	"           C = TX write-back threshold (default value is %u)                   \n"
 	"    --cfg FILE : profile configuration to load                                 \n"
+	"    --mwt \"A, B, C\" : Extra WT lcores of the last pfc, its port subports are   \n"
+	"           split between all its WT lcores (the pfc needs a TX LCORE)          \n"
 ;
 
 /* display usage */
@@ -275,6 +277,44 @@ app_parse_flow_conf(const char *conf_str)
 	return 0;
 }
 
+static int
+app_parse_mwt_conf(const char *conf_str)
+{
+	int ret;
+	uint32_t i, vals[MAX_WT_CORES - 1];
+	struct flow_conf *pconf;
+
+	if (nb_pfc == 0) {
+		RTE_LOG(ERR, APP, "mwt: no pfc configured\n");
+		return -1;
+	}
+
+	pconf = &qos_conf[nb_pfc - 1];
+	if (pconf->tx_core == pconf->wt_core) {
+		RTE_LOG(ERR, APP, "pfc %u: several WT lcores need a TX lcore\n",
+				nb_pfc - 1);
+		return -1;
+	}
+
+	ret = app_parse_opt_vals(conf_str, ',', MAX_WT_CORES - 1, vals);
+	if (ret < 1)
+		return -1;
+
+	for (i = 0; i < (uint32_t)ret; i++) {
+		if (vals[i] == pconf->rx_core || vals[i] == pconf->tx_core) {
+			RTE_LOG(ERR, APP, "pfc %u: WT lcore %u is used already\n",
+					nb_pfc - 1, vals[i]);
+			return -1;
+		}
+
+		pconf->mwt_core[i] = vals[i];
+		app_used_core_mask |= 1lu << vals[i];
+	}
+	pconf->n_mwt_cores = ret;
+
+	return 0;
+}
+
 static int
 app_parse_burst_conf(const char *conf_str)
 {
@@ -310,6 +350,8 @@ enum {
 	OPT_TTH_NUM,
 #define OPT_CFG "cfg"
 	OPT_CFG_NUM,
+#define OPT_MWT "mwt"
+	OPT_MWT_NUM,
 };
 
 /*
@@ -333,6 +375,7 @@ app_parse_args(int argc, char **argv)
 		{OPT_RTH, 1, NULL, OPT_RTH_NUM},
 		{OPT_TTH, 1, NULL, OPT_TTH_NUM},
 		{OPT_CFG, 1, NULL, OPT_CFG_NUM},
+		{OPT_MWT, 1, NULL, OPT_MWT_NUM},
 		{NULL,    0, 0,    0          }
 	};
 
@@ -419,6 +462,15 @@ app_parse_args(int argc, char **argv)
 				cfg_profile = optarg;
 				break;
 
+			case OPT_MWT_NUM:
+				ret = app_parse_mwt_conf(optarg);
+				if (ret) {
+					RTE_LOG(ERR, APP, "Invalid WT lcores configuration %s\n",
+							optarg);
+					return -1;
+				}
+				break;
+
 			default:
 				app_usage(prgname);
 				return -1;
@@ -355,6 +355,47 @@ app_init_sched_port(uint32_t portid, uint32_t socketid)
 	return port;
 }
 
+/* split the port subports between the WT lcores of a pfc */
+static void
+app_init_sched_workers(struct flow_conf *flow, uint32_t pfc, uint32_t socket)
+{
+	char ring_name[MAX_NAME_LEN];
+	uint32_t n_workers = flow->n_mwt_cores + 1;
+	uint32_t n_subports = port_params.n_subports_per_port;
+	uint32_t i, n, subport, first = 0;
+	struct rte_ring *ring;
+
+	if (n_subports < n_workers)
+		rte_exit(EXIT_FAILURE, "pfc %u: %u WT lcores for %u subports\n",
+			pfc, n_workers, n_subports);
+
+	for (i = 0; i < n_workers; i++) {
+		n = n_subports / n_workers + (i < n_subports % n_workers);
+
+		ring = flow->rx_ring;
+		if (i > 0) {
+			snprintf(ring_name, MAX_NAME_LEN, "ring-%u-%u", pfc,
+				flow->mwt_core[i - 1]);
+			ring = rte_ring_create(ring_name, ring_conf.ring_size,
+				socket, RING_F_SP_ENQ | RING_F_SC_DEQ);
+			if (ring == NULL)
+				rte_exit(EXIT_FAILURE, "Cannot create ring %s\n",
+					ring_name);
+			flow->mwt_ring[i - 1] = ring;
+		}
+
+		flow->sched_worker[i] = rte_sched_port_worker_create(
+			flow->sched_port, first, n);
+		if (flow->sched_worker[i] == NULL)
+			rte_exit(EXIT_FAILURE, "Unable to create sched worker "
+				"for subports %u-%u\n", first, first + n - 1);
+
+		for (subport = first; subport < first + n; subport++)
+			flow->rx_thread.subport_ring[subport] = ring;
+		first += n;
+	}
+}
+
 static int
 app_load_cfg_profile(const char *profile)
 {
@@ -400,11 +441,13 @@ int app_init(void)
 		else
 			qos_conf[i].rx_ring = ring;
 
+		/* the TX ring is written by all the WT lcores of the pfc */
 		snprintf(ring_name, MAX_NAME_LEN, "ring-%u-%u", i, qos_conf[i].tx_core);
 		ring = rte_ring_lookup(ring_name);
 		if (ring == NULL)
 			qos_conf[i].tx_ring = rte_ring_create(ring_name, ring_conf.ring_size,
-				socket, RING_F_SP_ENQ | RING_F_SC_DEQ);
+				socket, qos_conf[i].n_mwt_cores ? RING_F_SC_DEQ :
+				RING_F_SP_ENQ | RING_F_SC_DEQ);
 		else
 			qos_conf[i].tx_ring = ring;
 
@@ -422,6 +465,8 @@ int app_init(void)
 		app_init_port(qos_conf[i].tx_port, qos_conf[i].mbuf_pool);
 
 		qos_conf[i].sched_port = app_init_sched_port(qos_conf[i].tx_port, socket);
+		if (qos_conf[i].n_mwt_cores != 0)
+			app_init_sched_workers(&qos_conf[i], i, socket);
 	}
 
 	RTE_LOG(INFO, APP, "time stamp clock running at %" PRIu64 " Hz\n",
@@ -32,7 +32,7 @@ static int
 app_main_loop(__rte_unused void *dummy)
 {
 	uint32_t lcore_id;
-	uint32_t i, mode;
+	uint32_t i, j, mode;
 	uint32_t rx_idx = 0;
 	uint32_t wt_idx = 0;
 	uint32_t tx_idx = 0;
@@ -75,9 +75,26 @@ app_main_loop(__rte_unused void *dummy)
 			flow->wt_thread.tx_ring =  flow->tx_ring;
 			flow->wt_thread.tx_port =  flow->tx_port;
 			flow->wt_thread.sched_port =  flow->sched_port;
+			flow->wt_thread.sched_worker = flow->sched_worker[0];
 
 			wt_confs[wt_idx++] = &flow->wt_thread;
 
+			mode |= APP_WT_MODE;
+		}
+		for (j = 0; j < flow->n_mwt_cores; j++) {
+			struct thread_conf *wt = &flow->mwt_thread[j];
+
+			if (flow->mwt_core[j] != lcore_id)
+				continue;
+
+			wt->rx_ring = flow->mwt_ring[j];
+			wt->tx_ring = flow->tx_ring;
+			wt->tx_port = flow->tx_port;
+			wt->sched_port = flow->sched_port;
+			wt->sched_worker = flow->sched_worker[j + 1];
+
+			wt_confs[wt_idx++] = wt;
+
 			mode |= APP_WT_MODE;
 		}
 	}
@@ -146,7 +163,7 @@ app_main_loop(__rte_unused void *dummy)
 void
 app_stat(void)
 {
-	uint32_t i;
+	uint32_t i, j;
 	struct rte_eth_stats stats;
 	static struct rte_eth_stats rx_stats[MAX_DATA_STREAMS];
 	static struct rte_eth_stats tx_stats[MAX_DATA_STREAMS];
@@ -172,6 +189,14 @@ app_stat(void)
 		memcpy(&tx_stats[i], &stats, sizeof(stats));
 
 #if APP_COLLECT_STAT
+		for (j = 0; j < flow->n_mwt_cores; j++) {
+			struct thread_stat *wt_stat = &flow->mwt_thread[j].stat;
+
+			flow->wt_thread.stat.nb_rx += wt_stat->nb_rx;
+			flow->wt_thread.stat.nb_drop += wt_stat->nb_drop;
+			memset(wt_stat, 0, sizeof(struct thread_stat));
+		}
+
 		printf("-------+------------+------------+\n");
 		printf("       |  received  |   dropped  |\n");
 		printf("-------+------------+------------+\n");
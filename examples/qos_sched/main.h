@@ -52,6 +52,7 @@ extern "C" {
 #define MAX_SCHED_PIPES		4096
 #define MAX_SCHED_PIPE_PROFILES		256
 #define MAX_SCHED_SUBPORT_PROFILES	8
+#define MAX_WT_CORES		4
 
 #ifndef APP_COLLECT_STAT
 #define APP_COLLECT_STAT		1
@@ -86,6 +87,9 @@ struct thread_conf
 	struct rte_ring *rx_ring;
 	struct rte_ring *tx_ring;
 	struct rte_sched_port *sched_port;
+	struct rte_sched_port_worker *sched_worker;
+	/* WT lcore ring of each subport, set when the port has several WT lcores */
+	struct rte_ring *subport_ring[MAX_SCHED_SUBPORTS];
 
 #if APP_COLLECT_STAT
 	struct thread_stat stat;
@@ -110,6 +114,13 @@ struct flow_conf
 	struct thread_conf rx_thread;
 	struct thread_conf wt_thread;
 	struct thread_conf tx_thread;
+
+	/* Extra WT lcores, the port subports are split between all WT lcores */
+	uint32_t n_mwt_cores;
+	uint32_t mwt_core[MAX_WT_CORES - 1];
+	struct rte_ring *mwt_ring[MAX_WT_CORES - 1];
+	struct rte_sched_port_worker *sched_worker[MAX_WT_CORES];
+	struct thread_conf mwt_thread[MAX_WT_CORES - 1];
 };
 
 
@@ -163,6 +163,8 @@ struct rte_acl_bld_trie {
 	struct rte_acl_node *trie;
 };
 
+struct acl_build_context;
+
 struct rte_acl_ctx {
 	char                name[RTE_ACL_NAMESIZE];
 	/** Name of the ACL context. */
@@ -174,6 +176,8 @@ struct rte_acl_ctx {
 	uint32_t            max_rules;
 	uint32_t            rule_sz;
 	uint32_t            num_rules;
+	struct acl_build_context *bld;
+	/** Build state kept for incremental builds. */
 	uint32_t            num_categories;
 	uint32_t            num_tries;
 	uint32_t            match_index;
@@ -187,6 +191,8 @@ struct rte_acl_ctx {
 	struct rte_acl_config config; /* copy of build config. */
 };
 
+void acl_build_free_state(struct rte_acl_ctx *ctx);
+
 int rte_acl_gen(struct rte_acl_ctx *ctx, struct rte_acl_trie *trie,
 	struct rte_acl_bld_trie *node_bld_trie, uint32_t num_tries,
 	uint32_t num_categories, uint32_t data_index_sz, size_t max_size);
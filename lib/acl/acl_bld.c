@@ -3,6 +3,8 @@
  */
 
 #include <rte_acl.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
 #include "tb_mem.h"
 #include "acl.h"
 
@@ -12,6 +14,9 @@
 /* number of pointers per alloc */
 #define ACL_PTR_ALLOC	32
 
+/* number of bits of a 128-bit prefix field */
+#define ACL_MASK128_BITS	128U
+
 /* macros for dividing rule sets heuristics */
 #define NODE_MAX	0x4000
 #define NODE_MIN	0x800
@@ -62,6 +67,8 @@ struct rte_acl_build_rule {
 	uint32_t                    *wildness;
 };
 
+struct acl_build_job;
+
 /* Context for build phase */
 struct acl_build_context {
 	const struct rte_acl_ctx *acx;
@@ -85,6 +92,25 @@ struct acl_build_context {
 	/* memory free lists for nodes and blocks used for node ptrs */
 	struct acl_mem_block      blocks[MEM_BLOCK_NUM];
 	struct rte_acl_node       *node_free_list;
+
+	/* tries rebuilt on worker lcores, each job owns its nodes */
+	const unsigned int        *lcores;
+	uint32_t                  num_lcores;
+	uint32_t                  num_jobs;
+	uint32_t                  num_jobs_done;
+	struct acl_build_job      *jobs[RTE_ACL_MAX_TRIES];
+
+	/* number of rules of the ACL context built in the tries */
+	uint32_t                  num_built;
+};
+
+/* Rebuild of one trie on a worker lcore, with its own build context */
+struct acl_build_job {
+	struct acl_build_context  bcx;
+	struct rte_acl_build_rule *rule_sets[RTE_ACL_MAX_TRIES];
+	uint32_t                  trie;
+	unsigned int              lcore;
+	int32_t                   rc;
 };
 
 static int acl_merge_trie(struct acl_build_context *context,
@@ -1001,6 +1027,39 @@ build_trie(struct acl_build_context *context, struct rte_acl_build_rule *head,
 			}
 			break;
 
+			case RTE_ACL_FIELD_TYPE_MASK128:
+			{
+				/*
+				 * Lay the prefix out in host order, as for the
+				 * other fields, and only build its leading
+				 * bytes that the rules of the trie need.
+				 */
+				uint64_t val[2], mask[2];
+				uint64_t len;
+				uint32_t size;
+
+				len = RTE_MIN(fld->mask_range.u32,
+					ACL_MASK128_BITS);
+				size = rule->config->defs[n].size;
+
+				val[0] = fld[1].value.u64;
+				val[1] = fld[0].value.u64;
+				mask[0] = RTE_ACL_MASKLEN_TO_BITMASK(
+					len > 64 ? len - 64 : 0,
+					sizeof(uint64_t));
+				mask[1] = RTE_ACL_MASKLEN_TO_BITMASK(
+					RTE_MIN(len, (uint64_t)64),
+					sizeof(uint64_t));
+
+				merge = acl_gen_mask_trie(context,
+					(uint8_t *)val + sizeof(val) - size,
+					(uint8_t *)mask + sizeof(mask) - size,
+					size,
+					end->level + 1,
+					&end);
+			}
+			break;
+
 			case RTE_ACL_FIELD_TYPE_RANGE:
 				merge = acl_gen_range_trie(context,
 					&rule->f->field[field_index].value,
@@ -1079,7 +1138,7 @@ acl_calc_wildness(struct rte_acl_build_rule *head,
 
 			double wild = 0;
 			uint32_t bit_len = CHAR_BIT * config->defs[n].size;
-			uint64_t msk_val = RTE_LEN2MASK(bit_len,
+			uint64_t msk_val = RTE_LEN2MASK(RTE_MIN(bit_len, 64U),
 				typeof(msk_val));
 			double size = bit_len;
 			int field_index = config->defs[n].field_index;
@@ -1097,6 +1156,11 @@ acl_calc_wildness(struct rte_acl_build_rule *head,
 				wild = (size - fld->mask_range.u32) / size;
 				break;
 
+			case RTE_ACL_FIELD_TYPE_MASK128:
+				wild = (size - RTE_MIN(fld->mask_range.u32,
+					ACL_MASK128_BITS)) / size;
+				break;
+
 			case RTE_ACL_FIELD_TYPE_RANGE:
 				wild = (fld->mask_range.u64 & msk_val) -
 					(fld->value.u64 & msk_val);
@@ -1109,6 +1173,25 @@ acl_calc_wildness(struct rte_acl_build_rule *head,
 	}
 }
 
+/*
+ * Size of the leading part of a 128-bit prefix field,
+ * in 32-bit words, that the given rules need.
+ */
+static uint8_t
+acl_mask128_size(const struct rte_acl_build_rule *head, uint32_t field_index)
+{
+	const struct rte_acl_build_rule *rule;
+	uint32_t len;
+
+	len = 0;
+	for (rule = head; rule != NULL; rule = rule->next)
+		len = RTE_MAX(len, rule->f->field[field_index].mask_range.u32);
+
+	len = RTE_MIN(len, ACL_MASK128_BITS);
+	return RTE_MAX(RTE_ALIGN_CEIL(len, 32U) / CHAR_BIT,
+		sizeof(uint32_t));
+}
+
 static void
 acl_rule_stats(struct rte_acl_build_rule *head, struct rte_acl_config *config)
 {
@@ -1142,6 +1225,16 @@ acl_rule_stats(struct rte_acl_build_rule *head, struct rte_acl_config *config)
 		}
 	}
 
+	/*
+	 * Only keep the leading 32-bit words of 128-bit prefixes
+	 * that some of the rules need.
+	 */
+	for (n = 0; n < config->num_fields; n++) {
+		if (config->defs[n].type == RTE_ACL_FIELD_TYPE_MASK128)
+			config->defs[n].size = acl_mask128_size(head,
+				config->defs[n].field_index);
+	}
+
 	/*
 	 * Look for any field that is always wild and drop it from the config
 	 * Only deactivate if all fields for a given input loop are deactivated.
@@ -1291,7 +1384,7 @@ sort_rules(struct rte_acl_build_rule *head)
 static uint32_t
 acl_build_index(const struct rte_acl_config *config, uint32_t *data_index)
 {
-	uint32_t n, m;
+	uint32_t k, n, m;
 	int32_t last_header;
 
 	m = 0;
@@ -1301,6 +1394,16 @@ acl_build_index(const struct rte_acl_config *config, uint32_t *data_index)
 		if (last_header != config->defs[n].input_index) {
 			last_header = config->defs[n].input_index;
 			data_index[m++] = config->defs[n].offset;
+
+			/* 128-bit prefix is read 4 bytes at a time. */
+			if (config->defs[n].type ==
+					RTE_ACL_FIELD_TYPE_MASK128) {
+				for (k = sizeof(uint32_t);
+						k < config->defs[n].size;
+						k += sizeof(uint32_t))
+					data_index[m++] =
+						config->defs[n].offset + k;
+			}
 		}
 	}
 
@@ -1335,9 +1438,147 @@ build_one_trie(struct acl_build_context *context,
 	return last;
 }
 
+/*
+ * Rebuild the n-th trie of a worker build context.
+ */
+static int
+acl_build_job_run(void *arg)
+{
+	struct acl_build_job *job;
+	struct acl_build_context *bcx;
+	struct rte_acl_build_rule *last;
+	int32_t rc;
+
+	job = arg;
+	bcx = &job->bcx;
+
+	rc = sigsetjmp(bcx->pool.fail, 0);
+
+	/* build phase runs out of memory. */
+	if (rc != 0) {
+		job->rc = rc;
+		return rc;
+	}
+
+	last = build_one_trie(bcx, job->rule_sets, job->trie, INT32_MAX);
+	if (bcx->bld_tries[job->trie].trie == NULL || last != NULL) {
+		RTE_LOG(ERR, ACL, "Build of %u-th trie failed\n", job->trie);
+		job->rc = -ENOMEM;
+	} else
+		job->rc = 0;
+
+	return job->rc;
+}
+
+/*
+ * Launch the rebuild of the n-th trie on one of the worker lcores,
+ * so that the rest of the rule set is split at the same time.
+ * Returns a negative value if no worker lcore could take the job.
+ */
+static int
+acl_build_job_launch(struct acl_build_context *context,
+	struct rte_acl_build_rule *rule_sets[RTE_ACL_MAX_TRIES], uint32_t n)
+{
+	struct acl_build_job *job;
+	unsigned int lcore;
+	uint32_t i;
+
+	if (context->num_lcores == 0 ||
+			rte_lcore_id() != rte_get_main_lcore())
+		return -ENOTSUP;
+
+	lcore = context->lcores[context->num_jobs % context->num_lcores];
+
+	job = calloc(1, sizeof(*job));
+	if (job == NULL)
+		return -ENOMEM;
+
+	job->bcx.acx = context->acx;
+	job->bcx.cfg = context->cfg;
+	job->bcx.category_mask = context->category_mask;
+	job->bcx.node_max = context->node_max;
+	job->bcx.pool.alignment = ACL_POOL_ALIGN;
+	job->bcx.pool.min_alloc = ACL_POOL_ALLOC_MIN;
+	job->rule_sets[n] = rule_sets[n];
+	job->trie = n;
+	job->lcore = lcore;
+
+	/* wait for the previous job launched on that lcore */
+	for (i = context->num_jobs_done; i != context->num_jobs; i++) {
+		if (context->jobs[i]->lcore == lcore) {
+			rte_eal_wait_lcore(lcore);
+			break;
+		}
+	}
+
+	if (rte_eal_remote_launch(acl_build_job_run, job, lcore) != 0) {
+		free(job);
+		return -EBUSY;
+	}
+
+	context->jobs[context->num_jobs++] = job;
+	return 0;
+}
+
+/*
+ * Wait for the tries rebuilt on worker lcores and take them
+ * into the main build context.
+ */
+static int
+acl_build_jobs_wait(struct acl_build_context *context)
+{
+	struct acl_build_job *job;
+	uint32_t i, n;
+	int32_t rc;
+
+	rc = 0;
+	for (i = context->num_jobs_done; i != context->num_jobs; i++) {
+		job = context->jobs[i];
+		rte_eal_wait_lcore(job->lcore);
+		if (job->rc != 0) {
+			rc = job->rc;
+			continue;
+		}
+
+		n = job->trie;
+		context->tries[n] = job->bcx.tries[n];
+		context->bld_tries[n] = job->bcx.bld_tries[n];
+		memcpy(context->data_indexes[n], job->bcx.data_indexes[n],
+			sizeof(context->data_indexes[n]));
+		context->tries[n].data_index = context->data_indexes[n];
+		context->num_nodes += job->bcx.num_nodes;
+	}
+
+	context->num_jobs_done = context->num_jobs;
+	return rc;
+}
+
+/*
+ * Release the build context memory, including the one of the worker jobs.
+ */
+static void
+acl_build_free_ctx(struct acl_build_context *context)
+{
+	uint32_t i;
+
+	acl_build_jobs_wait(context);
+
+	for (i = 0; i != context->num_jobs; i++) {
+		tb_free_pool(&context->jobs[i]->bcx.pool);
+		free(context->jobs[i]);
+	}
+	context->num_jobs = 0;
+	context->num_jobs_done = 0;
+
+	tb_free_pool(&context->pool);
+}
+
+/*
+ * Build the tries for the given rule set, starting from the first one.
+ */
 static int
 acl_build_tries(struct acl_build_context *context,
-	struct rte_acl_build_rule *head)
+	struct rte_acl_build_rule *head, uint32_t first)
 {
 	uint32_t n, num_tries;
 	struct rte_acl_config *config;
@@ -1345,21 +1586,21 @@ acl_build_tries(struct acl_build_context *context,
 	struct rte_acl_build_rule *rule_sets[RTE_ACL_MAX_TRIES];
 
 	config = head->config;
-	rule_sets[0] = head;
+	rule_sets[first] = head;
 
 	/* initialize tries */
-	for (n = 0; n < RTE_DIM(context->tries); n++) {
+	for (n = first; n < RTE_DIM(context->tries); n++) {
 		context->tries[n].type = RTE_ACL_UNUSED_TRIE;
 		context->bld_tries[n].trie = NULL;
 		context->tries[n].count = 0;
 	}
 
-	context->tries[0].type = RTE_ACL_FULL_TRIE;
+	context->tries[first].type = RTE_ACL_FULL_TRIE;
 
 	/* calc wildness of each field of each rule */
 	acl_calc_wildness(head, config);
 
-	for (n = 0;; n = num_tries) {
+	for (n = first;; n = num_tries) {
 
 		num_tries = n + 1;
 
@@ -1384,6 +1625,7 @@ acl_build_tries(struct acl_build_context *context,
 		rule_sets[num_tries] = last->next;
 		last->next = NULL;
 		acl_free_node(context, context->bld_tries[n].trie);
+		context->bld_tries[n].trie = NULL;
 
 		/* Create a new copy of config for remaining rules. */
 		config = acl_build_alloc(context, 1, sizeof(*config));
@@ -1398,6 +1640,9 @@ acl_build_tries(struct acl_build_context *context,
 		 * Rebuild the trie for the reduced rule-set.
 		 * Don't try to split it any further.
 		 */
+		if (acl_build_job_launch(context, rule_sets, n) == 0)
+			continue;
+
 		last = build_one_trie(context, rule_sets, n, INT32_MAX);
 		if (context->bld_tries[n].trie == NULL || last != NULL) {
 			RTE_LOG(ERR, ACL, "Build of %u-th trie failed\n", n);
@@ -1407,22 +1652,29 @@ acl_build_tries(struct acl_build_context *context,
 	}
 
 	context->num_tries = num_tries;
-	return 0;
+	return acl_build_jobs_wait(context);
 }
 
 static void
 acl_build_log(const struct acl_build_context *ctx)
 {
 	uint32_t n;
+	size_t alloc;
+
+	alloc = ctx->pool.alloc;
+	for (n = 0; n != ctx->num_jobs; n++)
+		alloc += ctx->jobs[n]->bcx.pool.alloc;
 
 	RTE_LOG(DEBUG, ACL, "Build phase for ACL \"%s\":\n"
 		"node limit for tree split: %u\n"
 		"nodes created: %u\n"
+		"tries built on worker lcores: %u\n"
 		"memory consumed: %zu\n",
 		ctx->acx->name,
 		ctx->node_max,
 		ctx->num_nodes,
-		ctx->pool.alloc);
+		ctx->num_jobs,
+		alloc);
 
 	for (n = 0; n < RTE_DIM(ctx->tries); n++) {
 		if (ctx->tries[n].count != 0)
@@ -1433,8 +1685,13 @@ acl_build_log(const struct acl_build_context *ctx)
 	}
 }
 
+/*
+ * Create a build rules copy of the context rules, starting from the first
+ * one, all using the given config.
+ */
 static int
-acl_build_rules(struct acl_build_context *bcx)
+acl_build_rules(struct acl_build_context *bcx, uint32_t first,
+	struct rte_acl_config *config)
 {
 	struct rte_acl_build_rule *br, *head;
 	const struct rte_acl_rule *rule;
@@ -1442,8 +1699,16 @@ acl_build_rules(struct acl_build_context *bcx)
 	uint32_t fn, i, n, num;
 	size_t ofs, sz;
 
-	fn = bcx->cfg.num_fields;
-	n = bcx->acx->num_rules;
+	/*
+	 * wildness is kept per rule field, some of them might be unused.
+	 * The rules get the fields of the given config: the build config
+	 * of a previous build may have lost the ones always wild since.
+	 */
+	fn = 0;
+	for (i = 0; i != config->num_fields; i++)
+		fn = RTE_MAX(fn, config->defs[i].field_index + 1U);
+
+	n = bcx->acx->num_rules - first;
 	ofs = n * sizeof(*br);
 	sz = ofs + n * fn * sizeof(*wp);
 
@@ -1453,12 +1718,12 @@ acl_build_rules(struct acl_build_context *bcx)
 	num = 0;
 	head = NULL;
 
-	for (i = 0; i != n; i++) {
+	for (i = first; i != bcx->acx->num_rules; i++) {
 		rule = (const struct rte_acl_rule *)
 			((uintptr_t)bcx->acx->rules + bcx->acx->rule_sz * i);
 		if ((rule->data.category_mask & bcx->category_mask) != 0) {
 			br[num].next = head;
-			br[num].config = &bcx->cfg;
+			br[num].config = config;
 			br[num].f = rule;
 			br[num].wildness = wp;
 			wp += fn;
@@ -1499,7 +1764,8 @@ acl_set_data_indexes(struct rte_acl_ctx *ctx)
  */
 static int
 acl_bld(struct acl_build_context *bcx, struct rte_acl_ctx *ctx,
-	const struct rte_acl_config *cfg, uint32_t node_max)
+	const struct rte_acl_config *cfg, uint32_t node_max,
+	const struct rte_acl_build_param *prm)
 {
 	int32_t rc;
 
@@ -1512,6 +1778,8 @@ acl_bld(struct acl_build_context *bcx, struct rte_acl_ctx *ctx,
 	bcx->category_mask = RTE_LEN2MASK(bcx->cfg.num_categories,
 		typeof(bcx->category_mask));
 	bcx->node_max = node_max;
+	bcx->lcores = prm->lcores;
+	bcx->num_lcores = prm->num_lcores;
 
 	rc = sigsetjmp(bcx->pool.fail, 0);
 
@@ -1524,7 +1792,7 @@ acl_bld(struct acl_build_context *bcx, struct rte_acl_ctx *ctx,
 	}
 
 	/* Create a build rules copy. */
-	rc = acl_build_rules(bcx);
+	rc = acl_build_rules(bcx, 0, &bcx->cfg);
 	if (rc != 0)
 		return rc;
 
@@ -1533,7 +1801,7 @@ acl_bld(struct acl_build_context *bcx, struct rte_acl_ctx *ctx,
 		rc = -EINVAL;
 	} else {
 		/* build internal trie representation. */
-		rc = acl_build_tries(bcx, bcx->build_rules);
+		rc = acl_build_tries(bcx, bcx->build_rules, 0);
 	}
 	return rc;
 }
@@ -1549,7 +1817,7 @@ acl_check_bld_param(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg)
 		sizeof(uint32_t), sizeof(uint64_t),
 	};
 
-	uint32_t i, j;
+	uint32_t i, j, num_indexes;
 
 	if (ctx == NULL || cfg == NULL || cfg->num_categories == 0 ||
 			cfg->num_categories > RTE_ACL_MAX_CATEGORIES ||
@@ -1557,13 +1825,38 @@ acl_check_bld_param(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg)
 			cfg->num_fields > RTE_ACL_MAX_FIELDS)
 		return -EINVAL;
 
+	num_indexes = 0;
 	for (i = 0; i != cfg->num_fields; i++) {
-		if (cfg->defs[i].type > RTE_ACL_FIELD_TYPE_BITMASK) {
+		if (cfg->defs[i].type > RTE_ACL_FIELD_TYPE_MASK128) {
 			RTE_LOG(ERR, ACL,
 			"ACL context: %s, invalid type: %hhu for %u-th field\n",
 			ctx->name, cfg->defs[i].type, i);
 			return -EINVAL;
 		}
+
+		if (i == 0 || cfg->defs[i].input_index !=
+				cfg->defs[i - 1].input_index)
+			num_indexes++;
+
+		/* 128-bit prefix takes 4 input indexes of its own */
+		if (cfg->defs[i].type == RTE_ACL_FIELD_TYPE_MASK128) {
+			if (cfg->defs[i].size != ACL_MASK128_BITS / CHAR_BIT ||
+					cfg->defs[i].field_index + 1 >=
+					RTE_ACL_MAX_FIELDS ||
+					(i != 0 && cfg->defs[i].input_index ==
+					cfg->defs[i - 1].input_index) ||
+					(i + 1 != cfg->num_fields &&
+					cfg->defs[i].input_index ==
+					cfg->defs[i + 1].input_index)) {
+				RTE_LOG(ERR, ACL,
+				"ACL context: %s, invalid 128-bit %u-th field\n",
+				ctx->name, i);
+				return -EINVAL;
+			}
+			num_indexes += 3;
+			continue;
+		}
+
 		for (j = 0;
 				j != RTE_DIM(field_sizes) &&
 				cfg->defs[i].size != field_sizes[j];
@@ -1578,6 +1871,13 @@ acl_check_bld_param(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg)
 		}
 	}
 
+	if (num_indexes > RTE_ACL_MAX_FIELDS) {
+		RTE_LOG(ERR, ACL,
+			"ACL context: %s, too many input indexes: %u\n",
+			ctx->name, num_indexes);
+		return -EINVAL;
+	}
+
 	return 0;
 }
 
@@ -1612,20 +1912,162 @@ get_first_load_size(const struct rte_acl_config *cfg)
 	return (ofs < max_ofs) ? sizeof(uint32_t) : sizeof(uint8_t);
 }
 
-int
-rte_acl_build(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg)
+/*
+ * Reset the run-time layout of the nodes of a trie already generated,
+ * so that it can be generated again along with new tries.
+ */
+static void
+acl_reset_gen_node(struct rte_acl_node *node)
+{
+	uint32_t n;
+
+	if (node->node_type == RTE_ACL_NODE_UNDEFINED)
+		return;
+
+	node->node_type = RTE_ACL_NODE_UNDEFINED;
+	node->node_index = RTE_ACL_NODE_UNDEFINED;
+	node->fanout = 0;
+
+	for (n = 0; n < node->num_ptrs; n++) {
+		if (node->ptrs[n].ptr != NULL)
+			acl_reset_gen_node(node->ptrs[n].ptr);
+	}
+}
+
+/*
+ * Check that a config is the one the kept build state was made for.
+ */
+static int
+acl_same_config(const struct rte_acl_config *a, const struct rte_acl_config *b)
+{
+	return a->num_categories == b->num_categories &&
+		a->num_fields == b->num_fields &&
+		a->max_size == b->max_size &&
+		memcmp(a->defs, b->defs,
+			a->num_fields * sizeof(a->defs[0])) == 0;
+}
+
+/*
+ * Build the rules added since the last build into new tries,
+ * keeping the tries of the previous rules as they are, then
+ * generate the run-time structures for all of them.
+ */
+static int
+acl_build_incremental(struct rte_acl_ctx *ctx,
+	const struct rte_acl_build_param *prm)
+{
+	int32_t rc;
+	uint32_t n, first;
+	size_t max_size;
+	struct rte_acl_config cfg, *config;
+	struct acl_build_context *bcx;
+
+	bcx = ctx->bld;
+
+	/* no new rules, run-time structures are up to date. */
+	if (ctx->num_rules == bcx->num_built)
+		return 0;
+
+	if (ctx->num_rules < bcx->num_built ||
+			bcx->num_tries == RTE_DIM(bcx->tries))
+		return -ERANGE;
+
+	bcx->lcores = prm->lcores;
+	bcx->num_lcores = prm->num_lcores;
+	first = bcx->num_tries;
+
+	rc = sigsetjmp(bcx->pool.fail, 0);
+
+	/* build phase runs out of memory. */
+	if (rc != 0) {
+		RTE_LOG(ERR, ACL,
+			"ACL context: %s, %s() failed with error code: %d\n",
+			bcx->acx->name, __func__, rc);
+		return rc;
+	}
+
+	/* new rules use their own copy of the build config. */
+	config = tb_alloc(&bcx->pool, sizeof(*config));
+	*config = ctx->config;
+
+	rc = acl_build_rules(bcx, bcx->num_built, config);
+	if (rc != 0)
+		return rc;
+
+	/* No new rules for the configured categories */
+	if (bcx->build_rules == NULL) {
+		bcx->num_built = ctx->num_rules;
+		return 0;
+	}
+
+	rc = acl_build_tries(bcx, bcx->build_rules, first);
+	if (rc != 0)
+		return rc;
+
+	cfg = ctx->config;
+	max_size = (cfg.max_size == 0) ? SIZE_MAX : cfg.max_size;
+
+	acl_build_reset(ctx);
+	for (n = 0; n != first; n++)
+		acl_reset_gen_node(bcx->bld_tries[n].trie);
+
+	/* allocate and fill run-time  structures. */
+	rc = rte_acl_gen(ctx, bcx->tries, bcx->bld_tries,
+		bcx->num_tries, bcx->cfg.num_categories,
+		RTE_ACL_MAX_FIELDS * RTE_DIM(bcx->tries) *
+		sizeof(ctx->data_indexes[0]), max_size);
+	if (rc != 0)
+		return rc;
+
+	acl_set_data_indexes(ctx);
+	ctx->first_load_sz = get_first_load_size(&cfg);
+	ctx->config = cfg;
+	bcx->num_built = ctx->num_rules;
+
+	acl_build_log(bcx);
+	return 0;
+}
+
+void
+acl_build_free_state(struct rte_acl_ctx *ctx)
+{
+	if (ctx->bld != NULL) {
+		acl_build_free_ctx(ctx->bld);
+		free(ctx->bld);
+		ctx->bld = NULL;
+	}
+}
+
+static int
+acl_build(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg,
+	const struct rte_acl_build_param *prm)
 {
 	int32_t rc;
 	uint32_t n;
 	size_t max_size;
-	struct acl_build_context bcx;
+	struct acl_build_context *bcx;
 
 	rc = acl_check_bld_param(ctx, cfg);
 	if (rc != 0)
 		return rc;
 
+	if ((prm->flags & RTE_ACL_BUILD_F_INCREMENTAL) != 0 &&
+			ctx->bld != NULL && acl_same_config(&ctx->config, cfg)) {
+		rc = acl_build_incremental(ctx, prm);
+		if (rc == 0)
+			return 0;
+		RTE_LOG(DEBUG, ACL,
+			"ACL context: %s, incremental build failed with error code: %d, rebuilding all tries\n",
+			ctx->name, rc);
+	}
+
+	acl_build_free_state(ctx);
 	acl_build_reset(ctx);
 
+	bcx = calloc(1, sizeof(*bcx));
+	if (bcx == NULL)
+		return -ENOMEM;
+
 	if (cfg->max_size == 0) {
 		n = NODE_MIN;
 		max_size = SIZE_MAX;
@@ -1637,13 +2079,13 @@ rte_acl_build(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg)
 	for (rc = -ERANGE; n >= NODE_MIN && rc == -ERANGE; n /= 2) {
 
 		/* perform build phase. */
-		rc = acl_bld(&bcx, ctx, cfg, n);
+		rc = acl_bld(bcx, ctx, cfg, n, prm);
 
 		if (rc == 0) {
 			/* allocate and fill run-time  structures. */
-			rc = rte_acl_gen(ctx, bcx.tries, bcx.bld_tries,
-				bcx.num_tries, bcx.cfg.num_categories,
-				RTE_ACL_MAX_FIELDS * RTE_DIM(bcx.tries) *
+			rc = rte_acl_gen(ctx, bcx->tries, bcx->bld_tries,
+				bcx->num_tries, bcx->cfg.num_categories,
+				RTE_ACL_MAX_FIELDS * RTE_DIM(bcx->tries) *
 				sizeof(ctx->data_indexes[0]), max_size);
 			if (rc == 0) {
 				/* set data indexes. */
@@ -1657,11 +2099,47 @@ rte_acl_build(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg)
 			}
 		}
 
-		acl_build_log(&bcx);
+		acl_build_log(bcx);
+
+		/* keep the build state for the next incremental build. */
+		if (rc == 0 && (prm->flags & RTE_ACL_BUILD_F_INCREMENTAL) != 0) {
+			bcx->num_built = ctx->num_rules;
+			ctx->bld = bcx;
+			return 0;
+		}
 
 		/* cleanup after build. */
-		tb_free_pool(&bcx.pool);
+		acl_build_free_ctx(bcx);
 	}
 
+	free(bcx);
 	return rc;
 }
+
+int
+rte_acl_build(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg)
+{
+	static const struct rte_acl_build_param prm;
+
+	return acl_build(ctx, cfg, &prm);
+}
+
+int
+rte_acl_build_ext(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg,
+	const struct rte_acl_build_param *prm)
+{
+	uint32_t i;
+
+	if (prm == NULL || (prm->num_lcores != 0 && prm->lcores == NULL) ||
+			(prm->flags & ~RTE_ACL_BUILD_F_INCREMENTAL) != 0)
+		return -EINVAL;
+
+	for (i = 0; i != prm->num_lcores; i++) {
+		if (prm->lcores[i] >= RTE_MAX_LCORE ||
+				!rte_lcore_is_enabled(prm->lcores[i]) ||
+				prm->lcores[i] == rte_get_main_lcore())
+			return -EINVAL;
+	}
+
+	return acl_build(ctx, cfg, prm);
+}
@@ -358,6 +358,7 @@ rte_acl_free(struct rte_acl_ctx *ctx)
 
 	rte_mcfg_tailq_write_unlock();
 
+	acl_build_free_state(ctx);
 	rte_free(ctx->mem);
 	rte_free(ctx);
 	rte_free(te);
@@ -491,8 +492,10 @@ rte_acl_add_rules(struct rte_acl_ctx *ctx, const struct rte_acl_rule *rules,
 void
 rte_acl_reset_rules(struct rte_acl_ctx *ctx)
 {
-	if (ctx != NULL)
+	if (ctx != NULL) {
+		acl_build_free_state(ctx);
 		ctx->num_rules = 0;
+	}
 }
 
 /*
@@ -524,6 +527,7 @@ rte_acl_dump(const struct rte_acl_ctx *ctx)
 	printf("  num_rules=%"PRIu32"\n", ctx->num_rules);
 	printf("  num_categories=%"PRIu32"\n", ctx->num_categories);
 	printf("  num_tries=%"PRIu32"\n", ctx->num_tries);
+	printf("  mem_sz=%zu\n", ctx->mem_sz);
 }
 
 /*
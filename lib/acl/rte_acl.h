@@ -11,6 +11,7 @@
  * RTE Classifier.
  */
 
+#include <rte_compat.h>
 #include <rte_acl_osdep.h>
 
 #ifdef __cplusplus
@@ -34,7 +35,13 @@ union rte_acl_field_types {
 enum {
 	RTE_ACL_FIELD_TYPE_MASK = 0,
 	RTE_ACL_FIELD_TYPE_RANGE,
-	RTE_ACL_FIELD_TYPE_BITMASK
+	RTE_ACL_FIELD_TYPE_BITMASK,
+	RTE_ACL_FIELD_TYPE_MASK128,
+	/**<
+	 * @warning
+	 * @b EXPERIMENTAL: 128-bit prefix, such as an IPv6 address.
+	 * Its value spans two consecutive fields of the rule.
+	 */
 };
 
 /**
@@ -47,10 +54,13 @@ enum {
  * into sets of 4 consecutive bytes. The loop processes the first input byte as
  * part of the setup and then subsequent bytes must be in groups of 4
  * consecutive bytes.
+ * A RTE_ACL_FIELD_TYPE_MASK128 field is read as four groups of 4 bytes,
+ * and needs an input index of its own.
  */
 struct rte_acl_field_def {
 	uint8_t  type;        /**< type - RTE_ACL_FIELD_TYPE_*. */
-	uint8_t	 size;        /**< size of field 1,2,4, or 8. */
+	uint8_t	 size;
+	/**< size of field 1,2,4, or 8, 16 for RTE_ACL_FIELD_TYPE_MASK128. */
 	uint8_t	 field_index; /**< index of field inside the rule. */
 	uint8_t  input_index; /**< 0-N input index. */
 	uint32_t offset;      /**< offset to start of field. */
@@ -80,7 +90,9 @@ struct rte_acl_field {
 	 * depending on field type:
 	 * mask -> 1.2.3.4/32 value=0x1020304, mask_range=32,
 	 * range -> 0 : 65535 value=0, mask_range=65535,
-	 * bitmask -> 0x06/0xff value=6, mask_range=0xff.
+	 * bitmask -> 0x06/0xff value=6, mask_range=0xff,
+	 * mask128 -> 2001:db8::/32 value=0x20010db800000000, mask_range=32,
+	 *            followed by a field with the low 64 bits value=0.
 	 */
 };
 
@@ -220,6 +232,63 @@ rte_acl_reset_rules(struct rte_acl_ctx *ctx);
 int
 rte_acl_build(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg);
 
+/**
+ * Build only the rules added since the previous build of the ACL context,
+ * into new tries, keeping the tries of the previous rules.
+ */
+#define RTE_ACL_BUILD_F_INCREMENTAL	0x1
+
+/**
+ * Optional parameters of the ACL build.
+ */
+struct rte_acl_build_param {
+	const unsigned int *lcores;
+	/**< Idle worker lcores to rebuild the tries on, NULL if none. */
+	uint32_t num_lcores; /**< Number of lcores in the array. */
+	uint32_t flags;      /**< RTE_ACL_BUILD_F_* flags. */
+};
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Analyze set of rules and build required internal run-time structures,
+ * as rte_acl_build() does, with optional build parameters.
+ * This function is not multi-thread safe.
+ *
+ * When worker lcores are given, the rule set is still split into tries
+ * on the calling lcore, but each trie is then rebuilt with its final
+ * rule subset on one of the worker lcores while the rest of the rule set
+ * is being split. The worker lcores have to be in WAIT state, and the
+ * function has to be called from the main lcore to use them; otherwise
+ * all the tries are built by the calling thread.
+ *
+ * With RTE_ACL_BUILD_F_INCREMENTAL, the build state is kept in the ACL
+ * context, so that the next incremental build with the same config only
+ * builds the rules added since then, into additional tries.
+ * The whole rule set is rebuilt if the config changed, if the rules
+ * were reset, or if there is no room left for more tries.
+ * The build state is released by the next non-incremental build,
+ * rte_acl_reset_rules(), rte_acl_reset() and rte_acl_free().
+ *
+ * @param ctx
+ *   ACL context to build.
+ * @param cfg
+ *   Pointer to struct rte_acl_config - defines build parameters.
+ * @param prm
+ *   Pointer to struct rte_acl_build_param - defines the worker lcores
+ *   and the build flags.
+ * @return
+ *   - -ENOMEM if couldn't allocate enough memory.
+ *   - -EINVAL if the parameters are invalid.
+ *   - Negative error code if operation failed.
+ *   - Zero if operation completed successfully.
+ */
+__rte_experimental
+int
+rte_acl_build_ext(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg,
+	const struct rte_acl_build_param *prm);
+
 /**
  * Delete all rules from the ACL context and
  * destroy all internal run-time structures.
@@ -154,6 +154,13 @@ struct rte_distributor {
 
 	uint8_t active[RTE_DISTRIB_MAX_WORKERS];
 	uint8_t activesum;
+
+	/* Idle flows go to the least loaded worker, see process() */
+	uint8_t rebalance;
+	/* Packets released to each worker and not taken yet */
+	uint8_t pending[RTE_DISTRIB_MAX_WORKERS];
+
+	struct rte_distributor_worker_stats stats[RTE_DISTRIB_MAX_WORKERS];
 };
 
 void
@@ -320,6 +320,7 @@ handle_worker_shutdown(struct rte_distributor *d, unsigned int wkr)
 			(d->backlog[wkr].pkts[i] >> RTE_DISTRIB_FLAG_BITS));
 
 	d->backlog[wkr].count = 0;
+	d->pending[wkr] = 0;
 
 	/* Clear both inflight and backlog tags */
 	for (i = 0; i < RTE_DIST_BURST_SIZE; i++) {
@@ -404,6 +405,10 @@ release(struct rte_distributor *d, unsigned int wkr)
 	if (unlikely(!d->active[wkr]))
 		return 0;
 
+	if (!(__atomic_load_n(&(buf->bufptr64[0]), __ATOMIC_ACQUIRE)
+		& RTE_DISTRIB_GET_BUF))
+		d->stats[wkr].stalls++;
+
 	/* Sync with worker on GET_BUF flag */
 	while (!(__atomic_load_n(&(d->bufs[wkr].bufptr64[0]), __ATOMIC_ACQUIRE)
 		& RTE_DISTRIB_GET_BUF)) {
@@ -421,6 +426,8 @@ release(struct rte_distributor *d, unsigned int wkr)
 		d->in_flight_tags[wkr][i] = d->backlog[wkr].tags[i];
 	}
 	buf->count = i;
+	d->pending[wkr] = i;
+	d->stats[wkr].pkts += i;
 	for ( ; i < RTE_DIST_BURST_SIZE ; i++) {
 		buf->bufptr64[i] = RTE_DISTRIB_GET_BUF;
 		d->in_flight_tags[wkr][i] = 0;
@@ -438,6 +445,63 @@ release(struct rte_distributor *d, unsigned int wkr)
 }
 
 
+/*
+ * Tag of the flow of a packet, which has to be non-zero. With rebalancing,
+ * the tag is taken from the RSS hash, folded to keep its upper bits.
+ */
+static inline uint16_t
+flow_tag(const struct rte_distributor *d, const struct rte_mbuf *mb)
+{
+	if (d->rebalance)
+		return (uint16_t)(mb->hash.rss ^ (mb->hash.rss >> 16)) | 1;
+	return (uint16_t)(mb->hash.usr) | 1;
+}
+
+/*
+ * Refresh the number of packets released to each worker and not taken by
+ * it yet, i.e. whose buffer has not been flagged with GET_BUF again.
+ */
+static void
+update_pending(struct rte_distributor *d)
+{
+	unsigned int wid;
+
+	for (wid = 0; wid < d->num_workers; wid++)
+		d->pending[wid] = (__atomic_load_n(&(d->bufs[wid].bufptr64[0]),
+			__ATOMIC_RELAXED) & RTE_DISTRIB_GET_BUF) ?
+			0 : d->bufs[wid].count;
+}
+
+/*
+ * Pick the worker for an idle flow when rebalancing. The current worker
+ * is kept while it takes its packets and its backlog is not full, so that
+ * full bursts are sent. Otherwise the active worker with the fewest packets
+ * queued is picked, looking from the next worker on.
+ */
+static unsigned int
+find_worker_rebalance(struct rte_distributor *d, unsigned int wkr)
+{
+	unsigned int i, w, load, best = wkr, best_load = UINT32_MAX;
+
+	if (d->active[wkr] && d->pending[wkr] == 0 &&
+			d->backlog[wkr].count < RTE_DIST_BURST_SIZE)
+		return wkr;
+
+	for (i = 1; i <= d->num_workers; i++) {
+		w = (wkr + i) % d->num_workers;
+		if (!d->active[w])
+			continue;
+		load = d->pending[w] + d->backlog[w].count;
+		if (load < best_load) {
+			best = w;
+			best_load = load;
+			if (load == 0)
+				break;
+		}
+	}
+	return best;
+}
+
 /* process a set of packets to distribute them to workers */
 int
 rte_distributor_process(struct rte_distributor *d,
@@ -488,14 +552,16 @@ rte_distributor_process(struct rte_distributor *d,
 
 		for (i = 0; i < pkts; i++) {
 			if (mbufs[next_idx + i]) {
-				/* flows have to be non-zero */
-				flows[i] = mbufs[next_idx + i]->hash.usr | 1;
+				flows[i] = flow_tag(d, mbufs[next_idx + i]);
 			} else
 				flows[i] = 0;
 		}
 		for (; i < RTE_DIST_BURST_SIZE; i++)
 			flows[i] = 0;
 
+		if (d->rebalance)
+			update_pending(d);
+
 		matching_required = 1;
 
 		for (j = 0; j < pkts; j++) {
@@ -529,8 +595,7 @@ rte_distributor_process(struct rte_distributor *d,
 			 * User defined tags are used to identify flows,
 			 * or sessions.
 			 */
-			/* flows MUST be non-zero */
-			new_tag = (uint16_t)(next_mb->hash.usr) | 1;
+			new_tag = flow_tag(d, next_mb);
 
 			/*
 			 * Uncommenting the next line will cause the find_match
@@ -558,10 +623,14 @@ rte_distributor_process(struct rte_distributor *d,
 
 				bl->tags[idx] = new_tag;
 				bl->pkts[idx] = next_value;
+				d->stats[matches[j]-1].pinned++;
 
 			} else {
 				struct rte_distributor_backlog *bl;
 
+				if (d->rebalance)
+					wkr = find_worker_rebalance(d,
+						wkr % d->num_workers);
 				while (unlikely(!d->active[wkr]))
 					wkr = (wkr + 1) % d->num_workers;
 				bl = &d->backlog[wkr];
@@ -582,6 +651,7 @@ rte_distributor_process(struct rte_distributor *d,
 
 				bl->tags[idx] = new_tag;
 				bl->pkts[idx] = next_value;
+				d->stats[wkr].unpinned++;
 				/*
 				 * Now that we've just added an unpinned flow
 				 * to a worker, we need to ensure that all
@@ -593,7 +663,8 @@ rte_distributor_process(struct rte_distributor *d,
 						matches[w] = wkr+1;
 			}
 		}
-		wkr = (wkr + 1) % d->num_workers;
+		if (!d->rebalance)
+			wkr = (wkr + 1) % d->num_workers;
 	}
 
 	/* Flush out all non-full cache-lines to workers. */
@@ -777,6 +848,10 @@ rte_distributor_create(const char *name,
 	memset(d->active, 0, sizeof(d->active));
 	d->activesum = 0;
 
+	d->rebalance = 0;
+	memset(d->pending, 0, sizeof(d->pending));
+	memset(d->stats, 0, sizeof(d->stats));
+
 	dist_burst_list = RTE_TAILQ_CAST(rte_dist_burst_tailq.head,
 					  rte_dist_burst_list);
 
@@ -787,3 +862,47 @@ rte_distributor_create(const char *name,
 
 	return d;
 }
+
+int
+rte_distributor_rebalance_set(struct rte_distributor *d, int enable)
+{
+	if (d == NULL)
+		return -EINVAL;
+	if (d->alg_type == RTE_DIST_ALG_SINGLE)
+		return -ENOTSUP;
+
+	d->rebalance = !!enable;
+	return 0;
+}
+
+int
+rte_distributor_worker_stats_get(struct rte_distributor *d,
+		unsigned int worker_id, struct rte_distributor_worker_stats *stats)
+{
+	if (d == NULL || stats == NULL)
+		return -EINVAL;
+	if (d->alg_type == RTE_DIST_ALG_SINGLE)
+		return -ENOTSUP;
+	if (worker_id >= d->num_workers)
+		return -EINVAL;
+
+	*stats = d->stats[worker_id];
+	stats->backlog = d->backlog[worker_id].count;
+	/* Sync with worker on GET_BUF flag. */
+	if (!(__atomic_load_n(&(d->bufs[worker_id].bufptr64[0]),
+			__ATOMIC_ACQUIRE) & RTE_DISTRIB_GET_BUF))
+		stats->backlog += d->bufs[worker_id].count;
+	return 0;
+}
+
+int
+rte_distributor_worker_stats_reset(struct rte_distributor *d)
+{
+	if (d == NULL)
+		return -EINVAL;
+	if (d->alg_type == RTE_DIST_ALG_SINGLE)
+		return -ENOTSUP;
+
+	memset(d->stats, 0, sizeof(d->stats));
+	return 0;
+}
@@ -17,6 +17,10 @@
 extern "C" {
 #endif
 
+#include <stdint.h>
+
+#include <rte_compat.h>
+
 /* Type of distribution (burst/single) */
 enum rte_distributor_alg_type {
 	RTE_DIST_ALG_BURST = 0,
@@ -27,6 +31,20 @@ enum rte_distributor_alg_type {
 struct rte_distributor;
 struct rte_mbuf;
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this structure may change without prior notice.
+ *
+ * Per-worker statistics of a burst distributor.
+ */
+struct rte_distributor_worker_stats {
+	uint64_t pkts;      /**< Packets handed to the worker. */
+	uint64_t pinned;    /**< Packets sent to it as their flow was there. */
+	uint64_t unpinned;  /**< Packets of idle flows assigned to it. */
+	uint64_t stalls;    /**< Waits for it to take its previous burst. */
+	uint32_t backlog;   /**< Packets queued for it and not taken yet. */
+};
+
 /**
  * Function to create a new distributor instance
  *
@@ -235,6 +253,85 @@ int
 rte_distributor_poll_pkt(struct rte_distributor *d,
 		unsigned int worker_id, struct rte_mbuf **mbufs);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Enable or disable rebalancing of idle flows in a burst distributor.
+ *
+ * By default, a flow which is not in flight or queued on a worker goes to
+ * the next worker in round-robin order, whether that worker keeps up or not.
+ * With rebalancing, such a flow goes to the least loaded worker instead,
+ * i.e. the one with the fewest packets queued for it and not taken yet, so
+ * a worker that falls behind stops receiving new flows until it catches up.
+ * Flow affinity is kept while a flow is in flight only.
+ *
+ * The flow of a packet is then taken from the RSS hash of the mbuf, folded
+ * to the 15 bits of the distributor tags, so that the application does not
+ * need to set the tag of packets received with a RSS hash.
+ *
+ * This is not multi-thread safe and should only be called on the
+ * distributor lcore, before any packet is processed or after a flush.
+ *
+ * @param d
+ *   The distributor instance to be used
+ * @param enable
+ *   Non-zero to enable rebalancing, zero to disable it
+ * @return
+ *   0 on success,
+ *   -EINVAL if d is NULL,
+ *   -ENOTSUP if the distributor is not a burst one (RTE_DIST_ALG_SINGLE)
+ */
+__rte_experimental
+int
+rte_distributor_rebalance_set(struct rte_distributor *d, int enable);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Retrieve the statistics of a worker of a burst distributor.
+ *
+ * This is not multi-thread safe and should only be called on the
+ * distributor lcore.
+ *
+ * @param d
+ *   The distributor instance to be used
+ * @param worker_id
+ *   The worker instance number, less than num_workers passed at
+ *   distributor creation time
+ * @param stats
+ *   The structure filled with the statistics of the worker
+ * @return
+ *   0 on success,
+ *   -EINVAL if a parameter is invalid,
+ *   -ENOTSUP if the distributor is not a burst one (RTE_DIST_ALG_SINGLE)
+ */
+__rte_experimental
+int
+rte_distributor_worker_stats_get(struct rte_distributor *d,
+		unsigned int worker_id, struct rte_distributor_worker_stats *stats);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Reset the statistics of all workers of a burst distributor.
+ *
+ * This is not multi-thread safe and should only be called on the
+ * distributor lcore.
+ *
+ * @param d
+ *   The distributor instance to be used
+ * @return
+ *   0 on success,
+ *   -EINVAL if d is NULL,
+ *   -ENOTSUP if the distributor is not a burst one (RTE_DIST_ALG_SINGLE)
+ */
+__rte_experimental
+int
+rte_distributor_worker_stats_reset(struct rte_distributor *d);
+
 #ifdef __cplusplus
 }
 #endif
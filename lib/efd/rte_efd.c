@@ -24,6 +24,7 @@
 #include <rte_vect.h>
 
 #include "rte_efd.h"
+#include "efd_private.h"
 #if defined(RTE_ARCH_X86)
 #include "rte_efd_x86.h"
 #elif defined(RTE_ARCH_ARM64)
@@ -31,25 +32,6 @@
 #endif
 
 #define EFD_KEY(key_idx, table) (table->keys + ((key_idx) * table->key_len))
-/** Hash function used to determine chunk_id and bin_id for a group */
-#define EFD_HASH(key, table) \
-	(uint32_t)(rte_jhash(key, table->key_len, 0xbc9f1d34))
-/** Hash function used as constant component of perfect hash search */
-#define EFD_HASHFUNCA(key, table) \
-	(uint32_t)(rte_hash_crc(key, table->key_len, 0xbc9f1d35))
-/** Hash function used as multiplicative component of perfect hash search */
-#define EFD_HASHFUNCB(key, table) \
-	(uint32_t)(rte_hash_crc(key, table->key_len, 0xbc9f1d36))
-
-/*************************************************************************
- * Fixed constants
- *************************************************************************/
-
-/* These parameters are fixed by the efd_bin_to_group balancing table */
-#define EFD_CHUNK_NUM_GROUPS (64)
-#define EFD_CHUNK_NUM_BINS   (256)
-#define EFD_CHUNK_NUM_BIN_TO_GROUP_SETS \
-	(EFD_CHUNK_NUM_BINS / EFD_CHUNK_NUM_GROUPS)
 
 /*
  * Target number of rules that each chunk is created to handle.
@@ -74,14 +56,6 @@ allocated memory
  */
 #define EFD_NUM_CHUNK_PADDING_BYTES (256)
 
-/* All different internal lookup functions */
-enum efd_lookup_internal_function {
-	EFD_LOOKUP_SCALAR = 0,
-	EFD_LOOKUP_AVX2,
-	EFD_LOOKUP_NEON,
-	EFD_LOOKUP_NUM
-};
-
 TAILQ_HEAD(rte_efd_list, rte_tailq_entry);
 
 static struct rte_tailq_elem rte_efd_tailq = {
@@ -200,67 +174,6 @@ struct efd_offline_chunk_rules {
 	/**< Array of all groups in the chunk. */
 };
 
-/*************************************************************************
- * Online region structures
- *************************************************************************/
-
-/** Online group containing values for EFD_MAX_GROUP_NUM_RULES rules. */
-struct efd_online_group_entry {
-	efd_hashfunc_t hash_idx[RTE_EFD_VALUE_NUM_BITS];
-	efd_lookuptbl_t lookup_table[RTE_EFD_VALUE_NUM_BITS];
-} __rte_packed;
-
-/**
- * A single chunk record, containing EFD_TARGET_CHUNK_NUM_RULES rules.
- * Those rules are split into EFD_CHUNK_NUM_GROUPS groups per chunk.
- */
-struct efd_online_chunk {
-	uint8_t bin_choice_list[(EFD_CHUNK_NUM_BINS * 2 + 7) / 8];
-	/**< This is a packed indirection index into the 'groups' array.
-	 * Each byte contains four two-bit values which index into
-	 * the efd_bin_to_group array.
-	 * The efd_bin_to_group array returns the index into the groups array
-	 */
-
-	struct efd_online_group_entry groups[EFD_CHUNK_NUM_GROUPS];
-	/**< Array of all the groups in the chunk. */
-} __rte_packed;
-
-/**
- * EFD table structure
- */
-struct rte_efd_table {
-	char name[RTE_EFD_NAMESIZE]; /**< Name of the efd table. */
-
-	uint32_t key_len; /**< Length of the key stored offline */
-
-	uint32_t max_num_rules;
-	/**< Static maximum number of entries the table was constructed to hold. */
-
-	uint32_t num_rules;
-	/**< Number of entries currently in the table . */
-
-	uint32_t num_chunks;
-	/**< Number of chunks in the table needed to support num_rules. */
-
-	uint32_t num_chunks_shift;
-	/**< Bits to shift to get chunk id, instead of dividing by num_chunk. */
-
-	enum efd_lookup_internal_function lookup_fn;
-	/**< Indicates which lookup function to use. */
-
-	struct efd_online_chunk *chunks[RTE_MAX_NUMA_NODES];
-	/**< Dynamic array of size num_chunks of chunk records. */
-
-	struct efd_offline_chunk_rules *offline_chunks;
-	/**< Dynamic array of size num_chunks of key-value pairs. */
-
-	struct rte_ring *free_slots;
-	/**< Ring that stores all indexes of the free slots in the key table */
-
-	uint8_t *keys; /**< Dynamic array of size max_num_rules of keys */
-};
-
 /**
  * Computes the chunk ID for a given key hash
  *
@@ -493,6 +406,71 @@ efd_search_hash(struct rte_efd_table * const table,
 	return 0;
 }
 
+/*
+ * Check that a lookup function is built in, supported by the CPU and
+ * allowed by the max SIMD bitwidth.
+ */
+static int
+efd_lookup_fn_check(enum efd_lookup_internal_function lookup_fn)
+{
+	switch (lookup_fn) {
+	case EFD_LOOKUP_SCALAR:
+		return 0;
+#if defined(RTE_ARCH_X86)
+	case EFD_LOOKUP_AVX2:
+		if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX2) &&
+				rte_vect_get_max_simd_bitwidth() >=
+				RTE_VECT_SIMD_256)
+			return 0;
+		break;
+#endif
+#if defined(CC_EFD_AVX512_SUPPORT)
+	case EFD_LOOKUP_AVX512:
+		if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512F) &&
+				rte_vect_get_max_simd_bitwidth() >=
+				RTE_VECT_SIMD_512)
+			return 0;
+		break;
+#endif
+#if defined(RTE_ARCH_ARM64)
+	case EFD_LOOKUP_NEON:
+		if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_NEON) &&
+				rte_vect_get_max_simd_bitwidth() >=
+				RTE_VECT_SIMD_128)
+			return 0;
+		break;
+#endif
+	default:
+		break;
+	}
+
+	return -ENOTSUP;
+}
+
+/* Select the fastest lookup function available */
+static enum efd_lookup_internal_function
+efd_default_lookup_fn(void)
+{
+	if (efd_lookup_fn_check(EFD_LOOKUP_AVX512) == 0)
+		return EFD_LOOKUP_AVX512;
+	/*
+	 * For less than 4 bits, scalar function performs better
+	 * than vectorised version
+	 */
+	if (RTE_EFD_VALUE_NUM_BITS > 3 &&
+			efd_lookup_fn_check(EFD_LOOKUP_AVX2) == 0)
+		return EFD_LOOKUP_AVX2;
+	/*
+	 * For less than or equal to 16 bits, scalar function performs better
+	 * than vectorised version
+	 */
+	if (RTE_EFD_VALUE_NUM_BITS > 16 &&
+			efd_lookup_fn_check(EFD_LOOKUP_NEON) == 0)
+		return EFD_LOOKUP_NEON;
+
+	return EFD_LOOKUP_SCALAR;
+}
+
 struct rte_efd_table *
 rte_efd_create(const char *name, uint32_t max_num_rules, uint32_t key_len,
 		uint64_t online_cpu_socket_bitmask, uint8_t offline_cpu_socket)
@@ -641,29 +619,7 @@ rte_efd_create(const char *name, uint32_t max_num_rules, uint32_t key_len,
 		}
 	}
 
-#if defined(RTE_ARCH_X86)
-	/*
-	 * For less than 4 bits, scalar function performs better
-	 * than vectorised version
-	 */
-	if (RTE_EFD_VALUE_NUM_BITS > 3
-			&& rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX2)
-			&& rte_vect_get_max_simd_bitwidth() >= RTE_VECT_SIMD_256)
-		table->lookup_fn = EFD_LOOKUP_AVX2;
-	else
-#endif
-#if defined(RTE_ARCH_ARM64)
-	/*
-	 * For less than or equal to 16 bits, scalar function performs better
-	 * than vectorised version
-	 */
-	if (RTE_EFD_VALUE_NUM_BITS > 16 &&
-	    rte_cpu_get_flag_enabled(RTE_CPUFLAG_NEON) &&
-			rte_vect_get_max_simd_bitwidth() >= RTE_VECT_SIMD_128)
-		table->lookup_fn = EFD_LOOKUP_NEON;
-	else
-#endif
-		table->lookup_fn = EFD_LOOKUP_SCALAR;
+	table->lookup_fn = efd_default_lookup_fn();
 
 	/*
 	 * Allocate the EFD table offline portion (with the actual rules
@@ -1271,6 +1227,9 @@ efd_lookup_internal(const struct efd_online_group_entry * const group,
 	switch (lookup_fn) {
 
 #if defined(RTE_ARCH_X86) && defined(CC_SUPPORT_AVX2)
+	/* AVX512 only has a bulk path, CPUs with it also have AVX2 */
+	case EFD_LOOKUP_AVX512:
+	/* Fall-through */
 	case EFD_LOOKUP_AVX2:
 		return efd_lookup_internal_avx2(group->hash_idx,
 					group->lookup_table,
@@ -1331,14 +1290,24 @@ void rte_efd_lookup_bulk(const struct rte_efd_table * const table,
 	struct efd_online_group_entry *group;
 
 	struct efd_online_chunk *chunks = table->chunks[socket_id];
+	int first = 0;
+
+#if defined(CC_EFD_AVX512_SUPPORT)
+	if (table->lookup_fn == EFD_LOOKUP_AVX512) {
+		for (; first + EFD_LOOKUP_AVX512_KEYS <= num_keys;
+				first += EFD_LOOKUP_AVX512_KEYS)
+			efd_lookup_bulk_avx512(table, socket_id,
+					&key_list[first], &value_list[first]);
+	}
+#endif
 
-	for (i = 0; i < num_keys; i++) {
+	for (i = first; i < num_keys; i++) {
 		efd_compute_ids(table, key_list[i], &chunk_id_list[i],
 				&bin_id_list[i]);
 		rte_prefetch0(&chunks[chunk_id_list[i]].bin_choice_list);
 	}
 
-	for (i = 0; i < num_keys; i++) {
+	for (i = first; i < num_keys; i++) {
 		bin_choice_list[i] = efd_get_choice(table, socket_id,
 				chunk_id_list[i], bin_id_list[i]);
 		group_id_list[i] =
@@ -1347,7 +1316,7 @@ void rte_efd_lookup_bulk(const struct rte_efd_table * const table,
 		rte_prefetch0(group);
 	}
 
-	for (i = 0; i < num_keys; i++) {
+	for (i = first; i < num_keys; i++) {
 		group = &chunks[chunk_id_list[i]].groups[group_id_list[i]];
 		value_list[i] = efd_lookup_internal(group,
 				EFD_HASHFUNCA(key_list[i], table),
@@ -1355,3 +1324,41 @@ void rte_efd_lookup_bulk(const struct rte_efd_table * const table,
 				table->lookup_fn);
 	}
 }
+
+int
+rte_efd_set_lookup_alg(struct rte_efd_table *table,
+		enum rte_efd_lookup_alg alg)
+{
+	enum efd_lookup_internal_function lookup_fn;
+	int ret;
+
+	if (table == NULL)
+		return -EINVAL;
+
+	switch (alg) {
+	case RTE_EFD_LOOKUP_DEFAULT:
+		table->lookup_fn = efd_default_lookup_fn();
+		return 0;
+	case RTE_EFD_LOOKUP_SCALAR:
+		lookup_fn = EFD_LOOKUP_SCALAR;
+		break;
+	case RTE_EFD_LOOKUP_AVX2:
+		lookup_fn = EFD_LOOKUP_AVX2;
+		break;
+	case RTE_EFD_LOOKUP_NEON:
+		lookup_fn = EFD_LOOKUP_NEON;
+		break;
+	case RTE_EFD_LOOKUP_AVX512:
+		lookup_fn = EFD_LOOKUP_AVX512;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	ret = efd_lookup_fn_check(lookup_fn);
+	if (ret != 0)
+		return ret;
+
+	table->lookup_fn = lookup_fn;
+	return 0;
+}
@@ -13,6 +13,8 @@
 
 #include <stdint.h>
 
+#include <rte_compat.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -116,6 +118,22 @@ typedef uint32_t efd_value_t;
 typedef uint16_t efd_lookuptbl_t;
 typedef uint16_t efd_hashfunc_t;
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this enumeration may change without prior notice.
+ *
+ * Lookup algorithms, see rte_efd_set_lookup_alg().
+ */
+enum rte_efd_lookup_alg {
+	RTE_EFD_LOOKUP_DEFAULT = 0,
+	/**< Fastest algorithm available on the running CPU */
+	RTE_EFD_LOOKUP_SCALAR,  /**< Generic implementation */
+	RTE_EFD_LOOKUP_AVX2,    /**< Values resolved with AVX2 */
+	RTE_EFD_LOOKUP_NEON,    /**< Values resolved with NEON */
+	RTE_EFD_LOOKUP_AVX512,
+	/**< Bulk lookups hash and resolve 16 keys at a time with AVX512 */
+};
+
 /**
  * Creates an EFD table with a single offline region and multiple per-socket
  * internally-managed copies of the online table used for lookups
@@ -272,6 +290,31 @@ rte_efd_lookup_bulk(const struct rte_efd_table *table, unsigned int socket_id,
 		int num_keys, const void **key_list,
 		efd_value_t *value_list);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Select the algorithm used by the lookups of an EFD table.
+ * The table is created with RTE_EFD_LOOKUP_DEFAULT, which picks the fastest
+ * algorithm the CPU and the max SIMD bitwidth allow.
+ * This operation is not multi-thread safe
+ * and should only be called while no lookup is in progress.
+ *
+ * @param table
+ *   EFD table to reference
+ * @param alg
+ *   Lookup algorithm to use
+ * @return
+ *   - 0 on success
+ *   - -EINVAL if the parameters are invalid
+ *   - -ENOTSUP if the algorithm is not supported by this build, the CPU
+ *     or the max SIMD bitwidth
+ */
+__rte_experimental
+int
+rte_efd_set_lookup_alg(struct rte_efd_table *table,
+		enum rte_efd_lookup_alg alg);
+
 #ifdef __cplusplus
 }
 #endif
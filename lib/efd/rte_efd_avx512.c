@@ -0,0 +1,236 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 Intel Corporation
+ */
+
+#include <stddef.h>
+
+#include <rte_vect.h>
+
+#include "efd_private.h"
+
+/*
+ * Bulk lookup of EFD_LOOKUP_AVX512_KEYS keys, one key per 32-bit lane.
+ *
+ * The chunk/bin hash (jhash) is computed for all the keys at once, their
+ * 32-bit words being gathered from the key pointers. The chunk, bin choice
+ * and group of every key are then gathered from the online table, and the
+ * perfect hash of each value bit is resolved for all the keys together,
+ * two bits per gather of the group hash indexes and lookup tables.
+ * The CRC32C hashes of the perfect hash search have no lane-parallel form,
+ * they are computed with the crc32 instructions for the 16 keys in a row.
+ */
+
+/* a -= c; a ^= rot(c, k); c += b; as in __rte_jhash_mix */
+#define EFD_JHASH_MIX_STEP(x, y, z, k) do { \
+	x = _mm512_sub_epi32(x, y); \
+	x = _mm512_xor_si512(x, _mm512_rol_epi32(y, k)); \
+	y = _mm512_add_epi32(y, z); \
+} while (0)
+
+#define EFD_JHASH_MIX(a, b, c) do { \
+	EFD_JHASH_MIX_STEP(a, c, b, 4); \
+	EFD_JHASH_MIX_STEP(b, a, c, 6); \
+	EFD_JHASH_MIX_STEP(c, b, a, 8); \
+	EFD_JHASH_MIX_STEP(a, c, b, 16); \
+	EFD_JHASH_MIX_STEP(b, a, c, 19); \
+	EFD_JHASH_MIX_STEP(c, b, a, 4); \
+} while (0)
+
+/* c ^= b; c -= rot(b, k); as in __rte_jhash_final */
+#define EFD_JHASH_FINAL_STEP(x, y, k) do { \
+	x = _mm512_xor_si512(x, y); \
+	x = _mm512_sub_epi32(x, _mm512_rol_epi32(y, k)); \
+} while (0)
+
+#define EFD_JHASH_FINAL(a, b, c) do { \
+	EFD_JHASH_FINAL_STEP(c, b, 14); \
+	EFD_JHASH_FINAL_STEP(a, c, 11); \
+	EFD_JHASH_FINAL_STEP(b, a, 25); \
+	EFD_JHASH_FINAL_STEP(c, b, 16); \
+	EFD_JHASH_FINAL_STEP(a, c, 4); \
+	EFD_JHASH_FINAL_STEP(b, a, 14); \
+	EFD_JHASH_FINAL_STEP(c, b, 24); \
+} while (0)
+
+/*
+ * Gather the 32-bit word at base + off for the 16 keys, the bases of keys
+ * 0-7 and 8-15 being 64-bit addresses in vbase_lo and vbase_hi.
+ */
+static __rte_always_inline __m512i
+efd_gather_x16(__m512i vbase_lo, __m512i vbase_hi, __m512i voff)
+{
+	__m256i lo, hi;
+
+	lo = _mm512_i64gather_epi32(_mm512_add_epi64(vbase_lo,
+			_mm512_cvtepu32_epi64(_mm512_castsi512_si256(voff))),
+			NULL, 1);
+	hi = _mm512_i64gather_epi32(_mm512_add_epi64(vbase_hi,
+			_mm512_cvtepu32_epi64(_mm512_extracti64x4_epi64(voff, 1))),
+			NULL, 1);
+
+	return _mm512_inserti64x4(_mm512_castsi256_si512(lo), hi, 1);
+}
+
+/* Same result as EFD_HASH() for each of the 16 keys */
+static __rte_always_inline __m512i
+efd_hash_x16(__m512i vkey_lo, __m512i vkey_hi, uint32_t length)
+{
+	__m512i a, b, c, w, vmask;
+	uint32_t off = 0;
+
+	a = b = c = _mm512_set1_epi32(RTE_JHASH_GOLDEN_RATIO + length +
+			EFD_HASH_SEED);
+	if (length == 0)
+		return c;
+
+	while (length > 12) {
+		a = _mm512_add_epi32(a, efd_gather_x16(vkey_lo, vkey_hi,
+				_mm512_set1_epi32(off)));
+		b = _mm512_add_epi32(b, efd_gather_x16(vkey_lo, vkey_hi,
+				_mm512_set1_epi32(off + 4)));
+		c = _mm512_add_epi32(c, efd_gather_x16(vkey_lo, vkey_hi,
+				_mm512_set1_epi32(off + 8)));
+		EFD_JHASH_MIX(a, b, c);
+		off += 12;
+		length -= 12;
+	}
+
+	/* Last 1 to 12 bytes, the bytes past the key masked out */
+	vmask = _mm512_set1_epi32((length & 3) ?
+			(1U << ((length & 3) * 8)) - 1 : UINT32_MAX);
+	w = efd_gather_x16(vkey_lo, vkey_hi, _mm512_set1_epi32(off));
+	if (length <= 4) {
+		a = _mm512_add_epi32(a, _mm512_and_si512(w, vmask));
+	} else {
+		a = _mm512_add_epi32(a, w);
+		w = efd_gather_x16(vkey_lo, vkey_hi,
+				_mm512_set1_epi32(off + 4));
+		if (length <= 8) {
+			b = _mm512_add_epi32(b, _mm512_and_si512(w, vmask));
+		} else {
+			b = _mm512_add_epi32(b, w);
+			w = efd_gather_x16(vkey_lo, vkey_hi,
+					_mm512_set1_epi32(off + 8));
+			c = _mm512_add_epi32(c, _mm512_and_si512(w, vmask));
+		}
+	}
+
+	EFD_JHASH_FINAL(a, b, c);
+	return c;
+}
+
+/* Set bit of the value of the keys whose lookup table has the bucket bit */
+static __rte_always_inline __m512i
+efd_resolve_bit_x16(__m512i vvalue, __m512i vhash_idx, __m512i vtable,
+		__m512i vhash_a, __m512i vhash_b, uint32_t table_bit,
+		uint32_t value_bit)
+{
+	__m512i vbucket;
+	__mmask16 m;
+
+	vbucket = _mm512_srli_epi32(_mm512_add_epi32(vhash_a,
+			_mm512_mullo_epi32(vhash_idx, vhash_b)),
+			EFD_LOOKUPTBL_SHIFT);
+	m = _mm512_test_epi32_mask(vtable, _mm512_sllv_epi32(
+			_mm512_set1_epi32(1 << table_bit), vbucket));
+
+	return _mm512_mask_or_epi32(vvalue, m, vvalue,
+			_mm512_set1_epi32((int)(UINT32_C(1) << value_bit)));
+}
+
+void
+efd_lookup_bulk_avx512(const struct rte_efd_table *table,
+		unsigned int socket_id, const void **key_list,
+		efd_value_t *value_list)
+{
+	const struct efd_online_chunk *chunks = table->chunks[socket_id];
+	uint32_t hash_val_a[EFD_LOOKUP_AVX512_KEYS];
+	uint32_t hash_val_b[EFD_LOOKUP_AVX512_KEYS];
+	__m512i vkey_lo, vkey_hi, vchunk_lo, vchunk_hi;
+	__m512i vh, vchunk, vbin, vchoice, vgroup, vhash_a, vhash_b;
+	__m512i vhash_idx, vtable, vvalue;
+	const __m512i vlo16 = _mm512_set1_epi32(UINT16_MAX);
+	unsigned int i;
+
+	vkey_lo = _mm512_loadu_si512(&key_list[0]);
+	vkey_hi = _mm512_loadu_si512(&key_list[8]);
+
+	/* Chunk and bin of each key, as in efd_compute_ids() */
+	vh = efd_hash_x16(vkey_lo, vkey_hi, table->key_len);
+	vchunk = _mm512_and_si512(vh, _mm512_set1_epi32(table->num_chunks - 1));
+	vbin = _mm512_and_si512(_mm512_srlv_epi32(vh,
+			_mm512_set1_epi32(table->num_chunks_shift)),
+			_mm512_set1_epi32(EFD_CHUNK_NUM_BINS - 1));
+
+	/* The online table may exceed 4GB, chunk addresses are 64-bit */
+	vchunk_lo = _mm512_add_epi64(_mm512_set1_epi64((uintptr_t)chunks),
+			_mm512_mul_epu32(_mm512_cvtepu32_epi64(
+				_mm512_castsi512_si256(vchunk)),
+			_mm512_set1_epi64(sizeof(struct efd_online_chunk))));
+	vchunk_hi = _mm512_add_epi64(_mm512_set1_epi64((uintptr_t)chunks),
+			_mm512_mul_epu32(_mm512_cvtepu32_epi64(
+				_mm512_extracti64x4_epi64(vchunk, 1)),
+			_mm512_set1_epi64(sizeof(struct efd_online_chunk))));
+
+	/*
+	 * Bin choice, as in efd_get_choice(): the 2-bit choice of a bin is
+	 * read from the aligned word of bin_choice_list holding its byte.
+	 */
+	vchoice = efd_gather_x16(vchunk_lo, vchunk_hi,
+			_mm512_slli_epi32(_mm512_srli_epi32(vbin, 4), 2));
+	vchoice = _mm512_and_si512(_mm512_srlv_epi32(vchoice,
+			_mm512_slli_epi32(_mm512_and_si512(vbin,
+				_mm512_set1_epi32(15)), 1)),
+			_mm512_set1_epi32(3));
+
+	/* Offset of the group of each key in its chunk */
+	vgroup = _mm512_i32gather_epi32(_mm512_add_epi32(
+			_mm512_slli_epi32(vchoice, 8), vbin),
+			efd_bin_to_group, sizeof(uint32_t));
+	vgroup = _mm512_add_epi32(_mm512_mullo_epi32(vgroup,
+			_mm512_set1_epi32(sizeof(struct efd_online_group_entry))),
+			_mm512_set1_epi32(offsetof(struct efd_online_chunk,
+				groups)));
+
+	for (i = 0; i < EFD_LOOKUP_AVX512_KEYS; i++) {
+		hash_val_a[i] = EFD_HASHFUNCA(key_list[i], table);
+		hash_val_b[i] = EFD_HASHFUNCB(key_list[i], table);
+	}
+	vhash_a = _mm512_loadu_si512(hash_val_a);
+	vhash_b = _mm512_loadu_si512(hash_val_b);
+
+	/*
+	 * Each gather returns the hash indexes or lookup tables of two
+	 * consecutive bits; for an odd number of bits the last one reads
+	 * past the group, into the next one or the chunk padding.
+	 */
+	vvalue = _mm512_setzero_si512();
+	for (i = 0; i < RTE_EFD_VALUE_NUM_BITS; i += 2) {
+		vhash_idx = efd_gather_x16(vchunk_lo, vchunk_hi,
+				_mm512_add_epi32(vgroup, _mm512_set1_epi32(
+				offsetof(struct efd_online_group_entry,
+					hash_idx) + i * sizeof(efd_hashfunc_t))));
+		vtable = efd_gather_x16(vchunk_lo, vchunk_hi,
+				_mm512_add_epi32(vgroup, _mm512_set1_epi32(
+				offsetof(struct efd_online_group_entry,
+					lookup_table) +
+				i * sizeof(efd_lookuptbl_t))));
+
+		vvalue = efd_resolve_bit_x16(vvalue,
+				_mm512_and_si512(vhash_idx, vlo16), vtable,
+				vhash_a, vhash_b, 0, i);
+		if (i + 1 < RTE_EFD_VALUE_NUM_BITS)
+			vvalue = efd_resolve_bit_x16(vvalue,
+					_mm512_srli_epi32(vhash_idx, 16), vtable,
+					vhash_a, vhash_b, 16, i + 1);
+	}
+
+#if (RTE_EFD_VALUE_NUM_BITS <= 8)
+	_mm_storeu_si128((__m128i *)value_list, _mm512_cvtepi32_epi8(vvalue));
+#elif (RTE_EFD_VALUE_NUM_BITS <= 16)
+	_mm256_storeu_si256((__m256i *)value_list,
+			_mm512_cvtepi32_epi16(vvalue));
+#else
+	_mm512_storeu_si512(value_list, vvalue);
+#endif
+}
@@ -155,9 +155,11 @@ tbl8_get_idx(struct dir24_8_tbl *dp)
 	uint32_t i;
 	int bit_idx;
 
-	for (i = 0; (i < (dp->number_tbl8s >> BITMAP_SLAB_BIT_SIZE_LOG2)) &&
+	for (i = dp->tbl8_slab;
+			(i < (dp->number_tbl8s >> BITMAP_SLAB_BIT_SIZE_LOG2)) &&
 			(dp->tbl8_idxes[i] == UINT64_MAX); i++)
 		;
+	dp->tbl8_slab = i;
 	if (i < (dp->number_tbl8s >> BITMAP_SLAB_BIT_SIZE_LOG2)) {
 		bit_idx = __builtin_ctzll(~dp->tbl8_idxes[i]);
 		dp->tbl8_idxes[i] |= (1ULL << bit_idx);
@@ -171,6 +173,8 @@ tbl8_free_idx(struct dir24_8_tbl *dp, int idx)
 {
 	dp->tbl8_idxes[idx >> BITMAP_SLAB_BIT_SIZE_LOG2] &=
 		~(1ULL << (idx & BITMAP_SLAB_BITMASK));
+	dp->tbl8_slab = RTE_MIN(dp->tbl8_slab,
+		(uint32_t)idx >> BITMAP_SLAB_BIT_SIZE_LOG2);
 }
 
 static int
@@ -180,6 +184,11 @@ tbl8_alloc(struct dir24_8_tbl *dp, uint64_t nh)
 	uint8_t	*tbl8_ptr;
 
 	tbl8_idx = tbl8_get_idx(dp);
+	if ((tbl8_idx == -ENOSPC) && (dp->dq != NULL)) {
+		/* If there are no tbl8 groups try to reclaim one. */
+		if (rte_rcu_qsbr_dq_reclaim(dp->dq, 1, NULL, NULL, NULL) == 0)
+			tbl8_idx = tbl8_get_idx(dp);
+	}
 	if (tbl8_idx < 0)
 		return tbl8_idx;
 	tbl8_ptr = (uint8_t *)dp->tbl8 +
@@ -189,10 +198,57 @@ tbl8_alloc(struct dir24_8_tbl *dp, uint64_t nh)
 	write_to_fib((void *)tbl8_ptr, nh|
 		DIR24_8_EXT_ENT, dp->nh_sz,
 		DIR24_8_TBL8_GRP_NUM_ENT);
+	/* Readers must see the entries before the group is linked in tbl24 */
+	__atomic_thread_fence(__ATOMIC_RELEASE);
 	dp->cur_tbl8s++;
 	return tbl8_idx;
 }
 
+static void
+tbl8_cleanup_and_free(struct dir24_8_tbl *dp, uint64_t tbl8_idx)
+{
+	uint8_t *ptr = (uint8_t *)dp->tbl8 +
+		((tbl8_idx * DIR24_8_TBL8_GRP_NUM_ENT) << dp->nh_sz);
+
+	memset(ptr, 0, DIR24_8_TBL8_GRP_NUM_ENT << dp->nh_sz);
+	tbl8_free_idx(dp, tbl8_idx);
+	dp->cur_tbl8s--;
+}
+
+static void
+__rcu_qsbr_free_resource(void *p, void *data, unsigned int n)
+{
+	struct dir24_8_tbl *dp = p;
+	uint64_t tbl8_idx = *(uint64_t *)data;
+
+	RTE_SET_USED(n);
+	tbl8_cleanup_and_free(dp, tbl8_idx);
+}
+
+/*
+ * Free a tbl8 group which is no longer linked from tbl24. With RCU, the
+ * group is only cleared and reused once the readers which may still be
+ * reading it have quiesced.
+ */
+static void
+tbl8_free(struct dir24_8_tbl *dp, uint64_t tbl8_idx)
+{
+	if (dp->v == NULL) {
+		tbl8_cleanup_and_free(dp, tbl8_idx);
+	} else if (dp->rcu_mode == RTE_FIB_QSBR_MODE_SYNC) {
+		/* Wait for quiescent state change. */
+		rte_rcu_qsbr_synchronize(dp->v, RTE_QSBR_THRID_INVALID);
+		tbl8_cleanup_and_free(dp, tbl8_idx);
+	} else if (dp->rcu_mode == RTE_FIB_QSBR_MODE_DQ) {
+		/* Push into QSBR defer queue, or wait if it is full. */
+		if (rte_rcu_qsbr_dq_enqueue(dp->dq, (void *)&tbl8_idx) != 0) {
+			rte_rcu_qsbr_synchronize(dp->v,
+				RTE_QSBR_THRID_INVALID);
+			tbl8_cleanup_and_free(dp, tbl8_idx);
+		}
+	}
+}
+
 static void
 tbl8_recycle(struct dir24_8_tbl *dp, uint32_t ip, uint64_t tbl8_idx)
 {
@@ -214,8 +270,6 @@ tbl8_recycle(struct dir24_8_tbl *dp, uint32_t ip, uint64_t tbl8_idx)
 		}
 		((uint8_t *)dp->tbl24)[ip >> 8] =
 			nh & ~DIR24_8_EXT_ENT;
-		for (i = 0; i < DIR24_8_TBL8_GRP_NUM_ENT; i++)
-			ptr8[i] = 0;
 		break;
 	case RTE_FIB_DIR24_8_2B:
 		ptr16 = &((uint16_t *)dp->tbl8)[tbl8_idx *
@@ -227,8 +281,6 @@ tbl8_recycle(struct dir24_8_tbl *dp, uint32_t ip, uint64_t tbl8_idx)
 		}
 		((uint16_t *)dp->tbl24)[ip >> 8] =
 			nh & ~DIR24_8_EXT_ENT;
-		for (i = 0; i < DIR24_8_TBL8_GRP_NUM_ENT; i++)
-			ptr16[i] = 0;
 		break;
 	case RTE_FIB_DIR24_8_4B:
 		ptr32 = &((uint32_t *)dp->tbl8)[tbl8_idx *
@@ -240,8 +292,6 @@ tbl8_recycle(struct dir24_8_tbl *dp, uint32_t ip, uint64_t tbl8_idx)
 		}
 		((uint32_t *)dp->tbl24)[ip >> 8] =
 			nh & ~DIR24_8_EXT_ENT;
-		for (i = 0; i < DIR24_8_TBL8_GRP_NUM_ENT; i++)
-			ptr32[i] = 0;
 		break;
 	case RTE_FIB_DIR24_8_8B:
 		ptr64 = &((uint64_t *)dp->tbl8)[tbl8_idx *
@@ -253,12 +303,9 @@ tbl8_recycle(struct dir24_8_tbl *dp, uint32_t ip, uint64_t tbl8_idx)
 		}
 		((uint64_t *)dp->tbl24)[ip >> 8] =
 			nh & ~DIR24_8_EXT_ENT;
-		for (i = 0; i < DIR24_8_TBL8_GRP_NUM_ENT; i++)
-			ptr64[i] = 0;
 		break;
 	}
-	tbl8_free_idx(dp, tbl8_idx);
-	dp->cur_tbl8s--;
+	tbl8_free(dp, tbl8_idx);
 }
 
 static int
@@ -406,6 +453,274 @@ modify_fib(struct dir24_8_tbl *dp, struct rte_rib *rib, uint32_t ip,
 	return 0;
 }
 
+/* Prefixes of the update transactions, sorted by address then depth */
+#define DIRTY_KEY(ip, depth)	(((uint64_t)(ip) << 8) | (depth))
+#define DIRTY_IP(key)		((uint32_t)((key) >> 8))
+#define DIRTY_DEPTH(key)	((uint8_t)(key))
+
+/* Make room for n prefixes in an array of prefixes */
+static int
+dirty_reserve(uint64_t **keys, uint32_t *sz, uint32_t n)
+{
+	uint64_t *tmp;
+	uint32_t new_sz;
+
+	if (n <= *sz)
+		return 0;
+
+	new_sz = RTE_MAX(*sz * 2, DIR24_8_DIRTY_MIN);
+	tmp = rte_realloc(*keys, new_sz * sizeof(*tmp), 0);
+	if (tmp == NULL)
+		return -ENOMEM;
+	*keys = tmp;
+	*sz = new_sz;
+	return 0;
+}
+
+static int
+dirty_cmp(const void *p1, const void *p2)
+{
+	uint64_t k1 = *(const uint64_t *)p1;
+	uint64_t k2 = *(const uint64_t *)p2;
+
+	return (k1 > k2) - (k1 < k2);
+}
+
+static inline int
+dirty_is_covered(uint64_t key, uint32_t ip, uint8_t depth)
+{
+	return (DIRTY_IP(key) & rte_rib_depth_to_mask(depth)) == ip;
+}
+
+/* Return the most specific route covering the prefix, itself included */
+static struct rte_rib_node *
+dirty_lookup_cover(struct rte_rib *rib, uint32_t ip, uint8_t depth)
+{
+	struct rte_rib_node *node;
+	uint8_t node_depth;
+
+	node = rte_rib_lookup(rib, ip);
+	while (node != NULL) {
+		rte_rib_get_depth(node, &node_depth);
+		if (node_depth <= depth)
+			break;
+		node = rte_rib_lookup_parent(node);
+	}
+	return node;
+}
+
+/*
+ * Same as install_to_fib, but the range may span tbl24 entries pointing
+ * to tbl8 groups of removed routes, release them first.
+ */
+static int
+install_gap(struct dir24_8_tbl *dp, uint32_t ledge, uint32_t redge,
+	uint64_t next_hop)
+{
+	uint32_t i, len;
+	uint64_t tbl24_tmp;
+
+	len = ((ledge == 0) && (redge == 0)) ? 1 << 24 :
+		((redge & DIR24_8_TBL24_MASK) - ROUNDUP(ledge, 24)) >> 8;
+
+	if (((ledge >> 8) != (redge >> 8)) || (len == 1 << 24)) {
+		for (i = ROUNDUP(ledge, 24) >> 8; len != 0; i++, len--) {
+			tbl24_tmp = get_tbl24(dp, i << 8, dp->nh_sz);
+			if ((tbl24_tmp & DIR24_8_EXT_ENT) != DIR24_8_EXT_ENT)
+				continue;
+			write_to_fib(get_tbl24_p(dp, i << 8, dp->nh_sz),
+				next_hop << 1, dp->nh_sz, 1);
+			tbl8_free(dp, tbl24_tmp >> 1);
+		}
+	}
+	return install_to_fib(dp, ledge, redge, next_hop);
+}
+
+/*
+ * Write the range of a prefix but the ranges of the prefixes it covers,
+ * which are on top of the stack, then replace them with the prefix.
+ */
+static int
+write_holes(struct dir24_8_tbl *dp, uint32_t *n, uint32_t ip, uint8_t depth,
+	uint64_t next_hop)
+{
+	uint32_t ledge, redge;
+	uint64_t key;
+	int ret;
+
+	redge = ip + (uint32_t)(1ULL << (32 - depth));
+	while ((*n > 0) && (DIRTY_DEPTH(dp->stack[*n - 1]) > depth) &&
+			dirty_is_covered(dp->stack[*n - 1], ip, depth)) {
+		key = dp->stack[--(*n)];
+		ledge = DIRTY_IP(key) +
+			(uint32_t)(1ULL << (32 - DIRTY_DEPTH(key)));
+		if (ledge != redge) {
+			ret = install_gap(dp, ledge, redge, next_hop);
+			if (ret != 0)
+				return ret;
+		}
+		redge = DIRTY_IP(key);
+	}
+	if (ip != redge) {
+		ret = install_gap(dp, ip, redge, next_hop);
+		if (ret != 0)
+			return ret;
+	}
+
+	ret = dirty_reserve(&dp->stack, &dp->stack_sz, *n + 1);
+	if (ret != 0)
+		return ret;
+	dp->stack[(*n)++] = DIRTY_KEY(ip, depth);
+	return 0;
+}
+
+/*
+ * Rewrite the whole range of a prefix from the routes it covers. They are
+ * visited children first, so that each entry is written only once.
+ */
+static int
+rewrite_fib(struct dir24_8_tbl *dp, struct rte_rib *rib, uint32_t ip,
+	uint8_t depth, uint64_t next_hop)
+{
+	struct rte_rib_node *node = NULL;
+	uint32_t n = 0, node_ip;
+	uint8_t node_depth;
+	uint64_t node_nh;
+	int ret;
+
+	while ((node = rte_rib_get_nxt(rib, ip, depth, node,
+			RTE_RIB_GET_NXT_ALL)) != NULL) {
+		rte_rib_get_ip(node, &node_ip);
+		rte_rib_get_depth(node, &node_depth);
+		rte_rib_get_nh(node, &node_nh);
+		ret = write_holes(dp, &n, node_ip, node_depth, node_nh);
+		if (ret != 0)
+			return ret;
+	}
+	return write_holes(dp, &n, ip, depth, next_hop);
+}
+
+/*
+ * Count the tbl8 groups the commit allocates, one for each /24 which has
+ * routes longer than /24 recorded in the transaction and no group yet,
+ * and make them available in one pass before anything is written, so
+ * that a lack of groups leaves the dataplane unchanged. The groups freed
+ * by the commit itself are not counted.
+ */
+static int
+dirty_reserve_tbl8(struct dir24_8_tbl *dp, struct rte_rib *rib)
+{
+	uint32_t i, ip, prev_ip = 0, need = 0;
+	uint64_t tbl24_tmp;
+
+	for (i = 0; i < dp->nb_dirty; i++) {
+		if (DIRTY_DEPTH(dp->dirty[i]) <= 24)
+			continue;
+		/* The prefixes of a /24 are next to each other once sorted */
+		ip = DIRTY_IP(dp->dirty[i]) & DIR24_8_TBL24_MASK;
+		if ((need != 0) && (ip == prev_ip))
+			continue;
+		prev_ip = ip;
+		tbl24_tmp = get_tbl24(dp, ip, dp->nh_sz);
+		if (((tbl24_tmp & DIR24_8_EXT_ENT) != DIR24_8_EXT_ENT) &&
+				(rte_rib_get_nxt(rib, ip, 24, NULL,
+				RTE_RIB_GET_NXT_COVER) != NULL))
+			need++;
+	}
+
+	if ((need > dp->number_tbl8s - dp->cur_tbl8s) && (dp->dq != NULL))
+		rte_rcu_qsbr_dq_reclaim(dp->dq,
+			need - (dp->number_tbl8s - dp->cur_tbl8s),
+			NULL, NULL, NULL);
+	if (need > dp->number_tbl8s - dp->cur_tbl8s)
+		return -ENOSPC;
+	return 0;
+}
+
+/*
+ * Rewrite the ranges of the recorded prefixes with the next hops of their
+ * longest match in the RIB. A prefix covering other recorded prefixes
+ * is rewritten along with all the routes it covers, in a single pass;
+ * otherwise only the part not covered by more specific routes is.
+ * With force, the prefixes which cannot be written are skipped and the
+ * transaction ends anyway, else they are kept for a retry.
+ */
+static int
+update_apply(struct dir24_8_tbl *dp, struct rte_rib *rib, int force)
+{
+	struct rte_rib_node *node;
+	uint32_t i, j, ip;
+	uint64_t next_hop;
+	uint8_t depth;
+	int nested, ret, err;
+
+	qsort(dp->dirty, dp->nb_dirty, sizeof(*dp->dirty), dirty_cmp);
+	err = dirty_reserve_tbl8(dp, rib);
+	if ((err != 0) && !force)
+		return err;
+
+	for (i = 0; i < dp->nb_dirty; i = j) {
+		ip = DIRTY_IP(dp->dirty[i]);
+		depth = DIRTY_DEPTH(dp->dirty[i]);
+		/* The prefixes it covers come next, skip them */
+		nested = 0;
+		for (j = i + 1; (j < dp->nb_dirty) &&
+				dirty_is_covered(dp->dirty[j], ip, depth); j++)
+			nested |= (DIRTY_DEPTH(dp->dirty[j]) != depth);
+
+		node = dirty_lookup_cover(rib, ip, depth);
+		if (node != NULL)
+			rte_rib_get_nh(node, &next_hop);
+		else
+			next_hop = dp->def_nh;
+
+		if (nested)
+			ret = rewrite_fib(dp, rib, ip, depth, next_hop);
+		else
+			ret = modify_fib(dp, rib, ip, depth, next_hop);
+		if ((ret != 0) && force) {
+			err = (err != 0) ? err : ret;
+		} else if (ret != 0) {
+			/* Keep the prefixes not rewritten yet for a retry */
+			dp->nb_dirty -= i;
+			memmove(dp->dirty, &dp->dirty[i],
+				dp->nb_dirty * sizeof(*dp->dirty));
+			return ret;
+		}
+	}
+
+	dp->nb_dirty = 0;
+	dp->in_update = 0;
+	return err;
+}
+
+int
+dir24_8_update_begin(struct dir24_8_tbl *dp)
+{
+	if (dp->in_update)
+		return -EBUSY;
+	dp->in_update = 1;
+	return 0;
+}
+
+int
+dir24_8_update_commit(struct dir24_8_tbl *dp, struct rte_rib *rib)
+{
+	if (!dp->in_update)
+		return -EINVAL;
+
+	return update_apply(dp, rib, 0);
+}
+
+int
+dir24_8_update_end(struct dir24_8_tbl *dp, struct rte_rib *rib)
+{
+	if (!dp->in_update)
+		return -EINVAL;
+
+	return update_apply(dp, rib, 1);
+}
+
 int
 dir24_8_modify(struct rte_fib *fib, uint32_t ip, uint8_t depth,
 	uint64_t next_hop, int op)
@@ -437,6 +752,16 @@ dir24_8_modify(struct rte_fib *fib, uint32_t ip, uint8_t depth,
 			rte_rib_get_nh(node, &node_nh);
 			if (node_nh == next_hop)
 				return 0;
+			if (dp->in_update) {
+				ret = dirty_reserve(&dp->dirty, &dp->dirty_sz,
+					dp->nb_dirty + 1);
+				if (ret != 0)
+					return ret;
+				dp->dirty[dp->nb_dirty++] =
+					DIRTY_KEY(ip, depth);
+				rte_rib_set_nh(node, next_hop);
+				return 0;
+			}
 			ret = modify_fib(dp, rib, ip, depth, next_hop);
 			if (ret == 0)
 				rte_rib_set_nh(node, next_hop);
@@ -450,10 +775,22 @@ dir24_8_modify(struct rte_fib *fib, uint32_t ip, uint8_t depth,
 				return -ENOSPC;
 
 		}
+		if (dp->in_update) {
+			ret = dirty_reserve(&dp->dirty, &dp->dirty_sz,
+				dp->nb_dirty + 1);
+			if (ret != 0)
+				return ret;
+		}
 		node = rte_rib_insert(rib, ip, depth);
 		if (node == NULL)
 			return -rte_errno;
 		rte_rib_set_nh(node, next_hop);
+		if (dp->in_update) {
+			dp->dirty[dp->nb_dirty++] = DIRTY_KEY(ip, depth);
+			if ((depth > 24) && (tmp == NULL))
+				dp->rsvd_tbl8s++;
+			return 0;
+		}
 		parent = rte_rib_lookup_parent(node);
 		if (parent != NULL) {
 			rte_rib_get_nh(parent, &par_nh);
@@ -472,14 +809,24 @@ dir24_8_modify(struct rte_fib *fib, uint32_t ip, uint8_t depth,
 		if (node == NULL)
 			return -ENOENT;
 
-		parent = rte_rib_lookup_parent(node);
-		if (parent != NULL) {
-			rte_rib_get_nh(parent, &par_nh);
-			rte_rib_get_nh(node, &node_nh);
-			if (par_nh != node_nh)
-				ret = modify_fib(dp, rib, ip, depth, par_nh);
-		} else
-			ret = modify_fib(dp, rib, ip, depth, dp->def_nh);
+		if (dp->in_update) {
+			ret = dirty_reserve(&dp->dirty, &dp->dirty_sz,
+				dp->nb_dirty + 1);
+			if (ret == 0)
+				dp->dirty[dp->nb_dirty++] =
+					DIRTY_KEY(ip, depth);
+		} else {
+			parent = rte_rib_lookup_parent(node);
+			if (parent != NULL) {
+				rte_rib_get_nh(parent, &par_nh);
+				rte_rib_get_nh(node, &node_nh);
+				if (par_nh != node_nh)
+					ret = modify_fib(dp, rib, ip, depth,
+						par_nh);
+			} else
+				ret = modify_fib(dp, rib, ip, depth,
+					dp->def_nh);
+		}
 		if (ret == 0) {
 			rte_rib_remove(rib, ip, depth);
 			if (depth > 24) {
@@ -567,7 +914,57 @@ dir24_8_free(void *p)
 {
 	struct dir24_8_tbl *dp = (struct dir24_8_tbl *)p;
 
+	if (dp->dq != NULL)
+		rte_rcu_qsbr_dq_delete(dp->dq);
+	rte_free(dp->dirty);
+	rte_free(dp->stack);
 	rte_free(dp->tbl8_idxes);
 	rte_free(dp->tbl8);
 	rte_free(dp);
 }
+
+int
+dir24_8_rcu_qsbr_add(struct dir24_8_tbl *dp, struct rte_fib_rcu_config *cfg,
+	const char *name)
+{
+	struct rte_rcu_qsbr_dq_parameters params = {0};
+	char rcu_dq_name[RTE_RCU_QSBR_DQ_NAMESIZE];
+
+	if (dp == NULL || cfg == NULL || cfg->v == NULL)
+		return -EINVAL;
+
+	if (dp->v != NULL)
+		return -EEXIST;
+
+	if (cfg->mode == RTE_FIB_QSBR_MODE_SYNC) {
+		/* No other things to do. */
+	} else if (cfg->mode == RTE_FIB_QSBR_MODE_DQ) {
+		/* Init QSBR defer queue. */
+		snprintf(rcu_dq_name, sizeof(rcu_dq_name),
+				"FIB_RCU_%s", name);
+		params.name = rcu_dq_name;
+		params.size = cfg->dq_size;
+		if (params.size == 0)
+			params.size = dp->number_tbl8s;
+		params.trigger_reclaim_limit = cfg->reclaim_thd;
+		params.max_reclaim_size = cfg->reclaim_max;
+		if (params.max_reclaim_size == 0)
+			params.max_reclaim_size = RTE_FIB_RCU_DQ_RECLAIM_MAX;
+		params.esize = sizeof(uint64_t);	/* tbl8 group index */
+		params.free_fn = __rcu_qsbr_free_resource;
+		params.p = dp;
+		params.v = cfg->v;
+		dp->dq = rte_rcu_qsbr_dq_create(&params);
+		if (dp->dq == NULL) {
+			RTE_LOG(ERR, LPM, "FIB defer queue creation failed\n");
+			return -rte_errno;
+		}
+	} else {
+		return -EINVAL;
+	}
+
+	dp->rcu_mode = cfg->mode;
+	dp->v = cfg->v;
+
+	return 0;
+}
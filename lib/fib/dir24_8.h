@@ -23,6 +23,9 @@
 #define BITMAP_SLAB_BIT_SIZE		(1 << BITMAP_SLAB_BIT_SIZE_LOG2)
 #define BITMAP_SLAB_BITMASK		(BITMAP_SLAB_BIT_SIZE - 1)
 
+/* Initial size of the arrays of prefixes used by update transactions */
+#define DIR24_8_DIRTY_MIN		64U
+
 struct dir24_8_tbl {
 	uint32_t	number_tbl8s;	/**< Total number of tbl8s */
 	uint32_t	rsvd_tbl8s;	/**< Number of reserved tbl8s */
@@ -31,6 +34,16 @@ struct dir24_8_tbl {
 	uint64_t	def_nh;		/**< Default next hop */
 	uint64_t	*tbl8;		/**< tbl8 table. */
 	uint64_t	*tbl8_idxes;	/**< bitmap containing free tbl8 idxes*/
+	uint32_t	tbl8_slab;	/**< slabs below this one are full */
+	struct rte_rcu_qsbr		*v;	/**< RCU QSBR variable */
+	enum rte_fib_qsbr_mode		rcu_mode; /**< Blocking, defer queue */
+	struct rte_rcu_qsbr_dq		*dq;	/**< RCU QSBR defer queue */
+	uint64_t	*dirty;		/**< Prefixes to rewrite on commit */
+	uint32_t	nb_dirty;	/**< Number of recorded prefixes */
+	uint32_t	dirty_sz;	/**< Size of the dirty array */
+	uint64_t	*stack;		/**< Prefixes pending during commit */
+	uint32_t	stack_sz;	/**< Size of the stack array */
+	uint8_t		in_update;	/**< Update transaction in progress */
 	/* tbl24 table. */
 	__extension__ uint64_t	tbl24[0] __rte_cache_aligned;
 };
@@ -248,4 +261,17 @@ int
 dir24_8_modify(struct rte_fib *fib, uint32_t ip, uint8_t depth,
 	uint64_t next_hop, int op);
 
+int
+dir24_8_rcu_qsbr_add(struct dir24_8_tbl *dp, struct rte_fib_rcu_config *cfg,
+	const char *name);
+
+int
+dir24_8_update_begin(struct dir24_8_tbl *dp);
+
+int
+dir24_8_update_commit(struct dir24_8_tbl *dp, struct rte_rib *rib);
+
+int
+dir24_8_update_end(struct dir24_8_tbl *dp, struct rte_rib *rib);
+
 #endif /* _DIR24_8_H_ */
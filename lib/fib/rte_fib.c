@@ -336,3 +336,157 @@ rte_fib_select_lookup(struct rte_fib *fib,
 		return -EINVAL;
 	}
 }
+
+int
+rte_fib_rcu_qsbr_add(struct rte_fib *fib, struct rte_fib_rcu_config *cfg)
+{
+	if (fib == NULL)
+		return -EINVAL;
+
+	switch (fib->type) {
+	case RTE_FIB_DIR24_8:
+		return dir24_8_rcu_qsbr_add(fib->dp, cfg, fib->name);
+	default:
+		return -ENOTSUP;
+	}
+}
+
+int
+rte_fib_update_begin(struct rte_fib *fib)
+{
+	if (fib == NULL)
+		return -EINVAL;
+
+	switch (fib->type) {
+	case RTE_FIB_DIR24_8:
+		return dir24_8_update_begin(fib->dp);
+	default:
+		return -ENOTSUP;
+	}
+}
+
+int
+rte_fib_update_commit(struct rte_fib *fib)
+{
+	if (fib == NULL)
+		return -EINVAL;
+
+	switch (fib->type) {
+	case RTE_FIB_DIR24_8:
+		return dir24_8_update_commit(fib->dp, fib->rib);
+	default:
+		return -ENOTSUP;
+	}
+}
+
+/* End a transaction even if some of its prefixes cannot be written */
+static int
+fib_update_end(struct rte_fib *fib)
+{
+	switch (fib->type) {
+	case RTE_FIB_DIR24_8:
+		return dir24_8_update_end(fib->dp, fib->rib);
+	default:
+		return -ENOTSUP;
+	}
+}
+
+/* Next hop of a prefix without route, above the largest next hop */
+#define FIB_NH_NONE	UINT64_MAX
+
+static uint64_t
+fib_get_nh(struct rte_fib *fib, uint32_t ip, uint8_t depth)
+{
+	struct rte_rib_node *node;
+	uint64_t nh;
+
+	node = rte_rib_lookup_exact(fib->rib, ip, depth);
+	if (node == NULL)
+		return FIB_NH_NONE;
+	rte_rib_get_nh(node, &nh);
+	return nh;
+}
+
+/* Give back to the first n prefixes their previous routes, last first */
+static void
+fib_undo_bulk(struct rte_fib *fib, const uint32_t *ips,
+	const uint8_t *depths, const uint64_t *prev_nhs, unsigned int n)
+{
+	while (n-- > 0) {
+		if (prev_nhs[n] == FIB_NH_NONE)
+			rte_fib_delete(fib, ips[n], depths[n]);
+		else
+			rte_fib_add(fib, ips[n], depths[n], prev_nhs[n]);
+	}
+}
+
+static int
+fib_modify_bulk(struct rte_fib *fib, const uint32_t *ips,
+	const uint8_t *depths, const uint64_t *next_hops, unsigned int n,
+	int op)
+{
+	uint64_t *prev_nhs = NULL;
+	unsigned int i;
+	int ret, commit;
+
+	if ((fib == NULL) || (ips == NULL) || (depths == NULL) ||
+			((op == RTE_FIB_ADD) && (next_hops == NULL)))
+		return -EINVAL;
+
+	/* Use a transaction of its own unless one is already in progress */
+	ret = rte_fib_update_begin(fib);
+	if ((ret != 0) && (ret != -EBUSY) && (ret != -ENOTSUP))
+		return ret;
+	commit = (ret == 0);
+
+	/* A transaction of its own is rolled back on failure */
+	if (commit && (n != 0)) {
+		prev_nhs = rte_malloc(NULL, n * sizeof(*prev_nhs), 0);
+		if (prev_nhs == NULL) {
+			fib_update_end(fib);
+			return -ENOMEM;
+		}
+	}
+
+	ret = 0;
+	for (i = 0; i < n; i++) {
+		if (prev_nhs != NULL)
+			prev_nhs[i] = fib_get_nh(fib, ips[i], depths[i]);
+		if (op == RTE_FIB_ADD)
+			ret = rte_fib_add(fib, ips[i], depths[i],
+				next_hops[i]);
+		else
+			ret = rte_fib_delete(fib, ips[i], depths[i]);
+		if (ret != 0)
+			break;
+	}
+
+	if (commit) {
+		if (ret == 0)
+			ret = rte_fib_update_commit(fib);
+		/* Restore the routes of the RIB from before the call, so
+		 * that ending the transaction rewrites the dataplane the
+		 * way it was: the RIB must not keep unwritten routes.
+		 */
+		if (ret != 0) {
+			fib_undo_bulk(fib, ips, depths, prev_nhs, i);
+			fib_update_end(fib);
+		}
+	}
+	rte_free(prev_nhs);
+	return ret;
+}
+
+int
+rte_fib_add_bulk(struct rte_fib *fib, const uint32_t *ips,
+	const uint8_t *depths, const uint64_t *next_hops, unsigned int n)
+{
+	return fib_modify_bulk(fib, ips, depths, next_hops, n, RTE_FIB_ADD);
+}
+
+int
+rte_fib_delete_bulk(struct rte_fib *fib, const uint32_t *ips,
+	const uint8_t *depths, unsigned int n)
+{
+	return fib_modify_bulk(fib, ips, depths, NULL, n, RTE_FIB_DEL);
+}
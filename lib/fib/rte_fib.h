@@ -18,6 +18,7 @@
 #include <stdint.h>
 
 #include <rte_compat.h>
+#include <rte_rcu_qsbr.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -35,6 +36,17 @@ enum rte_fib_type {
 	RTE_FIB_DIR24_8		/**< DIR24_8 based FIB */
 };
 
+/** @internal Default RCU defer queue entries to reclaim in one go. */
+#define RTE_FIB_RCU_DQ_RECLAIM_MAX	16
+
+/** RCU reclamation modes */
+enum rte_fib_qsbr_mode {
+	/** Create defer queue for reclaim. */
+	RTE_FIB_QSBR_MODE_DQ = 0,
+	/** Use blocking mode reclaim. No defer queue created. */
+	RTE_FIB_QSBR_MODE_SYNC
+};
+
 /** Modify FIB function */
 typedef int (*rte_fib_modify_fn_t)(struct rte_fib *fib, uint32_t ip,
 	uint8_t depth, uint64_t next_hop, int op);
@@ -90,6 +102,22 @@ struct rte_fib_conf {
 	};
 };
 
+/** FIB RCU QSBR configuration structure. */
+struct rte_fib_rcu_config {
+	struct rte_rcu_qsbr *v;	/**< RCU QSBR variable. */
+	/** Mode of RCU QSBR. RTE_FIB_QSBR_MODE_xxx,
+	 * '0' for default: create defer queue for reclaim.
+	 */
+	enum rte_fib_qsbr_mode mode;
+	/** RCU defer queue size, default: number of tbl8 groups. */
+	uint32_t dq_size;
+	uint32_t reclaim_thd;	/**< Threshold to trigger auto reclaim. */
+	/** Max entries to reclaim in one go,
+	 * default: RTE_FIB_RCU_DQ_RECLAIM_MAX.
+	 */
+	uint32_t reclaim_max;
+};
+
 /**
  * Create FIB
  *
@@ -221,6 +249,147 @@ rte_fib_get_rib(struct rte_fib *fib);
 int
 rte_fib_select_lookup(struct rte_fib *fib, enum rte_fib_lookup_type type);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change, or be removed, without prior notice
+ *
+ * Associate RCU QSBR variable with a FIB object.
+ *
+ * Once associated, the tbl8 groups released by rte_fib_delete() or
+ * rte_fib_add() are only reused once all the threads registered
+ * with the QSBR variable went through a quiescent state, so that
+ * rte_fib_lookup_bulk() can run concurrently with the updates.
+ * Only the RTE_FIB_DIR24_8 type supports it.
+ *
+ * @param fib
+ *   FIB object handle
+ * @param cfg
+ *   RCU QSBR configuration
+ * @return
+ *   0 on success
+ *   -EINVAL for invalid arguments
+ *   -ENOTSUP if the FIB type does not support RCU
+ *   -EEXIST if a QSBR variable is already associated
+ *   -ENOMEM on defer queue allocation failure
+ */
+__rte_experimental
+int
+rte_fib_rcu_qsbr_add(struct rte_fib *fib, struct rte_fib_rcu_config *cfg);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change, or be removed, without prior notice
+ *
+ * Start an update transaction on the FIB.
+ *
+ * Until rte_fib_update_commit(), rte_fib_add() and rte_fib_delete() only
+ * update the RIB and record the modified prefixes, the lookups keep
+ * returning the next hops from before the transaction. The commit then
+ * rewrites the dataplane entries of all the modified prefixes at once,
+ * writing each of them at most once, whatever the number and the order
+ * of the updates. The RIB updates are not faster, so the gain depends on
+ * how much the prefixes overlap.
+ * Only the RTE_FIB_DIR24_8 type supports it.
+ *
+ * @param fib
+ *   FIB object handle
+ * @return
+ *   0 on success
+ *   -EINVAL for invalid arguments
+ *   -ENOTSUP if the FIB type does not support transactions
+ *   -EBUSY if a transaction is already in progress
+ */
+__rte_experimental
+int
+rte_fib_update_begin(struct rte_fib *fib);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change, or be removed, without prior notice
+ *
+ * Apply the routes added and deleted since rte_fib_update_begin() to
+ * the dataplane and end the transaction.
+ *
+ * The lookups running concurrently may see a mix of the old and new
+ * next hops until the commit returns. The tbl8 groups needed are counted
+ * and made available before writing, so that a lack of them, such as
+ * groups pending RCU reclamation, fails the commit with the dataplane
+ * unchanged. On failure the transaction stays in progress, the dataplane
+ * being partially updated for other errors: the commit can be retried,
+ * possibly after more updates.
+ *
+ * @param fib
+ *   FIB object handle
+ * @return
+ *   0 on success
+ *   -EINVAL for invalid arguments or if no transaction is in progress
+ *   -ENOTSUP if the FIB type does not support transactions
+ *   -ENOSPC if there are not enough tbl8 groups
+ */
+__rte_experimental
+int
+rte_fib_update_commit(struct rte_fib *fib);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change, or be removed, without prior notice
+ *
+ * Add multiple routes to the FIB.
+ *
+ * Unless a transaction is already in progress, the routes are added in
+ * a transaction of their own, see rte_fib_update_begin().
+ * The routes are added in order and the first failure stops the
+ * processing. In a transaction of their own, any failure, to commit
+ * included, rolls it back: the RIB and the dataplane are left as they
+ * were before the call. Otherwise the routes added before it are kept.
+ *
+ * @param fib
+ *   FIB object handle
+ * @param ips
+ *   Array of IPv4 prefix addresses to be added to the FIB
+ * @param depths
+ *   Array of prefix lengths
+ * @param next_hops
+ *   Array of next hops to be added to the FIB
+ * @param n
+ *   Number of routes to add
+ * @return
+ *   0 on success, negative value otherwise
+ */
+__rte_experimental
+int
+rte_fib_add_bulk(struct rte_fib *fib, const uint32_t *ips,
+	const uint8_t *depths, const uint64_t *next_hops, unsigned int n);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change, or be removed, without prior notice
+ *
+ * Delete multiple routes from the FIB.
+ *
+ * Unless a transaction is already in progress, the routes are deleted in
+ * a transaction of their own, see rte_fib_update_begin().
+ * The routes are deleted in order and the first failure stops the
+ * processing. In a transaction of their own, any failure, to commit
+ * included, rolls it back: the RIB and the dataplane are left as they
+ * were before the call. Otherwise the routes deleted before it stay deleted.
+ *
+ * @param fib
+ *   FIB object handle
+ * @param ips
+ *   Array of IPv4 prefix addresses to be deleted from the FIB
+ * @param depths
+ *   Array of prefix lengths
+ * @param n
+ *   Number of routes to delete
+ * @return
+ *   0 on success, negative value otherwise
+ */
+__rte_experimental
+int
+rte_fib_delete_bulk(struct rte_fib *fib, const uint32_t *ips,
+	const uint8_t *depths, unsigned int n);
+
 #ifdef __cplusplus
 }
 #endif
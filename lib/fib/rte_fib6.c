@@ -337,3 +337,161 @@ rte_fib6_select_lookup(struct rte_fib6 *fib,
 		return -EINVAL;
 	}
 }
+
+int
+rte_fib6_rcu_qsbr_add(struct rte_fib6 *fib, struct rte_fib6_rcu_config *cfg)
+{
+	if (fib == NULL)
+		return -EINVAL;
+
+	switch (fib->type) {
+	case RTE_FIB6_TRIE:
+		return trie_rcu_qsbr_add(fib->dp, cfg, fib->name);
+	default:
+		return -ENOTSUP;
+	}
+}
+
+int
+rte_fib6_update_begin(struct rte_fib6 *fib)
+{
+	if (fib == NULL)
+		return -EINVAL;
+
+	switch (fib->type) {
+	case RTE_FIB6_TRIE:
+		return trie_update_begin(fib->dp);
+	default:
+		return -ENOTSUP;
+	}
+}
+
+int
+rte_fib6_update_commit(struct rte_fib6 *fib)
+{
+	if (fib == NULL)
+		return -EINVAL;
+
+	switch (fib->type) {
+	case RTE_FIB6_TRIE:
+		return trie_update_commit(fib->dp, fib->rib);
+	default:
+		return -ENOTSUP;
+	}
+}
+
+/* End a transaction even if some of its prefixes cannot be written */
+static int
+fib6_update_end(struct rte_fib6 *fib)
+{
+	switch (fib->type) {
+	case RTE_FIB6_TRIE:
+		return trie_update_end(fib->dp, fib->rib);
+	default:
+		return -ENOTSUP;
+	}
+}
+
+/* Next hop of a prefix without route, above the largest next hop */
+#define FIB6_NH_NONE	UINT64_MAX
+
+static uint64_t
+fib6_get_nh(struct rte_fib6 *fib, const uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE],
+	uint8_t depth)
+{
+	struct rte_rib6_node *node;
+	uint64_t nh;
+
+	node = rte_rib6_lookup_exact(fib->rib, ip, depth);
+	if (node == NULL)
+		return FIB6_NH_NONE;
+	rte_rib6_get_nh(node, &nh);
+	return nh;
+}
+
+/* Give back to the first n prefixes their previous routes, last first */
+static void
+fib6_undo_bulk(struct rte_fib6 *fib,
+	const uint8_t ips[][RTE_FIB6_IPV6_ADDR_SIZE], const uint8_t *depths,
+	const uint64_t *prev_nhs, unsigned int n)
+{
+	while (n-- > 0) {
+		if (prev_nhs[n] == FIB6_NH_NONE)
+			rte_fib6_delete(fib, ips[n], depths[n]);
+		else
+			rte_fib6_add(fib, ips[n], depths[n], prev_nhs[n]);
+	}
+}
+
+static int
+fib6_modify_bulk(struct rte_fib6 *fib,
+	const uint8_t ips[][RTE_FIB6_IPV6_ADDR_SIZE], const uint8_t *depths,
+	const uint64_t *next_hops, unsigned int n, int op)
+{
+	uint64_t *prev_nhs = NULL;
+	unsigned int i;
+	int ret, commit;
+
+	if ((fib == NULL) || (ips == NULL) || (depths == NULL) ||
+			((op == RTE_FIB6_ADD) && (next_hops == NULL)))
+		return -EINVAL;
+
+	/* Use a transaction of its own unless one is already in progress */
+	ret = rte_fib6_update_begin(fib);
+	if ((ret != 0) && (ret != -EBUSY) && (ret != -ENOTSUP))
+		return ret;
+	commit = (ret == 0);
+
+	/* A transaction of its own is rolled back on failure */
+	if (commit && (n != 0)) {
+		prev_nhs = rte_malloc(NULL, n * sizeof(*prev_nhs), 0);
+		if (prev_nhs == NULL) {
+			fib6_update_end(fib);
+			return -ENOMEM;
+		}
+	}
+
+	ret = 0;
+	for (i = 0; i < n; i++) {
+		if (prev_nhs != NULL)
+			prev_nhs[i] = fib6_get_nh(fib, ips[i], depths[i]);
+		if (op == RTE_FIB6_ADD)
+			ret = rte_fib6_add(fib, ips[i], depths[i],
+				next_hops[i]);
+		else
+			ret = rte_fib6_delete(fib, ips[i], depths[i]);
+		if (ret != 0)
+			break;
+	}
+
+	if (commit) {
+		if (ret == 0)
+			ret = rte_fib6_update_commit(fib);
+		/* Restore the routes of the RIB from before the call, so
+		 * that ending the transaction rewrites the dataplane the
+		 * way it was: the RIB must not keep unwritten routes.
+		 */
+		if (ret != 0) {
+			fib6_undo_bulk(fib, ips, depths, prev_nhs, i);
+			fib6_update_end(fib);
+		}
+	}
+	rte_free(prev_nhs);
+	return ret;
+}
+
+int
+rte_fib6_add_bulk(struct rte_fib6 *fib,
+	const uint8_t ips[][RTE_FIB6_IPV6_ADDR_SIZE], const uint8_t *depths,
+	const uint64_t *next_hops, unsigned int n)
+{
+	return fib6_modify_bulk(fib, ips, depths, next_hops, n, RTE_FIB6_ADD);
+}
+
+int
+rte_fib6_delete_bulk(struct rte_fib6 *fib,
+	const uint8_t ips[][RTE_FIB6_IPV6_ADDR_SIZE], const uint8_t *depths,
+	unsigned int n)
+{
+	return fib6_modify_bulk(fib, ips, depths, NULL, n, RTE_FIB6_DEL);
+}
@@ -18,6 +18,7 @@
 #include <stdint.h>
 
 #include <rte_compat.h>
+#include <rte_rcu_qsbr.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -36,6 +37,17 @@ enum rte_fib6_type {
 	RTE_FIB6_TRIE		/**< TRIE based fib  */
 };
 
+/** @internal Default RCU defer queue entries to reclaim in one go. */
+#define RTE_FIB6_RCU_DQ_RECLAIM_MAX	16
+
+/** RCU reclamation modes */
+enum rte_fib6_qsbr_mode {
+	/** Create defer queue for reclaim. */
+	RTE_FIB6_QSBR_MODE_DQ = 0,
+	/** Use blocking mode reclaim. No defer queue created. */
+	RTE_FIB6_QSBR_MODE_SYNC
+};
+
 /** Modify FIB function */
 typedef int (*rte_fib6_modify_fn_t)(struct rte_fib6 *fib,
 	const uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE], uint8_t depth,
@@ -81,6 +93,22 @@ struct rte_fib6_conf {
 	};
 };
 
+/** FIB6 RCU QSBR configuration structure. */
+struct rte_fib6_rcu_config {
+	struct rte_rcu_qsbr *v;	/**< RCU QSBR variable. */
+	/** Mode of RCU QSBR. RTE_FIB6_QSBR_MODE_xxx,
+	 * '0' for default: create defer queue for reclaim.
+	 */
+	enum rte_fib6_qsbr_mode mode;
+	/** RCU defer queue size, default: number of tbl8 groups. */
+	uint32_t dq_size;
+	uint32_t reclaim_thd;	/**< Threshold to trigger auto reclaim. */
+	/** Max entries to reclaim in one go,
+	 * default: RTE_FIB6_RCU_DQ_RECLAIM_MAX.
+	 */
+	uint32_t reclaim_max;
+};
+
 /**
  * Create FIB
  *
@@ -216,6 +244,146 @@ rte_fib6_get_rib(struct rte_fib6 *fib);
 int
 rte_fib6_select_lookup(struct rte_fib6 *fib, enum rte_fib6_lookup_type type);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change, or be removed, without prior notice
+ *
+ * Associate RCU QSBR variable with a FIB6 object.
+ *
+ * Once associated, the tbl8 groups released by rte_fib6_delete() or
+ * rte_fib6_add() are only reused once all the threads registered
+ * with the QSBR variable went through a quiescent state, so that
+ * rte_fib6_lookup_bulk() can run concurrently with the updates.
+ * Only the RTE_FIB6_TRIE type supports it.
+ *
+ * @param fib
+ *   FIB6 object handle
+ * @param cfg
+ *   RCU QSBR configuration
+ * @return
+ *   0 on success
+ *   -EINVAL for invalid arguments
+ *   -ENOTSUP if the FIB6 type does not support RCU
+ *   -EEXIST if a QSBR variable is already associated
+ *   -ENOMEM on defer queue allocation failure
+ */
+__rte_experimental
+int
+rte_fib6_rcu_qsbr_add(struct rte_fib6 *fib, struct rte_fib6_rcu_config *cfg);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change, or be removed, without prior notice
+ *
+ * Start an update transaction on the FIB6.
+ *
+ * Until rte_fib6_update_commit(), rte_fib6_add() and rte_fib6_delete()
+ * only update the RIB and record the modified prefixes, the lookups keep
+ * returning the next hops from before the transaction. The commit then
+ * rewrites the dataplane entries of all the modified prefixes at once.
+ * Only the RTE_FIB6_TRIE type supports it.
+ *
+ * @param fib
+ *   FIB6 object handle
+ * @return
+ *   0 on success
+ *   -EINVAL for invalid arguments
+ *   -ENOTSUP if the FIB6 type does not support transactions
+ *   -EBUSY if a transaction is already in progress
+ */
+__rte_experimental
+int
+rte_fib6_update_begin(struct rte_fib6 *fib);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change, or be removed, without prior notice
+ *
+ * Apply the routes added and deleted since rte_fib6_update_begin() to
+ * the dataplane and end the transaction.
+ *
+ * The lookups running concurrently may see a mix of the old and new
+ * next hops until the commit returns. The tbl8 groups needed are counted
+ * and made available before writing, so that a lack of them, such as
+ * groups pending RCU reclamation, fails the commit with the dataplane
+ * unchanged. On failure the transaction stays in progress, the dataplane
+ * being partially updated for other errors: the commit can be retried,
+ * possibly after more updates.
+ *
+ * @param fib
+ *   FIB6 object handle
+ * @return
+ *   0 on success
+ *   -EINVAL for invalid arguments or if no transaction is in progress
+ *   -ENOTSUP if the FIB6 type does not support transactions
+ *   -ENOSPC if there are not enough tbl8 groups
+ */
+__rte_experimental
+int
+rte_fib6_update_commit(struct rte_fib6 *fib);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change, or be removed, without prior notice
+ *
+ * Add multiple routes to the FIB6.
+ *
+ * Unless a transaction is already in progress, the routes are added in
+ * a transaction of their own, see rte_fib6_update_begin().
+ * The routes are added in order and the first failure stops the
+ * processing. In a transaction of their own, any failure, to commit
+ * included, rolls it back: the RIB and the dataplane are left as they
+ * were before the call. Otherwise the routes added before it are kept.
+ *
+ * @param fib
+ *   FIB6 object handle
+ * @param ips
+ *   Array of IPv6 prefix addresses to be added to the FIB6
+ * @param depths
+ *   Array of prefix lengths
+ * @param next_hops
+ *   Array of next hops to be added to the FIB6
+ * @param n
+ *   Number of routes to add
+ * @return
+ *   0 on success, negative value otherwise
+ */
+__rte_experimental
+int
+rte_fib6_add_bulk(struct rte_fib6 *fib,
+	const uint8_t ips[][RTE_FIB6_IPV6_ADDR_SIZE], const uint8_t *depths,
+	const uint64_t *next_hops, unsigned int n);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change, or be removed, without prior notice
+ *
+ * Delete multiple routes from the FIB6.
+ *
+ * Unless a transaction is already in progress, the routes are deleted in
+ * a transaction of their own, see rte_fib6_update_begin().
+ * The routes are deleted in order and the first failure stops the
+ * processing. In a transaction of their own, any failure, to commit
+ * included, rolls it back: the RIB and the dataplane are left as they
+ * were before the call. Otherwise the routes deleted before it stay deleted.
+ *
+ * @param fib
+ *   FIB6 object handle
+ * @param ips
+ *   Array of IPv6 prefix addresses to be deleted from the FIB6
+ * @param depths
+ *   Array of prefix lengths
+ * @param n
+ *   Number of routes to delete
+ * @return
+ *   0 on success, negative value otherwise
+ */
+__rte_experimental
+int
+rte_fib6_delete_bulk(struct rte_fib6 *fib,
+	const uint8_t ips[][RTE_FIB6_IPV6_ADDR_SIZE], const uint8_t *depths,
+	unsigned int n);
+
 #ifdef __cplusplus
 }
 #endif
@@ -162,6 +162,11 @@ tbl8_alloc(struct rte_trie_tbl *dp, uint64_t nh)
 	uint8_t		*tbl8_ptr;
 
 	tbl8_idx = tbl8_get(dp);
+	if ((tbl8_idx == -ENOSPC) && (dp->dq != NULL)) {
+		/* If there are no tbl8 groups try to reclaim one. */
+		if (rte_rcu_qsbr_dq_reclaim(dp->dq, 1, NULL, NULL, NULL) == 0)
+			tbl8_idx = tbl8_get(dp);
+	}
 	if (tbl8_idx < 0)
 		return tbl8_idx;
 	tbl8_ptr = get_tbl_p_by_idx(dp->tbl8,
@@ -169,10 +174,61 @@ tbl8_alloc(struct rte_trie_tbl *dp, uint64_t nh)
 	/*Init tbl8 entries with nexthop from tbl24*/
 	write_to_dp((void *)tbl8_ptr, nh, dp->nh_sz,
 		TRIE_TBL8_GRP_NUM_ENT);
+	/* Readers must see the entries before the group is linked */
+	__atomic_thread_fence(__ATOMIC_RELEASE);
 	return tbl8_idx;
 }
 
 static void
+tbl8_cleanup_and_free(struct rte_trie_tbl *dp, uint64_t tbl8_idx)
+{
+	uint8_t *ptr = (uint8_t *)dp->tbl8 +
+		((tbl8_idx * TRIE_TBL8_GRP_NUM_ENT) << dp->nh_sz);
+
+	memset(ptr, 0, TRIE_TBL8_GRP_NUM_ENT << dp->nh_sz);
+	tbl8_put(dp, tbl8_idx);
+}
+
+static void
+__rcu_qsbr_free_resource(void *p, void *data, unsigned int n)
+{
+	struct rte_trie_tbl *dp = p;
+	uint64_t tbl8_idx = *(uint64_t *)data;
+
+	RTE_SET_USED(n);
+	tbl8_cleanup_and_free(dp, tbl8_idx);
+}
+
+/*
+ * Free a tbl8 which is no longer linked from its parent. With RCU, the
+ * tbl8 is only cleared and reused once the readers which may still be
+ * reading it have quiesced.
+ */
+static void
+tbl8_free(struct rte_trie_tbl *dp, uint64_t tbl8_idx)
+{
+	if (dp->v == NULL) {
+		tbl8_cleanup_and_free(dp, tbl8_idx);
+	} else if (dp->rcu_mode == RTE_FIB6_QSBR_MODE_SYNC) {
+		/* Wait for quiescent state change. */
+		rte_rcu_qsbr_synchronize(dp->v, RTE_QSBR_THRID_INVALID);
+		tbl8_cleanup_and_free(dp, tbl8_idx);
+	} else if (dp->rcu_mode == RTE_FIB6_QSBR_MODE_DQ) {
+		/* Push into QSBR defer queue, or wait if it is full. */
+		if (rte_rcu_qsbr_dq_enqueue(dp->dq, (void *)&tbl8_idx) != 0) {
+			rte_rcu_qsbr_synchronize(dp->v,
+				RTE_QSBR_THRID_INVALID);
+			tbl8_cleanup_and_free(dp, tbl8_idx);
+		}
+	}
+}
+
+/*
+ * If all the entries of a tbl8 have the same next hop, write it to the
+ * parent entry instead. Return 1 if so, the tbl8 must then be freed once
+ * the parent entry is written to the table.
+ */
+static int
 tbl8_recycle(struct rte_trie_tbl *dp, void *par, uint64_t tbl8_idx)
 {
 	uint32_t i;
@@ -187,45 +243,39 @@ tbl8_recycle(struct rte_trie_tbl *dp, void *par, uint64_t tbl8_idx)
 				TRIE_TBL8_GRP_NUM_ENT];
 		nh = *ptr16;
 		if (nh & TRIE_EXT_ENT)
-			return;
+			return 0;
 		for (i = 1; i < TRIE_TBL8_GRP_NUM_ENT; i++) {
 			if (nh != ptr16[i])
-				return;
+				return 0;
 		}
 		write_to_dp(par, nh, dp->nh_sz, 1);
-		for (i = 0; i < TRIE_TBL8_GRP_NUM_ENT; i++)
-			ptr16[i] = 0;
 		break;
 	case RTE_FIB6_TRIE_4B:
 		ptr32 = &((uint32_t *)dp->tbl8)[tbl8_idx *
 				TRIE_TBL8_GRP_NUM_ENT];
 		nh = *ptr32;
 		if (nh & TRIE_EXT_ENT)
-			return;
+			return 0;
 		for (i = 1; i < TRIE_TBL8_GRP_NUM_ENT; i++) {
 			if (nh != ptr32[i])
-				return;
+				return 0;
 		}
 		write_to_dp(par, nh, dp->nh_sz, 1);
-		for (i = 0; i < TRIE_TBL8_GRP_NUM_ENT; i++)
-			ptr32[i] = 0;
 		break;
 	case RTE_FIB6_TRIE_8B:
 		ptr64 = &((uint64_t *)dp->tbl8)[tbl8_idx *
 				TRIE_TBL8_GRP_NUM_ENT];
 		nh = *ptr64;
 		if (nh & TRIE_EXT_ENT)
-			return;
+			return 0;
 		for (i = 1; i < TRIE_TBL8_GRP_NUM_ENT; i++) {
 			if (nh != ptr64[i])
-				return;
+				return 0;
 		}
 		write_to_dp(par, nh, dp->nh_sz, 1);
-		for (i = 0; i < TRIE_TBL8_GRP_NUM_ENT; i++)
-			ptr64[i] = 0;
 		break;
 	}
-	tbl8_put(dp, tbl8_idx);
+	return 1;
 }
 
 #define BYTE_SIZE	8
@@ -281,7 +331,8 @@ recycle_root_path(struct rte_trie_tbl *dp, const uint8_t *ip_part,
 			TRIE_TBL8_GRP_NUM_ENT + *ip_part, dp->nh_sz);
 		recycle_root_path(dp, ip_part + 1, common_tbl8 - 1, p);
 	}
-	tbl8_recycle(dp, prev, val >> 1);
+	if (tbl8_recycle(dp, prev, val >> 1))
+		tbl8_free(dp, val >> 1);
 }
 
 static inline int
@@ -322,6 +373,7 @@ write_edge(struct rte_trie_tbl *dp, const uint8_t *ip_part, uint64_t next_hop,
 {
 	uint64_t val = next_hop << 1;
 	int tbl8_idx;
+	int recycled = 0;
 	int ret = 0;
 	void *p;
 
@@ -348,13 +400,27 @@ write_edge(struct rte_trie_tbl *dp, const uint8_t *ip_part, uint64_t next_hop,
 				TRIE_TBL8_GRP_NUM_ENT, dp->nh_sz),
 				next_hop << 1, dp->nh_sz, *ip_part);
 		}
-		tbl8_recycle(dp, &val, tbl8_idx);
+		recycled = tbl8_recycle(dp, &val, tbl8_idx);
 	}
 
 	write_to_dp(ent, val, dp->nh_sz, 1);
+	if (recycled)
+		tbl8_free(dp, tbl8_idx);
 	return ret;
 }
 
+static inline int
+is_filled(const uint8_t *p, uint8_t val, int len)
+{
+	int i;
+
+	for (i = 0; i < len; i++) {
+		if (p[i] != val)
+			return 0;
+	}
+	return 1;
+}
+
 #define IPV6_MAX_IDX	(RTE_FIB6_IPV6_ADDR_SIZE - 1)
 #define TBL24_BYTES	3
 #define TBL8_LEN	(RTE_FIB6_IPV6_ADDR_SIZE - TBL24_BYTES)
@@ -383,6 +449,12 @@ install_to_dp(struct rte_trie_tbl *dp, const uint8_t *ledge, const uint8_t *r,
 		if (ledge[common_bytes] != redge[common_bytes])
 			break;
 	}
+	/* A range filling the entry above is written to it directly */
+	if ((common_bytes > 0) && is_filled(&ledge[common_bytes], 0,
+			RTE_FIB6_IPV6_ADDR_SIZE - common_bytes) &&
+			is_filled(&redge[common_bytes], UINT8_MAX,
+			RTE_FIB6_IPV6_ADDR_SIZE - common_bytes))
+		common_bytes--;
 
 	ret = build_common_root(dp, ledge, common_bytes, &common_root_tbl);
 	if (unlikely(ret != 0))
@@ -395,13 +467,14 @@ install_to_dp(struct rte_trie_tbl *dp, const uint8_t *ledge, const uint8_t *r,
 			break;
 	}
 
-	llen = i - first_tbl8_byte + (common_bytes < 3);
+	llen = i - first_tbl8_byte + ((common_bytes < 3) && (ledge[i] != 0));
 
 	for (i = IPV6_MAX_IDX; i > first_tbl8_byte; i--) {
 		if (redge[i] != UINT8_MAX)
 			break;
 	}
-	rlen = i - first_tbl8_byte + (common_bytes < 3);
+	rlen = i - first_tbl8_byte +
+		((common_bytes < 3) && (redge[i] != UINT8_MAX));
 
 	/*first noncommon byte*/
 	uint8_t first_byte_idx = (common_bytes < 3) ? 0 : common_bytes;
@@ -504,19 +577,413 @@ modify_dp(struct rte_trie_tbl *dp, struct rte_rib6 *rib,
 	return 0;
 }
 
+/* Make room for n prefixes in an array of prefixes */
+static int
+dirty_reserve(struct rte_trie_dirty **dirty, uint32_t *sz, uint32_t n)
+{
+	struct rte_trie_dirty *tmp;
+	uint32_t new_sz;
+
+	if (n <= *sz)
+		return 0;
+
+	new_sz = RTE_MAX(*sz * 2, TRIE_DIRTY_MIN);
+	tmp = rte_realloc(*dirty, new_sz * sizeof(*tmp), 0);
+	if (tmp == NULL)
+		return -ENOMEM;
+	*dirty = tmp;
+	*sz = new_sz;
+	return 0;
+}
+
+static inline void
+dirty_set(struct rte_trie_dirty *d,
+	const uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE], uint8_t depth)
+{
+	rte_rib6_copy_addr(d->ip, ip);
+	d->depth = depth;
+}
+
+/* Return the most specific route covering the prefix, itself included */
+static struct rte_rib6_node *
+dirty_lookup_cover(struct rte_rib6 *rib,
+	const uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE], uint8_t depth)
+{
+	struct rte_rib6_node *node;
+	uint8_t node_depth;
+
+	node = rte_rib6_lookup(rib, ip);
+	while (node != NULL) {
+		rte_rib6_get_depth(node, &node_depth);
+		if (node_depth <= depth)
+			break;
+		node = rte_rib6_lookup_parent(node);
+	}
+	return node;
+}
+
+static int
+dirty_cmp(const void *p1, const void *p2)
+{
+	const struct rte_trie_dirty *d1 = p1;
+	const struct rte_trie_dirty *d2 = p2;
+	int ret;
+
+	ret = memcmp(d1->ip, d2->ip, RTE_FIB6_IPV6_ADDR_SIZE);
+	if (ret != 0)
+		return ret;
+	return d1->depth - d2->depth;
+}
+
+static inline int
+dirty_is_covered(const struct rte_trie_dirty *d,
+	const struct rte_trie_dirty *cover)
+{
+	int i;
+
+	for (i = 0; i < RTE_FIB6_IPV6_ADDR_SIZE; i++) {
+		if ((d->ip[i] & get_msk_part(cover->depth, i)) !=
+				cover->ip[i])
+			return 0;
+	}
+	return 1;
+}
+
+/* Free a tbl8 and the tbl8s linked from it */
+static void
+tbl8_free_tree(struct rte_trie_tbl *dp, uint64_t tbl8_idx)
+{
+	uint64_t val;
+	uint32_t i;
+
+	for (i = 0; i < TRIE_TBL8_GRP_NUM_ENT; i++) {
+		val = get_tbl_val_by_idx(dp->tbl8,
+			tbl8_idx * TRIE_TBL8_GRP_NUM_ENT + i, dp->nh_sz);
+		if (is_entry_extended(val))
+			tbl8_free_tree(dp, val >> 1);
+	}
+	tbl8_free(dp, tbl8_idx);
+}
+
+/*
+ * Free the tbl8s linked from an entry, or from the part of it within
+ * [ledge, redge]. The bytes of the addresses below the entry start at
+ * byte, lb and rb tell whether the entry holds ledge and redge.
+ */
+static void
+free_tbl8s_in_range(struct rte_trie_tbl *dp, uint64_t *tbl, uint64_t idx,
+	int byte, const uint8_t *ledge, const uint8_t *redge, int lb, int rb,
+	uint64_t next_hop)
+{
+	uint64_t val;
+	uint32_t i, first, last;
+
+	val = get_tbl_val_by_idx(tbl, idx, dp->nh_sz);
+	if (!is_entry_extended(val))
+		return;
+
+	lb = lb && !is_filled(&ledge[byte], 0, RTE_FIB6_IPV6_ADDR_SIZE - byte);
+	rb = rb && !is_filled(&redge[byte], UINT8_MAX,
+		RTE_FIB6_IPV6_ADDR_SIZE - byte);
+	if (!lb && !rb) {
+		/* Unlink the tbl8s before freeing them */
+		write_to_dp(get_tbl_p_by_idx(tbl, idx, dp->nh_sz),
+			next_hop << 1, dp->nh_sz, 1);
+		tbl8_free_tree(dp, val >> 1);
+		return;
+	}
+
+	first = lb ? ledge[byte] : 0;
+	last = rb ? redge[byte] : UINT8_MAX;
+	for (i = first; i <= last; i++)
+		free_tbl8s_in_range(dp, dp->tbl8,
+			(val >> 1) * TRIE_TBL8_GRP_NUM_ENT + i, byte + 1,
+			ledge, redge, lb && (i == first), rb && (i == last),
+			next_hop);
+}
+
+/*
+ * Same as install_to_dp, but the range may hold entries linking to the
+ * tbl8s of removed routes, release them first.
+ */
+static int
+install_gap(struct rte_trie_tbl *dp, const uint8_t *ledge, const uint8_t *r,
+	uint64_t next_hop)
+{
+	uint8_t redge[RTE_FIB6_IPV6_ADDR_SIZE];
+	uint32_t i, first, last;
+
+	/* decrement redge by 1*/
+	rte_rib6_copy_addr(redge, r);
+	for (i = RTE_FIB6_IPV6_ADDR_SIZE; i-- > 0; ) {
+		redge[i]--;
+		if (redge[i] != 0xff)
+			break;
+	}
+
+	first = get_tbl24_idx(ledge);
+	last = get_tbl24_idx(redge);
+	for (i = first; i <= last; i++)
+		free_tbl8s_in_range(dp, dp->tbl24, i, TBL24_BYTES, ledge,
+			redge, i == first, i == last, next_hop);
+
+	return install_to_dp(dp, ledge, r, next_hop);
+}
+
+/*
+ * Write the range of a prefix but the ranges of the prefixes it covers,
+ * which are on top of the stack, then replace them with the prefix.
+ */
+static int
+write_holes(struct rte_trie_tbl *dp, uint32_t *n,
+	const uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE], uint8_t depth,
+	uint64_t next_hop)
+{
+	struct rte_trie_dirty cur, *d;
+	uint8_t ledge[RTE_FIB6_IPV6_ADDR_SIZE];
+	uint8_t redge[RTE_FIB6_IPV6_ADDR_SIZE];
+	int ret;
+
+	dirty_set(&cur, ip, depth);
+	rte_rib6_copy_addr(redge, ip);
+	get_nxt_net(redge, depth);
+	while ((*n > 0) && (dp->stack[*n - 1].depth > depth) &&
+			dirty_is_covered(&dp->stack[*n - 1], &cur)) {
+		d = &dp->stack[--(*n)];
+		rte_rib6_copy_addr(ledge, d->ip);
+		get_nxt_net(ledge, d->depth);
+		if (!rte_rib6_is_equal(ledge, redge)) {
+			ret = install_gap(dp, ledge, redge, next_hop);
+			if (ret != 0)
+				return ret;
+		}
+		rte_rib6_copy_addr(redge, d->ip);
+	}
+	if (!rte_rib6_is_equal(ip, redge)) {
+		ret = install_gap(dp, ip, redge, next_hop);
+		if (ret != 0)
+			return ret;
+	}
+
+	ret = dirty_reserve(&dp->stack, &dp->stack_sz, *n + 1);
+	if (ret != 0)
+		return ret;
+	dp->stack[(*n)++] = cur;
+	return 0;
+}
+
+/*
+ * Rewrite the whole range of a prefix from the routes it covers. They are
+ * visited children first, so that each entry is written only once.
+ */
+static int
+rewrite_dp(struct rte_trie_tbl *dp, struct rte_rib6 *rib,
+	const uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE], uint8_t depth,
+	uint64_t next_hop)
+{
+	struct rte_rib6_node *node = NULL;
+	uint8_t node_ip[RTE_FIB6_IPV6_ADDR_SIZE];
+	uint8_t node_depth;
+	uint64_t node_nh;
+	uint32_t n = 0;
+	int ret;
+
+	while ((node = rte_rib6_get_nxt(rib, ip, depth, node,
+			RTE_RIB6_GET_NXT_ALL)) != NULL) {
+		rte_rib6_get_ip(node, node_ip);
+		rte_rib6_get_depth(node, &node_depth);
+		rte_rib6_get_nh(node, &node_nh);
+		ret = write_holes(dp, &n, node_ip, node_depth, node_nh);
+		if (ret != 0)
+			return ret;
+	}
+	return write_holes(dp, &n, ip, depth, next_hop);
+}
+
+/*
+ * Count the tbl8 groups the commit allocates, those missing on the path
+ * of each route longer than /24 recorded in the transaction, and make
+ * them available in one pass before anything is written, so that a lack
+ * of groups leaves the dataplane unchanged. The prefixes being sorted,
+ * the groups on the path of a previous route are counted only once.
+ * The groups freed by the commit itself are not counted.
+ */
+static int
+dirty_reserve_tbl8(struct rte_trie_tbl *dp, struct rte_rib6 *rib)
+{
+	const struct rte_trie_dirty *d, *path = NULL;
+	uint32_t i, need = 0, nb_free;
+	int lvl, nb_lvl, path_lvl = 0, shared, byte;
+	uint64_t val;
+
+	for (i = 0; i < dp->nb_dirty; i++) {
+		d = &dp->dirty[i];
+		if ((d->depth <= 24) || (rte_rib6_lookup_exact(rib, d->ip,
+				d->depth) == NULL))
+			continue;
+		/* One group for each byte of the prefix below the tbl24 */
+		nb_lvl = RTE_ALIGN_CEIL(d->depth, 8) / 8 - TBL24_BYTES;
+		val = get_tbl_val_by_idx(dp->tbl24, get_tbl24_idx(d->ip),
+			dp->nh_sz);
+		for (lvl = 0; (lvl < nb_lvl) && is_entry_extended(val);
+				lvl++)
+			val = get_tbl_val_by_idx(dp->tbl8,
+				(val >> 1) * TRIE_TBL8_GRP_NUM_ENT +
+				d->ip[TBL24_BYTES + lvl], dp->nh_sz);
+
+		/* The group of a level hangs from the bytes above it */
+		shared = 0;
+		if (path != NULL) {
+			for (byte = 0; byte < RTE_FIB6_IPV6_ADDR_SIZE;
+					byte++) {
+				if (d->ip[byte] != path->ip[byte])
+					break;
+			}
+			shared = RTE_MIN(byte - (TBL24_BYTES - 1), path_lvl);
+		}
+		if (nb_lvl > RTE_MAX(lvl, shared))
+			need += nb_lvl - RTE_MAX(lvl, shared);
+		/* Keep the deepest path the next routes may hang from */
+		if (shared < nb_lvl) {
+			path = d;
+			path_lvl = nb_lvl;
+		}
+	}
+
+	nb_free = dp->number_tbl8s - dp->tbl8_pool_pos;
+	if ((need > nb_free) && (dp->dq != NULL))
+		rte_rcu_qsbr_dq_reclaim(dp->dq, need - nb_free,
+			NULL, NULL, NULL);
+	if (need > dp->number_tbl8s - dp->tbl8_pool_pos)
+		return -ENOSPC;
+	return 0;
+}
+
+/*
+ * Rewrite the ranges of the recorded prefixes with the next hops of their
+ * longest match in the RIB. A prefix covering other recorded prefixes
+ * is rewritten along with all the routes it covers, in a single pass;
+ * otherwise only the part not covered by more specific routes is.
+ * With force, the prefixes which cannot be written are skipped and the
+ * transaction ends anyway, else they are kept for a retry.
+ */
+static int
+update_apply(struct rte_trie_tbl *dp, struct rte_rib6 *rib, int force)
+{
+	struct rte_trie_dirty *cover;
+	struct rte_rib6_node *node;
+	uint64_t next_hop;
+	uint32_t i, j;
+	int nested, ret, err;
+
+	qsort(dp->dirty, dp->nb_dirty, sizeof(*dp->dirty), dirty_cmp);
+	err = dirty_reserve_tbl8(dp, rib);
+	if ((err != 0) && !force)
+		return err;
+
+	for (i = 0; i < dp->nb_dirty; i = j) {
+		cover = &dp->dirty[i];
+		/* The prefixes it covers come next, skip them */
+		nested = 0;
+		for (j = i + 1; (j < dp->nb_dirty) &&
+				dirty_is_covered(&dp->dirty[j], cover); j++)
+			nested |= (dp->dirty[j].depth != cover->depth);
+
+		node = dirty_lookup_cover(rib, cover->ip, cover->depth);
+		if (node != NULL)
+			rte_rib6_get_nh(node, &next_hop);
+		else
+			next_hop = dp->def_nh;
+
+		if (nested)
+			ret = rewrite_dp(dp, rib, cover->ip, cover->depth,
+				next_hop);
+		else
+			ret = modify_dp(dp, rib, cover->ip, cover->depth,
+				next_hop);
+		if ((ret != 0) && force) {
+			err = (err != 0) ? err : ret;
+		} else if (ret != 0) {
+			/* Keep the prefixes not rewritten yet for a retry */
+			dp->nb_dirty -= i;
+			memmove(dp->dirty, cover,
+				dp->nb_dirty * sizeof(*dp->dirty));
+			return ret;
+		}
+	}
+
+	dp->nb_dirty = 0;
+	dp->in_update = 0;
+	return err;
+}
+
+int
+trie_update_begin(struct rte_trie_tbl *dp)
+{
+	if (dp->in_update)
+		return -EBUSY;
+	dp->in_update = 1;
+	return 0;
+}
+
+int
+trie_update_commit(struct rte_trie_tbl *dp, struct rte_rib6 *rib)
+{
+	if (!dp->in_update)
+		return -EINVAL;
+
+	return update_apply(dp, rib, 0);
+}
+
+int
+trie_update_end(struct rte_trie_tbl *dp, struct rte_rib6 *rib)
+{
+	if (!dp->in_update)
+		return -EINVAL;
+
+	return update_apply(dp, rib, 1);
+}
+
+/*
+ * Number of tbl8 groups reserved for a route not in the RIB: the levels
+ * it adds below its parent route, none if more specific routes already
+ * hold its groups.
+ */
+static uint8_t
+get_depth_diff(struct rte_rib6 *rib,
+	const uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE], uint8_t depth)
+{
+	struct rte_rib6_node *tmp;
+	uint8_t tmp_depth, parent_depth = 24;
+
+	if (depth <= 24)
+		return 0;
+
+	tmp = rte_rib6_get_nxt(rib, ip, RTE_ALIGN_FLOOR(depth, 8), NULL,
+		RTE_RIB6_GET_NXT_COVER);
+	if (tmp != NULL)
+		return 0;
+	tmp = rte_rib6_lookup(rib, ip);
+	if (tmp != NULL) {
+		rte_rib6_get_depth(tmp, &tmp_depth);
+		parent_depth = RTE_MAX(tmp_depth, 24);
+	}
+	return (RTE_ALIGN_CEIL(depth, 8) -
+		RTE_ALIGN_CEIL(parent_depth, 8)) >> 3;
+}
+
 int
 trie_modify(struct rte_fib6 *fib, const uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE],
 	uint8_t depth, uint64_t next_hop, int op)
 {
 	struct rte_trie_tbl *dp;
 	struct rte_rib6 *rib;
-	struct rte_rib6_node *tmp = NULL;
 	struct rte_rib6_node *node;
 	struct rte_rib6_node *parent;
 	uint8_t	ip_masked[RTE_FIB6_IPV6_ADDR_SIZE];
 	int i, ret = 0;
 	uint64_t par_nh, node_nh;
-	uint8_t tmp_depth, depth_diff = 0, parent_depth = 24;
+	uint8_t depth_diff;
 
 	if ((fib == NULL) || (ip == NULL) || (depth > RTE_FIB6_MAXDEPTH))
 		return -EINVAL;
@@ -529,21 +996,6 @@ trie_modify(struct rte_fib6 *fib, const uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE],
 	for (i = 0; i < RTE_FIB6_IPV6_ADDR_SIZE; i++)
 		ip_masked[i] = ip[i] & get_msk_part(depth, i);
 
-	if (depth > 24) {
-		tmp = rte_rib6_get_nxt(rib, ip_masked,
-			RTE_ALIGN_FLOOR(depth, 8), NULL,
-			RTE_RIB6_GET_NXT_COVER);
-		if (tmp == NULL) {
-			tmp = rte_rib6_lookup(rib, ip);
-			if (tmp != NULL) {
-				rte_rib6_get_depth(tmp, &tmp_depth);
-				parent_depth = RTE_MAX(tmp_depth, 24);
-			}
-			depth_diff = RTE_ALIGN_CEIL(depth, 8) -
-				RTE_ALIGN_CEIL(parent_depth, 8);
-			depth_diff = depth_diff >> 3;
-		}
-	}
 	node = rte_rib6_lookup_exact(rib, ip_masked, depth);
 	switch (op) {
 	case RTE_FIB6_ADD:
@@ -551,20 +1003,43 @@ trie_modify(struct rte_fib6 *fib, const uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE],
 			rte_rib6_get_nh(node, &node_nh);
 			if (node_nh == next_hop)
 				return 0;
+			if (dp->in_update) {
+				ret = dirty_reserve(&dp->dirty, &dp->dirty_sz,
+					dp->nb_dirty + 1);
+				if (ret != 0)
+					return ret;
+				dirty_set(&dp->dirty[dp->nb_dirty++],
+					ip_masked, depth);
+				rte_rib6_set_nh(node, next_hop);
+				return 0;
+			}
 			ret = modify_dp(dp, rib, ip_masked, depth, next_hop);
 			if (ret == 0)
 				rte_rib6_set_nh(node, next_hop);
 			return 0;
 		}
 
+		depth_diff = get_depth_diff(rib, ip_masked, depth);
 		if ((depth > 24) && (dp->rsvd_tbl8s >=
 				dp->number_tbl8s - depth_diff))
 			return -ENOSPC;
 
+		if (dp->in_update) {
+			ret = dirty_reserve(&dp->dirty, &dp->dirty_sz,
+				dp->nb_dirty + 1);
+			if (ret != 0)
+				return ret;
+		}
 		node = rte_rib6_insert(rib, ip_masked, depth);
 		if (node == NULL)
 			return -rte_errno;
 		rte_rib6_set_nh(node, next_hop);
+		if (dp->in_update) {
+			dirty_set(&dp->dirty[dp->nb_dirty++], ip_masked,
+				depth);
+			dp->rsvd_tbl8s += depth_diff;
+			return 0;
+		}
 		parent = rte_rib6_lookup_parent(node);
 		if (parent != NULL) {
 			rte_rib6_get_nh(parent, &par_nh);
@@ -583,21 +1058,31 @@ trie_modify(struct rte_fib6 *fib, const uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE],
 		if (node == NULL)
 			return -ENOENT;
 
-		parent = rte_rib6_lookup_parent(node);
-		if (parent != NULL) {
-			rte_rib6_get_nh(parent, &par_nh);
-			rte_rib6_get_nh(node, &node_nh);
-			if (par_nh != node_nh)
+		if (dp->in_update) {
+			ret = dirty_reserve(&dp->dirty, &dp->dirty_sz,
+				dp->nb_dirty + 1);
+			if (ret == 0)
+				dirty_set(&dp->dirty[dp->nb_dirty++],
+					ip_masked, depth);
+		} else {
+			parent = rte_rib6_lookup_parent(node);
+			if (parent != NULL) {
+				rte_rib6_get_nh(parent, &par_nh);
+				rte_rib6_get_nh(node, &node_nh);
+				if (par_nh != node_nh)
+					ret = modify_dp(dp, rib, ip_masked,
+						depth, par_nh);
+			} else
 				ret = modify_dp(dp, rib, ip_masked, depth,
-					par_nh);
-		} else
-			ret = modify_dp(dp, rib, ip_masked, depth, dp->def_nh);
+					dp->def_nh);
+		}
 
 		if (ret != 0)
 			return ret;
 		rte_rib6_remove(rib, ip, depth);
 
-		dp->rsvd_tbl8s -= depth_diff;
+		/* Once removed, so that the route does not cover itself */
+		dp->rsvd_tbl8s -= get_depth_diff(rib, ip_masked, depth);
 		return 0;
 	default:
 		break;
@@ -677,7 +1162,57 @@ trie_free(void *p)
 {
 	struct rte_trie_tbl *dp = (struct rte_trie_tbl *)p;
 
+	if (dp->dq != NULL)
+		rte_rcu_qsbr_dq_delete(dp->dq);
+	rte_free(dp->dirty);
+	rte_free(dp->stack);
 	rte_free(dp->tbl8_pool);
 	rte_free(dp->tbl8);
 	rte_free(dp);
 }
+
+int
+trie_rcu_qsbr_add(struct rte_trie_tbl *dp, struct rte_fib6_rcu_config *cfg,
+	const char *name)
+{
+	struct rte_rcu_qsbr_dq_parameters params = {0};
+	char rcu_dq_name[RTE_RCU_QSBR_DQ_NAMESIZE];
+
+	if (dp == NULL || cfg == NULL || cfg->v == NULL)
+		return -EINVAL;
+
+	if (dp->v != NULL)
+		return -EEXIST;
+
+	if (cfg->mode == RTE_FIB6_QSBR_MODE_SYNC) {
+		/* No other things to do. */
+	} else if (cfg->mode == RTE_FIB6_QSBR_MODE_DQ) {
+		/* Init QSBR defer queue. */
+		snprintf(rcu_dq_name, sizeof(rcu_dq_name),
+				"FIB6_RCU_%s", name);
+		params.name = rcu_dq_name;
+		params.size = cfg->dq_size;
+		if (params.size == 0)
+			params.size = dp->number_tbl8s;
+		params.trigger_reclaim_limit = cfg->reclaim_thd;
+		params.max_reclaim_size = cfg->reclaim_max;
+		if (params.max_reclaim_size == 0)
+			params.max_reclaim_size = RTE_FIB6_RCU_DQ_RECLAIM_MAX;
+		params.esize = sizeof(uint64_t);	/* tbl8 index */
+		params.free_fn = __rcu_qsbr_free_resource;
+		params.p = dp;
+		params.v = cfg->v;
+		dp->dq = rte_rcu_qsbr_dq_create(&params);
+		if (dp->dq == NULL) {
+			RTE_LOG(ERR, LPM, "FIB6 defer queue creation failed\n");
+			return -rte_errno;
+		}
+	} else {
+		return -EINVAL;
+	}
+
+	dp->rcu_mode = cfg->mode;
+	dp->v = cfg->v;
+
+	return 0;
+}
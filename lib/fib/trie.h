@@ -28,6 +28,15 @@
 #define BITMAP_SLAB_BIT_SIZE		(1ULL << BITMAP_SLAB_BIT_SIZE_LOG2)
 #define BITMAP_SLAB_BITMASK		(BITMAP_SLAB_BIT_SIZE - 1)
 
+/* Initial size of the arrays of prefixes used by update transactions */
+#define TRIE_DIRTY_MIN		64U
+
+/* Prefix of an update transaction */
+struct rte_trie_dirty {
+	uint8_t		ip[RTE_FIB6_IPV6_ADDR_SIZE];
+	uint8_t		depth;
+};
+
 struct rte_trie_tbl {
 	uint32_t	number_tbl8s;	/**< Total number of tbl8s */
 	uint32_t	rsvd_tbl8s;	/**< Number of reserved tbl8s */
@@ -37,6 +46,15 @@ struct rte_trie_tbl {
 	uint64_t	*tbl8;		/**< tbl8 table. */
 	uint32_t	*tbl8_pool;	/**< bitmap containing free tbl8 idxes*/
 	uint32_t	tbl8_pool_pos;
+	struct rte_rcu_qsbr		*v;	/**< RCU QSBR variable */
+	enum rte_fib6_qsbr_mode		rcu_mode; /**< Blocking, defer queue */
+	struct rte_rcu_qsbr_dq		*dq;	/**< RCU QSBR defer queue */
+	struct rte_trie_dirty	*dirty;	/**< Prefixes to rewrite on commit */
+	uint32_t	nb_dirty;	/**< Number of recorded prefixes */
+	uint32_t	dirty_sz;	/**< Size of the dirty array */
+	struct rte_trie_dirty	*stack;	/**< Prefixes pending during commit */
+	uint32_t	stack_sz;	/**< Size of the stack array */
+	uint8_t		in_update;	/**< Update transaction in progress */
 	/* tbl24 table. */
 	__extension__ uint64_t	tbl24[0] __rte_cache_aligned;
 };
@@ -141,4 +159,17 @@ int
 trie_modify(struct rte_fib6 *fib, const uint8_t ip[RTE_FIB6_IPV6_ADDR_SIZE],
 	uint8_t depth, uint64_t next_hop, int op);
 
+int
+trie_rcu_qsbr_add(struct rte_trie_tbl *dp, struct rte_fib6_rcu_config *cfg,
+	const char *name);
+
+int
+trie_update_begin(struct rte_trie_tbl *dp);
+
+int
+trie_update_commit(struct rte_trie_tbl *dp, struct rte_rib6 *rib);
+
+int
+trie_update_end(struct rte_trie_tbl *dp, struct rte_rib6 *rib);
+
 #endif /* _TRIE_H_ */
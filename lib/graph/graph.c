@@ -176,15 +176,20 @@ static int
 graph_node_init(struct graph *graph)
 {
 	struct graph_node *graph_node;
+	struct rte_graph *instance;
 	const char *name;
+	uint16_t i;
 	int rc;
 
-	STAILQ_FOREACH(graph_node, &graph->node_list, next) {
-		if (graph_node->node->init) {
+	for (i = 0; i < graph->nb_instances; i++) {
+		instance = graph->instances[i];
+		STAILQ_FOREACH(graph_node, &graph->node_list, next) {
+			if (graph_node->node->init == NULL)
+				continue;
+
 			name = graph_node->node->name;
 			rc = graph_node->node->init(
-				graph->graph,
-				graph_node_name_to_ptr(graph->graph, name));
+				instance, graph_node_name_to_ptr(instance, name));
 			if (rc)
 				SET_ERR_JMP(rc, err, "Node %s init() failed",
 					    name);
@@ -200,13 +205,18 @@ static void
 graph_node_fini(struct graph *graph)
 {
 	struct graph_node *graph_node;
+	struct rte_graph *instance;
+	uint16_t i;
 
-	STAILQ_FOREACH(graph_node, &graph->node_list, next)
-		if (graph_node->node->fini)
-			graph_node->node->fini(
-				graph->graph,
-				graph_node_name_to_ptr(graph->graph,
-						       graph_node->node->name));
+	for (i = 0; i < graph->nb_instances; i++) {
+		instance = graph->instances[i];
+		STAILQ_FOREACH(graph_node, &graph->node_list, next)
+			if (graph_node->node->fini)
+				graph_node->node->fini(
+					instance,
+					graph_node_name_to_ptr(instance,
+						graph_node->node->name));
+	}
 }
 
 static struct rte_graph *
@@ -238,10 +248,22 @@ graph_mem_fixup_node_ctx(struct rte_graph *graph)
 static struct rte_graph *
 graph_mem_fixup_secondary(struct rte_graph *graph)
 {
+	struct rte_graph **lcore_instances;
+	unsigned int lcore_id;
+
 	if (graph == NULL || rte_eal_process_type() == RTE_PROC_PRIMARY)
 		return graph;
 
-	return graph_mem_fixup_node_ctx(graph);
+	if (graph->model != RTE_GRAPH_MODEL_MCORE_DISPATCH)
+		return graph_mem_fixup_node_ctx(graph);
+
+	lcore_instances = graph->dispatch->lcore_instances;
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
+		if (lcore_instances[lcore_id] != NULL &&
+		    graph_mem_fixup_node_ctx(lcore_instances[lcore_id]) == NULL)
+			return NULL;
+
+	return graph;
 }
 
 struct rte_graph *
@@ -271,6 +293,10 @@ rte_graph_create(const char *name, struct rte_graph_param *prm)
 	if (prm == NULL)
 		SET_ERR_JMP(EINVAL, fail, "Param should not be NULL");
 
+	if (prm->model != RTE_GRAPH_MODEL_RTC &&
+	    prm->model != RTE_GRAPH_MODEL_MCORE_DISPATCH)
+		SET_ERR_JMP(EINVAL, fail, "Invalid graph model %u", prm->model);
+
 	if (name == NULL)
 		SET_ERR_JMP(EINVAL, fail, "Graph name should not be NULL");
 
@@ -322,19 +348,32 @@ rte_graph_create(const char *name, struct rte_graph_param *prm)
 	if (graph_has_isolated_node(graph))
 		goto graph_cleanup;
 
+	/* Affinitize the nodes to lcores for the dispatch model */
+	if (prm->model == RTE_GRAPH_MODEL_MCORE_DISPATCH &&
+	    graph_dispatch_lcores_resolve(graph, prm))
+		goto graph_cleanup;
+
 	/* Initialize graph object */
 	graph->socket = prm->socket_id;
 	graph->src_node_count = src_node_count;
 	graph->node_count = graph_nodes_count(graph);
 	graph->id = graph_id;
+	graph->model = prm->model;
 
 	/* Allocate the Graph fast path memory and populate the data */
 	if (graph_fp_mem_create(graph))
 		goto graph_cleanup;
+	graph->instances = &graph->graph;
+	graph->nb_instances = 1;
+
+	/* Spread the graph over its lcores for the dispatch model */
+	if (graph->model == RTE_GRAPH_MODEL_MCORE_DISPATCH &&
+	    graph_dispatch_create(graph, prm))
+		goto graph_mem_destroy;
 
 	/* Call init() of the all the nodes in the graph */
 	if (graph_node_init(graph))
-		goto graph_mem_destroy;
+		goto graph_dispatch_destroy;
 
 	/* All good, Lets add the graph to the list */
 	graph_id++;
@@ -343,6 +382,8 @@ rte_graph_create(const char *name, struct rte_graph_param *prm)
 	graph_spinlock_unlock();
 	return graph->id;
 
+graph_dispatch_destroy:
+	graph_dispatch_destroy(graph);
 graph_mem_destroy:
 	graph_fp_mem_destroy(graph);
 graph_cleanup:
@@ -368,6 +409,8 @@ rte_graph_destroy(rte_graph_t id)
 		if (graph->id == id) {
 			/* Call fini() of the all the nodes in the graph */
 			graph_node_fini(graph);
+			/* Destroy dispatch model instances and rings */
+			graph_dispatch_destroy(graph);
 			/* Destroy graph fast path memory */
 			rc = graph_fp_mem_destroy(graph);
 			if (rc)
@@ -22,9 +22,17 @@ graph_dump(FILE *f, struct graph *g)
 	fprintf(f, "  mem_sz=%zu\n", g->mem_sz);
 	fprintf(f, "  node_count=%" PRIu32 "\n", g->node_count);
 	fprintf(f, "  src_node_count=%" PRIu32 "\n", g->src_node_count);
+	fprintf(f, "  model=%u\n", g->model);
+	fprintf(f, "  nb_instances=%u\n", g->nb_instances);
 
-	STAILQ_FOREACH(graph_node, &g->node_list, next)
-		fprintf(f, "     node[%d] <%s>\n", i++, graph_node->node->name);
+	STAILQ_FOREACH(graph_node, &g->node_list, next) {
+		if (g->model == RTE_GRAPH_MODEL_MCORE_DISPATCH)
+			fprintf(f, "     node[%d] <%s> lcore=%u\n", i++,
+				graph_node->node->name, graph_node->lcore_id);
+		else
+			fprintf(f, "     node[%d] <%s>\n", i++,
+				graph_node->node->name);
+	}
 }
 
 void
@@ -53,6 +61,7 @@ rte_graph_obj_dump(FILE *f, struct rte_graph *g, bool all)
 
 	fprintf(f, "graph <%s> @ %p\n", g->name, g);
 	fprintf(f, "  id=%" PRIu32 "\n", g->id);
+	fprintf(f, "  model=%u\n", g->model);
 	fprintf(f, "  head=%" PRId32 "\n", (int32_t)g->head);
 	fprintf(f, "  tail=%" PRId32 "\n", (int32_t)g->tail);
 	fprintf(f, "  cir_mask=0x%" PRIx32 "\n", g->cir_mask);
@@ -77,6 +86,13 @@ rte_graph_obj_dump(FILE *f, struct rte_graph *g, bool all)
 		fprintf(f, "       idx=%d\n", n->idx);
 		fprintf(f, "       total_objs=%" PRId64 "\n", n->total_objs);
 		fprintf(f, "       total_calls=%" PRId64 "\n", n->total_calls);
+		if (g->model == RTE_GRAPH_MODEL_MCORE_DISPATCH) {
+			fprintf(f, "       lcore_id=%u\n", n->lcore_id);
+			fprintf(f, "       dispatch_objs=%" PRId64 "\n",
+				n->dispatch_objs);
+			fprintf(f, "       dispatch_full=%" PRId64 "\n",
+				n->dispatch_full);
+		}
 		for (i = 0; i < n->nb_edges; i++)
 			fprintf(f, "          edge[%d] <%s>\n", i,
 				n->nodes[i]->name);
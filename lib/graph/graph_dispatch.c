@@ -0,0 +1,410 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(C) 2020 Marvell International Ltd.
+ */
+
+#include <fnmatch.h>
+#include <stdbool.h>
+
+#include <rte_common.h>
+#include <rte_errno.h>
+#include <rte_lcore.h>
+#include <rte_malloc.h>
+#include <rte_ring.h>
+
+#include "graph_private.h"
+
+int
+graph_dispatch_lcores_resolve(struct graph *graph,
+			      const struct rte_graph_param *prm)
+{
+	const struct rte_graph_node_lcore *affinity;
+	struct graph_node *graph_node;
+	const char *name;
+	uint16_t i;
+
+	if (prm->nb_node_lcores == 0 || prm->node_lcores == NULL)
+		SET_ERR_JMP(EINVAL, fail, "No node lcore affinity for graph %s",
+			    graph->name);
+
+	for (i = 0; i < prm->nb_node_lcores; i++) {
+		affinity = &prm->node_lcores[i];
+		if (affinity->node_pattern == NULL ||
+		    affinity->lcore_id >= RTE_MAX_LCORE ||
+		    !rte_lcore_is_enabled(affinity->lcore_id))
+			SET_ERR_JMP(EINVAL, fail, "Invalid affinity %u", i);
+	}
+
+	STAILQ_FOREACH(graph_node, &graph->node_list, next) {
+		name = graph_node->node->name;
+		for (i = 0; i < prm->nb_node_lcores; i++) {
+			affinity = &prm->node_lcores[i];
+			if (fnmatch(affinity->node_pattern, name, 0) == 0)
+				break;
+		}
+		if (i == prm->nb_node_lcores)
+			SET_ERR_JMP(EINVAL, fail, "Node %s has no lcore affinity",
+				    name);
+
+		graph_node->lcore_id = affinity->lcore_id;
+	}
+
+	return 0;
+fail:
+	return -rte_errno;
+}
+
+static int
+dispatch_instances_create(struct graph *graph)
+{
+	struct rte_graph **lcore_instances;
+	struct graph_node *graph_node;
+	struct rte_graph *instance;
+	unsigned int lcore_id;
+	uint16_t nb = 0;
+
+	lcore_instances = rte_zmalloc_socket(NULL,
+			sizeof(struct rte_graph *) * RTE_MAX_LCORE,
+			RTE_CACHE_LINE_SIZE, graph->socket);
+	if (lcore_instances == NULL)
+		SET_ERR_JMP(ENOMEM, fail, "Failed to alloc lcore instances");
+
+	graph->instances = calloc(RTE_MAX_LCORE, sizeof(struct rte_graph *));
+	if (graph->instances == NULL)
+		SET_ERR_JMP(ENOMEM, free, "Failed to calloc instances");
+
+	STAILQ_FOREACH(graph_node, &graph->node_list, next)
+		lcore_instances[graph_node->lcore_id] = graph->graph;
+
+	/* Lowest lcore walks the memzone backed graph, others a clone */
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		if (lcore_instances[lcore_id] == NULL)
+			continue;
+
+		instance = nb ? graph_fp_mem_clone(graph) : graph->graph;
+		if (instance == NULL)
+			goto instances_free;
+
+		lcore_instances[lcore_id] = instance;
+		graph->instances[nb++] = instance;
+	}
+
+	graph->nb_instances = nb;
+	graph->lcore_instances = lcore_instances;
+	return 0;
+
+instances_free:
+	while (--nb > 0)
+		graph_fp_mem_clone_destroy(graph->instances[nb]);
+	free(graph->instances);
+free:
+	rte_free(lcore_instances);
+	graph->instances = &graph->graph;
+fail:
+	return -rte_errno;
+}
+
+static void
+dispatch_src_nodes_filter(struct rte_graph *graph, unsigned int lcore_id)
+{
+	int32_t head = (int32_t)graph->head;
+	int32_t local = -1;
+	struct rte_node *node;
+	int32_t i;
+
+	/* Keep only the source nodes walked by this lcore */
+	for (i = -1; i >= head; i--) {
+		node = RTE_PTR_ADD(graph, graph->cir_start[i]);
+		if (node->lcore_id == lcore_id)
+			graph->cir_start[local--] = node->off;
+	}
+	graph->head = (uint32_t)(local + 1);
+}
+
+static struct rte_ring *
+dispatch_ring_create(struct graph *graph, struct rte_node *node,
+		     unsigned int lcore_id, uint32_t ring_size)
+{
+	char name[RTE_RING_NAMESIZE];
+	struct rte_ring *ring;
+
+	snprintf(name, sizeof(name), "gdisp_%u_%u_%u", graph->id, node->id,
+		 lcore_id);
+	ring = rte_ring_create(name, ring_size, graph->socket,
+			       RING_F_SP_ENQ | RING_F_SC_DEQ);
+	if (ring == NULL)
+		SET_ERR_JMP(rte_errno, fail, "Failed to create ring %s", name);
+
+	return ring;
+fail:
+	return NULL;
+}
+
+static int
+dispatch_rings_create(struct graph *graph, uint32_t ring_size)
+{
+	struct rte_graph **lcore_instances = graph->lcore_instances;
+	struct graph_node *graph_node, *adjacency;
+	struct rte_graph_dispatch *dst_dispatch;
+	struct rte_graph_dispatch *dispatch;
+	struct rte_node *node, *dst_node;
+	struct graph_dispatch_inbound *in;
+	rte_edge_t i;
+
+	/* One SPSC ring per edge crossing lcores, shared by all such edges
+	 * of a lcore pointing to the same node.
+	 */
+	STAILQ_FOREACH(graph_node, &graph->node_list, next) {
+		dispatch = lcore_instances[graph_node->lcore_id]->dispatch;
+		for (i = 0; i < graph_node->node->nb_edges; i++) {
+			adjacency = graph_node->adjacency_list[i];
+			if (adjacency->lcore_id == graph_node->lcore_id)
+				continue;
+
+			node = graph_node_name_to_ptr(
+				lcore_instances[graph_node->lcore_id],
+				adjacency->node->name);
+			if (node->dispatch_ring != NULL)
+				continue;
+
+			node->dispatch_ring = dispatch_ring_create(graph, node,
+					graph_node->lcore_id, ring_size);
+			if (node->dispatch_ring == NULL)
+				goto fail;
+			dispatch->remote[dispatch->nb_remote++] = node;
+
+			dst_dispatch =
+				lcore_instances[adjacency->lcore_id]->dispatch;
+			dst_node = graph_node_name_to_ptr(
+				lcore_instances[adjacency->lcore_id],
+				adjacency->node->name);
+			in = &dst_dispatch->inbound[dst_dispatch->nb_inbound++];
+			in->ring = node->dispatch_ring;
+			in->node = dst_node;
+		}
+	}
+
+	return 0;
+fail:
+	return -rte_errno;
+}
+
+static void
+dispatch_rings_destroy(struct graph *graph)
+{
+	struct rte_graph *instance;
+	struct rte_node *node;
+	rte_graph_off_t off;
+	rte_node_t count;
+	uint16_t i;
+
+	for (i = 0; i < graph->nb_instances; i++) {
+		instance = graph->instances[i];
+		rte_graph_foreach_node(count, off, instance, node) {
+			rte_ring_free(node->dispatch_ring);
+			node->dispatch_ring = NULL;
+		}
+	}
+}
+
+int
+graph_dispatch_create(struct graph *graph, const struct rte_graph_param *prm)
+{
+	uint32_t ring_size = prm->dispatch_ring_size;
+	struct rte_graph_dispatch *dispatch;
+	struct rte_graph *instance;
+	unsigned int lcore_id;
+	size_t sz;
+	uint16_t i;
+
+	if (ring_size == 0)
+		ring_size = RTE_GRAPH_DISPATCH_RING_SZ;
+
+	if (dispatch_instances_create(graph))
+		goto fail;
+
+	/* Enough room for an inbound ring per node and remote lcore */
+	sz = sizeof(struct rte_graph_dispatch);
+	sz += sizeof(struct graph_dispatch_inbound) * graph->node_count *
+	      graph->nb_instances;
+	for (i = 0; i < graph->nb_instances; i++) {
+		dispatch = rte_zmalloc_socket(NULL,
+				sz + sizeof(struct rte_node *) *
+				graph->node_count,
+				RTE_CACHE_LINE_SIZE, graph->socket);
+		if (dispatch == NULL)
+			SET_ERR_JMP(ENOMEM, destroy,
+				    "Failed to alloc dispatch state");
+
+		dispatch->lcore_instances = graph->lcore_instances;
+		dispatch->remote = RTE_PTR_ADD(dispatch, sz);
+		graph->instances[i]->dispatch = dispatch;
+	}
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		instance = graph->lcore_instances[lcore_id];
+		if (instance == NULL)
+			continue;
+
+		instance->dispatch->lcore_id = lcore_id;
+		instance->model = RTE_GRAPH_MODEL_MCORE_DISPATCH;
+		dispatch_src_nodes_filter(instance, lcore_id);
+	}
+
+	if (dispatch_rings_create(graph, ring_size))
+		goto destroy;
+
+	return 0;
+
+destroy:
+	graph_dispatch_destroy(graph);
+fail:
+	return -rte_errno;
+}
+
+void
+graph_dispatch_destroy(struct graph *graph)
+{
+	struct rte_graph *instance;
+	uint16_t i;
+
+	if (graph->lcore_instances == NULL)
+		return;
+
+	dispatch_rings_destroy(graph);
+	for (i = 0; i < graph->nb_instances; i++) {
+		instance = graph->instances[i];
+		rte_free(instance->dispatch);
+		instance->dispatch = NULL;
+		if (i != 0)
+			graph_fp_mem_clone_destroy(instance);
+	}
+
+	rte_free(graph->lcore_instances);
+	graph->lcore_instances = NULL;
+	free(graph->instances);
+	graph->instances = &graph->graph;
+	graph->nb_instances = 1;
+}
+
+static __rte_always_inline void
+dispatch_inbound_drain(struct rte_graph *graph,
+		       struct rte_graph_dispatch *dispatch)
+{
+	struct graph_dispatch_inbound *in;
+	struct rte_node *node;
+	unsigned int n;
+	uint16_t idx;
+	uint32_t i;
+
+	for (i = 0; i < dispatch->nb_inbound; i++) {
+		in = &dispatch->inbound[i];
+		node = in->node;
+		idx = node->idx;
+		if (unlikely(idx > UINT16_MAX - RTE_GRAPH_BURST_SIZE))
+			continue;
+
+		if (unlikely(node->size < idx + RTE_GRAPH_BURST_SIZE))
+			__rte_node_stream_alloc_size(graph, node,
+						     idx + RTE_GRAPH_BURST_SIZE);
+
+		n = rte_ring_sc_dequeue_burst(in->ring, &node->objs[idx],
+					      RTE_GRAPH_BURST_SIZE, NULL);
+		if (n == 0)
+			continue;
+
+		if (idx == 0)
+			__rte_node_enqueue_tail_update(graph, node);
+		node->idx = idx + n;
+	}
+}
+
+static __rte_always_inline void
+dispatch_node_handoff(struct rte_graph_dispatch *dispatch,
+		      struct rte_node *node)
+{
+	const uint16_t idx = node->idx;
+	unsigned int n;
+
+	n = rte_ring_sp_enqueue_burst(node->dispatch_ring, node->objs, idx,
+				      NULL);
+	node->dispatch_objs += n;
+	if (likely(n == idx)) {
+		node->idx = 0;
+		return;
+	}
+
+	/* Keep the rest for the next walk, the ring is full */
+	memmove(node->objs, &node->objs[n], (idx - n) * sizeof(void *));
+	node->idx = idx - n;
+	node->dispatch_full++;
+	dispatch->nb_stalled++;
+}
+
+void
+__rte_graph_mcore_dispatch_walk(struct rte_graph *graph)
+{
+	struct rte_graph_dispatch *dispatch = graph->dispatch;
+	const rte_graph_off_t *cir_start;
+	struct rte_node *node;
+	rte_node_t mask;
+	uint64_t start;
+	uint32_t head;
+	uint32_t i;
+	uint16_t rc;
+	unsigned int lcore_id;
+	void **objs;
+
+	/* Non-EAL threads have no instance of a dispatch graph */
+	lcore_id = rte_lcore_id();
+	if (unlikely(lcore_id >= RTE_MAX_LCORE))
+		return;
+
+	graph = dispatch->lcore_instances[lcore_id];
+	if (unlikely(graph == NULL))
+		return;
+
+	dispatch = graph->dispatch;
+	cir_start = graph->cir_start;
+	mask = graph->cir_mask;
+	head = graph->head;
+
+	dispatch_inbound_drain(graph, dispatch);
+
+	while (likely(head != graph->tail)) {
+		node = RTE_PTR_ADD(graph, cir_start[(int32_t)head++]);
+		RTE_ASSERT(node->fence == RTE_GRAPH_FENCE);
+
+		if (node->lcore_id != dispatch->lcore_id) {
+			dispatch_node_handoff(dispatch, node);
+			head = likely((int32_t)head > 0) ? head & mask : head;
+			continue;
+		}
+
+		objs = node->objs;
+		rte_prefetch0(objs);
+
+		if (rte_graph_has_stats_feature()) {
+			start = rte_rdtsc();
+			rc = node->process(graph, node, objs, node->idx);
+			node->total_cycles += rte_rdtsc() - start;
+			node->total_calls++;
+			node->total_objs += rc;
+		} else {
+			node->process(graph, node, objs, node->idx);
+		}
+		node->idx = 0;
+		head = likely((int32_t)head > 0) ? head & mask : head;
+	}
+	graph->tail = 0;
+
+	if (likely(dispatch->nb_stalled == 0))
+		return;
+
+	/* Retry the handoffs left behind by a full ring on the next walk */
+	for (i = 0; i < dispatch->nb_remote; i++) {
+		node = dispatch->remote[i];
+		if (node->idx != 0)
+			__rte_node_enqueue_tail_update(graph, node);
+	}
+	dispatch->nb_stalled = 0;
+}
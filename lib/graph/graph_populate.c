@@ -46,10 +46,8 @@ graph_fp_mem_calc_size(struct graph *graph)
 }
 
 static void
-graph_header_popluate(struct graph *_graph)
+graph_header_popluate(struct graph *_graph, struct rte_graph *graph)
 {
-	struct rte_graph *graph = _graph->graph;
-
 	graph->tail = 0;
 	graph->head = (int32_t)-_graph->src_node_count;
 	graph->cir_mask = _graph->cir_mask;
@@ -58,15 +56,15 @@ graph_header_popluate(struct graph *_graph)
 	graph->nodes_start = _graph->nodes_start;
 	graph->socket = _graph->socket;
 	graph->id = _graph->id;
+	graph->model = RTE_GRAPH_MODEL_RTC;
 	memcpy(graph->name, _graph->name, RTE_GRAPH_NAMESIZE);
 	graph->fence = RTE_GRAPH_FENCE;
 }
 
 static void
-graph_nodes_populate(struct graph *_graph)
+graph_nodes_populate(struct graph *_graph, struct rte_graph *graph)
 {
 	rte_graph_off_t off = _graph->nodes_start;
-	struct rte_graph *graph = _graph->graph;
 	struct graph_node *graph_node;
 	rte_edge_t count, nb_edges;
 	const char *parent;
@@ -86,6 +84,7 @@ graph_nodes_populate(struct graph *_graph)
 		}
 		node->id = graph_node->node->id;
 		node->parent_id = pid;
+		node->lcore_id = graph_node->lcore_id;
 		nb_edges = graph_node->node->nb_edges;
 		node->nb_edges = nb_edges;
 		off += sizeof(struct rte_node);
@@ -131,12 +130,11 @@ graph_node_name_to_ptr(const struct rte_graph *graph, const char *name)
 }
 
 static int
-graph_node_nexts_populate(struct graph *_graph)
+graph_node_nexts_populate(const struct rte_graph *graph)
 {
 	rte_node_t count, val;
 	rte_graph_off_t off;
 	struct rte_node *node;
-	const struct rte_graph *graph = _graph->graph;
 	const char *name;
 
 	rte_graph_foreach_node(count, off, graph, node) {
@@ -154,9 +152,8 @@ graph_node_nexts_populate(struct graph *_graph)
 }
 
 static int
-graph_src_nodes_populate(struct graph *_graph)
+graph_src_nodes_populate(struct graph *_graph, struct rte_graph *graph)
 {
-	struct rte_graph *graph = _graph->graph;
 	struct graph_node *graph_node;
 	struct rte_node *node;
 	int32_t head = -1;
@@ -180,14 +177,14 @@ graph_src_nodes_populate(struct graph *_graph)
 }
 
 static int
-graph_fp_mem_populate(struct graph *graph)
+graph_fp_mem_populate(struct graph *_graph, struct rte_graph *graph)
 {
 	int rc;
 
-	graph_header_popluate(graph);
-	graph_nodes_populate(graph);
+	graph_header_popluate(_graph, graph);
+	graph_nodes_populate(_graph, graph);
 	rc = graph_node_nexts_populate(graph);
-	rc |= graph_src_nodes_populate(graph);
+	rc |= graph_src_nodes_populate(_graph, graph);
 
 	return rc;
 }
@@ -207,7 +204,7 @@ graph_fp_mem_create(struct graph *graph)
 	graph->graph = mz->addr;
 	graph->mz = mz;
 
-	return graph_fp_mem_populate(graph);
+	return graph_fp_mem_populate(graph, graph->graph);
 fail:
 	return -rte_errno;
 }
@@ -232,3 +229,31 @@ graph_fp_mem_destroy(struct graph *graph)
 	graph_nodes_mem_destroy(graph->graph);
 	return rte_memzone_free(graph->mz);
 }
+
+struct rte_graph *
+graph_fp_mem_clone(struct graph *graph)
+{
+	struct rte_graph *clone;
+
+	clone = rte_zmalloc_socket(graph->name, graph->mem_sz,
+				   RTE_CACHE_LINE_SIZE, graph->socket);
+	if (clone == NULL)
+		SET_ERR_JMP(ENOMEM, fail, "Failed to alloc %s instance",
+			    graph->name);
+
+	if (graph_fp_mem_populate(graph, clone)) {
+		graph_fp_mem_clone_destroy(clone);
+		goto fail;
+	}
+
+	return clone;
+fail:
+	return NULL;
+}
+
+void
+graph_fp_mem_clone_destroy(struct rte_graph *graph)
+{
+	graph_nodes_mem_destroy(graph);
+	rte_free(graph);
+}
@@ -67,6 +67,7 @@ struct graph_node {
 	STAILQ_ENTRY(graph_node) next; /**< Next graph node in the list. */
 	struct node *node; /**< Pointer to internal node. */
 	bool visited;      /**< Flag used in BFS to mark node visited. */
+	unsigned int lcore_id; /**< Affinitized lcore in dispatch model. */
 	struct graph_node *adjacency_list[]; /**< Adjacency list of the node. */
 };
 
@@ -100,10 +101,50 @@ struct graph {
 	/**< Memory size of the graph. */
 	int socket;
 	/**< Socket identifier where memory is allocated. */
+	uint8_t model;
+	/**< Graph walk model. */
+	uint16_t nb_instances;
+	/**< Number of fast path instances, one per lcore in dispatch model. */
+	struct rte_graph **instances;
+	/**< Fast path instances, the first one being graph. */
+	struct rte_graph **lcore_instances;
+	/**< Fast path instance per lcore id in dispatch model. */
 	STAILQ_HEAD(gnode_list, graph_node) node_list;
 	/**< Nodes in a graph. */
 };
 
+/**
+ * @internal
+ *
+ * Structure that holds an inbound handoff ring of a dispatch instance.
+ */
+struct graph_dispatch_inbound {
+	struct rte_ring *ring; /**< Ring filled by a remote lcore. */
+	struct rte_node *node; /**< Local node fed by the ring. */
+};
+
+/**
+ * @internal
+ *
+ * Structure that holds the multi-core dispatch state of a graph instance.
+ */
+struct rte_graph_dispatch {
+	struct rte_graph **lcore_instances;
+	/**< Instance per lcore id, shared by all instances of the graph. */
+	unsigned int lcore_id;
+	/**< Lcore walking this instance. */
+	uint32_t nb_stalled;
+	/**< Number of handoffs left behind by a full ring in last walk. */
+	uint32_t nb_remote;
+	/**< Number of nodes handed off to other lcores. */
+	uint32_t nb_inbound;
+	/**< Number of inbound rings. */
+	struct rte_node **remote;
+	/**< Nodes handed off to other lcores. */
+	struct graph_dispatch_inbound inbound[];
+	/**< Inbound rings. */
+};
+
 /* Node functions */
 STAILQ_HEAD(node_head, node);
 
@@ -286,6 +327,79 @@ int graph_fp_mem_create(struct graph *graph);
  */
 int graph_fp_mem_destroy(struct graph *graph);
 
+/**
+ * @internal
+ *
+ * Create an additional fast-path instance of the graph and nodes.
+ *
+ * @param graph
+ *   Pointer to the internal graph object, whose fast-path memory has
+ *   already been created.
+ *
+ * @return
+ *   Pointer to the new instance on success, NULL otherwise.
+ */
+struct rte_graph *graph_fp_mem_clone(struct graph *graph);
+
+/**
+ * @internal
+ *
+ * Free a fast-path instance created by graph_fp_mem_clone().
+ *
+ * @param graph
+ *   Pointer to the fast-path instance.
+ */
+void graph_fp_mem_clone_destroy(struct rte_graph *graph);
+
+/* Multi-core dispatch model functions */
+
+/**
+ * @internal
+ *
+ * Resolve the lcore of every node in the graph from the node to lcore
+ * affinities.
+ *
+ * @param graph
+ *   Pointer to the internal graph object.
+ * @param prm
+ *   Graph parameters holding the node to lcore affinities.
+ *
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid affinity or node without affinity.
+ */
+int graph_dispatch_lcores_resolve(struct graph *graph,
+				  const struct rte_graph_param *prm);
+
+/**
+ * @internal
+ *
+ * Spread the graph over the lcores of the node to lcore affinities,
+ * creating one fast-path instance per lcore and the handoff rings.
+ *
+ * @param graph
+ *   Pointer to the internal graph object.
+ * @param prm
+ *   Graph parameters holding the node to lcore affinities.
+ *
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid affinities.
+ *   - -ENOMEM: Not enough memory for instances or rings.
+ */
+int graph_dispatch_create(struct graph *graph,
+			  const struct rte_graph_param *prm);
+
+/**
+ * @internal
+ *
+ * Free the instances and rings created by graph_dispatch_create().
+ *
+ * @param graph
+ *   Pointer to the internal graph object.
+ */
+void graph_dispatch_destroy(struct graph *graph);
+
 /* Lookup functions */
 /**
  * @internal
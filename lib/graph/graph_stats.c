@@ -8,6 +8,7 @@
 #include <rte_common.h>
 #include <rte_errno.h>
 #include <rte_malloc.h>
+#include <rte_ring.h>
 
 #include "graph_private.h"
 
@@ -15,6 +16,7 @@
 struct cluster {
 	rte_graph_t nb_graphs;
 	rte_graph_t size;
+	uint32_t nb_instances;
 
 	struct graph **graphs;
 };
@@ -44,6 +46,12 @@ struct rte_graph_cluster_stats {
 		   "-------+---------------+---------------+---------------+-" \
 		   "----------+\n")
 
+#define dispatch_boarder()                                                     \
+	fprintf(f, "+-------------------------------+---------------+--------" \
+		   "-------+---------------+---------------+---------------+-" \
+		   "----------+---------------+---------------+-----------" \
+		   "----+\n")
+
 static inline void
 print_banner(FILE *f)
 {
@@ -55,7 +63,19 @@ print_banner(FILE *f)
 }
 
 static inline void
-print_node(FILE *f, const struct rte_graph_cluster_node_stats *stat)
+print_dispatch_banner(FILE *f)
+{
+	dispatch_boarder();
+	fprintf(f, "%-32s%-16s%-16s%-16s%-16s%-16s%-12s%-16s%-16s%-16s\n",
+		"|Node", "|calls", "|objs", "|realloc_count", "|objs/call",
+		"|objs/sec(10E6)", "|cycles/call", "|handoff_objs",
+		"|handoff_full", "|ring_count|");
+	dispatch_boarder();
+}
+
+static inline void
+print_node(FILE *f, const struct rte_graph_cluster_node_stats *stat,
+	   bool dispatch)
 {
 	double objs_per_call, objs_per_sec, cycles_per_call, ts_per_hz;
 	const uint64_t prev_calls = stat->prev_calls;
@@ -77,9 +97,14 @@ print_node(FILE *f, const struct rte_graph_cluster_node_stats *stat)
 
 	fprintf(f,
 		"|%-31s|%-15" PRIu64 "|%-15" PRIu64 "|%-15" PRIu64
-		"|%-15.3f|%-15.6f|%-11.4f|\n",
+		"|%-15.3f|%-15.6f|%-11.4f|",
 		stat->name, calls, objs, stat->realloc_count, objs_per_call,
 		objs_per_sec, cycles_per_call);
+	if (dispatch)
+		fprintf(f, "%-15" PRIu64 "|%-15" PRIu64 "|%-15" PRIu64 "|",
+			stat->dispatch_objs, stat->dispatch_full,
+			stat->ring_count);
+	fprintf(f, "\n");
 }
 
 static int
@@ -91,13 +116,29 @@ graph_cluster_stats_cb(bool is_first, bool is_last, void *cookie,
 	if (unlikely(is_first))
 		print_banner(f);
 	if (stat->objs)
-		print_node(f, stat);
+		print_node(f, stat, false);
 	if (unlikely(is_last))
 		boarder();
 
 	return 0;
 };
 
+static int
+graph_cluster_dispatch_stats_cb(bool is_first, bool is_last, void *cookie,
+				const struct rte_graph_cluster_node_stats *stat)
+{
+	FILE *f = cookie;
+
+	if (unlikely(is_first))
+		print_dispatch_banner(f);
+	if (stat->objs || stat->dispatch_objs || stat->ring_count)
+		print_node(f, stat, true);
+	if (unlikely(is_last))
+		dispatch_boarder();
+
+	return 0;
+};
+
 static struct rte_graph_cluster_stats *
 stats_mem_init(struct cluster *cluster,
 	       const struct rte_graph_cluster_stats_param *prm)
@@ -110,12 +151,14 @@ stats_mem_init(struct cluster *cluster,
 
 	/* Fix up callback */
 	fn = prm->fn;
-	if (fn == NULL)
+	if (fn == NULL && cluster->nb_instances > cluster->nb_graphs)
+		fn = graph_cluster_dispatch_stats_cb;
+	else if (fn == NULL)
 		fn = graph_cluster_stats_cb;
 
 	cluster_node_size = sizeof(struct cluster_node);
-	/* For a given cluster, max nodes will be the max number of graphs */
-	cluster_node_size += cluster->nb_graphs * sizeof(struct rte_node *);
+	/* For a given cluster, max nodes will be the max number of instances */
+	cluster_node_size += cluster->nb_instances * sizeof(struct rte_node *);
 	cluster_node_size = RTE_ALIGN(cluster_node_size, RTE_CACHE_LINE_SIZE);
 
 	stats = realloc(NULL, sz);
@@ -224,6 +267,7 @@ cluster_add(struct cluster *cluster, struct graph *graph)
 
 	/* Add graph to cluster */
 	cluster->graphs[cluster->nb_graphs++] = graph;
+	cluster->nb_instances += graph->nb_instances;
 	return 0;
 
 free:
@@ -270,6 +314,7 @@ rte_graph_cluster_stats_create(const struct rte_graph_cluster_stats_param *prm)
 	struct graph *graph;
 	const char *pattern;
 	rte_graph_t i;
+	uint16_t j;
 
 	/* Sanity checks */
 	if (!rte_graph_has_stats_feature())
@@ -296,13 +341,16 @@ rte_graph_cluster_stats_create(const struct rte_graph_cluster_stats_param *prm)
 	if (stats == NULL)
 		SET_ERR_JMP(ENOMEM, bad_pattern, "Failed alloc stats memory");
 
-	/* Iterate over M(Graph) x N (Nodes in graph) */
+	/* Iterate over M(Graph instances) x N (Nodes in graph) */
 	for (i = 0; i < cluster.nb_graphs; i++) {
 		graph = cluster.graphs[i];
-		STAILQ_FOREACH(graph_node, &graph->node_list, next) {
-			struct rte_graph *graph_fp = graph->graph;
-			if (stats_mem_populate(&stats, graph_fp, graph_node))
-				goto realloc_fail;
+		for (j = 0; j < graph->nb_instances; j++) {
+			STAILQ_FOREACH(graph_node, &graph->node_list, next) {
+				struct rte_graph *graph_fp = graph->instances[j];
+				if (stats_mem_populate(&stats, graph_fp,
+						       graph_node))
+					goto realloc_fail;
+			}
 		}
 	}
 
@@ -332,6 +380,7 @@ static inline void
 cluster_node_arregate_stats(struct cluster_node *cluster)
 {
 	uint64_t calls = 0, cycles = 0, objs = 0, realloc_count = 0;
+	uint64_t dispatch_objs = 0, dispatch_full = 0, ring_count = 0;
 	struct rte_graph_cluster_node_stats *stat = &cluster->stat;
 	struct rte_node *node;
 	rte_node_t count;
@@ -343,6 +392,10 @@ cluster_node_arregate_stats(struct cluster_node *cluster)
 		objs += node->total_objs;
 		cycles += node->total_cycles;
 		realloc_count += node->realloc_count;
+		dispatch_objs += node->dispatch_objs;
+		dispatch_full += node->dispatch_full;
+		if (node->dispatch_ring != NULL)
+			ring_count += rte_ring_count(node->dispatch_ring);
 	}
 
 	stat->calls = calls;
@@ -350,6 +403,9 @@ cluster_node_arregate_stats(struct cluster_node *cluster)
 	stat->cycles = cycles;
 	stat->ts = rte_get_timer_cycles();
 	stat->realloc_count = realloc_count;
+	stat->dispatch_objs = dispatch_objs;
+	stat->dispatch_full = dispatch_full;
+	stat->ring_count = ring_count;
 }
 
 static inline void
@@ -404,6 +460,9 @@ rte_graph_cluster_stats_reset(struct rte_graph_cluster_stats *stat)
 		node->prev_objs = 0;
 		node->prev_cycles = 0;
 		node->realloc_count = 0;
+		node->dispatch_objs = 0;
+		node->dispatch_full = 0;
+		node->ring_count = 0;
 		cluster = RTE_PTR_ADD(cluster, stat->cluster_node_size);
 	}
 }
@@ -41,6 +41,11 @@ extern "C" {
 #define RTE_GRAPH_ID_INVALID UINT16_MAX  /**< Invalid graph id. */
 #define RTE_GRAPH_FENCE 0xdeadbeef12345678ULL /**< Graph fence data. */
 
+#define RTE_GRAPH_MODEL_RTC 0 /**< Run-to-completion on the walking lcore. */
+#define RTE_GRAPH_MODEL_MCORE_DISPATCH 1
+/**< Nodes run on their affinitized lcores, streams handed over rings. */
+#define RTE_GRAPH_DISPATCH_RING_SZ 1024 /**< Default handoff ring size. */
+
 typedef uint32_t rte_graph_off_t;  /**< Graph offset type. */
 typedef uint32_t rte_node_t;       /**< Node id type. */
 typedef uint16_t rte_edge_t;       /**< Edge id type. */
@@ -154,6 +159,18 @@ typedef void (*rte_node_fini_t)(const struct rte_graph *graph,
 typedef int (*rte_graph_cluster_stats_cb_t)(bool is_first, bool is_last,
 	     void *cookie, const struct rte_graph_cluster_node_stats *stats);
 
+/**
+ * Structure to hold a node to lcore affinity of the multi-core dispatch
+ * model.
+ *
+ * @see struct rte_graph_param
+ */
+struct rte_graph_node_lcore {
+	const char *node_pattern;
+	/**< Node names to affinitize, based on shell pattern. */
+	unsigned int lcore_id; /**< Lcore running the matching nodes. */
+};
+
 /**
  * Structure to hold configuration parameters for creating the graph.
  *
@@ -164,6 +181,17 @@ struct rte_graph_param {
 	uint16_t nb_node_patterns;  /**< Number of node patterns. */
 	const char **node_patterns;
 	/**< Array of node patterns based on shell pattern. */
+	uint8_t model; /**< Graph walk model, RTE_GRAPH_MODEL_* */
+	uint16_t nb_node_lcores;
+	/**< Number of node to lcore affinities (dispatch model only). */
+	const struct rte_graph_node_lcore *node_lcores;
+	/**< Array of node to lcore affinities, the first matching pattern
+	 *   wins. Every node in the graph must match one of them.
+	 */
+	uint32_t dispatch_ring_size;
+	/**< Size of each cross lcore handoff ring, must be a power of 2.
+	 *   0 selects RTE_GRAPH_DISPATCH_RING_SZ.
+	 */
 };
 
 /**
@@ -206,6 +234,10 @@ struct rte_graph_cluster_node_stats {
 
 	uint64_t realloc_count; /**< Realloc count. */
 
+	uint64_t dispatch_objs; /**< Objs handed off to another lcore. */
+	uint64_t dispatch_full; /**< Handoffs stalled by a full ring. */
+	uint64_t ring_count;	/**< Objs waiting in handoff rings. */
+
 	rte_node_t id;	/**< Node identifier of stats. */
 	uint64_t hz;	/**< Cycles per seconds. */
 	char name[RTE_NODE_NAMESIZE];	/**< Name of the node. */
@@ -216,6 +248,12 @@ struct rte_graph_cluster_node_stats {
  *
  * Create memory reel, detect loops and find isolated nodes.
  *
+ * With the RTE_GRAPH_MODEL_MCORE_DISPATCH model, one graph instance is
+ * created per lcore named in the node to lcore affinities. Each lcore walks
+ * its own instance by calling rte_graph_walk() on the graph, only the nodes
+ * affinitized to it are processed there, and streams enqueued to nodes of
+ * other lcores are handed over through lock-free rings.
+ *
  * @param name
  *   Unique name for this graph.
  * @param prm
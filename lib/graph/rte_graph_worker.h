@@ -28,6 +28,9 @@
 extern "C" {
 #endif
 
+struct rte_graph_dispatch; /**< Multi-core dispatch state of a graph. */
+struct rte_ring;
+
 /**
  * @internal
  *
@@ -41,9 +44,11 @@ struct rte_graph {
 	rte_graph_off_t *cir_start;  /**< Pointer to circular buffer. */
 	rte_graph_off_t nodes_start; /**< Offset at which node memory starts. */
 	rte_graph_t id;	/**< Graph identifier. */
+	uint8_t model;	/**< Graph walk model. */
 	int socket;	/**< Socket ID where memory is allocated. */
 	char name[RTE_GRAPH_NAMESIZE];	/**< Name of the graph. */
 	uint64_t fence;			/**< Fence. */
+	struct rte_graph_dispatch *dispatch; /**< Dispatch model state. */
 } __rte_cache_aligned;
 
 /**
@@ -59,6 +64,10 @@ struct rte_node {
 	rte_node_t parent_id;	/**< Parent Node identifier. */
 	rte_edge_t nb_edges;	/**< Number of edges from this node. */
 	uint32_t realloc_count;	/**< Number of times realloced. */
+	unsigned int lcore_id;	/**< Lcore the node is affinitized to. */
+	uint64_t dispatch_objs;	/**< Objects handed off to another lcore. */
+	uint64_t dispatch_full;	/**< Handoffs stalled by a full ring. */
+	struct rte_ring *dispatch_ring; /**< Ring towards lcore_id. */
 
 	char parent[RTE_NODE_NAMESIZE];	/**< Parent node name. */
 	char name[RTE_NODE_NAMESIZE];	/**< Name of the node. */
@@ -118,10 +127,25 @@ __rte_experimental
 void __rte_node_stream_alloc_size(struct rte_graph *graph,
 				  struct rte_node *node, uint16_t req_size);
 
+/**
+ * @internal
+ *
+ * Walk the calling lcore's instance of a multi-core dispatch graph.
+ *
+ * @param graph
+ *   Pointer to the graph object.
+ */
+__rte_experimental
+void __rte_graph_mcore_dispatch_walk(struct rte_graph *graph);
+
 /**
  * Perform graph walk on the circular buffer and invoke the process function
  * of the nodes and collect the stats.
  *
+ * For the RTE_GRAPH_MODEL_MCORE_DISPATCH model, only the nodes affinitized
+ * to the calling lcore are processed; lcores outside of the graph and non-EAL
+ * threads return immediately.
+ *
  * @param graph
  *   Graph pointer returned from rte_graph_lookup function.
  *
@@ -139,6 +163,11 @@ rte_graph_walk(struct rte_graph *graph)
 	uint16_t rc;
 	void **objs;
 
+	if (unlikely(graph->model == RTE_GRAPH_MODEL_MCORE_DISPATCH)) {
+		__rte_graph_mcore_dispatch_walk(graph);
+		return;
+	}
+
 	/*
 	 * Walk on the source node(s) ((cir_start - head) -> cir_start) and then
 	 * on the pending streams (cir_start -> (cir_start + mask) -> cir_start)
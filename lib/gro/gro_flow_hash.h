@@ -0,0 +1,164 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2017 Intel Corporation
+ */
+
+#ifndef _GRO_FLOW_HASH_H_
+#define _GRO_FLOW_HASH_H_
+
+#include <rte_common.h>
+#include <rte_hash_crc.h>
+#include <rte_malloc.h>
+
+#define INVALID_ARRAY_INDEX 0xffffffffUL
+
+/*
+ * Upper bound of the uint32_t words of backing memory needed by a flow
+ * hash indexing up to 'nb_flows' flows: one head per bucket, rounded up
+ * to a power of 2, and one chain link per flow.
+ */
+#define GRO_FLOW_HASH_MEM_WORDS(nb_flows) (3 * (nb_flows))
+
+/*
+ * Link the 'nb' entries of the array 'items' into a stack of free
+ * entries, through their 'next' member, and set 'top' to the first one.
+ * An entry is then taken with GRO_FREE_ITEM_POP() and given back with
+ * GRO_FREE_ITEM_PUSH(), instead of scanning the array for an empty one.
+ */
+#define GRO_FREE_ITEM_INIT(items, next, nb, top) do {			\
+	uint32_t _i;							\
+	for (_i = 0; _i < (nb); _i++)					\
+		(items)[_i].next = _i + 1 < (nb) ?			\
+			_i + 1 : INVALID_ARRAY_INDEX;			\
+	(top) = (nb) != 0 ? 0 : INVALID_ARRAY_INDEX;			\
+} while (0)
+
+/* Pop a free entry into 'idx', INVALID_ARRAY_INDEX if there is none. */
+#define GRO_FREE_ITEM_POP(items, next, top, idx) do {			\
+	(idx) = (top);							\
+	if ((idx) != INVALID_ARRAY_INDEX)				\
+		(top) = (items)[idx].next;				\
+} while (0)
+
+#define GRO_FREE_ITEM_PUSH(items, next, top, idx) do {			\
+	(items)[idx].next = (top);					\
+	(top) = (idx);							\
+} while (0)
+
+/*
+ * Chained hash indexing the flow array of a reassembly table. Flows
+ * whose keys hash to the same bucket are linked through 'next', so a
+ * lookup only compares the keys of the flows in one bucket instead of
+ * walking the whole flow array. The flows which are not in the hash are
+ * linked through 'next' too, in a stack of free flows.
+ */
+struct gro_flow_hash {
+	/* First flow index of each bucket */
+	uint32_t *buckets;
+	/* Next flow index in the same bucket, indexed by flow index */
+	uint32_t *next;
+	/* Number of buckets - 1 */
+	uint32_t mask;
+	/* First free flow index */
+	uint32_t free;
+};
+
+/*
+ * Initialize a flow hash on caller provided memory of
+ * GRO_FLOW_HASH_MEM_WORDS(nb_flows) words, with all the flows free.
+ */
+static inline void
+gro_flow_hash_init(struct gro_flow_hash *h, uint32_t *mem, uint32_t nb_flows)
+{
+	uint32_t nb_buckets = rte_align32pow2(nb_flows), i;
+
+	h->buckets = mem;
+	h->next = mem + nb_buckets;
+	h->mask = nb_buckets - 1;
+	for (i = 0; i < nb_buckets; i++)
+		h->buckets[i] = INVALID_ARRAY_INDEX;
+	for (i = 0; i < nb_flows; i++)
+		h->next[i] = i + 1 < nb_flows ? i + 1 : INVALID_ARRAY_INDEX;
+	h->free = nb_flows != 0 ? 0 : INVALID_ARRAY_INDEX;
+}
+
+/*
+ * Allocate and initialize a flow hash for up to 'nb_flows' flows.
+ * Return 0 on success and -1 on allocation failure.
+ */
+static inline int
+gro_flow_hash_create(struct gro_flow_hash *h, uint32_t nb_flows,
+		uint16_t socket_id)
+{
+	uint32_t nb_words = rte_align32pow2(nb_flows) + nb_flows;
+	uint32_t *mem;
+
+	mem = rte_malloc_socket(__func__, sizeof(uint32_t) * nb_words,
+			RTE_CACHE_LINE_SIZE, socket_id);
+	if (mem == NULL)
+		return -1;
+
+	gro_flow_hash_init(h, mem, nb_flows);
+	return 0;
+}
+
+static inline void
+gro_flow_hash_free(struct gro_flow_hash *h)
+{
+	rte_free(h->buckets);
+}
+
+/* First flow index of the bucket of 'sig'. */
+static inline uint32_t
+gro_flow_hash_head(const struct gro_flow_hash *h, uint32_t sig)
+{
+	return h->buckets[sig & h->mask];
+}
+
+/* Flow index following 'flow_idx' in its bucket. */
+static inline uint32_t
+gro_flow_hash_next(const struct gro_flow_hash *h, uint32_t flow_idx)
+{
+	return h->next[flow_idx];
+}
+
+/*
+ * Take a free flow index, to be added to the hash.
+ * Return INVALID_ARRAY_INDEX if all the flows are in use.
+ */
+static inline uint32_t
+gro_flow_hash_get_free(struct gro_flow_hash *h)
+{
+	uint32_t flow_idx = h->free;
+
+	if (flow_idx != INVALID_ARRAY_INDEX)
+		h->free = h->next[flow_idx];
+	return flow_idx;
+}
+
+static inline void
+gro_flow_hash_add(struct gro_flow_hash *h, uint32_t sig, uint32_t flow_idx)
+{
+	uint32_t *head = &h->buckets[sig & h->mask];
+
+	h->next[flow_idx] = *head;
+	*head = flow_idx;
+}
+
+/* Remove a flow from the hash and make its index free. */
+static inline void
+gro_flow_hash_del(struct gro_flow_hash *h, uint32_t sig, uint32_t flow_idx)
+{
+	uint32_t *cur = &h->buckets[sig & h->mask];
+
+	while (*cur != INVALID_ARRAY_INDEX) {
+		if (*cur == flow_idx) {
+			*cur = h->next[flow_idx];
+			break;
+		}
+		cur = &h->next[*cur];
+	}
+	h->next[flow_idx] = h->free;
+	h->free = flow_idx;
+}
+
+#endif
@@ -5,24 +5,10 @@
 #ifndef _GRO_TCP4_H_
 #define _GRO_TCP4_H_
 
-#include <rte_ip.h>
-#include <rte_tcp.h>
-#include <rte_vxlan.h>
+#include "gro_tcp.h"
 
-#define INVALID_ARRAY_INDEX 0xffffffffUL
 #define GRO_TCP4_TBL_MAX_ITEM_NUM (1024UL * 1024UL)
 
-/*
- * The max length of a IPv4 packet, which includes the length of the L3
- * header, the L4 header and the data payload.
- */
-#define MAX_IPV4_PKT_LENGTH UINT16_MAX
-
-/* The maximum TCP header length */
-#define MAX_TCP_HLEN 60
-#define INVALID_TCP_HDRLEN(len) \
-	(((len) < sizeof(struct rte_tcp_hdr)) || ((len) > MAX_TCP_HLEN))
-
 /* Header fields representing a TCP/IPv4 flow */
 struct tcp4_flow_key {
 	struct rte_ether_addr eth_saddr;
@@ -44,42 +30,12 @@ struct gro_tcp4_flow {
 	uint32_t start_index;
 };
 
-struct gro_tcp4_item {
-	/*
-	 * The first MBUF segment of the packet. If the value
-	 * is NULL, it means the item is empty.
-	 */
-	struct rte_mbuf *firstseg;
-	/* The last MBUF segment of the packet */
-	struct rte_mbuf *lastseg;
-	/*
-	 * The time when the first packet is inserted into the table.
-	 * This value won't be updated, even if the packet is merged
-	 * with other packets.
-	 */
-	uint64_t start_time;
-	/*
-	 * next_pkt_idx is used to chain the packets that
-	 * are in the same flow but can't be merged together
-	 * (e.g. caused by packet reordering).
-	 */
-	uint32_t next_pkt_idx;
-	/* TCP sequence number of the packet */
-	uint32_t sent_seq;
-	/* IPv4 ID of the packet */
-	uint16_t ip_id;
-	/* the number of merged packets */
-	uint16_t nb_merged;
-	/* Indicate if IPv4 ID can be ignored */
-	uint8_t is_atomic;
-};
-
 /*
  * TCP/IPv4 reassembly table structure.
  */
 struct gro_tcp4_tbl {
 	/* item array */
-	struct gro_tcp4_item *items;
+	struct gro_tcp_item *items;
 	/* flow array */
 	struct gro_tcp4_flow *flows;
 	/* current item number */
@@ -90,6 +46,10 @@ struct gro_tcp4_tbl {
 	uint32_t max_item_num;
 	/* flow array size */
 	uint32_t max_flow_num;
+	/* first free item, linked to the next through next_pkt_idx */
+	uint32_t free_item;
+	/* flow index, keyed on the flow key hash */
+	struct gro_flow_hash flow_hash;
 };
 
 /**
@@ -198,110 +158,18 @@ is_same_tcp4_flow(struct tcp4_flow_key k1, struct tcp4_flow_key k2)
 }
 
 /*
- * Merge two TCP/IPv4 packets without updating checksums.
- * If cmp is larger than 0, append the new packet to the
- * original packet. Otherwise, pre-pend the new packet to
- * the original packet.
+ * Hash the 5-tuple of a TCP/IPv4 flow key. Keys that are the same
+ * flow always get the same signature.
  */
-static inline int
-merge_two_tcp4_packets(struct gro_tcp4_item *item,
-		struct rte_mbuf *pkt,
-		int cmp,
-		uint32_t sent_seq,
-		uint16_t ip_id,
-		uint16_t l2_offset)
+static inline uint32_t
+tcp4_flow_key_hash(const struct tcp4_flow_key *k)
 {
-	struct rte_mbuf *pkt_head, *pkt_tail, *lastseg;
-	uint16_t hdr_len, l2_len;
-
-	if (cmp > 0) {
-		pkt_head = item->firstseg;
-		pkt_tail = pkt;
-	} else {
-		pkt_head = pkt;
-		pkt_tail = item->firstseg;
-	}
+	uint32_t sig;
 
-	/* check if the IPv4 packet length is greater than the max value */
-	hdr_len = l2_offset + pkt_head->l2_len + pkt_head->l3_len +
-		pkt_head->l4_len;
-	l2_len = l2_offset > 0 ? pkt_head->outer_l2_len : pkt_head->l2_len;
-	if (unlikely(pkt_head->pkt_len - l2_len + pkt_tail->pkt_len -
-				hdr_len > MAX_IPV4_PKT_LENGTH))
-		return 0;
-
-	/* remove the packet header for the tail packet */
-	rte_pktmbuf_adj(pkt_tail, hdr_len);
-
-	/* chain two packets together */
-	if (cmp > 0) {
-		item->lastseg->next = pkt;
-		item->lastseg = rte_pktmbuf_lastseg(pkt);
-		/* update IP ID to the larger value */
-		item->ip_id = ip_id;
-	} else {
-		lastseg = rte_pktmbuf_lastseg(pkt);
-		lastseg->next = item->firstseg;
-		item->firstseg = pkt;
-		/* update sent_seq to the smaller value */
-		item->sent_seq = sent_seq;
-		item->ip_id = ip_id;
-	}
-	item->nb_merged++;
-
-	/* update MBUF metadata for the merged packet */
-	pkt_head->nb_segs += pkt_tail->nb_segs;
-	pkt_head->pkt_len += pkt_tail->pkt_len;
-
-	return 1;
+	sig = rte_hash_crc_4byte(k->ip_src_addr, 0);
+	sig = rte_hash_crc_4byte(k->ip_dst_addr, sig);
+	return rte_hash_crc_4byte(((uint32_t)k->src_port << 16) |
+			k->dst_port, sig);
 }
 
-/*
- * Check if two TCP/IPv4 packets are neighbors.
- */
-static inline int
-check_seq_option(struct gro_tcp4_item *item,
-		struct rte_tcp_hdr *tcph,
-		uint32_t sent_seq,
-		uint16_t ip_id,
-		uint16_t tcp_hl,
-		uint16_t tcp_dl,
-		uint16_t l2_offset,
-		uint8_t is_atomic)
-{
-	struct rte_mbuf *pkt_orig = item->firstseg;
-	struct rte_ipv4_hdr *iph_orig;
-	struct rte_tcp_hdr *tcph_orig;
-	uint16_t len, tcp_hl_orig;
-
-	iph_orig = (struct rte_ipv4_hdr *)(rte_pktmbuf_mtod(pkt_orig, char *) +
-			l2_offset + pkt_orig->l2_len);
-	tcph_orig = (struct rte_tcp_hdr *)((char *)iph_orig + pkt_orig->l3_len);
-	tcp_hl_orig = pkt_orig->l4_len;
-
-	/* Check if TCP option fields equal */
-	len = RTE_MAX(tcp_hl, tcp_hl_orig) - sizeof(struct rte_tcp_hdr);
-	if ((tcp_hl != tcp_hl_orig) || ((len > 0) &&
-				(memcmp(tcph + 1, tcph_orig + 1,
-					len) != 0)))
-		return 0;
-
-	/* Don't merge packets whose DF bits are different */
-	if (unlikely(item->is_atomic ^ is_atomic))
-		return 0;
-
-	/* check if the two packets are neighbors */
-	len = pkt_orig->pkt_len - l2_offset - pkt_orig->l2_len -
-		pkt_orig->l3_len - tcp_hl_orig;
-	if ((sent_seq == item->sent_seq + len) && (is_atomic ||
-				(ip_id == item->ip_id + 1)))
-		/* append the new packet */
-		return 1;
-	else if ((sent_seq + tcp_dl == item->sent_seq) && (is_atomic ||
-				(ip_id + item->nb_merged == item->ip_id)))
-		/* pre-pend the new packet */
-		return -1;
-
-	return 0;
-}
 #endif
@@ -41,6 +41,8 @@ gro_udp4_tbl_create(uint16_t socket_id,
 		return NULL;
 	}
 	tbl->max_item_num = entries_num;
+	GRO_FREE_ITEM_INIT(tbl->items, next_pkt_idx, entries_num,
+			tbl->free_item);
 
 	size = sizeof(struct gro_udp4_flow) * entries_num;
 	tbl->flows = rte_zmalloc_socket(__func__,
@@ -57,6 +59,13 @@ gro_udp4_tbl_create(uint16_t socket_id,
 		tbl->flows[i].start_index = INVALID_ARRAY_INDEX;
 	tbl->max_flow_num = entries_num;
 
+	if (gro_flow_hash_create(&tbl->flow_hash, entries_num, socket_id)) {
+		rte_free(tbl->flows);
+		rte_free(tbl->items);
+		rte_free(tbl);
+		return NULL;
+	}
+
 	return tbl;
 }
 
@@ -68,6 +77,7 @@ gro_udp4_tbl_destroy(void *tbl)
 	if (udp_tbl) {
 		rte_free(udp_tbl->items);
 		rte_free(udp_tbl->flows);
+		gro_flow_hash_free(&udp_tbl->flow_hash);
 	}
 	rte_free(udp_tbl);
 }
@@ -75,25 +85,10 @@ gro_udp4_tbl_destroy(void *tbl)
 static inline uint32_t
 find_an_empty_item(struct gro_udp4_tbl *tbl)
 {
-	uint32_t i;
-	uint32_t max_item_num = tbl->max_item_num;
-
-	for (i = 0; i < max_item_num; i++)
-		if (tbl->items[i].firstseg == NULL)
-			return i;
-	return INVALID_ARRAY_INDEX;
-}
-
-static inline uint32_t
-find_an_empty_flow(struct gro_udp4_tbl *tbl)
-{
-	uint32_t i;
-	uint32_t max_flow_num = tbl->max_flow_num;
+	uint32_t item_idx;
 
-	for (i = 0; i < max_flow_num; i++)
-		if (tbl->flows[i].start_index == INVALID_ARRAY_INDEX)
-			return i;
-	return INVALID_ARRAY_INDEX;
+	GRO_FREE_ITEM_POP(tbl->items, next_pkt_idx, tbl->free_item, item_idx);
+	return item_idx;
 }
 
 static inline uint32_t
@@ -141,6 +136,8 @@ delete_item(struct gro_udp4_tbl *tbl, uint32_t item_idx,
 	if (prev_item_idx != INVALID_ARRAY_INDEX)
 		tbl->items[prev_item_idx].next_pkt_idx = next_idx;
 
+	GRO_FREE_ITEM_PUSH(tbl->items, next_pkt_idx, tbl->free_item, item_idx);
+
 	return next_idx;
 }
 
@@ -152,7 +149,7 @@ insert_new_flow(struct gro_udp4_tbl *tbl,
 	struct udp4_flow_key *dst;
 	uint32_t flow_idx;
 
-	flow_idx = find_an_empty_flow(tbl);
+	flow_idx = gro_flow_hash_get_free(&tbl->flow_hash);
 	if (unlikely(flow_idx == INVALID_ARRAY_INDEX))
 		return INVALID_ARRAY_INDEX;
 
@@ -166,10 +163,22 @@ insert_new_flow(struct gro_udp4_tbl *tbl,
 
 	tbl->flows[flow_idx].start_index = item_idx;
 	tbl->flow_num++;
+	gro_flow_hash_add(&tbl->flow_hash, udp4_flow_key_hash(src),
+			flow_idx);
 
 	return flow_idx;
 }
 
+/* Release an empty flow, after its last item has been deleted. */
+static inline void
+delete_flow(struct gro_udp4_tbl *tbl, uint32_t flow_idx)
+{
+	gro_flow_hash_del(&tbl->flow_hash,
+			udp4_flow_key_hash(&tbl->flows[flow_idx].key),
+			flow_idx);
+	tbl->flow_num--;
+}
+
 /*
  * update the packet length for the flushed packet.
  */
@@ -207,7 +216,7 @@ gro_udp4_reassemble(struct rte_mbuf *pkt,
 
 	struct udp4_flow_key key;
 	uint32_t cur_idx, prev_idx, item_idx;
-	uint32_t i, max_flow_num, remaining_flow_num;
+	uint32_t i, sig;
 	int cmp;
 	uint8_t find;
 
@@ -245,16 +254,14 @@ gro_udp4_reassemble(struct rte_mbuf *pkt,
 	key.ip_id = ip_id;
 
 	/* Search for a matched flow. */
-	max_flow_num = tbl->max_flow_num;
-	remaining_flow_num = tbl->flow_num;
+	sig = udp4_flow_key_hash(&key);
 	find = 0;
-	for (i = 0; i < max_flow_num && remaining_flow_num; i++) {
-		if (tbl->flows[i].start_index != INVALID_ARRAY_INDEX) {
-			if (is_same_udp4_flow(tbl->flows[i].key, key)) {
-				find = 1;
-				break;
-			}
-			remaining_flow_num--;
+	for (i = gro_flow_hash_head(&tbl->flow_hash, sig);
+			i != INVALID_ARRAY_INDEX;
+			i = gro_flow_hash_next(&tbl->flow_hash, i)) {
+		if (is_same_udp4_flow(tbl->flows[i].key, key)) {
+			find = 1;
+			break;
 		}
 	}
 
@@ -403,7 +410,7 @@ gro_udp4_tbl_timeout_flush(struct gro_udp4_tbl *tbl,
 				j = delete_item(tbl, j, INVALID_ARRAY_INDEX);
 				tbl->flows[i].start_index = j;
 				if (j == INVALID_ARRAY_INDEX)
-					tbl->flow_num--;
+					delete_flow(tbl, i);
 
 				if (unlikely(k == nb_out))
 					return k;
@@ -9,7 +9,8 @@
 #include <rte_udp.h>
 #include <rte_vxlan.h>
 
-#define INVALID_ARRAY_INDEX 0xffffffffUL
+#include "gro_flow_hash.h"
+
 #define GRO_UDP4_TBL_MAX_ITEM_NUM (1024UL * 1024UL)
 
 /*
@@ -84,6 +85,10 @@ struct gro_udp4_tbl {
 	uint32_t max_item_num;
 	/* flow array size */
 	uint32_t max_flow_num;
+	/* first free item, linked to the next through next_pkt_idx */
+	uint32_t free_item;
+	/* flow index, keyed on the flow key hash */
+	struct gro_flow_hash flow_hash;
 };
 
 /**
@@ -185,6 +190,20 @@ is_same_udp4_flow(struct udp4_flow_key k1, struct udp4_flow_key k2)
 			(k1.ip_id == k2.ip_id));
 }
 
+/*
+ * Hash the addresses and IP ID of a UDP/IPv4 flow key. Keys that
+ * are the same flow always get the same signature.
+ */
+static inline uint32_t
+udp4_flow_key_hash(const struct udp4_flow_key *k)
+{
+	uint32_t sig;
+
+	sig = rte_hash_crc_4byte(k->ip_src_addr, 0);
+	sig = rte_hash_crc_4byte(k->ip_dst_addr, sig);
+	return rte_hash_crc_4byte(k->ip_id, sig);
+}
+
 /*
  * Merge two UDP/IPv4 packets without updating checksums.
  * If cmp is larger than 0, append the new packet to the
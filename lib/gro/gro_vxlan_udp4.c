@@ -42,6 +42,8 @@ gro_vxlan_udp4_tbl_create(uint16_t socket_id,
 		return NULL;
 	}
 	tbl->max_item_num = entries_num;
+	GRO_FREE_ITEM_INIT(tbl->items, inner_item.next_pkt_idx, entries_num,
+			tbl->free_item);
 
 	size = sizeof(struct gro_vxlan_udp4_flow) * entries_num;
 	tbl->flows = rte_zmalloc_socket(__func__,
@@ -58,6 +60,13 @@ gro_vxlan_udp4_tbl_create(uint16_t socket_id,
 		tbl->flows[i].start_index = INVALID_ARRAY_INDEX;
 	tbl->max_flow_num = entries_num;
 
+	if (gro_flow_hash_create(&tbl->flow_hash, entries_num, socket_id)) {
+		rte_free(tbl->flows);
+		rte_free(tbl->items);
+		rte_free(tbl);
+		return NULL;
+	}
+
 	return tbl;
 }
 
@@ -69,6 +78,7 @@ gro_vxlan_udp4_tbl_destroy(void *tbl)
 	if (vxlan_tbl) {
 		rte_free(vxlan_tbl->items);
 		rte_free(vxlan_tbl->flows);
+		gro_flow_hash_free(&vxlan_tbl->flow_hash);
 	}
 	rte_free(vxlan_tbl);
 }
@@ -76,23 +86,11 @@ gro_vxlan_udp4_tbl_destroy(void *tbl)
 static inline uint32_t
 find_an_empty_item(struct gro_vxlan_udp4_tbl *tbl)
 {
-	uint32_t max_item_num = tbl->max_item_num, i;
-
-	for (i = 0; i < max_item_num; i++)
-		if (tbl->items[i].inner_item.firstseg == NULL)
-			return i;
-	return INVALID_ARRAY_INDEX;
-}
-
-static inline uint32_t
-find_an_empty_flow(struct gro_vxlan_udp4_tbl *tbl)
-{
-	uint32_t max_flow_num = tbl->max_flow_num, i;
+	uint32_t item_idx;
 
-	for (i = 0; i < max_flow_num; i++)
-		if (tbl->flows[i].start_index == INVALID_ARRAY_INDEX)
-			return i;
-	return INVALID_ARRAY_INDEX;
+	GRO_FREE_ITEM_POP(tbl->items, inner_item.next_pkt_idx,
+			tbl->free_item, item_idx);
+	return item_idx;
 }
 
 static inline uint32_t
@@ -141,9 +139,23 @@ delete_item(struct gro_vxlan_udp4_tbl *tbl,
 	if (prev_item_idx != INVALID_ARRAY_INDEX)
 		tbl->items[prev_item_idx].inner_item.next_pkt_idx = next_idx;
 
+	GRO_FREE_ITEM_PUSH(tbl->items, inner_item.next_pkt_idx,
+			tbl->free_item, item_idx);
+
 	return next_idx;
 }
 
+static inline uint32_t
+vxlan_udp4_flow_key_hash(const struct vxlan_udp4_flow_key *k)
+{
+	uint32_t sig;
+
+	sig = udp4_flow_key_hash(&k->inner_key);
+	sig = rte_hash_crc_4byte(k->outer_ip_src_addr, sig);
+	sig = rte_hash_crc_4byte(k->outer_ip_dst_addr, sig);
+	return rte_hash_crc_4byte(k->vxlan_hdr.vx_vni, sig);
+}
+
 static inline uint32_t
 insert_new_flow(struct gro_vxlan_udp4_tbl *tbl,
 		struct vxlan_udp4_flow_key *src,
@@ -152,7 +164,7 @@ insert_new_flow(struct gro_vxlan_udp4_tbl *tbl,
 	struct vxlan_udp4_flow_key *dst;
 	uint32_t flow_idx;
 
-	flow_idx = find_an_empty_flow(tbl);
+	flow_idx = gro_flow_hash_get_free(&tbl->flow_hash);
 	if (unlikely(flow_idx == INVALID_ARRAY_INDEX))
 		return INVALID_ARRAY_INDEX;
 
@@ -176,10 +188,22 @@ insert_new_flow(struct gro_vxlan_udp4_tbl *tbl,
 
 	tbl->flows[flow_idx].start_index = item_idx;
 	tbl->flow_num++;
+	gro_flow_hash_add(&tbl->flow_hash, vxlan_udp4_flow_key_hash(src),
+			flow_idx);
 
 	return flow_idx;
 }
 
+/* Release an empty flow, after its last item has been deleted. */
+static inline void
+delete_flow(struct gro_vxlan_udp4_tbl *tbl, uint32_t flow_idx)
+{
+	gro_flow_hash_del(&tbl->flow_hash,
+			vxlan_udp4_flow_key_hash(&tbl->flows[flow_idx].key),
+			flow_idx);
+	tbl->flow_num--;
+}
+
 static inline int
 is_same_vxlan_udp4_flow(struct vxlan_udp4_flow_key k1,
 		struct vxlan_udp4_flow_key k2)
@@ -298,7 +322,7 @@ gro_vxlan_udp4_reassemble(struct rte_mbuf *pkt,
 
 	struct vxlan_udp4_flow_key key;
 	uint32_t cur_idx, prev_idx, item_idx;
-	uint32_t i, max_flow_num, remaining_flow_num;
+	uint32_t i, sig;
 	int cmp;
 	uint16_t hdr_len;
 	uint8_t find;
@@ -356,16 +380,14 @@ gro_vxlan_udp4_reassemble(struct rte_mbuf *pkt,
 	key.outer_dst_port = udp_hdr->dst_port;
 
 	/* Search for a matched flow. */
-	max_flow_num = tbl->max_flow_num;
-	remaining_flow_num = tbl->flow_num;
+	sig = vxlan_udp4_flow_key_hash(&key);
 	find = 0;
-	for (i = 0; i < max_flow_num && remaining_flow_num; i++) {
-		if (tbl->flows[i].start_index != INVALID_ARRAY_INDEX) {
-			if (is_same_vxlan_udp4_flow(tbl->flows[i].key, key)) {
-				find = 1;
-				break;
-			}
-			remaining_flow_num--;
+	for (i = gro_flow_hash_head(&tbl->flow_hash, sig);
+			i != INVALID_ARRAY_INDEX;
+			i = gro_flow_hash_next(&tbl->flow_hash, i)) {
+		if (is_same_vxlan_udp4_flow(tbl->flows[i].key, key)) {
+			find = 1;
+			break;
 		}
 	}
 
@@ -515,7 +537,7 @@ gro_vxlan_udp4_tbl_timeout_flush(struct gro_vxlan_udp4_tbl *tbl,
 				j = delete_item(tbl, j, INVALID_ARRAY_INDEX);
 				tbl->flows[i].start_index = j;
 				if (j == INVALID_ARRAY_INDEX)
-					tbl->flow_num--;
+					delete_flow(tbl, i);
 
 				if (unlikely(k == nb_out))
 					return k;
@@ -61,6 +61,10 @@ struct gro_vxlan_udp4_tbl {
 	uint32_t max_item_num;
 	/* the maximum flow number */
 	uint32_t max_flow_num;
+	/* first free item, linked to the next through next_pkt_idx */
+	uint32_t free_item;
+	/* flow index, keyed on the flow key hash */
+	struct gro_flow_hash flow_hash;
 };
 
 /**
@@ -10,6 +10,7 @@
 #include "rte_gso.h"
 #include "gso_common.h"
 #include "gso_tcp4.h"
+#include "gso_tcp6.h"
 #include "gso_tunnel_tcp4.h"
 #include "gso_tunnel_udp4.h"
 #include "gso_udp4.h"
@@ -74,6 +75,11 @@ rte_gso_segment(struct rte_mbuf *pkt,
 		ret = gso_tcp4_segment(pkt, gso_size, ipid_delta,
 				direct_pool, indirect_pool,
 				pkts_out, nb_pkts_out);
+	} else if (IS_IPV6_TCP(pkt->ol_flags) &&
+			(gso_ctx->gso_types & RTE_ETH_TX_OFFLOAD_TCP_TSO)) {
+		pkt->ol_flags &= (~RTE_MBUF_F_TX_TCP_SEG);
+		ret = gso_tcp6_segment(pkt, gso_size, direct_pool,
+				indirect_pool, pkts_out, nb_pkts_out);
 	} else if (IS_IPV4_UDP(pkt->ol_flags) &&
 			(gso_ctx->gso_types & RTE_ETH_TX_OFFLOAD_UDP_TSO)) {
 		pkt->ol_flags &= (~RTE_MBUF_F_TX_UDP_SEG);
@@ -22,6 +22,7 @@
 #include <rte_errno.h>
 #include <rte_string_fns.h>
 #include <rte_cpuflags.h>
+#include <rte_cycles.h>
 #include <rte_rwlock.h>
 #include <rte_spinlock.h>
 #include <rte_ring_elem.h>
@@ -38,6 +39,8 @@
 				   RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY | \
 				   RTE_HASH_EXTRA_FLAGS_EXT_TABLE |	\
 				   RTE_HASH_EXTRA_FLAGS_NO_FREE_ON_DEL | \
+				   RTE_HASH_EXTRA_FLAGS_GROWABLE | \
+				   RTE_HASH_EXTRA_FLAGS_AGING | \
 				   RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF)
 
 #define FOR_EACH_BUCKET(CURRENT_BKT, START_BUCKET)                            \
@@ -104,6 +107,31 @@ rte_hash_cmp_eq(const void *key1, const void *key2, const struct rte_hash *h)
 		return cmp_jump_table[h->cmp_jump_table_idx](key1, key2, h->key_len);
 }
 
+/* Clock of the aging timestamps, in milliseconds */
+static inline uint32_t
+hash_age_clock(void)
+{
+	return rte_get_timer_cycles() / (rte_get_timer_hz() / 1000);
+}
+
+/* Refresh the timestamp of a key, if aging is enabled. The store is
+ * skipped when the timestamp is current to keep the cache line shared
+ * between the readers.
+ */
+static inline void
+hash_age_touch(const struct rte_hash *h, const struct rte_hash_key *k)
+{
+	uint32_t *ts, now;
+
+	if (likely(!h->aging))
+		return;
+
+	ts = RTE_PTR_ADD(k, h->age_offset);
+	now = __atomic_load_n(&h->age_now, __ATOMIC_RELAXED);
+	if (__atomic_load_n(ts, __ATOMIC_RELAXED) != now)
+		__atomic_store_n(ts, now, __ATOMIC_RELAXED);
+}
+
 /*
  * We use higher 16 bits of hash as the signature value stored in table.
  * We use the lower bits for the primary bucket
@@ -148,9 +176,11 @@ rte_hash_create(const struct rte_hash_parameters *params)
 	void *buckets_ext = NULL;
 	char ring_name[RTE_RING_NAMESIZE];
 	char ext_ring_name[RTE_RING_NAMESIZE];
-	unsigned num_key_slots;
+	unsigned num_key_slots, init_key_slots;
 	unsigned int hw_trans_mem_support = 0, use_local_cache = 0;
 	unsigned int ext_table_support = 0;
+	unsigned int growable = 0;
+	unsigned int aging = 0;
 	unsigned int readwrite_concur_support = 0;
 	unsigned int writer_takes_lock = 0;
 	unsigned int no_free_on_del = 0;
@@ -193,6 +223,16 @@ rte_hash_create(const struct rte_hash_parameters *params)
 		return NULL;
 	}
 
+	if ((params->extra_flag & RTE_HASH_EXTRA_FLAGS_GROWABLE) &&
+	    (params->extra_flag & (RTE_HASH_EXTRA_FLAGS_MULTI_WRITER_ADD |
+				   RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY |
+				   RTE_HASH_EXTRA_FLAGS_EXT_TABLE))) {
+		rte_errno = EINVAL;
+		RTE_LOG(ERR, HASH, "rte_hash_create: growable table supports "
+			"single writer without ext table only\n");
+		return NULL;
+	}
+
 	/* Check extra flags field to check extra options. */
 	if (params->extra_flag & RTE_HASH_EXTRA_FLAGS_TRANS_MEM_SUPPORT)
 		hw_trans_mem_support = 1;
@@ -213,6 +253,12 @@ rte_hash_create(const struct rte_hash_parameters *params)
 	if (params->extra_flag & RTE_HASH_EXTRA_FLAGS_NO_FREE_ON_DEL)
 		no_free_on_del = 1;
 
+	if (params->extra_flag & RTE_HASH_EXTRA_FLAGS_GROWABLE)
+		growable = 1;
+
+	if (params->extra_flag & RTE_HASH_EXTRA_FLAGS_AGING)
+		aging = 1;
+
 	if (params->extra_flag & RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF) {
 		readwrite_concur_lf_support = 1;
 		/* Enable not freeing internal memory/index on delete.
@@ -234,6 +280,26 @@ rte_hash_create(const struct rte_hash_parameters *params)
 	else
 		num_key_slots = params->entries + 1;
 
+	uint32_t num_buckets = rte_align32pow2(params->entries) /
+						RTE_HASH_BUCKET_ENTRIES;
+
+	/* A growable table starts smaller, the free slots ring is sized for
+	 * the largest table so it never needs to be replaced.
+	 */
+	init_key_slots = num_key_slots;
+	if (growable) {
+		uint32_t init_entries = params->init_entries != 0 ?
+			params->init_entries :
+			params->entries / 16;
+
+		init_entries = rte_align32pow2(RTE_MAX(init_entries,
+					(uint32_t)RTE_HASH_BUCKET_ENTRIES));
+		if (init_entries < num_buckets * RTE_HASH_BUCKET_ENTRIES) {
+			num_buckets = init_entries / RTE_HASH_BUCKET_ENTRIES;
+			init_key_slots = init_entries + 1;
+		}
+	}
+
 	snprintf(ring_name, sizeof(ring_name), "HT_%s", params->name);
 	/* Create ring (Dummy slot index is not enqueued) */
 	r = rte_ring_create_elem(ring_name, sizeof(uint32_t),
@@ -243,9 +309,6 @@ rte_hash_create(const struct rte_hash_parameters *params)
 		goto err;
 	}
 
-	const uint32_t num_buckets = rte_align32pow2(params->entries) /
-						RTE_HASH_BUCKET_ENTRIES;
-
 	/* Create ring for extendable buckets. */
 	if (ext_table_support) {
 		snprintf(ext_ring_name, sizeof(ext_ring_name), "HT_EXT_%s",
@@ -331,10 +394,14 @@ rte_hash_create(const struct rte_hash_parameters *params)
 		}
 	}
 
-	const uint32_t key_entry_size =
+	/* With aging, the timestamp follows the key */
+	const uint32_t age_offset = sizeof(struct rte_hash_key) +
+		RTE_ALIGN(params->key_len, sizeof(uint32_t));
+	const uint32_t key_entry_size = aging ?
+		RTE_ALIGN(age_offset + sizeof(uint32_t), KEY_ALIGNMENT) :
 		RTE_ALIGN(sizeof(struct rte_hash_key) + params->key_len,
 			  KEY_ALIGNMENT);
-	const uint64_t key_tbl_size = (uint64_t) key_entry_size * num_key_slots;
+	const uint64_t key_tbl_size = (uint64_t) key_entry_size * init_key_slots;
 
 	k = rte_zmalloc_socket(NULL, key_tbl_size,
 			RTE_CACHE_LINE_SIZE, params->socket_id);
@@ -413,6 +480,9 @@ rte_hash_create(const struct rte_hash_parameters *params)
 	h->entries = params->entries;
 	h->key_len = params->key_len;
 	h->key_entry_size = key_entry_size;
+	h->aging = aging;
+	h->age_offset = age_offset;
+	h->age_now = hash_age_clock();
 	h->hash_func_init_val = params->hash_func_init_val;
 
 	h->num_buckets = num_buckets;
@@ -435,6 +505,9 @@ rte_hash_create(const struct rte_hash_parameters *params)
 	h->writer_takes_lock = writer_takes_lock;
 	h->no_free_on_del = no_free_on_del;
 	h->readwrite_concur_lf_support = readwrite_concur_lf_support;
+	h->cur_entries = init_key_slots - 1;
+	h->growable = growable;
+	h->socket_id = params->socket_id;
 
 #if defined(RTE_ARCH_X86)
 	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_SSE2))
@@ -461,7 +534,7 @@ rte_hash_create(const struct rte_hash_parameters *params)
 	}
 
 	/* Populate free slots ring. Entry zero is reserved for key misses. */
-	for (i = 1; i < num_key_slots; i++)
+	for (i = 1; i < init_key_slots; i++)
 		rte_ring_sp_enqueue_elem(r, &i, sizeof(uint32_t));
 
 	te->data = (void *) h;
@@ -527,6 +600,9 @@ rte_hash_free(struct rte_hash *h)
 	rte_free(h->buckets_ext);
 	rte_free(h->tbl_chng_cnt);
 	rte_free(h->ext_bkt_to_free);
+	rte_free(h->old_buckets);
+	while (h->nb_retired > 0)
+		rte_free(h->retired[--h->nb_retired]);
 	rte_free(h);
 	rte_free(te);
 }
@@ -562,16 +638,15 @@ rte_hash_count(const struct rte_hash *h)
 	if (h == NULL)
 		return -EINVAL;
 
+	/* Slots of the key store, including the ones in lcore caches */
+	tot_ring_cnt = h->cur_entries;
 	if (h->use_local_cache) {
-		tot_ring_cnt = h->entries + (RTE_MAX_LCORE - 1) *
-					(LCORE_CACHE_SIZE - 1);
 		for (i = 0; i < RTE_MAX_LCORE; i++)
 			cached_cnt += h->local_free_slots[i].len;
 
 		ret = tot_ring_cnt - rte_ring_count(h->free_slots) -
 								cached_cnt;
 	} else {
-		tot_ring_cnt = h->entries;
 		ret = tot_ring_cnt - rte_ring_count(h->free_slots);
 	}
 	return ret;
@@ -632,8 +707,16 @@ rte_hash_reset(struct rte_hash *h)
 			RTE_LOG(ERR, HASH, "RCU reclaim all resources failed\n");
 	}
 
+	/* A growable table keeps its current size, readers are not
+	 * referencing the tables any more.
+	 */
+	rte_free(h->old_buckets);
+	h->old_buckets = NULL;
+	while (h->nb_retired > 0)
+		rte_free(h->retired[--h->nb_retired]);
+
 	memset(h->buckets, 0, h->num_buckets * sizeof(struct rte_hash_bucket));
-	memset(h->key_store, 0, h->key_entry_size * (h->entries + 1));
+	memset(h->key_store, 0, h->key_entry_size * (h->cur_entries + 1));
 	*h->tbl_chng_cnt = 0;
 
 	/* reset the free ring */
@@ -647,11 +730,7 @@ rte_hash_reset(struct rte_hash *h)
 	}
 
 	/* Repopulate the free slots ring. Entry zero is reserved for key misses */
-	if (h->use_local_cache)
-		tot_ring_cnt = h->entries + (RTE_MAX_LCORE - 1) *
-					(LCORE_CACHE_SIZE - 1);
-	else
-		tot_ring_cnt = h->entries;
+	tot_ring_cnt = h->cur_entries;
 
 	for (i = 1; i < tot_ring_cnt + 1; i++)
 		rte_ring_sp_enqueue_elem(h->free_slots, &i, sizeof(uint32_t));
@@ -713,6 +792,7 @@ search_and_update(const struct rte_hash *h, void *data, const void *key,
 				__atomic_store_n(&k->pdata,
 					data,
 					__ATOMIC_RELEASE);
+				hash_age_touch(h, k);
 				/*
 				 * Return index where key is stored,
 				 * subtracting the first dummy index
@@ -1004,6 +1084,225 @@ alloc_slot(const struct rte_hash *h, struct lcore_cache *cached_free_slots)
 	return slot_id;
 }
 
+/*
+ * Free a key store or bucket table replaced by the growth of the table,
+ * once the lock free readers cannot reference it any more.
+ */
+static void
+retire_table(struct rte_hash *h, void *tbl)
+{
+	if (!h->readwrite_concur_lf_support) {
+		rte_free(tbl);
+		return;
+	}
+
+	if (h->hash_rcu_cfg != NULL) {
+		rte_rcu_qsbr_synchronize(h->hash_rcu_cfg->v,
+					 RTE_QSBR_THRID_INVALID);
+		rte_free(tbl);
+		return;
+	}
+
+	/* Without RCU, keep it until the table is reset or freed. As each
+	 * table is twice the size of the previous one, the retired tables
+	 * take less memory than the current ones.
+	 */
+	h->retired[h->nb_retired++] = tbl;
+}
+
+/* Insert an existing key of the key store in the current bucket table */
+static int
+migrate_key(const struct rte_hash *h, uint32_t key_idx)
+{
+	struct rte_hash_key *k = RTE_PTR_ADD(h->key_store,
+			key_idx * h->key_entry_size);
+	hash_sig_t sig = rte_hash_hash(h, k->key);
+	uint16_t short_sig = get_short_sig(sig);
+	uint32_t prim_bucket_idx = get_prim_bucket_index(h, sig);
+	uint32_t sec_bucket_idx = get_alt_bucket_index(h, prim_bucket_idx,
+						       short_sig);
+	struct rte_hash_bucket *prim_bkt = &h->buckets[prim_bucket_idx];
+	struct rte_hash_bucket *sec_bkt = &h->buckets[sec_bucket_idx];
+	int32_t ret_val;
+	int ret;
+
+	ret = rte_hash_cuckoo_insert_mw(h, prim_bkt, sec_bkt,
+			(const void *)k->key, k->pdata, short_sig, key_idx,
+			&ret_val);
+	if (ret == 0)
+		return 0;
+
+	ret = rte_hash_cuckoo_make_space_mw(h, prim_bkt, sec_bkt,
+			(const void *)k->key, k->pdata, short_sig,
+			prim_bucket_idx, key_idx, &ret_val);
+	if (ret == 0)
+		return 0;
+
+	ret = rte_hash_cuckoo_make_space_mw(h, sec_bkt, prim_bkt,
+			(const void *)k->key, k->pdata, short_sig,
+			sec_bucket_idx, key_idx, &ret_val);
+	return ret == 0 ? 0 : -ENOSPC;
+}
+
+/*
+ * Move the keys of the next bucket of the old table to the current one.
+ * The old table is retired once all its buckets are migrated.
+ */
+static int
+migrate_bucket(struct rte_hash *h)
+{
+	struct rte_hash_bucket *old_buckets = h->old_buckets;
+	struct rte_hash_bucket *bkt = &old_buckets[h->migrate_idx];
+	unsigned int i, moved = 0;
+	int ret = 0;
+
+	for (i = 0; i < RTE_HASH_BUCKET_ENTRIES; i++) {
+		if (bkt->key_idx[i] == EMPTY_SLOT)
+			continue;
+		ret = migrate_key(h, bkt->key_idx[i]);
+		if (ret != 0)
+			break;
+		moved |= 1 << i;
+	}
+
+	if (moved != 0 && h->readwrite_concur_lf_support) {
+		/* The moved keys are in both tables, inform the readers
+		 * before removing them from the old one. Since there is
+		 * one writer, load acquire on tbl_chng_cnt is not required.
+		 */
+		__atomic_store_n(h->tbl_chng_cnt, *h->tbl_chng_cnt + 1,
+				 __ATOMIC_RELEASE);
+		/* The stores to key_idx should not move above the store
+		 * to tbl_chng_cnt.
+		 */
+		__atomic_thread_fence(__ATOMIC_RELEASE);
+	}
+
+	for (i = 0; i < RTE_HASH_BUCKET_ENTRIES; i++) {
+		if ((moved & (1 << i)) == 0)
+			continue;
+		bkt->sig_current[i] = NULL_SIGNATURE;
+		__atomic_store_n(&bkt->key_idx[i], EMPTY_SLOT,
+				 __ATOMIC_RELEASE);
+	}
+
+	if (ret != 0)
+		return ret;
+
+	if (++h->migrate_idx == h->num_buckets / 2) {
+		__atomic_store_n(&h->old_buckets, NULL, __ATOMIC_RELEASE);
+		retire_table(h, old_buckets);
+	}
+	return 0;
+}
+
+/* Resume a stopped migration of the old table on each add and delete */
+static inline void
+migrate_buckets(const struct rte_hash *h)
+{
+	unsigned int i;
+
+	for (i = 0; i < RTE_HASH_MIGRATE_BKTS && h->old_buckets != NULL; i++)
+		if (migrate_bucket((struct rte_hash *)((uintptr_t)h)) != 0)
+			return;
+}
+
+/*
+ * Double the key store and the bucket table of a growable table. The keys
+ * stay in the old bucket table until it is migrated, lookups search both.
+ * A migration stopped by a key which does not fit in the new table is
+ * resumed by the following add and delete operations.
+ */
+static int
+grow_table(struct rte_hash *h)
+{
+	const uint32_t num_buckets = h->num_buckets * 2;
+	struct rte_hash_bucket *buckets;
+	uint32_t num_slots, i;
+	void *k, *old_k;
+
+	if (num_buckets * RTE_HASH_BUCKET_ENTRIES >
+			rte_align32pow2(h->entries))
+		return -ENOSPC;
+
+	/* Finish the migration of the previous growth */
+	while (h->old_buckets != NULL)
+		if (migrate_bucket(h) != 0)
+			return -ENOSPC;
+
+	buckets = rte_zmalloc_socket(NULL,
+			num_buckets * sizeof(struct rte_hash_bucket),
+			RTE_CACHE_LINE_SIZE, h->socket_id);
+	if (buckets == NULL) {
+		RTE_LOG(ERR, HASH, "buckets memory allocation failed\n");
+		return -ENOMEM;
+	}
+
+	num_slots = RTE_MIN(num_buckets * RTE_HASH_BUCKET_ENTRIES, h->entries);
+	if (num_slots > h->cur_entries) {
+		k = rte_zmalloc_socket(NULL,
+				(uint64_t)h->key_entry_size * (num_slots + 1),
+				RTE_CACHE_LINE_SIZE, h->socket_id);
+		if (k == NULL) {
+			RTE_LOG(ERR, HASH, "memory allocation failed\n");
+			rte_free(buckets);
+			return -ENOMEM;
+		}
+		memcpy(k, h->key_store,
+			(uint64_t)h->key_entry_size * (h->cur_entries + 1));
+
+		/* Readers load the key store after the key index, they see
+		 * the new key store before any of its new slots.
+		 */
+		old_k = h->key_store;
+		__atomic_store_n(&h->key_store, k, __ATOMIC_RELEASE);
+		for (i = h->cur_entries + 1; i <= num_slots; i++)
+			rte_ring_sp_enqueue_elem(h->free_slots, &i,
+						 sizeof(uint32_t));
+		h->cur_entries = num_slots;
+		retire_table(h, old_k);
+	}
+
+	if (h->readwrite_concur_lf_support) {
+		/* Readers which see part of the new tables retry */
+		__atomic_store_n(h->tbl_chng_cnt, *h->tbl_chng_cnt + 1,
+				 __ATOMIC_RELEASE);
+		__atomic_thread_fence(__ATOMIC_RELEASE);
+	}
+
+	/* Readers load the bitmask first, it indexes within the tables
+	 * they load after it, which can only be larger.
+	 */
+	__atomic_store_n(&h->old_buckets, h->buckets, __ATOMIC_RELAXED);
+	__atomic_store_n(&h->buckets, buckets, __ATOMIC_RELAXED);
+	__atomic_store_n(&h->bucket_bitmask, num_buckets - 1,
+			 __ATOMIC_RELEASE);
+	h->num_buckets = num_buckets;
+	h->migrate_idx = 0;
+
+	if (h->readwrite_concur_lf_support) {
+		/* Readers which loaded the counter above may have seen the
+		 * new tables with the old bitmask, and searched the old
+		 * table with the wrong one. Make them retry.
+		 */
+		__atomic_store_n(h->tbl_chng_cnt, *h->tbl_chng_cnt + 1,
+				 __ATOMIC_RELEASE);
+	}
+
+	/* The growth already copies the key store and zeroes the new table.
+	 * Migrate the old table now rather than over the following updates,
+	 * the lookups of a table with few updates would search it until then.
+	 * Lock free readers keep finding the keys during the migration.
+	 */
+	while (h->old_buckets != NULL)
+		if (migrate_bucket(h) != 0)
+			break;
+
+	RTE_LOG(DEBUG, HASH, "%s grown to %u buckets and %u keys\n",
+		h->name, num_buckets, h->cur_entries);
+	return 0;
+}
+
 static inline int32_t
 __rte_hash_add_key_with_hash(const struct rte_hash *h, const void *key,
 						hash_sig_t sig, void *data)
@@ -1011,7 +1310,7 @@ __rte_hash_add_key_with_hash(const struct rte_hash *h, const void *key,
 	uint16_t short_sig;
 	uint32_t prim_bucket_idx, sec_bucket_idx;
 	struct rte_hash_bucket *prim_bkt, *sec_bkt, *cur_bkt;
-	struct rte_hash_key *new_k, *keys = h->key_store;
+	struct rte_hash_key *new_k, *keys;
 	uint32_t ext_bkt_id = 0;
 	uint32_t slot_id;
 	int ret;
@@ -1021,6 +1320,11 @@ __rte_hash_add_key_with_hash(const struct rte_hash *h, const void *key,
 	int32_t ret_val;
 	struct rte_hash_bucket *last;
 
+	if (unlikely(h->old_buckets != NULL))
+		migrate_buckets(h);
+
+retry:
+	keys = h->key_store;
 	short_sig = get_short_sig(sig);
 	prim_bucket_idx = get_prim_bucket_index(h, sig);
 	sec_bucket_idx = get_alt_bucket_index(h, prim_bucket_idx, short_sig);
@@ -1048,6 +1352,24 @@ __rte_hash_add_key_with_hash(const struct rte_hash *h, const void *key,
 
 	__hash_rw_writer_unlock(h);
 
+	/* Check if key is still in the old table of a growable table,
+	 * which has a single writer and no lock.
+	 */
+	if (unlikely(h->old_buckets != NULL)) {
+		const uint32_t old_bitmask = h->bucket_bitmask >> 1;
+		uint32_t old_idx = sig & old_bitmask;
+
+		ret = search_and_update(h, data, key,
+				&h->old_buckets[old_idx], short_sig);
+		if (ret != -1)
+			return ret;
+		old_idx = (old_idx ^ short_sig) & old_bitmask;
+		ret = search_and_update(h, data, key,
+				&h->old_buckets[old_idx], short_sig);
+		if (ret != -1)
+			return ret;
+	}
+
 	/* Did not find a match, so get a new slot for storing the new key */
 	if (h->use_local_cache) {
 		lcore_id = rte_lcore_id();
@@ -1064,8 +1386,12 @@ __rte_hash_add_key_with_hash(const struct rte_hash *h, const void *key,
 			if (ret == 0)
 				slot_id = alloc_slot(h, cached_free_slots);
 		}
-		if (slot_id == EMPTY_SLOT)
+		if (slot_id == EMPTY_SLOT) {
+			if (h->growable &&
+			    grow_table((struct rte_hash *)((uintptr_t)h)) == 0)
+				goto retry;
 			return -ENOSPC;
+		}
 	}
 
 	new_k = RTE_PTR_ADD(keys, slot_id * h->key_entry_size);
@@ -1078,6 +1404,7 @@ __rte_hash_add_key_with_hash(const struct rte_hash *h, const void *key,
 		__ATOMIC_RELEASE);
 	/* Copy key */
 	memcpy(new_k->key, key, h->key_len);
+	hash_age_touch(h, new_k);
 
 	/* Find an empty slot and insert */
 	ret = rte_hash_cuckoo_insert_mw(h, prim_bkt, sec_bkt, key, data,
@@ -1113,6 +1440,9 @@ __rte_hash_add_key_with_hash(const struct rte_hash *h, const void *key,
 	/* if ext table not enabled, we failed the insertion */
 	if (!h->ext_table_support) {
 		enqueue_slot_back(h, cached_free_slots, slot_id);
+		if (h->growable &&
+		    grow_table((struct rte_hash *)((uintptr_t)h)) == 0)
+			goto retry;
 		return ret;
 	}
 
@@ -1258,6 +1588,7 @@ search_one_bucket_l(const struct rte_hash *h, const void *key,
 			if (rte_hash_cmp_eq(key, k->key, h) == 0) {
 				if (data != NULL)
 					*data = k->pdata;
+				hash_age_touch(h, k);
 				/*
 				 * Return index where key is stored,
 				 * subtracting the first dummy index
@@ -1276,7 +1607,7 @@ search_one_bucket_lf(const struct rte_hash *h, const void *key, uint16_t sig,
 {
 	int i;
 	uint32_t key_idx;
-	struct rte_hash_key *k, *keys = h->key_store;
+	struct rte_hash_key *k, *keys;
 
 	for (i = 0; i < RTE_HASH_BUCKET_ENTRIES; i++) {
 		/* Signature comparison is done before the acquire-load
@@ -1290,6 +1621,12 @@ search_one_bucket_lf(const struct rte_hash *h, const void *key, uint16_t sig,
 			key_idx = __atomic_load_n(&bkt->key_idx[i],
 					  __ATOMIC_ACQUIRE);
 			if (key_idx != EMPTY_SLOT) {
+				/* The key store of a growable table is
+				 * replaced when it grows, load it after
+				 * the key index.
+				 */
+				keys = __atomic_load_n(&h->key_store,
+						       __ATOMIC_RELAXED);
 				k = (struct rte_hash_key *) ((char *)keys +
 						key_idx * h->key_entry_size);
 
@@ -1299,6 +1636,7 @@ search_one_bucket_lf(const struct rte_hash *h, const void *key, uint16_t sig,
 							&k->pdata,
 							__ATOMIC_ACQUIRE);
 					}
+					hash_age_touch(h, k);
 					/*
 					 * Return index where key is stored,
 					 * subtracting the first dummy index
@@ -1409,11 +1747,89 @@ __rte_hash_lookup_with_hash_lf(const struct rte_hash *h, const void *key,
 	return -ENOENT;
 }
 
+/*
+ * Lookup in a growable table: in the current bucket table, then in the old
+ * one while it is migrated. Also used without lock free concurrency, the
+ * table change counter is then never updated.
+ */
+static inline int32_t
+__rte_hash_lookup_with_hash_grow(const struct rte_hash *h, const void *key,
+					hash_sig_t sig, void **data)
+{
+	const struct rte_hash_bucket *buckets, *old_buckets;
+	uint32_t bucket_bitmask, prim_bucket_idx, sec_bucket_idx;
+	uint32_t cnt_b, cnt_a;
+	int ret;
+	uint16_t short_sig;
+
+	short_sig = get_short_sig(sig);
+
+	do {
+		/* Load the table change counter before the lookup
+		 * starts. Acquire semantics will make sure that
+		 * loads of the tables are not hoisted.
+		 */
+		cnt_b = __atomic_load_n(h->tbl_chng_cnt,
+				__ATOMIC_ACQUIRE);
+
+		/* The bitmask is stored last when the table grows, it
+		 * indexes within the tables loaded after it, and within
+		 * the old table with one bit less.
+		 */
+		bucket_bitmask = __atomic_load_n(&h->bucket_bitmask,
+				__ATOMIC_ACQUIRE);
+		buckets = __atomic_load_n(&h->buckets, __ATOMIC_RELAXED);
+		old_buckets = __atomic_load_n(&h->old_buckets,
+				__ATOMIC_RELAXED);
+
+		prim_bucket_idx = sig & bucket_bitmask;
+		sec_bucket_idx = (prim_bucket_idx ^ short_sig) &
+				bucket_bitmask;
+		ret = search_one_bucket_lf(h, key, short_sig, data,
+				&buckets[prim_bucket_idx]);
+		if (ret != -1)
+			return ret;
+		ret = search_one_bucket_lf(h, key, short_sig, data,
+				&buckets[sec_bucket_idx]);
+		if (ret != -1)
+			return ret;
+
+		if (old_buckets != NULL) {
+			bucket_bitmask >>= 1;
+			prim_bucket_idx = sig & bucket_bitmask;
+			sec_bucket_idx = (prim_bucket_idx ^ short_sig) &
+					bucket_bitmask;
+			ret = search_one_bucket_lf(h, key, short_sig, data,
+					&old_buckets[prim_bucket_idx]);
+			if (ret != -1)
+				return ret;
+			ret = search_one_bucket_lf(h, key, short_sig, data,
+					&old_buckets[sec_bucket_idx]);
+			if (ret != -1)
+				return ret;
+		}
+
+		/* The loads of sig_current in search_one_bucket
+		 * should not move below the load from tbl_chng_cnt.
+		 */
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		/* Re-read the table change counter to check if the
+		 * table has changed (or grown) during search.
+		 */
+		cnt_a = __atomic_load_n(h->tbl_chng_cnt,
+					__ATOMIC_ACQUIRE);
+	} while (cnt_b != cnt_a);
+
+	return -ENOENT;
+}
+
 static inline int32_t
 __rte_hash_lookup_with_hash(const struct rte_hash *h, const void *key,
 					hash_sig_t sig, void **data)
 {
-	if (h->readwrite_concur_lf_support)
+	if (h->growable)
+		return __rte_hash_lookup_with_hash_grow(h, key, sig, data);
+	else if (h->readwrite_concur_lf_support)
 		return __rte_hash_lookup_with_hash_lf(h, key, sig, data);
 	else
 		return __rte_hash_lookup_with_hash_l(h, key, sig, data);
@@ -1676,55 +2092,25 @@ search_and_remove(const struct rte_hash *h, const void *key,
 	return -1;
 }
 
-static inline int32_t
-__rte_hash_del_key_with_hash(const struct rte_hash *h, const void *key,
-						hash_sig_t sig)
+/* Recycle the last ext bucket of the chain of a deleted key if it is
+ * empty, and free the key index through RCU if integrated.
+ * Writer is expected to hold the lock while calling this function.
+ */
+static inline void
+free_deleted_key(const struct rte_hash *h, struct rte_hash_bucket *head_bkt,
+		 int32_t ret)
 {
-	uint32_t prim_bucket_idx, sec_bucket_idx;
-	struct rte_hash_bucket *prim_bkt, *sec_bkt, *prev_bkt, *last_bkt;
-	struct rte_hash_bucket *cur_bkt;
-	int pos;
-	int32_t ret, i;
-	uint16_t short_sig;
+	struct rte_hash_bucket *prev_bkt, *last_bkt;
 	uint32_t index = EMPTY_SLOT;
 	struct __rte_hash_rcu_dq_entry rcu_dq_entry;
+	int32_t i;
 
-	short_sig = get_short_sig(sig);
-	prim_bucket_idx = get_prim_bucket_index(h, sig);
-	sec_bucket_idx = get_alt_bucket_index(h, prim_bucket_idx, short_sig);
-	prim_bkt = &h->buckets[prim_bucket_idx];
-
-	__hash_rw_writer_lock(h);
-	/* look for key in primary bucket */
-	ret = search_and_remove(h, key, prim_bkt, short_sig, &pos);
-	if (ret != -1) {
-		__rte_hash_compact_ll(h, prim_bkt, pos);
-		last_bkt = prim_bkt->next;
-		prev_bkt = prim_bkt;
-		goto return_bkt;
-	}
-
-	/* Calculate secondary hash */
-	sec_bkt = &h->buckets[sec_bucket_idx];
-
-	FOR_EACH_BUCKET(cur_bkt, sec_bkt) {
-		ret = search_and_remove(h, key, cur_bkt, short_sig, &pos);
-		if (ret != -1) {
-			__rte_hash_compact_ll(h, cur_bkt, pos);
-			last_bkt = sec_bkt->next;
-			prev_bkt = sec_bkt;
-			goto return_bkt;
-		}
-	}
-
-	__hash_rw_writer_unlock(h);
-	return -ENOENT;
-
-/* Search last bucket to see if empty to be recycled */
-return_bkt:
-	if (!last_bkt)
+	/* Search last bucket to see if empty to be recycled */
+	if (head_bkt == NULL || head_bkt->next == NULL)
 		goto return_key;
 
+	prev_bkt = head_bkt;
+	last_bkt = head_bkt->next;
 	while (last_bkt->next) {
 		prev_bkt = last_bkt;
 		last_bkt = last_bkt->next;
@@ -1777,6 +2163,72 @@ __rte_hash_del_key_with_hash(const struct rte_hash *h, const void *key,
 			if (rte_rcu_qsbr_dq_enqueue(h->dq, &rcu_dq_entry) != 0)
 				RTE_LOG(ERR, HASH, "Failed to push QSBR FIFO\n");
 	}
+}
+
+static inline int32_t
+__rte_hash_del_key_with_hash(const struct rte_hash *h, const void *key,
+						hash_sig_t sig)
+{
+	uint32_t prim_bucket_idx, sec_bucket_idx;
+	struct rte_hash_bucket *prim_bkt, *sec_bkt, *head_bkt;
+	struct rte_hash_bucket *cur_bkt;
+	int pos;
+	int32_t ret;
+	uint16_t short_sig;
+
+	if (unlikely(h->old_buckets != NULL))
+		migrate_buckets(h);
+
+	short_sig = get_short_sig(sig);
+	prim_bucket_idx = get_prim_bucket_index(h, sig);
+	sec_bucket_idx = get_alt_bucket_index(h, prim_bucket_idx, short_sig);
+	prim_bkt = &h->buckets[prim_bucket_idx];
+
+	__hash_rw_writer_lock(h);
+	/* look for key in primary bucket */
+	ret = search_and_remove(h, key, prim_bkt, short_sig, &pos);
+	if (ret != -1) {
+		__rte_hash_compact_ll(h, prim_bkt, pos);
+		head_bkt = prim_bkt;
+		goto return_key;
+	}
+
+	/* Calculate secondary hash */
+	sec_bkt = &h->buckets[sec_bucket_idx];
+
+	FOR_EACH_BUCKET(cur_bkt, sec_bkt) {
+		ret = search_and_remove(h, key, cur_bkt, short_sig, &pos);
+		if (ret != -1) {
+			__rte_hash_compact_ll(h, cur_bkt, pos);
+			head_bkt = sec_bkt;
+			goto return_key;
+		}
+	}
+
+	/* Look for key in the old table of a growable table */
+	if (unlikely(h->old_buckets != NULL)) {
+		const uint32_t old_bitmask = h->bucket_bitmask >> 1;
+
+		prim_bucket_idx = sig & old_bitmask;
+		sec_bucket_idx = (prim_bucket_idx ^ short_sig) & old_bitmask;
+		ret = search_and_remove(h, key,
+				&h->old_buckets[prim_bucket_idx],
+				short_sig, &pos);
+		if (ret == -1)
+			ret = search_and_remove(h, key,
+					&h->old_buckets[sec_bucket_idx],
+					short_sig, &pos);
+		if (ret != -1) {
+			head_bkt = NULL;
+			goto return_key;
+		}
+	}
+
+	__hash_rw_writer_unlock(h);
+	return -ENOENT;
+
+return_key:
+	free_deleted_key(h, head_bkt, ret);
 	__hash_rw_writer_unlock(h);
 	return ret;
 }
@@ -1802,6 +2254,10 @@ rte_hash_get_key_with_position(const struct rte_hash *h, const int32_t position,
 {
 	RETURN_IF_TRUE(((h == NULL) || (key == NULL)), -EINVAL);
 
+	/* Out of the key store of a growable table */
+	if ((uint32_t)position >= h->cur_entries)
+		return -EINVAL;
+
 	struct rte_hash_key *k, *keys = h->key_store;
 	k = (struct rte_hash_key *) ((char *) keys + (position + 1) *
 				     h->key_entry_size);
@@ -1825,9 +2281,7 @@ rte_hash_free_key_with_position(const struct rte_hash *h,
 
 	RETURN_IF_TRUE(((h == NULL) || (key_idx == EMPTY_SLOT)), -EINVAL);
 
-	const uint32_t total_entries = h->use_local_cache ?
-		h->entries + (RTE_MAX_LCORE - 1) * (LCORE_CACHE_SIZE - 1) + 1
-							: h->entries + 1;
+	const uint32_t total_entries = h->cur_entries + 1;
 
 	/* Out of bounds */
 	if (key_idx >= total_entries)
@@ -1973,6 +2427,7 @@ __bulk_lookup_l(const struct rte_hash *h, const void **keys,
 					key_slot->key, keys[i], h)) {
 				if (data != NULL)
 					data[i] = key_slot->pdata;
+				hash_age_touch(h, key_slot);
 
 				hits |= 1ULL << i;
 				positions[i] = key_idx - 1;
@@ -2002,6 +2457,7 @@ __bulk_lookup_l(const struct rte_hash *h, const void **keys,
 					key_slot->key, keys[i], h)) {
 				if (data != NULL)
 					data[i] = key_slot->pdata;
+				hash_age_touch(h, key_slot);
 
 				hits |= 1ULL << i;
 				positions[i] = key_idx - 1;
@@ -2133,6 +2589,7 @@ __bulk_lookup_lf(const struct rte_hash *h, const void **keys,
 						data[i] = __atomic_load_n(
 							&key_slot->pdata,
 							__ATOMIC_ACQUIRE);
+					hash_age_touch(h, key_slot);
 
 					hits |= 1ULL << i;
 					positions[i] = key_idx - 1;
@@ -2166,6 +2623,7 @@ __bulk_lookup_lf(const struct rte_hash *h, const void **keys,
 						data[i] = __atomic_load_n(
 							&key_slot->pdata,
 							__ATOMIC_ACQUIRE);
+					hash_age_touch(h, key_slot);
 
 					hits |= 1ULL << i;
 					positions[i] = key_idx - 1;
@@ -2312,12 +2770,41 @@ __rte_hash_lookup_bulk_lf(const struct rte_hash *h, const void **keys,
 		positions, hit_mask, data);
 }
 
+/*
+ * Bulk lookup in a growable table, one key at a time: the buckets of a key
+ * can only be found once the table change counter is loaded.
+ */
+static inline void
+__rte_hash_lookup_bulk_grow(const struct rte_hash *h, const void **keys,
+			const hash_sig_t *prim_hash, int32_t num_keys,
+			int32_t *positions, uint64_t *hit_mask, void *data[])
+{
+	uint64_t hits = 0;
+	hash_sig_t sig;
+	int32_t i;
+
+	for (i = 0; i < num_keys; i++) {
+		sig = prim_hash != NULL ? prim_hash[i] :
+				rte_hash_hash(h, keys[i]);
+		positions[i] = __rte_hash_lookup_with_hash_grow(h, keys[i],
+				sig, data != NULL ? &data[i] : NULL);
+		if (positions[i] >= 0)
+			hits |= 1ULL << i;
+	}
+
+	if (hit_mask != NULL)
+		*hit_mask = hits;
+}
+
 static inline void
 __rte_hash_lookup_bulk(const struct rte_hash *h, const void **keys,
 			int32_t num_keys, int32_t *positions,
 			uint64_t *hit_mask, void *data[])
 {
-	if (h->readwrite_concur_lf_support)
+	if (h->growable)
+		__rte_hash_lookup_bulk_grow(h, keys, NULL, num_keys, positions,
+					    hit_mask, data);
+	else if (h->readwrite_concur_lf_support)
 		__rte_hash_lookup_bulk_lf(h, keys, num_keys, positions,
 					  hit_mask, data);
 	else
@@ -2325,6 +2812,214 @@ __rte_hash_lookup_bulk(const struct rte_hash *h, const void **keys,
 					 hit_mask, data);
 }
 
+/*
+ * Streaming lookup, software pipelined in three stages which are
+ * STREAM_DISTANCE keys apart so that the memory accesses of a stage are
+ * complete when the next one runs on the same key:
+ * 1. hash the key and prefetch its buckets,
+ * 2. compare the signatures and prefetch the matching key slots,
+ * 3. compare the keys, then search the extendable buckets if any.
+ */
+#define STREAM_DISTANCE 8
+#define STREAM_STATES (2 * STREAM_DISTANCE)
+
+struct stream_state {
+	const struct rte_hash_bucket *prim_bkt;
+	const struct rte_hash_bucket *sec_bkt;
+	hash_sig_t hash;
+	uint32_t prim_hitmask;
+	uint32_t sec_hitmask;
+	uint32_t cnt;
+	uint16_t sig;
+};
+
+static inline void
+stream_hash(const struct rte_hash *h, const void *key, struct stream_state *st)
+{
+	uint32_t prim_idx;
+
+	st->hash = rte_hash_hash(h, key);
+	st->sig = get_short_sig(st->hash);
+	prim_idx = get_prim_bucket_index(h, st->hash);
+	st->prim_bkt = &h->buckets[prim_idx];
+	st->sec_bkt = &h->buckets[get_alt_bucket_index(h, prim_idx, st->sig)];
+	rte_prefetch0(st->prim_bkt);
+	rte_prefetch0(st->sec_bkt);
+}
+
+static inline void
+stream_prefetch_key(const struct rte_hash *h,
+		    const struct rte_hash_bucket *bkt, uint32_t hitmask)
+{
+	uint32_t key_idx = bkt->key_idx[__builtin_ctzl(hitmask) >> 1];
+
+	rte_prefetch0((const char *)h->key_store +
+		      key_idx * h->key_entry_size);
+}
+
+static inline void
+stream_compare_sigs(const struct rte_hash *h, struct stream_state *st,
+		    const int lf)
+{
+	/* Load the table change counter before the signatures, acquire
+	 * semantics will make sure that their loads are not hoisted.
+	 */
+	if (lf)
+		st->cnt = __atomic_load_n(h->tbl_chng_cnt, __ATOMIC_ACQUIRE);
+
+	st->prim_hitmask = 0;
+	st->sec_hitmask = 0;
+	compare_signatures(&st->prim_hitmask, &st->sec_hitmask,
+			   st->prim_bkt, st->sec_bkt, st->sig, h->sig_cmp_fn);
+	if (st->prim_hitmask)
+		stream_prefetch_key(h, st->prim_bkt, st->prim_hitmask);
+	if (st->sec_hitmask)
+		stream_prefetch_key(h, st->sec_bkt, st->sec_hitmask);
+}
+
+static inline int32_t
+stream_compare_keys(const struct rte_hash *h, const void *key,
+		    const struct rte_hash_bucket *bkt, uint32_t hitmask,
+		    void **data, const int lf)
+{
+	const struct rte_hash_key *key_slot;
+	uint32_t hit_index, key_idx;
+
+	while (hitmask) {
+		hit_index = __builtin_ctzl(hitmask) >> 1;
+		hitmask &= ~(3U << (hit_index << 1));
+		key_idx = lf ? __atomic_load_n(&bkt->key_idx[hit_index],
+					       __ATOMIC_ACQUIRE) :
+			bkt->key_idx[hit_index];
+		/* The dummy slot 0 is never compared */
+		if (key_idx == EMPTY_SLOT)
+			continue;
+		key_slot = (const struct rte_hash_key *)(
+				(const char *)h->key_store +
+				key_idx * h->key_entry_size);
+		if (rte_hash_cmp_eq(key_slot->key, key, h) != 0)
+			continue;
+		if (data != NULL)
+			*data = lf ? __atomic_load_n(&key_slot->pdata,
+						     __ATOMIC_ACQUIRE) :
+				key_slot->pdata;
+		hash_age_touch(h, key_slot);
+		return key_idx - 1;
+	}
+	return -1;
+}
+
+static inline int32_t
+stream_search(const struct rte_hash *h, const void *key,
+	      const struct stream_state *st, void **data, const int lf)
+{
+	struct rte_hash_bucket *cur_bkt;
+	int32_t ret;
+	uint32_t cnt_a;
+
+	ret = stream_compare_keys(h, key, st->prim_bkt, st->prim_hitmask,
+				  data, lf);
+	if (ret != -1)
+		return ret;
+	ret = stream_compare_keys(h, key, st->sec_bkt, st->sec_hitmask,
+				  data, lf);
+	if (ret != -1)
+		return ret;
+
+	if (h->ext_table_support) {
+		FOR_EACH_BUCKET(cur_bkt, st->sec_bkt->next) {
+			ret = lf ? search_one_bucket_lf(h, key, st->sig,
+							data, cur_bkt) :
+				search_one_bucket_l(h, key, st->sig,
+						    data, cur_bkt);
+			if (ret != -1)
+				return ret;
+		}
+	}
+
+	if (lf) {
+		/* The loads of sig_current in compare_signatures
+		 * should not move below the load from tbl_chng_cnt.
+		 */
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		cnt_a = __atomic_load_n(h->tbl_chng_cnt, __ATOMIC_ACQUIRE);
+		/* A key may have moved while it was searched, search it
+		 * again on its own.
+		 */
+		if (st->cnt != cnt_a)
+			return __rte_hash_lookup_with_hash_lf(h, key,
+							      st->hash, data);
+	}
+	return -ENOENT;
+}
+
+static inline int
+__rte_hash_lookup_stream(const struct rte_hash *h, const void **keys,
+			 uint32_t num_keys, int32_t *positions, void *data[],
+			 const int lf)
+{
+	struct stream_state st[STREAM_STATES];
+	uint32_t i, j;
+	int hits = 0;
+
+	/* The last stage runs first, to free the state of its key for the
+	 * first stage of the next key.
+	 */
+	for (i = 0; i < num_keys + 2 * STREAM_DISTANCE; i++) {
+		j = i - 2 * STREAM_DISTANCE;
+		if (i >= 2 * STREAM_DISTANCE) {
+			positions[j] = stream_search(h, keys[j],
+					&st[j % STREAM_STATES],
+					data != NULL ? &data[j] : NULL, lf);
+			if (positions[j] >= 0)
+				hits++;
+			else
+				positions[j] = -ENOENT;
+		}
+
+		j = i - STREAM_DISTANCE;
+		if (i >= STREAM_DISTANCE && j < num_keys)
+			stream_compare_sigs(h, &st[j % STREAM_STATES], lf);
+
+		if (i + STREAM_DISTANCE < num_keys)
+			rte_prefetch0(keys[i + STREAM_DISTANCE]);
+		if (i < num_keys)
+			stream_hash(h, keys[i], &st[i % STREAM_STATES]);
+	}
+	return hits;
+}
+
+int
+rte_hash_lookup_stream(const struct rte_hash *h, const void **keys,
+		       uint32_t num_keys, int32_t *positions, void *data[])
+{
+	uint32_t i;
+	int hits = 0;
+
+	RETURN_IF_TRUE(((h == NULL) || (keys == NULL) ||
+			(positions == NULL)), -EINVAL);
+
+	if (h->growable) {
+		for (i = 0; i < num_keys; i++) {
+			positions[i] = __rte_hash_lookup_with_hash_grow(h,
+					keys[i], rte_hash_hash(h, keys[i]),
+					data != NULL ? &data[i] : NULL);
+			if (positions[i] >= 0)
+				hits++;
+		}
+		return hits;
+	}
+
+	if (h->readwrite_concur_lf_support)
+		return __rte_hash_lookup_stream(h, keys, num_keys, positions,
+						data, 1);
+
+	__hash_rw_reader_lock(h);
+	hits = __rte_hash_lookup_stream(h, keys, num_keys, positions, data, 0);
+	__hash_rw_reader_unlock(h);
+	return hits;
+}
+
 int
 rte_hash_lookup_bulk(const struct rte_hash *h, const void **keys,
 		      uint32_t num_keys, int32_t *positions)
@@ -2429,7 +3124,10 @@ __rte_hash_lookup_with_hash_bulk(const struct rte_hash *h, const void **keys,
 			hash_sig_t *prim_hash, int32_t num_keys,
 			int32_t *positions, uint64_t *hit_mask, void *data[])
 {
-	if (h->readwrite_concur_lf_support)
+	if (h->growable)
+		__rte_hash_lookup_bulk_grow(h, keys, prim_hash, num_keys,
+				positions, hit_mask, data);
+	else if (h->readwrite_concur_lf_support)
 		__rte_hash_lookup_with_hash_bulk_lf(h, keys, prim_hash,
 				num_keys, positions, hit_mask, data);
 	else
@@ -2475,12 +3173,25 @@ rte_hash_iterate(const struct rte_hash *h, const void **key, void **data, uint32
 {
 	uint32_t bucket_idx, idx, position;
 	struct rte_hash_key *next_key;
+	struct rte_hash_bucket *ext_bkts;
 
 	RETURN_IF_TRUE(((h == NULL) || (next == NULL)), -EINVAL);
 
 	const uint32_t total_entries_main = h->num_buckets *
 							RTE_HASH_BUCKET_ENTRIES;
-	const uint32_t total_entries = total_entries_main << 1;
+	uint32_t total_entries = total_entries_main << 1;
+
+	/* The old table of a growable table, half the size of the main
+	 * one, is iterated in place of the extendable buckets.
+	 */
+	if (h->growable) {
+		ext_bkts = h->old_buckets;
+		total_entries = total_entries_main + total_entries_main / 2;
+	} else if (h->ext_table_support) {
+		ext_bkts = h->buckets_ext;
+	} else {
+		ext_bkts = NULL;
+	}
 
 	/* Out of bounds of all buckets (both main table and ext table) */
 	if (*next >= total_entries_main)
@@ -2518,13 +3229,13 @@ rte_hash_iterate(const struct rte_hash *h, const void **key, void **data, uint32
 /* Begin to iterate extendable buckets */
 extend_table:
 	/* Out of total bound or if ext bucket feature is not enabled */
-	if (*next >= total_entries || !h->ext_table_support)
+	if (*next >= total_entries || ext_bkts == NULL)
 		return -ENOENT;
 
 	bucket_idx = (*next - total_entries_main) / RTE_HASH_BUCKET_ENTRIES;
 	idx = (*next - total_entries_main) % RTE_HASH_BUCKET_ENTRIES;
 
-	while ((position = h->buckets_ext[bucket_idx].key_idx[idx]) == EMPTY_SLOT) {
+	while ((position = ext_bkts[bucket_idx].key_idx[idx]) == EMPTY_SLOT) {
 		(*next)++;
 		if (*next == total_entries)
 			return -ENOENT;
@@ -2545,3 +3256,91 @@ rte_hash_iterate(const struct rte_hash *h, const void **key, void **data, uint32
 	(*next)++;
 	return position - 1;
 }
+
+/* Delete or report the expired keys of one bucket of the chain of head_bkt.
+ * The keys stamped with prev, the clock before this scan, were used since
+ * the previous scan and are kept whatever the interval between the scans.
+ * Writer is expected to hold the lock while calling this function.
+ */
+static int
+age_scan_bucket(const struct rte_hash *h, struct rte_hash_bucket *bkt,
+		struct rte_hash_bucket *head_bkt, uint32_t prev, uint32_t now,
+		uint32_t timeout, rte_hash_age_cb_t cb, void *arg)
+{
+	struct rte_hash_key *k;
+	uint32_t key_idx, *ts, t;
+	unsigned int i;
+	int expired = 0;
+
+	for (i = 0; i < RTE_HASH_BUCKET_ENTRIES; i++) {
+		key_idx = bkt->key_idx[i];
+		if (key_idx == EMPTY_SLOT)
+			continue;
+		k = RTE_PTR_ADD(h->key_store, key_idx * h->key_entry_size);
+		ts = RTE_PTR_ADD(k, h->age_offset);
+		t = __atomic_load_n(ts, __ATOMIC_RELAXED);
+		if (t == prev || now - t < timeout)
+			continue;
+
+		expired++;
+		if (cb != NULL &&
+		    cb(arg, k->key, k->pdata, key_idx - 1) == RTE_HASH_AGE_KEEP) {
+			__atomic_store_n(ts, now, __ATOMIC_RELAXED);
+			continue;
+		}
+
+		bkt->sig_current[i] = NULL_SIGNATURE;
+		if (!h->no_free_on_del)
+			remove_entry(h, bkt, i);
+		__atomic_store_n(&bkt->key_idx[i], EMPTY_SLOT,
+				 __ATOMIC_RELEASE);
+		/* A key of the last bucket of the chain may be moved in
+		 * the slot, look at it again.
+		 */
+		__rte_hash_compact_ll(h, bkt, i);
+		free_deleted_key(h, head_bkt, key_idx - 1);
+		i--;
+	}
+	return expired;
+}
+
+int
+rte_hash_age_scan(const struct rte_hash *h, uint32_t timeout,
+		  uint32_t budget, rte_hash_age_cb_t cb, void *arg)
+{
+	struct rte_hash *ht = (struct rte_hash *)((uintptr_t)h);
+	struct rte_hash_bucket *head_bkt, *cur_bkt;
+	uint32_t prev, now, idx;
+	int expired = 0;
+
+	if (h == NULL || !h->aging)
+		return -EINVAL;
+
+	if (unlikely(h->old_buckets != NULL))
+		migrate_buckets(h);
+
+	__hash_rw_writer_lock(h);
+
+	prev = h->age_now;
+	now = hash_age_clock();
+	__atomic_store_n(&ht->age_now, now, __ATOMIC_RELAXED);
+
+	budget = RTE_MIN(budget, h->num_buckets);
+	for (; budget > 0; budget--) {
+		idx = h->age_cursor & h->bucket_bitmask;
+		ht->age_cursor = idx + 1;
+
+		head_bkt = &h->buckets[idx];
+		FOR_EACH_BUCKET(cur_bkt, head_bkt)
+			expired += age_scan_bucket(h, cur_bkt, head_bkt, prev,
+						   now, timeout, cb, arg);
+
+		/* The not yet migrated old bucket of a growable table */
+		if (h->old_buckets != NULL && idx < h->num_buckets / 2)
+			expired += age_scan_bucket(h, &h->old_buckets[idx],
+						   NULL, prev, now, timeout, cb, arg);
+	}
+
+	__hash_rw_writer_unlock(h);
+	return expired;
+}
@@ -124,6 +124,12 @@ const rte_hash_cmp_eq_t cmp_jump_table[NUM_KEY_CMP_CASES] = {
 
 #define RTE_HASH_BFS_QUEUE_MAX_LEN       1000
 
+/** Number of buckets of a stopped migration moved by each add or delete */
+#define RTE_HASH_MIGRATE_BKTS		1
+
+/** Key stores and bucket tables retired by the growth of a table */
+#define RTE_HASH_RETIRED_MAX		64
+
 #define RTE_XABORT_CUCKOO_PATH_INVALIDED 0x4
 
 #define RTE_HASH_TSX_MAX_RETRY  10
@@ -202,6 +208,8 @@ struct rte_hash {
 	/**< If read-write concurrency lock free support is enabled */
 	uint8_t writer_takes_lock;
 	/**< Indicates if the writer threads need to take lock */
+	uint8_t aging;
+	/**< If a timestamp is kept with each key */
 	rte_hash_function hash_func;    /**< Function used to calculate hash. */
 	uint32_t hash_func_init_val;    /**< Init value used by hash_func. */
 	rte_hash_cmp_eq_t rte_hash_custom_cmp_eq;
@@ -213,6 +221,8 @@ struct rte_hash {
 	uint32_t bucket_bitmask;
 	/**< Bitmask for getting bucket index from hash signature. */
 	uint32_t key_entry_size;         /**< Size of each key entry. */
+	uint32_t age_offset;
+	/**< Offset of the timestamp in each key entry, if aging. */
 
 	void *key_store;                /**< Table storing all keys and data */
 	struct rte_hash_bucket *buckets;
@@ -231,6 +241,23 @@ struct rte_hash {
 	uint32_t *ext_bkt_to_free;
 	uint32_t *tbl_chng_cnt;
 	/**< Indicates if the hash table changed from last read. */
+
+	/* Fields used by growable tables */
+	uint32_t cur_entries;
+	/**< Number of key slots currently in the key store. */
+	uint8_t growable;               /**< If the table grows when full. */
+	int socket_id;                  /**< NUMA socket of the tables. */
+	struct rte_hash_bucket *old_buckets;
+	/**< Table being migrated to buckets, half its size. NULL if none. */
+	uint32_t migrate_idx;           /**< Next bucket of old_buckets. */
+	uint32_t nb_retired;            /**< Number of retired tables. */
+	void *retired[RTE_HASH_RETIRED_MAX];
+	/**< Tables replaced while lock free readers may still use them. */
+
+	/* Fields used by aging */
+	uint32_t age_now __rte_cache_aligned;
+	/**< Time in ms stored in the keys, updated by the age scan. */
+	uint32_t age_cursor;            /**< Next bucket to scan. */
 } __rte_cache_aligned;
 
 struct queue_node {
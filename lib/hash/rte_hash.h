@@ -56,6 +56,23 @@ extern "C" {
  */
 #define RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF 0x20
 
+/** Flag to start the table with init_entries entries and grow it, up to
+ * entries, when it is full. The add operation which grows the table
+ * migrates the buckets of the smaller table to the larger one, while lock
+ * free readers keep working.
+ * Only single writer mode without RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY and
+ * RTE_HASH_EXTRA_FLAGS_EXT_TABLE is supported. Keys are rehashed with the
+ * hash function of the table when migrated, so the signatures given to the
+ * rte_hash_xxx_with_hash APIs must be computed with rte_hash_hash().
+ */
+#define RTE_HASH_EXTRA_FLAGS_GROWABLE 0x40
+
+/** Flag to keep a timestamp with each key, refreshed when the key is added
+ * or found by a lookup, so that rte_hash_age_scan() can find the keys
+ * which were not used for some time.
+ */
+#define RTE_HASH_EXTRA_FLAGS_AGING 0x80
+
 /**
  * The type of hash value of a key.
  * It should be a value of at least 32bit with fully random pattern.
@@ -76,13 +93,43 @@ typedef int (*rte_hash_cmp_eq_t)(const void *key1, const void *key2, size_t key_
  */
 typedef void (*rte_hash_free_key_data)(void *p, void *key_data);
 
+/** Return value of rte_hash_age_cb_t to delete the expired key. */
+#define RTE_HASH_AGE_DELETE 0
+/** Return value of rte_hash_age_cb_t to keep the expired key. */
+#define RTE_HASH_AGE_KEEP 1
+
+/**
+ * Type of function called by rte_hash_age_scan() for each expired key.
+ * It must not add or delete keys.
+ *
+ * @param arg
+ *   Argument given to rte_hash_age_scan()
+ * @param key
+ *   Expired key
+ * @param data
+ *   Data stored with the key
+ * @param position
+ *   Position of the key, as returned by rte_hash_add_key_xxx APIs
+ * @return
+ *   RTE_HASH_AGE_DELETE to delete the key,
+ *   RTE_HASH_AGE_KEEP to keep it as if it was just used.
+ */
+typedef int (*rte_hash_age_cb_t)(void *arg, const void *key, void *data,
+				 int32_t position);
+
 /**
  * Parameters used when creating the hash table.
  */
 struct rte_hash_parameters {
 	const char *name;		/**< Name of the hash. */
 	uint32_t entries;		/**< Total hash table entries. */
-	uint32_t reserved;		/**< Unused field. Should be set to 0 */
+	union {
+		uint32_t reserved;	/**< Unused field. Should be set to 0 */
+		/** Initial number of entries of a table created with
+		 * RTE_HASH_EXTRA_FLAGS_GROWABLE, 0 for entries / 16.
+		 */
+		uint32_t init_entries;
+	};
 	uint32_t key_len;		/**< Length of hash key. */
 	rte_hash_function hash_func;	/**< Primary Hash function used to calculate hash. */
 	uint32_t hash_func_init_val;	/**< Init value used by hash_func. */
@@ -186,6 +233,7 @@ rte_hash_free(struct rte_hash *h);
  * it is application's responsibility to make sure that
  * none of the readers are referencing the hash table
  * while calling this API.
+ * A table created with RTE_HASH_EXTRA_FLAGS_GROWABLE keeps its current size.
  *
  * @param h
  *   Hash table to reset
@@ -633,6 +681,43 @@ int
 rte_hash_lookup_bulk(const struct rte_hash *h, const void **keys,
 		      uint32_t num_keys, int32_t *positions);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Find any number of keys in the hash table.
+ * The lookups of successive keys are overlapped: the buckets of a key are
+ * prefetched while the signatures of previous keys are compared, and their
+ * matching keys prefetched while the keys of even earlier lookups are
+ * compared, which hides the memory latency of tables larger than the
+ * caches better than successive calls of rte_hash_lookup_bulk().
+ * This operation is multi-thread safe with regarding to other lookup threads.
+ * Read-write concurrency can be enabled by setting flag during
+ * table creation, the reader lock is then held for the whole call.
+ *
+ * @param h
+ *   Hash table to look in.
+ * @param keys
+ *   A pointer to a list of keys to look for.
+ * @param num_keys
+ *   How many keys are in the keys list, no limit.
+ * @param positions
+ *   Output containing a list of values, corresponding to the list of keys that
+ *   can be used by the caller as an offset into an array of user data. These
+ *   values are unique for each key, and are the same values that were returned
+ *   when each key was added. If a key in the list was not found, then -ENOENT
+ *   will be the value.
+ * @param data
+ *   Output containing array of data returned from all the successful lookups,
+ *   NULL if not needed.
+ * @return
+ *   -EINVAL if there's an error, otherwise number of successful lookups.
+ */
+__rte_experimental
+int
+rte_hash_lookup_stream(const struct rte_hash *h, const void **keys,
+		       uint32_t num_keys, int32_t *positions, void *data[]);
+
 /**
  * Iterate through the hash table, returning key-value pairs.
  *
@@ -674,6 +759,47 @@ rte_hash_iterate(const struct rte_hash *h, const void **key, void **data, uint32
  */
 int rte_hash_rcu_qsbr_add(struct rte_hash *h, struct rte_hash_rcu_config *cfg);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Scan the next buckets of a hash table created with
+ * RTE_HASH_EXTRA_FLAGS_AGING for keys which were neither added nor found by
+ * a lookup for timeout milliseconds, and delete them or report them to cb.
+ * Each call continues where the previous one stopped, so that the whole
+ * table is scanned by calling this API periodically.
+ *
+ * The timestamps of the keys are taken from a clock updated by this API,
+ * they have the resolution of the interval between two calls. The keys
+ * found by a lookup since the previous call are never expired, even when
+ * the calls are further apart than the timeout.
+ *
+ * The expired keys are deleted as by rte_hash_del_key(): with integrated
+ * RCU QSBR, they are freed once the readers are done with them, else with
+ * RTE_HASH_EXTRA_FLAGS_NO_FREE_ON_DEL or
+ * RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF their position, given to cb,
+ * must be freed with rte_hash_free_key_with_position().
+ * This API is a writer of the table.
+ *
+ * @param h
+ *   Hash table to scan
+ * @param timeout
+ *   Time in milliseconds after which an unused key expires
+ * @param budget
+ *   Number of buckets to scan
+ * @param cb
+ *   Function called for each expired key, NULL to delete them all
+ * @param arg
+ *   Argument passed to cb
+ * @return
+ *   - Number of expired keys found
+ *   - -EINVAL if the parameters are invalid or aging is not enabled.
+ */
+__rte_experimental
+int
+rte_hash_age_scan(const struct rte_hash *h, uint32_t timeout,
+		  uint32_t budget, rte_hash_age_cb_t cb, void *arg);
+
 #ifdef __cplusplus
 }
 #endif
@@ -3,6 +3,7 @@
  */
 
 #include <unistd.h>
+#include <ctype.h>
 #include <sys/types.h>
 #include <stdbool.h>
 #include <math.h>
@@ -16,6 +17,7 @@
 #include <rte_metrics.h>
 #include <rte_memzone.h>
 #include <rte_lcore.h>
+#include <rte_telemetry.h>
 
 #include "rte_latencystats.h"
 
@@ -58,6 +60,46 @@ struct rte_latency_stats {
 
 static struct rte_latency_stats *glob_stats;
 
+/*
+ * Log-linear latency histogram in cycles: the latencies below
+ * LAT_HIST_SUB_BUCKETS cycles have one bucket each, then each power of 2
+ * is split in LAT_HIST_SUB_BUCKETS linear buckets, so the bucket width is
+ * at most 1/LAT_HIST_SUB_BUCKETS of its latency. The latencies above
+ * 2^LAT_HIST_MAX_BITS cycles share the last bucket.
+ */
+#define LAT_HIST_SUB_BITS 4
+#define LAT_HIST_SUB_BUCKETS (1 << LAT_HIST_SUB_BITS)
+#define LAT_HIST_MAX_BITS 40
+#define LAT_HIST_BUCKETS \
+	((LAT_HIST_MAX_BITS - LAT_HIST_SUB_BITS + 1) * LAT_HIST_SUB_BUCKETS)
+
+/*
+ * Number of Tx queues per port with percentiles in rte_metrics, which
+ * holds no more than RTE_METRICS_MAX_METRICS names in total.
+ */
+#define LAT_HIST_METRICS_MAX_QUEUES 16
+
+struct latency_hist {
+	uint64_t buckets[LAT_HIST_BUCKETS];
+} __rte_cache_aligned;
+
+/* Histograms of all the Tx queues, shared with secondary processes */
+struct latency_hists {
+	uint16_t nb_queues[RTE_MAX_ETHPORTS];
+	uint32_t first[RTE_MAX_ETHPORTS]; /**< Histogram of queue 0 */
+	struct latency_hist hist[];
+};
+
+static const char *MZ_RTE_LATENCY_HISTS = "rte_latencystats_hist";
+static struct latency_hists *glob_hists;
+static int latency_hist_index;
+static uint16_t latency_hist_nb_queues;
+
+static const char * const lat_hist_names[] = {"p50", "p99", "p99_9"};
+static const double lat_hist_percentiles[] = {50, 99, 99.9};
+
+#define NUM_LATENCY_PERCENTILES RTE_DIM(lat_hist_percentiles)
+
 struct rxtx_cbs {
 	const struct rte_eth_rxtx_callback *cb;
 };
@@ -80,6 +122,143 @@ static const struct latency_stats_nameoff lat_stats_strings[] = {
 #define NUM_LATENCY_STATS (sizeof(lat_stats_strings) / \
 				sizeof(lat_stats_strings[0]))
 
+static inline uint32_t
+latency_hist_bucket(uint64_t cycles)
+{
+	uint32_t msb;
+
+	if (cycles < LAT_HIST_SUB_BUCKETS)
+		return cycles;
+	if (cycles >= (UINT64_C(1) << LAT_HIST_MAX_BITS))
+		return LAT_HIST_BUCKETS - 1;
+
+	msb = 63 - __builtin_clzll(cycles);
+	return ((msb - LAT_HIST_SUB_BITS + 1) << LAT_HIST_SUB_BITS) +
+		((cycles >> (msb - LAT_HIST_SUB_BITS)) &
+		 (LAT_HIST_SUB_BUCKETS - 1));
+}
+
+/* Highest latency in cycles counted by a bucket */
+static uint64_t
+latency_hist_bucket_max(uint32_t bucket)
+{
+	uint32_t shift;
+
+	if (bucket < LAT_HIST_SUB_BUCKETS)
+		return bucket;
+
+	shift = (bucket >> LAT_HIST_SUB_BITS) - 1;
+	return (((uint64_t)(bucket & (LAT_HIST_SUB_BUCKETS - 1)) +
+		LAT_HIST_SUB_BUCKETS + 1) << shift) - 1;
+}
+
+static inline void
+latency_hist_add(struct latency_hist *hist, uint64_t cycles)
+{
+	uint64_t *bucket = &hist->buckets[latency_hist_bucket(cycles)];
+
+	/* A Tx queue has a single writer, readers only need untorn values */
+	__atomic_store_n(bucket, *bucket + 1, __ATOMIC_RELAXED);
+}
+
+static struct latency_hists *
+latency_hists_get(void)
+{
+	const struct rte_memzone *mz;
+
+	if (glob_hists == NULL ||
+			rte_eal_process_type() == RTE_PROC_SECONDARY) {
+		mz = rte_memzone_lookup(MZ_RTE_LATENCY_HISTS);
+		glob_hists = mz != NULL ? mz->addr : NULL;
+	}
+	return glob_hists;
+}
+
+static const struct latency_hist *
+latency_hist_get(uint16_t port_id, uint16_t queue_id)
+{
+	const struct latency_hists *hists = latency_hists_get();
+
+	if (hists == NULL || port_id >= RTE_MAX_ETHPORTS ||
+			queue_id >= hists->nb_queues[port_id])
+		return NULL;
+	return &hists->hist[hists->first[port_id] + queue_id];
+}
+
+/*
+ * Compute n percentiles in nano seconds of a histogram, in increasing
+ * order of percentile. Return the number of latency samples.
+ */
+static uint64_t
+latency_hist_percentiles(const struct latency_hist *hist,
+		const double *percentiles, uint64_t *latency_ns, unsigned int n)
+{
+	uint64_t counts[LAT_HIST_BUCKETS];
+	uint64_t total = 0, sum = 0, rank;
+	unsigned int i, b = 0;
+
+	/* Snapshot the buckets updated concurrently by the Tx callback */
+	for (i = 0; i < LAT_HIST_BUCKETS; i++) {
+		counts[i] = __atomic_load_n(&hist->buckets[i],
+				__ATOMIC_RELAXED);
+		total += counts[i];
+	}
+
+	for (i = 0; i < n; i++) {
+		latency_ns[i] = 0;
+		if (total == 0)
+			continue;
+
+		rank = RTE_MAX((uint64_t)ceil(total * percentiles[i] / 100),
+				UINT64_C(1));
+		while (b < LAT_HIST_BUCKETS && sum + counts[b] < rank)
+			sum += counts[b++];
+		latency_ns[i] = (uint64_t)(latency_hist_bucket_max(
+				RTE_MIN(b, LAT_HIST_BUCKETS - 1U)) * NS_PER_SEC /
+				rte_get_timer_hz());
+	}
+
+	return total;
+}
+
+/* Push the percentiles of the first Tx queues of each port to rte_metrics */
+static int32_t
+latency_hist_update(void)
+{
+	uint64_t values[LAT_HIST_METRICS_MAX_QUEUES * NUM_LATENCY_PERCENTILES];
+	const struct latency_hists *hists = latency_hists_get();
+	uint16_t pid, qid, nb_queues;
+	int ret;
+
+	if (hists == NULL || latency_hist_nb_queues == 0)
+		return 0;
+
+	for (pid = 0; pid < RTE_MAX_ETHPORTS; pid++) {
+		nb_queues = RTE_MIN(hists->nb_queues[pid],
+				latency_hist_nb_queues);
+		if (nb_queues == 0)
+			continue;
+
+		for (qid = 0; qid < nb_queues; qid++)
+			latency_hist_percentiles(
+				&hists->hist[hists->first[pid] + qid],
+				lat_hist_percentiles,
+				&values[qid * NUM_LATENCY_PERCENTILES],
+				NUM_LATENCY_PERCENTILES);
+
+		ret = rte_metrics_update_values(pid, latency_hist_index,
+				values, nb_queues * NUM_LATENCY_PERCENTILES);
+		if (ret < 0) {
+			RTE_LOG(INFO, LATENCY_STATS,
+				"Failed to push the port %u percentiles\n",
+				pid);
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
 int32_t
 rte_latencystats_update(void)
 {
@@ -98,10 +277,12 @@ rte_latencystats_update(void)
 	ret = rte_metrics_update_values(RTE_METRICS_GLOBAL,
 					latency_stats_index,
 					values, NUM_LATENCY_STATS);
-	if (ret < 0)
+	if (ret < 0) {
 		RTE_LOG(INFO, LATENCY_STATS, "Failed to push the stats\n");
+		return ret;
+	}
 
-	return ret;
+	return latency_hist_update();
 }
 
 static void
@@ -157,10 +338,11 @@ calc_latency(uint16_t pid __rte_unused,
 		uint16_t qid __rte_unused,
 		struct rte_mbuf **pkts,
 		uint16_t nb_pkts,
-		void *_ __rte_unused)
+		void *arg)
 {
+	struct latency_hist *hist = arg;
 	unsigned int i, cnt = 0;
-	uint64_t now;
+	uint64_t now, cycles;
 	float latency[nb_pkts];
 	static float prev_latency;
 	/*
@@ -172,8 +354,11 @@ calc_latency(uint16_t pid __rte_unused,
 
 	now = rte_rdtsc();
 	for (i = 0; i < nb_pkts; i++) {
-		if (pkts[i]->ol_flags & timestamp_dynflag)
-			latency[cnt++] = now - *timestamp_dynfield(pkts[i]);
+		if (pkts[i]->ol_flags & timestamp_dynflag) {
+			cycles = now - *timestamp_dynfield(pkts[i]);
+			latency_hist_add(hist, cycles);
+			latency[cnt++] = cycles;
+		}
 	}
 
 	rte_spinlock_lock(&glob_stats->lock);
@@ -211,6 +396,85 @@ calc_latency(uint16_t pid __rte_unused,
 	return nb_pkts;
 }
 
+static void
+latency_hist_free(void)
+{
+	const struct rte_memzone *mz;
+
+	mz = rte_memzone_lookup(MZ_RTE_LATENCY_HISTS);
+	if (mz)
+		rte_memzone_free(mz);
+	glob_hists = NULL;
+	latency_hist_nb_queues = 0;
+}
+
+/* Allocate the histograms of all Tx queues and register their metrics */
+static int
+latency_hist_init(void)
+{
+	char names[LAT_HIST_METRICS_MAX_QUEUES * NUM_LATENCY_PERCENTILES]
+		[RTE_METRICS_MAX_NAME_LEN];
+	const char *ptr_strings[RTE_DIM(names)];
+	uint16_t nb_queues[RTE_MAX_ETHPORTS] = {0};
+	const struct rte_memzone *mz;
+	uint32_t nb_hists = 0;
+	uint16_t pid, max_queues = 0;
+	unsigned int i, n;
+
+	RTE_ETH_FOREACH_DEV(pid) {
+		struct rte_eth_dev_info dev_info;
+
+		if (rte_eth_dev_info_get(pid, &dev_info) != 0)
+			continue;
+		nb_queues[pid] = dev_info.nb_tx_queues;
+		nb_hists += nb_queues[pid];
+		max_queues = RTE_MAX(max_queues, nb_queues[pid]);
+	}
+
+	mz = rte_memzone_reserve(MZ_RTE_LATENCY_HISTS,
+			sizeof(*glob_hists) +
+			nb_hists * sizeof(glob_hists->hist[0]),
+			rte_socket_id(), 0);
+	if (mz == NULL) {
+		RTE_LOG(ERR, LATENCY_STATS, "Cannot reserve memory: %s:%d\n",
+			__func__, __LINE__);
+		return -ENOMEM;
+	}
+	glob_hists = mz->addr;
+	memset(glob_hists, 0, mz->len);
+
+	nb_hists = 0;
+	for (pid = 0; pid < RTE_MAX_ETHPORTS; pid++) {
+		glob_hists->nb_queues[pid] = nb_queues[pid];
+		glob_hists->first[pid] = nb_hists;
+		nb_hists += nb_queues[pid];
+	}
+
+	/* Register the percentiles of the first queues with stats library */
+	latency_hist_nb_queues = RTE_MIN(max_queues,
+			LAT_HIST_METRICS_MAX_QUEUES);
+	n = latency_hist_nb_queues * NUM_LATENCY_PERCENTILES;
+	if (n == 0)
+		return 0;
+
+	for (i = 0; i < n; i++) {
+		snprintf(names[i], sizeof(names[i]), "tx_q%u_%s_latency_ns",
+			(unsigned int)(i / NUM_LATENCY_PERCENTILES),
+			lat_hist_names[i % NUM_LATENCY_PERCENTILES]);
+		ptr_strings[i] = names[i];
+	}
+
+	latency_hist_index = rte_metrics_reg_names(ptr_strings, n);
+	if (latency_hist_index < 0) {
+		RTE_LOG(DEBUG, LATENCY_STATS,
+			"Failed to register latency percentiles names\n");
+		latency_hist_free();
+		return -1;
+	}
+
+	return 0;
+}
+
 int
 rte_latencystats_init(uint64_t app_samp_intvl,
 		rte_latency_stats_flow_type_fn user_cb)
@@ -249,16 +513,23 @@ rte_latencystats_init(uint64_t app_samp_intvl,
 	if (latency_stats_index < 0) {
 		RTE_LOG(DEBUG, LATENCY_STATS,
 			"Failed to register latency stats names\n");
-		return -1;
+		ret = -1;
+		goto free_stats;
 	}
 
+	ret = latency_hist_init();
+	if (ret != 0)
+		goto free_stats;
+
 	/* Register mbuf field and flag for Rx timestamp */
 	ret = rte_mbuf_dyn_rx_timestamp_register(&timestamp_dynfield_offset,
 			&timestamp_dynflag);
 	if (ret != 0) {
 		RTE_LOG(ERR, LATENCY_STATS,
 			"Cannot register mbuf field/flag for timestamp\n");
-		return -rte_errno;
+		ret = -rte_errno;
+		latency_hist_free();
+		goto free_stats;
 	}
 
 	/** Register Rx/Tx callbacks */
@@ -286,7 +557,8 @@ rte_latencystats_init(uint64_t app_samp_intvl,
 		for (qid = 0; qid < dev_info.nb_tx_queues; qid++) {
 			cbs = &tx_cbs[pid][qid];
 			cbs->cb =  rte_eth_add_tx_callback(pid, qid,
-					calc_latency, user_cb);
+					calc_latency, &glob_hists->hist[
+						glob_hists->first[pid] + qid]);
 			if (!cbs->cb)
 				RTE_LOG(INFO, LATENCY_STATS, "Failed to "
 					"register Tx callback for pid=%d, "
@@ -294,6 +566,12 @@ rte_latencystats_init(uint64_t app_samp_intvl,
 		}
 	}
 	return 0;
+
+free_stats:
+	/* Let a later init start over */
+	rte_memzone_free(mz);
+	glob_stats = NULL;
+	return ret;
 }
 
 int
@@ -340,6 +618,7 @@ rte_latencystats_uninit(void)
 	mz = rte_memzone_lookup(MZ_RTE_LATENCY_STATS);
 	if (mz)
 		rte_memzone_free(mz);
+	latency_hist_free();
 
 	return 0;
 }
@@ -381,3 +660,79 @@ rte_latencystats_get(struct rte_metric_value *values, uint16_t size)
 
 	return NUM_LATENCY_STATS;
 }
+
+int
+rte_latencystats_queue_percentile(uint16_t port_id, uint16_t queue_id,
+		double percentile, uint64_t *latency_ns)
+{
+	const struct latency_hist *hist;
+
+	if (latency_ns == NULL || percentile < 0 || percentile > 100)
+		return -EINVAL;
+
+	hist = latency_hist_get(port_id, queue_id);
+	if (hist == NULL)
+		return -EINVAL;
+
+	if (latency_hist_percentiles(hist, &percentile, latency_ns, 1) == 0)
+		return -ENODATA;
+
+	return 0;
+}
+
+static int
+latencystats_handle_queues(const char *cmd __rte_unused,
+		const char *params,
+		struct rte_tel_data *d)
+{
+	uint64_t values[NUM_LATENCY_PERCENTILES];
+	struct rte_tel_data *q_data[NUM_LATENCY_PERCENTILES + 1];
+	const struct latency_hist *hist;
+	char name[RTE_TEL_MAX_STRING_LEN];
+	uint16_t port_id, qid;
+	unsigned int i;
+
+	if (params == NULL || strlen(params) == 0 || !isdigit(*params))
+		return -1;
+
+	port_id = atoi(params);
+	if (latency_hist_get(port_id, 0) == NULL)
+		return -1;
+
+	for (i = 0; i < RTE_DIM(q_data); i++) {
+		q_data[i] = rte_tel_data_alloc();
+		if (q_data[i] == NULL) {
+			while (i-- > 0)
+				rte_tel_data_free(q_data[i]);
+			return -ENOMEM;
+		}
+		rte_tel_data_start_array(q_data[i], RTE_TEL_U64_VAL);
+	}
+
+	for (qid = 0; qid < RTE_TEL_MAX_ARRAY_ENTRIES &&
+			(hist = latency_hist_get(port_id, qid)) != NULL; qid++) {
+		rte_tel_data_add_array_u64(q_data[NUM_LATENCY_PERCENTILES],
+			latency_hist_percentiles(hist, lat_hist_percentiles,
+				values, NUM_LATENCY_PERCENTILES));
+		for (i = 0; i < NUM_LATENCY_PERCENTILES; i++)
+			rte_tel_data_add_array_u64(q_data[i], values[i]);
+	}
+
+	rte_tel_data_start_dict(d);
+	rte_tel_data_add_dict_container(d, "samples",
+			q_data[NUM_LATENCY_PERCENTILES], 0);
+	for (i = 0; i < NUM_LATENCY_PERCENTILES; i++) {
+		snprintf(name, sizeof(name), "%s_latency_ns",
+				lat_hist_names[i]);
+		rte_tel_data_add_dict_container(d, name, q_data[i], 0);
+	}
+
+	return 0;
+}
+
+RTE_INIT(latencystats_init_telemetry)
+{
+	rte_telemetry_register_cmd("/latencystats/queues",
+			latencystats_handle_queues,
+			"Returns the latency percentiles of each Tx queue of a port. Parameters: int port_id");
+}
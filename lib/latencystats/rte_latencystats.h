@@ -43,6 +43,13 @@ typedef uint16_t (*rte_latency_stats_flow_type_fn)(struct rte_mbuf *pkt,
 /**
  *  Registers Rx/Tx callbacks for each active port, queue.
  *
+ *  A latency histogram is allocated for every Tx queue, but the
+ *  rte_metrics API only reports the percentiles of the first 16 Tx queues
+ *  of each port, as it is limited to RTE_METRICS_MAX_METRICS names.
+ *  The percentiles of all queues are available through
+ *  rte_latencystats_queue_percentile() and the /latencystats/queues
+ *  telemetry command.
+ *
  * @param samp_intvl
  *  Sampling time period in nano seconds, at which packet
  *  should be marked with time stamp.
@@ -121,6 +128,37 @@ int rte_latencystats_get_names(struct rte_metric_name *names,
 int rte_latencystats_get(struct rte_metric_value *values,
 			uint16_t size);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Retrieve a latency percentile of a Tx queue.
+ *
+ * The latency of each sampled packet is counted in a log-linear histogram
+ * of its Tx queue, whose bucket width is at most 1/16 of the latency.
+ * The percentile is the upper bound of the bucket it falls in.
+ * The 50th, 99th and 99.9th percentiles of the first 16 Tx queues of each
+ * port are also exposed per port by *rte_latencystats_update* through the
+ * rte_metrics API, and those of all queues by the /latencystats/queues
+ * telemetry command.
+ *
+ * @param port_id
+ *   The port identifier of the Ethernet device.
+ * @param queue_id
+ *   The Tx queue on which the packets were sent.
+ * @param percentile
+ *   The percentile to compute, between 0 and 100, e.g. 99.9.
+ * @param latency_ns
+ *   Output the latency percentile in nano seconds.
+ * @return
+ *    0      : On success
+ *   -EINVAL : Invalid port, queue or percentile
+ *   -ENODATA: No packet latency sampled yet on the queue
+ */
+__rte_experimental
+int rte_latencystats_queue_percentile(uint16_t port_id, uint16_t queue_id,
+		double percentile, uint64_t *latency_ns);
+
 #ifdef __cplusplus
 }
 #endif
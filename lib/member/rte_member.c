@@ -15,6 +15,7 @@
 #include "rte_member.h"
 #include "rte_member_ht.h"
 #include "rte_member_vbf.h"
+#include "rte_member_sketch.h"
 
 TAILQ_HEAD(rte_member_list, rte_tailq_entry);
 static struct rte_tailq_elem rte_member_tailq = {
@@ -74,6 +75,9 @@ rte_member_free(struct rte_member_setsum *setsum)
 	case RTE_MEMBER_TYPE_VBF:
 		rte_member_free_vbf(setsum);
 		break;
+	case RTE_MEMBER_TYPE_SKETCH:
+		rte_member_free_sketch(setsum);
+		break;
 	default:
 		break;
 	}
@@ -147,6 +151,9 @@ rte_member_create(const struct rte_member_parameters *params)
 	case RTE_MEMBER_TYPE_VBF:
 		ret = rte_member_create_vbf(setsum, params);
 		break;
+	case RTE_MEMBER_TYPE_SKETCH:
+		ret = rte_member_create_sketch(setsum, params);
+		break;
 	default:
 		goto error_unlock_exit;
 	}
@@ -180,11 +187,47 @@ rte_member_add(const struct rte_member_setsum *setsum, const void *key,
 		return rte_member_add_ht(setsum, key, set_id);
 	case RTE_MEMBER_TYPE_VBF:
 		return rte_member_add_vbf(setsum, key, set_id);
+	case RTE_MEMBER_TYPE_SKETCH:
+		return rte_member_add_sketch(setsum, key, 1);
 	default:
 		return -EINVAL;
 	}
 }
 
+int
+rte_member_add_byte_count(const struct rte_member_setsum *setsum,
+			const void *key, uint32_t byte_count)
+{
+	if (setsum == NULL || key == NULL ||
+			setsum->type != RTE_MEMBER_TYPE_SKETCH)
+		return -EINVAL;
+
+	return rte_member_add_sketch(setsum, key, byte_count);
+}
+
+int
+rte_member_query_count(const struct rte_member_setsum *setsum,
+			const void *key, uint64_t *count)
+{
+	if (setsum == NULL || key == NULL || count == NULL ||
+			setsum->type != RTE_MEMBER_TYPE_SKETCH)
+		return -EINVAL;
+
+	*count = rte_member_query_sketch(setsum, key);
+	return 0;
+}
+
+int
+rte_member_report_heavyhitter(const struct rte_member_setsum *setsum,
+			void **keys, uint64_t *counts)
+{
+	if (setsum == NULL || keys == NULL || counts == NULL ||
+			setsum->type != RTE_MEMBER_TYPE_SKETCH)
+		return -EINVAL;
+
+	return rte_member_report_heavyhitter_sketch(setsum, keys, counts);
+}
+
 int
 rte_member_lookup(const struct rte_member_setsum *setsum, const void *key,
 			member_set_t *set_id)
@@ -292,6 +335,9 @@ rte_member_reset(const struct rte_member_setsum *setsum)
 	case RTE_MEMBER_TYPE_VBF:
 		rte_member_reset_vbf(setsum);
 		return;
+	case RTE_MEMBER_TYPE_SKETCH:
+		rte_member_reset_sketch(setsum);
+		return;
 	default:
 		return;
 	}
@@ -16,6 +16,10 @@
  * cache and non-cache modes. The table below summarize some properties of
  * the different implementations.
  *
+ * A third type, the count-min sketch, does not test membership but estimates
+ * how many times each key was added and reports the heaviest keys, for
+ * example to find the elephant flows of a traffic.
+ *
  * @warning
  * @b EXPERIMENTAL: this API may change without prior notice
  */
@@ -105,6 +109,7 @@ struct rte_member_parameters;
 enum rte_member_setsum_type {
 	RTE_MEMBER_TYPE_HT = 0,  /**< Hash table based set summary. */
 	RTE_MEMBER_TYPE_VBF,     /**< Vector of bloom filters. */
+	RTE_MEMBER_TYPE_SKETCH,  /**< Count-min sketch with heavy hitters. */
 	RTE_MEMBER_NUM_TYPE
 };
 
@@ -167,6 +172,10 @@ struct rte_member_parameters {
 	 *
 	 * vBF setsummary is a vector of bloom filters. It is used when number
 	 * of sets is not big (less than 32 for current implementation).
+	 *
+	 * Sketch setsummary counts the keys instead of storing their set. It
+	 * is used to estimate the count of any key and to find the top_k
+	 * heaviest keys.
 	 */
 	enum rte_member_setsum_type type;
 
@@ -244,6 +253,11 @@ struct rte_member_parameters {
 	 * to number of entries (num_keys) divided by entry count per bucket
 	 * (RTE_MEMBER_BUCKET_ENTRIES). Thus, the false_positive_rate is not
 	 * directly set by users for HT mode.
+	 *
+	 * For sketch, false_positive_rate is the probability that the
+	 * estimated count of a key exceeds its real count by more than
+	 * error_rate times the total count. It sets the number of counter
+	 * rows, i.e. of hashes per key.
 	 */
 	float false_positive_rate;
 
@@ -263,6 +277,25 @@ struct rte_member_parameters {
 	uint32_t sec_hash_seed;
 
 	int socket_id;			/**< NUMA Socket ID for memory. */
+
+	/**
+	 * error_rate is only used for sketch.
+	 *
+	 * The estimated count of a key exceeds its real count by at most
+	 * error_rate times the total count of all keys, with the probability
+	 * given by false_positive_rate. It sets the number of counters per
+	 * row, e / error_rate rounded up to a power of 2.
+	 */
+	float error_rate;
+
+	/**
+	 * top_k is only used for sketch.
+	 *
+	 * Number of the heaviest keys tracked by the sketch, along with their
+	 * estimated count. The keys are copied in the sketch so the memory
+	 * used grows with top_k * key_len.
+	 */
+	uint32_t top_k;
 };
 
 /**
@@ -431,6 +464,8 @@ rte_member_lookup_multi_bulk(const struct rte_member_setsum *setsum,
  *   eviction, return 1 otherwise. Return 0 for non-cache mode if success,
  *   -ENOSPC for full, and 1 if cuckoo eviction happens.
  *   Always returns 0 for vBF mode.
+ *   For sketch mode, set_id is ignored and the count of the key is
+ *   incremented by 1. Always returns 0 for sketch mode.
  */
 int
 rte_member_add(const struct rte_member_setsum *setsum, const void *key,
@@ -483,6 +518,73 @@ int
 rte_member_delete(const struct rte_member_setsum *setsum, const void *key,
 			member_set_t set_id);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Add a key to a sketch set-summary with a count other than 1, for example
+ * the number of bytes of a packet to find the flows sending the most bytes.
+ *
+ * @param setsum
+ *   Pointer of a sketch set-summary.
+ * @param key
+ *   Pointer of the key to be added.
+ * @param byte_count
+ *   Value added to the count of the key.
+ * @return
+ *   0 on success, -EINVAL if the set-summary is not a sketch.
+ */
+__rte_experimental
+int
+rte_member_add_byte_count(const struct rte_member_setsum *setsum,
+			const void *key, uint32_t byte_count);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Query the estimated count of a key in a sketch set-summary.
+ * The estimation is never below the real count of the key.
+ *
+ * @param setsum
+ *   Pointer of a sketch set-summary.
+ * @param key
+ *   Pointer of the key to be queried.
+ * @param count
+ *   Output the estimated count of the key.
+ * @return
+ *   0 on success, -EINVAL if the set-summary is not a sketch.
+ */
+__rte_experimental
+int
+rte_member_query_count(const struct rte_member_setsum *setsum,
+			const void *key, uint64_t *count);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Report the heaviest keys of a sketch set-summary, by decreasing estimated
+ * count.
+ *
+ * @param setsum
+ *   Pointer of a sketch set-summary.
+ * @param keys
+ *   Output pointers to the keys. The keys are stored in the set-summary and
+ *   are only valid until the next add or reset. User should preallocate an
+ *   array of top_k pointers.
+ * @param counts
+ *   Output the estimated count of each key. User should preallocate an
+ *   array of top_k counts.
+ * @return
+ *   The number of keys reported, at most top_k, or -EINVAL if the
+ *   set-summary is not a sketch.
+ */
+__rte_experimental
+int
+rte_member_report_heavyhitter(const struct rte_member_setsum *setsum,
+			void **keys, uint64_t *counts);
+
 #ifdef __cplusplus
 }
 #endif
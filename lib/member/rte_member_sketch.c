@@ -0,0 +1,324 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2017 Intel Corporation
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include <rte_malloc.h>
+#include <rte_memory.h>
+#include <rte_errno.h>
+#include <rte_log.h>
+#include <rte_prefetch.h>
+#include <rte_vect.h>
+
+#include "rte_member.h"
+#include "rte_member_sketch.h"
+
+#if defined(RTE_ARCH_X86)
+#include "rte_member_sketch_x86.h"
+#endif
+
+/*
+ * The count-min sketch is a matrix of num_row rows of num_col counters.
+ * Adding a key increments one counter per row, the one of row r being
+ * picked by (h1 + r * h2) as for vBF. The estimated count of a key is the
+ * minimum of its counters: it is never below the real count and, with
+ * num_col = e / error_rate and num_row = ln(1 / false_positive_rate), it
+ * exceeds the real count by at most error_rate times the total count with
+ * probability 1 - false_positive_rate.
+ *
+ * The heaviest keys are kept in top_k slots with their estimated count.
+ * The slots are ordered by a min-heap of their counts, so a new key is
+ * tracked as soon as its estimated count exceeds the lightest tracked key,
+ * which it replaces. The slot of a key is found by comparing a 32-bit
+ * signature of all the slots at once with SIMD, then the key itself.
+ */
+int
+rte_member_create_sketch(struct rte_member_setsum *ss,
+		const struct rte_member_parameters *params)
+{
+	struct member_sketch *sk;
+	uint32_t num_row, num_col, num_sig;
+	size_t sk_size, counters_size, sigs_size, counts_size, heap_size;
+	size_t keys_size;
+	uint8_t *mem;
+
+	if (params->error_rate <= 0 || params->error_rate >= 1 ||
+			params->false_positive_rate <= 0 ||
+			params->false_positive_rate >= 1 ||
+			params->top_k == 0) {
+		rte_errno = EINVAL;
+		RTE_MEMBER_LOG(ERR, "Membership sketch create with invalid parameters\n");
+		return -EINVAL;
+	}
+
+	num_col = rte_align32pow2((uint32_t)ceil(M_E / params->error_rate));
+	num_row = (uint32_t)ceil(log(1 / params->false_positive_rate));
+	if (num_col == 0 || num_col > RTE_MEMBER_ENTRIES_MAX ||
+			num_row > RTE_MEMBER_SKETCH_MAX_ROW) {
+		rte_errno = EINVAL;
+		RTE_MEMBER_LOG(ERR, "Membership sketch error rate or false positive rate is too small\n");
+		return -EINVAL;
+	}
+
+	/* Signatures are padded to whole AVX2 registers */
+	num_sig = RTE_ALIGN_CEIL(params->top_k, 8);
+
+	sk_size = RTE_ALIGN_CEIL(sizeof(*sk), RTE_CACHE_LINE_SIZE);
+	counters_size = RTE_ALIGN_CEIL((size_t)num_row * num_col *
+			sizeof(uint64_t), RTE_CACHE_LINE_SIZE);
+	sigs_size = RTE_ALIGN_CEIL(num_sig * sizeof(uint32_t),
+			RTE_CACHE_LINE_SIZE);
+	counts_size = RTE_ALIGN_CEIL(params->top_k * sizeof(uint64_t),
+			RTE_CACHE_LINE_SIZE);
+	heap_size = RTE_ALIGN_CEIL(params->top_k * sizeof(uint32_t),
+			RTE_CACHE_LINE_SIZE);
+	keys_size = (size_t)params->top_k * params->key_len;
+
+	mem = rte_zmalloc_socket(NULL, sk_size + counters_size + sigs_size +
+			counts_size + 2 * heap_size + keys_size,
+			RTE_CACHE_LINE_SIZE, ss->socket_id);
+	if (mem == NULL)
+		return -ENOMEM;
+
+	sk = (struct member_sketch *)mem;
+	mem += sk_size;
+	sk->counters = (uint64_t *)mem;
+	mem += counters_size;
+	sk->sigs = (uint32_t *)mem;
+	mem += sigs_size;
+	sk->counts = (uint64_t *)mem;
+	mem += counts_size;
+	sk->heap = (uint32_t *)mem;
+	mem += heap_size;
+	sk->heap_pos = (uint32_t *)mem;
+	mem += heap_size;
+	sk->keys = mem;
+
+	sk->num_row = num_row;
+	sk->num_col = num_col;
+	sk->col_mask = num_col - 1;
+	sk->top_k = params->top_k;
+	sk->num_heavy = 0;
+	ss->table = sk;
+
+#if defined(RTE_ARCH_X86)
+	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX2) &&
+			rte_vect_get_max_simd_bitwidth() >= RTE_VECT_SIMD_256)
+		ss->sig_cmp_fn = RTE_MEMBER_COMPARE_AVX2;
+	else
+#endif
+		ss->sig_cmp_fn = RTE_MEMBER_COMPARE_SCALAR;
+
+	RTE_MEMBER_LOG(DEBUG, "count-min sketch created, "
+		"%u rows of %u counters, tracking %u heavy hitters\n",
+		num_row, num_col, sk->top_k);
+
+	return 0;
+}
+
+static inline uint32_t
+search_sig(const uint32_t *sigs, uint32_t start, uint32_t num, uint32_t sig)
+{
+	uint32_t i;
+
+	for (i = start; i < num; i++) {
+		if (sigs[i] == sig)
+			break;
+	}
+	return i;
+}
+
+static inline uint8_t *
+sketch_slot_key(const struct rte_member_setsum *ss,
+		const struct member_sketch *sk, uint32_t slot)
+{
+	return &sk->keys[(size_t)slot * ss->key_len];
+}
+
+/* Return the heavy hitter slot of the key, or num_heavy if not tracked */
+static inline uint32_t
+sketch_find_slot(const struct rte_member_setsum *ss,
+		const struct member_sketch *sk, const void *key, uint32_t sig)
+{
+	uint32_t slot = 0;
+
+	for (;;) {
+		switch (ss->sig_cmp_fn) {
+#if defined(RTE_ARCH_X86) && defined(__AVX2__)
+		case RTE_MEMBER_COMPARE_AVX2:
+			slot = search_sig_avx(sk->sigs, slot, sk->num_heavy,
+					sig);
+			break;
+#endif
+		default:
+			slot = search_sig(sk->sigs, slot, sk->num_heavy, sig);
+		}
+
+		if (slot == sk->num_heavy ||
+				memcmp(sketch_slot_key(ss, sk, slot), key,
+					ss->key_len) == 0)
+			return slot;
+		slot++;
+	}
+}
+
+static inline void
+sketch_heap_swap(struct member_sketch *sk, uint32_t a, uint32_t b)
+{
+	uint32_t slot = sk->heap[a];
+
+	sk->heap[a] = sk->heap[b];
+	sk->heap[b] = slot;
+	sk->heap_pos[sk->heap[a]] = a;
+	sk->heap_pos[sk->heap[b]] = b;
+}
+
+/* Move a heap entry up while its count is below the count of its parent */
+static void
+sketch_heap_up(struct member_sketch *sk, uint32_t pos)
+{
+	uint32_t parent;
+
+	while (pos > 0) {
+		parent = (pos - 1) / 2;
+		if (sk->counts[sk->heap[parent]] <= sk->counts[sk->heap[pos]])
+			break;
+		sketch_heap_swap(sk, parent, pos);
+		pos = parent;
+	}
+}
+
+/* Move a heap entry down while its count is above the count of a child */
+static void
+sketch_heap_down(struct member_sketch *sk, uint32_t pos)
+{
+	uint32_t child, min;
+
+	for (;;) {
+		min = pos;
+		child = 2 * pos + 1;
+		if (child < sk->num_heavy &&
+				sk->counts[sk->heap[child]] <
+				sk->counts[sk->heap[min]])
+			min = child;
+		child++;
+		if (child < sk->num_heavy &&
+				sk->counts[sk->heap[child]] <
+				sk->counts[sk->heap[min]])
+			min = child;
+		if (min == pos)
+			return;
+		sketch_heap_swap(sk, min, pos);
+		pos = min;
+	}
+}
+
+int
+rte_member_add_sketch(const struct rte_member_setsum *ss, const void *key,
+		uint64_t count)
+{
+	struct member_sketch *sk = ss->table;
+	uint32_t h1 = MEMBER_HASH_FUNC(key, ss->key_len, ss->prim_hash_seed);
+	uint32_t h2 = MEMBER_HASH_FUNC(&h1, sizeof(uint32_t),
+						ss->sec_hash_seed);
+	uint64_t *counters[RTE_MEMBER_SKETCH_MAX_ROW];
+	uint64_t est = UINT64_MAX;
+	uint32_t i, slot;
+
+	/* The rows are in distinct cache lines, fetch them all first */
+	for (i = 0; i < sk->num_row; i++) {
+		counters[i] = &sk->counters[i * sk->num_col +
+				((h1 + i * h2) & sk->col_mask)];
+		rte_prefetch0(counters[i]);
+	}
+	for (i = 0; i < sk->num_row; i++) {
+		*counters[i] += count;
+		est = RTE_MIN(est, *counters[i]);
+	}
+
+	slot = sketch_find_slot(ss, sk, key, h1);
+	if (slot < sk->num_heavy) {
+		/* Already tracked, its count only grows */
+		sk->counts[slot] = est;
+		sketch_heap_down(sk, sk->heap_pos[slot]);
+		return 0;
+	}
+
+	if (sk->num_heavy < sk->top_k) {
+		slot = sk->num_heavy++;
+		sk->heap[slot] = slot;
+		sk->heap_pos[slot] = slot;
+	} else {
+		/* Replace the lightest tracked key if the new one is heavier */
+		slot = sk->heap[0];
+		if (est <= sk->counts[slot])
+			return 0;
+	}
+
+	sk->sigs[slot] = h1;
+	sk->counts[slot] = est;
+	memcpy(sketch_slot_key(ss, sk, slot), key, ss->key_len);
+	if (sk->heap_pos[slot] == 0)
+		sketch_heap_down(sk, 0);
+	else
+		sketch_heap_up(sk, sk->heap_pos[slot]);
+
+	return 0;
+}
+
+uint64_t
+rte_member_query_sketch(const struct rte_member_setsum *ss, const void *key)
+{
+	const struct member_sketch *sk = ss->table;
+	uint32_t h1 = MEMBER_HASH_FUNC(key, ss->key_len, ss->prim_hash_seed);
+	uint32_t h2 = MEMBER_HASH_FUNC(&h1, sizeof(uint32_t),
+						ss->sec_hash_seed);
+	uint64_t est = UINT64_MAX;
+	uint32_t i;
+
+	for (i = 0; i < sk->num_row; i++)
+		est = RTE_MIN(est, sk->counters[i * sk->num_col +
+				((h1 + i * h2) & sk->col_mask)]);
+
+	return est;
+}
+
+uint32_t
+rte_member_report_heavyhitter_sketch(const struct rte_member_setsum *ss,
+		void **keys, uint64_t *counts)
+{
+	const struct member_sketch *sk = ss->table;
+	uint32_t i, j;
+	uint64_t count;
+
+	/* Insertion sort by decreasing count, top_k is small */
+	for (i = 0; i < sk->num_heavy; i++) {
+		count = sk->counts[i];
+		for (j = i; j > 0 && counts[j - 1] < count; j--) {
+			counts[j] = counts[j - 1];
+			keys[j] = keys[j - 1];
+		}
+		counts[j] = count;
+		keys[j] = sketch_slot_key(ss, sk, i);
+	}
+
+	return sk->num_heavy;
+}
+
+void
+rte_member_free_sketch(struct rte_member_setsum *ss)
+{
+	rte_free(ss->table);
+}
+
+void
+rte_member_reset_sketch(const struct rte_member_setsum *ss)
+{
+	struct member_sketch *sk = ss->table;
+
+	memset(sk->counters, 0,
+		(size_t)sk->num_row * sk->num_col * sizeof(uint64_t));
+	sk->num_heavy = 0;
+}
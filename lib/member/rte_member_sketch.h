@@ -0,0 +1,59 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2017 Intel Corporation
+ */
+
+#ifndef _RTE_MEMBER_SKETCH_H_
+#define _RTE_MEMBER_SKETCH_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Maximum number of counter rows, i.e. hashes per key, in the sketch */
+#define RTE_MEMBER_SKETCH_MAX_ROW 16
+
+/*
+ * Count-min sketch with the heavy hitter slots, stored in the table of the
+ * set-summary. The arrays point into the same allocation.
+ */
+struct member_sketch {
+	uint32_t num_row;	/* Number of counter rows. */
+	uint32_t num_col;	/* Number of counters per row. */
+	uint32_t col_mask;	/* Bit mask to get the counter in a row. */
+	uint32_t top_k;		/* Number of heavy hitter slots. */
+	uint32_t num_heavy;	/* Number of used heavy hitter slots. */
+	uint32_t *sigs;		/* Signature of the key of each slot. */
+	uint64_t *counts;	/* Estimated count of the key of each slot. */
+	uint32_t *heap;		/* Min-heap of the slots by estimated count. */
+	uint32_t *heap_pos;	/* Position of each slot in the heap. */
+	uint8_t *keys;		/* Key of each slot. */
+	uint64_t *counters;	/* num_row rows of num_col counters. */
+};
+
+int
+rte_member_create_sketch(struct rte_member_setsum *ss,
+		const struct rte_member_parameters *params);
+
+int
+rte_member_add_sketch(const struct rte_member_setsum *setsum,
+		const void *key, uint64_t count);
+
+uint64_t
+rte_member_query_sketch(const struct rte_member_setsum *setsum,
+		const void *key);
+
+uint32_t
+rte_member_report_heavyhitter_sketch(const struct rte_member_setsum *setsum,
+		void **keys, uint64_t *counts);
+
+void
+rte_member_free_sketch(struct rte_member_setsum *ss);
+
+void
+rte_member_reset_sketch(const struct rte_member_setsum *setsum);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_MEMBER_SKETCH_H_ */
@@ -0,0 +1,46 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2017 Intel Corporation
+ */
+
+#ifndef _RTE_MEMBER_SKETCH_X86_H_
+#define _RTE_MEMBER_SKETCH_X86_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <x86intrin.h>
+
+#if defined(__AVX2__)
+
+/*
+ * Return the first slot in [start, num) whose signature is sig, or num.
+ * The signature array is 32B aligned and padded to a multiple of 8 slots.
+ */
+static inline uint32_t
+search_sig_avx(const uint32_t *sigs, uint32_t start, uint32_t num,
+		uint32_t sig)
+{
+	const __m256i x = _mm256_set1_epi32(sig);
+	uint32_t i = start & ~7U;
+	uint32_t hitmask;
+
+	for (; i < num; i += 8) {
+		hitmask = _mm256_movemask_ps((__m256)_mm256_cmpeq_epi32(
+			_mm256_load_si256((__m256i const *)&sigs[i]), x));
+		if (i < start)
+			hitmask &= ~0U << (start - i);
+		if (hitmask) {
+			i += __builtin_ctz(hitmask);
+			return i < num ? i : num;
+		}
+	}
+	return num;
+}
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_MEMBER_SKETCH_X86_H_ */
@@ -719,6 +719,65 @@ rte_mempool_populate_anon(struct rte_mempool *mp)
 	return 0;
 }
 
+/*
+ * Allocate the return buffers of the lcores, on their socket. An lcore of
+ * the socket of the mempool never uses its buffer, but it is allocated
+ * anyway as the lcores are only compared to the mempool socket at put time.
+ */
+static int
+mempool_return_bufs_alloc(struct rte_mempool *mp)
+{
+	unsigned int lcore_id;
+
+	mp->return_bufs = rte_zmalloc_socket("MEMPOOL_RETURN_BUFS",
+		sizeof(*mp->return_bufs) * RTE_MAX_LCORE, 0, mp->socket_id);
+	if (mp->return_bufs == NULL)
+		return -ENOMEM;
+
+	RTE_LCORE_FOREACH(lcore_id) {
+		mp->return_bufs[lcore_id] = rte_zmalloc_socket(
+			"MEMPOOL_RETURN_BUF",
+			sizeof(struct rte_mempool_return_buf),
+			RTE_CACHE_LINE_SIZE, rte_lcore_to_socket_id(lcore_id));
+		/* the socket of the lcore may have no memory */
+		if (mp->return_bufs[lcore_id] == NULL)
+			mp->return_bufs[lcore_id] = rte_zmalloc(
+				"MEMPOOL_RETURN_BUF",
+				sizeof(struct rte_mempool_return_buf),
+				RTE_CACHE_LINE_SIZE);
+		if (mp->return_bufs[lcore_id] == NULL)
+			return -ENOMEM;
+	}
+	return 0;
+}
+
+static void
+mempool_return_bufs_free(struct rte_mempool *mp)
+{
+	unsigned int lcore_id;
+
+	if (mp->return_bufs == NULL)
+		return;
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
+		rte_free(mp->return_bufs[lcore_id]);
+	rte_free(mp->return_bufs);
+	mp->return_bufs = NULL;
+}
+
+/* number of objects in the return buffers */
+static unsigned int
+mempool_return_bufs_count(const struct rte_mempool *mp)
+{
+	unsigned int lcore_id, count = 0;
+
+	if (mp->return_bufs == NULL)
+		return 0;
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
+		if (mp->return_bufs[lcore_id] != NULL)
+			count += mp->return_bufs[lcore_id]->len;
+	return count;
+}
+
 /* free a mempool */
 void
 rte_mempool_free(struct rte_mempool *mp)
@@ -747,6 +806,7 @@ rte_mempool_free(struct rte_mempool *mp)
 	rte_mempool_trace_free(mp);
 	rte_mempool_free_memchunks(mp);
 	rte_mempool_ops_free(mp);
+	mempool_return_bufs_free(mp);
 	rte_memzone_free(mp->mz);
 }
 
@@ -849,6 +909,18 @@ rte_mempool_create_empty(const char *name, unsigned n, unsigned elt_size,
 		return NULL;
 	}
 
+	/* an adaptive cache needs a max size */
+	if ((flags & RTE_MEMPOOL_F_ADAPTIVE_CACHE) && cache_size == 0) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	/* remote puts are relative to the socket of the mempool */
+	if ((flags & RTE_MEMPOOL_F_REMOTE_FREE) && socket_id == SOCKET_ID_ANY) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
 	/*
 	 * No objects in the pool can be used for IO until it's populated
 	 * with at least some objects with valid IOVA.
@@ -925,12 +997,26 @@ rte_mempool_create_empty(const char *name, unsigned n, unsigned elt_size,
 		RTE_PTR_ADD(mp, RTE_MEMPOOL_HEADER_SIZE(mp, 0));
 
 	/* Init all default caches. */
-	if (cache_size != 0) {
+	if (cache_size != 0 && (flags & RTE_MEMPOOL_F_ADAPTIVE_CACHE)) {
+		for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+			mempool_cache_init(&mp->local_cache[lcore_id],
+				RTE_MIN(cache_size,
+					RTE_MEMPOOL_CACHE_ADAPT_MIN_SIZE));
+			mp->local_cache[lcore_id].max_size = cache_size;
+		}
+	} else if (cache_size != 0) {
 		for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
 			mempool_cache_init(&mp->local_cache[lcore_id],
 					   cache_size);
 	}
 
+	if ((flags & RTE_MEMPOOL_F_REMOTE_FREE) &&
+	    mempool_return_bufs_alloc(mp) < 0) {
+		RTE_LOG(ERR, MEMPOOL, "Cannot allocate return buffers\n");
+		rte_errno = ENOMEM;
+		goto exit_unlock;
+	}
+
 	te->data = mp;
 
 	rte_mcfg_tailq_write_lock();
@@ -1010,6 +1096,7 @@ rte_mempool_avail_count(const struct rte_mempool *mp)
 	unsigned lcore_id;
 
 	count = rte_mempool_ops_get_count(mp);
+	count += mempool_return_bufs_count(mp);
 
 	if (mp->cache_size == 0)
 		return count;
@@ -1051,6 +1138,9 @@ rte_mempool_dump_cache(FILE *f, const struct rte_mempool *mp)
 		cache_count = mp->local_cache[lcore_id].len;
 		fprintf(f, "    cache_count[%u]=%"PRIu32"\n",
 			lcore_id, cache_count);
+		if (mp->flags & RTE_MEMPOOL_F_ADAPTIVE_CACHE)
+			fprintf(f, "    cache_size[%u]=%"PRIu32"\n",
+				lcore_id, mp->local_cache[lcore_id].size);
 		count += cache_count;
 	}
 	fprintf(f, "    total_cache_count=%u\n", count);
@@ -1195,6 +1285,20 @@ mempool_audit_cache(const struct rte_mempool *mp)
 	/* check cache size consistency */
 	unsigned lcore_id;
 
+	if (mp->return_bufs != NULL) {
+		for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+			const struct rte_mempool_return_buf *buf;
+
+			buf = mp->return_bufs[lcore_id];
+			if (buf != NULL && buf->len > RTE_DIM(buf->objs)) {
+				RTE_LOG(CRIT, MEMPOOL,
+					"badness on return buffer[%u]\n",
+					lcore_id);
+				rte_panic("MEMPOOL: invalid return buffer len\n");
+			}
+		}
+	}
+
 	if (mp->cache_size == 0)
 		return;
 
@@ -1233,6 +1337,7 @@ rte_mempool_dump(FILE *f, struct rte_mempool *mp)
 	struct rte_mempool_ops *ops;
 	unsigned common_count;
 	unsigned cache_count;
+	unsigned int return_count;
 	size_t mem_len = 0;
 
 	RTE_ASSERT(f != NULL);
@@ -1266,6 +1371,11 @@ rte_mempool_dump(FILE *f, struct rte_mempool *mp)
 	}
 
 	cache_count = rte_mempool_dump_cache(f, mp);
+	if (mp->return_bufs != NULL) {
+		return_count = mempool_return_bufs_count(mp);
+		fprintf(f, "  return_buf_count=%u\n", return_count);
+		cache_count += return_count;
+	}
 	common_count = rte_mempool_ops_get_count(mp);
 	if ((cache_count + common_count) > mp->size)
 		common_count = mp->size - cache_count;
@@ -1288,6 +1398,8 @@ rte_mempool_dump(FILE *f, struct rte_mempool *mp)
 		sum.get_fail_objs += mp->stats[lcore_id].get_fail_objs;
 		sum.get_success_blks += mp->stats[lcore_id].get_success_blks;
 		sum.get_fail_blks += mp->stats[lcore_id].get_fail_blks;
+		sum.put_remote_bulk += mp->stats[lcore_id].put_remote_bulk;
+		sum.put_remote_objs += mp->stats[lcore_id].put_remote_objs;
 	}
 	fprintf(f, "  stats:\n");
 	fprintf(f, "    put_bulk=%"PRIu64"\n", sum.put_bulk);
@@ -1305,6 +1417,12 @@ rte_mempool_dump(FILE *f, struct rte_mempool *mp)
 			sum.get_success_blks);
 		fprintf(f, "    get_fail_blks=%"PRIu64"\n", sum.get_fail_blks);
 	}
+	if (mp->return_bufs != NULL) {
+		fprintf(f, "    put_remote_bulk=%"PRIu64"\n",
+			sum.put_remote_bulk);
+		fprintf(f, "    put_remote_objs=%"PRIu64"\n",
+			sum.put_remote_objs);
+	}
 #else
 	fprintf(f, "  no statistics available\n");
 #endif
@@ -1560,10 +1678,89 @@ mempool_handle_info(const char *cmd __rte_unused, const char *params,
 	return 0;
 }
 
+static void
+mempool_cache_cb(struct rte_mempool *mp, void *arg)
+{
+	struct mempool_info_cb_arg *info = (struct mempool_info_cb_arg *)arg;
+	const struct rte_mempool_cache *cache;
+	char lcore_name[16];
+	struct rte_tel_data *c;
+	unsigned int lcore_id;
+	uint64_t ops;
+	int stats;
+
+	if (strncmp(mp->name, info->pool_name, RTE_MEMZONE_NAMESIZE))
+		return;
+
+	rte_tel_data_add_dict_string(info->d, "name", mp->name);
+	rte_tel_data_add_dict_int(info->d, "cache_size", mp->cache_size);
+	rte_tel_data_add_dict_int(info->d, "adaptive",
+		!!(mp->flags & RTE_MEMPOOL_F_ADAPTIVE_CACHE));
+	if (mp->cache_size == 0)
+		return;
+
+	/* the hits and misses are only counted in these cases */
+#ifdef RTE_LIBRTE_MEMPOOL_DEBUG
+	stats = 1;
+#else
+	stats = !!(mp->flags & RTE_MEMPOOL_F_ADAPTIVE_CACHE);
+#endif
+
+	/*
+	 * only the caches of the lcores are listed, and those holding
+	 * objects or counted operations
+	 */
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		cache = &mp->local_cache[lcore_id];
+		ops = cache->hits + cache->misses;
+		if (rte_lcore_has_role(lcore_id, ROLE_OFF) &&
+				cache->len == 0 && (!stats || ops == 0))
+			continue;
+
+		c = rte_tel_data_alloc();
+		if (c == NULL)
+			return;
+		rte_tel_data_start_dict(c);
+		rte_tel_data_add_dict_int(c, "size", cache->size);
+		rte_tel_data_add_dict_int(c, "len", cache->len);
+		if (stats) {
+			rte_tel_data_add_dict_u64(c, "hits", cache->hits);
+			rte_tel_data_add_dict_u64(c, "misses", cache->misses);
+			rte_tel_data_add_dict_int(c, "hit_rate_pct", ops == 0 ?
+				0 : (int)(cache->hits * 100 / ops));
+		}
+
+		snprintf(lcore_name, sizeof(lcore_name), "lcore_%u", lcore_id);
+		rte_tel_data_add_dict_container(info->d, lcore_name, c, 0);
+	}
+}
+
+static int
+mempool_handle_cache(const char *cmd __rte_unused, const char *params,
+		     struct rte_tel_data *d)
+{
+	struct mempool_info_cb_arg mp_arg;
+	char name[RTE_MEMZONE_NAMESIZE];
+
+	if (!params || strlen(params) == 0)
+		return -EINVAL;
+
+	rte_strlcpy(name, params, RTE_MEMZONE_NAMESIZE);
+
+	rte_tel_data_start_dict(d);
+	mp_arg.pool_name = name;
+	mp_arg.d = d;
+	rte_mempool_walk(mempool_cache_cb, &mp_arg);
+
+	return 0;
+}
+
 RTE_INIT(mempool_init_telemetry)
 {
 	rte_telemetry_register_cmd("/mempool/list", mempool_handle_list,
 		"Returns list of available mempool. Takes no parameters");
 	rte_telemetry_register_cmd("/mempool/info", mempool_handle_info,
 		"Returns mempool info. Parameters: pool_name");
+	rte_telemetry_register_cmd("/mempool/cache", mempool_handle_cache,
+		"Returns per-lcore cache occupancy and hit rates, if counted. Parameters: pool_name");
 }
@@ -80,6 +80,8 @@ struct rte_mempool_debug_stats {
 	uint64_t get_fail_objs;        /**< Objects that failed to be allocated. */
 	uint64_t get_success_blks;     /**< Successful allocation number of contiguous blocks. */
 	uint64_t get_fail_blks;        /**< Failed allocation number of contiguous blocks. */
+	uint64_t put_remote_bulk;      /**< Number of puts from another socket. */
+	uint64_t put_remote_objs;      /**< Number of objects put from another socket. */
 } __rte_cache_aligned;
 #endif
 
@@ -95,6 +97,50 @@ struct rte_mempool_cache {
 	 * cases to avoid needless emptying of cache.
 	 */
 	void *objs[RTE_MEMPOOL_CACHE_MAX_SIZE * 3]; /**< Cache objects */
+	/*
+	 * The fields below are only updated for the pools created with
+	 * RTE_MEMPOOL_F_ADAPTIVE_CACHE, and in debug mode.
+	 */
+	uint32_t max_size;    /**< Max size of an adaptive cache, 0 if fixed */
+	uint64_t hits;	      /**< Gets and puts served by the cache */
+	uint64_t misses;      /**< Gets and puts reaching the common pool */
+	uint64_t adapt_hits;  /**< Hits at the last resizing decision */
+	uint64_t adapt_misses; /**< Misses at the last resizing decision */
+} __rte_cache_aligned;
+
+/**
+ * Initial and min size of the caches of a mempool created with
+ * RTE_MEMPOOL_F_ADAPTIVE_CACHE, if less than the pool cache size.
+ */
+#define RTE_MEMPOOL_CACHE_ADAPT_MIN_SIZE 32U
+
+/**
+ * Number of gets and puts over which the miss rate of an adaptive cache
+ * is measured before resizing it.
+ */
+#define RTE_MEMPOOL_CACHE_ADAPT_PERIOD 1024
+
+/**
+ * An adaptive cache doubles its size when more than one get or put in
+ * RTE_MEMPOOL_CACHE_ADAPT_GROW misses it, and halves its size when less
+ * than one in RTE_MEMPOOL_CACHE_ADAPT_SHRINK misses it.
+ */
+#define RTE_MEMPOOL_CACHE_ADAPT_GROW 8
+#define RTE_MEMPOOL_CACHE_ADAPT_SHRINK 64
+
+/**
+ * Number of objects put by an lcore to a mempool of another NUMA socket
+ * before they are returned to the pool, see RTE_MEMPOOL_F_REMOTE_FREE.
+ */
+#define RTE_MEMPOOL_RETURN_BUF_SIZE 128
+
+/**
+ * @internal A structure that stores the objects put by an lcore to
+ * a mempool of another NUMA socket, allocated on the socket of the lcore.
+ */
+struct rte_mempool_return_buf {
+	uint32_t len; /**< Number of objects in the buffer */
+	void *objs[RTE_MEMPOOL_RETURN_BUF_SIZE]; /**< Buffered objects */
 } __rte_cache_aligned;
 
 /**
@@ -244,6 +290,11 @@ struct rte_mempool {
 	struct rte_mempool_objhdr_list elt_list; /**< List of objects in pool */
 	uint32_t nb_mem_chunks;          /**< Number of memory chunks */
 	struct rte_mempool_memhdr_list mem_list; /**< List of memory chunks */
+	/**
+	 * Per-lcore buffers of the objects put from another socket,
+	 * NULL unless RTE_MEMPOOL_F_REMOTE_FREE is set.
+	 */
+	struct rte_mempool_return_buf **return_bufs;
 
 #ifdef RTE_LIBRTE_MEMPOOL_DEBUG
 	/** Per-lcore statistics. */
@@ -290,6 +341,10 @@ struct rte_mempool {
 #define MEMPOOL_F_NO_IOVA_CONTIG	RTE_MEMPOOL_F_NO_IOVA_CONTIG
 /** Internal: no object from the pool can be used for device IO (DMA). */
 #define RTE_MEMPOOL_F_NON_IO		0x0040
+/** Objects put from another socket are returned to the pool in batches. */
+#define RTE_MEMPOOL_F_REMOTE_FREE	0x0080
+/** The size of each lcore cache follows its miss rate. */
+#define RTE_MEMPOOL_F_ADAPTIVE_CACHE	0x0100
 
 /**
  * This macro lists all the mempool flags an application may request.
@@ -299,6 +354,8 @@ struct rte_mempool {
 	| RTE_MEMPOOL_F_SP_PUT \
 	| RTE_MEMPOOL_F_SC_GET \
 	| RTE_MEMPOOL_F_NO_IOVA_CONTIG \
+	| RTE_MEMPOOL_F_REMOTE_FREE \
+	| RTE_MEMPOOL_F_ADAPTIVE_CACHE \
 	)
 /**
  * @internal When debug is enabled, store some statistics.
@@ -321,6 +378,25 @@ struct rte_mempool {
 #define RTE_MEMPOOL_STAT_ADD(mp, name, n) do {} while (0)
 #endif
 
+/**
+ * @internal Increment a hit or miss counter of a cache. The counters are
+ * kept for the adaptive caches, and for all the caches in debug mode.
+ * @param mp
+ *   Pointer to the memory pool.
+ * @param cache
+ *   Pointer to the cache.
+ * @param name
+ *   Name of the counter field.
+ */
+#ifdef RTE_LIBRTE_MEMPOOL_DEBUG
+#define RTE_MEMPOOL_CACHE_STAT_INC(mp, cache, name) ((cache)->name++)
+#else
+#define RTE_MEMPOOL_CACHE_STAT_INC(mp, cache, name) do {		\
+		if (unlikely((mp)->flags & RTE_MEMPOOL_F_ADAPTIVE_CACHE))	\
+			(cache)->name++;				\
+	} while (0)
+#endif
+
 /**
  * @internal Calculate the size of the mempool header.
  *
@@ -1037,6 +1113,18 @@ typedef void (rte_mempool_ctor_t)(struct rte_mempool *, void *);
  *     "single-consumer". Otherwise, it is "multi-consumers".
  *   - RTE_MEMPOOL_F_NO_IOVA_CONTIG: If set, allocated objects won't
  *     necessarily be contiguous in IO memory.
+ *   - RTE_MEMPOOL_F_REMOTE_FREE: If set, the objects put by an lcore
+ *     which is not on *socket_id* bypass its cache, including a user-owned
+ *     cache passed to rte_mempool_generic_put(): they are buffered apart
+ *     and returned to the pool RTE_MEMPOOL_RETURN_BUF_SIZE at a time, or
+ *     by rte_mempool_remote_flush(). The *socket_id* must not be
+ *     SOCKET_ID_ANY.
+ *   - RTE_MEMPOOL_F_ADAPTIVE_CACHE: If set, *cache_size* is the max size
+ *     of the per-lcore caches. Each cache starts with
+ *     RTE_MEMPOOL_CACHE_ADAPT_MIN_SIZE objects at most and is grown or
+ *     shrunk by its lcore according to its miss rate, so that the caches
+ *     of the lightly loaded lcores hold fewer objects. The *cache_size*
+ *     must not be 0.
  * @return
  *   The pointer to the new allocated mempool, on success. NULL on error
  *   with rte_errno set appropriately. Possible rte_errno values include:
@@ -1318,6 +1406,98 @@ rte_mempool_cache_flush(struct rte_mempool_cache *cache,
 	cache->len = 0;
 }
 
+/**
+ * @internal Resize an adaptive cache according to its miss rate since
+ * the last resizing decision; used internally on cache misses.
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param cache
+ *   A pointer to a mempool cache structure.
+ * @param n
+ *   The number of objects of the get or put which missed the cache,
+ *   the cache is not shrunk down to this number.
+ */
+static inline void
+rte_mempool_cache_adapt(struct rte_mempool *mp,
+			struct rte_mempool_cache *cache, unsigned int n)
+{
+	uint64_t misses, ops;
+	uint32_t size;
+
+	if (likely(!(mp->flags & RTE_MEMPOOL_F_ADAPTIVE_CACHE)) ||
+	    cache->max_size == 0)
+		return;
+
+	misses = cache->misses - cache->adapt_misses;
+	ops = cache->hits - cache->adapt_hits + misses;
+	if (ops < RTE_MEMPOOL_CACHE_ADAPT_PERIOD)
+		return;
+	cache->adapt_hits = cache->hits;
+	cache->adapt_misses = cache->misses;
+
+	if (misses * RTE_MEMPOOL_CACHE_ADAPT_GROW > ops)
+		size = RTE_MIN(cache->size * 2, cache->max_size);
+	else if (misses * RTE_MEMPOOL_CACHE_ADAPT_SHRINK < ops &&
+		 cache->size / 2 > n)
+		size = RTE_MAX(cache->size / 2, RTE_MIN(cache->max_size,
+			RTE_MEMPOOL_CACHE_ADAPT_MIN_SIZE));
+	else
+		return;
+
+	cache->size = size;
+	cache->flushthresh = size + size / 2;
+
+	/* Return the objects above the new size to the pool */
+	if (cache->len > size) {
+		rte_mempool_ops_enqueue_bulk(mp, &cache->objs[size],
+				cache->len - size);
+		cache->len = size;
+	}
+}
+
+/**
+ * @internal Put several objects in the return buffer of the calling lcore,
+ * if it is not on the socket of the mempool; used internally.
+ *
+ * @return
+ *   1 if the objects were handled, 0 if they must be put as usual.
+ */
+static __rte_always_inline int
+rte_mempool_do_remote_put(struct rte_mempool *mp, void * const *obj_table,
+			  unsigned int n)
+{
+	struct rte_mempool_return_buf *buf;
+	unsigned int lcore_id = rte_lcore_id();
+
+	if (lcore_id >= RTE_MAX_LCORE ||
+	    (int)rte_socket_id() == mp->socket_id)
+		return 0;
+	buf = mp->return_bufs[lcore_id];
+	if (unlikely(buf == NULL))
+		return 0;
+
+	RTE_MEMPOOL_STAT_ADD(mp, put_remote_bulk, 1);
+	RTE_MEMPOOL_STAT_ADD(mp, put_remote_objs, n);
+
+	/* Return the buffered objects to the pool, in one bulk */
+	if (buf->len + n > RTE_MEMPOOL_RETURN_BUF_SIZE) {
+		RTE_MEMPOOL_STAT_ADD(mp, put_common_pool_bulk, 1);
+		RTE_MEMPOOL_STAT_ADD(mp, put_common_pool_objs, buf->len);
+		rte_mempool_ops_enqueue_bulk(mp, buf->objs, buf->len);
+		buf->len = 0;
+	}
+	if (unlikely(n > RTE_MEMPOOL_RETURN_BUF_SIZE)) {
+		RTE_MEMPOOL_STAT_ADD(mp, put_common_pool_bulk, 1);
+		RTE_MEMPOOL_STAT_ADD(mp, put_common_pool_objs, n);
+		rte_mempool_ops_enqueue_bulk(mp, obj_table, n);
+		return 1;
+	}
+
+	rte_memcpy(&buf->objs[buf->len], obj_table, sizeof(void *) * n);
+	buf->len += n;
+	return 1;
+}
+
 /**
  * @internal Put several objects back in the mempool; used internally.
  * @param mp
@@ -1340,10 +1520,21 @@ rte_mempool_do_generic_put(struct rte_mempool *mp, void * const *obj_table,
 	RTE_MEMPOOL_STAT_ADD(mp, put_bulk, 1);
 	RTE_MEMPOOL_STAT_ADD(mp, put_objs, n);
 
-	/* No cache provided or if put would overflow mem allocated for cache */
-	if (unlikely(cache == NULL || n > RTE_MEMPOOL_CACHE_MAX_SIZE))
+	/* Objects from another socket are batched apart from the cache */
+	if (unlikely(mp->flags & RTE_MEMPOOL_F_REMOTE_FREE) &&
+	    rte_mempool_do_remote_put(mp, obj_table, n))
+		return;
+
+	/* No cache provided */
+	if (unlikely(cache == NULL))
 		goto ring_enqueue;
 
+	/* Put would overflow mem allocated for cache */
+	if (unlikely(n > RTE_MEMPOOL_CACHE_MAX_SIZE)) {
+		RTE_MEMPOOL_CACHE_STAT_INC(mp, cache, misses);
+		goto ring_enqueue;
+	}
+
 	cache_objs = &cache->objs[cache->len];
 
 	/*
@@ -1362,6 +1553,10 @@ rte_mempool_do_generic_put(struct rte_mempool *mp, void * const *obj_table,
 		rte_mempool_ops_enqueue_bulk(mp, &cache->objs[cache->size],
 				cache->len - cache->size);
 		cache->len = cache->size;
+		RTE_MEMPOOL_CACHE_STAT_INC(mp, cache, misses);
+		rte_mempool_cache_adapt(mp, cache, n);
+	} else {
+		RTE_MEMPOOL_CACHE_STAT_INC(mp, cache, hits);
 	}
 
 	return;
@@ -1441,6 +1636,37 @@ rte_mempool_put(struct rte_mempool *mp, void *obj)
 	rte_mempool_put_bulk(mp, &obj, 1);
 }
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Return to the mempool the objects put by the calling lcore from another
+ * socket and still buffered, see RTE_MEMPOOL_F_REMOTE_FREE.
+ * An lcore should call it when it stops putting objects to the mempool,
+ * so that the other lcores can get them.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ */
+__rte_experimental
+static __rte_always_inline void
+rte_mempool_remote_flush(struct rte_mempool *mp)
+{
+	struct rte_mempool_return_buf *buf;
+	unsigned int lcore_id = rte_lcore_id();
+
+	if (mp->return_bufs == NULL || lcore_id >= RTE_MAX_LCORE)
+		return;
+	buf = mp->return_bufs[lcore_id];
+	if (buf == NULL || buf->len == 0)
+		return;
+
+	RTE_MEMPOOL_STAT_ADD(mp, put_common_pool_bulk, 1);
+	RTE_MEMPOOL_STAT_ADD(mp, put_common_pool_objs, buf->len);
+	rte_mempool_ops_enqueue_bulk(mp, buf->objs, buf->len);
+	buf->len = 0;
+}
+
 /**
  * @internal Get several objects from the mempool; used internally.
  * @param mp
@@ -1463,18 +1689,29 @@ rte_mempool_do_generic_get(struct rte_mempool *mp, void **obj_table,
 	uint32_t index, len;
 	void **cache_objs;
 
-	/* No cache provided or cannot be satisfied from cache */
-	if (unlikely(cache == NULL || n >= cache->size))
+	/* No cache provided */
+	if (unlikely(cache == NULL))
 		goto ring_dequeue;
 
+	/* Cannot be satisfied from cache */
+	if (unlikely(n >= cache->size)) {
+		RTE_MEMPOOL_CACHE_STAT_INC(mp, cache, misses);
+		rte_mempool_cache_adapt(mp, cache, n);
+		goto ring_dequeue;
+	}
+
 	cache_objs = cache->objs;
 
 	/* Can this be satisfied from the cache? */
 	if (cache->len < n) {
 		/* No. Backfill the cache first, and then fill from it */
-		uint32_t req = n + (cache->size - cache->len);
+		uint32_t req;
+
+		RTE_MEMPOOL_CACHE_STAT_INC(mp, cache, misses);
+		rte_mempool_cache_adapt(mp, cache, n);
 
 		/* How many do we require i.e. number to fill the cache + the request */
+		req = n + (cache->size - cache->len);
 		ret = rte_mempool_ops_dequeue_bulk(mp,
 			&cache->objs[cache->len], req);
 		if (unlikely(ret < 0)) {
@@ -1488,6 +1725,8 @@ rte_mempool_do_generic_get(struct rte_mempool *mp, void **obj_table,
 		}
 
 		cache->len += req;
+	} else {
+		RTE_MEMPOOL_CACHE_STAT_INC(mp, cache, hits);
 	}
 
 	/* Now fill in the response ... */
@@ -12,6 +12,7 @@
 #include "ethdev_rx_priv.h"
 #include "ethdev_tx_priv.h"
 #include "ip4_rewrite_priv.h"
+#include "ip6_rewrite_priv.h"
 #include "node_private.h"
 
 static struct ethdev_ctrl {
@@ -23,6 +24,7 @@ rte_node_eth_config(struct rte_node_ethdev_config *conf, uint16_t nb_confs,
 		    uint16_t nb_graphs)
 {
 	struct rte_node_register *ip4_rewrite_node;
+	struct rte_node_register *ip6_rewrite_node;
 	struct ethdev_tx_node_main *tx_node_data;
 	uint16_t tx_q_used, rx_q_used, port_id;
 	struct rte_node_register *tx_node;
@@ -33,6 +35,7 @@ rte_node_eth_config(struct rte_node_ethdev_config *conf, uint16_t nb_confs,
 	uint32_t id;
 
 	ip4_rewrite_node = ip4_rewrite_node_get();
+	ip6_rewrite_node = ip6_rewrite_node_get();
 	tx_node_data = ethdev_tx_node_data_get();
 	tx_node = ethdev_tx_node_get();
 	for (i = 0; i < nb_confs; i++) {
@@ -108,6 +111,15 @@ rte_node_eth_config(struct rte_node_ethdev_config *conf, uint16_t nb_confs,
 			port_id, rte_node_edge_count(ip4_rewrite_node->id) - 1);
 		if (rc < 0)
 			return rc;
+
+		/* Add this tx port node as next to ip6_rewrite_node */
+		rte_node_edge_update(ip6_rewrite_node->id, RTE_EDGE_ID_INVALID,
+				     &next_nodes, 1);
+		/* Assuming edge id is the last one alloc'ed */
+		rc = ip6_rewrite_set_next(
+			port_id, rte_node_edge_count(ip6_rewrite_node->id) - 1);
+		if (rc < 0)
+			return rc;
 	}
 
 	ctrl.nb_graphs = nb_graphs;
@@ -0,0 +1,245 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(C) 2020 Marvell International Ltd.
+ */
+
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include <rte_debug.h>
+#include <rte_ethdev.h>
+#include <rte_ether.h>
+#include <rte_graph.h>
+#include <rte_graph_worker.h>
+#include <rte_ip.h>
+#include <rte_lpm6.h>
+#include <rte_mbuf.h>
+
+#include "rte_node_ip6_api.h"
+
+#include "node_private.h"
+
+#define IPV6_L3FWD_LPM_MAX_RULES 1024
+#define IPV6_L3FWD_LPM_NUMBER_TBL8S (1 << 12)
+
+/* Number of packets resolved with one LPM6 bulk lookup */
+#define IP6_LOOKUP_BULK_SZ 64
+
+/* IP6 Lookup global data struct */
+struct ip6_lookup_node_main {
+	struct rte_lpm6 *lpm_tbl[RTE_MAX_NUMA_NODES];
+};
+
+struct ip6_lookup_node_ctx {
+	/* Socket's LPM table */
+	struct rte_lpm6 *lpm6;
+	/* Dynamic offset to mbuf priv1 */
+	int mbuf_priv1_off;
+};
+
+static struct ip6_lookup_node_main ip6_lookup_nm;
+
+#define IP6_LOOKUP_NODE_LPM(ctx) \
+	(((struct ip6_lookup_node_ctx *)ctx)->lpm6)
+
+#define IP6_LOOKUP_NODE_PRIV1_OFF(ctx) \
+	(((struct ip6_lookup_node_ctx *)ctx)->mbuf_priv1_off)
+
+static uint16_t
+ip6_lookup_node_process(struct rte_graph *graph, struct rte_node *node,
+			void **objs, uint16_t nb_objs)
+{
+	uint8_t ip_batch[IP6_LOOKUP_BULK_SZ][RTE_LPM6_IPV6_ADDR_SIZE];
+	struct rte_lpm6 *lpm6 = IP6_LOOKUP_NODE_LPM(node->ctx);
+	const int dyn = IP6_LOOKUP_NODE_PRIV1_OFF(node->ctx);
+	int32_t next_hop[IP6_LOOKUP_BULK_SZ];
+	struct rte_ipv6_hdr *ipv6_hdr;
+	void **to_next, **from;
+	uint16_t last_spec = 0;
+	struct rte_mbuf *mbuf;
+	rte_edge_t next_index;
+	uint16_t n_left_from;
+	uint16_t held = 0;
+	uint32_t drop_nh;
+	uint16_t i, n;
+
+	/* Speculative next */
+	next_index = RTE_NODE_IP6_LOOKUP_NEXT_REWRITE;
+	/* Drop node */
+	drop_nh = ((uint32_t)RTE_NODE_IP6_LOOKUP_NEXT_PKT_DROP) << 16;
+	from = objs;
+	n_left_from = nb_objs;
+
+	/* Get stream for the speculated next node */
+	to_next = rte_node_next_stream_get(graph, node, next_index, nb_objs);
+	while (n_left_from > 0) {
+		void **batch = objs + (nb_objs - n_left_from);
+
+		n = RTE_MIN(n_left_from, (uint16_t)IP6_LOOKUP_BULK_SZ);
+		n_left_from -= n;
+
+		/* Gather DIPs and cache hop limit while the hdr is hot */
+		for (i = 0; i < n; i++) {
+			if (likely(i + 4 < n))
+				rte_prefetch0(rte_pktmbuf_mtod_offset(
+					(struct rte_mbuf *)batch[i + 4], void *,
+					sizeof(struct rte_ether_hdr)));
+
+			mbuf = (struct rte_mbuf *)batch[i];
+			ipv6_hdr = rte_pktmbuf_mtod_offset(mbuf,
+					struct rte_ipv6_hdr *,
+					sizeof(struct rte_ether_hdr));
+			node_mbuf_priv1(mbuf, dyn)->ttl = ipv6_hdr->hop_limits;
+			rte_memcpy(ip_batch[i], ipv6_hdr->dst_addr,
+				   RTE_LPM6_IPV6_ADDR_SIZE);
+		}
+
+		rte_lpm6_lookup_bulk_func(lpm6, ip_batch, next_hop, n);
+
+		for (i = 0; i < n; i++) {
+			uint32_t nh;
+			uint16_t next;
+
+			mbuf = (struct rte_mbuf *)batch[i];
+			nh = (next_hop[i] >= 0) ? (uint32_t)next_hop[i] :
+						  drop_nh;
+
+			node_mbuf_priv1(mbuf, dyn)->nh = (uint16_t)nh;
+			next = (uint16_t)(nh >> 16);
+
+			if (unlikely(next_index != next)) {
+				/* Copy things successfully speculated till now */
+				rte_memcpy(to_next, from,
+					   last_spec * sizeof(from[0]));
+				from += last_spec;
+				to_next += last_spec;
+				held += last_spec;
+				last_spec = 0;
+
+				rte_node_enqueue_x1(graph, node, next, from[0]);
+				from += 1;
+			} else {
+				last_spec += 1;
+			}
+		}
+	}
+
+	/* !!! Home run !!! */
+	if (likely(last_spec == nb_objs)) {
+		rte_node_next_stream_move(graph, node, next_index);
+		return nb_objs;
+	}
+	held += last_spec;
+	rte_memcpy(to_next, from, last_spec * sizeof(from[0]));
+	rte_node_next_stream_put(graph, node, next_index, held);
+
+	return nb_objs;
+}
+
+int
+rte_node_ip6_route_add(const uint8_t *ip, uint8_t depth, uint16_t next_hop,
+		       enum rte_node_ip6_lookup_next next_node)
+{
+	char abuf[INET6_ADDRSTRLEN];
+	uint8_t socket;
+	uint32_t val;
+	int ret;
+
+	inet_ntop(AF_INET6, ip, abuf, sizeof(abuf));
+	/* Embedded next node id into 21 bit next hop */
+	val = ((next_node << 16) | next_hop) & ((1ull << 21) - 1);
+	node_dbg("ip6_lookup", "LPM: Adding route %s / %d nh (0x%x)", abuf,
+		 depth, val);
+
+	for (socket = 0; socket < RTE_MAX_NUMA_NODES; socket++) {
+		if (!ip6_lookup_nm.lpm_tbl[socket])
+			continue;
+
+		ret = rte_lpm6_add(ip6_lookup_nm.lpm_tbl[socket], ip, depth,
+				   val);
+		if (ret < 0) {
+			node_err("ip6_lookup",
+				 "Unable to add entry %s / %d nh (%x) to LPM table on sock %d, rc=%d\n",
+				 abuf, depth, val, socket, ret);
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+static int
+setup_lpm6(struct ip6_lookup_node_main *nm, int socket)
+{
+	struct rte_lpm6_config config_ipv6;
+	char s[RTE_LPM6_NAMESIZE];
+
+	/* One LPM table per socket */
+	if (nm->lpm_tbl[socket])
+		return 0;
+
+	/* create the LPM table */
+	config_ipv6.max_rules = IPV6_L3FWD_LPM_MAX_RULES;
+	config_ipv6.number_tbl8s = IPV6_L3FWD_LPM_NUMBER_TBL8S;
+	config_ipv6.flags = 0;
+	snprintf(s, sizeof(s), "IPV6_L3FWD_LPM_%d", socket);
+	nm->lpm_tbl[socket] = rte_lpm6_create(s, socket, &config_ipv6);
+	if (nm->lpm_tbl[socket] == NULL)
+		return -rte_errno;
+
+	return 0;
+}
+
+static int
+ip6_lookup_node_init(const struct rte_graph *graph, struct rte_node *node)
+{
+	uint16_t socket, lcore_id;
+	static uint8_t init_once;
+	int rc;
+
+	RTE_SET_USED(graph);
+	RTE_BUILD_BUG_ON(sizeof(struct ip6_lookup_node_ctx) > RTE_NODE_CTX_SZ);
+
+	if (!init_once) {
+		node_mbuf_priv1_dynfield_offset = rte_mbuf_dynfield_register(
+				&node_mbuf_priv1_dynfield_desc);
+		if (node_mbuf_priv1_dynfield_offset < 0)
+			return -rte_errno;
+
+		/* Setup LPM tables for all sockets */
+		RTE_LCORE_FOREACH(lcore_id)
+		{
+			socket = rte_lcore_to_socket_id(lcore_id);
+			rc = setup_lpm6(&ip6_lookup_nm, socket);
+			if (rc) {
+				node_err("ip6_lookup",
+					 "Failed to setup lpm6 tbl for sock %u, rc=%d",
+					 socket, rc);
+				return rc;
+			}
+		}
+		init_once = 1;
+	}
+
+	/* Update socket's LPM and mbuf dyn priv1 offset in node ctx */
+	IP6_LOOKUP_NODE_LPM(node->ctx) = ip6_lookup_nm.lpm_tbl[graph->socket];
+	IP6_LOOKUP_NODE_PRIV1_OFF(node->ctx) = node_mbuf_priv1_dynfield_offset;
+
+	node_dbg("ip6_lookup", "Initialized ip6_lookup node");
+
+	return 0;
+}
+
+static struct rte_node_register ip6_lookup_node = {
+	.process = ip6_lookup_node_process,
+	.name = "ip6_lookup",
+
+	.init = ip6_lookup_node_init,
+
+	.nb_edges = RTE_NODE_IP6_LOOKUP_NEXT_MAX,
+	.next_nodes = {
+		[RTE_NODE_IP6_LOOKUP_NEXT_REWRITE] = "ip6_rewrite",
+		[RTE_NODE_IP6_LOOKUP_NEXT_PKT_DROP] = "pkt_drop",
+	},
+};
+
+RTE_NODE_REGISTER(ip6_lookup_node);
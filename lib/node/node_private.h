@@ -22,11 +22,12 @@ extern int rte_node_logtype;
 #define node_dbg(node_name, ...) NODE_LOG(DEBUG, node_name, __VA_ARGS__)
 
 /**
- * Node mbuf private data to store next hop, ttl and checksum.
+ * Node mbuf private data to store next hop, ttl (IPv6 hop limit) and
+ * checksum.
  */
 struct node_mbuf_priv1 {
 	union {
-		/* IP4 rewrite */
+		/* IP4/IP6 rewrite */
 		struct {
 			uint16_t nh;
 			uint16_t ttl;
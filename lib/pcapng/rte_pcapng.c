@@ -32,6 +32,15 @@ struct rte_pcapng {
 	int  outfd;		/* output file */
 	/* DPDK port id to interface index in file */
 	uint32_t port_index[RTE_MAX_ETHPORTS];
+
+	/*
+	 * Optional write buffer. Its offsets match the file offsets modulo
+	 * buf_size, so that it is always written up to a multiple of buf_size.
+	 */
+	uint8_t *buf;
+	uint32_t buf_size;
+	uint32_t buf_head;	/* start of data not written yet */
+	uint32_t buf_len;	/* end of data */
 };
 
 /* For converting TSC cycles to PCAPNG ns format */
@@ -77,6 +86,63 @@ pcapng_add_option(struct pcapng_option *popt, uint16_t code,
 	return (struct pcapng_option *)((uint8_t *)popt + pcapng_optlen(len));
 }
 
+/* Write out the pending data of the write buffer */
+static int
+pcapng_buffer_write(rte_pcapng_t *self)
+{
+	ssize_t cc;
+
+	while (self->buf_head < self->buf_len) {
+		cc = write(self->outfd, self->buf + self->buf_head,
+			   self->buf_len - self->buf_head);
+		if (cc < 0) {
+			if (errno == EINTR)
+				continue;
+			rte_errno = errno;
+			return -1;
+		}
+		self->buf_head += cc;
+	}
+
+	/* Wrap around once the whole buffer is written */
+	if (self->buf_len == self->buf_size)
+		self->buf_head = self->buf_len = 0;
+	return 0;
+}
+
+/* Copy data to the write buffer, writing it out each time it is full */
+static int
+pcapng_buffer_add(rte_pcapng_t *self, const void *data, uint32_t len)
+{
+	const uint8_t *src = data;
+	uint32_t n;
+
+	while (len > 0) {
+		n = RTE_MIN(len, self->buf_size - self->buf_len);
+		memcpy(self->buf + self->buf_len, src, n);
+		self->buf_len += n;
+		src += n;
+		len -= n;
+
+		if (self->buf_len == self->buf_size &&
+		    pcapng_buffer_write(self) < 0)
+			return -1;
+	}
+	return 0;
+}
+
+/* Write a block to file, through the write buffer if any */
+static ssize_t
+pcapng_write(rte_pcapng_t *self, const void *data, uint32_t len)
+{
+	if (self->buf == NULL)
+		return write(self->outfd, data, len);
+
+	if (pcapng_buffer_add(self, data, len) < 0)
+		return -1;
+	return len;
+}
+
 /*
  * Write required initial section header describing the capture
  */
@@ -323,7 +389,7 @@ rte_pcapng_write_stats(rte_pcapng_t *self, uint16_t port_id,
 	/* clone block_length after option */
 	memcpy(opt, &len, sizeof(uint32_t));
 
-	return write(self->outfd, buf, len);
+	return pcapng_write(self, buf, len);
 }
 
 uint32_t
@@ -406,6 +472,39 @@ pcapng_vlan_insert(struct rte_mbuf *m, uint16_t ether_type, uint16_t tci)
  *    +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
  */
 
+/* Length of the options following the packet data in the EPB */
+#define PCAPNG_EPB_OPTLEN \
+	(pcapng_optlen(sizeof(uint32_t)) /* flag option */ + \
+	 pcapng_optlen(sizeof(uint32_t))) /* queue option */
+
+/* Add the direction and queue options of an EPB */
+static struct pcapng_option *
+pcapng_add_epb_options(struct pcapng_option *opt, uint32_t queue,
+		       enum rte_pcapng_direction direction)
+{
+	uint32_t flags;
+
+	switch (direction) {
+	case RTE_PCAPNG_DIRECTION_IN:
+		flags = PCAPNG_IFB_INBOUND;
+		break;
+	case RTE_PCAPNG_DIRECTION_OUT:
+		flags = PCAPNG_IFB_OUTBOUND;
+		break;
+	default:
+		flags = 0;
+	}
+
+	opt = pcapng_add_option(opt, PCAPNG_EPB_FLAGS,
+				&flags, sizeof(flags));
+
+	opt = pcapng_add_option(opt, PCAPNG_EPB_QUEUE,
+				&queue, sizeof(queue));
+
+	/* Note: END_OPT necessary here. Wireshark doesn't do it. */
+	return opt;
+}
+
 /* Make a copy of original mbuf with pcapng header and options */
 struct rte_mbuf *
 rte_pcapng_copy(uint16_t port_id, uint32_t queue,
@@ -415,9 +514,8 @@ rte_pcapng_copy(uint16_t port_id, uint32_t queue,
 		enum rte_pcapng_direction direction)
 {
 	struct pcapng_enhance_packet_block *epb;
-	uint32_t orig_len, data_len, padding, flags;
+	uint32_t orig_len, data_len, padding;
 	struct pcapng_option *opt;
-	const uint16_t optlen = pcapng_optlen(sizeof(flags)) + pcapng_optlen(sizeof(queue));
 	struct rte_mbuf *mc;
 	uint64_t ns;
 
@@ -453,7 +551,7 @@ rte_pcapng_copy(uint16_t port_id, uint32_t queue,
 	}
 
 	/* pad the packet to 32 bit boundary */
-	data_len = rte_pktmbuf_data_len(mc);
+	data_len = rte_pktmbuf_pkt_len(mc);
 	padding = RTE_ALIGN(data_len, sizeof(uint32_t)) - data_len;
 	if (padding > 0) {
 		void *tail = rte_pktmbuf_append(mc, padding);
@@ -465,28 +563,11 @@ rte_pcapng_copy(uint16_t port_id, uint32_t queue,
 
 	/* reserve trailing options and block length */
 	opt = (struct pcapng_option *)
-		rte_pktmbuf_append(mc, optlen + sizeof(uint32_t));
+		rte_pktmbuf_append(mc, PCAPNG_EPB_OPTLEN + sizeof(uint32_t));
 	if (unlikely(opt == NULL))
 		goto fail;
 
-	switch (direction) {
-	case RTE_PCAPNG_DIRECTION_IN:
-		flags = PCAPNG_IFB_INBOUND;
-		break;
-	case RTE_PCAPNG_DIRECTION_OUT:
-		flags = PCAPNG_IFB_OUTBOUND;
-		break;
-	default:
-		flags = 0;
-	}
-
-	opt = pcapng_add_option(opt, PCAPNG_EPB_FLAGS,
-				&flags, sizeof(flags));
-
-	opt = pcapng_add_option(opt, PCAPNG_EPB_QUEUE,
-				&queue, sizeof(queue));
-
-	/* Note: END_OPT necessary here. Wireshark doesn't do it. */
+	opt = pcapng_add_epb_options(opt, queue, direction);
 
 	/* Add PCAPNG packet header */
 	epb = (struct pcapng_enhance_packet_block *)
@@ -495,7 +576,7 @@ rte_pcapng_copy(uint16_t port_id, uint32_t queue,
 		goto fail;
 
 	epb->block_type = PCAPNG_ENHANCED_PACKET_BLOCK;
-	epb->block_length = rte_pktmbuf_data_len(mc);
+	epb->block_length = rte_pktmbuf_pkt_len(mc);
 
 	/* Interface index is filled in later during write */
 	mc->port = port_id;
@@ -515,6 +596,160 @@ rte_pcapng_copy(uint16_t port_id, uint32_t queue,
 	return NULL;
 }
 
+/* Cut a chain of mbufs after its first len bytes */
+static void
+pcapng_trim(struct rte_mbuf *m, uint32_t len)
+{
+	struct rte_mbuf *seg = m;
+
+	if (rte_pktmbuf_pkt_len(m) <= len)
+		return;
+
+	m->pkt_len = len;
+	m->nb_segs = 1;
+	while (seg->data_len < len) {
+		len -= seg->data_len;
+		seg = seg->next;
+		m->nb_segs++;
+	}
+	seg->data_len = len;
+
+	rte_pktmbuf_free(seg->next);
+	seg->next = NULL;
+}
+
+/*
+ * Reference original mbuf with pcapng header and options.
+ *
+ * The EPB is a chain of three parts: a header mbuf holding the block
+ * header, a clone of the packet data and a trailer mbuf holding the
+ * padding, options and block length. Offloaded VLAN tags are expanded
+ * in the header mbuf, after a copy of the Ethernet addresses which are
+ * then cut from the clone.
+ */
+struct rte_mbuf *
+rte_pcapng_clone(uint16_t port_id, uint32_t queue,
+		 const struct rte_mbuf *md,
+		 struct rte_mempool *mp,
+		 uint32_t length, uint64_t cycles,
+		 enum rte_pcapng_direction direction)
+{
+	struct pcapng_enhance_packet_block *epb;
+	struct rte_mbuf *mh, *mc = NULL, *mt = NULL;
+	uint32_t orig_len, cap_len, padding;
+	uint16_t vlan_type[2], vlan_tci[2];
+	unsigned int i, nb_vlan = 0;
+	struct pcapng_option *opt;
+	uint8_t *trailer;
+	uint16_t *tag;
+	uint64_t ns;
+
+#ifdef RTE_LIBRTE_ETHDEV_DEBUG
+	RTE_ETH_VALID_PORTID_OR_ERR_RET(port_id, NULL);
+#endif
+	ns = pcapng_tsc_to_ns(cycles);
+
+	orig_len = rte_pktmbuf_pkt_len(md);
+
+	/* Offloaded VLAN tags, outermost first */
+	if ((direction == RTE_PCAPNG_DIRECTION_IN &&
+	     (md->ol_flags & RTE_MBUF_F_RX_QINQ_STRIPPED)) ||
+	    (direction == RTE_PCAPNG_DIRECTION_OUT &&
+	     (md->ol_flags & RTE_MBUF_F_TX_QINQ))) {
+		vlan_type[nb_vlan] = RTE_ETHER_TYPE_QINQ;
+		vlan_tci[nb_vlan++] = md->vlan_tci_outer;
+	}
+
+	if ((direction == RTE_PCAPNG_DIRECTION_IN &&
+	     (md->ol_flags & RTE_MBUF_F_RX_VLAN_STRIPPED)) ||
+	    (direction == RTE_PCAPNG_DIRECTION_OUT &&
+	     (md->ol_flags & RTE_MBUF_F_TX_VLAN))) {
+		vlan_type[nb_vlan] = RTE_ETHER_TYPE_VLAN;
+		vlan_tci[nb_vlan++] = md->vlan_tci;
+	}
+
+	if (nb_vlan > 0 &&
+	    (rte_pktmbuf_data_len(md) < sizeof(struct rte_ether_hdr) ||
+	     length < sizeof(struct rte_ether_hdr)))
+		return NULL;
+
+	mh = rte_pktmbuf_alloc(mp);
+	if (unlikely(mh == NULL))
+		return NULL;
+
+	/* Header and trailer only use the headroom of their mbuf */
+	epb = (struct pcapng_enhance_packet_block *)
+		rte_pktmbuf_prepend(mh, sizeof(*epb) +
+				   (nb_vlan > 0 ? 2 * RTE_ETHER_ADDR_LEN : 0) +
+				   nb_vlan * sizeof(struct rte_vlan_hdr));
+	if (unlikely(epb == NULL))
+		goto fail;
+
+	/* Reference the packet data, the cast only bumps its refcnt */
+	mc = rte_pktmbuf_clone((struct rte_mbuf *)(uintptr_t)md, mp);
+	if (unlikely(mc == NULL))
+		goto fail;
+
+	if (nb_vlan > 0) {
+		memcpy(epb + 1, rte_pktmbuf_mtod(md, void *),
+		       2 * RTE_ETHER_ADDR_LEN);
+		tag = (uint16_t *)
+			((uint8_t *)(epb + 1) + 2 * RTE_ETHER_ADDR_LEN);
+		for (i = 0; i < nb_vlan; i++) {
+			*tag++ = rte_cpu_to_be_16(vlan_type[i]);
+			*tag++ = rte_cpu_to_be_16(vlan_tci[i]);
+		}
+		rte_pktmbuf_adj(mc, 2 * RTE_ETHER_ADDR_LEN);
+		length -= 2 * RTE_ETHER_ADDR_LEN;
+	}
+	pcapng_trim(mc, length);
+
+	cap_len = rte_pktmbuf_data_len(mh) - sizeof(*epb) +
+		rte_pktmbuf_pkt_len(mc);
+	padding = RTE_ALIGN(cap_len, sizeof(uint32_t)) - cap_len;
+
+	mt = rte_pktmbuf_alloc(mp);
+	if (unlikely(mt == NULL))
+		goto fail;
+
+	trailer = (uint8_t *)rte_pktmbuf_prepend(mt, padding +
+				PCAPNG_EPB_OPTLEN + sizeof(uint32_t));
+	if (unlikely(trailer == NULL))
+		goto fail;
+	memset(trailer, 0, padding);
+	opt = pcapng_add_epb_options((struct pcapng_option *)
+				     (trailer + padding), queue, direction);
+
+	if (unlikely(rte_pktmbuf_chain(mh, mc) != 0))
+		goto fail;
+	mc = NULL;
+	if (unlikely(rte_pktmbuf_chain(mh, mt) != 0))
+		goto fail;
+	mt = NULL;
+
+	epb->block_type = PCAPNG_ENHANCED_PACKET_BLOCK;
+	epb->block_length = rte_pktmbuf_pkt_len(mh);
+
+	/* Interface index is filled in later during write */
+	mh->port = port_id;
+
+	epb->timestamp_hi = ns >> 32;
+	epb->timestamp_lo = (uint32_t)ns;
+	epb->capture_length = cap_len;
+	epb->original_length = orig_len;
+
+	/* set trailer of block length */
+	*(uint32_t *)opt = epb->block_length;
+
+	return mh;
+
+fail:
+	rte_pktmbuf_free(mt);
+	rte_pktmbuf_free(mc);
+	rte_pktmbuf_free(mh);
+	return NULL;
+}
+
 /* Count how many segments are in this array of mbufs */
 static unsigned int
 mbuf_burst_segs(struct rte_mbuf *pkts[], unsigned int n)
@@ -531,10 +766,59 @@ mbuf_burst_segs(struct rte_mbuf *pkts[], unsigned int n)
 	return iovcnt;
 }
 
-/* Write pre-formatted packets to file. */
-ssize_t
-rte_pcapng_write_packets(rte_pcapng_t *self,
-			 struct rte_mbuf *pkts[], uint16_t nb_pkts)
+/* Check that an mbuf is a pcapng block and set its interface */
+static inline int
+pcapng_epb_prepare(rte_pcapng_t *self, struct rte_mbuf *m)
+{
+	struct pcapng_enhance_packet_block *epb;
+
+	/* sanity check that is really a pcapng mbuf */
+	epb = rte_pktmbuf_mtod(m, struct pcapng_enhance_packet_block *);
+	if (unlikely(rte_pktmbuf_data_len(m) < sizeof(*epb) ||
+		     epb->block_type != PCAPNG_ENHANCED_PACKET_BLOCK ||
+		     epb->block_length != rte_pktmbuf_pkt_len(m))) {
+		rte_errno = EINVAL;
+		return -1;
+	}
+
+	/*
+	 * The DPDK port is recorded during pcapng_copy.
+	 * Map that to PCAPNG interface in file.
+	 */
+	epb->interface_id = self->port_index[m->port];
+	return 0;
+}
+
+/* Copy pre-formatted packets to the write buffer */
+static ssize_t
+pcapng_buffer_packets(rte_pcapng_t *self,
+		      struct rte_mbuf *pkts[], uint16_t nb_pkts)
+{
+	ssize_t len = 0;
+	unsigned int i;
+
+	for (i = 0; i < nb_pkts; i++) {
+		struct rte_mbuf *m = pkts[i];
+
+		__rte_mbuf_sanity_check(m, 1);
+
+		if (pcapng_epb_prepare(self, m) < 0)
+			return -1;
+
+		len += rte_pktmbuf_pkt_len(m);
+		do {
+			if (pcapng_buffer_add(self, rte_pktmbuf_mtod(m, void *),
+					      rte_pktmbuf_data_len(m)) < 0)
+				return -1;
+		} while ((m = m->next));
+	}
+	return len;
+}
+
+/* Write pre-formatted packets to file with one writev */
+static ssize_t
+pcapng_writev_packets(rte_pcapng_t *self,
+		      struct rte_mbuf *pkts[], uint16_t nb_pkts)
 {
 	int iovcnt = mbuf_burst_segs(pkts, nb_pkts);
 	struct iovec iov[iovcnt];
@@ -543,21 +827,10 @@ rte_pcapng_write_packets(rte_pcapng_t *self,
 
 	for (i = cnt = 0; i < nb_pkts; i++) {
 		struct rte_mbuf *m = pkts[i];
-		struct pcapng_enhance_packet_block *epb;
 
-		/* sanity check that is really a pcapng mbuf */
-		epb = rte_pktmbuf_mtod(m, struct pcapng_enhance_packet_block *);
-		if (unlikely(epb->block_type != PCAPNG_ENHANCED_PACKET_BLOCK ||
-			     epb->block_length != rte_pktmbuf_data_len(m))) {
-			rte_errno = EINVAL;
+		if (pcapng_epb_prepare(self, m) < 0)
 			return -1;
-		}
 
-		/*
-		 * The DPDK port is recorded during pcapng_copy.
-		 * Map that to PCAPNG interface in file.
-		 */
-		epb->interface_id = self->port_index[m->port];
 		do {
 			iov[cnt].iov_base = rte_pktmbuf_mtod(m, void *);
 			iov[cnt].iov_len = rte_pktmbuf_data_len(m);
@@ -571,6 +844,58 @@ rte_pcapng_write_packets(rte_pcapng_t *self,
 	return ret;
 }
 
+/* Write pre-formatted packets to file. */
+ssize_t
+rte_pcapng_write_packets(rte_pcapng_t *self,
+			 struct rte_mbuf *pkts[], uint16_t nb_pkts)
+{
+	if (self->buf != NULL)
+		return pcapng_buffer_packets(self, pkts, nb_pkts);
+	return pcapng_writev_packets(self, pkts, nb_pkts);
+}
+
+int
+rte_pcapng_set_write_buffer(rte_pcapng_t *self, uint32_t size)
+{
+	void *buf = NULL;
+	off_t offset;
+
+	if (self->buf != NULL) {
+		if (pcapng_buffer_write(self) < 0)
+			return -1;
+		free(self->buf);
+		self->buf = NULL;
+	}
+
+	if (size == 0)
+		return 0;
+
+	/* Page aligned, the buffer is mostly written whole */
+	if (posix_memalign(&buf, getpagesize(), size) != 0) {
+		rte_errno = ENOMEM;
+		return -1;
+	}
+
+	/* Pipes have no offset, take them as aligned */
+	offset = lseek(self->outfd, 0, SEEK_CUR);
+	if (offset < 0)
+		offset = 0;
+
+	self->buf = buf;
+	self->buf_size = size;
+	self->buf_head = self->buf_len = offset % size;
+	return 0;
+}
+
+int
+rte_pcapng_flush(rte_pcapng_t *self)
+{
+	if (self->buf == NULL)
+		return 0;
+
+	return pcapng_buffer_write(self);
+}
+
 /* Create new pcapng writer handle */
 rte_pcapng_t *
 rte_pcapng_fdopen(int fd,
@@ -579,7 +904,7 @@ rte_pcapng_fdopen(int fd,
 {
 	rte_pcapng_t *self;
 
-	self = malloc(sizeof(*self));
+	self = calloc(1, sizeof(*self));
 	if (!self) {
 		rte_errno = ENOMEM;
 		return NULL;
@@ -602,6 +927,8 @@ rte_pcapng_fdopen(int fd,
 void
 rte_pcapng_close(rte_pcapng_t *self)
 {
+	rte_pcapng_flush(self);
+	free(self->buf);
 	close(self->outfd);
 	free(self);
 }
@@ -116,6 +116,48 @@ rte_pcapng_copy(uint16_t port_id, uint32_t queue,
 		enum rte_pcapng_direction direction);
 
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Format an mbuf for writing to file without copying its data.
+ *
+ * Same as rte_pcapng_copy(), but the packet data is referenced
+ * with indirect mbufs instead of being copied, so it must not be
+ * modified until the returned mbuf is freed.
+ * The pcapng header and trailer are in two more mbufs chained
+ * before and after the indirect ones.
+ *
+ * @param port_id
+ *   The Ethernet port on which packet was received
+ *   or is going to be transmitted.
+ * @param queue
+ *   The queue on the Ethernet port where packet was received
+ *   or is going to be transmitted.
+ * @param m
+ *   The mbuf to reference.
+ * @param mp
+ *   The mempool from which the header, trailer and indirect mbufs
+ *   are allocated. Its data room must be at least 64 bytes.
+ * @param length
+ *   The upper limit on bytes to capture.  Passing UINT32_MAX
+ *   means all data.
+ * @param timestamp
+ *   The timestamp in TSC cycles.
+ * @param direction
+ *   The direction of the packet: receive, transmit or unknown.
+ *
+ * @return
+ *   - The pointer to the new mbuf formatted for pcapng_write
+ *   - NULL if allocation fails.
+ */
+__rte_experimental
+struct rte_mbuf *
+rte_pcapng_clone(uint16_t port_id, uint32_t queue,
+		 const struct rte_mbuf *m, struct rte_mempool *mp,
+		 uint32_t length, uint64_t timestamp,
+		 enum rte_pcapng_direction direction);
+
 /**
  * Determine optimum mbuf data size.
  *
@@ -133,7 +175,8 @@ rte_pcapng_mbuf_size(uint32_t length);
  * Write packets to the capture file.
  *
  * Packets to be captured are copied by rte_pcapng_copy()
- * and then this function is called to write them to the file.
+ * or rte_pcapng_clone() and then this function is called
+ * to write them to the file.
  *
  * @warning
  * Do not pass original mbufs from transmit or receive
@@ -155,6 +198,47 @@ ssize_t
 rte_pcapng_write_packets(rte_pcapng_t *self,
 			 struct rte_mbuf *pkts[], uint16_t nb_pkts);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Set the write buffer of the capture file.
+ *
+ * Once set, rte_pcapng_write_packets() and rte_pcapng_write_stats()
+ * copy the blocks to the buffer, which is written to file each time
+ * it is full, up to the next file offset multiple of *size*.
+ * The pending data is written by rte_pcapng_flush() and
+ * rte_pcapng_close().
+ * The first write after this call or after a flush starts at the current
+ * file offset and the flushes write what is pending, so not all the
+ * writes are aligned: the file must not be opened with O_DIRECT.
+ *
+ * @param self
+ *  The handle to the packet capture file
+ * @param size
+ *  The size of the buffer in bytes, 0 to write the blocks directly.
+ * @return
+ *  0 on success, -1 on failure with rte_errno set.
+ */
+__rte_experimental
+int
+rte_pcapng_set_write_buffer(rte_pcapng_t *self, uint32_t size);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Write the data pending in the write buffer to the capture file.
+ *
+ * @param self
+ *  The handle to the packet capture file
+ * @return
+ *  0 on success, -1 on failure to write file with rte_errno set.
+ */
+__rte_experimental
+int
+rte_pcapng_flush(rte_pcapng_t *self);
+
 /**
  * Write an Interface statistics block.
  * For statistics, use 0 if don't know or care to report it.
@@ -10,6 +10,7 @@
 #include <rte_memzone.h>
 #include <rte_errno.h>
 #include <rte_string_fns.h>
+#include <rte_net.h>
 #include <rte_pcapng.h>
 
 #include "rte_pdump.h"
@@ -46,6 +47,10 @@ struct pdump_request {
 
 	const struct rte_bpf_prm *prm;
 	uint32_t snaplen;
+	uint32_t sample_rate;
+	/* per-queue rings, used instead of ring if nb_rings is not 0 */
+	struct rte_ring * const *rings;
+	uint16_t nb_rings;
 };
 
 struct pdump_response {
@@ -61,6 +66,10 @@ static struct pdump_rxtx_cbs {
 	const struct rte_bpf *filter;
 	enum pdump_version ver;
 	uint32_t snaplen;
+	bool zerocopy;
+	bool sample_flow;	/* sample flows rather than packets */
+	uint32_t sample_rate;	/* capture one in sample_rate */
+	uint32_t sample_count;	/* packets since last sampled one */
 } rx_cbs[RTE_MAX_ETHPORTS][RTE_MAX_QUEUES_PER_PORT],
 tx_cbs[RTE_MAX_ETHPORTS][RTE_MAX_QUEUES_PER_PORT];
 
@@ -77,24 +86,117 @@ static struct {
 	const struct rte_memzone *mz;
 } *pdump_stats;
 
+/*
+ * Hash of the IP addresses and L4 ports of a packet, the same for both
+ * directions of a flow. The RSS hash is not used: it is usually not
+ * symmetric, and transmitted packets do not have one.
+ * Packets which are not IP all have hash 0.
+ */
+static uint32_t
+pdump_flow_hash(const struct rte_mbuf *m)
+{
+	struct rte_net_hdr_lens hdr_lens;
+	uint32_t ptype, l4, hash = 0;
+	uint32_t buf[8];
+	const uint32_t *addr;
+	const uint16_t *ports;
+	unsigned int i, n;
+
+	ptype = rte_net_get_ptype(m, &hdr_lens, RTE_PTYPE_L2_MASK |
+				  RTE_PTYPE_L3_MASK | RTE_PTYPE_L4_MASK);
+	if (RTE_ETH_IS_IPV4_HDR(ptype)) {
+		n = 2;
+		addr = rte_pktmbuf_read(m, hdr_lens.l2_len +
+				offsetof(struct rte_ipv4_hdr, src_addr),
+				n * sizeof(uint32_t), buf);
+	} else if (RTE_ETH_IS_IPV6_HDR(ptype)) {
+		n = 8;
+		addr = rte_pktmbuf_read(m, hdr_lens.l2_len +
+				offsetof(struct rte_ipv6_hdr, src_addr),
+				n * sizeof(uint32_t), buf);
+	} else {
+		return 0;
+	}
+	if (addr == NULL)
+		return 0;
+	for (i = 0; i < n; i++)
+		hash ^= addr[i];
+
+	l4 = ptype & RTE_PTYPE_L4_MASK;
+	if (l4 == RTE_PTYPE_L4_TCP || l4 == RTE_PTYPE_L4_UDP ||
+	    l4 == RTE_PTYPE_L4_SCTP) {
+		ports = rte_pktmbuf_read(m, hdr_lens.l2_len + hdr_lens.l3_len,
+					 2 * sizeof(uint16_t), buf);
+		if (ports != NULL)
+			hash ^= ports[0] ^ ports[1];
+	}
+	return hash;
+}
+
+/*
+ * Select the packets to capture: one packet in sample_rate, or all
+ * the packets of one flow in sample_rate.
+ */
+static uint16_t
+pdump_sample(struct pdump_rxtx_cbs *cbs,
+	     struct rte_mbuf **pkts, uint16_t nb_pkts,
+	     struct rte_mbuf **sampled)
+{
+	uint32_t count = cbs->sample_count;
+	uint16_t i, n = 0;
+	uint32_t hash;
+
+	if (cbs->sample_flow) {
+		for (i = 0; i < nb_pkts; i++) {
+			/* Spread the hash before scaling it to the rate */
+			hash = pdump_flow_hash(pkts[i]) * 0x9e3779b1;
+			if (((uint64_t)hash * cbs->sample_rate) >> 32 == 0)
+				sampled[n++] = pkts[i];
+		}
+		return n;
+	}
+
+	for (i = 0; i < nb_pkts; i++) {
+		if (++count == cbs->sample_rate) {
+			count = 0;
+			sampled[n++] = pkts[i];
+		}
+	}
+	cbs->sample_count = count;
+	return n;
+}
+
 /* Create a clone of mbuf to be placed into ring. */
 static void
 pdump_copy(uint16_t port_id, uint16_t queue,
 	   enum rte_pcapng_direction direction,
 	   struct rte_mbuf **pkts, uint16_t nb_pkts,
-	   const struct pdump_rxtx_cbs *cbs,
+	   struct pdump_rxtx_cbs *cbs,
 	   struct rte_pdump_stats *stats)
 {
 	unsigned int i;
 	int ring_enq;
 	uint16_t d_pkts = 0;
 	struct rte_mbuf *dup_bufs[nb_pkts];
+	struct rte_mbuf *sampled[nb_pkts];
 	uint64_t ts;
 	struct rte_ring *ring;
 	struct rte_mempool *mp;
 	struct rte_mbuf *p;
 	uint64_t rcs[nb_pkts];
 
+	/* Sample before anything else, to leave the other packets alone */
+	if (cbs->sample_rate > 1) {
+		uint16_t nb_sampled = pdump_sample(cbs, pkts, nb_pkts, sampled);
+
+		__atomic_fetch_add(&stats->skipped, nb_pkts - nb_sampled,
+				   __ATOMIC_RELAXED);
+		if (nb_sampled == 0)
+			return;
+		pkts = sampled;
+		nb_pkts = nb_sampled;
+	}
+
 	if (cbs->filter)
 		rte_bpf_exec_burst(cbs->filter, (void **)pkts, rcs, nb_pkts);
 
@@ -118,7 +220,11 @@ pdump_copy(uint16_t port_id, uint16_t queue,
 		 * If using pcapng then want to wrap packets
 		 * otherwise a simple copy.
 		 */
-		if (cbs->ver == V2)
+		if (cbs->ver == V2 && cbs->zerocopy)
+			p = rte_pcapng_clone(port_id, queue,
+					     pkts[i], mp, cbs->snaplen,
+					     ts, direction);
+		else if (cbs->ver == V2)
 			p = rte_pcapng_copy(port_id, queue,
 					    pkts[i], mp, cbs->snaplen,
 					    ts, direction);
@@ -147,7 +253,7 @@ pdump_rx(uint16_t port, uint16_t queue,
 	struct rte_mbuf **pkts, uint16_t nb_pkts,
 	uint16_t max_pkts __rte_unused, void *user_params)
 {
-	const struct pdump_rxtx_cbs *cbs = user_params;
+	struct pdump_rxtx_cbs *cbs = user_params;
 	struct rte_pdump_stats *stats = &pdump_stats->rx[port][queue];
 
 	pdump_copy(port, queue, RTE_PCAPNG_DIRECTION_IN,
@@ -159,7 +265,7 @@ static uint16_t
 pdump_tx(uint16_t port, uint16_t queue,
 		struct rte_mbuf **pkts, uint16_t nb_pkts, void *user_params)
 {
-	const struct pdump_rxtx_cbs *cbs = user_params;
+	struct pdump_rxtx_cbs *cbs = user_params;
 	struct rte_pdump_stats *stats = &pdump_stats->tx[port][queue];
 
 	pdump_copy(port, queue, RTE_PCAPNG_DIRECTION_OUT,
@@ -167,31 +273,41 @@ pdump_tx(uint16_t port, uint16_t queue,
 	return nb_pkts;
 }
 
+static void
+pdump_cbs_init(struct pdump_rxtx_cbs *cbs, const struct pdump_request *p,
+	       struct rte_ring *ring, struct rte_bpf *filter)
+{
+	cbs->ver = p->ver;
+	cbs->ring = ring;
+	cbs->mp = p->mp;
+	cbs->snaplen = p->snaplen;
+	cbs->zerocopy = !!(p->flags & RTE_PDUMP_FLAG_ZEROCOPY);
+	cbs->sample_flow = !!(p->flags & RTE_PDUMP_FLAG_SAMPLE_FLOW);
+	cbs->sample_rate = p->sample_rate;
+	cbs->sample_count = 0;
+	cbs->filter = filter;
+}
+
 static int
-pdump_register_rx_callbacks(enum pdump_version ver,
-			    uint16_t end_q, uint16_t port, uint16_t queue,
-			    struct rte_ring *ring, struct rte_mempool *mp,
-			    struct rte_bpf *filter,
-			    uint16_t operation, uint32_t snaplen)
+pdump_register_rx_callbacks(const struct pdump_request *p,
+			    uint16_t end_q, uint16_t port,
+			    struct rte_ring * const *rings, uint16_t nb_rings,
+			    struct rte_bpf *filter)
 {
 	uint16_t qid;
 
-	qid = (queue == RTE_PDUMP_ALL_QUEUES) ? 0 : queue;
+	qid = (p->queue == RTE_PDUMP_ALL_QUEUES) ? 0 : p->queue;
 	for (; qid < end_q; qid++) {
 		struct pdump_rxtx_cbs *cbs = &rx_cbs[port][qid];
 
-		if (operation == ENABLE) {
+		if (p->op == ENABLE) {
 			if (cbs->cb) {
 				PDUMP_LOG(ERR,
 					"rx callback for port=%d queue=%d, already exists\n",
 					port, qid);
 				return -EEXIST;
 			}
-			cbs->ver = ver;
-			cbs->ring = ring;
-			cbs->mp = mp;
-			cbs->snaplen = snaplen;
-			cbs->filter = filter;
+			pdump_cbs_init(cbs, p, rings[qid % nb_rings], filter);
 
 			cbs->cb = rte_eth_add_first_rx_callback(port, qid,
 								pdump_rx, cbs);
@@ -201,7 +317,7 @@ pdump_register_rx_callbacks(enum pdump_version ver,
 					rte_errno);
 				return rte_errno;
 			}
-		} else if (operation == DISABLE) {
+		} else if (p->op == DISABLE) {
 			int ret;
 
 			if (cbs->cb == NULL) {
@@ -224,32 +340,49 @@ pdump_register_rx_callbacks(enum pdump_version ver,
 	return 0;
 }
 
-static int
-pdump_register_tx_callbacks(enum pdump_version ver,
-			    uint16_t end_q, uint16_t port, uint16_t queue,
-			    struct rte_ring *ring, struct rte_mempool *mp,
-			    struct rte_bpf *filter,
-			    uint16_t operation, uint32_t snaplen)
+/* Tx queues with fast free recycle the mbufs whatever their refcnt */
+static bool
+pdump_tx_fast_free(uint16_t port, uint16_t queue)
 {
+	struct rte_eth_txq_info qinfo;
+	struct rte_eth_conf dev_conf;
+
+	if (rte_eth_dev_conf_get(port, &dev_conf) == 0 &&
+	    (dev_conf.txmode.offloads & RTE_ETH_TX_OFFLOAD_MBUF_FAST_FREE))
+		return true;
+
+	return rte_eth_tx_queue_info_get(port, queue, &qinfo) == 0 &&
+		(qinfo.conf.offloads & RTE_ETH_TX_OFFLOAD_MBUF_FAST_FREE);
+}
 
+static int
+pdump_register_tx_callbacks(const struct pdump_request *p,
+			    uint16_t end_q, uint16_t port,
+			    struct rte_ring * const *rings, uint16_t nb_rings,
+			    struct rte_bpf *filter)
+{
 	uint16_t qid;
 
-	qid = (queue == RTE_PDUMP_ALL_QUEUES) ? 0 : queue;
+	qid = (p->queue == RTE_PDUMP_ALL_QUEUES) ? 0 : p->queue;
 	for (; qid < end_q; qid++) {
 		struct pdump_rxtx_cbs *cbs = &tx_cbs[port][qid];
 
-		if (operation == ENABLE) {
+		if (p->op == ENABLE) {
 			if (cbs->cb) {
 				PDUMP_LOG(ERR,
 					"tx callback for port=%d queue=%d, already exists\n",
 					port, qid);
 				return -EEXIST;
 			}
-			cbs->ver = ver;
-			cbs->ring = ring;
-			cbs->mp = mp;
-			cbs->snaplen = snaplen;
-			cbs->filter = filter;
+			pdump_cbs_init(cbs, p, rings[qid % nb_rings], filter);
+
+			/* The capture must not reference recycled mbufs */
+			if (cbs->zerocopy && pdump_tx_fast_free(port, qid)) {
+				PDUMP_LOG(INFO,
+					"copying packets of tx queue %d of port %d, it uses fast free\n",
+					qid, port);
+				cbs->zerocopy = false;
+			}
 
 			cbs->cb = rte_eth_add_tx_callback(port, qid, pdump_tx,
 								cbs);
@@ -259,7 +392,7 @@ pdump_register_tx_callbacks(enum pdump_version ver,
 					rte_errno);
 				return rte_errno;
 			}
-		} else if (operation == DISABLE) {
+		} else if (p->op == DISABLE) {
 			int ret;
 
 			if (cbs->cb == NULL) {
@@ -290,9 +423,8 @@ set_pdump_rxtx_cbs(const struct pdump_request *p)
 	int ret = 0;
 	struct rte_bpf *filter = NULL;
 	uint32_t flags;
-	uint16_t operation;
-	struct rte_ring *ring;
-	struct rte_mempool *mp;
+	struct rte_ring * const *rings;
+	uint16_t nb_rings;
 
 	/* Check for possible DPDK version mismatch */
 	if (!(p->ver == V1 || p->ver == V2)) {
@@ -318,10 +450,16 @@ set_pdump_rxtx_cbs(const struct pdump_request *p)
 	}
 
 	flags = p->flags;
-	operation = p->op;
 	queue = p->queue;
-	ring = p->ring;
-	mp = p->mp;
+
+	/* queue q captures to rings[q % nb_rings], or to the single ring */
+	if (p->nb_rings != 0) {
+		rings = p->rings;
+		nb_rings = p->nb_rings;
+	} else {
+		rings = &p->ring;
+		nb_rings = 1;
+	}
 
 	ret = rte_eth_dev_get_port_by_name(p->device, &port);
 	if (ret < 0) {
@@ -356,7 +494,7 @@ set_pdump_rxtx_cbs(const struct pdump_request *p)
 			return -EINVAL;
 		}
 		if ((nb_tx_q == 0 || nb_rx_q == 0) &&
-			flags == RTE_PDUMP_FLAG_RXTX) {
+			(flags & RTE_PDUMP_FLAG_RXTX) == RTE_PDUMP_FLAG_RXTX) {
 			PDUMP_LOG(ERR,
 				"both tx&rx queues must be non zero\n");
 			return -EINVAL;
@@ -366,9 +504,8 @@ set_pdump_rxtx_cbs(const struct pdump_request *p)
 	/* register RX callback */
 	if (flags & RTE_PDUMP_FLAG_RX) {
 		end_q = (queue == RTE_PDUMP_ALL_QUEUES) ? nb_rx_q : queue + 1;
-		ret = pdump_register_rx_callbacks(p->ver, end_q, port, queue,
-						  ring, mp, filter,
-						  operation, p->snaplen);
+		ret = pdump_register_rx_callbacks(p, end_q, port,
+						  rings, nb_rings, filter);
 		if (ret < 0)
 			return ret;
 	}
@@ -376,9 +513,8 @@ set_pdump_rxtx_cbs(const struct pdump_request *p)
 	/* register TX callback */
 	if (flags & RTE_PDUMP_FLAG_TX) {
 		end_q = (queue == RTE_PDUMP_ALL_QUEUES) ? nb_tx_q : queue + 1;
-		ret = pdump_register_tx_callbacks(p->ver, end_q, port, queue,
-						  ring, mp, filter,
-						  operation, p->snaplen);
+		ret = pdump_register_tx_callbacks(p, end_q, port,
+						  rings, nb_rings, filter);
 		if (ret < 0)
 			return ret;
 	}
@@ -489,13 +625,22 @@ pdump_validate_flags(uint32_t flags)
 	}
 
 	/* mask off the flags we know about */
-	if (flags & ~(RTE_PDUMP_FLAG_RXTX | RTE_PDUMP_FLAG_PCAPNG)) {
+	if (flags & ~(RTE_PDUMP_FLAG_RXTX | RTE_PDUMP_FLAG_PCAPNG |
+		      RTE_PDUMP_FLAG_ZEROCOPY | RTE_PDUMP_FLAG_SAMPLE_FLOW)) {
 		PDUMP_LOG(ERR,
 			  "unknown flags: %#x\n", flags);
 		rte_errno = ENOTSUP;
 		return -1;
 	}
 
+	if ((flags & RTE_PDUMP_FLAG_ZEROCOPY) &&
+	    !(flags & RTE_PDUMP_FLAG_PCAPNG)) {
+		PDUMP_LOG(ERR,
+			  "zero copy capture requires pcapng format\n");
+		rte_errno = EINVAL;
+		return -1;
+	}
+
 	return 0;
 }
 
@@ -526,6 +671,8 @@ pdump_prepare_client_request(const char *device, uint16_t queue,
 			     uint32_t flags, uint32_t snaplen,
 			     uint16_t operation,
 			     struct rte_ring *ring,
+			     struct rte_ring * const *rings, uint16_t nb_rings,
+			     uint32_t sample_rate,
 			     struct rte_mempool *mp,
 			     const struct rte_bpf_prm *prm)
 {
@@ -539,13 +686,17 @@ pdump_prepare_client_request(const char *device, uint16_t queue,
 	memset(req, 0, sizeof(*req));
 
 	req->ver = (flags & RTE_PDUMP_FLAG_PCAPNG) ? V2 : V1;
-	req->flags = flags & RTE_PDUMP_FLAG_RXTX;
+	req->flags = flags & (RTE_PDUMP_FLAG_RXTX | RTE_PDUMP_FLAG_ZEROCOPY |
+			      RTE_PDUMP_FLAG_SAMPLE_FLOW);
 	req->op = operation;
 	req->queue = queue;
 	rte_strscpy(req->device, device, sizeof(req->device));
 
 	if ((operation & ENABLE) != 0) {
 		req->ring = ring;
+		req->rings = rings;
+		req->nb_rings = nb_rings;
+		req->sample_rate = sample_rate;
 		req->mp = mp;
 		req->prm = prm;
 		req->snaplen = snaplen;
@@ -598,7 +749,7 @@ pdump_enable(uint16_t port, uint16_t queue,
 		snaplen = UINT32_MAX;
 
 	return pdump_prepare_client_request(name, queue, flags, snaplen,
-					    ENABLE, ring, mp, prm);
+					    ENABLE, ring, NULL, 0, 0, mp, prm);
 }
 
 int
@@ -622,6 +773,43 @@ rte_pdump_enable_bpf(uint16_t port, uint16_t queue,
 			    ring, mp, prm);
 }
 
+int
+rte_pdump_enable_sample(uint16_t port, uint16_t queue,
+			uint32_t flags, uint32_t snaplen,
+			uint32_t sample_rate,
+			struct rte_ring * const *rings, uint16_t nb_rings,
+			struct rte_mempool *mp,
+			const struct rte_bpf_prm *prm)
+{
+	int ret;
+	uint16_t i;
+	char name[RTE_DEV_NAME_MAX_LEN];
+
+	ret = pdump_validate_port(port, name);
+	if (ret < 0)
+		return ret;
+	if (rings == NULL || nb_rings == 0) {
+		PDUMP_LOG(ERR, "no capture rings\n");
+		rte_errno = EINVAL;
+		return -1;
+	}
+	for (i = 0; i < nb_rings; i++) {
+		ret = pdump_validate_ring_mp(rings[i], mp);
+		if (ret < 0)
+			return ret;
+	}
+	ret = pdump_validate_flags(flags);
+	if (ret < 0)
+		return ret;
+
+	if (snaplen == 0)
+		snaplen = UINT32_MAX;
+
+	return pdump_prepare_client_request(name, queue, flags, snaplen,
+					    ENABLE, rings[0], rings, nb_rings,
+					    sample_rate, mp, prm);
+}
+
 static int
 pdump_enable_by_deviceid(const char *device_id, uint16_t queue,
 			 uint32_t flags, uint32_t snaplen,
@@ -642,7 +830,7 @@ pdump_enable_by_deviceid(const char *device_id, uint16_t queue,
 		snaplen = UINT32_MAX;
 
 	return pdump_prepare_client_request(device_id, queue, flags, snaplen,
-					    ENABLE, ring, mp, prm);
+					    ENABLE, ring, NULL, 0, 0, mp, prm);
 }
 
 int
@@ -681,7 +869,8 @@ rte_pdump_disable(uint16_t port, uint16_t queue, uint32_t flags)
 		return ret;
 
 	ret = pdump_prepare_client_request(name, queue, flags, 0,
-					   DISABLE, NULL, NULL, NULL);
+					   DISABLE, NULL, NULL, 0, 0,
+					   NULL, NULL);
 
 	return ret;
 }
@@ -697,7 +886,8 @@ rte_pdump_disable_by_deviceid(char *device_id, uint16_t queue,
 		return ret;
 
 	ret = pdump_prepare_client_request(device_id, queue, flags, 0,
-					   DISABLE, NULL, NULL, NULL);
+					   DISABLE, NULL, NULL, 0, 0,
+					   NULL, NULL);
 
 	return ret;
 }
@@ -30,6 +30,10 @@ enum {
 	RTE_PDUMP_FLAG_RXTX = (RTE_PDUMP_FLAG_RX|RTE_PDUMP_FLAG_TX),
 
 	RTE_PDUMP_FLAG_PCAPNG = 4, /* format for pcapng */
+	/* reference packets instead of copying them, requires pcapng */
+	RTE_PDUMP_FLAG_ZEROCOPY = 8,
+	/* sample whole flows instead of single packets */
+	RTE_PDUMP_FLAG_SAMPLE_FLOW = 16,
 };
 
 /**
@@ -97,6 +101,11 @@ rte_pdump_enable(uint16_t port, uint16_t queue, uint32_t flags,
  *  queues of a given port.
  * @param flags
  *  Pdump library flags that specify direction and packet format.
+ *  With RTE_PDUMP_FLAG_ZEROCOPY, the captured packets reference the data
+ *  of the original ones, see rte_pcapng_clone(), which is then only
+ *  freed once the captured packets are. The packets of Tx queues with
+ *  RTE_ETH_TX_OFFLOAD_MBUF_FAST_FREE, which are freed whatever their
+ *  reference count, are copied instead.
  * @param snaplen
  *  The upper limit on bytes to copy.
  *  Passing UINT32_MAX means capture all the possible data.
@@ -118,6 +127,59 @@ rte_pdump_enable_bpf(uint16_t port_id, uint16_t queue,
 		     struct rte_mempool *mp,
 		     const struct rte_bpf_prm *prm);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change, or be removed, without prior notice
+ *
+ * Enables sampled packet capturing on given port and queue, with one
+ * capture ring per queue.
+ *
+ * Only one packet in sample_rate is captured; the others are counted as
+ * skipped in the statistics and are not copied. With
+ * RTE_PDUMP_FLAG_SAMPLE_FLOW, the choice is made per flow instead, from a
+ * hash of the IP addresses and ports of the packets, so that one flow in
+ * sample_rate is captured whole, in both directions.
+ * Packets which are not IP are all captured then.
+ *
+ * The packets of queue q are enqueued to rings[q % nb_rings], so that the
+ * queues of the port do not contend on the same ring.
+ *
+ * @param port_id
+ *  The Ethernet port on which packet capturing should be enabled.
+ * @param queue
+ *  The queue on the Ethernet port which packet capturing
+ *  should be enabled. Pass UINT16_MAX to enable packet capturing on all
+ *  queues of a given port.
+ * @param flags
+ *  Pdump library flags that specify direction, packet format and sampling.
+ * @param snaplen
+ *  The upper limit on bytes to copy.
+ *  Passing UINT32_MAX means capture all the possible data.
+ * @param sample_rate
+ *  Capture one packet, or one flow, in sample_rate.
+ *  0 or 1 means capture all the packets.
+ * @param rings
+ *  The rings on which captured packets will be enqueued for user.
+ *  The array must be in shared memory, like the rings themselves.
+ * @param nb_rings
+ *  The number of rings in the array.
+ * @param mp
+ *  The mempool on to which original packets will be mirrored or duplicated.
+ * @param prm
+ *  Use BPF program to run to filter packets of the sample (can be NULL)
+ *
+ * @return
+ *    0 on success, -1 on error, rte_errno is set accordingly.
+ */
+__rte_experimental
+int
+rte_pdump_enable_sample(uint16_t port_id, uint16_t queue,
+			uint32_t flags, uint32_t snaplen,
+			uint32_t sample_rate,
+			struct rte_ring * const *rings, uint16_t nb_rings,
+			struct rte_mempool *mp,
+			const struct rte_bpf_prm *prm);
+
 /**
  * Disables packet capturing on given port and queue.
  *
@@ -238,8 +300,9 @@ struct rte_pdump_stats {
 	uint64_t filtered; /**< Number of packets rejected by filter. */
 	uint64_t nombuf;   /**< Number of mbuf allocation failures. */
 	uint64_t ringfull; /**< Number of missed packets due to ring full. */
+	uint64_t skipped;  /**< Number of packets skipped by sampling. */
 
-	uint64_t reserved[4]; /**< Reserved and pad to cache line */
+	uint64_t reserved[3]; /**< Reserved and pad to cache line */
 };
 
 /**
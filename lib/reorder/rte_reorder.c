@@ -24,6 +24,7 @@ static struct rte_tailq_elem rte_reorder_tailq = {
 EAL_REGISTER_TAILQ(rte_reorder_tailq)
 
 #define NO_FLAGS 0
+#define RTE_REORDER_F_MP_INSERT 0x1
 #define RTE_REORDER_PREFIX "RO_"
 #define RTE_REORDER_NAMESIZE 32
 
@@ -50,6 +51,9 @@ struct rte_reorder_buffer {
 	struct cir_buffer ready_buf; /**< temp buffer for dequeued entries */
 	struct cir_buffer order_buf; /**< buffer used to reorder entries */
 	int is_initialized;
+	unsigned int flags; /**< RTE_REORDER_F_* flags set at creation */
+	/** Seq. number the drain of a multi-producer buffer may skip up to */
+	uint32_t skip_seqn;
 } __rte_cache_aligned;
 
 static void
@@ -99,8 +103,9 @@ rte_reorder_init(struct rte_reorder_buffer *b, unsigned int bufsize,
 	return b;
 }
 
-struct rte_reorder_buffer*
-rte_reorder_create(const char *name, unsigned socket_id, unsigned int size)
+static struct rte_reorder_buffer *
+reorder_create(const char *name, unsigned int socket_id, unsigned int size,
+		unsigned int flags)
 {
 	struct rte_reorder_buffer *b = NULL;
 	struct rte_tailq_entry *te;
@@ -165,6 +170,7 @@ rte_reorder_create(const char *name, unsigned socket_id, unsigned int size)
 		rte_free(te);
 	} else {
 		rte_reorder_init(b, bufsize, name, size);
+		b->flags = flags;
 		te->data = (void *)b;
 		TAILQ_INSERT_TAIL(reorder_list, te, next);
 	}
@@ -174,15 +180,30 @@ rte_reorder_create(const char *name, unsigned socket_id, unsigned int size)
 	return b;
 }
 
+struct rte_reorder_buffer*
+rte_reorder_create(const char *name, unsigned socket_id, unsigned int size)
+{
+	return reorder_create(name, socket_id, size, NO_FLAGS);
+}
+
+struct rte_reorder_buffer *
+rte_reorder_create_mp(const char *name, unsigned int socket_id,
+		unsigned int size)
+{
+	return reorder_create(name, socket_id, size, RTE_REORDER_F_MP_INSERT);
+}
+
 void
 rte_reorder_reset(struct rte_reorder_buffer *b)
 {
 	char name[RTE_REORDER_NAMESIZE];
+	unsigned int flags = b->flags;
 
 	rte_reorder_free_mbufs(b);
 	strlcpy(name, b->name, sizeof(name));
 	/* No error checking as current values should be valid */
 	rte_reorder_init(b, b->memsize, name, b->order_buf.size);
+	b->flags = flags;
 }
 
 static void
@@ -314,18 +335,12 @@ rte_reorder_fill_overflow(struct rte_reorder_buffer *b, unsigned n)
 	return order_head_adv;
 }
 
-int
-rte_reorder_insert(struct rte_reorder_buffer *b, struct rte_mbuf *mbuf)
+static inline int
+reorder_insert_sp(struct rte_reorder_buffer *b, struct rte_mbuf *mbuf)
 {
 	uint32_t offset, position;
-	struct cir_buffer *order_buf;
+	struct cir_buffer *order_buf = &b->order_buf;
 
-	if (b == NULL || mbuf == NULL) {
-		rte_errno = EINVAL;
-		return -1;
-	}
-
-	order_buf = &b->order_buf;
 	if (!b->is_initialized) {
 		b->min_seqn = *rte_reorder_seqn(mbuf);
 		b->is_initialized = 1;
@@ -380,6 +395,123 @@ rte_reorder_insert(struct rte_reorder_buffer *b, struct rte_mbuf *mbuf)
 	return 0;
 }
 
+/*
+ * Insert into a multi-producer buffer. The slot of a sequence number is
+ * fixed, seqn & mask, so producers only race on distinct slots and the
+ * single drain publishes the window start with a store-release of min_seqn.
+ *
+ * A producer may compute its offset from a min_seqn that the drain moved
+ * past the mbuf since, in which case the late mbuf lands in the slot of a
+ * sequence number one window ahead. The drain detects it from its sequence
+ * number and returns it as is, like the single-writer buffer does for
+ * late mbufs, and the owner of that slot gets ENOSPC until it is drained.
+ */
+static inline int
+reorder_insert_mp(struct rte_reorder_buffer *b, struct rte_mbuf *mbuf)
+{
+	struct cir_buffer *order_buf = &b->order_buf;
+	rte_reorder_seqn_t seqn = *rte_reorder_seqn(mbuf);
+	struct rte_mbuf *expected = NULL;
+	uint32_t offset, skip, cur;
+
+	offset = seqn - __atomic_load_n(&b->min_seqn, __ATOMIC_ACQUIRE);
+	if (offset >= order_buf->size) {
+		if (offset >= 2 * order_buf->size) {
+			rte_errno = ERANGE;
+			return -1;
+		}
+		/*
+		 * Let the drain skip the missing entries holding the window,
+		 * as the single-writer insert does when it overflows.
+		 */
+		skip = seqn + 1 - order_buf->size;
+		cur = __atomic_load_n(&b->skip_seqn, __ATOMIC_RELAXED);
+		while ((int32_t)(skip - cur) > 0 &&
+				!__atomic_compare_exchange_n(&b->skip_seqn, &cur,
+					skip, 0, __ATOMIC_RELAXED,
+					__ATOMIC_RELAXED))
+			;
+		rte_errno = ENOSPC;
+		return -1;
+	}
+
+	if (!__atomic_compare_exchange_n(&order_buf->entries[seqn &
+				order_buf->mask], &expected, mbuf, 0,
+				__ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+		/* The slot still holds a late mbuf, not drained yet */
+		rte_errno = ENOSPC;
+		return -1;
+	}
+	return 0;
+}
+
+int
+rte_reorder_insert(struct rte_reorder_buffer *b, struct rte_mbuf *mbuf)
+{
+	if (b == NULL || mbuf == NULL) {
+		rte_errno = EINVAL;
+		return -1;
+	}
+
+	if (b->flags & RTE_REORDER_F_MP_INSERT)
+		return reorder_insert_mp(b, mbuf);
+	return reorder_insert_sp(b, mbuf);
+}
+
+unsigned int
+rte_reorder_insert_bulk(struct rte_reorder_buffer *b,
+		struct rte_mbuf **mbufs, unsigned int n)
+{
+	unsigned int i;
+
+	if (b == NULL || (mbufs == NULL && n != 0)) {
+		rte_errno = EINVAL;
+		return 0;
+	}
+
+	if (b->flags & RTE_REORDER_F_MP_INSERT) {
+		for (i = 0; i < n; i++)
+			if (reorder_insert_mp(b, mbufs[i]) != 0)
+				break;
+	} else {
+		for (i = 0; i < n; i++)
+			if (reorder_insert_sp(b, mbufs[i]) != 0)
+				break;
+	}
+	return i;
+}
+
+static unsigned int
+reorder_drain_mp(struct rte_reorder_buffer *b, struct rte_mbuf **mbufs,
+		unsigned int max_mbufs)
+{
+	struct cir_buffer *order_buf = &b->order_buf;
+	uint32_t min_seqn = b->min_seqn;
+	uint32_t skip = __atomic_load_n(&b->skip_seqn, __ATOMIC_RELAXED);
+	unsigned int drain_cnt = 0;
+	struct rte_mbuf **slot, *m;
+
+	while (drain_cnt < max_mbufs) {
+		slot = &order_buf->entries[min_seqn & order_buf->mask];
+		m = __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+		if (m == NULL) {
+			/* Only skip a missing entry if a producer waits on it */
+			if ((int32_t)(skip - min_seqn) <= 0)
+				break;
+			min_seqn++;
+			continue;
+		}
+		__atomic_store_n(slot, NULL, __ATOMIC_RELAXED);
+		mbufs[drain_cnt++] = m;
+		/* A late mbuf does not move the window */
+		if (*rte_reorder_seqn(m) == min_seqn)
+			min_seqn++;
+	}
+
+	__atomic_store_n(&b->min_seqn, min_seqn, __ATOMIC_RELEASE);
+	return drain_cnt;
+}
+
 unsigned int
 rte_reorder_drain(struct rte_reorder_buffer *b, struct rte_mbuf **mbufs,
 		unsigned max_mbufs)
@@ -389,6 +521,9 @@ rte_reorder_drain(struct rte_reorder_buffer *b, struct rte_mbuf **mbufs,
 	struct cir_buffer *order_buf = &b->order_buf,
 			*ready_buf = &b->ready_buf;
 
+	if (b->flags & RTE_REORDER_F_MP_INSERT)
+		return reorder_drain_mp(b, mbufs, max_mbufs);
+
 	/* Try to fetch requested number of mbufs from ready buffer */
 	while ((drain_cnt < max_mbufs) && (ready_buf->tail != ready_buf->head)) {
 		mbufs[drain_cnt++] = ready_buf->entries[ready_buf->tail];
@@ -66,6 +66,42 @@ rte_reorder_seqn(struct rte_mbuf *mbuf)
 struct rte_reorder_buffer *
 rte_reorder_create(const char *name, unsigned socket_id, unsigned int size);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Create a new multi-producer reorder buffer instance
+ *
+ * Same as rte_reorder_create(), but rte_reorder_insert() and
+ * rte_reorder_insert_bulk() may be called on the returned buffer by several
+ * lcores at once. Each sequence number has a fixed slot in the buffer, so
+ * inserts are lock-free. rte_reorder_drain() must still be called by a
+ * single lcore at a time, which needs not be one of the inserting lcores,
+ * e.g. it can be a service core.
+ *
+ * The first expected sequence number is 0. An mbuf too early to fit in the
+ * window makes the following drains skip the missing mbufs holding the
+ * window, and is rejected with ENOSPC meanwhile, so its insert should be
+ * retried.
+ *
+ * @param name
+ *   The name to be given to the reorder buffer instance.
+ * @param socket_id
+ *   The NUMA node on which the memory for the reorder buffer
+ *   instance is to be reserved.
+ * @param size
+ *   Max number of elements that can be stored in the reorder buffer
+ * @return
+ *   The initialized reorder buffer instance, or NULL on error
+ *   On error case, rte_errno will be set appropriately:
+ *    - ENOMEM - no appropriate memory area found in which to create memzone
+ *    - EINVAL - invalid parameters
+ */
+__rte_experimental
+struct rte_reorder_buffer *
+rte_reorder_create_mp(const char *name, unsigned int socket_id,
+		unsigned int size);
+
 /**
  * Initializes given reorder buffer instance
  *
@@ -146,6 +182,30 @@ rte_reorder_free(struct rte_reorder_buffer *b);
 int
 rte_reorder_insert(struct rte_reorder_buffer *b, struct rte_mbuf *mbuf);
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Insert several mbufs in reorder buffer in their correct positions
+ *
+ * Same as calling rte_reorder_insert() for each mbuf in turn, stopping at
+ * the first mbuf which cannot be inserted.
+ *
+ * @param b
+ *   Reorder buffer where the mbufs have to be inserted.
+ * @param mbufs
+ *   Array of the mbufs to insert.
+ * @param n
+ *   Number of mbufs in the array.
+ * @return
+ *   Number of mbufs inserted, from the start of the array. If less than n,
+ *   rte_errno is set as by rte_reorder_insert() for mbufs[return value].
+ */
+__rte_experimental
+unsigned int
+rte_reorder_insert_bulk(struct rte_reorder_buffer *b,
+		struct rte_mbuf **mbufs, unsigned int n);
+
 /**
  * Fetch reordered buffers
  *
@@ -45,7 +45,8 @@ EAL_REGISTER_TAILQ(rte_ring_tailq)
 /* mask of all valid flag values to ring_create() */
 #define RING_F_MASK (RING_F_SP_ENQ | RING_F_SC_DEQ | RING_F_EXACT_SZ | \
 		     RING_F_MP_RTS_ENQ | RING_F_MC_RTS_DEQ |	       \
-		     RING_F_MP_HTS_ENQ | RING_F_MC_HTS_DEQ)
+		     RING_F_MP_HTS_ENQ | RING_F_MC_HTS_DEQ |	       \
+		     RING_F_MP_STG_ENQ)
 
 /* true if x is a power of 2 */
 #define POWEROF2(x) ((((x)-1) & (x)) == 0)
@@ -104,6 +105,7 @@ reset_headtail(void *p)
 	switch (ht->sync_type) {
 	case RTE_RING_SYNC_MT:
 	case RTE_RING_SYNC_ST:
+	case RTE_RING_SYNC_MT_STG:
 		ht->head = 0;
 		ht->tail = 0;
 		break;
@@ -123,8 +125,15 @@ reset_headtail(void *p)
 void
 rte_ring_reset(struct rte_ring *r)
 {
+	unsigned int i;
+
 	reset_headtail(&r->prod);
 	reset_headtail(&r->cons);
+
+	/* drop the staged objects */
+	if (r->prod.sync_type == RTE_RING_SYNC_MT_STG)
+		for (i = 0; i < RTE_MAX_LCORE; i++)
+			__rte_ring_stg_get(r, i)->len = 0;
 }
 
 /*
@@ -137,7 +146,8 @@ get_sync_type(uint32_t flags, enum rte_ring_sync_type *prod_st,
 	enum rte_ring_sync_type *cons_st)
 {
 	static const uint32_t prod_st_flags =
-		(RING_F_SP_ENQ | RING_F_MP_RTS_ENQ | RING_F_MP_HTS_ENQ);
+		(RING_F_SP_ENQ | RING_F_MP_RTS_ENQ | RING_F_MP_HTS_ENQ |
+		RING_F_MP_STG_ENQ);
 	static const uint32_t cons_st_flags =
 		(RING_F_SC_DEQ | RING_F_MC_RTS_DEQ | RING_F_MC_HTS_DEQ);
 
@@ -154,6 +164,9 @@ get_sync_type(uint32_t flags, enum rte_ring_sync_type *prod_st,
 	case RING_F_MP_HTS_ENQ:
 		*prod_st = RTE_RING_SYNC_MT_HTS;
 		break;
+	case RING_F_MP_STG_ENQ:
+		*prod_st = RTE_RING_SYNC_MT_STG;
+		break;
 	default:
 		return -EINVAL;
 	}
@@ -202,6 +215,13 @@ rte_ring_init(struct rte_ring *r, const char *name, unsigned int count,
 	RTE_BUILD_BUG_ON(offsetof(struct rte_ring_headtail, tail) !=
 		offsetof(struct rte_ring_rts_headtail, tail.val.pos));
 
+	RTE_BUILD_BUG_ON(offsetof(struct rte_ring_headtail, head) !=
+		offsetof(struct rte_ring_stg_headtail, head));
+	RTE_BUILD_BUG_ON(offsetof(struct rte_ring_headtail, tail) !=
+		offsetof(struct rte_ring_stg_headtail, tail));
+	RTE_BUILD_BUG_ON(offsetof(struct rte_ring_headtail, sync_type) !=
+		offsetof(struct rte_ring_stg_headtail, sync_type));
+
 	/* future proof flags, only allow supported values */
 	if (flags & ~RING_F_MASK) {
 		RTE_LOG(ERR, RING,
@@ -209,6 +229,13 @@ rte_ring_init(struct rte_ring *r, const char *name, unsigned int count,
 		return -EINVAL;
 	}
 
+	/* the stages are allocated by rte_ring_create_elem() */
+	if (flags & RING_F_MP_STG_ENQ) {
+		RTE_LOG(ERR, RING,
+			"Staged producer ring must be created with rte_ring_create_elem()\n");
+		return -EINVAL;
+	}
+
 	/* init the ring structure */
 	memset(r, 0, sizeof(*r));
 	ret = strlcpy(r->name, name, sizeof(r->name));
@@ -257,6 +284,8 @@ rte_ring_create_elem(const char *name, unsigned int esize, unsigned int count,
 	int mz_flags = 0;
 	struct rte_ring_list* ring_list = NULL;
 	const unsigned int requested_count = count;
+	uint32_t stg_stride = 0;
+	uint64_t stg_offset = 0;
 	int ret;
 
 	ring_list = RTE_TAILQ_CAST(rte_ring_tailq.head, rte_ring_list);
@@ -271,6 +300,15 @@ rte_ring_create_elem(const char *name, unsigned int esize, unsigned int count,
 		return NULL;
 	}
 
+	/* the stages of all the lcores follow the ring */
+	if (flags & RING_F_MP_STG_ENQ) {
+		stg_offset = ring_size;
+		stg_stride = RTE_CACHE_LINE_ROUNDUP(
+			sizeof(struct __rte_ring_stg) +
+			RTE_RING_STG_SIZE * esize);
+		ring_size += (ssize_t)stg_stride * RTE_MAX_LCORE;
+	}
+
 	ret = snprintf(mz_name, sizeof(mz_name), "%s%s",
 		RTE_RING_MZ_PREFIX, name);
 	if (ret < 0 || ret >= (int)sizeof(mz_name)) {
@@ -296,7 +334,16 @@ rte_ring_create_elem(const char *name, unsigned int esize, unsigned int count,
 		r = mz->addr;
 		/* no need to check return value here, we already checked the
 		 * arguments above */
-		rte_ring_init(r, name, requested_count, flags);
+		rte_ring_init(r, name, requested_count,
+			flags & ~RING_F_MP_STG_ENQ);
+		if (flags & RING_F_MP_STG_ENQ) {
+			r->flags = flags;
+			r->stg_prod.sync_type = RTE_RING_SYNC_MT_STG;
+			r->stg_prod.stg_size = RTE_RING_STG_SIZE;
+			r->stg_prod.stg_stride = stg_stride;
+			r->stg_prod.stg_offset = stg_offset;
+			rte_ring_reset(r);
+		}
 
 		te->data = (void *) r;
 		r->memzone = mz;
@@ -381,6 +428,8 @@ rte_ring_dump(FILE *f, const struct rte_ring *r)
 	fprintf(f, "  ph=%"PRIu32"\n", r->prod.head);
 	fprintf(f, "  used=%u\n", rte_ring_count(r));
 	fprintf(f, "  avail=%u\n", rte_ring_free_count(r));
+	if (r->prod.sync_type == RTE_RING_SYNC_MT_STG)
+		fprintf(f, "  stg_size=%"PRIu32"\n", r->stg_prod.stg_size);
 }
 
 /* dump the status of all rings on the console */
@@ -58,6 +58,7 @@ enum rte_ring_sync_type {
 	RTE_RING_SYNC_ST,     /**< single thread only */
 	RTE_RING_SYNC_MT_RTS, /**< multi-thread relaxed tail sync */
 	RTE_RING_SYNC_MT_HTS, /**< multi-thread head/tail sync */
+	RTE_RING_SYNC_MT_STG, /**< multi-thread with per-lcore staging */
 };
 
 /**
@@ -107,6 +108,27 @@ struct rte_ring_hts_headtail {
 	enum rte_ring_sync_type sync_type;  /**< sync type of prod/cons */
 };
 
+struct rte_ring_stg_headtail {
+	volatile uint32_t head;      /**< prod head. */
+	volatile uint32_t tail;      /**< prod tail. */
+	enum rte_ring_sync_type sync_type;  /**< sync type of prod */
+	uint32_t stg_size;   /**< max number of objects staged per lcore */
+	uint32_t stg_stride; /**< distance in bytes between two lcore stages */
+	uint64_t stg_offset; /**< offset in bytes of the stages in the ring */
+};
+
+/** Number of objects a producer lcore stages before enqueuing them. */
+#define RTE_RING_STG_SIZE 32
+
+/**
+ * @internal Stage of a producer lcore, followed by its objects.
+ * Only accessed by the lcore owning it.
+ */
+struct __rte_ring_stg {
+	uint32_t len; /**< number of objects staged */
+	uint32_t reserved[3];
+};
+
 /**
  * An RTE ring structure.
  *
@@ -135,6 +157,7 @@ struct rte_ring {
 		struct rte_ring_headtail prod;
 		struct rte_ring_hts_headtail hts_prod;
 		struct rte_ring_rts_headtail rts_prod;
+		struct rte_ring_stg_headtail stg_prod;
 	}  __rte_cache_aligned;
 
 	char pad1 __rte_cache_aligned; /**< empty cache line */
@@ -169,6 +192,12 @@ struct rte_ring {
 #define RING_F_MP_HTS_ENQ 0x0020 /**< The default enqueue is "MP HTS". */
 #define RING_F_MC_HTS_DEQ 0x0040 /**< The default dequeue is "MC HTS". */
 
+/**
+ * The default enqueue is "MP staged": each producer lcore gathers its
+ * objects in a private stage and enqueues them RTE_RING_STG_SIZE at a time.
+ */
+#define RING_F_MP_STG_ENQ 0x0080
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,208 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 Intel Corporation
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_log.h>
+#include <rte_malloc.h>
+#include <rte_atomic.h>
+#include <rte_errno.h>
+#include <rte_string_fns.h>
+
+#include "rte_ring.h"
+#include "rte_ring_set.h"
+
+#define RING_SET_WORD_BITS 64
+
+struct ring_set_entry {
+	struct rte_ring *r;
+	uint32_t weight;
+};
+
+struct rte_ring_set {
+	char name[RTE_RING_SET_NAMESIZE];
+	uint32_t esize;
+	uint32_t flags;
+	uint32_t max_rings;
+	uint32_t nb_rings;
+	uint32_t nb_words;
+	/**
+	 * Bit i is set when ring i may hold objects. It is set by the
+	 * producers and cleared by the consumer, on its own cache lines.
+	 */
+	uint64_t *nonempty;
+
+	/** Index of the next ring to visit, only used by the consumer. */
+	uint32_t next __rte_cache_aligned;
+
+	struct ring_set_entry rings[] __rte_cache_aligned;
+};
+
+struct rte_ring_set *
+rte_ring_set_create(const char *name, unsigned int esize,
+		unsigned int max_rings, int socket_id, unsigned int flags)
+{
+	struct rte_ring_set *set;
+	uint32_t nb_words;
+	size_t sz, bitmap_off;
+
+	if (name == NULL || max_rings == 0 || esize == 0 || esize % 4 != 0 ||
+			(flags & ~RTE_RING_SET_F_WEIGHTED) != 0) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	nb_words = RTE_ALIGN_CEIL(max_rings, RING_SET_WORD_BITS) /
+		RING_SET_WORD_BITS;
+	bitmap_off = RTE_CACHE_LINE_ROUNDUP(sizeof(*set) +
+		max_rings * sizeof(set->rings[0]));
+	sz = bitmap_off + RTE_CACHE_LINE_ROUNDUP(nb_words * sizeof(uint64_t));
+
+	set = rte_zmalloc_socket("RING_SET", sz, RTE_CACHE_LINE_SIZE,
+			socket_id);
+	if (set == NULL) {
+		RTE_LOG(ERR, RING, "Cannot reserve memory for ring set %s\n",
+			name);
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
+	strlcpy(set->name, name, sizeof(set->name));
+	set->esize = esize;
+	set->flags = flags;
+	set->max_rings = max_rings;
+	set->nb_words = nb_words;
+	set->nonempty = RTE_PTR_ADD(set, bitmap_off);
+
+	return set;
+}
+
+void
+rte_ring_set_free(struct rte_ring_set *set)
+{
+	rte_free(set);
+}
+
+int
+rte_ring_set_add(struct rte_ring_set *set, struct rte_ring *r,
+		unsigned int weight)
+{
+	uint32_t idx;
+
+	if (set == NULL || r == NULL ||
+			((set->flags & RTE_RING_SET_F_WEIGHTED) && weight == 0))
+		return -EINVAL;
+	if (set->nb_rings == set->max_rings)
+		return -ENOSPC;
+
+	idx = set->nb_rings;
+	set->rings[idx].r = r;
+	set->rings[idx].weight = weight;
+	set->nb_rings++;
+
+	/* the ring may already hold objects */
+	if (!rte_ring_empty(r))
+		__atomic_fetch_or(&set->nonempty[idx / RING_SET_WORD_BITS],
+			UINT64_C(1) << (idx % RING_SET_WORD_BITS),
+			__ATOMIC_RELEASE);
+
+	return idx;
+}
+
+unsigned int
+rte_ring_set_enqueue_burst(struct rte_ring_set *set, unsigned int ring_idx,
+		const void *obj_table, unsigned int n, unsigned int *free_space)
+{
+	uint64_t *word = &set->nonempty[ring_idx / RING_SET_WORD_BITS];
+	const uint64_t bit = UINT64_C(1) << (ring_idx % RING_SET_WORD_BITS);
+	unsigned int enq;
+
+	enq = rte_ring_enqueue_burst_elem(set->rings[ring_idx].r, obj_table,
+			set->esize, n, free_space);
+	if (enq == 0)
+		return 0;
+
+	/*
+	 * Order the ring tail update before the load of the bit, the
+	 * consumer orders the clearing of the bit before its check of the
+	 * ring tail: either the consumer sees the objects, or this producer
+	 * sees the bit cleared. The bit is only written if not already set,
+	 * to keep the bitmap cache line shared while the ring is busy.
+	 */
+	rte_atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if ((__atomic_load_n(word, __ATOMIC_RELAXED) & bit) == 0)
+		__atomic_fetch_or(word, bit, __ATOMIC_RELAXED);
+
+	return enq;
+}
+
+/* Mark an empty ring, unless a producer enqueued objects meanwhile */
+static void
+ring_set_clear(struct rte_ring_set *set, uint32_t idx)
+{
+	uint64_t *word = &set->nonempty[idx / RING_SET_WORD_BITS];
+	const uint64_t bit = UINT64_C(1) << (idx % RING_SET_WORD_BITS);
+
+	__atomic_fetch_and(word, ~bit, __ATOMIC_RELAXED);
+	rte_atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if (!rte_ring_empty(set->rings[idx].r))
+		__atomic_fetch_or(word, bit, __ATOMIC_RELAXED);
+}
+
+unsigned int
+rte_ring_set_dequeue_burst(struct rte_ring_set *set, void *obj_table,
+		unsigned int n)
+{
+	const bool weighted = set->flags & RTE_RING_SET_F_WEIGHTED;
+	const uint32_t nb_words = set->nb_words;
+	uint32_t start, w, k, idx, quota, avail, visited;
+	unsigned int total = 0;
+	uint64_t bits;
+
+	do {
+		visited = 0;
+		start = set->next;
+
+		/*
+		 * Scan the bitmap once from the next ring, the first word
+		 * being visited twice: its upper bits first, its lower bits
+		 * last.
+		 */
+		for (k = 0; k <= nb_words && total != n; k++) {
+			w = (start / RING_SET_WORD_BITS + k) % nb_words;
+			bits = __atomic_load_n(&set->nonempty[w],
+					__ATOMIC_ACQUIRE);
+			if (k == 0)
+				bits &= UINT64_MAX <<
+					(start % RING_SET_WORD_BITS);
+			else if (k == nb_words)
+				bits &= ~(UINT64_MAX <<
+					(start % RING_SET_WORD_BITS));
+
+			while (bits != 0 && total != n) {
+				idx = w * RING_SET_WORD_BITS + rte_bsf64(bits);
+				bits &= bits - 1;
+				visited++;
+
+				quota = n - total;
+				if (weighted)
+					quota = RTE_MIN(quota,
+						set->rings[idx].weight);
+				total += rte_ring_dequeue_burst_elem(
+					set->rings[idx].r,
+					RTE_PTR_ADD(obj_table,
+						(size_t)total * set->esize),
+					set->esize, quota, &avail);
+				if (avail == 0)
+					ring_set_clear(set, idx);
+				set->next = idx + 1;
+			}
+		}
+	} while (weighted && visited != 0 && total != n);
+
+	return total;
+}
@@ -0,0 +1,162 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2022 Intel Corporation
+ */
+
+#ifndef _RTE_RING_SET_H_
+#define _RTE_RING_SET_H_
+
+/**
+ * @file
+ * RTE Ring Set
+ *
+ * A ring set groups the rings feeding one consumer, typically one SPSC
+ * ring per upstream lcore. The producers enqueue through the set, which
+ * keeps a bitmap of the rings holding objects, so that the consumer
+ * dequeues from the non-empty rings only, with one call, instead of
+ * polling every ring.
+ *
+ * The rings are visited in round-robin order. By default each ring
+ * visited gives as many objects as requested by the consumer, the next
+ * call starting from the following ring. With RTE_RING_SET_F_WEIGHTED,
+ * each ring visited gives at most its weight in objects and the rings
+ * are visited in turn until the request is fulfilled.
+ *
+ * Only one thread at a time may dequeue from a set. Any number of
+ * producers may enqueue, within the limits of the sync modes of the rings.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <rte_compat.h>
+#include <rte_ring.h>
+
+/** Max length of a ring set name. */
+#define RTE_RING_SET_NAMESIZE 32
+
+/** Rings are dequeued in weighted round-robin order. */
+#define RTE_RING_SET_F_WEIGHTED 0x0001
+
+struct rte_ring_set;
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Create an empty ring set.
+ *
+ * @param name
+ *   The name of the ring set.
+ * @param esize
+ *   The size of the ring elements, in bytes. It must be a multiple of 4,
+ *   sizeof(void *) for the rings created with rte_ring_create().
+ * @param max_rings
+ *   The maximum number of rings in the set.
+ * @param socket_id
+ *   The socket identifier in the case of NUMA. The value can be
+ *   *SOCKET_ID_ANY* if there is no NUMA constraint for the reserved zone.
+ * @param flags
+ *   0 or RTE_RING_SET_F_WEIGHTED.
+ * @return
+ *   On success, the pointer to the new ring set. NULL on error with
+ *   rte_errno set appropriately. Possible errno values include:
+ *    - EINVAL - invalid parameter
+ *    - ENOMEM - no appropriate memory area found in which to create memzone
+ */
+__rte_experimental
+struct rte_ring_set *
+rte_ring_set_create(const char *name, unsigned int esize,
+		unsigned int max_rings, int socket_id, unsigned int flags);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Free a ring set. The rings of the set are not freed.
+ *
+ * @param set
+ *   The ring set to free. If NULL then, the function does nothing.
+ */
+__rte_experimental
+void
+rte_ring_set_free(struct rte_ring_set *set);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Add a ring to a set. The ring elements must be of the size given at
+ * the set creation, and the objects must only be enqueued on the ring
+ * with rte_ring_set_enqueue_burst() once it is added.
+ * This function is not multi-thread safe, the rings should be added
+ * before the producers and the consumer start.
+ *
+ * @param set
+ *   The ring set.
+ * @param r
+ *   The ring to add.
+ * @param weight
+ *   The number of objects dequeued from the ring per visit, ignored
+ *   unless the set was created with RTE_RING_SET_F_WEIGHTED.
+ * @return
+ *   - The index of the ring in the set, to use for enqueuing.
+ *   - -EINVAL: invalid parameter.
+ *   - -ENOSPC: the set already has max_rings rings.
+ */
+__rte_experimental
+int
+rte_ring_set_add(struct rte_ring_set *set, struct rte_ring *r,
+		unsigned int weight);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Enqueue several objects on a ring of the set and mark it non-empty.
+ *
+ * @param set
+ *   The ring set.
+ * @param ring_idx
+ *   The index of the ring, as returned by rte_ring_set_add().
+ * @param obj_table
+ *   A pointer to a table of objects.
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @param free_space
+ *   if non-NULL, returns the amount of space in the ring after the
+ *   enqueue operation has finished.
+ * @return
+ *   - n: Actual number of objects enqueued.
+ */
+__rte_experimental
+unsigned int
+rte_ring_set_enqueue_burst(struct rte_ring_set *set, unsigned int ring_idx,
+		const void *obj_table, unsigned int n, unsigned int *free_space);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Dequeue up to n objects from the non-empty rings of the set,
+ * in round-robin or weighted round-robin order.
+ *
+ * @param set
+ *   The ring set.
+ * @param obj_table
+ *   A pointer to a table of objects that will be filled.
+ * @param n
+ *   The number of objects to dequeue from the rings to the obj_table.
+ * @return
+ *   - Number of objects dequeued
+ */
+__rte_experimental
+unsigned int
+rte_ring_set_dequeue_burst(struct rte_ring_set *set, void *obj_table,
+		unsigned int n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_RING_SET_H_ */
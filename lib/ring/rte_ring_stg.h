@@ -0,0 +1,206 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2022 Intel Corporation
+ */
+
+#ifndef _RTE_RING_STG_H_
+#define _RTE_RING_STG_H_
+
+/**
+ * @file rte_ring_stg.h
+ * It is not recommended to include this file directly.
+ * Please include <rte_ring.h> instead.
+ *
+ * Contains functions for the staged producer ring mode.
+ * In that mode each producer lcore copies the objects it enqueues to a
+ * private stage of RTE_RING_STG_SIZE objects, and only moves the producer
+ * head once the stage fills up, for all the staged objects at once.
+ * With many producers this divides the contention on the producer head
+ * by the stage size, at the cost of latency: the staged objects are not
+ * visible to the consumers until the stage is flushed, when it fills up or
+ * explicitly with rte_ring_stg_flush_elem().
+ * The producer head and tail are updated as for RTE_RING_SYNC_MT, the
+ * consumer side can use any sync mode.
+ * Rings in that mode must be created with rte_ring_create() or
+ * rte_ring_create_elem(), which allocate the stages of all the lcores
+ * along with the ring. Non-EAL threads enqueue without staging.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <rte_compat.h>
+#include <rte_ring_stg_elem_pvt.h>
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Enqueue several objects on the staged producer ring
+ * (multi-producers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of objects.
+ * @param esize
+ *   The size of ring element, in bytes. It must be a multiple of 4.
+ *   This must be the same value used while creating the ring. Otherwise
+ *   the results are undefined.
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @param free_space
+ *   if non-NULL, returns the amount of space in the ring after the
+ *   enqueue operation has finished.
+ * @return
+ *   The number of objects enqueued or staged, either 0 or n
+ */
+__rte_experimental
+static __rte_always_inline unsigned int
+rte_ring_mp_stg_enqueue_bulk_elem(struct rte_ring *r, const void *obj_table,
+	unsigned int esize, unsigned int n, unsigned int *free_space)
+{
+	return __rte_ring_do_stg_enqueue_elem(r, obj_table, esize, n,
+			RTE_RING_QUEUE_FIXED, free_space);
+}
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Enqueue several objects on the staged producer ring
+ * (multi-producers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of objects.
+ * @param esize
+ *   The size of ring element, in bytes. It must be a multiple of 4.
+ *   This must be the same value used while creating the ring. Otherwise
+ *   the results are undefined.
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @param free_space
+ *   if non-NULL, returns the amount of space in the ring after the
+ *   enqueue operation has finished.
+ * @return
+ *   - n: Actual number of objects enqueued or staged.
+ */
+__rte_experimental
+static __rte_always_inline unsigned int
+rte_ring_mp_stg_enqueue_burst_elem(struct rte_ring *r, const void *obj_table,
+	unsigned int esize, unsigned int n, unsigned int *free_space)
+{
+	return __rte_ring_do_stg_enqueue_elem(r, obj_table, esize, n,
+			RTE_RING_QUEUE_VARIABLE, free_space);
+}
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Enqueue the objects staged by the calling lcore, so that they become
+ * visible to the consumers. A producer must flush its stage before it
+ * stops enqueuing objects, or they could stay staged forever.
+ * It does nothing for the rings not in staged producer mode.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param esize
+ *   The size of ring element, in bytes. It must be a multiple of 4.
+ *   This must be the same value used while creating the ring. Otherwise
+ *   the results are undefined.
+ * @return
+ *   The number of objects still staged, non-zero only if the ring is full.
+ */
+__rte_experimental
+static __rte_always_inline unsigned int
+rte_ring_stg_flush_elem(struct rte_ring *r, unsigned int esize)
+{
+	return __rte_ring_do_stg_flush_elem(r, esize);
+}
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Enqueue several objects on the staged producer ring
+ * (multi-producers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @param free_space
+ *   if non-NULL, returns the amount of space in the ring after the
+ *   enqueue operation has finished.
+ * @return
+ *   The number of objects enqueued or staged, either 0 or n
+ */
+__rte_experimental
+static __rte_always_inline unsigned int
+rte_ring_mp_stg_enqueue_bulk(struct rte_ring *r, void * const *obj_table,
+			 unsigned int n, unsigned int *free_space)
+{
+	return __rte_ring_do_stg_enqueue_elem(r, obj_table,
+			sizeof(uintptr_t), n, RTE_RING_QUEUE_FIXED,
+			free_space);
+}
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Enqueue several objects on the staged producer ring
+ * (multi-producers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @param free_space
+ *   if non-NULL, returns the amount of space in the ring after the
+ *   enqueue operation has finished.
+ * @return
+ *   - n: Actual number of objects enqueued or staged.
+ */
+__rte_experimental
+static __rte_always_inline unsigned int
+rte_ring_mp_stg_enqueue_burst(struct rte_ring *r, void * const *obj_table,
+			 unsigned int n, unsigned int *free_space)
+{
+	return __rte_ring_do_stg_enqueue_elem(r, obj_table,
+			sizeof(uintptr_t), n, RTE_RING_QUEUE_VARIABLE,
+			free_space);
+}
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Enqueue the objects staged by the calling lcore on a ring of pointers,
+ * see rte_ring_stg_flush_elem().
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @return
+ *   The number of objects still staged, non-zero only if the ring is full.
+ */
+__rte_experimental
+static __rte_always_inline unsigned int
+rte_ring_stg_flush(struct rte_ring *r)
+{
+	return __rte_ring_do_stg_flush_elem(r, sizeof(uintptr_t));
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_RING_STG_H_ */
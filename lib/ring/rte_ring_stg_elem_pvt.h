@@ -0,0 +1,186 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ *
+ * Copyright (c) 2022 Intel Corporation
+ */
+
+#ifndef _RTE_RING_STG_ELEM_PVT_H_
+#define _RTE_RING_STG_ELEM_PVT_H_
+
+/**
+ * @file rte_ring_stg_elem_pvt.h
+ * It is not recommended to include this file directly,
+ * include <rte_ring.h> instead.
+ * Contains internal helper functions for the staged producer ring mode.
+ * For more information please refer to <rte_ring_stg.h>.
+ */
+
+/**
+ * @internal Get the stage of a producer lcore.
+ */
+static __rte_always_inline struct __rte_ring_stg *
+__rte_ring_stg_get(const struct rte_ring *r, unsigned int lcore_id)
+{
+	return (struct __rte_ring_stg *)((uintptr_t)r +
+		r->stg_prod.stg_offset +
+		(size_t)lcore_id * r->stg_prod.stg_stride);
+}
+
+/**
+ * @internal Get the address of the n-th object of a stage.
+ */
+static __rte_always_inline void *
+__rte_ring_stg_obj(struct __rte_ring_stg *stg, uint32_t esize, uint32_t n)
+{
+	return (uint8_t *)(stg + 1) + (size_t)n * esize;
+}
+
+/**
+ * @internal Enqueue the staged objects followed by the objects of
+ * obj_table, reserving room for all of them with one head update.
+ * Objects are enqueued in order: up to n objects of obj_table are only
+ * enqueued once the stage is empty.
+ *
+ * @return
+ *   The number of objects of obj_table enqueued.
+ *   If behavior == RTE_RING_QUEUE_FIXED, nothing is enqueued unless all
+ *   the staged objects and the n objects of obj_table fit in the ring.
+ */
+static __rte_always_inline unsigned int
+__rte_ring_stg_flush_elem(struct rte_ring *r, struct __rte_ring_stg *stg,
+	const void *obj_table, uint32_t esize, uint32_t n,
+	enum rte_ring_queue_behavior behavior, uint32_t *free_space)
+{
+	uint32_t head, next, free, m, s, k;
+
+	m = __rte_ring_move_prod_head(r, 0, stg->len + n, behavior,
+			&head, &next, &free);
+	s = RTE_MIN(m, stg->len);
+	/* m - s <= n, spelled out for the compiler bounds checks */
+	k = RTE_MIN(m - s, n);
+
+	if (m != 0) {
+		if (s != 0)
+			__rte_ring_enqueue_elems(r, head,
+				__rte_ring_stg_obj(stg, esize, 0), esize, s);
+		if (k != 0)
+			__rte_ring_enqueue_elems(r, head + s, obj_table,
+				esize, k);
+		__rte_ring_update_tail(&r->prod, head, next, 0, 1);
+	}
+
+	/* Keep the objects which did not fit at the start of the stage */
+	if (s != 0 && s < stg->len)
+		memmove(__rte_ring_stg_obj(stg, esize, 0),
+			__rte_ring_stg_obj(stg, esize, s),
+			(size_t)(stg->len - s) * esize);
+	stg->len -= s;
+
+	if (free_space != NULL)
+		*free_space = free - m;
+	return k;
+}
+
+/**
+ * @internal Enqueue several objects on the staged producer ring.
+ * The objects are copied to the stage of the calling lcore and only
+ * enqueued, along with the objects staged before, once the stage fills
+ * up. The calls from non-EAL threads enqueue the objects directly.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of objects.
+ * @param esize
+ *   The size of ring element, in bytes. It must be a multiple of 4.
+ *   This must be the same value used while creating the ring. Otherwise
+ *   the results are undefined.
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @param behavior
+ *   RTE_RING_QUEUE_FIXED:    Enqueue a fixed number of items from a ring
+ *   RTE_RING_QUEUE_VARIABLE: Enqueue as many items as possible from ring
+ * @param free_space
+ *   returns the amount of space after the enqueue operation has finished
+ * @return
+ *   Actual number of objects enqueued or staged.
+ *   If behavior == RTE_RING_QUEUE_FIXED, this will be 0 or n only.
+ */
+static __rte_always_inline unsigned int
+__rte_ring_do_stg_enqueue_elem(struct rte_ring *r, const void *obj_table,
+	uint32_t esize, uint32_t n, enum rte_ring_queue_behavior behavior,
+	uint32_t *free_space)
+{
+	struct __rte_ring_stg *stg;
+	uint32_t lcore_id, enq, room;
+
+	lcore_id = rte_lcore_id();
+	if (unlikely(lcore_id >= RTE_MAX_LCORE))
+		return __rte_ring_do_enqueue_elem(r, obj_table, esize, n,
+				behavior, RTE_RING_SYNC_MT, free_space);
+
+	stg = __rte_ring_stg_get(r, lcore_id);
+
+	/* Stage the objects as long as the stage does not fill up */
+	if (stg->len + n < r->stg_prod.stg_size) {
+		memcpy(__rte_ring_stg_obj(stg, esize, stg->len), obj_table,
+			(size_t)n * esize);
+		stg->len += n;
+		if (free_space != NULL)
+			*free_space = r->capacity + r->cons.tail -
+				r->prod.head;
+		return n;
+	}
+
+	/* Flush the stage and the new objects with one head update */
+	enq = __rte_ring_stg_flush_elem(r, stg, obj_table, esize, n,
+			behavior, free_space);
+	if (enq == n)
+		return n;
+
+	/* The ring is full, flush what fits and stage the rest if possible */
+	if (behavior == RTE_RING_QUEUE_FIXED && stg->len != 0)
+		__rte_ring_stg_flush_elem(r, stg, NULL, esize, 0,
+			RTE_RING_QUEUE_VARIABLE, free_space);
+
+	room = r->stg_prod.stg_size - stg->len;
+	if (n - enq > room) {
+		if (behavior == RTE_RING_QUEUE_FIXED)
+			return 0;
+		n = enq + room;
+	}
+
+	memcpy(__rte_ring_stg_obj(stg, esize, stg->len),
+		(const uint8_t *)obj_table + (size_t)enq * esize,
+		(size_t)(n - enq) * esize);
+	stg->len += n - enq;
+	return n;
+}
+
+/**
+ * @internal Enqueue the objects staged by the calling lcore.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param esize
+ *   The size of ring element, in bytes.
+ * @return
+ *   The number of objects still staged, non-zero only if the ring is full.
+ */
+static __rte_always_inline unsigned int
+__rte_ring_do_stg_flush_elem(struct rte_ring *r, uint32_t esize)
+{
+	struct __rte_ring_stg *stg;
+	uint32_t lcore_id = rte_lcore_id();
+
+	if (r->prod.sync_type != RTE_RING_SYNC_MT_STG ||
+			lcore_id >= RTE_MAX_LCORE)
+		return 0;
+
+	stg = __rte_ring_stg_get(r, lcore_id);
+	if (stg->len != 0)
+		__rte_ring_stg_flush_elem(r, stg, NULL, esize, 0,
+			RTE_RING_QUEUE_VARIABLE, NULL);
+	return stg->len;
+}
+
+#endif /* _RTE_RING_STG_ELEM_PVT_H_ */
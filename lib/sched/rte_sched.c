@@ -186,6 +186,11 @@ struct rte_sched_subport {
 
 	/* Pipe queues size */
 	uint16_t qsize[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint16_t pipe_qsize[RTE_SCHED_QUEUES_PER_PIPE];
+	uint32_t n_be_queues;
+
+	/* Dequeue worker owning the subport, NULL if none */
+	struct rte_sched_port_worker *worker;
 
 #ifdef RTE_SCHED_CMAN
 	bool cman_enabled;
@@ -238,7 +243,16 @@ struct rte_sched_port {
 	uint32_t frame_overhead;
 	int socket;
 
-	/* Timing */
+	/*
+	 * Timing. Without dequeue workers, the port timing is owned by the
+	 * lcore running the port. A worker view owns its own timing, and
+	 * once a port has workers, they share the timing of the port:
+	 * - time is advanced by the workers with a compare and swap, and
+	 *   read with atomic loads by the enqueue and configuration paths;
+	 * - time_cpu_cycles is advanced by the workers, to the latest of
+	 *   their CPU times, for the congestion management on enqueue;
+	 * - time_cpu_bytes is not used until the last worker is freed.
+	 */
 	uint64_t time_cpu_cycles;     /* Current CPU time measured in CPU cycles */
 	uint64_t time_cpu_bytes;      /* Current CPU time measured in bytes */
 	uint64_t time;                /* Current NIC TX time measured in bytes */
@@ -250,11 +264,28 @@ struct rte_sched_port {
 	uint32_t n_pkts_out;
 	uint32_t subport_id;
 
+	/* Dequeue workers */
+	struct rte_sched_port *parent; /* Port a worker view belongs to */
+	uint32_t n_workers;
+
 	/* Large data structures */
 	struct rte_sched_subport_profile *subport_profiles;
 	struct rte_sched_subport *subports[0] __rte_cache_aligned;
 } __rte_cache_aligned;
 
+/*
+ * A dequeue worker runs the grinders of its subports on a private view
+ * of the port: a copy of the port restricted to the worker subports,
+ * with its own timing and output state, synchronized with the time of
+ * the parent port by the arbiter.
+ */
+struct rte_sched_port_worker {
+	struct rte_sched_port *port;
+	uint32_t subport_first;
+	uint32_t n_subports;
+	struct rte_sched_port *view;
+};
+
 enum rte_sched_subport_array {
 	e_RTE_SCHED_SUBPORT_ARRAY_PIPE = 0,
 	e_RTE_SCHED_SUBPORT_ARRAY_QUEUE,
@@ -282,12 +313,10 @@ rte_sched_subport_pipe_qbase(struct rte_sched_subport *subport, uint32_t qindex)
 }
 
 static inline uint16_t
-rte_sched_subport_pipe_qsize(struct rte_sched_port *port,
+rte_sched_subport_pipe_qsize(struct rte_sched_port *port __rte_unused,
 struct rte_sched_subport *subport, uint32_t qindex)
 {
-	uint32_t tc = port->pipe_tc[qindex & (RTE_SCHED_QUEUES_PER_PIPE - 1)];
-
-	return subport->qsize[tc];
+	return subport->pipe_qsize[qindex & (RTE_SCHED_QUEUES_PER_PIPE - 1)];
 }
 
 static inline uint32_t
@@ -327,7 +356,7 @@ rte_sched_port_tc_queue(struct rte_sched_port *port, uint32_t qindex)
 
 static int
 pipe_profile_check(struct rte_sched_pipe_params *params,
-	uint64_t rate, uint16_t *qsize)
+	uint64_t rate, uint16_t *qsize, uint32_t n_be_queues)
 {
 	uint32_t i;
 
@@ -385,8 +414,8 @@ pipe_profile_check(struct rte_sched_pipe_params *params,
 		return -EINVAL;
 	}
 
-	/* Queue WRR weights: non-zero */
-	for (i = 0; i < RTE_SCHED_BE_QUEUES_PER_PIPE; i++) {
+	/* Queue WRR weights: non-zero for the enabled queues */
+	for (i = 0; i < n_be_queues; i++) {
 		if (params->wrr_weights[i] == 0) {
 			RTE_LOG(ERR, SCHED,
 				"%s: Incorrect value for wrr weight\n", __func__);
@@ -522,6 +551,15 @@ rte_sched_port_check_params(struct rte_sched_port_params *params)
 	return 0;
 }
 
+static inline uint32_t
+rte_sched_subport_be_queues(struct rte_sched_subport_params *params)
+{
+	if (params->n_be_queues == 0)
+		return RTE_SCHED_BE_QUEUES_PER_PIPE;
+
+	return params->n_be_queues;
+}
+
 static uint32_t
 rte_sched_subport_get_array_base(struct rte_sched_subport_params *params,
 	enum rte_sched_subport_array array)
@@ -549,7 +587,8 @@ rte_sched_subport_get_array_base(struct rte_sched_subport_params *params,
 			size_per_pipe_queue_array +=
 				params->qsize[i] * sizeof(struct rte_mbuf *);
 		else
-			size_per_pipe_queue_array += RTE_SCHED_MAX_QUEUES_PER_TC *
+			size_per_pipe_queue_array +=
+				rte_sched_subport_be_queues(params) *
 				params->qsize[i] * sizeof(struct rte_mbuf *);
 	}
 	size_queue_array = n_pipes_per_subport * size_per_pipe_queue_array;
@@ -591,22 +630,25 @@ rte_sched_subport_config_qsize(struct rte_sched_subport *subport)
 	subport->qsize_add[0] = 0;
 
 	/* Strict priority traffic class */
+	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASS_BE; i++)
+		subport->pipe_qsize[i] = subport->qsize[i];
+
 	for (i = 1; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++)
 		subport->qsize_add[i] = subport->qsize_add[i-1] + subport->qsize[i-1];
 
-	/* Best-effort traffic class */
-	subport->qsize_add[RTE_SCHED_TRAFFIC_CLASS_BE + 1] =
-		subport->qsize_add[RTE_SCHED_TRAFFIC_CLASS_BE] +
-		subport->qsize[RTE_SCHED_TRAFFIC_CLASS_BE];
-	subport->qsize_add[RTE_SCHED_TRAFFIC_CLASS_BE + 2] =
-		subport->qsize_add[RTE_SCHED_TRAFFIC_CLASS_BE + 1] +
-		subport->qsize[RTE_SCHED_TRAFFIC_CLASS_BE];
-	subport->qsize_add[RTE_SCHED_TRAFFIC_CLASS_BE + 3] =
-		subport->qsize_add[RTE_SCHED_TRAFFIC_CLASS_BE + 2] +
-		subport->qsize[RTE_SCHED_TRAFFIC_CLASS_BE];
+	/* Best-effort traffic class, disabled queues take no room */
+	for (i = 0; i < RTE_SCHED_BE_QUEUES_PER_PIPE; i++)
+		subport->pipe_qsize[RTE_SCHED_TRAFFIC_CLASS_BE + i] =
+			(i < subport->n_be_queues) ?
+			subport->qsize[RTE_SCHED_TRAFFIC_CLASS_BE] : 0;
 
-	subport->qsize_sum = subport->qsize_add[RTE_SCHED_TRAFFIC_CLASS_BE + 3] +
-		subport->qsize[RTE_SCHED_TRAFFIC_CLASS_BE];
+	for (i = 1; i < RTE_SCHED_BE_QUEUES_PER_PIPE; i++)
+		subport->qsize_add[RTE_SCHED_TRAFFIC_CLASS_BE + i] =
+			subport->qsize_add[RTE_SCHED_TRAFFIC_CLASS_BE + i - 1] +
+			subport->pipe_qsize[RTE_SCHED_TRAFFIC_CLASS_BE + i - 1];
+
+	subport->qsize_sum = subport->qsize_add[RTE_SCHED_QUEUES_PER_PIPE - 1] +
+		subport->pipe_qsize[RTE_SCHED_QUEUES_PER_PIPE - 1];
 }
 
 static void
@@ -735,11 +777,10 @@ rte_sched_pipe_profile_convert(struct rte_sched_subport *subport,
 
 	dst->tc_ov_weight = src->tc_ov_weight;
 
-	/* WRR queues */
-	wrr_cost[0] = src->wrr_weights[0];
-	wrr_cost[1] = src->wrr_weights[1];
-	wrr_cost[2] = src->wrr_weights[2];
-	wrr_cost[3] = src->wrr_weights[3];
+	/* WRR queues, the disabled queues reuse the weight of queue 0 */
+	for (i = 0; i < RTE_SCHED_BE_QUEUES_PER_PIPE; i++)
+		wrr_cost[i] = (i < subport->n_be_queues) ?
+			src->wrr_weights[i] : src->wrr_weights[0];
 
 	lcd1 = rte_get_lcd(wrr_cost[0], wrr_cost[1]);
 	lcd2 = rte_get_lcd(wrr_cost[2], wrr_cost[3]);
@@ -861,6 +902,15 @@ rte_sched_subport_check_params(struct rte_sched_subport_params *params,
 		return -EINVAL;
 	}
 
+	/* n_be_queues: zero (default), or power of 2 up to the maximum */
+	if (params->n_be_queues > RTE_SCHED_BE_QUEUES_PER_PIPE ||
+		(params->n_be_queues != 0 &&
+		!rte_is_power_of_2(params->n_be_queues))) {
+		RTE_LOG(ERR, SCHED,
+			"%s: Incorrect value for be queues number\n", __func__);
+		return -EINVAL;
+	}
+
 	/* n_pipes_per_subport: non-zero, power of 2 */
 	if (params->n_pipes_per_subport_enabled == 0 ||
 		params->n_pipes_per_subport_enabled > n_max_pipes_per_subport ||
@@ -884,7 +934,8 @@ rte_sched_subport_check_params(struct rte_sched_subport_params *params,
 		struct rte_sched_pipe_params *p = params->pipe_profiles + i;
 		int status;
 
-		status = pipe_profile_check(p, rate, &params->qsize[0]);
+		status = pipe_profile_check(p, rate, &params->qsize[0],
+			rte_sched_subport_be_queues(params));
 		if (status != 0) {
 			RTE_LOG(ERR, SCHED,
 				"%s: Pipe profile check failed(%d)\n", __func__, status);
@@ -1248,7 +1299,7 @@ rte_sched_subport_config(struct rte_sched_port *port,
 		/* Port */
 		port->subports[subport_id] = s;
 
-		s->tb_time = port->time;
+		s->tb_time = __atomic_load_n(&port->time, __ATOMIC_RELAXED);
 
 		/* compile time checks */
 		RTE_BUILD_BUG_ON(RTE_SCHED_PORT_N_GRINDERS == 0);
@@ -1259,6 +1310,7 @@ rte_sched_subport_config(struct rte_sched_port *port,
 		s->n_pipes_per_subport_enabled =
 				params->n_pipes_per_subport_enabled;
 		memcpy(s->qsize, params->qsize, sizeof(params->qsize));
+		s->n_be_queues = rte_sched_subport_be_queues(params);
 		s->n_pipe_profiles = params->n_pipe_profiles;
 		s->n_max_pipe_profiles = params->n_max_pipe_profiles;
 
@@ -1343,7 +1395,8 @@ rte_sched_subport_config(struct rte_sched_port *port,
 
 		s->tb_credits = profile->tb_size / 2;
 
-		s->tc_time = port->time + profile->tc_period;
+		s->tc_time = __atomic_load_n(&port->time, __ATOMIC_RELAXED) +
+			profile->tc_period;
 
 		for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++)
 			if (s->qsize[i])
@@ -1454,11 +1507,11 @@ rte_sched_pipe_config(struct rte_sched_port *port,
 	params = s->pipe_profiles + p->profile;
 
 	/* Token Bucket (TB) */
-	p->tb_time = port->time;
+	p->tb_time = __atomic_load_n(&port->time, __ATOMIC_RELAXED);
 	p->tb_credits = params->tb_size / 2;
 
 	/* Traffic Classes (TCs) */
-	p->tc_time = port->time + params->tc_period;
+	p->tc_time = p->tb_time + params->tc_period;
 
 	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++)
 		if (s->qsize[i])
@@ -1530,7 +1583,8 @@ rte_sched_subport_pipe_profile_add(struct rte_sched_port *port,
 	}
 
 	/* Pipe params */
-	status = pipe_profile_check(params, port->rate, &s->qsize[0]);
+	status = pipe_profile_check(params, port->rate, &s->qsize[0],
+		s->n_be_queues);
 	if (status != 0) {
 		RTE_LOG(ERR, SCHED,
 			"%s: Pipe profile check failed(%d)\n", __func__, status);
@@ -1637,7 +1691,8 @@ rte_sched_port_qindex(struct rte_sched_port *port,
 		(port->n_pipes_per_subport_log2 + 4)) |
 		((pipe &
 		(port->subports[subport]->n_pipes_per_subport_enabled - 1)) << 4) |
-		((rte_sched_port_pipe_queue(port, traffic_class) + queue) &
+		((rte_sched_port_pipe_queue(port, traffic_class) +
+		(queue & (port->subports[subport]->n_be_queues - 1))) &
 		(RTE_SCHED_QUEUES_PER_PIPE - 1));
 }
 
@@ -1879,14 +1934,16 @@ rte_sched_port_cman_drop(struct rte_sched_port *port,
 
 		red = &qe->red;
 
-		return rte_red_enqueue(red_cfg, red, qlen, port->time);
+		return rte_red_enqueue(red_cfg, red, qlen,
+			__atomic_load_n(&port->time, __ATOMIC_RELAXED));
 	}
 
 	/* PIE */
 	struct rte_pie_config *pie_cfg = &subport->pie_config[tc_index];
 	struct rte_pie *pie = &qe->pie;
 
-	return rte_pie_enqueue(pie_cfg, pie, qlen, pkt->pkt_len, port->time_cpu_cycles);
+	return rte_pie_enqueue(pie_cfg, pie, qlen, pkt->pkt_len,
+		__atomic_load_n(&port->time_cpu_cycles, __ATOMIC_RELAXED));
 }
 
 static inline void
@@ -2993,6 +3050,51 @@ grinder_handle(struct rte_sched_port *port,
 	}
 }
 
+/*
+ * The arbiter keeps the time of the parent port as the transmission
+ * time shared by all the workers: each worker starts a dequeue burst
+ * from the shared time and adds the bytes it sent to it at the end of
+ * the burst. The time of a view is private to the lcore of its worker,
+ * only the timing of the parent is accessed atomically.
+ */
+static inline void
+rte_sched_port_arbiter_sync(struct rte_sched_port *port)
+{
+	struct rte_sched_port *parent = port->parent;
+	uint64_t time = __atomic_load_n(&parent->time, __ATOMIC_RELAXED);
+	uint64_t cycles;
+
+	if (port->time < time)
+		port->time = time;
+
+	/*
+	 * CPU time used by the congestion management on enqueue, only
+	 * moved forward so that a late worker does not take it back.
+	 */
+	cycles = __atomic_load_n(&parent->time_cpu_cycles, __ATOMIC_RELAXED);
+	while (cycles < port->time_cpu_cycles) {
+		if (__atomic_compare_exchange_n(&parent->time_cpu_cycles,
+				&cycles, port->time_cpu_cycles, 0,
+				__ATOMIC_RELAXED, __ATOMIC_RELAXED))
+			break;
+	}
+}
+
+static inline void
+rte_sched_port_arbiter_publish(struct rte_sched_port *port,
+	uint64_t time_start)
+{
+	struct rte_sched_port *parent = port->parent;
+	uint64_t sent = port->time - time_start;
+	uint64_t time, next;
+
+	time = __atomic_load_n(&parent->time, __ATOMIC_RELAXED);
+	do {
+		next = RTE_MAX(time, time_start) + sent;
+	} while (!__atomic_compare_exchange_n(&parent->time, &time, next, 0,
+			__ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+
 static inline void
 rte_sched_port_time_resync(struct rte_sched_port *port)
 {
@@ -3016,6 +3118,10 @@ rte_sched_port_time_resync(struct rte_sched_port *port)
 	if (port->time < port->time_cpu_bytes)
 		port->time = port->time_cpu_bytes;
 
+	/* Catch up with the bytes sent by the other workers of the port */
+	if (port->parent != NULL)
+		rte_sched_port_arbiter_sync(port);
+
 	/* Reset pipe loop detection */
 	for (i = 0; i < port->n_subports_per_port; i++)
 		port->subports[i]->pipe_loop = RTE_SCHED_PIPE_INVALID;
@@ -3042,11 +3148,13 @@ rte_sched_port_dequeue(struct rte_sched_port *port, struct rte_mbuf **pkts, uint
 	struct rte_sched_subport *subport;
 	uint32_t subport_id = port->subport_id;
 	uint32_t i, n_subports = 0, count;
+	uint64_t time_start;
 
 	port->pkts_out = pkts;
 	port->n_pkts_out = 0;
 
 	rte_sched_port_time_resync(port);
+	time_start = port->time;
 
 	/* Take each queue in the grinder one step further */
 	for (i = 0, count = 0; ; i++)  {
@@ -3080,5 +3188,116 @@ rte_sched_port_dequeue(struct rte_sched_port *port, struct rte_mbuf **pkts, uint
 		}
 	}
 
+	if (port->parent != NULL)
+		rte_sched_port_arbiter_publish(port, time_start);
+
 	return count;
 }
+
+struct rte_sched_port_worker *
+rte_sched_port_worker_create(struct rte_sched_port *port,
+	uint32_t subport_first,
+	uint32_t n_subports)
+{
+	struct rte_sched_port_worker *worker;
+	struct rte_sched_port *view;
+	uint32_t i;
+
+	/* Check user parameters */
+	if (port == NULL || port->parent != NULL) {
+		RTE_LOG(ERR, SCHED,
+			"%s: Incorrect value for parameter port\n", __func__);
+		return NULL;
+	}
+
+	if (n_subports == 0 || subport_first >= port->n_subports_per_port ||
+		n_subports > port->n_subports_per_port - subport_first) {
+		RTE_LOG(ERR, SCHED,
+			"%s: Incorrect value for subport range\n", __func__);
+		return NULL;
+	}
+
+	for (i = subport_first; i < subport_first + n_subports; i++)
+		if (port->subports[i] == NULL ||
+			port->subports[i]->worker != NULL) {
+			RTE_LOG(ERR, SCHED,
+				"%s: Subport %u not configured or already owned\n",
+				__func__, i);
+			return NULL;
+		}
+
+	worker = rte_zmalloc_socket("sched_worker", sizeof(*worker),
+		RTE_CACHE_LINE_SIZE, port->socket);
+	view = rte_zmalloc_socket("sched_worker_view", sizeof(*view) +
+		n_subports * sizeof(struct rte_sched_subport *),
+		RTE_CACHE_LINE_SIZE, port->socket);
+	if (worker == NULL || view == NULL) {
+		RTE_LOG(ERR, SCHED, "%s: Memory allocation fails\n", __func__);
+		rte_free(worker);
+		rte_free(view);
+		return NULL;
+	}
+
+	/* View of the port restricted to the worker subports */
+	memcpy(view, port, sizeof(*view));
+	view->n_subports_per_port = n_subports;
+	for (i = 0; i < n_subports; i++) {
+		view->subports[i] = port->subports[subport_first + i];
+		view->subports[i]->worker = worker;
+	}
+
+	/* Timing, starting from the shared transmission time */
+	view->time = __atomic_load_n(&port->time, __ATOMIC_RELAXED);
+	view->time_cpu_bytes = view->time;
+	view->time_cpu_cycles = rte_get_tsc_cycles();
+
+	/* Grinders */
+	view->pkts_out = NULL;
+	view->n_pkts_out = 0;
+	view->subport_id = 0;
+
+	view->parent = port;
+	view->n_workers = 0;
+
+	worker->port = port;
+	worker->subport_first = subport_first;
+	worker->n_subports = n_subports;
+	worker->view = view;
+	port->n_workers++;
+
+	return worker;
+}
+
+void
+rte_sched_port_worker_free(struct rte_sched_port_worker *worker)
+{
+	struct rte_sched_port *port;
+	uint32_t i;
+
+	/* Check user parameters */
+	if (worker == NULL)
+		return;
+
+	port = worker->port;
+	for (i = 0; i < worker->n_subports; i++)
+		port->subports[worker->subport_first + i]->worker = NULL;
+
+	/* Restart the port CPU time from the shared transmission time */
+	port->n_workers--;
+	if (port->n_workers == 0) {
+		__atomic_store_n(&port->time_cpu_cycles, rte_get_tsc_cycles(),
+			__ATOMIC_RELAXED);
+		port->time_cpu_bytes = __atomic_load_n(&port->time,
+			__ATOMIC_RELAXED);
+	}
+
+	rte_free(worker->view);
+	rte_free(worker);
+}
+
+int
+rte_sched_port_worker_dequeue(struct rte_sched_port_worker *worker,
+	struct rte_mbuf **pkts, uint32_t n_pkts)
+{
+	return rte_sched_port_dequeue(worker->view, pkts, n_pkts);
+}
@@ -75,7 +75,9 @@ extern "C" {
  */
 #define RTE_SCHED_QUEUES_PER_PIPE    16
 
-/** Number of WRR queues for best-effort traffic class per pipe.
+/** Maximum number of WRR queues for best-effort traffic class per pipe.
+ * The number of queues actually used by the pipes of a subport is set
+ * through struct rte_sched_subport_params::n_be_queues.
  *
  * @see struct rte_sched_pipe_params
  */
@@ -156,7 +158,10 @@ struct rte_sched_pipe_params {
 	/** Best-effort traffic class oversubscription weight */
 	uint8_t tc_ov_weight;
 
-	/** WRR weights of best-effort traffic class queues */
+	/** WRR weights of best-effort traffic class queues.
+	 * Only the weights of the first n_be_queues queues of the subport
+	 * are used.
+	 */
 	uint8_t wrr_weights[RTE_SCHED_BE_QUEUES_PER_PIPE];
 };
 
@@ -216,6 +221,14 @@ struct rte_sched_subport_params {
 	 * otherwise proper parameters need to be provided.
 	 */
 	struct rte_sched_cman_params *cman_params;
+
+	/** Number of best-effort traffic class queues per pipe.
+	 * Power of 2, no bigger than RTE_SCHED_BE_QUEUES_PER_PIPE. Zero
+	 * selects RTE_SCHED_BE_QUEUES_PER_PIPE. No queue memory is
+	 * allocated for the queues above this number, and the packets
+	 * written to them are folded onto the enabled queues.
+	 */
+	uint32_t n_be_queues;
 };
 
 struct rte_sched_subport_profile_params {
@@ -500,7 +513,9 @@ rte_sched_queue_read_stats(struct rte_sched_port *port,
  *   Traffic class ID within pipe (0 .. RTE_SCHED_TRAFFIC_CLASS_BE)
  * @param queue
  *   Queue ID within pipe traffic class, 0 for high priority TCs, and
- *   0 .. (RTE_SCHED_BE_QUEUES_PER_PIPE - 1) for best-effort TC
+ *   0 .. (RTE_SCHED_BE_QUEUES_PER_PIPE - 1) for best-effort TC. The
+ *   best-effort queue ID is taken modulo the number of best-effort
+ *   queues of the subport.
  * @param color
  *   Packet color set
  */
@@ -580,6 +595,88 @@ rte_sched_port_enqueue(struct rte_sched_port *port, struct rte_mbuf **pkts, uint
 int
 rte_sched_port_dequeue(struct rte_sched_port *port, struct rte_mbuf **pkts, uint32_t n_pkts);
 
+/*
+ * Multi-core dequeue
+ *
+ ***/
+
+/** Dequeue worker: a range of subports of a port dequeued by one lcore. */
+struct rte_sched_port_worker;
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Hierarchical scheduler dequeue worker create
+ *
+ * Hand a range of subports of the port over to a dequeue worker, so
+ * that the subports of one port can be dequeued by several lcores,
+ * each lcore running one worker. The workers of a port share the port
+ * transmission time through a lightweight arbiter, updated once per
+ * dequeue burst, so the subport and pipe token buckets keep being
+ * credited against the same time base as with a single lcore.
+ *
+ * All the subports of the range must be configured and not owned by
+ * another worker. Once a port has workers, rte_sched_port_dequeue()
+ * must no longer be called on it, and the packets of the subports of
+ * a worker must be enqueued with rte_sched_port_enqueue() by the lcore
+ * running that worker.
+ *
+ * @param port
+ *   Handle to port scheduler instance
+ * @param subport_first
+ *   ID of the first subport of the worker
+ * @param n_subports
+ *   Number of subports of the worker
+ * @return
+ *   Handle to the dequeue worker upon success or NULL otherwise.
+ */
+__rte_experimental
+struct rte_sched_port_worker *
+rte_sched_port_worker_create(struct rte_sched_port *port,
+	uint32_t subport_first,
+	uint32_t n_subports);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Hierarchical scheduler dequeue worker free
+ *
+ * The subports of the worker are handed back to the port. All the
+ * workers of a port must be freed before the port.
+ *
+ * @param worker
+ *   Handle to the dequeue worker
+ */
+__rte_experimental
+void
+rte_sched_port_worker_free(struct rte_sched_port_worker *worker);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice.
+ *
+ * Hierarchical scheduler worker dequeue. Same as
+ * rte_sched_port_dequeue(), restricted to the subports of the worker.
+ * Different workers of the same port can be used concurrently by
+ * different lcores.
+ *
+ * @param worker
+ *   Handle to the dequeue worker
+ * @param pkts
+ *   Pre-allocated packet descriptor array where the packets dequeued
+ *   from the subports of the worker should be stored
+ * @param n_pkts
+ *   Number of packets to dequeue
+ * @return
+ *   Number of packets successfully dequeued and placed in the pkts array
+ */
+__rte_experimental
+int
+rte_sched_port_worker_dequeue(struct rte_sched_port_worker *worker,
+	struct rte_mbuf **pkts, uint32_t n_pkts);
+
 #ifdef __cplusplus
 }
 #endif
@@ -28,6 +28,32 @@
 
 #include "rte_timer.h"
 
+/*
+ * The timer wheel has TIMER_WHEEL_LEVELS levels of TIMER_WHEEL_SLOTS slots.
+ * A slot of level 0 holds the timers expiring in one tick, a slot of level l
+ * the timers expiring in TIMER_WHEEL_SLOTS^l ticks, which are moved down to
+ * the lower levels (cascaded) when the current tick enters the slot.
+ * The timers are linked through their skiplist pointers: sl_next[0] to the
+ * next timer of the slot and sl_next[1] to the pointer to the timer.
+ */
+#define TIMER_WHEEL_LEVELS 4
+#define TIMER_WHEEL_BITS 8
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_MASK (TIMER_WHEEL_SLOTS - 1)
+#define TIMER_WHEEL_RANGE (UINT64_C(1) << \
+		(TIMER_WHEEL_LEVELS * TIMER_WHEEL_BITS))
+#define TIMER_WHEEL_DEFAULT_HZ 10000 /* default tick of 100 us */
+
+struct timer_wheel {
+	uint64_t cur;    /**< next tick to process */
+	uint32_t shift;  /**< log2 of the tick in timer cycles */
+	uint32_t count;  /**< number of timers in the wheel */
+	struct rte_timer *slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+};
+
+/* maximum number of timers given at once to a bulk callback */
+#define TIMER_BULK_SIZE 32
+
 /**
  * Per-lcore info for timers.
  */
@@ -47,6 +73,9 @@ struct priv_timer {
 	/** running timer on this lcore now */
 	struct rte_timer *running_tim;
 
+	/** timer wheel, NULL when pending timers are in the skiplist */
+	struct timer_wheel *wheel;
+
 #ifdef RTE_LIBRTE_TIMER_DEBUG
 	/** per-lcore statistics */
 	struct rte_timer_debug_stats stats;
@@ -115,12 +144,71 @@ rte_timer_data_alloc(uint32_t *id_ptr)
 	return -ENOSPC;
 }
 
+int
+rte_timer_data_alloc_ext(uint32_t *id_ptr,
+		const struct rte_timer_data_params *params)
+{
+	struct rte_timer_data *data;
+	struct timer_wheel *wheels;
+	uint64_t tick, cur_tick;
+	uint32_t id, shift;
+	int lcore_id, ret;
+
+	if (params == NULL ||
+			params->backend == RTE_TIMER_BACKEND_SKIPLIST)
+		return rte_timer_data_alloc(id_ptr);
+	if (params->backend != RTE_TIMER_BACKEND_WHEEL)
+		return -EINVAL;
+
+	tick = params->wheel_tick;
+	if (tick == 0)
+		tick = RTE_MAX(rte_get_timer_hz() / TIMER_WHEEL_DEFAULT_HZ,
+				UINT64_C(1));
+	shift = rte_fls_u64(tick) - 1;
+
+	wheels = rte_zmalloc("timer_wheels", sizeof(*wheels) * RTE_MAX_LCORE,
+			RTE_CACHE_LINE_SIZE);
+	if (wheels == NULL)
+		return -ENOMEM;
+
+	ret = rte_timer_data_alloc(&id);
+	if (ret != 0) {
+		rte_free(wheels);
+		return ret;
+	}
+
+	data = &rte_timer_data_arr[id];
+	cur_tick = rte_get_timer_cycles() >> shift;
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		wheels[lcore_id].cur = cur_tick;
+		wheels[lcore_id].shift = shift;
+		data->priv_timer[lcore_id].pending_head.expire =
+				(cur_tick + 1) << shift;
+		data->priv_timer[lcore_id].wheel = &wheels[lcore_id];
+	}
+
+	if (id_ptr)
+		*id_ptr = id;
+
+	return 0;
+}
+
 int
 rte_timer_data_dealloc(uint32_t id)
 {
 	struct rte_timer_data *timer_data;
+	int lcore_id;
 	TIMER_DATA_VALID_GET_OR_ERR_RET(id, timer_data, -EINVAL);
 
+	if (timer_data->priv_timer[0].wheel != NULL) {
+		rte_free(timer_data->priv_timer[0].wheel);
+		for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+			timer_data->priv_timer[lcore_id].wheel = NULL;
+			timer_data->priv_timer[lcore_id].pending_head.expire =
+					0;
+		}
+	}
+
 	timer_data->internal_flags &= ~(FL_ALLOCATED);
 
 	return 0;
@@ -389,6 +477,137 @@ timer_get_prev_entries_for_node(struct rte_timer *tim, unsigned tim_lcore,
 	}
 }
 
+static inline struct rte_timer **
+timer_wheel_pprev(const struct rte_timer *tim)
+{
+	return (struct rte_timer **)(uintptr_t)tim->sl_next[1];
+}
+
+static inline void
+timer_wheel_set_pprev(struct rte_timer *tim, struct rte_timer **pprev)
+{
+	tim->sl_next[1] = (struct rte_timer *)(uintptr_t)pprev;
+}
+
+/*
+ * Link a timer in the slot of its expiry tick, at the lowest level whose
+ * slots do not wrap before that tick. Timers further than the wheel range
+ * go to the last slot of the top level, and are placed again when cascaded.
+ */
+static void
+timer_wheel_link(struct timer_wheel *wheel, struct rte_timer *tim)
+{
+	uint64_t tick = tim->expire >> wheel->shift;
+	uint64_t delta;
+	struct rte_timer **slot;
+	unsigned int lvl;
+
+	if (tick < wheel->cur)
+		tick = wheel->cur;
+	delta = tick - wheel->cur;
+	if (delta >= TIMER_WHEEL_RANGE) {
+		delta = TIMER_WHEEL_RANGE - 1;
+		tick = wheel->cur + delta;
+	}
+
+	for (lvl = 0; delta >= UINT64_C(1) << (TIMER_WHEEL_BITS * (lvl + 1));
+			lvl++)
+		;
+	slot = &wheel->slots[lvl][(tick >> (TIMER_WHEEL_BITS * lvl)) &
+			TIMER_WHEEL_MASK];
+
+	tim->sl_next[0] = *slot;
+	if (*slot != NULL)
+		timer_wheel_set_pprev(*slot, &tim->sl_next[0]);
+	*slot = tim;
+	timer_wheel_set_pprev(tim, slot);
+}
+
+static void
+timer_wheel_add(struct timer_wheel *wheel, struct rte_timer *tim)
+{
+	uint64_t cur_tick;
+
+	/* the wheel is not turned while empty, catch up with the time */
+	if (wheel->count == 0) {
+		cur_tick = rte_get_timer_cycles() >> wheel->shift;
+		if (wheel->cur < cur_tick)
+			wheel->cur = cur_tick;
+	}
+
+	timer_wheel_link(wheel, tim);
+	wheel->count++;
+}
+
+static void
+timer_wheel_del(struct timer_wheel *wheel, struct rte_timer *tim)
+{
+	struct rte_timer **pprev = timer_wheel_pprev(tim);
+
+	/* already taken out of the wheel as expired */
+	if (pprev == NULL)
+		return;
+
+	*pprev = tim->sl_next[0];
+	if (tim->sl_next[0] != NULL)
+		timer_wheel_set_pprev(tim->sl_next[0], pprev);
+	timer_wheel_set_pprev(tim, NULL);
+	wheel->count--;
+}
+
+/* Move the timers of a slot of a higher level to the lower levels */
+static void
+timer_wheel_cascade(struct timer_wheel *wheel, unsigned int lvl)
+{
+	struct rte_timer **slot = &wheel->slots[lvl][(wheel->cur >>
+			(TIMER_WHEEL_BITS * lvl)) & TIMER_WHEEL_MASK];
+	struct rte_timer *tim = *slot, *next_tim;
+
+	*slot = NULL;
+	for (; tim != NULL; tim = next_tim) {
+		next_tim = tim->sl_next[0];
+		timer_wheel_link(wheel, tim);
+	}
+}
+
+/*
+ * Take the timers of all the ticks elapsed before cur_time out of the wheel,
+ * and return them linked through sl_next[0] in expiry tick order. The timers
+ * of the current tick are left, so that no timer is taken before it expires.
+ */
+static struct rte_timer *
+timer_wheel_take_expired(struct timer_wheel *wheel, uint64_t cur_time)
+{
+	const uint64_t cur_tick = cur_time >> wheel->shift;
+	struct rte_timer *run_first_tim = NULL, **tail = &run_first_tim;
+	struct rte_timer **slot, *tim;
+	unsigned int lvl;
+
+	while (wheel->cur < cur_tick && wheel->count != 0) {
+		for (lvl = TIMER_WHEEL_LEVELS - 1; lvl > 0; lvl--)
+			if ((wheel->cur & ((UINT64_C(1) <<
+					(TIMER_WHEEL_BITS * lvl)) - 1)) == 0)
+				timer_wheel_cascade(wheel, lvl);
+
+		slot = &wheel->slots[0][wheel->cur & TIMER_WHEEL_MASK];
+		if (*slot != NULL) {
+			*tail = *slot;
+			*slot = NULL;
+			for (tim = *tail; tim != NULL; tim = tim->sl_next[0]) {
+				timer_wheel_set_pprev(tim, NULL);
+				wheel->count--;
+				tail = &tim->sl_next[0];
+			}
+		}
+		wheel->cur++;
+	}
+	/* nothing left to expire in the ticks to skip */
+	if (wheel->cur < cur_tick)
+		wheel->cur = cur_tick;
+
+	return run_first_tim;
+}
+
 /* call with lock held as necessary
  * add in list
  * timer must be in config state
@@ -401,6 +620,11 @@ timer_add(struct rte_timer *tim, unsigned int tim_lcore,
 	unsigned lvl;
 	struct rte_timer *prev[MAX_SKIPLIST_DEPTH+1];
 
+	if (priv_timer[tim_lcore].wheel != NULL) {
+		timer_wheel_add(priv_timer[tim_lcore].wheel, tim);
+		return;
+	}
+
 	/* find where exactly this element goes in the list of elements
 	 * for each depth. */
 	timer_get_prev_entries(tim->expire, tim_lcore, prev, priv_timer);
@@ -446,6 +670,11 @@ timer_del(struct rte_timer *tim, union rte_timer_status prev_status,
 	if (prev_owner != lcore_id || !local_is_locked)
 		rte_spinlock_lock(&priv_timer[prev_owner].list_lock);
 
+	if (priv_timer[prev_owner].wheel != NULL) {
+		timer_wheel_del(priv_timer[prev_owner].wheel, tim);
+		goto unlock;
+	}
+
 	/* save the lowest list entry into the expire field of the dummy hdr.
 	 * NOTE: this is not atomic on 32-bit */
 	if (tim == priv_timer[prev_owner].pending_head.sl_next[0])
@@ -466,6 +695,7 @@ timer_del(struct rte_timer *tim, union rte_timer_status prev_status,
 		else
 			break;
 
+unlock:
 	if (prev_owner != lcore_id || !local_is_locked)
 		rte_spinlock_unlock(&priv_timer[prev_owner].list_lock);
 }
@@ -657,59 +887,72 @@ rte_timer_pending(struct rte_timer *tim)
 				__ATOMIC_RELAXED) == RTE_TIMER_PENDING;
 }
 
-/* must be called periodically, run all timer that expired */
-static void
-__rte_timer_manage(struct rte_timer_data *timer_data)
+/*
+ * Take the expired timers out of the pending list of an lcore, mark them as
+ * running and return them linked through sl_next[0], in expiry order.
+ */
+static struct rte_timer *
+timer_take_expired(struct priv_timer *priv_timer, unsigned int poll_lcore)
 {
-	union rte_timer_status status;
+	struct priv_timer *privp = &priv_timer[poll_lcore];
 	struct rte_timer *tim, *next_tim;
 	struct rte_timer *run_first_tim, **pprev;
-	unsigned lcore_id = rte_lcore_id();
 	struct rte_timer *prev[MAX_SKIPLIST_DEPTH + 1];
 	uint64_t cur_time;
 	int i, ret;
-	struct priv_timer *priv_timer = timer_data->priv_timer;
 
-	/* timer manager only runs on EAL thread with valid lcore_id */
-	assert(lcore_id < RTE_MAX_LCORE);
-
-	__TIMER_STAT_ADD(priv_timer, manage, 1);
 	/* optimize for the case where per-cpu list is empty */
-	if (priv_timer[lcore_id].pending_head.sl_next[0] == NULL)
-		return;
+	if (privp->wheel != NULL ? privp->wheel->count == 0 :
+			privp->pending_head.sl_next[0] == NULL)
+		return NULL;
 	cur_time = rte_get_timer_cycles();
 
 #ifdef RTE_ARCH_64
 	/* on 64-bit the value cached in the pending_head.expired will be
 	 * updated atomically, so we can consult that for a quick check here
 	 * outside the lock */
-	if (likely(priv_timer[lcore_id].pending_head.expire > cur_time))
-		return;
+	if (likely(privp->pending_head.expire > cur_time))
+		return NULL;
 #endif
 
 	/* browse ordered list, add expired timers in 'expired' list */
-	rte_spinlock_lock(&priv_timer[lcore_id].list_lock);
+	rte_spinlock_lock(&privp->list_lock);
 
-	/* if nothing to do just unlock and return */
-	if (priv_timer[lcore_id].pending_head.sl_next[0] == NULL ||
-	    priv_timer[lcore_id].pending_head.sl_next[0]->expire > cur_time) {
-		rte_spinlock_unlock(&priv_timer[lcore_id].list_lock);
-		return;
-	}
+	if (privp->wheel != NULL) {
+		tim = timer_wheel_take_expired(privp->wheel, cur_time);
+		/* no timer expires before the end of the current tick */
+		privp->pending_head.expire =
+			(privp->wheel->cur + 1) << privp->wheel->shift;
+		if (tim == NULL) {
+			rte_spinlock_unlock(&privp->list_lock);
+			return NULL;
+		}
+	} else {
+		/* if nothing to do just unlock and return */
+		if (privp->pending_head.sl_next[0] == NULL ||
+		    privp->pending_head.sl_next[0]->expire > cur_time) {
+			rte_spinlock_unlock(&privp->list_lock);
+			return NULL;
+		}
+
+		/* save start of list of expired timers */
+		tim = privp->pending_head.sl_next[0];
 
-	/* save start of list of expired timers */
-	tim = priv_timer[lcore_id].pending_head.sl_next[0];
+		/* break the existing list at current time point */
+		timer_get_prev_entries(cur_time, poll_lcore, prev, priv_timer);
+		for (i = privp->curr_skiplist_depth - 1; i >= 0; i--) {
+			if (prev[i] == &privp->pending_head)
+				continue;
+			privp->pending_head.sl_next[i] = prev[i]->sl_next[i];
+			if (prev[i]->sl_next[i] == NULL)
+				privp->curr_skiplist_depth--;
+			prev[i]->sl_next[i] = NULL;
+		}
 
-	/* break the existing list at current time point */
-	timer_get_prev_entries(cur_time, lcore_id, prev, priv_timer);
-	for (i = priv_timer[lcore_id].curr_skiplist_depth -1; i >= 0; i--) {
-		if (prev[i] == &priv_timer[lcore_id].pending_head)
-			continue;
-		priv_timer[lcore_id].pending_head.sl_next[i] =
-		    prev[i]->sl_next[i];
-		if (prev[i]->sl_next[i] == NULL)
-			priv_timer[lcore_id].curr_skiplist_depth--;
-		prev[i] ->sl_next[i] = NULL;
+		/* update the next to expire timer value */
+		privp->pending_head.expire =
+		    (privp->pending_head.sl_next[0] == NULL) ? 0 :
+			privp->pending_head.sl_next[0]->expire;
 	}
 
 	/* transition run-list from PENDING to RUNNING */
@@ -730,12 +973,29 @@ __rte_timer_manage(struct rte_timer_data *timer_data)
 		}
 	}
 
-	/* update the next to expire timer value */
-	priv_timer[lcore_id].pending_head.expire =
-	    (priv_timer[lcore_id].pending_head.sl_next[0] == NULL) ? 0 :
-		priv_timer[lcore_id].pending_head.sl_next[0]->expire;
+	rte_spinlock_unlock(&privp->list_lock);
 
-	rte_spinlock_unlock(&priv_timer[lcore_id].list_lock);
+	return run_first_tim;
+}
+
+/* must be called periodically, run all timer that expired */
+static void
+__rte_timer_manage(struct rte_timer_data *timer_data)
+{
+	union rte_timer_status status;
+	struct rte_timer *tim, *next_tim;
+	struct rte_timer *run_first_tim;
+	unsigned lcore_id = rte_lcore_id();
+	struct priv_timer *priv_timer = timer_data->priv_timer;
+
+	/* timer manager only runs on EAL thread with valid lcore_id */
+	assert(lcore_id < RTE_MAX_LCORE);
+
+	__TIMER_STAT_ADD(priv_timer, manage, 1);
+
+	run_first_tim = timer_take_expired(priv_timer, lcore_id);
+	if (run_first_tim == NULL)
+		return;
 
 	/* now scan expired list and call callbacks */
 	for (tim = run_first_tim; tim != NULL; tim = next_tim) {
@@ -804,16 +1064,12 @@ rte_timer_alt_manage(uint32_t timer_data_id,
 {
 	unsigned int default_poll_lcores[] = {rte_lcore_id()};
 	union rte_timer_status status;
-	struct rte_timer *tim, *next_tim, **pprev;
+	struct rte_timer *tim;
 	struct rte_timer *run_first_tims[RTE_MAX_LCORE];
 	unsigned int this_lcore = rte_lcore_id();
-	struct rte_timer *prev[MAX_SKIPLIST_DEPTH + 1];
-	uint64_t cur_time;
-	int i, j, ret;
+	int i;
 	int nb_runlists = 0;
 	struct rte_timer_data *data;
-	struct priv_timer *privp;
-	uint32_t poll_lcore;
 
 	TIMER_DATA_VALID_GET_OR_ERR_RET(timer_data_id, data, -EINVAL);
 
@@ -828,75 +1084,9 @@ rte_timer_alt_manage(uint32_t timer_data_id,
 	}
 
 	for (i = 0; i < nb_poll_lcores; i++) {
-		poll_lcore = poll_lcores[i];
-		privp = &data->priv_timer[poll_lcore];
-
-		/* optimize for the case where per-cpu list is empty */
-		if (privp->pending_head.sl_next[0] == NULL)
-			continue;
-		cur_time = rte_get_timer_cycles();
-
-#ifdef RTE_ARCH_64
-		/* on 64-bit the value cached in the pending_head.expired will
-		 * be updated atomically, so we can consult that for a quick
-		 * check here outside the lock
-		 */
-		if (likely(privp->pending_head.expire > cur_time))
-			continue;
-#endif
-
-		/* browse ordered list, add expired timers in 'expired' list */
-		rte_spinlock_lock(&privp->list_lock);
-
-		/* if nothing to do just unlock and return */
-		if (privp->pending_head.sl_next[0] == NULL ||
-		    privp->pending_head.sl_next[0]->expire > cur_time) {
-			rte_spinlock_unlock(&privp->list_lock);
-			continue;
-		}
-
-		/* save start of list of expired timers */
-		tim = privp->pending_head.sl_next[0];
-
-		/* break the existing list at current time point */
-		timer_get_prev_entries(cur_time, poll_lcore, prev,
-				       data->priv_timer);
-		for (j = privp->curr_skiplist_depth - 1; j >= 0; j--) {
-			if (prev[j] == &privp->pending_head)
-				continue;
-			privp->pending_head.sl_next[j] =
-				prev[j]->sl_next[j];
-			if (prev[j]->sl_next[j] == NULL)
-				privp->curr_skiplist_depth--;
-
-			prev[j]->sl_next[j] = NULL;
-		}
-
-		/* transition run-list from PENDING to RUNNING */
-		run_first_tims[nb_runlists] = tim;
-		pprev = &run_first_tims[nb_runlists];
-		nb_runlists++;
-
-		for ( ; tim != NULL; tim = next_tim) {
-			next_tim = tim->sl_next[0];
-
-			ret = timer_set_running_state(tim);
-			if (likely(ret == 0)) {
-				pprev = &tim->sl_next[0];
-			} else {
-				/* another core is trying to re-config this one,
-				 * remove it from local expired list
-				 */
-				*pprev = next_tim;
-			}
-		}
-
-		/* update the next to expire timer value */
-		privp->pending_head.expire =
-		    (privp->pending_head.sl_next[0] == NULL) ? 0 :
-			privp->pending_head.sl_next[0]->expire;
-
-		rte_spinlock_unlock(&privp->list_lock);
+		tim = timer_take_expired(data->priv_timer, poll_lcores[i]);
+		if (tim != NULL)
+			run_first_tims[nb_runlists++] = tim;
 	}
 
 	/* Now process the run lists */
@@ -976,6 +1166,108 @@ rte_timer_alt_manage(uint32_t timer_data_id,
 	return 0;
 }
 
+int
+rte_timer_alt_manage_bulk(uint32_t timer_data_id, unsigned int *poll_lcores,
+			  int nb_poll_lcores, rte_timer_bulk_cb_t f,
+			  void *f_arg)
+{
+	unsigned int default_poll_lcores[] = {rte_lcore_id()};
+	struct rte_timer *tims[TIMER_BULK_SIZE];
+	union rte_timer_status status;
+	struct rte_timer *tim, *next_tim;
+	unsigned int this_lcore = rte_lcore_id();
+	unsigned int nb_tims = 0;
+	struct rte_timer_data *data;
+	int i;
+
+	TIMER_DATA_VALID_GET_OR_ERR_RET(timer_data_id, data, -EINVAL);
+	if (f == NULL)
+		return -EINVAL;
+
+	/* timer manager only runs on EAL thread with valid lcore_id */
+	assert(this_lcore < RTE_MAX_LCORE);
+
+	__TIMER_STAT_ADD(data->priv_timer, manage, 1);
+
+	if (poll_lcores == NULL) {
+		poll_lcores = default_poll_lcores;
+		nb_poll_lcores = RTE_DIM(default_poll_lcores);
+	}
+
+	for (i = 0; i < nb_poll_lcores; i++) {
+		tim = timer_take_expired(data->priv_timer, poll_lcores[i]);
+
+		for ( ; tim != NULL; tim = next_tim) {
+			next_tim = tim->sl_next[0];
+
+			__TIMER_STAT_ADD(data->priv_timer, pending, -1);
+
+			/* the timers are stopped or reloaded before the
+			 * callback, which is then free to reset them
+			 */
+			if (tim->period == 0) {
+				status.state = RTE_TIMER_STOP;
+				status.owner = RTE_TIMER_NO_OWNER;
+				/* The "RELEASE" ordering guarantees the memory
+				 * operations above the status update are
+				 * observed before the update by all threads
+				 */
+				__atomic_store_n(&tim->status.u32, status.u32,
+					__ATOMIC_RELEASE);
+			} else {
+				rte_spinlock_lock(
+					&data->priv_timer[this_lcore].list_lock);
+				status.state = RTE_TIMER_PENDING;
+				__TIMER_STAT_ADD(data->priv_timer, pending, 1);
+				status.owner = (int16_t)this_lcore;
+				__atomic_store_n(&tim->status.u32, status.u32,
+					__ATOMIC_RELEASE);
+				__rte_timer_reset(tim, tim->expire + tim->period,
+					tim->period, this_lcore, tim->f,
+					tim->arg, 1, data);
+				rte_spinlock_unlock(
+					&data->priv_timer[this_lcore].list_lock);
+			}
+
+			tims[nb_tims++] = tim;
+			if (nb_tims == TIMER_BULK_SIZE) {
+				f(tims, nb_tims, f_arg);
+				nb_tims = 0;
+			}
+		}
+	}
+
+	if (nb_tims != 0)
+		f(tims, nb_tims, f_arg);
+
+	return 0;
+}
+
+/* Stop the timers of the wheel of an lcore, called with the list locked */
+static void
+timer_wheel_stop_all(struct rte_timer_data *timer_data,
+		     struct timer_wheel *wheel,
+		     rte_timer_stop_all_cb_t f, void *f_arg)
+{
+	struct rte_timer *tim, *next_tim;
+	unsigned int lvl, idx;
+
+	for (lvl = 0; lvl < TIMER_WHEEL_LEVELS; lvl++) {
+		for (idx = 0; idx < TIMER_WHEEL_SLOTS; idx++) {
+			for (tim = wheel->slots[lvl][idx]; tim != NULL;
+			     tim = next_tim) {
+				next_tim = tim->sl_next[0];
+
+				/* Call timer_stop with lock held */
+				__rte_timer_stop(tim, 1, timer_data);
+
+				if (f)
+					f(tim, f_arg);
+			}
+		}
+	}
+}
+
 /* Walk pending lists, stopping timers and calling user-specified function */
 int
 rte_timer_stop_all(uint32_t timer_data_id, unsigned int *walk_lcores,
@@ -996,6 +1288,13 @@ rte_timer_stop_all(uint32_t timer_data_id, unsigned int *walk_lcores,
 
 		rte_spinlock_lock(&priv_timer->list_lock);
 
+		if (priv_timer->wheel != NULL) {
+			timer_wheel_stop_all(timer_data, priv_timer->wheel,
+					     f, f_arg);
+			rte_spinlock_unlock(&priv_timer->list_lock);
+			continue;
+		}
+
 		for (tim = priv_timer->pending_head.sl_next[0];
 		     tim != NULL;
 		     tim = next_tim) {
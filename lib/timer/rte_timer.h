@@ -146,6 +146,57 @@ struct rte_timer
  */
 int rte_timer_data_alloc(uint32_t *id_ptr);
 
+/**
+ * Backend keeping the pending timers of a timer data instance.
+ */
+enum rte_timer_backend {
+	/** Skiplist ordered by expiry time per lcore, O(log n) to arm. */
+	RTE_TIMER_BACKEND_SKIPLIST = 0,
+	/** Hierarchical timer wheel per lcore, O(1) to arm and stop. */
+	RTE_TIMER_BACKEND_WHEEL,
+};
+
+/**
+ * Parameters of a timer data instance.
+ */
+struct rte_timer_data_params {
+	enum rte_timer_backend backend; /**< Backend of the pending timers. */
+	/**
+	 * Resolution of the timer wheel in timer cycles, rounded down to a
+	 * power of 2, or 0 for about 100 us. A timer expires up to one
+	 * resolution late. The wheel covers 2^32 resolutions, timers set
+	 * further are kept aside until they get in range.
+	 */
+	uint64_t wheel_tick;
+};
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Allocate a timer data instance with the given backend.
+ *
+ * The skiplist backend is the one of rte_timer_data_alloc(). The timer
+ * wheel backend arms and stops timers in constant time, without the random
+ * memory accesses of the skiplist, at the cost of the precision of the
+ * expiry, and suits a large number of long timeouts.
+ *
+ * @param id_ptr
+ *   Pointer to variable into which to write the identifier of the allocated
+ *   timer data instance.
+ * @param params
+ *   The parameters of the instance, NULL for the skiplist backend.
+ *
+ * @return
+ *   - 0: Success
+ *   - -EINVAL: invalid parameters
+ *   - -ENOMEM: cannot allocate the timer wheels
+ *   - -ENOSPC: maximum number of timer data instances already allocated
+ */
+__rte_experimental
+int rte_timer_data_alloc_ext(uint32_t *id_ptr,
+		const struct rte_timer_data_params *params);
+
 /**
  * Deallocate a timer data instance.
  *
@@ -470,6 +521,50 @@ int
 rte_timer_alt_manage(uint32_t timer_data_id, unsigned int *poll_lcores,
 		     int n_poll_lcores, rte_timer_alt_manage_cb_t f);
 
+/**
+ * Callback function type for rte_timer_alt_manage_bulk().
+ */
+typedef void (*rte_timer_bulk_cb_t)(struct rte_timer **tims,
+		unsigned int nb_tims, void *arg);
+
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * Manage a set of timer lists and execute the specified callback function for
+ * the expired timers, passed in bursts. This function is similar to
+ * rte_timer_alt_manage(), except that the expired timers are given to the
+ * callback function several at a time.
+ *
+ * When the callback function is called, the single timers it is given are
+ * already stopped, and the periodic ones are already pending again, so that
+ * it can reset, stop or free them. A periodic timer has to be stopped before
+ * it is freed.
+ *
+ * @see rte_timer_alt_manage()
+ * @param timer_data_id
+ *   An identifier indicating which instance of timer data should be used for
+ *   this operation.
+ * @param poll_lcores
+ *   An array of lcore ids identifying the timer lists that should be processed.
+ *   NULL is allowed - if NULL, the timer list corresponding to the lcore
+ *   calling this routine is processed (same as rte_timer_manage()).
+ * @param nb_poll_lcores
+ *   The size of the poll_lcores array. If 'poll_lcores' is NULL, this parameter
+ *   is ignored.
+ * @param f
+ *   The callback function which should be called for the expired timers.
+ * @param f_arg
+ *   An arbitrary argument that will be passed to f.
+ * @return
+ *   - 0: success
+ *   - -EINVAL: invalid timer_data_id or callback function
+ */
+__rte_experimental
+int
+rte_timer_alt_manage_bulk(uint32_t timer_data_id, unsigned int *poll_lcores,
+		int nb_poll_lcores, rte_timer_bulk_cb_t f, void *f_arg);
+
 /**
  * Callback function type for rte_timer_stop_all().
  */